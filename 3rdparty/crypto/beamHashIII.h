@@ -19,11 +19,14 @@ const uint32_t workBitSize=448;
 const uint32_t collisionBitSize=24;
 const uint32_t numRounds=5;
 
+// Work bits are kept as plain 64-bit words (least significant first), the loops over them are vectorized by the compiler
+const uint32_t workWordSize=workBitSize/64;
+
 class stepElem {	
 	friend class BeamHash_III;
 	
 	private:
-	std::bitset<workBitSize> workBits;
+	uint64_t workWords[workWordSize];
 	std::vector<uint32_t> indexTree;
 
 	public: 
@@ -37,7 +40,7 @@ class stepElem {
 	friend bool hasCollision(stepElem &a, stepElem &b);
 	friend bool distinctIndices(stepElem &a, stepElem &b);  
 	friend bool indexAfter(stepElem &a, stepElem &b);  
-	friend uint64_t getLowBits(stepElem test);
+	friend uint64_t getLowBits(const stepElem& test);
 };
 
 class BeamHash_III : public PoWScheme {
@@ -41,13 +41,41 @@ uint64_t siphash24(uint64_t state0, uint64_t state1, uint64_t state2, uint64_t s
 } //end namespace sipHash
 
 
-stepElem::stepElem(const uint64_t * prePow, uint32_t index) {
-	workBits.reset();
+namespace {
+
+// Shift right the 448-bit work bits by the collision size, and keep the lowest remLen bits
+void shiftAndMask(uint64_t* w, uint32_t remLen) {
+	for (uint32_t i=0; i<workWordSize-1; i++) {
+		w[i] = (w[i] >> collisionBitSize) | (w[i+1] << (64-collisionBitSize));
+	}
+	w[workWordSize-1] >>= collisionBitSize;
+
+	for (uint32_t i=0; i<workWordSize; i++) {
+		uint32_t pos = i*64;
+		if (pos >= remLen) {
+			w[i] = 0;
+		} else if (remLen-pos < 64) {
+			w[i] &= (1ULL << (remLen-pos)) - 1;
+		}
+	}
+}
 
-	for (int32_t i=6; i>=0; i--) {
-		workBits = (workBits << 64);
-		uint64_t hash=sipHash::siphash24(prePow[0],prePow[1],prePow[2],prePow[3],(index << 3)+i);
-		workBits |= hash; 		
+// OR the value into the 512-bit buffer at the given bit position, the overflowing bits are dropped
+void orBits(uint64_t* w, uint32_t pos, uint64_t val) {
+	uint32_t i = pos / 64;
+	uint32_t shift = pos % 64;
+
+	if (i < 8) {
+		w[i] |= val << shift;
+		if (shift && (i+1 < 8)) w[i+1] |= val >> (64-shift);
+	}
+}
+
+} // namespace
+
+stepElem::stepElem(const uint64_t * prePow, uint32_t index) {
+	for (uint32_t i=0; i<workWordSize; i++) {
+		workWords[i] = sipHash::siphash24(prePow[0],prePow[1],prePow[2],prePow[3],(index << 3)+i);
 	}
 
 	indexTree.assign(1, index);
@@ -55,69 +83,58 @@ stepElem::stepElem(const uint64_t * prePow, uint32_t index) {
 
 stepElem::stepElem(const stepElem &a, const stepElem &b, uint32_t remLen) {
 	// Create a new rounds step element from matching two ancestors
-	workBits.reset();
-
-	workBits = a.workBits ^ b.workBits;
-	workBits = (workBits >> collisionBitSize);
-
-	std::bitset<workBitSize> mask;
-	mask.set();
-	mask = (mask >> (workBitSize-remLen));
-	workBits &= mask;
-
-	if (a.indexTree[0] < b.indexTree[0]) {
-		indexTree.insert(indexTree.end(), a.indexTree.begin(), a.indexTree.end());
-		indexTree.insert(indexTree.end(), b.indexTree.begin(), b.indexTree.end());
-	} else {
-		indexTree.insert(indexTree.end(), b.indexTree.begin(), b.indexTree.end());
-		indexTree.insert(indexTree.end(), a.indexTree.begin(), a.indexTree.end());
-	} 
+	for (uint32_t i=0; i<workWordSize; i++) {
+		workWords[i] = a.workWords[i] ^ b.workWords[i];
+	}
+
+	shiftAndMask(workWords, remLen);
+
+	const stepElem& first = (a.indexTree[0] < b.indexTree[0]) ? a : b;
+	const stepElem& second = (a.indexTree[0] < b.indexTree[0]) ? b : a;
+
+	indexTree.reserve(first.indexTree.size() + second.indexTree.size());
+	indexTree.insert(indexTree.end(), first.indexTree.begin(), first.indexTree.end());
+	indexTree.insert(indexTree.end(), second.indexTree.begin(), second.indexTree.end());
 }
 
 void stepElem::applyMix(uint32_t remLen) {
-	std::bitset<512> tempBits(workBits.to_string());
+	uint64_t tempBits[8];
+	for (uint32_t i=0; i<workWordSize; i++) tempBits[i] = workWords[i];
+	for (uint32_t i=workWordSize; i<8; i++) tempBits[i] = 0;
 
 	// Add in the bits of the index tree to the end of work bits
 	uint32_t padNum = ((512-remLen) + collisionBitSize) / (collisionBitSize + 1);
 	padNum = std::min(padNum, static_cast<uint32_t>(indexTree.size()));
 
 	for (uint32_t i=0; i<padNum; i++) {
-		std::bitset<512> tmp(indexTree[i]);
-		tmp = tmp << (remLen+i*(collisionBitSize + 1));
-		tempBits |= tmp;
+		orBits(tempBits, remLen+i*(collisionBitSize + 1), indexTree[i]);
 	}
 
 
 	// Applyin the mix from the lined up bits
-	std::bitset<512> mask(0xFFFFFFFFFFFFFFFFUL);
 	uint64_t result = 0;
 	for (uint32_t i=0; i<8; i++) {
-		uint64_t tmp = (tempBits & mask).to_ullong();
-		tempBits = tempBits >> 64;
-
-		result += sipHash::rotl(tmp, (29*(i+1)) & 0x3F);
+		result += sipHash::rotl(tempBits[i], (29*(i+1)) & 0x3F);
 	}
 	result = sipHash::rotl(result, 24);
 
 
 	// Wipe out lowest 64 bits in favor of the mixed bits
-	workBits = (workBits >> 64);
-	workBits = (workBits << 64);
-	workBits |= std::bitset<workBitSize>(result);
+	workWords[0] = result;
 }
 
 uint32_t stepElem::getCollisionBits() const {
-	std::bitset<workBitSize> mask((1 << collisionBitSize) - 1);
-	return (uint32_t) (workBits & mask).to_ullong();
+	return (uint32_t) (workWords[0] & ((1 << collisionBitSize) - 1));
 }
 
 bool stepElem::isZero() {
-	return workBits.none();
+	uint64_t acc = 0;
+	for (uint32_t i=0; i<workWordSize; i++) acc |= workWords[i];
+	return !acc;
 }
 
-uint64_t getLowBits(stepElem test) {
-	std::bitset<workBitSize> mask(~0ULL);
-	return (uint64_t) (test.workBits & mask).to_ullong();
+uint64_t getLowBits(const stepElem& test) {
+	return test.workWords[0];
 }
 /********
 
@@ -154,39 +171,40 @@ bool sortStepElement(const stepElem &a, const stepElem &b) {
 
 ********/
 
-std::vector<uint32_t> GetIndicesFromMinimal(std::vector<uint8_t> soln) {
-	std::bitset<800> inStream;
-	std::bitset<800> mask((1 << (collisionBitSize+1))-1);
+std::vector<uint32_t> GetIndicesFromMinimal(const std::vector<uint8_t>& soln) {
+	// 32 indices, 25 bits each, packed little-endian into the first 100 bytes
+	const uint32_t indexBits = collisionBitSize+1;
 
-	inStream.reset();
-	for (int32_t i = 99; i>=0; i--) {
-		inStream = (inStream << 8);
-		inStream |= (uint64_t) soln[i];
-	}
-
-	std::vector<uint32_t> res;
+	std::vector<uint32_t> res(32);
 	for (uint32_t i=0; i<32; i++) {
-		res.push_back((uint32_t) (inStream & mask).to_ullong() );
-		inStream = (inStream >> (collisionBitSize+1));
+		uint32_t pos = i*indexBits;
+
+		uint64_t val = 0;
+		for (uint32_t k=0; (k<5) && (pos/8+k < 100); k++) {
+			val |= ((uint64_t) soln[pos/8+k]) << (8*k);
+		}
+
+		res[i] = (uint32_t) ((val >> (pos%8)) & ((1 << indexBits)-1));
 	}
 
 	return res;
 }
 
-std::vector<uint8_t> GetMinimalFromIndices(std::vector<uint32_t> sol) {
-	std::bitset<800> inStream;
-	std::bitset<800> mask(0xFF);
+std::vector<uint8_t> GetMinimalFromIndices(const std::vector<uint32_t>& sol) {
+	const uint32_t indexBits = collisionBitSize+1;
+
+	uint64_t outStream[13] = {0}; // 800 bits, rounded up
+	for (uint32_t i=0; (i<sol.size()) && (i*indexBits < 800); i++) {
+		uint32_t pos = i*indexBits;
+		uint64_t val = sol[i] & ((1ULL << indexBits)-1);
 
-	inStream.reset();
-	for (int32_t i = static_cast<uint32_t>(sol.size()); i>=0; i--) {
-		inStream = (inStream << (collisionBitSize+1));
-		inStream |= (uint64_t) sol[i];
+		outStream[pos/64] |= val << (pos%64);
+		if ((pos%64) && (pos/64+1 < 13)) outStream[pos/64+1] |= val >> (64-pos%64);
 	}
 
-	std::vector<uint8_t> res;
+	std::vector<uint8_t> res(100);
 	for (uint32_t i=0; i<100; i++) {
-		res.push_back((uint8_t) (inStream & mask).to_ullong() );
-		inStream = (inStream >> 8);
+		res[i] = (uint8_t) (outStream[i/8] >> (8*(i%8)));
 	}
 
 	return res;
@@ -226,6 +244,7 @@ bool BeamHash_III::IsValidSolution(const blake2b_state& base_state, std::vector<
 	std::vector<uint32_t> indices = GetIndicesFromMinimal(soln);
 
 	std::vector<stepElem> X;
+	X.reserve(indices.size());
 	for (uint32_t i=0; i<indices.size(); i++) {
 		X.emplace_back(&prePow[0], indices[i]);
 	}
@@ -233,6 +252,7 @@ bool BeamHash_III::IsValidSolution(const blake2b_state& base_state, std::vector<
 	uint32_t round=1;
 	while (X.size() > 1) {
 		std::vector<stepElem> Xtmp;
+		Xtmp.reserve(X.size() / 2);
 
 		for (size_t i = 0; i < X.size(); i += 2) {
 			uint32_t remLen = workBitSize-(round-1)*collisionBitSize;
@@ -263,7 +283,7 @@ bool BeamHash_III::IsValidSolution(const blake2b_state& base_state, std::vector<
 			Xtmp.emplace_back(X[i], X[i+1], remLen);
 		}
 
-		X = Xtmp;
+		X.swap(Xtmp);
 		round++;
 	}
 
@@ -331,7 +351,7 @@ bool BeamHash_III::OptimisedSolve(const blake2b_state& base_state,
 			if (cancelled(ListColliding)) throw beamSolverCancelled;
 		}
 
-		elements = outElements;	
+		elements.swap(outElements);	
 	}
 
 	// Check the output of the last round for solutions
@@ -57,7 +57,7 @@ void CL_CALLBACK CCallbackFunc(cl_event ev, cl_int err , void* data) {
 
 
 // Function to load the OpenCL kernel and prepare our device for mining
-void clHost::loadAndCompileKernel(cl::Device &device, uint32_t pl) {
+void clHost::loadAndCompileKernel(cl::Device &device, uint32_t pl, const string& name) {
 	LOG_INFO() << "Loading and compiling Beam OpenCL Kernel";
 
 	// reading the kernel file
@@ -92,7 +92,13 @@ void clHost::loadAndCompileKernel(cl::Device &device, uint32_t pl) {
 		results.push_back(NULL);
 		currentWork.push_back(clCallbackData());
 		paused.push_back(true);
+		deviceNames.push_back(name);
 		solutionCnt.push_back(0);
+		iterationStart.push_back(clock::now());
+		lastIterationMs.push_back(0);
+		bestIterationMs.push_back(0);
+		stats.push_back(clDeviceStats());
+		stats.back().name = name;
 
 		// Create the kernels
 		vector<cl::Kernel> newKernels;	
@@ -182,7 +188,7 @@ void clHost::detectPlatFormDevices(vector<int32_t> selDev, bool allowCPU) {
 
 				if (deviceMemory > needed) {
 					LOG_INFO() << "Memory check ok";
-					loadAndCompileKernel(nDev[di], pl);
+					loadAndCompileKernel(nDev[di], pl, name);
 				} else {
 					LOG_INFO() << "Memory check failed";
 					LOG_INFO() << "Device reported " << deviceMemory / (1024*1024) << "MByte memory, " << needed/(1024*1024) << " are required ";
@@ -211,8 +217,8 @@ void clHost::queueKernels(uint32_t gpuIndex, clCallbackData* workData) {
 	cl_ulong4 work;	
 	cl_ulong nonce;
 
-	// Get a new set of work from the stratum interface
-	bridge->getWork(&id,(uint64_t *) &nonce, (uint8_t *) &work, &difficulty);
+	// Get a new set of work from the stratum interface, the nonce comes from this device's own range
+	bridge->getDeviceWork(gpuIndex, &id,(uint64_t *) &nonce, (uint8_t *) &work, &difficulty);
 
 	workData->workId = id;
 	workData->nonce = (uint64_t) nonce;
@@ -279,6 +285,39 @@ void clHost::queueKernels(uint32_t gpuIndex, clCallbackData* workData) {
 }
 
 
+// Queue the next iteration on a device and arrange the callback for its results
+void clHost::runDevice(uint32_t gpu) {
+	if (results[gpu] != NULL) {
+		queues[gpu].enqueueUnmapMemObject(buffers[gpu][6], results[gpu], NULL, NULL);
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(statsMutex);
+		iterationStart[gpu] = clock::now();
+	}
+
+	queueKernels(gpu, &currentWork[gpu]);
+	results[gpu] = (unsigned *) queues[gpu].enqueueMapBuffer(buffers[gpu][6], CL_FALSE, CL_MAP_READ, 0, sizeof(cl_uint4) * 81, NULL, &events[gpu], NULL);
+	events[gpu].setCallback(CL_COMPLETE, &CCallbackFunc, (void*) &currentWork[gpu]);
+	queues[gpu].flush();
+}
+
+
+// Account a finished iteration. A device that takes noticeably longer than its best run
+// is most likely clocked down (thermal or power limit), OpenCL has no portable way to ask
+void clHost::updateStats(uint32_t gpu, uint32_t solutions) {
+	std::lock_guard<std::mutex> lock(statsMutex);
+
+	solutionCnt[gpu] += solutions;
+
+	double ms = std::chrono::duration<double, std::milli>(clock::now() - iterationStart[gpu]).count();
+	lastIterationMs[gpu] = ms;
+	if ((bestIterationMs[gpu] == 0) || (ms < bestIterationMs[gpu])) {
+		bestIterationMs[gpu] = ms;
+	}
+}
+
+
 // this function will sumit the solutions done on GPU, then fetch new work and restart mining
 void clHost::callbackFunc(cl_int err , void* data){
 	clCallbackData* workInfo = (clCallbackData*) data;
@@ -294,15 +333,12 @@ void clHost::callbackFunc(cl_int err , void* data){
 		bridge->handleSolution(workInfo->workId,workInfo->nonce,indexes, workInfo->difficulty);
 	}
 
-	solutionCnt[gpu] += solutions;
+	updateStats(gpu, solutions);
 
-	// Get new work and resume working
+	// Get new work and resume working. A job switch needs nothing special: the next iteration
+	// simply picks up the new input, so the queues never run dry
 	if (bridge->hasWork() && restart) {
-		queues[gpu].enqueueUnmapMemObject(buffers[gpu][6], results[gpu], NULL, NULL);
-		queueKernels(gpu, &currentWork[gpu]);
-		results[gpu] = (unsigned *) queues[gpu].enqueueMapBuffer(buffers[gpu][6], CL_FALSE, CL_MAP_READ, 0, sizeof(cl_uint4) * 81, NULL, &events[gpu], NULL);
-		events[gpu].setCallback(CL_COMPLETE, &CCallbackFunc, (void*) &currentWork[gpu]);
-		queues[gpu].flush();
+		runDevice(gpu);
 	} else {
 		paused[gpu] = true;
 		LOG_INFO() << "Device will be paused, waiting for new work";
@@ -312,6 +348,23 @@ void clHost::callbackFunc(cl_int err , void* data){
 void clHost::stopMining()
 {
     restart = false;
+    workChanged();
+}
+
+// Called by the bridge owner when new work is available, paused devices are resumed right away
+void clHost::workChanged()
+{
+	{
+		std::lock_guard<std::mutex> lock(wakeMutex);
+		workPending = true;
+	}
+	wakeCond.notify_one();
+}
+
+void clHost::getStats(vector<clDeviceStats>& out) const
+{
+	std::lock_guard<std::mutex> lock(statsMutex);
+	out = stats;
 }
 
 void clHost::startMining()
@@ -323,40 +376,51 @@ void clHost::startMining()
 
 		currentWork[i].gpuIndex = i;
 		currentWork[i].host = (void*) this;
-		queueKernels(i, &currentWork[i]);
-
-		results[i] = (unsigned *) queues[i].enqueueMapBuffer(buffers[i][6], CL_FALSE, CL_MAP_READ, 0, sizeof(cl_uint4) * 81, NULL, &events[i], NULL);
-		events[i].setCallback(CL_COMPLETE, &CCallbackFunc, (void*) &currentWork[i]);
-		queues[i].flush();
+		runDevice(i);
 	}
 
+	const auto statsPeriod = std::chrono::seconds(15);
+	auto statsTime = clock::now();
+
 	// While the mining is running print some statistics
 	while (restart) {
-		this_thread::sleep_for(std::chrono::seconds(15));
-
-		// Print performance stats (roughly)
-        stringstream ss;
-		
-        for (uint32_t i = 0; i < devices.size(); i++) {
-            uint32_t sol = solutionCnt[i];
-            solutionCnt[i] = 0;
-            ss << fixed << setprecision(2) << (double)sol / 15.0 << " sol/s ";
-        }
-        LOG_INFO() << "Performance: " << ss.str();
+		{
+			std::unique_lock<std::mutex> lock(wakeMutex);
+			wakeCond.wait_until(lock, statsTime + statsPeriod, [this] { return workPending; });
+			workPending = false;
+		}
+
+		auto now = clock::now();
+		if (now >= statsTime + statsPeriod) {
+			double period = std::chrono::duration<double>(now - statsTime).count();
+			statsTime = now;
+
+			// Print performance stats (roughly)
+			stringstream ss;
+			{
+				std::lock_guard<std::mutex> lock(statsMutex);
+				for (uint32_t i = 0; i < devices.size(); i++) {
+					clDeviceStats& s = stats[i];
+					s.solPerSec = (double) solutionCnt[i] / period;
+					s.iterationMs = lastIterationMs[i];
+					s.throttled = lastIterationMs[i] > bestIterationMs[i] * 1.2;
+					solutionCnt[i] = 0;
+
+					ss << fixed << setprecision(2) << "[" << i << "] " << s.solPerSec << " sol/s ";
+					if (s.throttled) {
+						ss << "(throttled, " << setprecision(0) << s.iterationMs << " ms/iter) ";
+					}
+				}
+			}
+			LOG_INFO() << "Performance: " << ss.str();
+		}
 
 		// Check if there are paused devices and restart them
 		for (uint32_t i=0; i<devices.size(); i++) {
 			if (paused[i] && bridge->hasWork() && restart) {
 				paused[i] = false;
-				
-				// Same as above
-				queueKernels(i, &currentWork[i]);
-
-				results[i] = (unsigned *) queues[i].enqueueMapBuffer(buffers[i][6], CL_FALSE, CL_MAP_READ, 0, sizeof(cl_uint4) * 81, NULL, &events[i], NULL);
-				events[i].setCallback(CL_COMPLETE, &CCallbackFunc, (void*) &currentWork[i]);
-				queues[i].flush();
+				runDevice(i);
 			}
-
 		}
 	}
 
@@ -34,6 +34,10 @@
 #include <map>
 #include <cstdlib>
 #include <climits>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
 
 namespace beamMiner {
 
@@ -47,6 +51,13 @@ struct clCallbackData {
     uint32_t difficulty;
 };
 
+struct clDeviceStats {
+	std::string name;
+	double solPerSec = 0;		// over the last reporting period
+	double iterationMs = 0;		// duration of the last kernel run
+	bool throttled = false;		// the last run was noticeably slower than the best one seen
+};
+
 class clHost {
 	private:
 	// OpenCL 
@@ -61,19 +72,33 @@ class clHost {
 	vector< vector<cl::Kernel> > kernels;
 
 	// Statistics
-	vector<int> solutionCnt;
+	typedef std::chrono::steady_clock clock;
+	vector<std::string> deviceNames;
+	vector<uint32_t> solutionCnt;
+	vector<clock::time_point> iterationStart;
+	vector<double> lastIterationMs;
+	vector<double> bestIterationMs;
+	vector<clDeviceStats> stats;
+	mutable std::mutex statsMutex;
 
 	// To check if a mining thread stoped and we must resume it
 	vector<bool> paused;
 
+	// Wakes the statistics loop so paused devices resume as soon as work arrives
+	std::mutex wakeMutex;
+	std::condition_variable wakeCond;
+	bool workPending = false;
+
 	// Callback data
 	vector<clCallbackData> currentWork;
     std::atomic<bool> restart = true;
 
 	// Functions
 	void detectPlatFormDevices(vector<int32_t>, bool);
-	void loadAndCompileKernel(cl::Device &, uint32_t);
+	void loadAndCompileKernel(cl::Device &, uint32_t, const std::string&);
 	void queueKernels(uint32_t, clCallbackData*);
+	void runDevice(uint32_t);
+	void updateStats(uint32_t, uint32_t);
 	
 	// The connector
 	minerBridge* bridge;
@@ -83,6 +108,8 @@ class clHost {
 	void setup(minerBridge*, vector<int32_t>, bool);
 	void startMining();	
     void stopMining();
+	void workChanged();
+	void getStats(vector<clDeviceStats>&) const;
 	void callbackFunc(cl_int, void*);
     ~clHost();
 };
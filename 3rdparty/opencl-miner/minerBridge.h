@@ -15,6 +15,11 @@ public:
     virtual bool hasWork() = 0;
     virtual void getWork(int64_t*, uint64_t*, uint8_t*, uint32_t*) = 0;
 
+    // Per-device variant, lets the bridge give every device its own nonce range
+    virtual void getDeviceWork(uint32_t, int64_t* workOut, uint64_t* nonceOut, uint8_t* dataOut, uint32_t* difficulty) {
+        getWork(workOut, nonceOut, dataOut, difficulty);
+    }
+
     virtual void handleSolution(int64_t&, uint64_t&, std::vector<uint32_t>&, uint32_t) = 0;
 };
 
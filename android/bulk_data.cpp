@@ -0,0 +1,95 @@
+// Copyright 2018-2024 The Beam Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "bulk_data.h"
+#include <cassert>
+#include <cstdlib>
+#include <cstring>
+
+BulkWriter::BulkWriter(size_t count)
+    : m_Count(static_cast<uint32_t>(count))
+{
+    m_Data.resize(sizeof(uint32_t) * (2 + count));
+    Put32(0, s_Version);
+    Put32(sizeof(uint32_t), m_Count);
+}
+
+void BulkWriter::Put32(size_t pos, uint32_t val)
+{
+    for (size_t i = 0; i < sizeof(val); i++, val >>= 8)
+        m_Data[pos + i] = static_cast<uint8_t>(val);
+}
+
+void BulkWriter::WriteRaw(const void* p, size_t n)
+{
+    const uint8_t* pSrc = reinterpret_cast<const uint8_t*>(p);
+    m_Data.insert(m_Data.end(), pSrc, pSrc + n);
+}
+
+void BulkWriter::BeginRecord()
+{
+    assert(m_Record < m_Count);
+    Put32(sizeof(uint32_t) * (2 + m_Record), static_cast<uint32_t>(m_Data.size()));
+    m_Record++;
+}
+
+void BulkWriter::WriteLong(int64_t val)
+{
+    uint64_t x = static_cast<uint64_t>(val);
+    for (size_t i = 0; i < sizeof(x); i++, x >>= 8)
+        m_Data.push_back(static_cast<uint8_t>(x));
+}
+
+void BulkWriter::WriteInt(int32_t val)
+{
+    size_t pos = m_Data.size();
+    m_Data.resize(pos + sizeof(uint32_t));
+    Put32(pos, static_cast<uint32_t>(val));
+}
+
+void BulkWriter::WriteBool(bool val)
+{
+    m_Data.push_back(val ? 1 : 0);
+}
+
+void BulkWriter::WriteString(const std::string& s)
+{
+    WriteInt(static_cast<int32_t>(s.size()));
+    WriteRaw(s.data(), s.size());
+}
+
+jobject BulkWriter::Detach(JNIEnv* env)
+{
+    assert(m_Record == m_Count);
+    if (!m_Count)
+        return nullptr;
+
+    // malloc'ed, since the buffer outlives the writer, and is freed by its address only
+    void* p = malloc(m_Data.size());
+    if (!p)
+        return nullptr;
+
+    memcpy(p, m_Data.data(), m_Data.size());
+    jobject buffer = env->NewDirectByteBuffer(p, static_cast<jlong>(m_Data.size()));
+    if (!buffer)
+        free(p);
+
+    return buffer;
+}
+
+void BulkWriter::Release(JNIEnv* env, jobject buffer)
+{
+    if (buffer)
+        free(env->GetDirectBufferAddress(buffer));
+}
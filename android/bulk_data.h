@@ -0,0 +1,56 @@
+// Copyright 2018-2024 The Beam Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include <jni.h>
+
+// Compact encoding of the bulk lists (coins, addresses), handed to Java as a direct ByteBuffer in a single call,
+// instead of a JNI object per item and a JNI call per field. Decoded on demand by entities/BulkData.java.
+//
+// Layout (little-endian):
+//    u32 version
+//    u32 count
+//    u32 offset[count] - record offsets, from the buffer start
+//    records
+// Record fields are i64, i32, u8 (bool), or string: u32 size + UTF-8 bytes.
+class BulkWriter
+{
+public:
+    static const uint32_t s_Version = 1;
+
+    explicit BulkWriter(size_t count);
+
+    void BeginRecord();
+
+    void WriteLong(int64_t);
+    void WriteInt(int32_t);
+    void WriteBool(bool);
+    void WriteString(const std::string&);
+
+    // The buffer memory is owned by Java, and must be freed by Wallet.releaseBulkData(). Returns null if empty.
+    jobject Detach(JNIEnv*);
+    static void Release(JNIEnv*, jobject buffer);
+
+private:
+    std::vector<uint8_t> m_Data;
+    uint32_t m_Count;
+    uint32_t m_Record = 0;
+
+    void WriteRaw(const void*, size_t);
+    void Put32(size_t pos, uint32_t);
+};
@@ -0,0 +1,135 @@
+// Copyright 2018-2024 The Beam Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+package com.mw.beam.beamwallet.core.entities;
+
+import com.mw.beam.beamwallet.core.entities.dto.UtxoDTO;
+import com.mw.beam.beamwallet.core.entities.dto.WalletAddressDTO;
+
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+import java.nio.charset.StandardCharsets;
+
+// Reader of the encoded lists passed to the WalletListener.on*Bulk callbacks (see android/bulk_data.h).
+// The records are decoded on access, so a long list costs nothing until it's displayed.
+// The buffer refers to the native memory, which must be freed by Wallet.releaseBulkData() once not needed.
+public class BulkData
+{
+    public static final int VERSION = 1;
+
+    private final ByteBuffer buffer;
+    private final int count;
+    private int pos;
+
+    public BulkData(ByteBuffer buffer)
+    {
+        if (buffer == null)
+        {
+            this.buffer = null;
+            this.count = 0;
+            return;
+        }
+
+        this.buffer = buffer.duplicate().order(ByteOrder.LITTLE_ENDIAN);
+        if (this.buffer.getInt(0) != VERSION)
+            throw new IllegalStateException("unsupported bulk data version");
+
+        this.count = this.buffer.getInt(4);
+    }
+
+    public int getCount()
+    {
+        return count;
+    }
+
+    public UtxoDTO getUtxo(int i)
+    {
+        seek(i);
+
+        UtxoDTO utxo = new UtxoDTO();
+        utxo.id = readLong();
+        utxo.stringId = readString();
+        utxo.amount = readLong();
+        utxo.status = readInt();
+        utxo.maturity = readLong();
+        utxo.keyType = readInt();
+        utxo.confirmHeight = readLong();
+        utxo.assetId = readInt();
+        utxo.isShielded = readBoolean();
+        utxo.createTxId = readOptString();
+        utxo.spentTxId = readOptString();
+        return utxo;
+    }
+
+    public WalletAddressDTO getAddress(int i)
+    {
+        seek(i);
+
+        WalletAddressDTO addr = new WalletAddressDTO();
+        addr.walletID = readString();
+        addr.identity = readString();
+        addr.label = readString();
+        addr.category = readString();
+        addr.createTime = readLong();
+        addr.duration = readLong();
+        addr.own = readLong();
+        addr.address = readString();
+        return addr;
+    }
+
+    private void seek(int i)
+    {
+        if (i < 0 || i >= count)
+            throw new IndexOutOfBoundsException();
+
+        pos = buffer.getInt(8 + 4 * i);
+    }
+
+    private long readLong()
+    {
+        long val = buffer.getLong(pos);
+        pos += 8;
+        return val;
+    }
+
+    private int readInt()
+    {
+        int val = buffer.getInt(pos);
+        pos += 4;
+        return val;
+    }
+
+    private boolean readBoolean()
+    {
+        return buffer.get(pos++) != 0;
+    }
+
+    private String readString()
+    {
+        int size = readInt();
+        byte[] bytes = new byte[size];
+        ByteBuffer src = buffer.duplicate();
+        src.position(pos);
+        src.get(bytes);
+        pos += size;
+        return new String(bytes, StandardCharsets.UTF_8);
+    }
+
+    // empty means absent, same as the unset field of the object path
+    private String readOptString()
+    {
+        String s = readString();
+        return s.isEmpty() ? null : s;
+    }
+}
@@ -56,6 +56,12 @@ public class Wallet
     
     public native void getExchangeRates();
 
+    // poll the node and batch the secondary updates while the app is in background
+    public native void setBackgroundMode(boolean isBackground);
+    // coins and addresses come to the WalletListener.on*Bulk callbacks, see BulkData
+    public native void setBulkDataMode(boolean enable);
+    public native void releaseBulkData(java.nio.ByteBuffer buffer);
+
     // deprecated
     public native void saveAddressChanges(String addr, String name, boolean isNever, boolean makeActive, boolean makeExpired);
 
@@ -25,6 +25,7 @@ public class WalletAddressDTO
     public long duration;
     public long own;
     public String identity;
+    public String address;
 
     public enum WalletAddressExpirationStatus
     {
@@ -24,6 +24,7 @@ import com.mw.beam.beamwallet.core.entities.dto.ExchangeRateDTO;
 import com.mw.beam.beamwallet.core.entities.dto.VersionInfoDTO;
 
 import com.mw.beam.beamwallet.core.entities.Wallet;
+import com.mw.beam.beamwallet.core.entities.BulkData;
 
 public class WalletListener
 {
@@ -119,6 +120,37 @@ public class WalletListener
 		}
 	}
 
+	static void onNormalUtxoChangedBulk(int action, java.nio.ByteBuffer buffer)
+	{
+		BulkData data = new BulkData(buffer);
+		System.out.println(">>>>>>>>>>>>>> async onNormalUtxoChangedBulk in Java, count: " + data.getCount());
+
+		for(int i = 0; i < data.getCount(); i++)
+		{
+			UtxoDTO utxo = data.getUtxo(i);
+			System.out.println("| " + utxo.id + "\t| " + utxo.amount + "\t| " + utxo.keyType);
+		}
+
+		wallet.releaseBulkData(buffer);
+	}
+
+	static void onAllShieldedUtxoChangedBulk(int action, java.nio.ByteBuffer buffer)
+	{
+		System.out.println(">>>>>>>>>>>>>> async onAllShieldedUtxoChangedBulk in Java, count: " + new BulkData(buffer).getCount());
+		wallet.releaseBulkData(buffer);
+	}
+
+	static void onAddressesChangedBulk(int action, java.nio.ByteBuffer buffer)
+	{
+		BulkData data = new BulkData(buffer);
+		System.out.println(">>>>>>>>>>>>>> async onAddressesChangedBulk in Java, count: " + data.getCount());
+
+		for(int i = 0; i < data.getCount(); i++)
+			System.out.println(data.getAddress(i).walletID);
+
+		wallet.releaseBulkData(buffer);
+	}
+
 	static void onAddresses(boolean own, WalletAddressDTO[] addresses)
 	{
 		System.out.println(">>>>>>>>>>> onAddresses(" + own + ") called");
@@ -13,6 +13,8 @@
 // limitations under the License.
 
 #include "common.h"
+#include <map>
+#include <mutex>
 
 JavaVM* JVM = nullptr;
 
@@ -61,6 +63,25 @@ namespace
     };
 }
 
+jfieldID getFieldID(JNIEnv* env, jclass clazz, const char* name, const char* sig)
+{
+    static std::mutex s_Mutex;
+    static std::map<std::pair<jclass, const char*>, jfieldID> s_Map;
+
+    std::unique_lock<std::mutex> lock(s_Mutex);
+
+    auto key = std::make_pair(clazz, name);
+    auto it = s_Map.find(key);
+    if (s_Map.end() != it)
+        return it->second;
+
+    jfieldID fieldId = env->GetFieldID(clazz, name, sig);
+    if (fieldId)
+        s_Map[key] = fieldId;
+
+    return fieldId;
+}
+
 JNIEnv* Android_JNI_getEnv(void)
 {
     static thread_local ThreadJNIEnv env;
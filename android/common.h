@@ -51,6 +51,9 @@ extern jclass ContractConsetClass;
 
 JNIEnv* Android_JNI_getEnv(void);
 
+// GetFieldID with a cache, the lists are converted field by field. The class must be a global ref, the name a literal
+jfieldID getFieldID(JNIEnv* env, jclass clazz, const char* name, const char* sig);
+
 struct JString
 {
     JString(JNIEnv *envVal, jstring nameVal)
@@ -83,27 +86,27 @@ private:
 
 inline void setByteField(JNIEnv *env, jclass clazz, jobject obj, const char* name, jbyte value)
 {
-    env->SetByteField(obj, env->GetFieldID(clazz, name, "B"), value);
+    env->SetByteField(obj, getFieldID(env, clazz, name, "B"), value);
 }
 
 inline void setLongField(JNIEnv *env, jclass clazz, jobject obj, const char* name, jlong value)
 {
-    env->SetLongField(obj, env->GetFieldID(clazz, name, "J"), value);
+    env->SetLongField(obj, getFieldID(env, clazz, name, "J"), value);
 }
 
 inline void setIntField(JNIEnv *env, jclass clazz, jobject obj, const char* name, jint value)
 {
-    env->SetIntField(obj, env->GetFieldID(clazz, name, "I"), value);
+    env->SetIntField(obj, getFieldID(env, clazz, name, "I"), value);
 }
 
 inline void setBooleanField(JNIEnv *env, jclass clazz, jobject obj, const char* name, jboolean value)
 {
-    env->SetBooleanField(obj, env->GetFieldID(clazz, name, "Z"), value);
+    env->SetBooleanField(obj, getFieldID(env, clazz, name, "Z"), value);
 }
 
 inline void setStringField(JNIEnv *env, jclass clazz, jobject obj, const char* name, const std::string& value)
 {
-    jfieldID fieldId = env->GetFieldID(clazz, name, "Ljava/lang/String;");
+    jfieldID fieldId = getFieldID(env, clazz, name, "Ljava/lang/String;");
     jstring str = env->NewStringUTF(value.c_str());
     env->SetObjectField(obj, fieldId, str);
 
@@ -120,7 +123,7 @@ inline void setByteArrayField(JNIEnv *env, jclass clazz, jobject obj, const char
 
         memcpy(hashBytes, &value[0], value.size());
 
-        env->SetObjectField(obj, env->GetFieldID(clazz, name, "[B"), hash);
+        env->SetObjectField(obj, getFieldID(env, clazz, name, "[B"), hash);
 
         env->ReleaseByteArrayElements(hash, hashBytes, 0);
         env->DeleteLocalRef(hash);
@@ -137,28 +140,28 @@ inline void setByteArrayField<ECC::uintBig>(JNIEnv *env, jclass clazz, jobject o
 
 inline std::string getStringField(JNIEnv *env, jclass clazz, jobject obj, const char* name)
 {
-    jfieldID fieldId = env->GetFieldID(clazz, name, "Ljava/lang/String;");
+    jfieldID fieldId = getFieldID(env, clazz, name, "Ljava/lang/String;");
 
     return JString(env, (jstring)env->GetObjectField(obj, fieldId)).value();
 }
 
 inline jlong getLongField(JNIEnv *env, jclass clazz, jobject obj, const char* name)
 {
-    jfieldID fieldId = env->GetFieldID(clazz, name, "J");
+    jfieldID fieldId = getFieldID(env, clazz, name, "J");
 
     return env->GetLongField(obj, fieldId);
 }
 
 inline jboolean getBooleanField(JNIEnv *env, jclass clazz, jobject obj, const char* name)
 {
-    jfieldID fieldId = env->GetFieldID(clazz, name, "Z");
+    jfieldID fieldId = getFieldID(env, clazz, name, "Z");
 
     return env->GetBooleanField(obj, fieldId);
 }
 
 inline jsize getByteArrayField(JNIEnv *env, jclass clazz, jobject obj, const char* name, uint8_t* value)
 {
-    jfieldID fieldId = env->GetFieldID(clazz, name, "[B");
+    jfieldID fieldId = getFieldID(env, clazz, name, "[B");
     jbyteArray byteArray = (jbyteArray)env->GetObjectField(obj, fieldId);
 
     jbyte* data = env->GetByteArrayElements(byteArray, NULL);
@@ -1034,6 +1034,21 @@ JNIEXPORT void JNICALL BEAM_JAVA_WALLET_INTERFACE(enableBodyRequests)(JNIEnv *en
     walletModel->getAsync()->enableBodyRequests(enable);
 }
 
+JNIEXPORT void JNICALL BEAM_JAVA_WALLET_INTERFACE(setBackgroundMode)(JNIEnv *env, jobject thiz, jboolean isBackground)
+{
+    walletModel->setBackgroundMode(isBackground);
+}
+
+JNIEXPORT void JNICALL BEAM_JAVA_WALLET_INTERFACE(setBulkDataMode)(JNIEnv *env, jobject thiz, jboolean enable)
+{
+    walletModel->setBulkDataMode(enable);
+}
+
+JNIEXPORT void JNICALL BEAM_JAVA_WALLET_INTERFACE(releaseBulkData)(JNIEnv *env, jobject thiz, jobject buffer)
+{
+    BulkWriter::Release(env, buffer);
+}
+
 JNIEXPORT void JNICALL BEAM_JAVA_WALLET_INTERFACE(exportTxHistoryToCsv)(JNIEnv *env, jobject thiz)
 {
     walletModel->getAsync()->exportTxHistoryToCsv();
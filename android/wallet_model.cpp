@@ -344,6 +344,64 @@ namespace
         return utxos;
     }
 
+    // The field order matches BulkData.getUtxo()
+    void writeCoin(BulkWriter& w, const Coin& coin)
+    {
+        w.BeginRecord();
+        w.WriteLong(coin.m_ID.m_Idx);
+        w.WriteString(coin.toStringID());
+        w.WriteLong(coin.m_ID.m_Value);
+        w.WriteInt(coin.m_status);
+        w.WriteLong(coin.m_maturity);
+        w.WriteInt(static_cast<int32_t>(coin.m_ID.m_Type));
+        w.WriteLong(coin.m_confirmHeight);
+        w.WriteInt(coin.getAssetID());
+        w.WriteBool(false);
+        w.WriteString(coin.m_createTxId ? txIDToString(*coin.m_createTxId) : std::string());
+        w.WriteString(coin.m_spentTxId ? txIDToString(*coin.m_spentTxId) : std::string());
+    }
+
+    void writeShieldedCoin(BulkWriter& w, const ShieldedCoin& coin)
+    {
+        int32_t status = 0;
+        switch (coin.m_Status)
+        {
+        case ShieldedCoin::Available: status = 1; break;
+        case ShieldedCoin::Maturing: status = 2; break;
+        case ShieldedCoin::Outgoing: status = 3; break;
+        case ShieldedCoin::Incoming: status = 4; break;
+        case ShieldedCoin::Spent: status = 6; break;
+        default: break;
+        }
+
+        w.BeginRecord();
+        w.WriteLong(coin.m_spentHeight);
+        w.WriteString(std::to_string(coin.m_spentHeight));
+        w.WriteLong(coin.m_CoinID.m_Value);
+        w.WriteInt(status);
+        w.WriteLong(coin.m_confirmHeight);
+        w.WriteInt(-1);
+        w.WriteLong(coin.m_confirmHeight);
+        w.WriteInt(coin.getAssetID());
+        w.WriteBool(true);
+        w.WriteString(coin.m_createTxId ? txIDToString(*coin.m_createTxId) : std::string());
+        w.WriteString(coin.m_spentTxId ? txIDToString(*coin.m_spentTxId) : std::string());
+    }
+
+    // The field order matches BulkData.getAddress()
+    void writeAddress(BulkWriter& w, const WalletAddress& address)
+    {
+        w.BeginRecord();
+        w.WriteString(to_string(address.m_BbsAddr));
+        w.WriteString(to_string(address.m_Endpoint));
+        w.WriteString(address.m_label);
+        w.WriteString(address.m_category);
+        w.WriteLong(address.m_createTime);
+        w.WriteLong(address.m_duration);
+        w.WriteLong(address.m_OwnID);
+        w.WriteString(address.m_Token);
+    }
+
     jobjectArray convertAddressesToJObject(JNIEnv* env, const std::vector<WalletAddress>& addresses)
     {
         jobjectArray addrArray = 0;
@@ -639,6 +697,16 @@ void WalletModel::onNormalCoinsChanged(ChangeAction action, const std::vector<Co
 {
     BEAM_LOG_DEBUG() << "onNormalCoinsChanged()";
 
+    if (m_BulkData)
+    {
+        BulkWriter w(utxosVec.size());
+        for (const auto& coin : utxosVec)
+            writeCoin(w, coin);
+
+        callBulkListener("onNormalUtxoChangedBulk", action, w);
+        return;
+    }
+
     JNIEnv* env = Android_JNI_getEnv();
 
     jobjectArray utxos = convertCoinsToJObject(env, utxosVec);
@@ -653,6 +721,16 @@ void WalletModel::onAddressesChanged(ChangeAction action, const std::vector<Wall
 {
     BEAM_LOG_DEBUG() << "onAddressesChanged()";
 
+    if (m_BulkData)
+    {
+        BulkWriter w(addresses.size());
+        for (const auto& addr : addresses)
+            writeAddress(w, addr);
+
+        callBulkListener("onAddressesChangedBulk", action, w);
+        return;
+    }
+
     JNIEnv* env = Android_JNI_getEnv();
 
     jmethodID callback = env->GetStaticMethodID(WalletListenerClass, "onAddressesChanged", "(I[L" BEAM_JAVA_PATH "/entities/dto/WalletAddressDTO;)V");
@@ -664,6 +742,18 @@ void WalletModel::onAddressesChanged(ChangeAction action, const std::vector<Wall
     env->DeleteLocalRef(addrArray);
 }
 
+void WalletModel::callBulkListener(const char* szMethod, ChangeAction action, BulkWriter& w)
+{
+    JNIEnv* env = Android_JNI_getEnv();
+
+    jobject buffer = w.Detach(env);
+
+    jmethodID callback = env->GetStaticMethodID(WalletListenerClass, szMethod, "(ILjava/nio/ByteBuffer;)V");
+    env->CallStaticVoidMethod(WalletListenerClass, callback, action, buffer);
+
+    env->DeleteLocalRef(buffer);
+}
+
 void WalletModel::onAddresses(bool own, const std::vector<WalletAddress>& addresses)
 {
     BEAM_LOG_DEBUG() << "onAddresses(" << own << ")";
@@ -733,6 +823,9 @@ void WalletModel::onNodeConnectionChanged(bool isNodeConnected)
     jmethodID callback = env->GetStaticMethodID(WalletListenerClass, "onNodeConnectedStatusChanged", "(Z)V");
 
     env->CallStaticVoidMethod(WalletListenerClass, callback, isNodeConnected);    
+
+    if (isNodeConnected)
+        flushDeferred(); // the radio is up anyway
 }
 
 void WalletModel::onWalletError(ErrorType error)
@@ -883,7 +976,55 @@ void WalletModel::onExportDataToJson(const std::string& data)
     env->DeleteLocalRef(jdata);
 }
 
+void WalletModel::setBackgroundMode(bool isBackground)
+{
+    BEAM_LOG_DEBUG() << "setBackgroundMode(" << isBackground << ")";
+
+    getAsync()->setNodePollPeriod(isBackground ? s_BackgroundPollPeriod_ms : 0);
+
+    getAsync()->makeIWTCall([this, isBackground]() -> boost::any
+    {
+        m_Deferred.m_Enabled = isBackground;
+        if (!isBackground)
+            flushDeferred();
+        return {};
+    },
+    [](const boost::any&) {});
+}
+
+void WalletModel::flushDeferred()
+{
+    Deferred d;
+    std::swap(d.m_Rates, m_Deferred.m_Rates);
+    std::swap(d.m_Assets, m_Deferred.m_Assets);
+    std::swap(d.m_Notifications, m_Deferred.m_Notifications);
+
+    if (!d.m_Rates.empty())
+    {
+        std::vector<ExchangeRate> rates;
+        rates.reserve(d.m_Rates.size());
+        for (const auto& x : d.m_Rates)
+            rates.push_back(x.second);
+
+        deliverExchangeRates(rates);
+    }
+
+    for (const auto& x : d.m_Assets)
+        deliverAssetInfo(x.first, x.second);
+
+    for (const auto& x : d.m_Notifications)
+        deliverNotifications(x.first, x.second);
+}
+
 void WalletModel::onNotificationsChanged(ChangeAction action, const std::vector<Notification>& notifications)
+{
+    if (m_Deferred.m_Enabled)
+        m_Deferred.m_Notifications.emplace_back(action, notifications);
+    else
+        deliverNotifications(action, notifications);
+}
+
+void WalletModel::deliverNotifications(ChangeAction action, const std::vector<Notification>& notifications)
 {
     BEAM_LOG_DEBUG() << "onNotificationsChanged";
 
@@ -917,6 +1058,18 @@ void WalletModel::onNotificationsChanged(ChangeAction action, const std::vector<
 }
 
 void WalletModel::onExchangeRates(const std::vector<ExchangeRate>& rates)
+{
+    if (m_Deferred.m_Enabled)
+    {
+        // only the latest rate of each pair matters
+        for (const auto& r : rates)
+            m_Deferred.m_Rates[std::make_pair(r.m_from, r.m_to)] = r;
+    }
+    else
+        deliverExchangeRates(rates);
+}
+
+void WalletModel::deliverExchangeRates(const std::vector<ExchangeRate>& rates)
 {
     BEAM_LOG_DEBUG() << "onExchangeRates(" << rates.size() << ")";
 
@@ -953,6 +1106,16 @@ void WalletModel::onShieldedCoinChanged(beam::wallet::ChangeAction action, const
         shieldedCoins[coin.m_TxoID] = coin;
     }
 
+    if (m_BulkData)
+    {
+        BulkWriter w(items.size());
+        for (const auto& coin : items)
+            writeShieldedCoin(w, coin);
+
+        callBulkListener("onAllShieldedUtxoChangedBulk", action, w);
+        return;
+    }
+
     JNIEnv* env = Android_JNI_getEnv();
 
     jobjectArray utxos = convertShieldedToJObject(env, items);
@@ -1079,6 +1242,14 @@ void WalletModel::onPublicAddress(const std::string& publicAddr)
 }
 
 void WalletModel::onAssetInfo(Asset::ID assetId, const WalletAsset& asset) 
+{
+    if (m_Deferred.m_Enabled)
+        m_Deferred.m_Assets[assetId] = asset;
+    else
+        deliverAssetInfo(assetId, asset);
+}
+
+void WalletModel::deliverAssetInfo(Asset::ID assetId, const WalletAsset& asset)
 {
     auto info = WalletAssetMeta(asset);
 
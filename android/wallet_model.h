@@ -15,6 +15,8 @@
 #pragma once
 
 #include "wallet/client/wallet_client.h"
+#include "bulk_data.h"
+#include <atomic>
 
 class WalletModel
     : public beam::wallet::WalletClient
@@ -31,7 +33,33 @@ public:
     void callMyFunction();
     std::function<void()> myFunction;
 
+    // The app is in background: the node is polled, and the secondary updates (exchange rates, asset info, notifications)
+    // are delivered in a batch once the node connection is up, instead of waking the app on each
+    void setBackgroundMode(bool);
+
+    // Coins and addresses are delivered to the *Bulk listener callbacks as an encoded ByteBuffer (see bulk_data.h)
+    void setBulkDataMode(bool enable) { m_BulkData = enable; }
+
 private:
+    static const uint32_t s_BackgroundPollPeriod_ms = 10 * 60 * 1000;
+
+    struct Deferred
+    {
+        bool m_Enabled = false;
+        std::map<std::pair<beam::wallet::Currency, beam::wallet::Currency>, beam::wallet::ExchangeRate> m_Rates;
+        std::map<beam::Asset::ID, beam::wallet::WalletAsset> m_Assets;
+        std::vector<std::pair<beam::wallet::ChangeAction, std::vector<beam::wallet::Notification> > > m_Notifications;
+    } m_Deferred; // accessed on the reactor thread only
+
+    std::atomic<bool> m_BulkData{ false };
+
+    void callBulkListener(const char* szMethod, beam::wallet::ChangeAction, BulkWriter&);
+
+    void flushDeferred();
+    void deliverNotifications(beam::wallet::ChangeAction, const std::vector<beam::wallet::Notification>&);
+    void deliverExchangeRates(const std::vector<beam::wallet::ExchangeRate>&);
+    void deliverAssetInfo(beam::Asset::ID, const beam::wallet::WalletAsset&);
+
     void doFunction(const std::function<void()>& func);
     std::string getConfirmationProgress(beam::wallet::TxDescription transaction, uint32_t minConfirmations);
 
@@ -23,16 +23,22 @@
 #include "utility/cli/options.h"
 #include "utility/log_rotation.h"
 #include "utility/helpers.h"
+#include "utility/string_helpers.h"
 #include <iomanip>
 
 #include "pow/external_pow.h"
 #include "websocket/websocket_server.h"
+#include "http/metrics_server.h"
+#include "utility/metrics.h"
 
 
 #include <boost/program_options.hpp>
 #include <boost/filesystem.hpp>
 #include <iterator>
 #include <future>
+#ifndef WIN32
+#	include <signal.h>
+#endif // WIN32
 #include "version.h"
 
 using namespace std;
@@ -213,6 +219,41 @@ namespace
 			*result = var.as<T>();
 		}
 	}
+
+	// Dumps the hot-path scopes to the log on SIGUSR1. The signal handler only raises the flag, it's polled on the reactor thread
+	struct HotScopesDump
+	{
+		static std::atomic<bool> s_Requested;
+		io::Timer::Ptr m_pTimer;
+
+		static void OnSignal(int)
+		{
+			s_Requested = true;
+		}
+
+		void Start(io::Reactor& r)
+		{
+#ifndef WIN32
+			struct sigaction sa;
+			sa.sa_handler = OnSignal;
+			sigemptyset(&sa.sa_mask);
+			sa.sa_flags = 0;
+			sigaction(SIGUSR1, &sa, nullptr);
+#endif // WIN32
+
+			m_pTimer = io::Timer::create(r);
+			m_pTimer->start(1000, true, []() {
+				if (s_Requested.exchange(false))
+				{
+					std::string s;
+					metrics::HotScopes::get().Dump(s);
+					BEAM_LOG_INFO() << "Hot scopes:\n" << s;
+				}
+			});
+		}
+	};
+
+	std::atomic<bool> HotScopesDump::s_Requested(false);
 }
 
 #ifndef LOG_VERBOSE_ENABLED
@@ -320,8 +361,11 @@ int main(int argc, char* argv[])
 #define LOG_FILES_DIR "logs"
 #define LOG_FILES_PREFIX "node_"
 
+		bool logAsync = vm.count(cli::LOG_ASYNC) && vm[cli::LOG_ASYNC].as<bool>();
+		bool logBinary = vm.count(cli::LOG_BINARY) && vm[cli::LOG_BINARY].as<bool>();
+
 		const auto path = boost::filesystem::system_complete(LOG_FILES_DIR);
-		auto logger = beam::Logger::create(logLevel, logLevel, fileLogLevel, LOG_FILES_PREFIX, path.string());
+		auto logger = beam::Logger::create(logLevel, logLevel, fileLogLevel, LOG_FILES_PREFIX, path.string(), logAsync, logBinary);
 
 		try
 		{
@@ -359,6 +403,7 @@ int main(int argc, char* argv[])
 				{
 					IExternalPOW::Options powOptions;
 					find_certificates(powOptions, vm[cli::STRATUM_SECRETS_PATH].as<string>(), vm[cli::STRATUM_USE_TLS].as<bool>());
+					powOptions.shareInterval = vm[cli::STRATUM_SHARE_INTERVAL].as<unsigned>();
 					unsigned noncePrefixDigits = vm[cli::NONCEPREFIX_DIGITS].as<unsigned>();
 					if (noncePrefixDigits > 6) noncePrefixDigits = 6;
 					stratumServer = IExternalPOW::create(powOptions, *reactor, io::Address().port(stratumPort), noncePrefixDigits);
@@ -399,6 +444,40 @@ int main(int argc, char* argv[])
 					}
 
 					node.m_Cfg.m_VerificationThreads = vm[cli::VERIFICATION_THREADS].as<int>();
+					node.m_Cfg.m_VerificationBatchBlocks = vm[cli::VERIFICATION_BATCH_BLOCKS].as<uint32_t>();
+					node.m_Cfg.m_ReadThreads = vm[cli::READ_THREADS].as<uint32_t>();
+
+					{
+						auto fnPlacement = [&vm](ThreadPlacement& tp, const char* szCpus, const char* szNice)
+						{
+							tp.nice = vm[szNice].as<int>();
+							if (vm.count(szCpus) && !ThreadPlacement::parse_cpus(vm[szCpus].as<string>(), tp.cpus))
+							{
+								BEAM_LOG_ERROR() << "Invalid core list: " << szCpus;
+								return false;
+							}
+							return true;
+						};
+
+						auto& pl = node.m_Cfg.m_Placement; // alias
+						if (!fnPlacement(pl.m_Reactor, cli::CPUS_REACTOR, cli::NICE_REACTOR) ||
+							!fnPlacement(pl.m_Verification, cli::CPUS_VERIFICATION, cli::NICE_VERIFICATION) ||
+							!fnPlacement(pl.m_Mining, cli::CPUS_MINING, cli::NICE_MINING))
+							return -1;
+					}
+
+					node.m_Cfg.m_MaxPoolSize = static_cast<uint64_t>(vm[cli::MEMPOOL_MAX_SIZE].as<uint32_t>()) * 1024 * 1024;
+					node.m_Cfg.m_Memory.m_SoftLimit = static_cast<uint64_t>(vm[cli::MEM_SOFT_LIMIT].as<uint32_t>()) * 1024 * 1024;
+					node.m_Cfg.m_Memory.m_ReportPeriod_s = vm[cli::MEM_REPORT_PERIOD].as<uint32_t>();
+					node.m_Cfg.m_TxSketchCells = vm[cli::TX_SKETCH_CELLS].as<uint32_t>();
+					node.m_Cfg.m_TxTrickle.m_Mean_ms = vm[cli::TX_TRICKLE].as<uint32_t>();
+					node.m_Cfg.m_PersistTxPool = vm[cli::MEMPOOL_PERSIST].as<bool>();
+					node.m_Cfg.m_ListenReusePort = vm[cli::LISTEN_REUSE_PORT].as<bool>();
+					node.m_Cfg.m_Wal.m_Enabled = vm[cli::DB_WAL].as<bool>();
+					node.m_Cfg.m_Wal.m_CheckpointInterval_ms = std::max(vm[cli::DB_WAL_CHECKPOINT_INTERVAL].as<uint32_t>(), 100U);
+					node.m_Cfg.m_Compaction.m_Period_ms = vm[cli::DB_COMPACTION_PERIOD].as<uint32_t>();
+					node.m_Cfg.m_Compaction.m_Budget_ms = std::max(vm[cli::DB_COMPACTION_BUDGET].as<uint32_t>(), 1U);
+					node.m_Cfg.m_FastSync.m_MaxRanges = std::max(vm[cli::FAST_SYNC_RANGES].as<uint32_t>(), 1U);
 
 					node.m_Cfg.m_LogEvents = vm[cli::LOG_UTXOS].as<bool>();
 
@@ -506,6 +585,28 @@ int main(int argc, char* argv[])
 
 					node.m_Cfg.m_PeersPersistent = vm[cli::NODE_PEERS_PERSISTENT].as<bool>();
 
+					if (vm.count(cli::CLUSTER_SECRET))
+					{
+						ECC::Hash::Processor()
+							<< vm[cli::CLUSTER_SECRET].as<std::string>()
+							>> node.m_Cfg.m_Cluster.m_Secret;
+
+						if (vm.count(cli::CLUSTER_BEACON_TARGETS))
+						{
+							for (const auto& sTargets : vm[cli::CLUSTER_BEACON_TARGETS].as<std::vector<std::string> >())
+							{
+								for (const auto& sAddr : string_helpers::split(sTargets, ','))
+								{
+									io::Address addr;
+									if (addr.resolve(sAddr.c_str()))
+										node.m_Cfg.m_Cluster.m_vBeaconTargets.push_back(addr); // port 0 - the beacon port
+									else
+										BEAM_LOG_ERROR() << "unable to resolve: " << sAddr;
+								}
+							}
+						}
+					}
+
 					BEAM_LOG_INFO() << "starting a node on " << node.m_Cfg.m_Listen.port() << " port...";
 
 					if (vm.count(cli::TREASURY_BLOCK))
@@ -522,10 +623,57 @@ int main(int argc, char* argv[])
 
 					if (vm.count(cli::CHECKDB))
 						node.m_Cfg.m_ProcessorParams.m_CheckIntegrity = vm[cli::CHECKDB].as<bool>();
+					if (vm.count(cli::CHECKDB_THREADS))
+						node.m_Cfg.m_ProcessorParams.m_CheckIntegrityThreads = vm[cli::CHECKDB_THREADS].as<uint32_t>();
+					if (vm.count(cli::CHECKDB_AFTER_CRASH))
+						node.m_Cfg.m_ProcessorParams.m_CheckAfterCrash = vm[cli::CHECKDB_AFTER_CRASH].as<bool>();
 
 					if (vm.count(cli::VACUUM))
 						node.m_Cfg.m_ProcessorParams.m_Vacuum = vm[cli::VACUUM].as<bool>();
 
+					if (vm.count(cli::PERSIST_VALIDATED_CACHE))
+						node.m_Cfg.m_ProcessorParams.m_PersistValCache = vm[cli::PERSIST_VALIDATED_CACHE].as<bool>();
+					if (vm.count(cli::DB_MMAP_SIZE))
+						node.m_Cfg.m_ProcessorParams.m_DbMmapSize = static_cast<uint64_t>(vm[cli::DB_MMAP_SIZE].as<uint32_t>()) * 1024 * 1024;
+					if (vm.count(cli::MMR_PIN_FROM_LEVEL))
+					{
+						uint32_t h = vm[cli::MMR_PIN_FROM_LEVEL].as<uint32_t>();
+						if (h && (h < Merkle::Position::HMax))
+							node.m_Cfg.m_ProcessorParams.m_MmrPinFrom = static_cast<uint8_t>(h);
+					}
+					if (vm.count(cli::MEM_CACHE_KERNEL_PROOFS))
+						node.m_Cfg.m_ProcessorParams.m_MemCacheKernelProofs = static_cast<uint64_t>(vm[cli::MEM_CACHE_KERNEL_PROOFS].as<uint32_t>()) * 1024 * 1024;
+					if (vm.count(cli::EXTERNAL_BODIES))
+						node.m_Cfg.m_ProcessorParams.m_ExternalBodies = vm[cli::EXTERNAL_BODIES].as<bool>();
+					if (vm.count(cli::BULK_LOAD_SYNC))
+						node.m_Cfg.m_ProcessorParams.m_BulkLoad = vm[cli::BULK_LOAD_SYNC].as<bool>();
+
+					if (vm.count(cli::MAPPING_COMPACT))
+						node.m_Cfg.m_ProcessorParams.m_CompactMapping = vm[cli::MAPPING_COMPACT].as<bool>();
+					if (vm.count(cli::MAPPING_REPORT))
+						node.m_Cfg.m_ProcessorParams.m_MappingReport = vm[cli::MAPPING_REPORT].as<bool>();
+
+					{
+						uint8_t& nHints = node.m_Cfg.m_ProcessorParams.m_MappingHints;
+						if (vm.count(cli::MAPPING_RANDOM_ACCESS) && vm[cli::MAPPING_RANDOM_ACCESS].as<bool>())
+							nHints |= MappedFileRaw::Hint::Random;
+						if (vm.count(cli::MAPPING_HUGE_PAGES) && vm[cli::MAPPING_HUGE_PAGES].as<bool>())
+							nHints |= MappedFileRaw::Hint::HugePages;
+						if (vm.count(cli::MAPPING_PREFAULT) && vm[cli::MAPPING_PREFAULT].as<bool>())
+							nHints |= MappedFileRaw::Hint::Prefault;
+					}
+
+					if (vm.count(cli::SNAPSHOT_IMPORT) && !boost::filesystem::exists(node.m_Cfg.m_sPathLocal))
+					{
+						string sPath = vm[cli::SNAPSHOT_IMPORT].as<string>();
+						BEAM_LOG_INFO() << "Importing snapshot " << sPath << "...";
+						NodeDB::ImportSnapshot(sPath.c_str(), node.m_Cfg.m_sPathLocal.c_str());
+
+						// the imported state is verified vs its headers chain
+						node.m_Cfg.m_ProcessorParams.m_CheckIntegrity = true;
+						node.m_Cfg.m_ProcessorParams.m_VerifyHeaders = true;
+					}
+
 					if (vm.count(cli::RESET_ID))
 						node.m_Cfg.m_ProcessorParams.m_ResetSelfID = vm[cli::RESET_ID].as<bool>();
 
@@ -544,6 +692,15 @@ int main(int argc, char* argv[])
 							node.m_Cfg.m_Horizon.SetInfinite();
 					}
 
+					if (vm.count(cli::PRUNE_DAYS))
+					{
+						uint32_t nDays = vm[cli::PRUNE_DAYS].as<uint32_t>();
+						Height hKeep = static_cast<Height>(nDays) * 24 * 3600 / Rules::get().DA.Target_s;
+						node.m_Cfg.m_Horizon.SetStdPruning(hKeep);
+
+						BEAM_LOG_INFO() << "Pruning node, spent outputs are kept for " << nDays << " days (" << hKeep << " blocks)";
+					}
+
 					ByteBuffer bufRichParser;
 
 					if (vm.count(cli::CONTRACT_RICH_INFO))
@@ -591,6 +748,12 @@ int main(int argc, char* argv[])
 						BEAM_LOG_INFO() << "Recovery info written";
 					}
 
+					if (vm.count(cli::SNAPSHOT_EXPORT))
+					{
+						string sPath = vm[cli::SNAPSHOT_EXPORT].as<string>();
+						node.ExportSnapshot(sPath.c_str());
+					}
+
 					if (vm.count(cli::RECOVERY_AUTO_PATH))
 					{
 						node.m_Cfg.m_Recovery.m_sPathOutput = vm[cli::RECOVERY_AUTO_PATH].as<string>();
@@ -641,6 +804,19 @@ int main(int argc, char* argv[])
 						node.RefreshCongestions();
 					}
 
+					std::unique_ptr<MetricsServer> metricsServer;
+					if (auto metricsPort = vm[cli::METRICS_PORT].as<uint16_t>(); metricsPort > 0)
+						metricsServer = std::make_unique<MetricsServer>(*reactor, io::Address().port(metricsPort));
+
+					std::unique_ptr<metrics::Scope> pHotScopesMetrics;
+					HotScopesDump hotScopesDump;
+					if (vm[cli::PROFILE_SCOPES].as<bool>())
+					{
+						metrics::HotScopes::s_Enabled = true;
+						pHotScopesMetrics = std::make_unique<metrics::Scope>(metrics::HotScopes::get());
+						hotScopesDump.Start(*reactor);
+					}
+
 					reactor->run();
 				}
 			}
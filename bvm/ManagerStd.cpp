@@ -14,6 +14,9 @@
 
 #include "ManagerStd.h"
 #include "../core/serialization_adapters.h"
+#include <mutex>
+#include <list>
+#include <map>
 
 namespace beam {
 namespace bvm2 {
@@ -108,6 +111,67 @@ namespace bvm2 {
 			}
 		};
 
+		// Reads the whole range, page by page, regardless of the consumer
+		struct VarsPrefetched
+			:public Handler
+		{
+			using Handler::Handler;
+
+			ByteBuffer m_Res;
+
+			static bool get_LastKey(ByteBuffer& res, const ByteBuffer& buf)
+			{
+				Blob key(nullptr, 0);
+
+				for (size_t nPos = 0; nPos < buf.size(); )
+				{
+					Deserializer der;
+					der.reset(&buf.front() + nPos, buf.size() - nPos);
+
+					uint32_t nKey = 0, nVal = 0;
+					der
+						& nKey
+						& nVal;
+
+					uint32_t nTotal = nKey + nVal;
+					if ((nTotal < nKey) || (nTotal > der.bytes_left()))
+						return false;
+
+					nPos = buf.size() - der.bytes_left();
+					key = Blob(&buf.front() + nPos, nKey);
+					nPos += nTotal;
+				}
+
+				key.Export(res);
+				return true;
+			}
+
+			virtual void OnComplete(proto::FlyClient::Request&) override
+			{
+				assert(m_pRequest && (this == m_pRequest->m_pTrg));
+				m_pRequest->m_pTrg = nullptr;
+
+				auto& r = Cast::Up<proto::FlyClient::RequestContractVars>(*m_pRequest);
+				auto& res = r.m_Res.m_Result;
+
+				bool bMore = r.m_Res.m_bMore && !res.empty();
+				if (bMore)
+				{
+					bMore = get_LastKey(r.m_Msg.m_KeyMin, res);
+					r.m_Msg.m_bSkipMin = true;
+					r.m_Res.m_bMore = false;
+				}
+
+				m_Res.insert(m_Res.end(), res.begin(), res.end());
+				res.clear();
+
+				if (bMore)
+					Post(); // ask for more
+				else
+					m_This.m_Pending.OnDone(*this);
+			}
+		};
+
 		struct Vars
 			:public Handler
 			,public IReadVars
@@ -117,21 +181,34 @@ namespace bvm2 {
 			size_t m_Consumed = 0;
 			ByteBuffer m_Buf;
 
+			VarsPrefetched* m_pPrefetched = nullptr;
+			bool m_PrefetchedLoaded = false;
+
 			virtual bool MoveNext() override
 			{
-				assert(m_pRequest);
-				auto& r = Cast::Up<proto::FlyClient::RequestContractVars>(*m_pRequest);
-
 				if (m_Consumed == m_Buf.size())
 				{
-					if (!CheckDone())
-						return false;
-
-					if (r.m_Res.m_Result.empty())
+					if (m_pPrefetched)
+					{
+						if (m_PrefetchedLoaded || !m_pPrefetched->CheckDone())
+							return false;
+
+						m_PrefetchedLoaded = true;
+						m_Buf = m_pPrefetched->m_Res; // copy, the same range may be enumerated again
+					}
+					else
+					{
+						assert(m_pRequest);
+						if (!CheckDone())
+							return false;
+
+						m_Buf = std::move(Cast::Up<proto::FlyClient::RequestContractVars>(*m_pRequest).m_Res.m_Result);
+					}
+
+					if (m_Buf.empty())
 						return false;
 
 					m_Consumed = 0;
-					m_Buf = std::move(r.m_Res.m_Result);
 				}
 
 				auto* pBuf = &m_Buf.front();
@@ -155,6 +232,10 @@ namespace bvm2 {
 				m_LastVal.p = pBuf + m_Consumed;
 				m_Consumed += m_LastVal.n;
 
+				if (m_pPrefetched)
+					return true;
+
+				auto& r = Cast::Up<proto::FlyClient::RequestContractVars>(*m_pRequest);
 				if ((m_Consumed == m_Buf.size()) && r.m_Res.m_bMore)
 				{
 					r.m_Res.m_bMore = false;
@@ -298,10 +379,57 @@ namespace bvm2 {
 		return pRet;
 	}
 
+	void ManagerStd::PrefetchVars()
+	{
+		for (const auto& rng : m_vVarsPrefetch)
+		{
+			auto& pVal = m_mapVarsPrefetched[rng];
+			if (pVal)
+				continue; // duplicate
+
+			auto p = std::make_unique<RemoteRead::VarsPrefetched>(*this);
+
+			boost::intrusive_ptr<proto::FlyClient::RequestContractVars> pReq(new proto::FlyClient::RequestContractVars);
+			auto& r = *pReq;
+
+			r.m_Msg.m_KeyMin = rng.first;
+			r.m_Msg.m_KeyMax = rng.second;
+
+			SetParentContext(r.m_pCtx);
+			p->m_pRequest = std::move(pReq);
+			p->Post();
+
+			pVal = std::move(p);
+		}
+	}
+
 	void ManagerStd::VarsEnum(const Blob& kMin, const Blob& kMax, IReadVars::Ptr& pOut)
 	{
 		auto p = std::make_unique<RemoteRead::Vars>(*this);
 
+		if (!m_mapVarsPrefetched.empty())
+		{
+			VarsRange rng;
+			kMin.Export(rng.first);
+			kMax.Export(rng.second);
+
+			auto it = m_mapVarsPrefetched.find(rng);
+			if (m_mapVarsPrefetched.end() != it)
+			{
+				auto& pf = Cast::Up<RemoteRead::VarsPrefetched>(*it->second);
+				const auto& pCtx = pf.m_pRequest->m_pCtx;
+				const auto* pParent = m_Context.m_pParent.get();
+
+				// use it only if fetched in the same context
+				if (pParent ? (pCtx && (*pCtx == *pParent)) : !pCtx)
+				{
+					p->m_pPrefetched = &pf;
+					pOut = std::move(p);
+					return;
+				}
+			}
+		}
+
 		boost::intrusive_ptr<proto::FlyClient::RequestContractVars> pReq(new proto::FlyClient::RequestContractVars);
 		auto& r = *pReq;
 
@@ -510,6 +638,8 @@ namespace bvm2 {
 		m_Pending.m_pSingleRequest.reset();
 		m_Pending.m_pCommMsg.reset();
 		m_Pending.m_pBlocker = nullptr;
+
+		m_mapVarsPrefetched.clear();
 	}
 
 	void ManagerStd::Reset()
@@ -526,6 +656,8 @@ namespace bvm2 {
 			if (m_EnforceDependent)
 				EnsureContext();
 
+			PrefetchVars();
+
 			CallMethod(iMethod);
 			RunSync();
 		}
@@ -590,7 +722,7 @@ namespace bvm2 {
 			if (IsSuspended())
 				return;
 
-			RunOnce();
+			RunMany();
 		}
 		OnDone(nullptr);
 	}
@@ -617,5 +749,199 @@ namespace bvm2 {
 		return false;
 	}
 
+	struct ManagerStd::AppShadersCache
+	{
+		struct Entry
+		{
+			ShaderID m_Sid;
+			ByteBuffer m_Code;
+		};
+
+		typedef std::list<Entry> List; // most recently used first
+
+		std::mutex m_Mutex;
+		List m_List;
+		std::map<ShaderID, List::iterator> m_Map;
+		uint32_t m_Max = 16;
+
+		static AppShadersCache& get()
+		{
+			static AppShadersCache s_Cache;
+			return s_Cache;
+		}
+
+		bool Find(ByteBuffer& res, const ShaderID& sid)
+		{
+			std::unique_lock<std::mutex> scope(m_Mutex);
+
+			auto it = m_Map.find(sid);
+			if (m_Map.end() == it)
+				return false;
+
+			m_List.splice(m_List.begin(), m_List, it->second);
+			res = it->second->m_Code;
+			return true;
+		}
+
+		void Insert(const ShaderID& sid, const ByteBuffer& code)
+		{
+			std::unique_lock<std::mutex> scope(m_Mutex);
+
+			if (m_Map.end() != m_Map.find(sid))
+				return; // compiled concurrently
+
+			m_List.push_front(Entry{ sid, code });
+			m_Map[sid] = m_List.begin();
+
+			Shrink();
+		}
+
+		void Shrink()
+		{
+			while (m_List.size() > m_Max)
+			{
+				m_Map.erase(m_List.back().m_Sid);
+				m_List.pop_back();
+			}
+		}
+	};
+
+	void ManagerStd::CompileAppShader(ByteBuffer& res, const Blob& src)
+	{
+		ShaderID sid;
+		get_ShaderID(sid, src);
+
+		AppShadersCache& c = AppShadersCache::get();
+		if (c.Find(res, sid))
+			return;
+
+		ByteBuffer buf;
+		Processor::Compile(buf, src, Kind::Manager); // may throw
+		c.Insert(sid, buf);
+
+		res.swap(buf);
+	}
+
+	void ManagerStd::set_AppShadersCacheMax(uint32_t n)
+	{
+		AppShadersCache& c = AppShadersCache::get();
+		std::unique_lock<std::mutex> scope(c.m_Mutex);
+
+		c.m_Max = n;
+		c.Shrink();
+	}
+
+	/////////////////////////////////////////////
+	// ContractSimulator
+	BlobMap::Entry& ContractSimulator::get_Var(const Blob& key)
+	{
+		auto* pE = m_Overlay.Find(key);
+		if (!pE)
+		{
+			pE = m_Overlay.Create(key);
+
+			auto* pSrc = m_Snapshot.Find(key);
+			if (pSrc)
+				pE->m_Data = pSrc->m_Data;
+		}
+		return *pE;
+	}
+
+	BlobMap::Entry* ContractSimulator::FindVarEx(const Blob& key, bool bExact, bool bBigger)
+	{
+		// same as the node does with its per-block cache on top of the DB: pull the neighbor from the snapshot, then step in the overlay
+		auto* pE = &get_Var(key);
+		if (pE->m_Data.empty() || !bExact)
+		{
+			while (true)
+			{
+				auto* pSrc = m_Snapshot.FindVarEx(pE->ToBlob(), false, bBigger);
+				if (pSrc)
+					get_Var(pSrc->ToBlob());
+
+				auto it = BlobMap::Set::s_iterator_to(*pE);
+				if (bBigger)
+				{
+					++it;
+					if (m_Overlay.end() == it)
+						return nullptr;
+				}
+				else
+				{
+					if (m_Overlay.begin() == it)
+						return nullptr;
+					--it;
+				}
+
+				pE = &(*it);
+				if (!pE->m_Data.empty())
+					break;
+			}
+		}
+		return pE;
+	}
+
+	void ContractSimulator::LoadVar(const Blob& key, Blob& res)
+	{
+		res = get_Var(key).m_Data;
+	}
+
+	void ContractSimulator::LoadVarEx(Blob& key, Blob& res, bool bExact, bool bBigger)
+	{
+		auto* pE = FindVarEx(key, bExact, bBigger);
+		if (pE)
+		{
+			key = pE->ToBlob();
+			res = pE->m_Data;
+		}
+		else
+		{
+			key.n = 0;
+			res.n = 0;
+		}
+	}
+
+	uint32_t ContractSimulator::SaveVar(const Blob& key, const Blob& val)
+	{
+		auto& e = get_Var(key);
+		auto nOldSize = static_cast<uint32_t>(e.m_Data.size());
+
+		val.Export(e.m_Data);
+		return nOldSize;
+	}
+
+	bool ContractSimulator::Run(const ContractID& cid, uint32_t iMethod, ByteBuffer& args, std::ostream* pErr /* = nullptr */)
+	{
+		try
+		{
+			m_Charge = Limits::BlockCharge;
+			if (pErr)
+				m_FarCalls.m_SaveLocal = true;
+
+			uint32_t nArgs = static_cast<uint32_t>(args.size());
+			InitStackPlus(m_Stack.AlignUp(nArgs));
+			m_Stack.PushAlias(args);
+
+			CallFar(cid, iMethod, m_Stack.get_AlasSp(), nArgs, 0);
+
+			if (!RunCharged(m_Charge, Limits::Cost::Cycle))
+				DischargeUnits(Limits::Cost::Cycle); // would throw
+
+			if (nArgs)
+				memcpy(&args.front(), m_Stack.get_AliasPtr(), nArgs);
+		}
+		catch (const std::exception& e)
+		{
+			if (pErr)
+			{
+				*pErr << e.what();
+				DumpCallstack(*pErr);
+			}
+			return false;
+		}
+
+		return true;
+	}
+
 } // namespace bvm2
 } // namespace beam
@@ -16,6 +16,7 @@
 #include "bvm2.h"
 #include "../core/fly_client.h"
 #include "invoke_data.h"
+#include "../utility/blobmap.h"
 
 namespace beam::bvm2 {
 	class ManagerStd
@@ -52,6 +53,10 @@ namespace beam::bvm2 {
 
 		struct RemoteRead;
 
+		typedef std::pair<ByteBuffer, ByteBuffer> VarsRange;
+		std::map<VarsRange, Pending::IBase::Ptr> m_mapVarsPrefetched;
+		void PrefetchVars();
+
 		void SetParentContext(std::unique_ptr<beam::Merkle::Hash>& pTrg) const;
 		void PerformSingleRequest(proto::FlyClient::Request& r);
 		proto::FlyClient::Request::Ptr GetResSingleRequest();
@@ -88,11 +93,52 @@ namespace beam::bvm2 {
 		ByteBuffer m_BodyManager; // always required
 		ByteBuffer m_BodyContract; // required if creating a new contract
 
+		// Hints: vars ranges (min, max) the app shader is expected to enumerate. All of them are requested at once in the beginning of each run,
+		// and read to the end. VarsEnum for the exactly matching range is served locally, instead of the round trip per range and per page
+		std::vector<VarsRange> m_vVarsPrefetch;
+
 		// results
 		std::ostringstream m_Out;
 
 		void Reset();
 		void StartRun(uint32_t iMethod);
+
+		// Compiles the app shader. The results are cached by the ShaderID of the source (process-wide, LRU), since the same apps are run over and over
+		static void CompileAppShader(ByteBuffer& res, const Blob& src);
+		static void set_AppShadersCacheMax(uint32_t);
+
+	private:
+		struct AppShadersCache;
+	};
+
+	// Runs contract methods locally, on top of a snapshot of the contract vars (fetched once, e.g. from the node).
+	// Modifications go to the copy-on-write overlay, the snapshot is not affected, hence it can be reused for many speculative runs
+	// (price quotes, charge estimation). Use a new instance per run.
+	class ContractSimulator
+		:public ProcessorContract
+	{
+		BlobMap::Set m_Overlay; // vars touched by the run, empty value stands for absent
+
+		BlobMap::Entry& get_Var(const Blob& key);
+		BlobMap::Entry* FindVarEx(const Blob& key, bool bExact, bool bBigger);
+
+		void LoadVar(const Blob& key, Blob& res) override;
+		void LoadVarEx(Blob& key, Blob& res, bool bExact, bool bBigger) override;
+		uint32_t SaveVar(const Blob& key, const Blob& val) override;
+		Height get_Height() override { return m_Height; }
+
+	public:
+
+		ContractSimulator(BlobMap::Set& snapshot) :m_Snapshot(snapshot) {}
+
+		BlobMap::Set& m_Snapshot; // must contain the contract code (under the ContractID key) and its vars. Not modified
+		Height m_Height = 0; // the current blockchain height, the run is simulated for the next block
+
+		// args are in/out. Returns false if the invocation failed (the error is written to pErr)
+		bool Run(const ContractID&, uint32_t iMethod, ByteBuffer& args, std::ostream* pErr = nullptr);
+
+		uint32_t get_ChargeSpent() const { return Limits::BlockCharge - m_Charge; }
+		const BlobMap::Set& get_Overlay() const { return m_Overlay; }
 	};
 } // namespace
 
@@ -303,11 +303,18 @@ namespace bvm2 {
 		m_Stack.Push(0); // retaddr, set dummy for far call
 
 		uint32_t nAddr = ByteOrder::from_le(hdr.m_pMethod[iMethod]);
+
+		if (m_pProfiler)
+			m_pProfiler->m_FarPending = true;
+
 		OnCall(nAddr);
 	}
 
 	void ProcessorContract::OnRet(Wasm::Word nRetAddr)
 	{
+		if (m_pProfiler)
+			ProfilerOnRet();
+
 		auto& x = m_FarCalls.m_Stack.back();
 
 		if (m_FarCalls.m_SaveLocal)
@@ -363,9 +370,150 @@ namespace bvm2 {
 			x.m_Debug.OnCall(nAddr, nRetAddr);
 		}
 
+		if (m_pProfiler)
+			ProfilerOnCall(nAddr);
+
 		Processor::OnCall(nAddr);
 	}
 
+	void ProcessorContract::ProfilerOnCall(Wasm::Word nAddr)
+	{
+		auto& p = *m_pProfiler;
+		const auto& fr = m_FarCalls.m_Stack.back();
+
+		Profiler::Key key;
+		key.m_Addr = nAddr;
+
+		if (p.m_FarPending || p.m_vStack.empty())
+		{
+			p.m_FarPending = false;
+			get_ShaderID(key.m_Sid, fr.m_Body);
+
+			if (1 == m_FarCalls.m_Stack.size())
+			{
+				// new invocation. Reset the state left by the previous one (it could be aborted)
+				p.m_vStack.clear();
+				p.m_Charge0 = m_Charge;
+				p.m_iBinding = 0;
+			}
+		}
+		else
+			key.m_Sid = p.m_vStack.back().first->m_Sid;
+
+		p.Account(m_Charge, static_cast<uint32_t>(m_Heap.m_vMem.size()));
+
+		auto& mapChildren = p.m_vStack.empty() ? p.m_Root.m_Children : p.m_vStack.back().second->m_Children;
+		auto it = mapChildren.emplace(key, Profiler::Node()).first;
+
+		auto& node = it->second;
+		node.m_Cid = fr.m_Cid;
+		node.m_Calls++;
+
+		p.m_vStack.emplace_back(&it->first, &node);
+	}
+
+	void ProcessorContract::ProfilerOnRet()
+	{
+		auto& p = *m_pProfiler;
+		p.Account(m_Charge, static_cast<uint32_t>(m_Heap.m_vMem.size()));
+
+		if (!p.m_vStack.empty())
+			p.m_vStack.pop_back();
+	}
+
+	void ProcessorContract::ProfilerOnCharge(uint32_t n)
+	{
+		// called after the charge is deducted
+		auto& p = *m_pProfiler;
+		if (p.m_vStack.empty())
+			return;
+
+		p.Account(m_Charge + n, static_cast<uint32_t>(m_Heap.m_vMem.size())); // instructions since the last event
+
+		auto& node = *p.m_vStack.back().second;
+		if (p.m_iBinding)
+			node.m_Host[p.m_iBinding - 1] += n;
+		else
+			node.m_Cycles += n; // per-instruction discharge
+
+		p.m_Charge0 = m_Charge;
+	}
+
+	void ProcessorContract::Profiler::Account(uint32_t nCharge, uint32_t nHeap)
+	{
+		if (!m_vStack.empty())
+		{
+			auto& node = *m_vStack.back().second;
+			if (m_Charge0 > nCharge)
+				node.m_Cycles += m_Charge0 - nCharge;
+			std::setmax(node.m_HeapMax, nHeap);
+		}
+
+		m_Charge0 = nCharge;
+	}
+
+	void ProcessorContract::Profiler::DumpFolded(std::ostream& os, const ProcessorContract& proc) const
+	{
+		std::string sPath;
+		for (const auto& x : m_Root.m_Children)
+			DumpFoldedNode(os, proc, x.second, &x.first, nullptr, sPath);
+	}
+
+	void ProcessorContract::Profiler::DumpFoldedNode(std::ostream& os, const ProcessorContract& proc, const Node& node, const Key* pKey, const Node* pParent, std::string& sPath) const
+	{
+		size_t nLen0 = sPath.size();
+
+		std::ostringstream osName;
+		if (nLen0)
+			osName << ';';
+		if (!pParent || (pParent->m_Cid != node.m_Cid))
+			osName << node.m_Cid << ':';
+
+		const Wasm::Compiler::DebugInfo::Function* pF = nullptr;
+		const auto* pDbgInfo = proc.get_DbgInfo(pKey->m_Sid);
+		if (pDbgInfo)
+			pF = pDbgInfo->Find(pKey->m_Addr);
+
+		if (pF)
+			osName << pF->m_sName;
+		else
+			osName << "f_" << uintBigFrom(pKey->m_Addr);
+
+		sPath += osName.str();
+
+		if (node.m_Cycles)
+			os << sPath << ' ' << node.m_Cycles << '\n';
+
+		for (const auto& x : node.m_Host)
+		{
+			const char* szName = get_BindingName(x.first);
+			os << sPath << ";[";
+			if (szName)
+				os << szName;
+			else
+				os << x.first;
+			os << "] " << x.second << '\n';
+		}
+
+		for (const auto& x : node.m_Children)
+			DumpFoldedNode(os, proc, x.second, &x.first, &node, sPath);
+
+		sPath.resize(nLen0);
+	}
+
+	const char* ProcessorContract::get_BindingName(uint32_t nBinding)
+	{
+#define THE_MACRO(id, ret, name) case id: return #name;
+		switch (nBinding)
+		{
+		BVMOpsAll_Common(THE_MACRO)
+		BVMOpsAll_Contract(THE_MACRO)
+		}
+#undef THE_MACRO
+
+		return nullptr;
+	}
+
 	void ProcessorContract::DumpCallstack(std::ostream& os) const
 	{
 		Wasm::Word ip = get_Ip();
@@ -474,6 +622,9 @@ namespace bvm2 {
 		}
 
 		m_Charge -= n;
+
+		if (m_pProfiler)
+			ProfilerOnCharge(n);
 	}
 
 	uint32_t ProcessorContract::get_WasmVersion()
@@ -808,12 +959,21 @@ namespace bvm2 {
 
 	void ProcessorContract::InvokeExt(uint32_t nBinding)
 	{
+		if (m_pProfiler)
+			m_pProfiler->m_iBinding = nBinding + 1;
+
 		ProcessorPlus_Contract::From(*this).InvokeExtPlus(nBinding);
+
+		if (m_pProfiler)
+			m_pProfiler->m_iBinding = 0;
 	}
 
 	void ProcessorManager::InvokeExt(uint32_t nBinding)
 	{
 		ProcessorPlus_Manager::From(*this).InvokeExtPlus(nBinding);
+
+		if (IsSuspended())
+			m_Interrupt = true; // the call will be repeated once resumed
 	}
 
 	void TestStackPtr(const Wasm::Compiler::GlobalVar& x)
@@ -3438,13 +3598,22 @@ namespace bvm2 {
 
 		Processor::RunOnce();
 
-		if (IsSuspended())
+		if (m_Interrupt)
 		{
+			m_Interrupt = false;
 			Jmp(nIp); // restore
 			m_Stack.m_Pos = nSp;
 		}
 	}
 
+	void ProcessorManager::RunMany()
+	{
+		assert(!IsSuspended());
+
+		uint32_t nCharge = 0;
+		RunCharged(nCharge, 0); // no charge for the manager
+	}
+
 	Height ProcessorManager::get_Height()
 	{
 		EnsureContext();
@@ -456,6 +456,10 @@ namespace bvm2 {
 
 		void OnRetFar();
 
+		void ProfilerOnCall(Wasm::Word nAddr);
+		void ProfilerOnRet();
+		void ProfilerOnCharge(uint32_t n);
+
 	public:
 
 		Kind get_Kind() override { return Kind::Contract; }
@@ -476,6 +480,50 @@ namespace bvm2 {
 
 		uint32_t m_Charge = Limits::BlockCharge;
 
+		// Instrumented profiler. The spent charge is attributed to the call stack (far calls and local functions),
+		// split into the instructions (cycles) and the host calls (by binding). Attach it for the duration of the run
+		struct Profiler
+		{
+			struct Key
+			{
+				ShaderID m_Sid;
+				Wasm::Word m_Addr;
+
+				bool operator < (const Key& x) const {
+					int n = m_Sid.cmp(x.m_Sid);
+					return n ? (n < 0) : (m_Addr < x.m_Addr);
+				}
+			};
+
+			struct Node
+			{
+				std::map<Key, Node> m_Children;
+				std::map<uint32_t, uint64_t> m_Host; // binding -> charge
+				ContractID m_Cid;
+				uint64_t m_Cycles = 0; // charge of the instructions
+				uint64_t m_Calls = 0;
+				uint32_t m_HeapMax = 0;
+			};
+
+			Node m_Root;
+			std::vector<std::pair<const Key*, Node*> > m_vStack;
+			uint32_t m_Charge0 = 0; // charge at the last accounted event
+			uint32_t m_iBinding = 0; // current host call + 1
+			bool m_FarPending = false;
+
+			void Account(uint32_t nCharge, uint32_t nHeap);
+
+			// flamegraph.pl input format ("folded stacks"), the units are charge
+			void DumpFolded(std::ostream&, const ProcessorContract&) const;
+
+		private:
+			void DumpFoldedNode(std::ostream&, const ProcessorContract&, const Node&, const Key*, const Node*, std::string&) const;
+		};
+
+		Profiler* m_pProfiler = nullptr;
+
+		static const char* get_BindingName(uint32_t nBinding);
+
 		virtual void CallFar(const ContractID&, uint32_t iMethod, Wasm::Word pArgs, uint32_t nArgs, uint32_t nFlags); // can override to invoke host code instead of interpretator (for debugging)
 	};
 
@@ -690,6 +738,7 @@ namespace bvm2 {
 		void CallMethod(uint32_t iMethod);
 
 		void RunOnce();
+		void RunMany(); // till done or suspended
 
 		void DumpCallstack(std::ostream& os, const Wasm::Compiler::DebugInfo* pDbgInfo = nullptr) const;
 	};
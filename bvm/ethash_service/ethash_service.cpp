@@ -20,11 +20,18 @@
 #include "core/block_crypt.h"
 #include "utility/cli/options.h"
 #include "utility/io/reactor.h"
+#include "utility/io/asyncevent.h"
+#include "utility/thread.h"
 #include "utility/logger.h"
 #include "utility/hex.h"
 #include "utility/byteorder.h"
 
 #include <boost/filesystem.hpp>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <set>
 
 #include "wallet/api/cli/api_server.h"
 #include "wallet/api/base/api_base.h"
@@ -57,7 +64,12 @@ namespace
     };
 
 
-    
+    void GenerateEpochData(uint32_t iEpoch, const std::string& sPath)
+    {
+        EthashUtils::GenerateLocalData(iEpoch, (sPath + ".cache").c_str(), (sPath + ".tre3").c_str(), 3); // skip 1st 3 levels, size reduction of 2^3 == 8
+        EthashUtils::CropLocalData((sPath + ".tre5").c_str(), (sPath + ".tre3").c_str(), 2); // skip 2 more levels
+    }
+
     int GenerateLocalData(const MyOptions& options)
     {
         fs::path path(options.dataPath);
@@ -82,8 +94,7 @@ namespace
 
                 void Exec(Executor::Context&) override
                 {
-                    EthashUtils::GenerateLocalData(m_iEpoch, (m_Path + ".cache").c_str(), (m_Path + ".tre3").c_str(), 3); // skip 1st 3 levels, size reduction of 2^3 == 8
-                    EthashUtils::CropLocalData((m_Path + ".tre5").c_str(), (m_Path + ".tre3").c_str(), 2); // skip 2 more levels
+                    GenerateEpochData(m_iEpoch, m_Path);
                 }
             };
 
@@ -120,17 +131,300 @@ namespace
         };
     };
 
-    class ProverApi : public wallet::ApiBase
+    // Builds the proofs on worker threads, so that requests are served concurrently and never stall the reactor.
+    // The local data of the recently used epochs stays mapped. Missing epochs, as well as the one after
+    // the newest requested, are generated in the background, epoch generation takes minutes.
+    class ProofService
     {
     public:
-        ProverApi(wallet::IWalletApiHandler& handler, const wallet::ApiInitData& initData, const std::string& dataPath)
-            : wallet::ApiBase(handler, initData)
-            , m_DataPath(dataPath)
+        struct Request
+        {
+            typedef std::unique_ptr<Request> Ptr;
+
+            uint32_t m_iEpoch = 0;
+            Shaders::Ethash::Hash512 m_hvSeed;
+            GetProof::Response m_Res;
+            std::string m_sError;
+            std::function<void(Request&)> m_fnDone; // invoked on the reactor thread
+        };
+
+        ProofService(io::Reactor& reactor, const std::string& dataPath)
+            : m_DataPath(dataPath)
+        {
+            m_pEvtDone = io::AsyncEvent::create(reactor, [this]() { OnDone(); });
+
+            if (!fs::exists(m_DataPath))
+                fs::create_directories(m_DataPath);
+
+            std::string sSuper = (m_DataPath / "Super.tre").string();
+            if (fs::exists(sSuper))
+                m_SuperTree.Open(sSuper.c_str());
+            else
+                BEAM_LOG_ERROR() << "Super tree is missing: " << sSuper;
+
+            m_vThreads.resize(std::max(MyThread::hardware_concurrency(), 1U));
+            for (auto& t : m_vThreads)
+                t = MyThread(&ProofService::Thread, this);
+
+            m_GenThread = MyThread(&ProofService::GenThread, this);
+        }
+
+        ~ProofService()
+        {
+            {
+                std::unique_lock<std::mutex> lock(m_Mutex);
+                m_Stop = true;
+                if (!m_Generating.empty())
+                    BEAM_LOG_INFO() << "Waiting for the epoch generation to complete";
+            }
+            m_Cond.notify_all();
+            m_GenCond.notify_all();
+
+            for (auto& t : m_vThreads)
+                if (t.joinable())
+                    t.join();
+
+            if (m_GenThread.joinable())
+                m_GenThread.join();
+        }
+
+        void Push(Request::Ptr&& pReq)
+        {
+            {
+                std::unique_lock<std::mutex> lock(m_Mutex);
+                m_Queue.push_back(std::move(pReq));
+            }
+            m_Cond.notify_one();
+        }
+
+    private:
+        static const size_t s_MaxEpochs = 4; // mapped simultaneously
+
+        typedef std::shared_ptr<const EthashUtils::EpochData> EpochPtr;
+
+        struct Epoch
+        {
+            EpochPtr m_pData;
+            uint64_t m_LastUse = 0;
+        };
+
+        std::string get_Path(uint32_t iEpoch, const char* szSuffix) const
+        {
+            return (m_DataPath / (std::to_string(iEpoch) + szSuffix)).string();
+        }
+
+        void Thread()
+        {
+            while (true)
+            {
+                Request::Ptr pReq;
+                {
+                    std::unique_lock<std::mutex> lock(m_Mutex);
+                    m_Cond.wait(lock, [this] { return m_Stop || !m_Queue.empty(); });
+                    if (m_Stop)
+                        return;
+
+                    pReq = std::move(m_Queue.front());
+                    m_Queue.pop_front();
+                }
+
+                try
+                {
+                    Process(*pReq);
+                }
+                catch (const std::exception& e)
+                {
+                    pReq->m_sError = e.what();
+                }
+
+                {
+                    std::unique_lock<std::mutex> lock(m_Mutex);
+                    m_Done.push_back(std::move(pReq));
+                }
+                m_pEvtDone->post();
+            }
+        }
+
+        void Process(Request& r)
+        {
+            if (r.m_iEpoch >= Shaders::Ethash::ProofBase::nEpochsTotal)
+            {
+                r.m_sError = "epoch out of range";
+                return;
+            }
+
+            if (!m_SuperTree.get_Base())
+            {
+                r.m_sError = "super tree is missing";
+                return;
+            }
+
+            bool bNewest = false;
+            {
+                std::unique_lock<std::mutex> lock(m_Mutex);
+                if (r.m_iEpoch > m_iNewest)
+                {
+                    m_iNewest = r.m_iEpoch;
+                    bNewest = true;
+                }
+            }
+
+            if (bNewest && (r.m_iEpoch + 1 < Shaders::Ethash::ProofBase::nEpochsTotal))
+                Prepare(r.m_iEpoch + 1); // epochs only go forward, the next one will be needed soon
+
+            auto pEpoch = get_Epoch(r.m_iEpoch);
+            if (!pEpoch)
+            {
+                r.m_sError = "epoch data is being generated, retry later";
+                return;
+            }
+
+            BEAM_LOG_DEBUG() << "Getting proof for epoch: " << r.m_iEpoch;
+            r.m_Res.datasetCount = EthashUtils::GenerateProof(r.m_iEpoch, *pEpoch, m_SuperTree, r.m_hvSeed, r.m_Res.proof);
+            BEAM_LOG_DEBUG() << "Got proof";
+        }
+
+        bool IsGenerated(uint32_t iEpoch) const
+        {
+            return fs::exists(get_Path(iEpoch, ".tre5")); // renamed in the last place
+        }
+
+        EpochPtr get_Epoch(uint32_t iEpoch)
+        {
+            {
+                std::unique_lock<std::mutex> lock(m_Mutex);
+                auto it = m_Epochs.find(iEpoch);
+                if (m_Epochs.end() != it)
+                {
+                    it->second.m_LastUse = ++m_Uses;
+                    return it->second.m_pData;
+                }
+            }
+
+            if (!IsGenerated(iEpoch))
+            {
+                Prepare(iEpoch);
+                return nullptr;
+            }
+
+            auto pData = std::make_shared<EthashUtils::EpochData>();
+            pData->Open(get_Path(iEpoch, ".cache").c_str(), get_Path(iEpoch, ".tre5").c_str());
+
+            std::unique_lock<std::mutex> lock(m_Mutex);
+
+            auto& e = m_Epochs[iEpoch];
+            if (!e.m_pData)
+                e.m_pData = std::move(pData); // otherwise mapped concurrently by another thread
+            e.m_LastUse = ++m_Uses;
+            EpochPtr pRet = e.m_pData;
+
+            while (m_Epochs.size() > s_MaxEpochs)
+            {
+                // evict the least recently used. Proofs in progress still hold their mapping
+                auto itOld = m_Epochs.begin();
+                for (auto it = m_Epochs.begin(); m_Epochs.end() != it; ++it)
+                    if (it->second.m_LastUse < itOld->second.m_LastUse)
+                        itOld = it;
+                m_Epochs.erase(itOld);
+            }
+
+            return pRet;
+        }
+
+        void Prepare(uint32_t iEpoch)
         {
-            if (!m_DataPath.empty() && m_DataPath.back() != '\\' && m_DataPath.back() != '/')
+            if (IsGenerated(iEpoch))
+                return;
+
             {
-                m_DataPath.push_back('\\');
+                std::unique_lock<std::mutex> lock(m_Mutex);
+                if (!m_Generating.insert(iEpoch).second)
+                    return;
+                m_GenQueue.push_back(iEpoch);
             }
+            m_GenCond.notify_one();
+        }
+
+        void GenThread()
+        {
+            while (true)
+            {
+                uint32_t iEpoch;
+                {
+                    std::unique_lock<std::mutex> lock(m_Mutex);
+                    m_GenCond.wait(lock, [this] { return m_Stop || !m_GenQueue.empty(); });
+                    if (m_Stop)
+                        return;
+
+                    iEpoch = m_GenQueue.front();
+                    m_GenQueue.pop_front();
+                }
+
+                BEAM_LOG_INFO() << "Generating data for epoch " << iEpoch;
+
+                try
+                {
+                    // generate under temporary names, so that incomplete data is never picked up
+                    std::string sPart = (m_DataPath / (std::to_string(iEpoch) + ".part")).string();
+                    GenerateEpochData(iEpoch, sPart);
+
+                    for (const char* szSuffix : { ".cache", ".tre3", ".tre5" })
+                        fs::rename(sPart + szSuffix, get_Path(iEpoch, szSuffix));
+
+                    BEAM_LOG_INFO() << "Epoch " << iEpoch << " data is ready";
+                }
+                catch (const std::exception& e)
+                {
+                    BEAM_LOG_ERROR() << "Epoch " << iEpoch << " generation failed: " << e.what();
+                }
+
+                std::unique_lock<std::mutex> lock(m_Mutex);
+                m_Generating.erase(iEpoch);
+            }
+        }
+
+        void OnDone()
+        {
+            std::deque<Request::Ptr> done;
+            {
+                std::unique_lock<std::mutex> lock(m_Mutex);
+                done.swap(m_Done);
+            }
+
+            for (auto& pReq : done)
+                pReq->m_fnDone(*pReq);
+        }
+
+        fs::path m_DataPath;
+        MappedFileRaw m_SuperTree;
+        io::AsyncEvent::Ptr m_pEvtDone;
+
+        std::mutex m_Mutex;
+        bool m_Stop = false;
+
+        std::condition_variable m_Cond;
+        std::deque<Request::Ptr> m_Queue;
+        std::deque<Request::Ptr> m_Done;
+        std::vector<MyThread> m_vThreads;
+
+        std::map<uint32_t, Epoch> m_Epochs;
+        uint64_t m_Uses = 0;
+        uint32_t m_iNewest = 0;
+
+        std::condition_variable m_GenCond;
+        std::deque<uint32_t> m_GenQueue;
+        std::set<uint32_t> m_Generating;
+        MyThread m_GenThread;
+    };
+
+    class ProverApi : public wallet::ApiBase
+    {
+    public:
+        ProverApi(wallet::IWalletApiHandler& handler, const wallet::ApiInitData& initData, ProofService& service)
+            : wallet::ApiBase(handler, initData)
+            , m_Service(service)
+            , m_pAlive(std::make_shared<bool>(true))
+        {
             BEAM_ETHASH_SERVICE_API_METHODS(BEAM_API_REG_METHOD)
         }
 
@@ -139,7 +433,8 @@ namespace
         BEAM_ETHASH_SERVICE_API_METHODS(BEAM_API_PARSE_FUNC)
 
     private:
-        std::string m_DataPath;
+        ProofService& m_Service;
+        std::shared_ptr<bool> m_pAlive; // the proof may complete after the connection is gone
     };
 
     struct ProverApiServer : public ApiServer
@@ -150,10 +445,10 @@ namespace
         {
             wallet::ApiInitData init;
             init.acl = _acl;
-            return std::make_unique<ProverApi>(handler, init, m_DataPath);
+            return std::make_unique<ProverApi>(handler, init, *m_pService);
         }
 
-        std::string m_DataPath;
+        ProofService* m_pService = nullptr;
     };
 
     void ProverApi::getResponse(const JsonRpcId& id, const GetProof::Response& data, json& msg)
@@ -174,17 +469,23 @@ namespace
 
     void ProverApi::onHandleGetProof(const JsonRpcId& id, GetProof&& data)
     {
-        GetProof::Response res;
-        std::string sEpoch = std::to_string(data.epoch);
-        BEAM_LOG_DEBUG() << "Getting proof for epoch: " << sEpoch;
-        res.datasetCount = beam::EthashUtils::GenerateProof(
-            data.epoch,
-            (m_DataPath + sEpoch + ".cache").c_str(),
-            (m_DataPath + sEpoch + ".tre5").c_str(),
-            (m_DataPath + "Super.tre").c_str(),
-            data.hvSeed, res.proof);
-        BEAM_LOG_DEBUG() << "Got proof";
-        doResponse(id, res);
+        auto pReq = std::make_unique<ProofService::Request>();
+        pReq->m_iEpoch = data.epoch;
+        pReq->m_hvSeed = data.hvSeed;
+
+        std::weak_ptr<bool> wpAlive = m_pAlive;
+        pReq->m_fnDone = [this, wpAlive, id](ProofService::Request& r)
+        {
+            if (wpAlive.expired())
+                return;
+
+            if (r.m_sError.empty())
+                doResponse(id, r.m_Res);
+            else
+                sendError(id, wallet::ApiError::InternalErrorJsonRpc, r.m_sError);
+        };
+
+        m_Service.Push(std::move(pReq));
     }
 
     std::pair<GetProof, wallet::IWalletApi::MethodInfo> ProverApi::onParseGetProof(const JsonRpcId & id, const json & msg)
@@ -207,8 +508,9 @@ namespace
         io::Address listenTo = io::Address().port(options.port);
         io::Reactor::Scope scope(*reactor);
         io::Reactor::GracefulIntHandler gih(*reactor);
+        ProofService service(*reactor, options.dataPath);
         ProverApiServer server(std::string("0.0.1"), *reactor, listenTo, options.useHttp, (options.useAcl ? loadACL(options.aclPath) : wallet::ApiACL()), options.tlsOptions, {});
-        server.m_DataPath = options.dataPath;
+        server.m_pService = &service;
         reactor->run();
         return 0;
     }
@@ -123,10 +123,8 @@ namespace beam::EthashUtils
 
 		};
 
-		ethash_epoch_context ReadLocalCache(MappedFileRaw& fmp, const char* szPath)
+		ethash_epoch_context GetLocalCache(const MappedFileRaw& fmp)
 		{
-			fmp.Open(szPath);
-
 			auto& hdr = fmp.get_At<HdrCache>(0);
 
 			return ethash_epoch_context{
@@ -137,6 +135,12 @@ namespace beam::EthashUtils
 				static_cast<int>(ByteOrder::from_le(hdr.m_FullItems)) };
 		}
 
+		ethash_epoch_context ReadLocalCache(MappedFileRaw& fmp, const char* szPath)
+		{
+			fmp.Open(szPath);
+			return GetLocalCache(fmp);
+		}
+
 		using MyBuilder = Shaders::MultiProof::Builder<MyMultiProof>;
 	}
 
@@ -285,13 +289,32 @@ namespace beam::EthashUtils
 		}
 	}
 
+	void EpochData::Open(const char* szPathCache, const char* szPathMerkle)
+	{
+		// proofs touch the dataset at pseudo-random spots, read-ahead would be wasted
+		m_Cache.m_Hints = MappedFileRaw::Hint::Random;
+		m_Merkle.m_Hints = MappedFileRaw::Hint::Random;
+
+		m_Cache.Open(szPathCache);
+		m_Merkle.Open(szPathMerkle);
+	}
+
 	uint32_t GenerateProof(uint32_t iEpoch, const char* szPathCache, const char* szPathMerkle, const char* szPathSuperTree, const uintBig_t<64>& hvSeed, ByteBuffer& res)
 	{
-		MappedFileRaw fmpCache, fmpMerkle, fmpSuperTree;
-		fmpMerkle.Open(szPathMerkle);
-		auto ctx = ReadLocalCache(fmpCache, szPathCache);
+		EpochData ed;
+		ed.Open(szPathCache, szPathMerkle);
+
+		MappedFileRaw fmpSuperTree;
+		fmpSuperTree.Open(szPathSuperTree);
 
-		auto& hdr = fmpMerkle.get_At<Hdr>(0);
+		return GenerateProof(iEpoch, ed, fmpSuperTree, hvSeed, res);
+	}
+
+	uint32_t GenerateProof(uint32_t iEpoch, const EpochData& ed, const MappedFileRaw& superTree, const uintBig_t<64>& hvSeed, ByteBuffer& res)
+	{
+		auto ctx = GetLocalCache(ed.m_Cache);
+
+		auto& hdr = ed.m_Merkle.get_At<Hdr>(0);
 
 		ECC::Hash::Value hvMix;
 		uint32_t pSolIndices[64];
@@ -303,12 +326,11 @@ namespace beam::EthashUtils
 
 		mpb.m_pHdr = &hdr;
 		mpb.m_pCtx = &ctx;
-		mpb.m_pHashes = &fmpMerkle.get_At<MyBuilder::THash>(sizeof(Hdr));
+		mpb.m_pHashes = &ed.m_Merkle.get_At<MyBuilder::THash>(sizeof(Hdr));
 
 		mpb.Build(pSolIndices, _countof(pSolIndices), ctx.full_dataset_num_items); // proof for this set of indices
 
-		fmpSuperTree.Open(szPathSuperTree);
-		const auto* pSuper = &fmpSuperTree.get_At<MyBuilder::THash>(0);
+		const auto* pSuper = &superTree.get_At<MyBuilder::THash>(0);
 
 		for (uint8_t h = 0; ; h++)
 		{
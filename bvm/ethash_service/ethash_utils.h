@@ -15,6 +15,7 @@
 #pragma once
 
 #include "utility/common.h"
+#include "core/mapped_file.h"
 #include <cstdint>
 #include <vector>
 
@@ -32,5 +33,16 @@ namespace beam
 
 		uint32_t GenerateProof(uint32_t iEpoch, const char* szPathCache, const char* szPathMerkle, const char* szPathSuperTree, const uintBig_t<64>& hvSeed, ByteBuffer& res);
 
+		// Local data of a single epoch, kept mapped between the proofs
+		struct EpochData
+		{
+			MappedFileRaw m_Cache;
+			MappedFileRaw m_Merkle;
+
+			void Open(const char* szPathCache, const char* szPathMerkle);
+		};
+
+		uint32_t GenerateProof(uint32_t iEpoch, const EpochData&, const MappedFileRaw& superTree, const uintBig_t<64>& hvSeed, ByteBuffer& res);
+
 	} // namespace EthashUtils
 }
\ No newline at end of file
@@ -326,6 +326,15 @@ struct Processor::Context :public Processor::Frame
 		w = val;
 	}
 
+	static bool IsU64(const Word& w, uint64_t& x)
+	{
+		if (!memis0(w.m_pData, w.nBytes - sizeof(x)))
+			return false;
+
+		w.ExportWord<sizeof(Word) / sizeof(x) - 1>(x);
+		return true;
+	}
+
 	static uint32_t NumWordsRoundUp(uint32_t n)
 	{
 		return (n + sizeof(Word) - 1) / sizeof(Word);
@@ -348,19 +357,25 @@ struct Processor::Context :public Processor::Frame
 
 void Processor::Context::LogOpCode(const char* sz)
 {
+#ifdef EVM_INTERPRETER_DEBUG
 	printf("\t%08x, %s\n", m_Code.m_Ip - 1, sz);
+#endif // EVM_INTERPRETER_DEBUG
 }
 
 void Processor::Context::LogOpCode(const char* sz, uint32_t n)
 {
+#ifdef EVM_INTERPRETER_DEBUG
 	printf("\t%08x, %s%u\n", m_Code.m_Ip - 1, sz, n);
+#endif // EVM_INTERPRETER_DEBUG
 }
 
 void Processor::Context::LogOperand(const Word& x)
 {
+#ifdef EVM_INTERPRETER_DEBUG
 	char sz[Word::nTxtLen + 1];
 	x.Print(sz);
 	printf("\t\t%s\n", sz);
+#endif // EVM_INTERPRETER_DEBUG
 }
 
 void Processor::BaseFrame::DrainGas(uint64_t n)
@@ -462,9 +477,22 @@ struct Processor::UndoOp::SetCode
 	typedef VarSet_T<Blob> Base;
 
 	ByteBuffer m_Buf;
-	using Base::Base;
+	Account& m_Account;
+
+	SetCode(Account& acc)
+		:Base(acc.m_Code)
+		,m_Account(acc)
+	{
+		acc.m_pJumpDests.reset();
+	}
+
 	~SetCode() override {}
 
+	void Undo(Processor& p) override
+	{
+		Base::Undo(p);
+		m_Account.m_pJumpDests.reset();
+	}
 };
 
 template <typename T>
@@ -477,7 +505,7 @@ void Processor::BaseFrame::UpdateVariable(Account::Variable<T>& trg, const T& x)
 
 void Processor::BaseFrame::UpdateCode(Account& acc, const Blob& code)
 {
-	auto* pOp = new UndoOp::SetCode(acc.m_Code);
+	auto* pOp = new UndoOp::SetCode(acc);
 	m_lstUndo.push_back(*pOp);
 
 	code.Export(pOp->m_Buf);
@@ -702,6 +730,13 @@ OnOpcodeBinary(add)
 
 OnOpcodeBinary(mul)
 {
+	uint64_t x, y;
+	if (IsU64(a, x) && IsU64(b, y) && !((x | y) >> 32))
+	{
+		b = x * y; // fast path, can't overflow
+		return;
+	}
+
 	Word::Number b_;
 	b_.get_Slice().SetMul(a.ToNumber().get_ConstSlice(), b.ToNumber().get_ConstSlice());
 	b.FromNumber(b_);
@@ -720,6 +755,13 @@ OnOpcodeBinary(div)
 	if (b == Zero)
 		return;
 
+	uint64_t x, y;
+	if (IsU64(a, x) && IsU64(b, y))
+	{
+		b = x / y;
+		return;
+	}
+
 	Word::Number quot;
 	quot.SetDiv(a.ToNumber(), b.ToNumber());
 	b.FromNumber(quot);
@@ -759,6 +801,13 @@ OnOpcodeBinary(mod)
 	if (b == Zero)
 		return;
 
+	uint64_t x, y;
+	if (IsU64(a, x) && IsU64(b, y))
+	{
+		b = x % y;
+		return;
+	}
+
 	auto resid = a.ToNumber();
 	Word::Number quot;
 	quot.SetDivResid(resid, b.ToNumber());
@@ -1197,13 +1246,50 @@ OnOpcode(sstore)
 	LogOperand(w2);
 }
 
+void Processor::JumpDests::Analyze(const uint8_t* p, uint32_t n)
+{
+	m_v.assign((n + 7) >> 3, 0);
+
+	for (uint32_t i = 0; i < n; )
+	{
+		uint8_t nCode = p[i];
+		if (Context::Opcode::jumpdest == nCode)
+			m_v[i >> 3] |= (1 << (i & 7));
+
+		i++;
+		if ((nCode >= 0x60) && (nCode <= 0x7f))
+			i += nCode - 0x5f; // skip push data
+	}
+}
+
 void Processor::Context::Jump(const Word& w)
 {
 	auto nAddr = WtoU32(w);
-	m_Code.m_Ip = nAddr;
-	Test(m_Code.m_Ip < m_Code.m_n);
-	Test(Opcode::jumpdest == m_Code.m_p[m_Code.m_Ip]);
 
+	if (!m_pJumpDests)
+	{
+		// share the analysis between the calls to the same contract, unless its code was changed since this frame started
+		auto& acc = *m_pAccount;
+		bool bAccCode =
+			(Type::CreateContract != m_Type) &&
+			(acc.m_Code.m_Value.p == m_Code.m_p) &&
+			(acc.m_Code.m_Value.n == m_Code.m_n);
+
+		if (bAccCode && acc.m_pJumpDests)
+			m_pJumpDests = acc.m_pJumpDests;
+		else
+		{
+			auto pJd = std::make_shared<JumpDests>();
+			pJd->Analyze(m_Code.m_p, m_Code.m_n);
+			m_pJumpDests = std::move(pJd);
+
+			if (bAccCode)
+				acc.m_pJumpDests = m_pJumpDests;
+		}
+	}
+
+	Test(m_pJumpDests->IsValid(nAddr));
+	m_Code.m_Ip = nAddr;
 }
 
 OnOpcode(jump)
@@ -71,6 +71,22 @@ namespace Evm {
 			std::vector<uint8_t> m_v;
 		};
 
+		struct JumpDests
+		{
+			// bitmap of the valid jump targets. JUMPDEST bytes within the PUSH data are excluded
+			std::vector<uint8_t> m_v;
+
+			void Analyze(const uint8_t*, uint32_t n);
+
+			bool IsValid(uint32_t nAddr) const
+			{
+				uint32_t iByte = nAddr >> 3;
+				return (iByte < m_v.size()) && ((m_v[iByte] >> (nAddr & 7)) & 1);
+			}
+
+			typedef std::shared_ptr<const JumpDests> Ptr;
+		};
+
 		struct Code
 		{
 			const uint8_t* m_p;
@@ -115,6 +131,7 @@ namespace Evm {
 			Variable<Word> m_Balance;
 			Variable<bool> m_Exists;
 			Variable<Blob> m_Code;
+			JumpDests::Ptr m_pJumpDests; // analysis of m_Code, reset when the code changes
 
 			struct Slot
 				:public intrusive::set_base_hook<Word>
@@ -186,6 +203,7 @@ namespace Evm {
 			Stack m_Stack;
 			Memory m_Memory;
 			Code m_Code;
+			JumpDests::Ptr m_pJumpDests; // analyzed on the 1st jump
 			Args m_Args;
 			Type m_Type = Type::Normal;
 		};
@@ -21,12 +21,14 @@
 #include "../../utility/hex.h"
 #include "../bvm2.h"
 #include "../bvm2_impl.h"
+#include "../ManagerStd.h"
 
 #include "../ethash_service/ethash_utils.h"
 
 #include <sstream>
 #include <algorithm>
 #include <iterator>
+#include <chrono>
 #include <math.h>
 
 #if defined(__ANDROID__) || !defined(BEAM_USE_AVX)
@@ -863,6 +865,43 @@ namespace bvm2 {
 		void TestAmm();
 
 		void TestAll();
+
+		// Benchmark mode (shaders_test --bench [runs]). The representative methods are re-run on the same state (the changes are
+		// undone after each run), before their regular invocation by the tests. The 1st run is profiled (for the host calls breakdown)
+		// and not timed.
+		struct Bench
+		{
+			struct Entry
+			{
+				uint32_t m_Runs = 0;
+				uint64_t m_Time_ns = 0;
+				uint64_t m_Charge = 0;
+				uint64_t m_Cycles = 0;
+				uint64_t m_ChargeProfiled = 0;
+				std::map<uint32_t, uint64_t> m_Host; // binding -> charge, of the profiled runs
+
+				double get_ns_PerCharge() const { return m_Charge ? (double(m_Time_ns) / double(m_Charge)) : 0.; }
+			};
+
+			uint32_t m_Runs = 0; // 0 - disabled
+			std::map<std::string, Entry> m_Map;
+
+			static void AddHost(Entry&, const Profiler::Node&);
+			void Report() const;
+
+		} m_Bench;
+
+		void BenchRun(const std::string& sName, const ContractID&, uint32_t iMethod, const Blob& args);
+
+		template <typename TArg>
+		void BenchRun_T(const char* szName, const ContractID& cid, TArg args) // by value, the arguments are modified by the shader
+		{
+			if (m_Bench.m_Runs)
+			{
+				Converter<TArg> cvt(args);
+				BenchRun(szName, cid, TArg::s_iMethod, cvt);
+			}
+		}
 	};
 
 	template <>
@@ -1117,7 +1156,20 @@ namespace bvm2 {
 
 		m_FarCalls.m_SaveLocal = true;
 
-		TestVault();
+		{
+			Profiler prof;
+			m_pProfiler = &prof;
+			TestVault();
+			m_pProfiler = nullptr;
+
+			std::ostringstream os;
+			prof.DumpFolded(os, *this);
+
+			std::string sFolded = os.str();
+			verify_test(sFolded.find("[SaveVar] ") != std::string::npos);
+			verify_test(!prof.m_Root.m_Children.empty());
+		}
+
 		TestAphorize();
 		TestNephrite();
 		TestMinter();
@@ -1137,6 +1189,122 @@ namespace bvm2 {
 		TestMirrorCoin();
 	}
 
+	void MyProcessor::BenchRun(const std::string& sName, const ContractID& cid, uint32_t iMethod, const Blob& args)
+	{
+		if (!m_Bench.m_Runs)
+			return;
+
+		auto& e = m_Bench.m_Map[sName];
+
+		bool bLogCalls = false;
+		TemporarySwap ts(m_LogCalls, bLogCalls);
+
+		FundsChangeMap fundsIO = m_FundsIO;
+		ByteBuffer buf;
+
+		for (uint32_t i = 0; i <= m_Bench.m_Runs; i++)
+		{
+			buf.assign(reinterpret_cast<const uint8_t*>(args.p), reinterpret_cast<const uint8_t*>(args.p) + args.n);
+			size_t nChanges = m_lstUndo.size();
+
+			Profiler prof;
+			if (!i)
+				m_pProfiler = &prof;
+
+			auto t0 = std::chrono::steady_clock::now();
+			bool bOk = RunGuarded(cid, iMethod, buf, nullptr);
+			uint64_t dt_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - t0).count();
+
+			m_pProfiler = nullptr;
+
+			UndoChanges(nChanges);
+			m_FundsIO = fundsIO;
+
+			if (!bOk)
+			{
+				std::cout << "Bench " << sName << " failed" << std::endl;
+				break;
+			}
+
+			uint64_t nCharge = Limits::BlockCharge - m_Charge;
+
+			if (i)
+			{
+				e.m_Runs++;
+				e.m_Time_ns += dt_ns;
+				e.m_Charge += nCharge;
+				e.m_Cycles += m_Cycles;
+			}
+			else
+			{
+				e.m_ChargeProfiled += nCharge;
+				Bench::AddHost(e, prof.m_Root);
+			}
+		}
+	}
+
+	void MyProcessor::Bench::AddHost(Entry& e, const Profiler::Node& node)
+	{
+		for (const auto& x : node.m_Host)
+			e.m_Host[x.first] += x.second;
+
+		for (const auto& x : node.m_Children)
+			AddHost(e, x.second);
+	}
+
+	void MyProcessor::Bench::Report() const
+	{
+		// the wall time per unit of charge should be roughly the same for all the methods, the outliers indicate the cost mismatch
+		std::vector<double> v;
+		for (const auto& x : m_Map)
+			if (x.second.m_Runs)
+				v.push_back(x.second.get_ns_PerCharge());
+
+		if (v.empty())
+			return;
+
+		std::sort(v.begin(), v.end());
+		double nsMedian = v[v.size() / 2];
+
+		std::cout << "Benchmark, " << m_Runs << " runs each" << std::endl;
+		std::cout << "method,us_per_call,charge,cycles,Mcycles_per_s,ns_per_charge,host_pcnt,top_host_calls" << std::endl;
+
+		for (const auto& x : m_Map)
+		{
+			const Entry& e = x.second;
+			if (!e.m_Runs)
+				continue;
+
+			uint64_t nHost = 0;
+			std::vector<std::pair<uint64_t, uint32_t> > vHost;
+			for (const auto& h : e.m_Host)
+			{
+				nHost += h.second;
+				vHost.emplace_back(h.second, h.first);
+			}
+			std::sort(vHost.rbegin(), vHost.rend());
+
+			double nsPerCharge = e.get_ns_PerCharge();
+
+			std::cout << x.first
+				<< "," << (e.m_Time_ns / e.m_Runs / 1000.)
+				<< "," << (e.m_Charge / e.m_Runs)
+				<< "," << (e.m_Cycles / e.m_Runs)
+				<< "," << (e.m_Time_ns ? (e.m_Cycles * 1e3 / e.m_Time_ns) : 0.)
+				<< "," << nsPerCharge
+				<< "," << (e.m_ChargeProfiled ? (nHost * 100 / e.m_ChargeProfiled) : 0)
+				<< ",";
+
+			for (size_t i = 0; i < std::min<size_t>(vHost.size(), 3); i++)
+				std::cout << (i ? " " : "") << ProcessorContract::get_BindingName(vHost[i].second) << ":" << vHost[i].first;
+
+			if ((nsPerCharge > nsMedian * 2) || (nsPerCharge * 2 < nsMedian))
+				std::cout << ",cost mismatch?";
+
+			std::cout << std::endl;
+		}
+	}
+
 	static void VerifyId(const ContractID& cidExp, const ContractID& cid, const char* szName)
 	{
 		if (cidExp != cid)
@@ -1213,6 +1381,31 @@ namespace bvm2 {
 		args.m_Aid = 6;
 		verify_test(RunGuarded_T(m_Vault.m_Cid, Shaders::Vault::Deposit::s_iMethod, args));
 
+		// speculative runs on top of the vars snapshot. The snapshot is not affected, hence the same withdrawal succeeds repeatedly
+		size_t nVars = m_Vars.size();
+		for (uint32_t i = 0; i < 3; i++)
+		{
+			ContractSimulator sim(m_Vars);
+
+			ByteBuffer buf(sizeof(args));
+			memcpy(&buf.front(), &args, sizeof(args));
+
+			verify_test(sim.Run(m_Vault.m_Cid, Shaders::Vault::Withdraw::s_iMethod, buf));
+			verify_test(sim.get_ChargeSpent() > 0);
+			verify_test(!sim.get_Overlay().empty());
+		}
+
+		{
+			ContractSimulator sim(m_Vars);
+
+			args.m_Amount++;
+			ByteBuffer buf(sizeof(args));
+			memcpy(&buf.front(), &args, sizeof(args));
+
+			verify_test(!sim.Run(m_Vault.m_Cid, Shaders::Vault::Withdraw::s_iMethod, buf)); // too much
+		}
+		verify_test(m_Vars.size() == nVars);
+
 		m_lstUndo.Clear();
 	}
 
@@ -1453,6 +1646,7 @@ namespace bvm2 {
 
 			{
 				TemporarySwap ts2(m_Proc.m_LogIO, bLogIO);
+				m_Proc.BenchRun("Nephrite.Method_" + std::to_string(iMethod), m_Proc.m_Nephrite.m_Cid, iMethod, Blob(&args, nSizeArgs));
 				if (!m_Proc.RunGuarded(m_Proc.m_Nephrite.m_Cid, iMethod, Blob(&args, nSizeArgs), nullptr))
 					return false;
 			}
@@ -1760,6 +1954,7 @@ namespace bvm2 {
 			Shaders::Oracle2::Method::FeedData args;
 			ZeroObject(args);
 			args.m_Value = 45; // to the moon!
+			BenchRun_T("Oracle2.FeedData", m_Oracle2.m_Cid, args);
 			verify_test(RunGuarded_T(m_Oracle2.m_Cid, args.s_iMethod, args));
 		}
 
@@ -2164,6 +2359,7 @@ namespace bvm2 {
 			args.m_Pid = pid;
 			args.m_Amounts.m_Tok1 = Rules::Coin * 3450;
 			args.m_Amounts.m_Tok2 = Rules::Coin * 170;
+			BenchRun_T("Amm.AddLiquidity", m_Amm.m_Cid, args);
 			verify_test(RunGuarded_T(m_Amm.m_Cid, args.s_iMethod, args));
 		}
 
@@ -2173,6 +2369,7 @@ namespace bvm2 {
 			args.m_Pid = pid;
 			std::swap(args.m_Pid.m_Aid1, args.m_Pid.m_Aid2);
 			args.m_Buy1 = Rules::Coin * 100; // would be very expensive
+			BenchRun_T("Amm.Trade", m_Amm.m_Cid, args);
 			verify_test(RunGuarded_T(m_Amm.m_Cid, args.s_iMethod, args));
 		}
 
@@ -2181,6 +2378,7 @@ namespace bvm2 {
 			ZeroObject(args);
 			args.m_Pid = pid;
 			args.m_Ctl = Rules::Coin * 100;
+			BenchRun_T("Amm.Withdraw", m_Amm.m_Cid, args);
 			verify_test(RunGuarded_T(m_Amm.m_Cid, args.s_iMethod, args));
 		}
 
@@ -3902,6 +4100,8 @@ namespace bvm2 {
 				args.m_Amount = 20 + i;
 				args.m_Lock = 1;
 				args.m_pkUser.m_X = i;
+				if ((1 == iEpoch) && !i)
+					BenchRun_T("DaoVote.MoveFunds", m_DaoVote.m_Cid, args);
 				verify_test(RunGuarded_T(m_DaoVote.m_Cid, args.s_iMethod, args));
 			}
 
@@ -3923,6 +4123,8 @@ namespace bvm2 {
 				args.m_Vote[1] = 1;
 				args.m_Vote[2] = 2;
 
+				if ((2 == iEpoch) && !i)
+					BenchRun_T("DaoVote.Vote", m_DaoVote.m_Cid, args);
 				verify_test(RunGuarded_T(m_DaoVote.m_Cid, args.s_iMethod, args));
 			}
 
@@ -4469,7 +4671,7 @@ namespace
 	}
 }
 
-int main()
+int main(int argc, char* argv[])
 {
 	try
 	{
@@ -4485,6 +4687,9 @@ int main()
 
 		MyProcessor proc;
 
+		if ((argc > 1) && !strcmp(argv[1], "--bench"))
+			proc.m_Bench.m_Runs = (argc > 2) ? atoi(argv[2]) : 100;
+
 		{
 
 			// const char szPathData[] = "S:\\Beam\\Data\\EthEpoch\\";
@@ -4566,6 +4771,7 @@ int main()
 
 		proc.m_Height = 10;
 		proc.TestAll();
+		proc.m_Bench.Report();
 
 		MyManager man(proc);
 		man.InitMem();
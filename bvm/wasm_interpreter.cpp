@@ -15,6 +15,7 @@
 #define _CRT_SECURE_NO_WARNINGS // sprintf
 #include "wasm_interpreter.h"
 #include "../core/uintBig.h"
+#include "../utility/metrics.h"
 #include <sstream>
 
 #define MY_TOKENIZE2(a, b) a##b
@@ -1787,22 +1788,57 @@ namespace Wasm {
 			return MemArgEx(nSize, false);
 		}
 
+		struct IpCheckpoint :public Exc::Checkpoint {
+			Word m_Ip;
+			virtual void Dump(std::ostream& os) override {
+				os << "wasm/Run, Ip=" << uintBigFrom(m_Ip);
+			}
+		};
+
 		void RunOncePlus()
 		{
-			struct MyCheckpoint :public Exc::Checkpoint {
-				Word m_Ip;
-				virtual void Dump(std::ostream& os) override {
-					os << "wasm/Run, Ip=" << uintBigFrom(m_Ip);
-				}
-			} cp;
+			IpCheckpoint cp;
 			cp.m_Ip = get_Ip();
 
+			RunInstruction(cp.m_Ip);
+		}
+
+		bool RunChargedPlus(uint32_t& nCharge, uint32_t nCycle)
+		{
+			// single checkpoint for the whole run, only the Ip is updated per instruction
+			IpCheckpoint cp;
+
+			while (m_Instruction.m_p0 != reinterpret_cast<const uint8_t*>(m_Code.p))
+			{
+				if (nCharge < nCycle)
+					return false;
+				nCharge -= nCycle; // nCharge may also be modified by the instruction (host calls)
+
+				cp.m_Ip = get_Ip();
+				auto nSp = m_Stack.m_Pos;
+
+				RunInstruction(cp.m_Ip);
+
+				if (m_Interrupt)
+				{
+					m_Interrupt = false;
+					Jmp(cp.m_Ip);
+					m_Stack.m_Pos = nSp;
+					return false;
+				}
+			}
+
+			return true;
+		}
+
+		void RunInstruction(Word nIp)
+		{
 			typedef Instruction I;
 			I nInstruction = (I) m_Instruction.Read1();
 
 #ifdef WASM_INTERPRETER_DEBUG
 			if (m_Dbg.m_Instructions)
-				*m_Dbg.m_pOut << "ip=" << uintBigFrom(cp.m_Ip) << ", sp=" << uintBigFrom(m_Stack.m_Pos) << ' ';
+				*m_Dbg.m_pOut << "ip=" << uintBigFrom(nIp) << ", sp=" << uintBigFrom(m_Stack.m_Pos) << ' ';
 
 #	define WASM_LOG_INSTRUCTION(name) if (m_Dbg.m_Instructions) (*m_Dbg.m_pOut) << #name << std::endl;
 #else // WASM_INTERPRETER_DEBUG
@@ -1929,6 +1965,14 @@ namespace Wasm {
 		p.RunOncePlus();
 	}
 
+	bool Processor::RunCharged(uint32_t& nCharge, uint32_t nCycle)
+	{
+		BEAM_METRICS_SCOPE("Wasm.Run"); // the RunOnce loop
+
+		auto& p = Cast::Up<ProcessorPlus>(*this);
+		return p.RunChargedPlus(nCharge, nCycle);
+	}
+
 	void Processor::InvokeExt(uint32_t)
 	{
 		Exc::Fail(); // unresolved binding
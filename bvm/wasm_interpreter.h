@@ -274,6 +274,7 @@ namespace Wasm {
 		Word m_prData0;
 		Blob m_LinearMem;
 		Reader m_Instruction;
+		bool m_Interrupt = false; // set during an instruction to abandon it. RunCharged restores the Ip and the operand stack and returns
 
         virtual ~Processor() = default;
 
@@ -397,6 +398,10 @@ namespace Wasm {
 
 		void RunOnce();
 
+		// Runs the instructions till the Ip gets to 0 (return from the outermost call), nCycle is discharged from nCharge before each one.
+		// The same as RunOnce in a loop with the per-instruction charge, w/o the per-instruction overhead. Returns false if ran out of charge, or interrupted
+		bool RunCharged(uint32_t& nCharge, uint32_t nCycle);
+
 		uint8_t* get_AddrEx(uint32_t nOffset, uint32_t nSize, bool bW) const;
 		uint8_t* get_AddrExVar(uint32_t nOffset, uint32_t& nSizeOut, bool bW) const;
 
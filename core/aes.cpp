@@ -479,6 +479,13 @@ void AES::Encoder::Init(const uint8_t* pKey)
 		RK[14] = RK[6] ^ RK[13];
 		RK[15] = RK[7] ^ RK[14];
 	}
+
+	for (i = 0; i < (Nr + 1) * 4; i++)
+	{
+		PUT_UINT32(m_erk[i], m_pHwKeys, i * 4);
+	}
+
+	m_bHw = IsHwSupported();
 }
 
 void AES::Decoder::Init(const Encoder& enc)
@@ -541,10 +548,149 @@ void AES::Decoder::Init(const Encoder& enc)
 }
 
 
+/* Hardware implementation */
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#	define AES_HW
+#	include <wmmintrin.h>
+#	ifdef _MSC_VER
+#		include <intrin.h>
+#		define AES_HW_TARGET
+#	else
+#		define AES_HW_TARGET __attribute__((target("aes,sse2")))
+#	endif
+
+AES_HW_TARGET static void HwEncode(const uint8_t* pKeys, uint8_t* pDst, const uint8_t* pSrc, uint32_t nBlocks)
+{
+	__m128i pK[AES::Nr + 1];
+	for (int i = 0; i <= AES::Nr; i++)
+		pK[i] = _mm_loadu_si128((const __m128i*) (pKeys + i * AES::s_BlockSize));
+
+	// 4 blocks at once, to hide the latency of aesenc
+	for (; nBlocks >= 4; nBlocks -= 4)
+	{
+		__m128i b0 = _mm_xor_si128(_mm_loadu_si128((const __m128i*) pSrc), pK[0]);
+		__m128i b1 = _mm_xor_si128(_mm_loadu_si128((const __m128i*) (pSrc + 0x10)), pK[0]);
+		__m128i b2 = _mm_xor_si128(_mm_loadu_si128((const __m128i*) (pSrc + 0x20)), pK[0]);
+		__m128i b3 = _mm_xor_si128(_mm_loadu_si128((const __m128i*) (pSrc + 0x30)), pK[0]);
+
+		for (int i = 1; i < AES::Nr; i++)
+		{
+			b0 = _mm_aesenc_si128(b0, pK[i]);
+			b1 = _mm_aesenc_si128(b1, pK[i]);
+			b2 = _mm_aesenc_si128(b2, pK[i]);
+			b3 = _mm_aesenc_si128(b3, pK[i]);
+		}
+
+		_mm_storeu_si128((__m128i*) pDst, _mm_aesenclast_si128(b0, pK[AES::Nr]));
+		_mm_storeu_si128((__m128i*) (pDst + 0x10), _mm_aesenclast_si128(b1, pK[AES::Nr]));
+		_mm_storeu_si128((__m128i*) (pDst + 0x20), _mm_aesenclast_si128(b2, pK[AES::Nr]));
+		_mm_storeu_si128((__m128i*) (pDst + 0x30), _mm_aesenclast_si128(b3, pK[AES::Nr]));
+
+		pSrc += 0x40;
+		pDst += 0x40;
+	}
+
+	for (; nBlocks; nBlocks--)
+	{
+		__m128i b = _mm_xor_si128(_mm_loadu_si128((const __m128i*) pSrc), pK[0]);
+		for (int i = 1; i < AES::Nr; i++)
+			b = _mm_aesenc_si128(b, pK[i]);
+		_mm_storeu_si128((__m128i*) pDst, _mm_aesenclast_si128(b, pK[AES::Nr]));
+
+		pSrc += AES::s_BlockSize;
+		pDst += AES::s_BlockSize;
+	}
+}
+
+bool AES::IsHwSupported()
+{
+#	ifdef _MSC_VER
+	static const bool s_bSupported = [] {
+		int pInfo[4];
+		__cpuid(pInfo, 1);
+		return 0 != (pInfo[2] & (1 << 25));
+	}();
+	return s_bSupported;
+#	else
+	static const bool s_bSupported = __builtin_cpu_supports("aes");
+	return s_bSupported;
+#	endif
+}
+
+#elif (defined(__aarch64__) || defined(_M_ARM64)) && (defined(__ARM_FEATURE_CRYPTO) || defined(__ARM_FEATURE_AES))
+#	define AES_HW
+#	include <arm_neon.h>
+
+// aese includes the AddRoundKey, hence the round keys are shifted by one w.r.t. x86
+static void HwEncode(const uint8_t* pKeys, uint8_t* pDst, const uint8_t* pSrc, uint32_t nBlocks)
+{
+	uint8x16_t pK[AES::Nr + 1];
+	for (int i = 0; i <= AES::Nr; i++)
+		pK[i] = vld1q_u8(pKeys + i * AES::s_BlockSize);
+
+	for (; nBlocks >= 4; nBlocks -= 4)
+	{
+		uint8x16_t b0 = vld1q_u8(pSrc);
+		uint8x16_t b1 = vld1q_u8(pSrc + 0x10);
+		uint8x16_t b2 = vld1q_u8(pSrc + 0x20);
+		uint8x16_t b3 = vld1q_u8(pSrc + 0x30);
+
+		for (int i = 0; i < AES::Nr - 1; i++)
+		{
+			b0 = vaesmcq_u8(vaeseq_u8(b0, pK[i]));
+			b1 = vaesmcq_u8(vaeseq_u8(b1, pK[i]));
+			b2 = vaesmcq_u8(vaeseq_u8(b2, pK[i]));
+			b3 = vaesmcq_u8(vaeseq_u8(b3, pK[i]));
+		}
+
+		vst1q_u8(pDst, veorq_u8(vaeseq_u8(b0, pK[AES::Nr - 1]), pK[AES::Nr]));
+		vst1q_u8(pDst + 0x10, veorq_u8(vaeseq_u8(b1, pK[AES::Nr - 1]), pK[AES::Nr]));
+		vst1q_u8(pDst + 0x20, veorq_u8(vaeseq_u8(b2, pK[AES::Nr - 1]), pK[AES::Nr]));
+		vst1q_u8(pDst + 0x30, veorq_u8(vaeseq_u8(b3, pK[AES::Nr - 1]), pK[AES::Nr]));
+
+		pSrc += 0x40;
+		pDst += 0x40;
+	}
+
+	for (; nBlocks; nBlocks--)
+	{
+		uint8x16_t b = vld1q_u8(pSrc);
+		for (int i = 0; i < AES::Nr - 1; i++)
+			b = vaesmcq_u8(vaeseq_u8(b, pK[i]));
+		vst1q_u8(pDst, veorq_u8(vaeseq_u8(b, pK[AES::Nr - 1]), pK[AES::Nr]));
+
+		pSrc += AES::s_BlockSize;
+		pDst += AES::s_BlockSize;
+	}
+}
+
+bool AES::IsHwSupported()
+{
+	return true; // the build targets the crypto extensions
+}
+
+#else
+
+bool AES::IsHwSupported()
+{
+	return false;
+}
+
+#endif
+
 /* AES 128-bit block encryption routine */
 
 void AES::Encoder::Proceed(uint8_t* pDst, const uint8_t* pSrc) const
 {
+#ifdef AES_HW
+	if (m_bHw)
+	{
+		HwEncode(m_pHwKeys, pDst, pSrc, 1);
+		return;
+	}
+#endif // AES_HW
+
 	uint32_t X0, X1, X2, X3, Y0, Y1, Y2, Y3;
 
 	const uint32_t* RK = m_erk;
@@ -822,27 +968,63 @@ void AES::StreamCipher::PerfXor(uint8_t* pBuf, uint32_t nSize)
 	m_nBuf -= (uint8_t) nSize;
 }
 
+void AES::Encoder::Proceed(uint8_t* pDst, const uint8_t* pSrc, uint32_t nBlocks) const
+{
+#ifdef AES_HW
+	if (m_bHw)
+	{
+		HwEncode(m_pHwKeys, pDst, pSrc, nBlocks);
+		return;
+	}
+#endif // AES_HW
+
+	for (; nBlocks; nBlocks--)
+	{
+		Proceed(pDst, pSrc);
+		pSrc += s_BlockSize;
+		pDst += s_BlockSize;
+	}
+}
+
 void AES::StreamCipher::XCrypt(const Encoder& enc, uint8_t* pBuf, uint32_t nSize)
 {
-	while (true)
+	if (m_nBuf)
+	{
+		// remaining cipherstream
+		uint8_t n = (uint8_t) std::min<uint32_t>(m_nBuf, nSize);
+		PerfXor(pBuf, n);
+
+		pBuf += n;
+		nSize -= n;
+	}
+
+	// whole blocks, the cipherstream is generated in batches
+	const uint32_t nBatch = 8;
+	while (nSize >= s_BlockSize)
 	{
-		if (!m_nBuf)
+		uint8_t pCtr[nBatch * s_BlockSize];
+		uint32_t nBlocks = std::min(nSize / s_BlockSize, nBatch);
+		uint32_t nBytes = nBlocks * s_BlockSize;
+
+		for (uint32_t i = 0; i < nBlocks; i++)
 		{
-			enc.Proceed(m_pBuf, m_Counter.m_pData);
-			m_nBuf = _countof(m_pBuf);
+			memcpy(pCtr + i * s_BlockSize, m_Counter.m_pData, s_BlockSize);
 			m_Counter.Inc();
 		}
 
-		if (m_nBuf >= nSize)
-		{
-			PerfXor(pBuf, nSize);
-			break;
-		}
+		enc.Proceed(pCtr, pCtr, nBlocks);
+		memxor(pBuf, pCtr, nBytes);
 
-		uint8_t n = m_nBuf;
-		PerfXor(pBuf, m_nBuf);
+		pBuf += nBytes;
+		nSize -= nBytes;
+	}
 
-		pBuf += n;
-		nSize -= n;
+	if (nSize)
+	{
+		enc.Proceed(m_pBuf, m_Counter.m_pData);
+		m_nBuf = _countof(m_pBuf);
+		m_Counter.Inc();
+
+		PerfXor(pBuf, nSize);
 	}
 }
@@ -8,11 +8,18 @@ struct AES
 	static const int Nr = 14; // num-rounds
 	static const int s_BlockSize = 16;
 
+	// AES-NI (x86) or ARMv8 crypto extensions, detected at runtime
+	static bool IsHwSupported();
+
 	struct Encoder
 	{
 		uint32_t m_erk[64]; // encryption round keys. Actually needed 60, but during init extra space is used
+		uint8_t m_pHwKeys[(Nr + 1) * s_BlockSize]; // same round keys in the byte order, for the hw implementation
+		bool m_bHw; // set by Init if supported, can be reset to force the portable implementation
+
 		void Init(const uint8_t* pKey);
 		void Proceed(uint8_t* pDst, const uint8_t* pSrc) const;
+		void Proceed(uint8_t* pDst, const uint8_t* pSrc, uint32_t nBlocks) const; // independent blocks, interleaved by the hw implementation
 	};
 
 	struct Decoder
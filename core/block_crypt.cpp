@@ -533,6 +533,8 @@ namespace beam
 		bool isPublic = (OpCode::Public == eOp) || m_Coinbase;
 
 		ECC::Scalar::Native skSign = sk;
+		Asset::Proof::Deferred dAsset;
+
 		if (cid.m_AssetID || (!isPublic && Asset::Proof::Params::get_AidMax(hScheme)))
 		{
 			ECC::Hash::Value hv;
@@ -540,9 +542,66 @@ namespace beam
 				cid.get_Hash(hv);
 
 			m_pAsset = std::make_unique<Asset::Proof>();
-			m_pAsset->Create(hScheme, wrk.m_hGen, skSign, cid.m_Value, cid.m_AssetID, wrk.m_hGen, bUseCoinKdf ? nullptr : &hv);
+			m_pAsset->CreateDeferred(dAsset, hScheme, wrk.m_hGen, skSign, cid.m_Value, cid.m_AssetID, wrk.m_hGen, bUseCoinKdf ? nullptr : &hv);
 		}
 
+		// The asset proof and the rangeproof are independent (the latter only needs the blinded generator), and have comparable cost.
+		// If an executor is available - generate them in parallel
+		Executor* pEx = Executor::s_pInstance;
+		if (m_pAsset && pEx && (pEx->get_Threads() > 1))
+		{
+			struct MyTask
+				:public Executor::TaskSync
+			{
+				Output* m_pThis;
+				Asset::Proof::Deferred* m_pAsset;
+				const ECC::Scalar::Native* m_pSk;
+				const CoinID* m_pCid;
+				const CoinID::Worker* m_pWrk;
+				Key::IPKdf* m_pTagKdf;
+				OpCode::Enum m_eOp;
+				const User* m_pUser;
+				bool m_bUseCoinKdf;
+				bool m_IsPublic;
+				Height m_hScheme;
+
+				virtual void Exec(Executor::Context& ctx) override
+				{
+					if (1 == ctx.m_iThread)
+						m_pAsset->Generate();
+					else
+					{
+						if (!ctx.m_iThread)
+							m_pThis->CreateRangeProof(m_hScheme, *m_pSk, *m_pCid, *m_pWrk, *m_pTagKdf, m_eOp, m_pUser, m_bUseCoinKdf, m_IsPublic);
+					}
+				}
+			} t;
+
+			t.m_pThis = this;
+			t.m_pAsset = &dAsset;
+			t.m_pSk = &skSign;
+			t.m_pCid = &cid;
+			t.m_pWrk = &wrk;
+			t.m_pTagKdf = &tagKdf;
+			t.m_eOp = eOp;
+			t.m_pUser = pUser;
+			t.m_bUseCoinKdf = bUseCoinKdf;
+			t.m_IsPublic = isPublic;
+			t.m_hScheme = hScheme;
+
+			pEx->ExecAll(t);
+		}
+		else
+		{
+			if (m_pAsset)
+				dAsset.Generate();
+
+			CreateRangeProof(hScheme, skSign, cid, wrk, tagKdf, eOp, pUser, bUseCoinKdf, isPublic);
+		}
+	}
+
+	void Output::CreateRangeProof(Height hScheme, const ECC::Scalar::Native& skSign, const CoinID& cid, const CoinID::Worker& wrk, Key::IPKdf& tagKdf, OpCode::Enum eOp, const User* pUser, bool bUseCoinKdf, bool isPublic)
+	{
 		ECC::Oracle oracle;
 		Prepare(oracle, hScheme);
 
@@ -2969,6 +3028,16 @@ namespace beam
 		return (hv == m_Kernels);
 	}
 
+	bool Block::SystemState::Full::IsValidProofUtxoRoot(const Merkle::Hash& hvUtxos, const Merkle::Proof& p) const
+	{
+		if (!Rules::get().IsPastFork_<3>(m_Height))
+			return false; // not a separate element of the definition
+
+		Merkle::Hash hv = hvUtxos;
+		Merkle::Interpret(hv, p);
+		return (hv == m_Kernels);
+	}
+
 	bool Block::SystemState::Full::IsValidProofShieldedOutp(const ShieldedTxo::DescriptionOutp& d, const Merkle::Proof& p) const
 	{
 		Merkle::Hash hv;
@@ -3586,6 +3655,13 @@ namespace beam
 	}
 
 	void Asset::Proof::Create(Height hScheme, ECC::Point::Native& genBlinded, ECC::Scalar::Native& skInOut, Amount val, Asset::ID aid, const ECC::Point::Native& gen, const ECC::Hash::Value* phvSeed)
+	{
+		Deferred d;
+		CreateDeferred(d, hScheme, genBlinded, skInOut, val, aid, gen, phvSeed);
+		d.Generate();
+	}
+
+	void Asset::Proof::CreateDeferred(Deferred& d, Height hScheme, ECC::Point::Native& genBlinded, ECC::Scalar::Native& skInOut, Amount val, Asset::ID aid, const ECC::Point::Native& gen, const ECC::Hash::Value* phvSeed)
 	{
 		ECC::NonceGenerator nonceGen("out-sk-asset");
 		ECC::NoLeak<ECC::Scalar> k;
@@ -3608,10 +3684,17 @@ namespace beam
 
 		ModifySk(skInOut, skAsset, val);
 
-		Create(hScheme, genBlinded, skAsset, aid, gen);
+		InitDeferred(d, hScheme, genBlinded, skAsset, aid, gen);
 	}
 
 	void Asset::Proof::Create(Height hScheme, ECC::Point::Native& genBlinded, const ECC::Scalar::Native& skGen, Asset::ID aid, const ECC::Point::Native& gen)
+	{
+		Deferred d;
+		InitDeferred(d, hScheme, genBlinded, skGen, aid, gen);
+		d.Generate();
+	}
+
+	void Asset::Proof::InitDeferred(Deferred& d, Height hScheme, ECC::Point::Native& genBlinded, const ECC::Scalar::Native& skGen, Asset::ID aid, const ECC::Point::Native& gen)
 	{
 		if (aid)
 			genBlinded = gen;
@@ -3621,25 +3704,42 @@ namespace beam
 		genBlinded += ECC::Context::get().G * skGen;
 		m_hGen = genBlinded;
 
+		// the window selection depends on the (thread-local) aidMax, must be done here
 		const Rules& r = Rules::get();
 		CmList lst(r, hScheme);
 
 		lst.SelectWindow(aid, r, skGen);
 		m_Begin = lst.m_Aid0;
 
-		Sigma::Prover prover(lst, r.CA.m_ProofCfg, *this);
-		prover.m_Witness.m_L = aid ? (aid - lst.m_Aid0) : 0; // should be correct, with both schemes
-		prover.m_Witness.m_R = -skGen;
+		d.m_pProof = this;
+		d.m_hScheme = hScheme;
+		d.m_Aid = aid;
+		d.m_skGen = skGen;
+		d.m_GenBlinded = genBlinded;
+	}
+
+	void Asset::Proof::Deferred::Generate()
+	{
+		assert(m_pProof);
+		Proof& p = *m_pProof;
+
+		const Rules& r = Rules::get();
+		CmList lst(r, m_hScheme);
+		lst.m_Aid0 = p.m_Begin;
+
+		Sigma::Prover prover(lst, r.CA.m_ProofCfg, p);
+		prover.m_Witness.m_L = m_Aid ? (m_Aid - lst.m_Aid0) : 0; // should be correct, with both schemes
+		prover.m_Witness.m_R = -m_skGen;
 
 		ECC::Hash::Value hvSeed;
 		ECC::Hash::Processor()
 			<< "asset-pr-gen"
-			<< skGen
+			<< m_skGen
 			>> hvSeed;
 
 		ECC::Oracle oracle;
-		oracle << m_hGen;
-		prover.Generate(hvSeed, oracle, genBlinded);
+		oracle << p.m_hGen;
+		prover.Generate(hvSeed, oracle, m_GenBlinded);
 	}
 
 	void Asset::Proof::ModifySk(ECC::Scalar::Native& skInOut, const ECC::Scalar::Native& skGen, Amount val)
@@ -360,6 +360,21 @@ namespace beam
 			void Create(Height, ECC::Point::Native& genBlinded, ECC::Scalar::Native& skInOut, Amount val, Asset::ID, const ECC::Hash::Value* phvSeed = nullptr);
 			void Create(Height, ECC::Point::Native& genBlinded, const ECC::Scalar::Native& skGen, Asset::ID, const ECC::Point::Native& gen);
 
+			// 2-stage creation. The 1st stage blinds the generator and selects the window (cheap), the Sigma proof is generated in the 2nd stage.
+			// After the 1st stage m_hGen is already valid, so that the rangeproof may be created concurrently with the 2nd stage.
+			struct Deferred
+			{
+				Proof* m_pProof;
+				Height m_hScheme;
+				Asset::ID m_Aid;
+				ECC::Scalar::Native m_skGen;
+				ECC::Point::Native m_GenBlinded;
+
+				void Generate(); // doesn't depend on thread-local params, can be called from any thread
+			};
+
+			void CreateDeferred(Deferred&, Height, ECC::Point::Native& genBlinded, ECC::Scalar::Native& skInOut, Amount val, Asset::ID, const ECC::Point::Native& gen, const ECC::Hash::Value* phvSeed = nullptr);
+
 			static void ModifySk(ECC::Scalar::Native& skInOut, const ECC::Scalar::Native& skGen, Amount val);
 
 			static void Expose(ECC::Oracle&, Height hScheme, const Ptr&);
@@ -388,6 +403,7 @@ namespace beam
 
 		private:
 			struct CmList;
+			void InitDeferred(Deferred&, Height, ECC::Point::Native& genBlinded, const ECC::Scalar::Native& skGen, Asset::ID, const ECC::Point::Native& gen);
 		};
 	};
 
@@ -730,6 +746,8 @@ namespace beam
 		} m_Internal;
 
 		typedef std::unique_ptr<Input> Ptr;
+		BEAM_ARENA_ALLOCATED
+
 		typedef uint32_t Count; // the type for count of duplicate UTXOs in the system
 
 		struct State
@@ -789,6 +807,7 @@ namespace beam
 		:public TxElement
 	{
 		typedef std::unique_ptr<Output> Ptr;
+		BEAM_ARENA_ALLOCATED
 
 		bool		m_Coinbase;
 		Height		m_Incubation; // # of blocks before it's mature
@@ -879,6 +898,7 @@ namespace beam
 	private:
 		struct PackedKA; // Key::ID + Asset::ID
 		bool IsValid2(Height hScheme, ECC::Point::Native& comm, const ECC::Point::Native* pGen) const;
+		void CreateRangeProof(Height hScheme, const ECC::Scalar::Native& skSign, const CoinID&, const CoinID::Worker&, Key::IPKdf& tagKdf, OpCode::Enum, const User*, bool bUseCoinKdf, bool isPublic);
 	};
 
 	inline bool operator < (const Output::Ptr& a, const Output::Ptr& b) { return *a < *b; }
@@ -1075,6 +1095,7 @@ namespace beam
 	struct TxKernel
 	{
 		typedef std::unique_ptr<TxKernel> Ptr;
+		BEAM_ARENA_ALLOCATED // inherited by all the kernel types
 
 		struct Subtype
 		{
@@ -1528,6 +1549,18 @@ namespace beam
 
 			void MoveInto(Full& trg);
 		};
+
+		// Structure-of-arrays view for validation: the commitments are contiguous, so that the ordering/duplicate checks
+		// and the point imports don't chase the element pointers. Built once per block, shared by all the verifiers.
+		// Refers to the Full it was built from, which must stay unchanged while the view is used
+		struct Flat
+		{
+			const Full* m_pTxv = nullptr;
+			std::vector<ECC::Point> m_vInputs;
+			std::vector<ECC::Point> m_vOutputs;
+
+			void Build(const Full&);
+		};
 	};
 
 	struct Transaction
@@ -1689,6 +1722,7 @@ namespace beam
 				bool IsValidProofLog(const Merkle::Hash& hvLog, const Merkle::Proof&) const;
 
 				bool IsValidProofUtxo(const ECC::Point&, const Input::Proof&) const;
+				bool IsValidProofUtxoRoot(const Merkle::Hash& hvUtxos, const Merkle::Proof&) const; // UTXO tree root vs definition, since Fork3
 				bool IsValidProofShieldedOutp(const ShieldedTxo::DescriptionOutp&, const Merkle::Proof&) const;
 				bool IsValidProofShieldedInp(const ShieldedTxo::DescriptionInp&, const Merkle::Proof&) const;
 				bool IsValidProofAsset(const Asset::Full&, const Merkle::Proof&) const;
@@ -1814,6 +1848,11 @@ namespace beam
 		void TestHeightNotEmpty() const;
 		void HandleElementHeightStrict(const HeightRange&);
 
+		void PrepareValidation();
+		void ValidateOutput(const Output&, const Output* pPrev, ECC::Point::Native&);
+		void ValidateKernel(const TxKernel&, const TxKernel* pPrev);
+		void FinishValidation(const TxBase&, uint32_t& iV);
+
 	public:
 		// Tests the validity of all the components, overall arithmetics, and the lexicographical order of the components.
 		// Determines the min/max block height that the transaction can fit, wrt component heights and maturity policies
@@ -1859,6 +1898,7 @@ namespace beam
 		void Reset();
 
 		void ValidateAndSummarizeStrict(const TxBase&, IReader&&);
+		void ValidateAndSummarizeStrict(const TxBase&, const TxVectors::Flat&); // same, w/o the reader indirection
 		bool ValidateAndSummarize(const TxBase&, IReader&&, std::string* psErr = nullptr);
 		void MergeStrict(const Context&);
 
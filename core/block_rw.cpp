@@ -400,6 +400,7 @@ namespace beam
 		void Open(const char*);
 		bool Proceed();
 		bool ProceedUtxos();
+		bool FlushUtxos(std::vector<UtxoEntry>&);
 		bool ProceedShielded();
 		bool ProceedAssets();
 		void Finalyze();
@@ -544,6 +545,9 @@ namespace beam
 
 	bool RecoveryInfo::IParser::Context::ProceedUtxos()
 	{
+		std::vector<UtxoEntry> vBatch;
+		vBatch.reserve(s_UtxoBatch);
+
 		while (true)
 		{
 			if (!m_Stream.get_Remaining())
@@ -555,12 +559,13 @@ namespace beam
 			if (MaxHeight == h)
 				break;
 
-			Output outp;
-			yas::detail::loadRecovery(m_Der, outp, h);
+			UtxoEntry& x = vBatch.emplace_back();
+			x.m_Height = h;
+			yas::detail::loadRecovery(m_Der, x.m_Output, h);
 
 			UtxoTree::Key::Data d;
-			d.m_Commitment = outp.m_Commitment;
-			d.m_Maturity = outp.get_MinMaturity(h);
+			d.m_Commitment = x.m_Output.m_Commitment;
+			d.m_Maturity = x.m_Output.get_MinMaturity(h);
 
 			UtxoTree::Key key;
 			key = d;
@@ -568,12 +573,30 @@ namespace beam
 			if (!m_UtxoTree.Add(key))
 				ThrowBadData();
 
-			if (!m_Parser.OnUtxo(h, outp))
+			if ((vBatch.size() >= s_UtxoBatch) && !FlushUtxos(vBatch))
 				return false;
+		}
 
-			if (!OnProgress())
+		return FlushUtxos(vBatch);
+	}
+
+	bool RecoveryInfo::IParser::Context::FlushUtxos(std::vector<UtxoEntry>& v)
+	{
+		if (v.empty())
+			return true;
+
+		if (!m_Parser.OnUtxoBatch(v))
+			return false;
+
+		v.clear();
+		return OnProgress();
+	}
+
+	bool RecoveryInfo::IParser::OnUtxoBatch(std::vector<UtxoEntry>& v)
+	{
+		for (const auto& x : v)
+			if (!OnUtxo(x.m_Height, x.m_Output))
 				return false;
-		}
 
 		return true;
 	}
@@ -686,6 +709,61 @@ namespace beam
 		}
 	}
 
+	bool RecoveryInfo::IRecognizer::OnUtxoBatch(std::vector<UtxoEntry>& v)
+	{
+		Executor* pEx = Executor::s_pInstance;
+		if (!m_pOwner || !pEx || (pEx->get_Threads() <= 1) || (v.size() <= 1))
+			return IParser::OnUtxoBatch(v);
+
+		struct Result
+		{
+			CoinID m_Cid;
+			Output::User m_User;
+			bool m_Recognized;
+		};
+
+		std::vector<Result> vRes(v.size());
+
+		// Output::Recover is context-free, the owner kdf is only read
+		struct MyTask
+			:public Executor::TaskSync
+		{
+			Key::IPKdf* m_pOwner;
+			const UtxoEntry* m_pUtxos;
+			Result* m_pRes;
+			uint32_t m_Count;
+
+			virtual void Exec(Executor::Context& ctx) override
+			{
+				uint32_t i0, nPortion;
+				ctx.get_Portion(i0, nPortion, m_Count);
+
+				for (uint32_t i = i0; i < i0 + nPortion; i++)
+				{
+					const UtxoEntry& x = m_pUtxos[i];
+					Result& r = m_pRes[i];
+					r.m_Recognized = x.m_Output.Recover(x.m_Height, *m_pOwner, r.m_Cid, &r.m_User);
+				}
+			}
+		} t;
+
+		t.m_pOwner = m_pOwner.get();
+		t.m_pUtxos = &v.front();
+		t.m_pRes = &vRes.front();
+		t.m_Count = static_cast<uint32_t>(v.size());
+
+		pEx->ExecAll(t);
+
+		for (size_t i = 0; i < v.size(); i++)
+		{
+			Result& r = vRes[i];
+			if (r.m_Recognized && !OnUtxoRecognized(v[i].m_Height, v[i].m_Output, r.m_Cid, r.m_User))
+				return false;
+		}
+
+		return true;
+	}
+
 	bool RecoveryInfo::IRecognizer::OnUtxo(Height h, const Output& outp)
 	{
 		if (m_pOwner)
@@ -70,9 +70,18 @@ namespace beam
 
 		struct IParser
 		{
+			struct UtxoEntry
+			{
+				Height m_Height;
+				Output m_Output;
+			};
+
+			static const uint32_t s_UtxoBatch = 0x400; // utxos are parsed and reported in batches of up to this size
+
 			// each of the following returns false to abort
 			virtual bool OnProgress(uint64_t nPos, uint64_t nTotal) { return true; }
 			virtual bool OnStates(std::vector<Block::SystemState::Full>&) { return true; }
+			virtual bool OnUtxoBatch(std::vector<UtxoEntry>&); // by default calls OnUtxo for each, in order
 			virtual bool OnUtxo(Height, const Output&) { return true; }
 			virtual bool OnShieldedOut(const ShieldedTxo::DescriptionOutp& , const ShieldedTxo&, const ECC::Hash::Value& hvMsg, Height) { return true; }
 			virtual bool OnShieldedIn(const ShieldedTxo::DescriptionInp&) { return true; }
@@ -91,6 +100,8 @@ namespace beam
 
 			void Init(const Key::IPKdf::Ptr&, Key::Index nMaxShieldedIdx = 1);
 
+			// if there's an Executor in scope - the batch is recognized in parallel, OnUtxoRecognized is still called in order
+			virtual bool OnUtxoBatch(std::vector<UtxoEntry>&) override;
 			virtual bool OnUtxo(Height, const Output&) override;
 			virtual bool OnShieldedOut(const ShieldedTxo::DescriptionOutp&, const ShieldedTxo&, const ECC::Hash::Value& hvMsg, Height) override;
 			virtual bool OnAsset(Asset::Full&) override;
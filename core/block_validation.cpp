@@ -16,6 +16,20 @@
 
 namespace beam
 {
+	namespace
+	{
+		struct InputCheckpoint :public Exc::Checkpoint
+		{
+			const ECC::Point& m_Comm;
+			InputCheckpoint(const ECC::Point& comm) :m_Comm(comm) {}
+
+			void Dump(std::ostream& os) override
+			{
+				os << "Input " << m_Comm;
+			}
+		};
+	}
+
 	/////////////
 	// Transaction
 	void TxBase::Fail_Order() {
@@ -91,19 +105,23 @@ namespace beam
 
 	void TxBase::Context::ValidateAndSummarizeStrict(const TxBase& txb, IReader&& r)
 	{
-		TestHeightNotEmpty();
+		if (!ECC::InnerProduct::BatchContext::s_pInstance)
+		{
+			// fold all the kernel signatures and rangeproofs into a single multi-exponentiation
+			ECC::InnerProduct::BatchContextEx<4> bc;
+			ECC::InnerProduct::BatchContext::Scope scopeBc(bc);
 
-		const Rules& rules = Rules::get(); // alias
+			ValidateAndSummarizeStrict(txb, std::move(r));
 
-		auto iFork = rules.FindFork(m_Height.m_Min);
-		std::setmin(m_Height.m_Max, rules.get_ForkMaxHeightSafe(iFork)); // mixed versions are not allowed!
-		assert(!m_Height.IsEmpty());
+			if (!bc.Flush())
+				Fail_Signature();
 
-		ECC::Mode::Scope scope(ECC::Mode::Fast);
+			return;
+		}
 
-		m_Sigma = -m_Sigma;
+		PrepareValidation();
+		ECC::Mode::Scope scope(ECC::Mode::Fast);
 
-		assert(m_Params.m_nVerifiers);
 		uint32_t iV = m_iVerifier;
 
 		// Inputs
@@ -117,17 +135,7 @@ namespace beam
 
 			if (ShouldVerify(iV))
 			{
-				struct MyCheckpoint :public Exc::Checkpoint {
-
-					const Input& m_Inp;
-					MyCheckpoint(const Input& inp) :m_Inp(inp) {}
-
-					void Dump(std::ostream& os) override
-					{
-						os << "Input " << m_Inp.m_Commitment;
-					}
-
-				} cp(*r.m_pUtxoIn);
+				InputCheckpoint cp(r.m_pUtxoIn->m_Commitment);
 
 				if (pPrev && (*pPrev > *r.m_pUtxoIn))
 					Fail_Order();
@@ -160,72 +168,195 @@ namespace beam
 			TestAbort();
 
 			if (ShouldVerify(iV))
-			{
-				struct MyCheckpoint :public Exc::Checkpoint {
+				ValidateOutput(*r.m_pUtxoOut, pPrev, pt);
+		}
 
-					const Output& m_Outp;
-					MyCheckpoint(const Output& outp) :m_Outp(outp) {}
+		for (const TxKernel* pPrev = NULL; r.m_pKernel; pPrev = r.m_pKernel, r.NextKernel())
+		{
+			TestAbort();
 
-					void Dump(std::ostream& os) override
-					{
-						os << "Output " << m_Outp.m_Commitment;
-					}
+			if (ShouldVerify(iV))
+				ValidateKernel(*r.m_pKernel, pPrev);
+		}
 
-				} cp(*r.m_pUtxoOut);
+		FinishValidation(txb, iV);
+	}
 
-				if (pPrev && (*pPrev > *r.m_pUtxoOut))
-				{
-					// in case of unsigned outputs sometimes order of outputs may look incorrect (duplicated commitment, part of signatures removed)
-					if (!m_Params.m_bAllowUnsignedOutputs || (pPrev->m_Commitment != r.m_pUtxoOut->m_Commitment))
-						Fail_Order();
-				}
+	void TxBase::Context::ValidateAndSummarizeStrict(const TxBase& txb, const TxVectors::Flat& fv)
+	{
+		if (!ECC::InnerProduct::BatchContext::s_pInstance)
+		{
+			ECC::InnerProduct::BatchContextEx<4> bc;
+			ECC::InnerProduct::BatchContext::Scope scopeBc(bc);
 
-				bool bSigned = r.m_pUtxoOut->m_pConfidential || r.m_pUtxoOut->m_pPublic;
+			ValidateAndSummarizeStrict(txb, fv);
 
-				if (bSigned)
-				{
-					if (!r.m_pUtxoOut->IsValid(m_Height.m_Min, pt))
-						Fail_Signature();
-				}
-				else
+			if (!bc.Flush())
+				Fail_Signature();
+
+			return;
+		}
+
+		assert(fv.m_pTxv);
+		const TxVectors::Full& txv = *fv.m_pTxv;
+		assert((fv.m_vInputs.size() == txv.m_vInputs.size()) && (fv.m_vOutputs.size() == txv.m_vOutputs.size()));
+
+		PrepareValidation();
+		ECC::Mode::Scope scope(ECC::Mode::Fast);
+
+		uint32_t iV = m_iVerifier;
+
+		// Inputs. Same as above, but only the contiguous commitments are touched
+		ECC::Point::Native pt;
+
+		const ECC::Point* pIn = fv.m_vInputs.empty() ? nullptr : &fv.m_vInputs.front();
+		const ECC::Point* pOut = fv.m_vOutputs.empty() ? nullptr : &fv.m_vOutputs.front();
+		const ECC::Point* pOutEnd = pOut + fv.m_vOutputs.size();
+
+		for (size_t i = 0; i < fv.m_vInputs.size(); i++)
+		{
+			TestAbort();
+
+			if (ShouldVerify(iV))
+			{
+				const ECC::Point& comm = pIn[i];
+				InputCheckpoint cp(comm);
+
+				if (i && (pIn[i - 1] > comm))
+					Fail_Order();
+
+				for (; pOut != pOutEnd; pOut++)
 				{
-					// unsigned output
-					if (!m_Params.m_bAllowUnsignedOutputs)
-						Exc::Fail("Missing rangeproof");
+					int n = comm.cmp(*pOut);
+					if (n < 0)
+						break;
 
-					pt.ImportStrict(r.m_pUtxoOut->m_Commitment);
+					if (!n)
+						Exc::Fail("dup out");
 				}
 
-				r.m_pUtxoOut->AddStats(m_Stats);
+				pt.ImportStrict(comm);
+
+				m_Stats.m_Inputs++;
 				m_Sigma += pt;
 			}
 		}
 
-		for (const TxKernel* pPrev = NULL; r.m_pKernel; pPrev = r.m_pKernel, r.NextKernel())
+		m_Sigma = -m_Sigma;
+
+		// Outputs and kernels, directly over the vectors
+		for (size_t i = 0; i < txv.m_vOutputs.size(); i++)
 		{
 			TestAbort();
 
 			if (ShouldVerify(iV))
-			{
-				TxKernel::Checkpoint cp(*r.m_pKernel);
+				ValidateOutput(*txv.m_vOutputs[i], i ? txv.m_vOutputs[i - 1].get() : nullptr, pt);
+		}
+
+		for (size_t i = 0; i < txv.m_vKernels.size(); i++)
+		{
+			TestAbort();
+
+			if (ShouldVerify(iV))
+				ValidateKernel(*txv.m_vKernels[i], i ? txv.m_vKernels[i - 1].get() : nullptr);
+		}
+
+		FinishValidation(txb, iV);
+	}
+
+	void TxBase::Context::PrepareValidation()
+	{
+		TestHeightNotEmpty();
+
+		const Rules& rules = Rules::get(); // alias
+
+		auto iFork = rules.FindFork(m_Height.m_Min);
+		std::setmin(m_Height.m_Max, rules.get_ForkMaxHeightSafe(iFork)); // mixed versions are not allowed!
+		assert(!m_Height.IsEmpty());
 
-				if (pPrev && ((*pPrev) > (*r.m_pKernel)))
-					Fail_Order(); // wrong order
+		m_Sigma = -m_Sigma;
+
+		assert(m_Params.m_nVerifiers);
+	}
 
-				r.m_pKernel->TestValid(m_Height.m_Min, m_Sigma);
+	void TxBase::Context::ValidateOutput(const Output& outp, const Output* pPrev, ECC::Point::Native& pt)
+	{
+		struct MyCheckpoint :public Exc::Checkpoint {
 
-				HandleElementHeightStrict(r.m_pKernel->get_EffectiveHeightRange());
+			const Output& m_Outp;
+			MyCheckpoint(const Output& outp) :m_Outp(outp) {}
 
-				r.m_pKernel->AddStats(m_Stats);
+			void Dump(std::ostream& os) override
+			{
+				os << "Output " << m_Outp.m_Commitment;
 			}
+
+		} cp(outp);
+
+		if (pPrev && (*pPrev > outp))
+		{
+			// in case of unsigned outputs sometimes order of outputs may look incorrect (duplicated commitment, part of signatures removed)
+			if (!m_Params.m_bAllowUnsignedOutputs || (pPrev->m_Commitment != outp.m_Commitment))
+				Fail_Order();
+		}
+
+		bool bSigned = outp.m_pConfidential || outp.m_pPublic;
+
+		if (bSigned)
+		{
+			if (!outp.IsValid(m_Height.m_Min, pt))
+				Fail_Signature();
 		}
+		else
+		{
+			// unsigned output
+			if (!m_Params.m_bAllowUnsignedOutputs)
+				Exc::Fail("Missing rangeproof");
+
+			pt.ImportStrict(outp.m_Commitment);
+		}
+
+		outp.AddStats(m_Stats);
+		m_Sigma += pt;
+	}
 
+	void TxBase::Context::ValidateKernel(const TxKernel& krn, const TxKernel* pPrev)
+	{
+		TxKernel::Checkpoint cp(krn);
+
+		if (pPrev && ((*pPrev) > krn))
+			Fail_Order(); // wrong order
+
+		krn.TestValid(m_Height.m_Min, m_Sigma);
+
+		HandleElementHeightStrict(krn.get_EffectiveHeightRange());
+
+		krn.AddStats(m_Stats);
+	}
+
+	void TxBase::Context::FinishValidation(const TxBase& txb, uint32_t& iV)
+	{
 		if (ShouldVerify(iV) && !(txb.m_Offset.m_Value == Zero))
 			m_Sigma += ECC::Context::get().G * txb.m_Offset;
 
 		assert(!m_Height.IsEmpty());
 	}
 
+	/////////////
+	// TxVectors::Flat
+	void TxVectors::Flat::Build(const Full& txv)
+	{
+		m_pTxv = &txv;
+
+		m_vInputs.resize(txv.m_vInputs.size());
+		for (size_t i = 0; i < m_vInputs.size(); i++)
+			m_vInputs[i] = txv.m_vInputs[i]->m_Commitment;
+
+		m_vOutputs.resize(txv.m_vOutputs.size());
+		for (size_t i = 0; i < m_vOutputs.size(); i++)
+			m_vOutputs[i] = txv.m_vOutputs[i]->m_Commitment;
+	}
+
 	void TxBase::Context::TestSigma()
 	{
 		if (m_Sigma != Zero)
@@ -15,6 +15,8 @@
 #include "common.h"
 #include "ecc_native.h"
 #include "../utility/common.h" // Exc
+#include "../utility/executor.h"
+#include "../utility/metrics.h"
 
 #if defined(__clang__) || defined(__GNUC__) || defined(__GNUG__)
 #	pragma GCC diagnostic push
@@ -44,6 +46,25 @@
 #    include <fcntl.h>
 #endif // WIN32
 
+#ifdef __linux__
+#	include <sys/mman.h>
+#endif // __linux__
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#	define BEAM_SHA256_X86
+#	include <immintrin.h>
+#	if defined(_MSC_VER) && !defined(__clang__)
+#		include <intrin.h>
+#		define BEAM_TARGET_SHA
+#	else
+#		include <cpuid.h>
+#		define BEAM_TARGET_SHA __attribute__((target("sha,sse4.1")))
+#	endif
+#elif defined(__aarch64__) && defined(__ARM_FEATURE_SHA2)
+#	define BEAM_SHA256_ARM
+#	include <arm_neon.h>
+#endif
+
 //#ifdef __linux__
 //#	include <sys/syscall.h>
 //#	include <linux/random.h>
@@ -351,6 +372,220 @@ namespace ECC {
 
 	/////////////////////
 	// Hash
+	namespace Sha256
+	{
+		typedef void (*Transform)(uint32_t* s, const uint8_t* p); // single 64-byte block
+
+		void Transform_Std(uint32_t* s, const uint8_t* p)
+		{
+			secp256k1_sha256_transform(s, p);
+		}
+
+#if defined(BEAM_SHA256_X86) || defined(BEAM_SHA256_ARM)
+		alignas(16) const uint32_t s_pK[64] = {
+			0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+			0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+			0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+			0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+			0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+			0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+			0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+			0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+		};
+#endif
+
+#ifdef BEAM_SHA256_X86
+		// Intel SHA extensions. The message schedule is kept in a ring of 4 vectors, 4 rounds per iteration
+		// The lanes are independent and interleaved, to hide the latency of the sha instructions
+		template <uint32_t nLanes>
+		BEAM_TARGET_SHA void Transform_ShaNi_T(uint32_t* const* ps, const uint8_t* const* pp)
+		{
+			const __m128i msk = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+
+			__m128i pSt0[nLanes], pSt1[nLanes], pSt0Save[nLanes], pSt1Save[nLanes];
+			__m128i pW[nLanes][4];
+
+			for (uint32_t iLane = 0; iLane < nLanes; iLane++)
+			{
+				__m128i tmp = _mm_loadu_si128((const __m128i*) ps[iLane]);
+				__m128i st1 = _mm_loadu_si128((const __m128i*) (ps[iLane] + 4));
+
+				tmp = _mm_shuffle_epi32(tmp, 0xB1); // CDAB
+				st1 = _mm_shuffle_epi32(st1, 0x1B); // EFGH
+				pSt0[iLane] = pSt0Save[iLane] = _mm_alignr_epi8(tmp, st1, 8); // ABEF
+				pSt1[iLane] = pSt1Save[iLane] = _mm_blend_epi16(st1, tmp, 0xF0); // CDGH
+
+				for (uint32_t i = 0; i < 4; i++)
+					pW[iLane][i] = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*) (pp[iLane] + (i << 4))), msk);
+			}
+
+			for (uint32_t r = 0; r < 16; r++)
+			{
+				const __m128i k = _mm_load_si128((const __m128i*) (s_pK + (r << 2)));
+
+				for (uint32_t iLane = 0; iLane < nLanes; iLane++)
+				{
+					__m128i* pWL = pW[iLane];
+					__m128i& w = pWL[r & 3];
+					if (r >= 4)
+					{
+						// w[t] = s1(w[t-2]) + w[t-7] + s0(w[t-15]) + w[t-16]
+						__m128i x = _mm_sha256msg1_epu32(w, pWL[(r + 1) & 3]);
+						x = _mm_add_epi32(x, _mm_alignr_epi8(pWL[(r + 3) & 3], pWL[(r + 2) & 3], 4));
+						w = _mm_sha256msg2_epu32(x, pWL[(r + 3) & 3]);
+					}
+
+					__m128i msg = _mm_add_epi32(w, k);
+					pSt1[iLane] = _mm_sha256rnds2_epu32(pSt1[iLane], pSt0[iLane], msg);
+					msg = _mm_shuffle_epi32(msg, 0x0E);
+					pSt0[iLane] = _mm_sha256rnds2_epu32(pSt0[iLane], pSt1[iLane], msg);
+				}
+			}
+
+			for (uint32_t iLane = 0; iLane < nLanes; iLane++)
+			{
+				__m128i st0 = _mm_add_epi32(pSt0[iLane], pSt0Save[iLane]);
+				__m128i st1 = _mm_add_epi32(pSt1[iLane], pSt1Save[iLane]);
+
+				__m128i tmp = _mm_shuffle_epi32(st0, 0x1B); // FEBA
+				st1 = _mm_shuffle_epi32(st1, 0xB1); // DCHG
+				st0 = _mm_blend_epi16(tmp, st1, 0xF0); // DCBA
+				st1 = _mm_alignr_epi8(st1, tmp, 8); // HGFE
+
+				_mm_storeu_si128((__m128i*) ps[iLane], st0);
+				_mm_storeu_si128((__m128i*) (ps[iLane] + 4), st1);
+			}
+		}
+
+		BEAM_TARGET_SHA void Transform_ShaNi(uint32_t* s, const uint8_t* p)
+		{
+			Transform_ShaNi_T<1>(&s, &p);
+		}
+
+		BEAM_TARGET_SHA void Transform2_ShaNi(uint32_t* const* ps, const uint8_t* const* pp)
+		{
+			Transform_ShaNi_T<2>(ps, pp);
+		}
+
+		bool IsSupported_ShaNi()
+		{
+			uint32_t pLeaf1[4], pLeaf7[4];
+#if defined(_MSC_VER) && !defined(__clang__)
+			int pRegs[4];
+			__cpuid(pRegs, 0);
+			if (pRegs[0] < 7)
+				return false;
+
+			__cpuid(pRegs, 1);
+			memcpy(pLeaf1, pRegs, sizeof(pLeaf1));
+			__cpuidex(pRegs, 7, 0);
+			memcpy(pLeaf7, pRegs, sizeof(pLeaf7));
+#else
+			if (__get_cpuid_max(0, nullptr) < 7)
+				return false;
+
+			__cpuid(1, pLeaf1[0], pLeaf1[1], pLeaf1[2], pLeaf1[3]);
+			__cpuid_count(7, 0, pLeaf7[0], pLeaf7[1], pLeaf7[2], pLeaf7[3]);
+#endif
+
+			return
+				(1 & (pLeaf1[2] >> 9)) && // SSSE3
+				(1 & (pLeaf1[2] >> 19)) && // SSE4.1
+				(1 & (pLeaf7[1] >> 29)); // SHA
+		}
+#endif // BEAM_SHA256_X86
+
+#ifdef BEAM_SHA256_ARM
+		// ARMv8 crypto extensions, enabled at compile time
+		void Transform_Arm(uint32_t* s, const uint8_t* p)
+		{
+			uint32x4_t st0 = vld1q_u32(s); // ABCD
+			uint32x4_t st1 = vld1q_u32(s + 4); // EFGH
+
+			const uint32x4_t st0Save = st0;
+			const uint32x4_t st1Save = st1;
+
+			uint32x4_t pW[4];
+			for (uint32_t i = 0; i < 4; i++)
+				pW[i] = vreinterpretq_u32_u8(vrev32q_u8(vld1q_u8(p + (i << 4))));
+
+			for (uint32_t r = 0; r < 16; r++)
+			{
+				uint32x4_t& w = pW[r & 3];
+				if (r >= 4)
+					w = vsha256su1q_u32(vsha256su0q_u32(w, pW[(r + 1) & 3]), pW[(r + 2) & 3], pW[(r + 3) & 3]);
+
+				uint32x4_t msg = vaddq_u32(w, vld1q_u32(s_pK + (r << 2)));
+				uint32x4_t tmp = st0;
+				st0 = vsha256hq_u32(st0, st1, msg);
+				st1 = vsha256h2q_u32(st1, tmp, msg);
+			}
+
+			vst1q_u32(s, vaddq_u32(st0, st0Save));
+			vst1q_u32(s + 4, vaddq_u32(st1, st1Save));
+		}
+#endif // BEAM_SHA256_ARM
+
+		Transform Select()
+		{
+#ifdef BEAM_SHA256_X86
+			if (IsSupported_ShaNi())
+				return Transform_ShaNi;
+#endif // BEAM_SHA256_X86
+
+#ifdef BEAM_SHA256_ARM
+			return Transform_Arm;
+#else // BEAM_SHA256_ARM
+			return Transform_Std;
+#endif // BEAM_SHA256_ARM
+		}
+
+		void Process(uint32_t* s, const uint8_t* p)
+		{
+			// selected once. Thread-safe, and may be used during the static initialization (see InitializeContext)
+			static const Transform s_pfn = Select();
+			s_pfn(s, p);
+		}
+
+		typedef void (*Transform2)(uint32_t* const* ps, const uint8_t* const* pp); // 2 independent blocks
+
+		void Transform2_Std(uint32_t* const* ps, const uint8_t* const* pp)
+		{
+			Process(ps[0], pp[0]);
+			Process(ps[1], pp[1]);
+		}
+
+		Transform2 Select2()
+		{
+#ifdef BEAM_SHA256_X86
+			if (IsSupported_ShaNi())
+				return Transform2_ShaNi;
+#endif // BEAM_SHA256_X86
+			return Transform2_Std;
+		}
+
+		void Process2(uint32_t* const* ps, const uint8_t* const* pp)
+		{
+			static const Transform2 s_pfn = Select2();
+			s_pfn(ps, pp);
+		}
+
+		const uint32_t s_pIV[8] = { 0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19 };
+
+		// the padding block for a 64-byte message
+		const uint8_t s_pPad64[64] = { 0x80, 0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0, 0x02, 0x00 };
+
+		void WriteBE(uint8_t* p, uint64_t x, uint32_t nBytes)
+		{
+			while (nBytes--)
+			{
+				p[nBytes] = static_cast<uint8_t>(x);
+				x >>= 8;
+			}
+		}
+
+	} // namespace Sha256
+
 	Hash::Processor::Processor()
 	{
 		Reset();
@@ -368,20 +603,97 @@ namespace ECC {
 		m_bInitialized = true;
 	}
 
-	void Hash::Processor::Write(const void* p, uint32_t n)
+	void Hash::Processor::Write(const void* p_, uint32_t n)
 	{
+		// same as secp256k1_sha256_write, but with the block transform selected by the cpu capabilities
 		assert(m_bInitialized);
-		secp256k1_sha256_write(this, (const uint8_t*) p, n);
+		const uint8_t* p = (const uint8_t*) p_;
+
+		uint32_t nBuf = static_cast<uint32_t>(bytes & 0x3f);
+		bytes += n;
+
+		if (nBuf)
+		{
+			uint32_t nPortion = sizeof(buf) - nBuf;
+			if (n < nPortion)
+			{
+				memcpy(buf + nBuf, p, n);
+				return;
+			}
+
+			memcpy(buf + nBuf, p, nPortion);
+			Sha256::Process(s, buf);
+
+			p += nPortion;
+			n -= nPortion;
+		}
+
+		for (; n >= sizeof(buf); p += sizeof(buf), n -= sizeof(buf))
+			Sha256::Process(s, p);
+
+		if (n)
+			memcpy(buf, p, n);
 	}
 
 	void Hash::Processor::Finalize(Value& v)
 	{
 		assert(m_bInitialized);
-		secp256k1_sha256_finalize(this, v.m_pData);
-		
+
+		uint8_t pSize[8];
+		Sha256::WriteBE(pSize, bytes << 3, sizeof(pSize));
+
+		static const uint8_t pPad[64] = { 0x80 };
+		Write(pPad, 1 + static_cast<uint32_t>((119 - (bytes & 0x3f)) & 0x3f));
+		Write(pSize, sizeof(pSize));
+
+		static_assert(sizeof(s) == Value::nBytes, "");
+		for (uint32_t i = 0; i < _countof(s); i++)
+			Sha256::WriteBE(v.m_pData + (i << 2), s[i], sizeof(uint32_t));
+
+		SecureErase(*this);
 		m_bInitialized = false;
 	}
 
+	void Hash::Processor::Hash64(Value* pRes, const void* pSrc, uint32_t nCount)
+	{
+		const uint8_t* p = (const uint8_t*) pSrc;
+		uint32_t pS[2][8];
+
+		for (uint32_t i = 0; i < nCount; )
+		{
+			// the inputs of the portion are consumed before the results are written, hence pRes may alias pSrc
+			uint32_t nPortion = std::min(nCount - i, 2U);
+
+			for (uint32_t iLane = 0; iLane < nPortion; iLane++)
+				memcpy(pS[iLane], Sha256::s_pIV, sizeof(pS[iLane]));
+
+			if (2 == nPortion)
+			{
+				uint32_t* ps[] = { pS[0], pS[1] };
+				const uint8_t* pp[] = { p, p + 64 };
+				Sha256::Process2(ps, pp);
+
+				pp[0] = pp[1] = Sha256::s_pPad64;
+				Sha256::Process2(ps, pp);
+			}
+			else
+			{
+				Sha256::Process(pS[0], p);
+				Sha256::Process(pS[0], Sha256::s_pPad64);
+			}
+
+			for (uint32_t iLane = 0; iLane < nPortion; iLane++)
+			{
+				Value& hv = pRes[i + iLane];
+				for (uint32_t j = 0; j < 8; j++)
+					Sha256::WriteBE(hv.m_pData + (j << 2), pS[iLane][j], sizeof(uint32_t));
+			}
+
+			i += nPortion;
+			p += 64 * nPortion;
+		}
+	}
+
 	void Hash::Processor::FinalizeTruncated(uint8_t* p, uint32_t nSize)
 	{
 		assert(nSize < Value::nBytes);
@@ -1478,8 +1790,121 @@ namespace ECC {
 		return true;
 	}
 
+	struct MultiMac::Pippenger
+	{
+		static unsigned int get_WndBits(unsigned int nCount)
+		{
+			// roughly log2(n) - 2, balances the additions per point vs the buckets overhead
+			unsigned int nBits = 5;
+			for (; (nBits < 12) && (nCount >> (nBits + 3)); nBits++)
+				;
+			return nBits;
+		}
+
+		static unsigned int get_Bits(const Scalar::Native& k, unsigned int iBit, unsigned int nBits)
+		{
+			const unsigned int nBitsPerWord = sizeof(Scalar::Native::uint) << 3;
+			const auto& d = k.get().d;
+
+			unsigned int iWord = iBit / nBitsPerWord;
+			if (iWord >= _countof(d))
+				return 0;
+
+			iBit %= nBitsPerWord;
+			uint64_t val = static_cast<uint64_t>(d[iWord]) >> iBit;
+			if ((iBit + nBits > nBitsPerWord) && (iWord + 1 < _countof(d)))
+				val |= static_cast<uint64_t>(d[iWord + 1]) << (nBitsPerWord - iBit);
+
+			return static_cast<unsigned int>(val) & ((1U << nBits) - 1);
+		}
+
+		// The casual points must be already normalized (to the common denominator), the result is w.r.t. the same denominator
+		static void Calculate(Point::Native& res, const MultiMac& mm)
+		{
+			const unsigned int nCount = mm.m_Casual;
+			const unsigned int nWndBits = get_WndBits(nCount);
+			const unsigned int nWindows = ECC::nBits / nWndBits + 1; // extra one for the carry
+			const unsigned int nBuckets = 1U << (nWndBits - 1);
+
+			// signed digits, in [-nBuckets, nBuckets]. Stored window-major, so that each pass reads them sequentially
+			std::vector<int16_t> vDigits(static_cast<size_t>(nCount) * nWindows);
+
+			// both signs of each point, the negation is done once rather than for each window
+			std::vector<secp256k1_ge> vPts(static_cast<size_t>(nCount) * 2);
+
+			for (unsigned int i = 0; i < nCount; i++)
+			{
+				const Casual::Fast& f = mm.m_pCasual[i].U.F.get();
+
+				if (!f.m_nNeeded)
+					continue; // zero point, digits remain zero
+
+				secp256k1_ge* pPt = &vPts[static_cast<size_t>(i) << 1];
+				Point::Native::BatchNormalizer::get_As(pPt[0], f.m_pPt[0]);
+				secp256k1_ge_neg(pPt + 1, pPt);
+
+				unsigned int nCarry = 0;
+				for (unsigned int iWnd = 0; iWnd < nWindows; iWnd++)
+				{
+					unsigned int nVal = get_Bits(mm.m_pKCasual[i], iWnd * nWndBits, nWndBits) + nCarry;
+					nCarry = (nVal > nBuckets);
+
+					vDigits[static_cast<size_t>(iWnd) * nCount + i] = static_cast<int16_t>(nCarry ? static_cast<int>(nVal) - static_cast<int>(nBuckets << 1) : static_cast<int>(nVal));
+				}
+				assert(!nCarry);
+			}
+
+			std::vector<Point::Native> vBuckets(nBuckets);
+
+			res = Zero;
+
+			for (unsigned int iWnd = nWindows; iWnd--; )
+			{
+				if (!(res == Zero))
+					for (unsigned int i = 0; i < nWndBits; i++)
+						res = res * Two;
+
+				for (unsigned int i = 0; i < nBuckets; i++)
+					vBuckets[i] = Zero;
+
+				const int16_t* pD = &vDigits[static_cast<size_t>(iWnd) * nCount];
+
+				for (unsigned int i = 0; i < nCount; i++)
+				{
+					int nDigit = pD[i];
+					if (!nDigit)
+						continue;
+
+					const secp256k1_ge* pPt = &vPts[static_cast<size_t>(i) << 1];
+					if (nDigit < 0)
+					{
+						pPt++;
+						nDigit = -nDigit;
+					}
+
+					secp256k1_gej& gej = vBuckets[nDigit - 1].get_Raw();
+					secp256k1_gej_add_ge_var(&gej, &gej, pPt, nullptr);
+				}
+
+				// sum of bucket[i] * (i+1)
+				Point::Native ptRunning, ptWnd;
+				ptRunning = Zero;
+				ptWnd = Zero;
+				for (unsigned int i = nBuckets; i--; )
+				{
+					ptRunning += vBuckets[i];
+					ptWnd += ptRunning;
+				}
+
+				res += ptWnd;
+			}
+		}
+	};
+
 	void MultiMac::Calculate(Point::Native& res) const
 	{
+		BEAM_METRICS_SCOPE("MultiMac.Calculate");
+
 		const unsigned int nBitsPerWord = sizeof(Scalar::Native::uint) << 3;
 
 		static_assert(!(nBitsPerWord % Casual::Secure::nBits), "");
@@ -1494,6 +1919,9 @@ namespace ECC {
 
 		WnafBase::Shared wsP, wsC;
 
+		// the decision depends only on the mode and the count, hence it's the same for Reuse::Generate and the following Reuse::UseGenerated
+		const bool bPippenger = (Mode::Fast == g_Mode) && (m_Casual >= s_PippengerMin);
+
 		unsigned int iBit = ECC::nBits;
 
 		if (Mode::Fast == g_Mode)
@@ -1523,6 +1951,22 @@ namespace ECC {
 					continue;
 				}
 
+				if (bPippenger)
+				{
+					if (Reuse::UseGenerated == m_ReuseFlag)
+					{
+						if (!bDenomSet)
+						{
+							bDenomSet = true;
+							zDenom = pt.get_Raw().z;
+						}
+					}
+					else
+						f.m_nNeeded = 1; // only the point itself, normalized along with the others
+
+					continue;
+				}
+
 				unsigned int nEntries = f.m_Wnaf.Init(wsC, m_pKCasual[iEntry], iEntry + 1);
 				assert(nEntries <= _countof(f.m_Wnaf.m_pVals));
 
@@ -1677,6 +2121,13 @@ namespace ECC {
 			}
 		}
 
+		if (bPippenger)
+		{
+			Point::Native ptCasual;
+			Pippenger::Calculate(ptCasual, *this);
+			res += ptCasual;
+		}
+
 		if (Mode::Secure == g_Mode)
 		{
 			for (int iEntry = 0; iEntry < m_Prepared; iEntry++)
@@ -1696,6 +2147,58 @@ namespace ECC {
 		}
 	}
 
+	void MultiMac::CalculateParallel(Point::Native& res) const
+	{
+		beam::Executor* pEx = beam::Executor::s_pInstance;
+		uint32_t nThreads = pEx ? pEx->get_Threads() : 1;
+
+		if ((nThreads <= 1) || (m_Casual + m_Prepared < s_ParallelMin) || (Reuse::None != m_ReuseFlag))
+		{
+			Calculate(res);
+			return;
+		}
+
+		struct MyTask
+			:public beam::Executor::TaskSync
+		{
+			const MultiMac* m_pThis;
+			Mode::Enum m_Mode;
+			std::vector<Point::Native> m_vRes;
+
+			virtual void Exec(beam::Executor::Context& ctx) override
+			{
+				Mode::Scope scope(m_Mode);
+
+				// each thread works on its own portion of the buffers, no overlap
+				uint32_t iC, nC, iP, nP;
+				ctx.get_Portion(iC, nC, m_pThis->m_Casual);
+				ctx.get_Portion(iP, nP, m_pThis->m_Prepared);
+
+				MultiMac mm;
+				mm.m_pCasual = m_pThis->m_pCasual + iC;
+				mm.m_pKCasual = m_pThis->m_pKCasual + iC;
+				mm.m_Casual = static_cast<int>(nC);
+
+				mm.m_ppPrepared = m_pThis->m_ppPrepared + iP;
+				mm.m_pKPrep = m_pThis->m_pKPrep + iP;
+				mm.m_pWnafPrepared = m_pThis->m_pWnafPrepared + iP;
+				mm.m_Prepared = static_cast<int>(nP);
+
+				mm.Calculate(m_vRes[ctx.m_iThread]);
+			}
+		} t;
+
+		t.m_pThis = this;
+		t.m_Mode = g_Mode;
+		t.m_vRes.resize(nThreads);
+
+		pEx->ExecAll(t);
+
+		res = t.m_vRes[0];
+		for (uint32_t i = 1; i < nThreads; i++)
+			res += t.m_vRes[i];
+	}
+
 	void MultiMac_Dyn::Prepare(uint32_t nMaxCasual, uint32_t nMaxPrepared)
 	{
 		if (nMaxCasual)
@@ -1772,7 +2275,12 @@ namespace ECC {
 
 	/////////////////////
 	// Context
+#ifdef __linux__
+	// aligned to the huge page size, so that the tables can be backed by transparent huge pages
+	alignas(0x200000) AlignedBuf<Context> g_ContextBuf;
+#else // __linux__
 	AlignedBuf<Context> g_ContextBuf;
+#endif // __linux__
 
 	// Currently - auto-init in global obj c'tor
 	Initializer g_Initializer;
@@ -1791,6 +2299,11 @@ namespace ECC {
 	{
 		Context& ctx = g_ContextBuf.get();
 
+#ifdef __linux__
+		// must be before the tables are touched. Just a hint, ignore errors (THP may be disabled)
+		madvise(&g_ContextBuf, sizeof(g_ContextBuf), MADV_HUGEPAGE);
+#endif // __linux__
+
 		Mode::Scope scope(Mode::Fast);
 
 		Oracle oracle;
@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #include "fly_client.h"
+#include "radixtree.h"
 #include "../utility/executor.h"
 
 namespace beam {
@@ -144,6 +145,34 @@ bool FlyClient::NetworkStd::Connection::ShouldSync() const
     return !m_This.m_Client.get_History().get_Tip(sTip) || (sTip.m_ChainWork < m_Tip.m_ChainWork);
 }
 
+bool FlyClient::NetworkStd::Connection::IsSyncingElsewhere() const
+{
+    for (ConnectionList::const_iterator it = m_This.m_Connections.begin(); m_This.m_Connections.end() != it; ++it)
+    {
+        const Connection& c = *it;
+        if ((&c != this) && c.m_pSync && (c.m_Tip.m_ChainWork >= m_Tip.m_ChainWork))
+            return true;
+    }
+    return false;
+}
+
+void FlyClient::NetworkStd::Connection::ResumeDeferredSync()
+{
+    for (ConnectionList::iterator it = m_This.m_Connections.begin(); m_This.m_Connections.end() != it; ++it)
+    {
+        Connection& c = *it;
+        if (!(Flags::SyncDeferred & c.m_Flags))
+            continue;
+
+        c.m_Flags &= ~Flags::SyncDeferred;
+
+        if (c.ShouldSync())
+            c.StartSync(); // may be deferred again
+        else
+            c.AssignRequests();
+    }
+}
+
 void FlyClient::NetworkStd::Connection::ResetVars()
 {
     ZeroObject(m_Tip);
@@ -199,7 +228,7 @@ void FlyClient::NetworkStd::Connection::OnConnectedSecure()
 
 void FlyClient::NetworkStd::Connection::SetupLogin(Login& msg)
 {
-    msg.m_Flags |= LoginFlags::SendPeers;
+    msg.m_Flags |= LoginFlags::SendPeers | LoginFlags::WantEvents;
 
     if (m_This.m_Cfg.m_PreferOnlineMining)
         msg.m_Flags |= LoginFlags::MiningFinalization;
@@ -211,9 +240,14 @@ void FlyClient::NetworkStd::Connection::SetupLogin(Login& msg)
 
 void FlyClient::NetworkStd::Connection::OnDisconnect(const DisconnectReason& dr)
 {
+    bool bWasSyncing = !!m_pSync;
+
     m_This.OnConnectionFailed(dr);
 	ResetAll();
     SetTimer(m_This.m_Cfg.m_ReconnectTimeout_ms);
+
+    if (bWasSyncing)
+        ResumeDeferredSync();
 }
 
 void FlyClient::NetworkStd::Connection::ResetAll()
@@ -405,6 +439,13 @@ void FlyClient::NetworkStd::Connection::StartSync()
     }
     else
     {
+        if (IsSyncingElsewhere())
+        {
+            // don't download the same proofs via several connections
+            m_Flags |= Flags::SyncDeferred;
+            return;
+        }
+
         // starting search
         m_pSync.reset(new SyncCtx);
         m_pSync->m_LowHeight = m_Tip.m_Height;
@@ -464,6 +505,7 @@ void FlyClient::NetworkStd::Connection::OnMsg(ProofCommonState&& msg)
     if (!ShouldSync())
     {
         m_pSync.reset();
+        ResumeDeferredSync();
         return; // other connection was faster
     }
 
@@ -567,7 +609,10 @@ void FlyClient::NetworkStd::Connection::OnMsg(ProofChainWork&& msg)
     SyncCtx::Ptr pSync = std::move(m_pSync);
 
     if (!ShouldSync())
+    {
+        ResumeDeferredSync();
         return;
+    }
 
     // Unpack the proof, convert it to one sorted array. For convenience
     StateArray arr;
@@ -639,6 +684,8 @@ void FlyClient::NetworkStd::Connection::PostChainworkProof(const StateArray& arr
     PrioritizeSelf();
     m_This.m_Client.OnNewTip(); // finished!
     AssignRequests();
+
+    ResumeDeferredSync();
 }
 
 
@@ -735,10 +782,38 @@ void FlyClient::NetworkStd::Connection::AssignRequests()
         KillTimer();
 }
 
+bool FlyClient::NetworkStd::Connection::IsTaggable(const RequestNode& n) const
+{
+    if (get_Ext() < 15)
+        return false;
+
+    // only the requests that are answered by a single message, with no side-effects on the connection state
+    switch (n.m_pRequest->get_Type())
+    {
+#define THE_MACRO(type, msgOut, msgIn) case Request::Type::type:
+    REQUEST_TYPES_Std(THE_MACRO)
+#undef THE_MACRO
+        return true;
+
+    default:
+        return false;
+    }
+}
+
 void FlyClient::NetworkStd::Connection::AssignRequest(RequestNode& n)
 {
     assert(n.m_pRequest);
 
+    n.m_Tag = 0;
+    if (IsTaggable(n))
+    {
+        if (!++m_TagNext)
+            ++m_TagNext; // 0 is reserved
+        n.m_Tag = m_TagNext;
+    }
+
+    TagScope scope(m_TagOut, n.m_Tag);
+
     switch (n.m_pRequest->get_Type())
     {
 #define THE_MACRO(type) \
@@ -768,14 +843,24 @@ void FlyClient::NetworkStd::RequestList::Finish(RequestNode& n)
     Delete(n);
 }
 
+FlyClient::NetworkStd::RequestNode* FlyClient::NetworkStd::Connection::FindRequest(uint32_t nTag)
+{
+    // tagged response matches its request, untagged - the oldest untagged request
+    for (auto& n : m_lst)
+        if (n.m_Tag == nTag)
+            return &n;
+
+    return nullptr;
+}
+
 FlyClient::NetworkStd::RequestNode& FlyClient::NetworkStd::Connection::get_FirstRequest()
 {
-    if (m_lst.empty())
+    RequestNode* pN = FindRequest(m_TagIn);
+    if (!pN)
         ThrowUnexpected();
-    RequestNode& n = m_lst.front();
-    assert(n.m_pRequest);
+    assert(pN->m_pRequest);
 
-    return n;
+    return *pN;
 }
 
 #define REQUEST_STD_RCV(type, msgIn) \
@@ -813,6 +898,50 @@ void FlyClient::NetworkStd::Connection::OnRequestData(RequestUtxo& req)
             ThrowUnexpected();
 }
 
+void FlyClient::NetworkStd::Connection::OnRequestData(RequestUtxoBatch& req)
+{
+    if (req.m_Res.m_Results.size() != req.m_Msg.m_Utxos.size())
+        ThrowUnexpected();
+
+    for (size_t i = 0; i < req.m_Res.m_Results.size(); i++)
+    {
+        const auto& vProofs = req.m_Res.m_Results[i].m_Proofs;
+        for (size_t j = 0; j < vProofs.size(); j++)
+            if (!m_Tip.IsValidProofUtxo(req.m_Msg.m_Utxos[i], vProofs[j]))
+                ThrowUnexpected();
+    }
+}
+
+void FlyClient::NetworkStd::Connection::OnRequestData(RequestUtxoMulti& req)
+{
+    const auto& vStates = req.m_Res.m_States;
+    if (vStates.size() != req.m_Msg.m_Utxos.size())
+        ThrowUnexpected();
+
+    std::vector<UtxoTree::LeafInfo> vLeafs;
+    for (size_t i = 0; i < vStates.size(); i++)
+    {
+        for (const auto& s : vStates[i])
+        {
+            UtxoTree::Key::Data d;
+            d.m_Commitment = req.m_Msg.m_Utxos[i];
+            d.m_Maturity = s.m_Maturity;
+
+            auto& x = vLeafs.emplace_back();
+            x.first = d;
+            x.second = s.m_Count;
+        }
+    }
+
+    if (vLeafs.empty())
+        return;
+
+    Merkle::Hash hv;
+    if (!UtxoTree::get_MultiProofRoot(hv, req.m_Res.m_Proof, vLeafs) ||
+        !m_Tip.IsValidProofUtxoRoot(hv, req.m_Res.m_ProofRoot))
+        ThrowUnexpected();
+}
+
 void FlyClient::NetworkStd::Connection::OnRequestData(RequestKernel& req)
 {
     if (!req.m_Res.m_Proof.empty())
@@ -845,6 +974,16 @@ void FlyClient::NetworkStd::Connection::OnRequestData(RequestKernel2& req)
     }
 }
 
+void FlyClient::NetworkStd::Connection::OnRequestData(RequestKernel2Batch& req)
+{
+    if (req.m_Res.m_Results.size() != req.m_Msg.m_IDs.size())
+        ThrowUnexpected();
+
+    for (const auto& x : req.m_Res.m_Results)
+        if (x.m_Kernel && !x.m_Kernel->IsValid(x.m_Height))
+            ThrowUnexpected();
+}
+
 bool FlyClient::NetworkStd::Connection::IsSupported(RequestEvents&)
 {
     return !!(Flags::Owned & m_Flags);
@@ -889,6 +1028,21 @@ bool FlyClient::NetworkStd::Connection::IsSupported(RequestTransaction& req)
     return true;
 }
 
+bool FlyClient::NetworkStd::Connection::IsSupported(RequestUtxoBatch& req)
+{
+    return (get_Ext() >= 16) && (req.m_Msg.m_Utxos.size() <= proto::g_ProofBatchMaxSize);
+}
+
+bool FlyClient::NetworkStd::Connection::IsSupported(RequestKernel2Batch& req)
+{
+    return (get_Ext() >= 16) && (req.m_Msg.m_IDs.size() <= proto::g_ProofBatchMaxSize);
+}
+
+bool FlyClient::NetworkStd::Connection::IsSupported(RequestUtxoMulti& req)
+{
+    return (get_Ext() >= 17) && (req.m_Msg.m_Utxos.size() <= proto::g_ProofBatchMaxSize);
+}
+
 void FlyClient::NetworkStd::Connection::OnRequestData(RequestProofShieldedInp& req)
 {
     if (!req.m_Res.m_Proof.empty())
@@ -917,13 +1071,9 @@ void FlyClient::NetworkStd::Connection::OnRequestData(RequestProofShieldedOutp&
     }
 }
 
-bool FlyClient::Data::DecodedHdrPack::DecodeAndCheck(const HdrPack& msg)
+void FlyClient::Data::DecodedHdrPack::Decode(std::vector<Block::SystemState::Full>& v, const HdrPack& msg)
 {
-    if (msg.m_vElements.empty())
-        return true; // this is allowed
-
-    // PoW verification is heavy for big packs. Do it in parallel
-    std::vector<Block::SystemState::Full> v;
+    assert(!msg.m_vElements.empty());
     v.resize(msg.m_vElements.size());
 
     Cast::Down<Block::SystemState::Sequence::Prefix>(v.front()) = msg.m_Prefix;
@@ -939,6 +1089,16 @@ bool FlyClient::Data::DecodedHdrPack::DecodeAndCheck(const HdrPack& msg)
         Cast::Down<Block::SystemState::Sequence::Element>(s1) = msg.m_vElements[msg.m_vElements.size() - i - 1];
         s1.m_ChainWork = s0.m_ChainWork + s1.m_PoW.m_Difficulty;
     }
+}
+
+bool FlyClient::Data::DecodedHdrPack::DecodeAndCheck(const HdrPack& msg)
+{
+    if (msg.m_vElements.empty())
+        return true; // this is allowed
+
+    // PoW verification is heavy for big packs. Do it in parallel
+    std::vector<Block::SystemState::Full> v;
+    Decode(v, msg);
 
     struct MyTask
         :public Executor::TaskSync
@@ -1096,9 +1256,10 @@ bool FlyClient::NetworkStd::Connection::SendRequest(RequestAssetsListAt& req)
 
 void FlyClient::NetworkStd::Connection::OnMsg(proto::Pong&&)
 {
-    if (!m_lst.empty())
+    RequestNode* pN = FindRequest(0);
+    if (pN)
     {
-        auto& n = get_FirstRequest();
+        auto& n = *pN;
         switch (n.m_pRequest->get_Type())
         {
         case Request::Type::BbsMsg:
@@ -1236,6 +1397,14 @@ void FlyClient::NetworkStd::Connection::OnMsg(EventsSerif&& msg)
     m_This.m_Client.OnEventsSerif(msg.m_Value, msg.m_Height);
 }
 
+void FlyClient::NetworkStd::Connection::OnMsg(EventsNew&& msg)
+{
+    if (!(Flags::Owned & m_Flags))
+        ThrowUnexpected();
+
+    m_This.m_Client.OnEventsNew(msg.m_Height);
+}
+
 void FlyClient::NetworkStd::Connection::OnMsg(PeerInfo&& msg)
 {
     m_This.m_Client.OnNewPeer(msg.m_ID, msg.m_LastAddr);
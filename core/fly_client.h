@@ -44,7 +44,10 @@ namespace proto {
 		macro(ShieldedOutputsAt) \
 		macro(BodyPack) \
 		macro(Body) \
-		macro(AssetsListAt)
+		macro(AssetsListAt) \
+		macro(UtxoBatch) \
+		macro(Kernel2Batch) \
+		macro(UtxoMulti)
 
 
 #define REQUEST_TYPES_Std(macro) \
@@ -63,6 +66,9 @@ namespace proto {
         macro(ShieldedOutputsAt, GetShieldedOutputsAt, ShieldedOutputsAt) \
         macro(BodyPack,          GetBodyPack,          BodyPack) \
         macro(Body,              GetBodyPack,          Body) \
+        macro(UtxoBatch,         GetProofUtxoBatch,    ProofUtxoBatch) \
+        macro(Kernel2Batch,      GetProofKernel2Batch, ProofKernel2Batch) \
+        macro(UtxoMulti,         GetProofUtxoMulti,    ProofUtxoMulti) \
 
 
 		class Request
@@ -122,6 +128,7 @@ namespace proto {
 			struct DecodedHdrPack {
 				std::vector<Block::SystemState::Full> m_vStates;
 				bool DecodeAndCheck(const HdrPack& msg);
+				static void Decode(std::vector<Block::SystemState::Full>&, const HdrPack& msg); // w/o verification
 			};
 			struct EnumHdrs :public DecodedHdrPack {
 				proto::EnumHdrs m_Msg;
@@ -168,6 +175,7 @@ namespace proto {
 		virtual Block::SystemState::IHistory& get_History() = 0;
 		virtual void OnOwnedNode(const PeerID&, bool bUp) {}
 		virtual void OnEventsSerif(const ECC::Hash::Value&, Height) {}
+		virtual void OnEventsNew(Height) {} // the owned node has new events up to this height. After the 1st one the node notifies on each change
 		virtual void OnNewPeer(const PeerID& id, io::Address address) {}
 		virtual void OnDependentStateChanged() {}
 
@@ -204,6 +212,7 @@ namespace proto {
 				:public boost::intrusive::list_base_hook<>
 			{
 				Request::Ptr m_pRequest;
+				uint32_t m_Tag = 0; // if set - the response may arrive out of order
 			};
 
 			struct RequestList
@@ -244,6 +253,8 @@ namespace proto {
 				struct StateArray;
 
 				bool ShouldSync() const;
+				bool IsSyncingElsewhere() const;
+				void ResumeDeferredSync(); // of the other connections
 				void StartSync();
 				void SearchBelow(Height, uint32_t nCount);
 				void RequestChainworkProof();
@@ -284,6 +295,10 @@ namespace proto {
 				void AssignRequests();
 				void AssignRequest(RequestNode&);
 
+				uint32_t m_TagNext = 0;
+				bool IsTaggable(const RequestNode&) const;
+				RequestNode* FindRequest(uint32_t nTag);
+
 				void SendLoginPlus();
 
 				bool IsAtTip() const;
@@ -294,6 +309,7 @@ namespace proto {
 					static const uint8_t Owned = 2;
 					static const uint8_t ReportedConnected = 4;
 					static const uint8_t DependentPending = 8;
+					static const uint8_t SyncDeferred = 16; // other connection is syncing to the same or better tip
 				};
 
 				// NodeConnection
@@ -308,6 +324,7 @@ namespace proto {
 				void OnMsg(proto::ProofChainWork&& msg) override;
 				void OnMsg(proto::BbsMsg&& msg) override;
 				void OnMsg(proto::EventsSerif&& msg) override;
+				void OnMsg(proto::EventsNew&& msg) override;
 				void OnMsg(proto::DataMissing&& msg) override;
 				void OnMsg(proto::PeerInfo&& msg) override;
 				void OnMsg(proto::DependentContextChanged&& msg) override;
@@ -329,11 +346,17 @@ namespace proto {
 				bool IsSupported(const Data::Std&) { return true; }
 				bool IsSupported(RequestEvents&);
 				bool IsSupported(RequestTransaction&);
+				bool IsSupported(RequestUtxoBatch&);
+				bool IsSupported(RequestKernel2Batch&);
+				bool IsSupported(RequestUtxoMulti&);
 
 				void OnRequestData(const Data::Std&) {}
 				void OnRequestData(RequestUtxo&);
 				void OnRequestData(RequestKernel&);
 				void OnRequestData(RequestKernel2&);
+				void OnRequestData(RequestUtxoBatch&);
+				void OnRequestData(RequestKernel2Batch&);
+				void OnRequestData(RequestUtxoMulti&);
 				void OnRequestData(RequestAsset&);
 				void OnRequestData(RequestProofShieldedInp&);
 				void OnRequestData(RequestProofShieldedOutp&);
@@ -44,21 +44,22 @@ void KeccakProcessorBase::WriteInternal(const uint8_t* pSrc, uint32_t nSrc, uint
 		AddLastWordInternal(nWordsBlock);
 	}
 
-	while (true)
+	// absorb whole words directly into the state, without going through m_LastWord
+	for (; nSrc >= nSizeWord; pSrc += nSizeWord, nSrc -= nSizeWord)
 	{
-		if (nSrc < nSizeWord)
+		uint64_t w;
+		memcpy(&w, pSrc, nSizeWord);
+		m_pState[m_iWord] ^= ByteOrder::to_le(w);
+
+		if (++m_iWord == nWordsBlock)
 		{
-			memcpy(m_pLastWordAsBytes, pSrc, nSrc);
-			m_LastWordBytes = nSrc;
-			return;
+			ethash_keccakf1600(m_pState);
+			m_iWord = 0;
 		}
-
-		memcpy(m_pLastWordAsBytes, pSrc, nSizeWord);
-		pSrc += nSizeWord;
-		nSrc -= nSizeWord;
-
-		AddLastWordInternal(nWordsBlock);
 	}
+
+	memcpy(m_pLastWordAsBytes, pSrc, nSrc);
+	m_LastWordBytes = nSrc;
 }
 
 void KeccakProcessorBase::ReadInternal(uint8_t* pRes, uint32_t nWordsBlock, uint32_t nBytes)
@@ -118,11 +118,61 @@ void CmList::Import(MultiMac& mm, uint32_t iPos, uint32_t nCount)
 }
 
 void CmList::Calculate(Point::Native& res, uint32_t iPos, uint32_t nCount, const Scalar::Native* pKs)
+{
+	Executor* pEx = Executor::s_pInstance;
+	uint32_t nThreads = pEx ? pEx->get_Threads() : 1;
+
+	if ((nThreads <= 1) || (nCount < static_cast<uint32_t>(MultiMac::s_ParallelMin) * 2))
+	{
+		CalculateSeq(res, iPos, nCount, pKs);
+		return;
+	}
+
+	// get_At is only read from, same as in the Prover::ExtractG
+	struct MyTask
+		:public Executor::TaskSync
+	{
+		CmList* m_pThis;
+		uint32_t m_iPos;
+		uint32_t m_Count;
+		const Scalar::Native* m_pKs;
+		std::vector<Point::Native> m_vRes;
+
+		virtual void Exec(Executor::Context& ctx) override
+		{
+			uint32_t i0, nCount;
+			ctx.get_Portion(i0, nCount, m_Count);
+
+			Point::Native& res = m_vRes[ctx.m_iThread];
+			res = Zero;
+
+			if (nCount)
+				m_pThis->CalculateSeq(res, m_iPos + i0, nCount, m_pKs);
+		}
+	} t;
+
+	t.m_pThis = this;
+	t.m_iPos = iPos;
+	t.m_Count = nCount;
+	t.m_pKs = pKs;
+	t.m_vRes.resize(nThreads);
+
+	pEx->ExecAll(t);
+
+	for (uint32_t i = 0; i < nThreads; i++)
+		res += t.m_vRes[i];
+}
+
+void CmList::CalculateSeq(Point::Native& res, uint32_t iPos, uint32_t nCount, const Scalar::Native* pKs)
 {
 	Mode::Scope scope(Mode::Fast);
 
-	const uint32_t nSizeNaggle = 128;
-	MultiMac_WithBufs<nSizeNaggle, 1> mm;
+	// large enough for the bucket method in MultiMac, which is much faster than the wNAF for this size
+	const uint32_t nSizeNaggle = 1024;
+	static_assert(nSizeNaggle >= MultiMac::s_PippengerMin, "");
+
+	MultiMac_Dyn mm;
+	mm.Prepare(std::min(nSizeNaggle, nCount), 0);
 
 	Point::Native comm;
 
@@ -574,8 +624,13 @@ void Prover::ExtractG_Part(GB* pGB, uint32_t i0, uint32_t i1)
 		gb.m_kBias = Zero;
 	}
 
-	const uint32_t nSizeNaggle = 128;
-	MultiMac_WithBufs<nSizeNaggle, 1> mm;
+	// The same points are multiplied by M different scalars. For large chunks the bucket method (with reuse of the normalized points) is much faster than the wNAF,
+	// whereas the cost of the per-chunk overhead (bucket reduction) diminishes.
+	const uint32_t nSizeNaggle = 2048;
+	static_assert(nSizeNaggle >= MultiMac::s_PippengerMin, "");
+
+	MultiMac_Dyn mm;
+	mm.Prepare(std::min(nSizeNaggle, i1 - i0), 0);
 
 	Point::Native comm;
 
@@ -23,7 +23,8 @@ namespace Sigma {
 		virtual bool get_At(ECC::Point::Storage&, uint32_t iIdx) = 0;
 
 		void Import(ECC::MultiMac&, uint32_t iPos, uint32_t nCount);
-		void Calculate(ECC::Point::Native&, uint32_t iPos, uint32_t nCount, const ECC::Scalar::Native* pKs);
+		void Calculate(ECC::Point::Native&, uint32_t iPos, uint32_t nCount, const ECC::Scalar::Native* pKs); // splits the range among the Executor threads, if set
+		void CalculateSeq(ECC::Point::Native&, uint32_t iPos, uint32_t nCount, const ECC::Scalar::Native* pKs);
 	};
 
 	struct CmListVec
@@ -141,6 +141,14 @@ namespace beam
 			test_SysRet(MAP_FAILED == pPtr, "mmap");
 
 			m_pMapping = pPtr;
+
+			// hints are advisory, failures are ignored
+			if (Hint::Random & m_Hints)
+				madvise(m_pMapping, m_nMapping, MADV_RANDOM);
+#ifdef MADV_HUGEPAGE
+			if (Hint::HugePages & m_Hints)
+				madvise(m_pMapping, m_nMapping, MADV_HUGEPAGE);
+#endif // MADV_HUGEPAGE
 		}
 
 #endif // WIN32
@@ -156,6 +164,49 @@ namespace beam
 #endif // WIN32
 	}
 
+	void MappedFileRaw::Flush()
+	{
+		if (!m_pMapping)
+			return;
+
+#ifdef WIN32
+		test_SysRet(!FlushViewOfFile(m_pMapping, 0), "FlushViewOfFile");
+		test_SysRet(!FlushFileBuffers(m_hFile), "FlushFileBuffers");
+#else // WIN32
+		test_SysRet(msync(m_pMapping, m_nMapping, MS_SYNC) != 0, "msync");
+#endif // WIN32
+	}
+
+	void MappedFileRaw::Prefault()
+	{
+		if (!m_pMapping)
+			return;
+
+#ifdef MADV_POPULATE_WRITE
+		if (!madvise(m_pMapping, m_nMapping, MADV_POPULATE_WRITE))
+			return;
+#endif // MADV_POPULATE_WRITE
+
+		// fallback: touch every page
+		volatile uint8_t nSum = 0;
+		for (Offset n = 0; n < m_nMapping; n += s_PageSize)
+			nSum += m_pMapping[n];
+	}
+
+	void MappedFileRaw::WillNeed(const void* p, size_t n)
+	{
+#ifndef WIN32
+		if (!n || !s_PageSize)
+			return;
+
+		uintptr_t x0 = reinterpret_cast<uintptr_t>(p);
+		uintptr_t x1 = x0 + n;
+		x0 -= x0 % s_PageSize;
+
+		madvise(reinterpret_cast<void*>(x0), x1 - x0, MADV_WILLNEED);
+#endif // WIN32
+	}
+
 	void MappedFileRaw::Open(const char* sz)
 	{
 		Close();
@@ -180,6 +231,9 @@ namespace beam
 #endif // WIN32
 
 		OpenMapping();
+
+		if (Hint::Prefault & m_Hints)
+			Prefault();
 	}
 
 	MappedFileRaw::Offset MappedFileRaw::get_Offset(const void* p) const
@@ -282,13 +336,18 @@ namespace beam
 		return ((Bank*) (m_Raw.m_pMapping + m_nBank0))[iBank];
 	}
 
-	void MappedFile::EnsureReserve(uint32_t iBank, uint32_t nSize, uint32_t nMinFree)
+	void MappedFile::EnsureReserve(uint32_t iBank, uint32_t nSize, uint64_t nMinFree)
 	{
+		// Remapping is expensive (all the pages are faulted-in again), hence grow proportionally to the current size, but not too much at once.
+		// The new elements are laid out from the cache line boundary, so that elements of the cache line size (such as hash joints) don't straddle lines.
+		const uint32_t nElementAlign = 64;
+		const Offset nGrowMax = 16 << 20;
+
 		while (get_Bank(iBank).m_Free < nMinFree)
 		{
 			// grow
-			Offset n0 = m_Raw.m_nMapping;
-			Offset n1 = AlignUp(n0, m_Raw.s_PageSize) + m_Raw.s_PageSize;
+			Offset n0 = AlignUp(m_Raw.m_nMapping, nElementAlign);
+			Offset n1 = AlignUp(n0 + std::min(m_Raw.m_nMapping >> 4, nGrowMax), m_Raw.s_PageSize) + m_Raw.s_PageSize;
 
 			nSize = AlignUp(nSize, sizeof(Offset));
 
@@ -297,6 +356,7 @@ namespace beam
 			m_Raw.OpenMapping();
 
 			Bank& b = get_Bank(iBank);
+			Offset nTailPrev = b.m_Tail; // may be non-empty if several iterations are needed
 			Offset* p = &b.m_Tail;
 
 			while (true)
@@ -305,7 +365,6 @@ namespace beam
 				if (n0_ > m_Raw.m_nMapping)
 					break;
 
-				assert(!*p);
 				*p = n0;
 				p = &get_At<Offset>(n0);
 
@@ -314,9 +373,18 @@ namespace beam
 
 				n0 = n0_;
 			}
+
+			*p = nTailPrev;
 		}
 	}
 
+	void MappedFile::get_BankStat(uint32_t iBank, uint64_t& nTotal, uint64_t& nFree)
+	{
+		const Bank& b = get_Bank(iBank);
+		nTotal = b.m_Total;
+		nFree = b.m_Free;
+	}
+
 	void* MappedFile::Allocate(uint32_t iBank, uint32_t nSize)
 	{
 		assert(nSize >= sizeof(Offset));
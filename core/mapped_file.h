@@ -33,11 +33,24 @@ namespace beam
 		Offset m_nMapping;
 		uint8_t* m_pMapping;
 
+		struct Hint {
+			static const uint8_t Random = 1; // random access pattern, no read-ahead
+			static const uint8_t HugePages = 2; // transparent huge pages, if supported for this file
+			static const uint8_t Prefault = 4; // populate the whole mapping when the file is opened
+		};
+
+		uint8_t m_Hints = 0; // applied to each (re)mapping. Currently ignored on Windows, except Prefault
+
 		void ResetVarsFile();
 		void ResetVarsMapping();
 		void CloseMapping();
 		void OpenMapping();
 		void Resize(Offset);
+		void Flush(); // sync the mapping contents to disk
+		void Prefault();
+
+		// asynchronous read-ahead of the pages that back the given range of a mapping. Advisory, no-op on Windows
+		static void WillNeed(const void* p, size_t n);
 
 		MappedFileRaw();
 		~MappedFileRaw();
@@ -114,7 +127,12 @@ namespace beam
 		void* Allocate(uint32_t iBank, uint32_t nSize);
 		void Free(uint32_t iBank, void*);
 
-		void EnsureReserve(uint32_t iBank, uint32_t nSize, uint32_t nMinFree);
+		void EnsureReserve(uint32_t iBank, uint32_t nSize, uint64_t nMinFree);
+		void get_BankStat(uint32_t iBank, uint64_t& nTotal, uint64_t& nFree);
+		Offset get_Size() const { return m_Raw.m_nMapping; }
+
+		void Flush() { m_Raw.Flush(); } // sync the mapping contents to disk
+		void set_Hints(uint8_t n) { m_Raw.m_Hints = n; } // before Open
 	};
 
 } // namespace beam
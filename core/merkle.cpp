@@ -15,6 +15,7 @@
 #include "common.h"
 #include "merkle.h"
 #include "ecc_native.h"
+#include "../utility/executor.h"
 
 namespace beam {
 namespace Merkle {
@@ -32,6 +33,12 @@ void Interpret(Hash& hOld, const Hash& hNew, bool bNewOnRight)
 		Interpret(hOld, hNew, hOld);
 }
 
+void InterpretBatch(Hash* pOut, const Hash* pPairs, uint32_t nPairs)
+{
+	static_assert(sizeof(Hash) * 2 == 64, "");
+	ECC::Hash::Processor::Hash64(pOut, pPairs, nPairs);
+}
+
 void Interpret(Hash& hash, const Node& n)
 {
 	Interpret(hash, n.second, n.first);
@@ -75,6 +82,98 @@ void Mmr::Replace(uint64_t n, const Hash& hv)
 	}
 }
 
+void Mmr::Append(const Hash* pHashes, uint64_t nCount)
+{
+	uint64_t n0 = m_Count;
+	m_Count += nCount;
+	Replace(n0, pHashes, nCount);
+}
+
+static void InterpretLevel(Hash* pOut, const Hash* pPairs, uint32_t nPairs)
+{
+	Executor* pEx = Executor::s_pInstance;
+	if (pEx && (pEx->get_Threads() > 1) && (nPairs >= Mmr::s_ParallelMin))
+	{
+		// pOut must not alias pPairs, otherwise the portions would overlap
+		struct MyTask
+			:public Executor::TaskSync
+		{
+			Hash* m_pOut;
+			const Hash* m_pPairs;
+			uint32_t m_Count;
+
+			virtual void Exec(Executor::Context& ctx) override
+			{
+				uint32_t i0, nPortion;
+				ctx.get_Portion(i0, nPortion, m_Count);
+				if (nPortion)
+					InterpretBatch(m_pOut + i0, m_pPairs + (i0 << 1), nPortion);
+			}
+		} t;
+
+		t.m_pOut = pOut;
+		t.m_pPairs = pPairs;
+		t.m_Count = nPairs;
+
+		pEx->ExecAll(t);
+	}
+	else
+		InterpretBatch(pOut, pPairs, nPairs);
+}
+
+void Mmr::Replace(uint64_t n0, const Hash* pHashes, uint64_t nCount)
+{
+	if (!nCount)
+		return;
+
+	uint64_t x0 = n0, x1 = n0 + nCount, nLevel = m_Count; // modified range of the current level, and its size
+	assert(x1 <= nLevel);
+
+	std::vector<Hash> v(pHashes, pHashes + nCount), vPairs;
+
+	Position pos;
+	for (pos.H = 0; ; pos.H++)
+	{
+		for (pos.X = x0; pos.X < x1; pos.X++)
+			SaveElement(v[pos.X - x0], pos);
+
+		// parents of the modified range, only those whose both children exist
+		uint64_t y0 = x0 >> 1;
+		uint64_t y1 = std::min((x1 + 1) >> 1, nLevel >> 1);
+		if (y0 >= y1)
+			break;
+
+		uint64_t nPairs = y1 - y0;
+		assert(nPairs <= static_cast<uint32_t>(-1));
+
+		vPairs.resize(nPairs << 1);
+		uint64_t iDst = 0;
+
+		if (1 & x0)
+		{
+			pos.X = x0 - 1;
+			LoadElement(vPairs.front(), pos);
+			iDst = 1;
+		}
+
+		uint64_t nCopy = std::min(x1, y1 << 1) - x0;
+		std::copy(v.begin(), v.begin() + nCopy, vPairs.begin() + iDst);
+
+		if (x1 < (y1 << 1))
+		{
+			pos.X = x1;
+			LoadElement(vPairs.back(), pos);
+		}
+
+		v.resize(nPairs);
+		InterpretLevel(&v.front(), &vPairs.front(), static_cast<uint32_t>(nPairs));
+
+		x0 = y0;
+		x1 = y1;
+		nLevel >>= 1;
+	}
+}
+
 void Mmr::get_PredictedHash(Hash& hv, const Hash& hvAppend) const
 {
 	hv = hvAppend;
@@ -483,16 +582,20 @@ struct FlyMmr::Inner
 	{
 		if (pos.H)
 		{
-			Position pos2;
-			pos2.X = pos.X << 1;
-			pos2.H = pos.H - 1;
-			Calculate(hv, pos2);
+			// complete subtree. Calculate it level-by-level, the hashes within a level are independent, and are calculated in a batch
+			assert(pos.H < 32);
+			uint32_t n = 1U << pos.H;
+			uint64_t x0 = pos.X << pos.H;
+			assert(x0 + n <= m_Count);
+
+			std::vector<Hash> v(n);
+			for (uint32_t i = 0; i < n; i++)
+				m_This.LoadElement(v[i], x0 + i);
 
-			Hash hv2;
-			pos2.X++;
-			Calculate(hv2, pos2);
+			for (; n > 1; n >>= 1)
+				InterpretBatch(&v.front(), &v.front(), n >> 1);
 
-			Interpret(hv, hv2, true);
+			hv = v.front();
 		}
 		else
 		{
@@ -636,6 +739,96 @@ void MultiProof::Verifier::Process(uint64_t i)
 	}
 }
 
+/////////////////////////////
+// SubtreeProof
+void SubtreeProof::Reset()
+{
+	m_vCodes.clear();
+	m_vHashes.clear();
+}
+
+void SubtreeProof::AddCode(uint32_t& nCodes, Code::Enum e)
+{
+	uint32_t nBit = (nCodes & 3) << 1;
+	if (!nBit)
+		m_vCodes.push_back(0);
+
+	m_vCodes.back() |= static_cast<uint8_t>(e) << nBit;
+	nCodes++;
+}
+
+struct SubtreeProof::Reader
+{
+	const SubtreeProof& m_This;
+	const Hash* m_pLeafs;
+	uint32_t m_nLeafs;
+
+	uint32_t m_iCode = 0;
+	uint32_t m_iHash = 0;
+	uint32_t m_iLeaf = 0;
+
+	Reader(const SubtreeProof& x) :m_This(x) {}
+
+	bool ReadHash(Hash& hv)
+	{
+		if (m_iHash >= m_This.m_vHashes.size())
+			return false;
+
+		hv = m_This.m_vHashes[m_iHash++];
+		return true;
+	}
+
+	bool Process(Hash& hv, uint16_t nDepth)
+	{
+		uint32_t iByte = m_iCode >> 2;
+		if (iByte >= m_This.m_vCodes.size())
+			return false;
+
+		uint8_t nCode = 3 & (m_This.m_vCodes[iByte] >> ((m_iCode & 3) << 1));
+		m_iCode++;
+
+		if (Code::Leaf == nCode)
+		{
+			if (m_iLeaf >= m_nLeafs)
+				return false;
+
+			hv = m_pLeafs[m_iLeaf++];
+			return true;
+		}
+
+		if (!nDepth--)
+			return false; // deeper than the tree may be
+
+		Hash hvR;
+		bool bOk = (Code::Right == nCode) ?
+			(ReadHash(hv) && Process(hvR, nDepth)) :
+			(Process(hv, nDepth) && ((Code::Both == nCode) ? Process(hvR, nDepth) : ReadHash(hvR)));
+
+		if (!bOk)
+			return false;
+
+		Interpret(hv, hv, hvR);
+		return true;
+	}
+};
+
+bool SubtreeProof::get_Root(Hash& hv, const Hash* pLeafs, uint32_t nLeafs, uint16_t nMaxDepth) const
+{
+	Reader r(*this);
+	r.m_pLeafs = pLeafs;
+	r.m_nLeafs = nLeafs;
+
+	if (!r.Process(hv, nMaxDepth))
+		return false;
+
+	// everything must be consumed, the padding bits must be zero
+	if ((r.m_iLeaf != nLeafs) || (r.m_iHash != m_vHashes.size()) || (((r.m_iCode + 3) >> 2) != m_vCodes.size()))
+		return false;
+
+	uint32_t nBit = (r.m_iCode & 3) << 1;
+	return !nBit || !(m_vCodes.back() >> nBit);
+}
+
 /////////////////////////////
 // HardVerifier
 HardVerifier::HardVerifier(const HardProof& p)
@@ -76,6 +76,7 @@ namespace Merkle {
 	void Interpret(Hash&, const Node&);
 	void Interpret(Hash&, const Hash& hLeft, const Hash& hRight);
 	void Interpret(Hash&, const Hash& hNew, bool bNewOnRight);
+	void InterpretBatch(Hash* pOut, const Hash* pPairs, uint32_t nPairs); // each output for the consecutive (left, right) pair. pOut may alias pPairs
 
 	struct Mmr
 	{
@@ -85,6 +86,13 @@ namespace Merkle {
 		void Append(const Hash&);
 		void Replace(uint64_t n, const Hash&);
 
+		// Bulk variants. The elements are hashed level-by-level in batches, each element is saved once.
+		// Large levels are split among the executor threads (if present)
+		void Append(const Hash*, uint64_t nCount);
+		void Replace(uint64_t n0, const Hash*, uint64_t nCount);
+
+		static const uint32_t s_ParallelMin = 0x400; // min hash pairs on a level to calculate it on the executor
+
 		void get_Hash(Hash&) const;
 		void get_PredictedHash(Hash&, const Hash& hvAppend) const;
 
@@ -268,6 +276,41 @@ namespace Merkle {
 		};
 	};
 
+	// Combined proof for several leaves of an arbitrary binary tree (such as the radix tree), in which their positions aren't known to the verifier.
+	// The subtree spanned by the paths of the leaves is encoded in pre-order: a 2-bit code per node, and the hashes of the omitted children.
+	// The leaves themselves are supplied by the verifier, in the tree order.
+	struct SubtreeProof
+	{
+		struct Code {
+			enum Enum {
+				Leaf,
+				Left, // only the left child is included, the right one is omitted
+				Right,
+				Both
+			};
+		};
+
+		std::vector<uint8_t> m_vCodes; // 4 per byte, from the LSB
+		std::vector<Hash> m_vHashes;
+
+		template <typename Archive>
+		void serialize(Archive& ar)
+		{
+			ar
+				& m_vCodes
+				& m_vHashes;
+		}
+
+		void Reset();
+		void AddCode(uint32_t& nCodes, Code::Enum);
+
+		// Returns false if the proof is malformed, or doesn't match the number of leaves
+		bool get_Root(Hash&, const Hash* pLeafs, uint32_t nLeafs, uint16_t nMaxDepth) const;
+
+	private:
+		struct Reader;
+	};
+
 	// Helper class for arbitrary (custom) tree
 	// Can be used to get the root hash, build a proof, and verification (deduce number of nodes and their direction)
 	struct IEvaluator
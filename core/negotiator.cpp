@@ -279,16 +279,20 @@ uint32_t Multisig::Update2()
 
 	bp.m_Part2 = p2;
 
-	o2 = oracle;
-	if (!bp.CoSign(nonces, sk, cp, o2, ECC::RangeProof::Confidential::Phase::Step2, &wrk.m_hGen))
-		return Status::Error;
-
 	uint32_t nShareRes = 0;
 	Get(nShareRes, Codes::ShareResult);
 
 	bool bMustHaveResult = !iRole || nShareRes;
 
-	if (!Get(bp.m_Part3.m_TauX, Codes::BpPart3))
+	bool bPart3 = Get(bp.m_Part3.m_TauX, Codes::BpPart3);
+	if (!bPart3 && (m_Pos >= 3))
+		return bMustHaveResult ? 0 : Status::Success; // already sent, waiting for the peer. Don't re-run the co-signing
+
+	o2 = oracle;
+	if (!bp.CoSign(nonces, sk, cp, o2, ECC::RangeProof::Confidential::Phase::Step2, &wrk.m_hGen))
+		return Status::Error;
+
+	if (!bPart3)
 	{
 		if (RaiseTo(3))
 		{
@@ -563,8 +567,21 @@ uint32_t MultiTx::Update2()
 		}
 	}
 
-	if (!BuildTxPart(tx, !iRole, skKrn))
-		return 0;
+	{
+		// creating the outputs (rangeproofs) is the most expensive part, and the result is deterministic
+		Transaction txOwn;
+		if (!Get(txOwn, Codes::TxOwn))
+		{
+			if (!BuildTxPart(txOwn, !iRole, skKrn))
+				return 0;
+
+			Set(txOwn, Codes::TxOwn);
+		}
+
+		tx.m_vInputs = std::move(txOwn.m_vInputs);
+		tx.m_vOutputs = std::move(txOwn.m_vOutputs);
+		tx.m_Offset = txOwn.m_Offset;
+	}
 
 	if (iRole || nShareRes)
 	{
@@ -296,6 +296,7 @@ namespace Negotiator {
 			static const uint32_t RestrictOutputs = Input0 + 32; // peer isn't allowed to "inflate" transaction (making it invalid or less likely to be mined). Can add up to 1 own output with DoNotDuplicate flag, no extra kernels
 
 			static const uint32_t Nonce = Variable0 + 1;
+			static const uint32_t TxOwn = Variable0 + 2; // own inputs/outputs/offset, kept to avoid re-creating them on each update
 
 			static const uint32_t KrnCommitment = PeerVariable0 + 0;
 			static const uint32_t KrnNonce = PeerVariable0 + 1;
@@ -193,6 +193,8 @@ PeerManager::PeerInfo* PeerManager::Find(const PeerID& id, bool& bCreate)
 	ret->m_LastSeen = 0;
 	ret->m_LastConnectAttempt = 0;
 	ret->m_LastActivity_ms = 0;
+	ret->m_Rtt_ms = 0;
+	ret->m_LastGood = 0;
 
 	BEAM_LOG_VERBOSE() << *ret << " New";
 
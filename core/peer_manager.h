@@ -147,6 +147,8 @@ namespace beam {
 			Timestamp m_LastSeen; // needed to filter-out dead peers, and to know when to update the address
 			Timestamp m_LastConnectAttempt;
 			uint32_t m_LastActivity_ms; // updated on connection attempt, and disconnection.
+			uint32_t m_Rtt_ms; // smoothed request latency, 0 - unknown
+			Timestamp m_LastGood; // data was downloaded successfully
 		};
 
 		typedef boost::intrusive::multiset<PeerInfo::ID> PeerIDSet;
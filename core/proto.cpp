@@ -17,6 +17,9 @@
 #include "core/ecc_native.h"
 #include "proto.h"
 #include "../utility/logger.h"
+#include "../utility/compress.h"
+#include "../utility/metrics.h"
+#include <chrono>
 
 namespace beam {
 namespace proto {
@@ -65,6 +68,32 @@ bool ProtocolPlus::VerifyMsg(const uint8_t* p, uint32_t nSize)
     return !memcmp(p + nSize - hmac.nBytes, hmac.m_pData, hmac.nBytes);
 }
 
+void ProtocolPlus::MacStart(const uint8_t* pHdr, uint32_t nSize)
+{
+    if (Mode::Duplex == m_Mode)
+    {
+        m_HMacStream = m_HMac;
+        m_HMacStream.Write(pHdr, nSize);
+    }
+}
+
+void ProtocolPlus::MacWrite(const uint8_t* p, uint32_t nSize)
+{
+    if (Mode::Duplex == m_Mode)
+        m_HMacStream.Write(p, nSize);
+}
+
+bool ProtocolPlus::MacVerify(const uint8_t* pMac)
+{
+    if (Mode::Duplex != m_Mode)
+        return true;
+
+    MacValue hmac;
+    get_HMac(m_HMacStream, hmac);
+
+    return !memcmp(pMac, hmac.m_pData, hmac.nBytes);
+}
+
 void ProtocolPlus::get_HMac(ECC::Hash::Mac& hm, MacValue& res)
 {
     ECC::Hash::Value hv;
@@ -150,14 +179,9 @@ void InitCipherIV(AES::StreamCipher& c, const ECC::Hash::Value& hvSecret, const
     c.m_nBuf = 0;
 }
 
-bool InitViaDiffieHellman(const ECC::Scalar::Native& myPrivate, const PeerID& remotePublic, AES::Encoder& enc, ECC::Hash::Mac& hmac, AES::StreamCipher* pCipherOut, AES::StreamCipher* pCipherIn)
+void InitViaDiffieHellman(const ECC::Scalar::Native& myPrivate, const ECC::Point::Native& ptRemote, const PeerID& remotePublic, const PeerID* pMyPublic, AES::Encoder& enc, ECC::Hash::Mac& hmac, AES::StreamCipher* pCipherOut, AES::StreamCipher* pCipherIn)
 {
-    // Diffie-Hellman
-    ECC::Point::Native p;
-    if (!remotePublic.ExportNnz(p))
-        return false;
-
-    ECC::Point::Native ptSecret = p * myPrivate;
+    ECC::Point::Native ptSecret = ptRemote * myPrivate;
 
     ECC::NoLeak<ECC::Hash::Value> hvSecret;
     ECC::Hash::Processor() << ptSecret >> hvSecret.V;
@@ -173,10 +197,23 @@ bool InitViaDiffieHellman(const ECC::Scalar::Native& myPrivate, const PeerID& re
     if (pCipherIn)
     {
         PeerID myPublic;
-        myPublic.FromSk(Cast::NotConst(myPrivate)); // my private must have been already normalized. Should not be modified.
-        InitCipherIV(*pCipherIn, hvSecret.V, myPublic);
+        if (!pMyPublic)
+        {
+            myPublic.FromSk(Cast::NotConst(myPrivate)); // my private must have been already normalized. Should not be modified.
+            pMyPublic = &myPublic;
+        }
+        InitCipherIV(*pCipherIn, hvSecret.V, *pMyPublic);
     }
+}
+
+bool InitViaDiffieHellman(const ECC::Scalar::Native& myPrivate, const PeerID& remotePublic, AES::Encoder& enc, ECC::Hash::Mac& hmac, AES::StreamCipher* pCipherOut, AES::StreamCipher* pCipherIn)
+{
+    // Diffie-Hellman
+    ECC::Point::Native p;
+    if (!remotePublic.ExportNnz(p))
+        return false;
 
+    InitViaDiffieHellman(myPrivate, p, remotePublic, nullptr, enc, hmac, pCipherOut, pCipherIn);
     return true;
 }
 
@@ -218,19 +255,34 @@ bool Bbs::Encrypt(ByteBuffer& res, const PeerID& publicAddr, ECC::Scalar::Native
 
 bool Bbs::Decrypt(uint8_t*& p, uint32_t& n, const ECC::Scalar::Native& privateAddr)
 {
-    PeerID remotePublic;
-    ECC::Hash::Value hvMac, hvMac2;
+    DecryptCtx ctx;
+    if (!ctx.Init(p, n))
+        return false;
+
+    PeerID myPublic;
+    myPublic.FromSk(Cast::NotConst(privateAddr)); // must have been already normalized. Should not be modified.
 
-    if (n < remotePublic.nBytes + hvMac.nBytes)
+    return ctx.Decrypt(p, n, privateAddr, myPublic);
+}
+
+bool Bbs::DecryptCtx::Init(const uint8_t* p, uint32_t n)
+{
+    if (n < m_RemotePublic.nBytes + ECC::Hash::Value::nBytes)
         return false;
 
-    memcpy(remotePublic.m_pData, p, remotePublic.nBytes);
+    memcpy(m_RemotePublic.m_pData, p, m_RemotePublic.nBytes);
+    return m_RemotePublic.ExportNnz(m_ptRemote); // bad address
+}
+
+bool Bbs::DecryptCtx::Decrypt(uint8_t*& p, uint32_t& n, const ECC::Scalar::Native& privateAddr, const PeerID& publicAddr) const
+{
+    const PeerID& remotePublic = m_RemotePublic;
+    ECC::Hash::Value hvMac, hvMac2;
 
     AES::Encoder enc;
     AES::StreamCipher cIn;
     ECC::Hash::Mac hmac;
-    if (!InitViaDiffieHellman(privateAddr, remotePublic, enc, hmac, NULL, &cIn))
-        return false; // bad address
+    InitViaDiffieHellman(privateAddr, m_ptRemote, remotePublic, &publicAddr, enc, hmac, NULL, &cIn);
 
     cIn.XCrypt(enc, p + remotePublic.nBytes, n - remotePublic.nBytes);
 
@@ -301,14 +353,47 @@ NodeConnection::NodeConnection()
     ,m_LoginFlags(0)
 {
 #define THE_MACRO(code, msg) \
-    m_Protocol.add_message_handler<NodeConnection, msg##_NoInit, &NodeConnection::OnMsgInternal>(uint8_t(code), this, 0, 1024*1024*10);
+    m_Protocol.add_message_handler<NodeConnection, msg##_NoInit, &NodeConnection::OnMsgInternal>(uint8_t(code), this, 0, s_MaxMsgSize);
 
     BeamNodeMsgsAll(THE_MACRO)
 #undef THE_MACRO
+
+    m_Protocol.set_stream_parser(uint8_t(BodyPack::s_Code), &NodeConnection::CreateBodyPackParser);
 }
 
+struct NodeConnection::MsgTiming
+{
+    NodeConnection* m_pThis = nullptr;
+    uint8_t m_Code;
+    std::chrono::steady_clock::time_point m_t0;
+
+    MsgTiming(NodeConnection& x, uint8_t nCode)
+        :m_Code(nCode)
+    {
+        if (x.m_MeasureMsgs && !x.m_pMsgTiming)
+        {
+            m_pThis = &x;
+            x.m_pMsgTiming = this;
+            m_t0 = std::chrono::steady_clock::now();
+        }
+    }
+
+    ~MsgTiming()
+    {
+        if (m_pThis)
+        {
+            m_pThis->m_pMsgTiming = nullptr;
+
+            auto dt = std::chrono::steady_clock::now() - m_t0;
+            m_pThis->OnMsgTiming(m_Code, std::chrono::duration_cast<std::chrono::microseconds>(dt).count());
+        }
+    }
+};
+
 NodeConnection::~NodeConnection()
 {
+    if (m_pMsgTiming)
+        m_pMsgTiming->m_pThis = nullptr; // deleted during message handling
     Reset();
 }
 
@@ -424,6 +509,17 @@ size_t NodeConnection::get_Unsent() const
 	return m_Connection ? m_Connection->get_Unsent() : 0;
 }
 
+void NodeConnection::SuspendInput()
+{
+	if (m_Connection)
+		m_Connection->suspend_read();
+}
+
+bool NodeConnection::ResumeInput()
+{
+	return m_Connection ? m_Connection->resume_read() : true;
+}
+
 void NodeConnection::on_protocol_error(uint64_t, ProtocolError error)
 {
     Reset();
@@ -520,20 +616,74 @@ bool NodeConnection::IsLive() const
     return m_Connection && !m_pAsyncFail;
 }
 
+// Already serialized message, written as-is
+struct SerializedRef
+{
+    const SerializeBuffer& m_Buf;
+
+    template <typename Archive>
+    void serialize(Archive& ar)
+    {
+        if (m_Buf.second)
+            ar.write(m_Buf.first, m_Buf.second);
+    }
+};
+
+template <typename T>
+void NodeConnection::SendRawAs(uint8_t code, const T& v)
+{
+    if (!IsLive())
+        return;
+
+    if (m_CompressOut && IsCompressible(code) && (get_Ext() >= 13))
+    {
+        // serialize once, and then send either compressed or as-is
+        Serializer ser;
+        ser & v;
+        SerializeBuffer sb = ser.buffer();
+
+        if (!SendCompressed(code, sb))
+            SendRawPlain(code, SerializedRef{ sb });
+        return;
+    }
+
+    SendRawPlain(code, v);
+}
+
+template <typename T>
+void NodeConnection::SendRawPlain(uint8_t code, const T& v)
+{
+    if (m_TagOut)
+    {
+        Serializer ser;
+        ser & v;
+        SerializeBuffer sb = ser.buffer();
+
+        Tagged msg;
+        msg.m_ID = m_TagOut;
+        msg.m_Code = code;
+        msg.m_Data.assign(sb.first, sb.first + sb.second);
+
+        TagScope scope(m_TagOut, 0);
+        SendRawPlain(Tagged::s_Code, msg);
+        return;
+    }
+
+    m_SerializeCache.clear();
+    MsgSerializer& ser = m_Protocol.serializeNoFinalize(m_SerializeCache, code, v);
+    m_Protocol.Encrypt(m_SerializeCache, ser);
+    OnTraficOut(code);
+    io::Result res = m_Connection->write_msg(m_SerializeCache);
+    m_SerializeCache.clear();
+
+    TestIoResultAsync(res);
+    TestNotDrown();
+}
+
 #define THE_MACRO(code, msg) \
 void NodeConnection::SendRaw(const msg& v) \
 { \
-    if (!IsLive()) \
-        return; \
-    m_SerializeCache.clear(); \
-    MsgSerializer& ser = m_Protocol.serializeNoFinalize(m_SerializeCache, uint8_t(code), v); \
-    m_Protocol.Encrypt(m_SerializeCache, ser); \
-    OnTraficOut(msg::s_Code); \
-    io::Result res = m_Connection->write_msg(m_SerializeCache); \
-    m_SerializeCache.clear(); \
-\
-    TestIoResultAsync(res); \
-    TestNotDrown(); \
+    SendRawAs(uint8_t(code), v); \
 } \
 \
 bool NodeConnection::OnMsgInternal(uint64_t, msg##_NoInit&& v, uint32_t msgSize) \
@@ -542,6 +692,8 @@ bool NodeConnection::OnMsgInternal(uint64_t, msg##_NoInit&& v, uint32_t msgSize)
         /* checkpoint */ \
         TestInputMsgContext(code); \
         OnTrafic(msg::s_Code, msgSize, false); \
+        MsgTiming mt(*this, code); \
+        BEAM_METRICS_SCOPE("Peer.OnMsg." #msg); \
         return OnMsg2(std::move(v)); \
     } catch (const NodeProcessingException& e) { \
         OnProcessingExc(e); \
@@ -622,6 +774,136 @@ void NodeConnection::OnMsg(SChannelInitiate&& msg)
 	OnConnectedSecure();
 }
 
+uint64_t CompactBody::get_ShortID(const ECC::Point& pt)
+{
+    uint64_t val;
+    static_assert(sizeof(val) < pt.m_X.nBytes);
+    memcpy(&val, pt.m_X.m_pData, sizeof(val));
+    return val;
+}
+
+uint64_t CompactBody::get_ShortID(const Merkle::Hash& hv)
+{
+    uint64_t val;
+    memcpy(&val, hv.m_pData, sizeof(val));
+    return val;
+}
+
+void CompactBody::get_Hash(Merkle::Hash& hv, const Blob& perishable, const Blob& eternal)
+{
+    ECC::Hash::Processor()
+        << "body.c"
+        << perishable.n
+        << perishable
+        << eternal.n
+        << eternal
+        >> hv;
+}
+
+void InvSketch::Init(uint32_t nCells)
+{
+    nCells += (s_Hashes - nCells % s_Hashes) % s_Hashes;
+
+    m_vCount.assign(nCells, 0);
+    m_vKey.assign(nCells, 0);
+    m_vCheck.assign(nCells, 0);
+}
+
+bool InvSketch::IsValid() const
+{
+    return
+        !(m_vCount.size() % s_Hashes) &&
+        (m_vKey.size() == m_vCount.size()) &&
+        (m_vCheck.size() == m_vCount.size());
+}
+
+uint64_t InvSketch::get_ShortID(const Transaction::KeyType& key)
+{
+    uint64_t val;
+    memcpy(&val, key.m_pData, sizeof(val));
+    return val;
+}
+
+uint64_t InvSketch::get_Check(uint64_t id)
+{
+    // splitmix64 finalizer
+    id += 0x9e3779b97f4a7c15ULL;
+    id = (id ^ (id >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    id = (id ^ (id >> 27)) * 0x94d049bb133111ebULL;
+    return id ^ (id >> 31);
+}
+
+uint32_t InvSketch::get_Cell(uint64_t id, uint32_t iHash) const
+{
+    uint32_t nSub = static_cast<uint32_t>(m_vCount.size() / s_Hashes);
+    assert(nSub);
+
+    uint64_t val = get_Check(id + iHash + 1);
+    return iHash * nSub + static_cast<uint32_t>(val % nSub);
+}
+
+void InvSketch::Toggle(uint32_t iCell, uint64_t id, uint64_t nCheck, uint32_t nDelta)
+{
+    m_vCount[iCell] += nDelta;
+    m_vKey[iCell] ^= id;
+    m_vCheck[iCell] ^= nCheck;
+}
+
+void InvSketch::Add(uint64_t id)
+{
+    uint64_t nCheck = get_Check(id);
+    for (uint32_t i = 0; i < s_Hashes; i++)
+        Toggle(get_Cell(id, i), id, nCheck, 1);
+}
+
+void InvSketch::Subtract(const InvSketch& x)
+{
+    assert(x.m_vCount.size() == m_vCount.size());
+
+    for (size_t i = 0; i < m_vCount.size(); i++)
+    {
+        m_vCount[i] -= x.m_vCount[i];
+        m_vKey[i] ^= x.m_vKey[i];
+        m_vCheck[i] ^= x.m_vCheck[i];
+    }
+}
+
+bool InvSketch::Decode(std::vector<uint64_t>& vPositive, std::vector<uint64_t>& vNegative)
+{
+    uint32_t nCells = static_cast<uint32_t>(m_vCount.size());
+
+    // peel the pure cells (a single ID, verified by its hash), until nothing left
+    for (bool bProgress = true; bProgress; )
+    {
+        bProgress = false;
+
+        for (uint32_t iCell = 0; iCell < nCells; iCell++)
+        {
+            uint32_t nCount = m_vCount[iCell];
+            if ((1 != nCount) && (static_cast<uint32_t>(-1) != nCount))
+                continue;
+
+            uint64_t id = m_vKey[iCell];
+            uint64_t nCheck = get_Check(id);
+            if (m_vCheck[iCell] != nCheck)
+                continue;
+
+            ((1 == nCount) ? vPositive : vNegative).push_back(id);
+
+            for (uint32_t i = 0; i < s_Hashes; i++)
+                Toggle(get_Cell(id, i), id, nCheck, 0 - nCount);
+
+            bProgress = true;
+        }
+    }
+
+    for (uint32_t iCell = 0; iCell < nCells; iCell++)
+        if (m_vCount[iCell] || m_vKey[iCell] || m_vCheck[iCell])
+            return false;
+
+    return true;
+}
+
 void LoginFlags::Extension::set(uint32_t& nFlags, uint32_t nExt)
 {
     assert(!(nFlags & Msk));
@@ -973,6 +1255,220 @@ void NodeConnection::OnMsg(NewTransaction0&& msg0)
     Cast::Down<INodeMsgHandler>(*this).OnMsg(std::move(msg));
 }
 
+bool NodeConnection::IsCompressible(uint8_t nCode)
+{
+    switch (nCode)
+    {
+    case HdrPack::s_Code:
+    case BodyPack::s_Code:
+    case ShieldedList::s_Code:
+        return true;
+
+    default:
+        return false;
+    }
+}
+
+bool NodeConnection::SendCompressed(uint8_t nCode, const SerializeBuffer& sb)
+{
+    if (sb.second < s_CompressMinSize)
+        return false;
+
+    Compressed msg;
+    msg.m_Code = nCode;
+    msg.m_Size = static_cast<uint32_t>(sb.second);
+    msg.m_Data.resize(lz::get_max_compressed_size(sb.second));
+
+    size_t n = lz::compress(&msg.m_Data.front(), reinterpret_cast<const uint8_t*>(sb.first), sb.second);
+    if (n > sb.second - sb.second / 8)
+        return false; // not worth it, block bodies are mostly incompressible
+
+    msg.m_Data.resize(n);
+    Send(msg);
+    return true;
+}
+
+bool NodeConnection::OnMsg2(Compressed&& msg)
+{
+    if (!IsCompressible(msg.m_Code) || (msg.m_Size > s_MaxMsgSize))
+        ThrowUnexpected();
+
+    ByteBuffer buf(msg.m_Size);
+    if (!lz::decompress(buf.data(), buf.size(), msg.m_Data.data(), msg.m_Data.size()))
+        ThrowUnexpected("bad compressed data");
+
+    ByteBuffer().swap(msg.m_Data);
+
+    // dispatch as if it was received uncompressed
+    return m_Protocol.on_new_message(0, msg.m_Code, buf.data(), buf.size());
+}
+
+bool NodeConnection::OnMsg2(Tagged&& msg)
+{
+    if (!msg.m_ID || m_TagIn || (Tagged::s_Code == msg.m_Code))
+        ThrowUnexpected();
+
+    ByteBuffer buf;
+    buf.swap(msg.m_Data);
+
+    TagScope scope(m_TagIn, msg.m_ID);
+    return m_Protocol.on_new_message(0, msg.m_Code, buf.data(), buf.size());
+}
+
+void NodeConnection::SendBody(const BodyBuffersRef& x)
+{
+    // wire format of Body
+    SendRawAs(Body::s_Code, x);
+}
+
+void NodeConnection::SendBodyPack(const std::vector<BodyBuffersRef>& v)
+{
+    // wire format of BodyPack
+    SendRawAs(BodyPack::s_Code, v);
+}
+
+void NodeConnection::SendSerialized(uint8_t code, const ByteBuffer& buf)
+{
+    SerializeBuffer sb(reinterpret_cast<const char*>(buf.empty() ? nullptr : &buf.front()), buf.size());
+    SendRawAs(code, SerializedRef{ sb });
+}
+
+/////////////////////////
+// NodeConnection::BodyPackParser
+// Deserializes std::vector<BodyBuffers> incrementally, the buffers are filled directly from the stream.
+// The message is dispatched only after the whole of it is received and its MAC verified
+struct NodeConnection::BodyPackParser
+    :public IStreamParser
+{
+    NodeConnection& m_This;
+    BodyPack_NoInit m_Msg;
+    uint32_t m_nSize;
+    size_t m_nLeft; // body bytes not received yet
+
+    // sizes are in the yas compacted format: either a single byte, or the length byte followed by the value
+    uint8_t m_pSize[1 + sizeof(uint64_t)];
+    uint32_t m_nSizeRead = 0;
+    Deserializer m_Der;
+
+    bool m_bCount = false; // elements count is read
+    uint64_t m_nCount = 0; // elements remaining
+    uint32_t m_iBuf = 0; // perishable/eternal of the current element
+    ByteBuffer* m_pDst = nullptr; // buffer being filled
+    size_t m_nDst = 0;
+
+    BodyPackParser(NodeConnection& x, uint32_t nSize)
+        :m_This(x)
+        ,m_nSize(nSize)
+        ,m_nLeft(nSize)
+    {
+    }
+
+    bool IsDone() const
+    {
+        return m_bCount && !m_nCount && !m_pDst;
+    }
+
+    void OnBufferDone()
+    {
+        m_pDst = nullptr;
+        m_iBuf ^= 1;
+        if (!m_iBuf)
+            m_nCount--;
+    }
+
+    bool OnSize(uint64_t n)
+    {
+        if (!m_bCount)
+        {
+            // each element takes at least 2 bytes
+            if (n > m_nLeft / 2)
+                return false;
+
+            m_bCount = true;
+            m_nCount = n;
+            m_Msg.m_Bodies.reserve(static_cast<size_t>(std::min<uint64_t>(n, 0x100)));
+            return true;
+        }
+
+        if (n > m_nLeft)
+            return false;
+
+        if (!m_iBuf)
+            m_Msg.m_Bodies.emplace_back();
+
+        BodyBuffers& bb = m_Msg.m_Bodies.back();
+        m_pDst = m_iBuf ? &bb.m_Eternal : &bb.m_Perishable;
+        m_pDst->resize(static_cast<size_t>(n));
+        m_nDst = 0;
+
+        if (!n)
+            OnBufferDone();
+
+        return true;
+    }
+
+    bool on_data(const uint8_t* p, size_t n) override
+    {
+        while (n)
+        {
+            if (IsDone())
+                return false; // trailing data
+
+            if (m_pDst)
+            {
+                size_t nPortion = std::min(n, m_pDst->size() - m_nDst);
+                memcpy(&m_pDst->front() + m_nDst, p, nPortion);
+
+                m_nDst += nPortion;
+                m_nLeft -= nPortion;
+                p += nPortion;
+                n -= nPortion;
+
+                if (m_pDst->size() == m_nDst)
+                    OnBufferDone();
+
+                continue;
+            }
+
+            m_pSize[m_nSizeRead++] = *p++;
+            n--;
+            m_nLeft--;
+
+            uint32_t nLen = (0x80 & m_pSize[0]) ? 1 : (1 + m_pSize[0]);
+            if (nLen > _countof(m_pSize))
+                return false;
+
+            if (m_nSizeRead < nLen)
+                continue;
+
+            m_nSizeRead = 0;
+
+            uint64_t nVal;
+            m_Der.reset(m_pSize, nLen);
+            if (!m_Der.deserialize(nVal) || m_Der.bytes_left() || !OnSize(nVal))
+                return false;
+        }
+
+        return true;
+    }
+
+    bool on_complete(uint64_t fromStream) override
+    {
+        if (!IsDone())
+        {
+            m_This.on_protocol_error(fromStream, ProtocolError::message_corrupted);
+            return false;
+        }
+
+        return m_This.OnMsgInternal(fromStream, std::move(m_Msg), m_nSize);
+    }
+};
+
+IStreamParser* NodeConnection::CreateBodyPackParser(void* pThis, uint32_t nSize)
+{
+    return new BodyPackParser(*static_cast<NodeConnection*>(pThis), nSize);
+}
+
 void NodeConnection::Send(const NewTransaction& msg)
 {
     if (get_Ext() >= 9)
@@ -989,9 +1485,9 @@ void NodeConnection::Send(const NewTransaction& msg)
 
 /////////////////////////
 // NodeConnection::Server
-void NodeConnection::Server::Listen(const io::Address& addr)
+void NodeConnection::Server::Listen(const io::Address& addr, bool bReusePort /* = false */)
 {
-    m_pServer = io::TcpServer::create(io::Reactor::get_Current(), addr, BIND_THIS_MEMFN(OnAccepted));
+    m_pServer = io::TcpServer::create(io::Reactor::get_Current(), addr, BIND_THIS_MEMFN(OnAccepted), bReusePort);
 }
 
 /////////////////////////
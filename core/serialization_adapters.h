@@ -1119,20 +1119,29 @@ namespace detail
 
 			bool bRecoveryOnly = !!pRecoveryScheme;
 
+			// existing proof objects are reused, so that an Output can be deserialized repeatedly without reallocating
 			if (4 & nFlags)
 			{
-				output.m_pConfidential = std::make_unique<ECC::RangeProof::Confidential>();
+				if (!output.m_pConfidential)
+					output.m_pConfidential = std::make_unique<ECC::RangeProof::Confidential>();
 				load(ar, *output.m_pConfidential, bRecoveryOnly);
 			}
+			else
+				output.m_pConfidential.reset();
 
 			if (8 & nFlags)
 			{
-				output.m_pPublic = std::make_unique<ECC::RangeProof::Public>();
+				if (!output.m_pPublic)
+					output.m_pPublic = std::make_unique<ECC::RangeProof::Public>();
 				load(ar, *output.m_pPublic, bRecoveryOnly);
 			}
+			else
+				output.m_pPublic.reset();
 
 			if (0x10 & nFlags)
 				ar & output.m_Incubation;
+			else
+				output.m_Incubation = 0;
 
 			if (0x20 & nFlags)
 			{
@@ -1147,6 +1156,8 @@ namespace detail
 				else
 					loadPtr(ar, output.m_pAsset);
 			}
+			else
+				output.m_pAsset.reset();
 
 
 			if (0x80 & nFlags)
@@ -408,6 +408,11 @@ namespace beam
 		if (!ctx.ValidateAndSummarize(m_Data, m_Data.get_Reader()))
 			return false;
 
+		return IsValidSummary(ctx);
+	}
+
+	bool Treasury::Data::Group::IsValidSummary(TxBase::Context& ctx) const
+	{
 		if (!(ctx.m_Stats.m_Fee == Zero))
 			return false; // doesn't make sense for treasury
 
@@ -419,22 +424,75 @@ namespace beam
 
 	bool Treasury::Data::IsValid() const
 	{
-		// finalize
+		// The groups differ much in size, hence each one is split among several verifiers (the elements are interleaved between them),
+		// and all the parts are verified in parallel. Then the parts of each group are merged
 		struct Context
 			:public ThreadPool::Verifier
 		{
+			struct Part
+			{
+				size_t m_iGroup;
+				TxBase::Context m_Ctx;
+			};
+
 			const Data& m_Data;
+			std::vector<Part> m_vParts;
+
 			Context(const Data& d) :m_Data(d) {}
 
 			virtual bool Verify(size_t iTask) override
 			{
-				return m_Data.m_vGroups[iTask].IsValid();
+				Part& x = m_vParts[iTask];
+				const Transaction& tx = m_Data.m_vGroups[x.m_iGroup].m_Data;
+				return x.m_Ctx.ValidateAndSummarize(tx, tx.get_Reader());
 			}
 
 		} ctx(*this);
 
-		ctx.DoAll(m_vGroups.size());
-		return ctx.m_bValid;
+		const size_t nPerPart = 0x100; // elements
+
+		for (size_t iG = 0; iG < m_vGroups.size(); iG++)
+		{
+			const Transaction& tx = m_vGroups[iG].m_Data;
+			size_t nElems = tx.m_vInputs.size() + tx.m_vOutputs.size() + tx.m_vKernels.size();
+			uint32_t nParts = static_cast<uint32_t>(std::max<size_t>(1, (nElems + nPerPart - 1) / nPerPart));
+
+			for (uint32_t i = 0; i < nParts; i++)
+			{
+				auto& x = ctx.m_vParts.emplace_back();
+				x.m_iGroup = iG;
+				ZeroObject(x.m_Ctx.m_Height); // current height is zero
+				x.m_Ctx.m_Params.m_nVerifiers = nParts;
+				x.m_Ctx.m_iVerifier = i;
+			}
+		}
+
+		if (!ctx.m_vParts.empty())
+			ctx.DoAll(ctx.m_vParts.size());
+
+		if (!ctx.m_bValid)
+			return false;
+
+		for (size_t i0 = 0; i0 < ctx.m_vParts.size(); )
+		{
+			Context::Part& x = ctx.m_vParts[i0];
+
+			size_t i1 = i0 + 1;
+			try {
+				for (; (i1 < ctx.m_vParts.size()) && (ctx.m_vParts[i1].m_iGroup == x.m_iGroup); i1++)
+					x.m_Ctx.MergeStrict(ctx.m_vParts[i1].m_Ctx);
+			}
+			catch (const std::exception&) {
+				return false;
+			}
+
+			if (!m_vGroups[x.m_iGroup].IsValidSummary(x.m_Ctx))
+				return false;
+
+			i0 = i1;
+		}
+
+		return true;
 	}
 
 	std::vector<Treasury::Data::Burst> Treasury::Data::get_Bursts() const
@@ -157,6 +157,7 @@ namespace beam
 				AmountBig::Number m_Value;
 
 				bool IsValid() const;
+				bool IsValidSummary(TxBase::Context&) const; // the validated context of the whole group, modifies it
 
 				template <typename Archive>
 				void serialize(Archive& ar)
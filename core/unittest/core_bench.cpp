@@ -0,0 +1,552 @@
+// Copyright 2018 The Beam Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Micro-benchmarks of the core cryptography.
+// Prints a CSV line per benchmark: name,us_per_op,ops
+// The output of a previous run can be given as a baseline, then the benchmarks that got slower than the tolerance
+// are reported, and the exit code is non-zero.
+//
+// core_bench [--filter <substr>] [--time <seconds>] [--threads <n>] [--baseline <file.csv>] [--tolerance <percent>]
+
+#include <chrono>
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../ecc_native.h"
+#include "../block_crypt.h"
+#include "../aes.h"
+#include "../lelantus.h"
+
+namespace ECC {
+
+struct BenchCfg
+{
+	std::string m_sFilter;
+	double m_Time_s = 1.;
+	uint32_t m_Threads = 1;
+} g_Cfg;
+
+struct BenchResult
+{
+	std::string m_sName;
+	double m_us;
+	uint64_t m_Ops;
+};
+
+std::vector<BenchResult> g_vResults;
+uint32_t g_Errors = 0;
+
+bool IsWanted(const std::string& sName)
+{
+	return g_Cfg.m_sFilter.empty() || (sName.find(g_Cfg.m_sFilter) != std::string::npos);
+}
+
+void CheckResult(bool b, const char* sz)
+{
+	if (!b)
+	{
+		fprintf(stderr, "Invalid result: %s\n", sz);
+		g_Errors++;
+	}
+}
+
+// for (Meter bm("Name"); bm.ShouldContinue(); ) { for (uint32_t i = 0; i < bm.N; i++) ... }
+// The number of iterations is doubled until the measurement takes long enough
+struct Meter
+{
+	std::string m_sName;
+	uint32_t m_OpsPerIteration;
+
+	uint64_t m_Iterations = 0;
+	uint32_t N = 0;
+	std::chrono::steady_clock::time_point m_Start;
+
+	Meter(std::string&& sName, uint32_t nOpsPerIteration = 1)
+		:m_sName(std::move(sName))
+		,m_OpsPerIteration(nOpsPerIteration)
+	{
+	}
+
+	bool ShouldContinue()
+	{
+		if (!N)
+		{
+			if (!IsWanted(m_sName))
+				return false;
+
+			N = 1;
+			m_Start = std::chrono::steady_clock::now();
+			return true;
+		}
+
+		m_Iterations += N;
+
+		double dt_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - m_Start).count();
+		if (dt_s >= g_Cfg.m_Time_s)
+		{
+			auto& r = g_vResults.emplace_back();
+			r.m_sName = m_sName;
+			r.m_Ops = m_Iterations * m_OpsPerIteration;
+			r.m_us = dt_s * 1e6 / double(r.m_Ops);
+
+			printf("%s,%.3f,%llu\n", r.m_sName.c_str(), r.m_us, (unsigned long long) r.m_Ops);
+			fflush(stdout);
+			return false;
+		}
+
+		if (dt_s < g_Cfg.m_Time_s * 0.5)
+			N <<= 1;
+
+		return true;
+	}
+};
+
+void SetRandom(Scalar::Native& x)
+{
+	Scalar s;
+	do
+		GenRandom(s.m_Value);
+	while (x.Import(s));
+}
+
+void SetRandom(Point::Native& x)
+{
+	Point p;
+	GenRandom(p.m_X);
+	p.m_Y = 0;
+
+	while (!x.Import(p))
+		p.m_X.Inc();
+}
+
+void BenchMultiMac()
+{
+	Mode::Scope scope(Mode::Fast);
+
+	// below and above the thresholds of the bucket method and the parallel split
+	const uint32_t pCount[] = { 8, 64, MultiMac::s_PippengerMin, MultiMac::s_ParallelMin, 4096 };
+
+	for (uint32_t iTest = 0; iTest < _countof(pCount); iTest++)
+	{
+		const uint32_t nCount = pCount[iTest];
+
+		std::string sName = "MultiMac." + std::to_string(nCount);
+		if (!IsWanted(sName))
+			continue;
+
+		MultiMac_Dyn mm;
+		mm.Prepare(nCount, 1);
+
+		std::vector<Point::Native> vPts(nCount);
+		for (uint32_t i = 0; i < nCount; i++)
+		{
+			SetRandom(vPts[i]);
+			SetRandom(mm.m_pKCasual[i]);
+		}
+
+		mm.m_ppPrepared[0] = &Context::get().m_Ipp.G_;
+		SetRandom(mm.m_pKPrep[0]);
+
+		Point::Native res;
+
+		// the casual points are initialized each time, as in the verification
+		for (Meter bm(std::move(sName)); bm.ShouldContinue(); )
+		{
+			for (uint32_t i = 0; i < bm.N; i++)
+			{
+				for (uint32_t j = 0; j < nCount; j++)
+					mm.m_pCasual[j].Init(vPts[j]);
+
+				mm.m_Casual = nCount;
+				mm.m_Prepared = 1;
+				mm.Calculate(res);
+			}
+		}
+
+		if (g_Cfg.m_Threads > 1)
+		{
+			for (Meter bm("MultiMac." + std::to_string(nCount) + ".Parallel"); bm.ShouldContinue(); )
+			{
+				for (uint32_t i = 0; i < bm.N; i++)
+				{
+					for (uint32_t j = 0; j < nCount; j++)
+						mm.m_pCasual[j].Init(vPts[j]);
+
+					mm.m_Casual = nCount;
+					mm.m_Prepared = 1;
+					mm.CalculateParallel(res);
+				}
+			}
+		}
+	}
+}
+
+template <uint32_t nBatch>
+void BenchBulletproofBatch(const RangeProof::Confidential& bp, const Point::Native& comm)
+{
+	// per proof, the flush included
+	std::string sName = "BulletProof.Verify.Batch" + std::to_string(nBatch);
+	if (!IsWanted(sName))
+		return;
+
+	typedef InnerProduct::BatchContextEx<nBatch> MyBatch;
+	std::unique_ptr<MyBatch> p(new MyBatch);
+
+	InnerProduct::BatchContext::Scope scope(*p);
+
+	bool bValid = true;
+
+	for (Meter bm(std::move(sName), nBatch); bm.ShouldContinue(); )
+	{
+		for (uint32_t i = 0; i < bm.N; i++)
+		{
+			for (uint32_t n = 0; n < nBatch; n++)
+			{
+				Oracle oracle;
+				if (!bp.IsValid(comm, oracle))
+					bValid = false;
+			}
+
+			if (!p->Flush())
+				bValid = false;
+		}
+	}
+
+	CheckResult(bValid, "BulletProof batch");
+}
+
+void BenchBulletproof()
+{
+	Scalar::Native sk;
+	SetRandom(sk);
+
+	RangeProof::Confidential bp;
+	RangeProof::Params::Create cp;
+	GenRandom(cp.m_Seed.V);
+	cp.m_Value = 23110;
+
+	for (Meter bm("BulletProof.Create"); bm.ShouldContinue(); )
+	{
+		for (uint32_t i = 0; i < bm.N; i++)
+		{
+			Oracle oracle;
+			bp.Create(sk, cp, oracle);
+		}
+	}
+
+	{
+		Oracle oracle;
+		bp.Create(sk, cp, oracle); // in case the above was filtered out
+	}
+
+	Point::Native comm = Commitment(sk, cp.m_Value);
+
+	bool bValid = true;
+	for (Meter bm("BulletProof.Verify"); bm.ShouldContinue(); )
+	{
+		for (uint32_t i = 0; i < bm.N; i++)
+		{
+			Oracle oracle;
+			if (!bp.IsValid(comm, oracle))
+				bValid = false;
+		}
+	}
+	CheckResult(bValid, "BulletProof");
+
+	BenchBulletproofBatch<1>(bp, comm);
+	BenchBulletproofBatch<4>(bp, comm);
+	BenchBulletproofBatch<16>(bp, comm);
+	BenchBulletproofBatch<64>(bp, comm);
+}
+
+void BenchLelantus(uint32_t n, uint32_t M)
+{
+	beam::Lelantus::Cfg cfg;
+	cfg.n = n;
+	cfg.M = M;
+
+	const uint32_t N = cfg.get_N();
+
+	std::string sPrefix = "Lelantus." + std::to_string(N);
+	if (!IsWanted(sPrefix + ".Prove") && !IsWanted(sPrefix + ".Verify"))
+		return;
+
+	beam::Lelantus::CmListVec lst;
+	lst.m_vec.resize(N);
+
+	Point::Native rnd;
+	SetRandom(rnd);
+	for (uint32_t i = 0; i < N; i++, rnd += rnd)
+		rnd.Export(lst.m_vec[i]);
+
+	beam::Lelantus::Proof proof;
+	proof.m_Cfg = cfg;
+	beam::Lelantus::Prover p(lst, proof);
+
+	p.m_Witness.m_V = 100500;
+	p.m_Witness.m_R = 4U;
+	p.m_Witness.m_R_Output = 756U;
+	p.m_Witness.m_L = 333 % N;
+	SetRandom(p.m_Witness.m_SpendSk);
+
+	Point::Native pt = Context::get().G * p.m_Witness.m_SpendSk;
+	Point ptSpendPk = pt;
+	Scalar::Native ser;
+	beam::Lelantus::SpendKey::ToSerial(ser, ptSpendPk);
+
+	pt = Context::get().G * p.m_Witness.m_R;
+	Tag::AddValue(pt, nullptr, p.m_Witness.m_V);
+	pt += Context::get().J * ser;
+	pt.Export(lst.m_vec[p.m_Witness.m_L]);
+
+	Hash::Value seed = Zero;
+
+	for (Meter bm(sPrefix + ".Prove"); bm.ShouldContinue(); )
+	{
+		for (uint32_t i = 0; i < bm.N; i++)
+		{
+			Oracle oracle;
+			p.Generate(seed, oracle);
+		}
+	}
+
+	{
+		Oracle oracle;
+		p.Generate(seed, oracle); // in case the above was filtered out
+	}
+
+	// single proof, the list commitments multiplication included
+	InnerProduct::BatchContextEx<1> bc;
+	std::vector<Scalar::Native> vKs(N);
+	bool bValid = true;
+
+	for (Meter bm(sPrefix + ".Verify"); bm.ShouldContinue(); )
+	{
+		for (uint32_t i = 0; i < bm.N; i++)
+		{
+			memset0(&vKs.front(), sizeof(Scalar::Native) * vKs.size());
+
+			Oracle oracle;
+			if (!proof.IsValid(bc, oracle, &vKs.front()))
+				bValid = false;
+
+			lst.Calculate(bc.m_Sum, 0, N, &vKs.front());
+
+			if (!bc.Flush())
+				bValid = false;
+		}
+	}
+
+	CheckResult(bValid, "Lelantus");
+}
+
+void BenchHash()
+{
+	Hash::Value hv;
+	uint8_t pBuf[0x400];
+	GenRandom(pBuf, sizeof(pBuf));
+
+	for (Meter bm("Hash.64B"); bm.ShouldContinue(); )
+	{
+		for (uint32_t i = 0; i < bm.N; i++)
+			Hash::Processor() << beam::Blob(pBuf, 64) >> hv;
+	}
+
+	for (Meter bm("Hash.1K"); bm.ShouldContinue(); )
+	{
+		for (uint32_t i = 0; i < bm.N; i++)
+			Hash::Processor() << beam::Blob(pBuf, sizeof(pBuf)) >> hv;
+	}
+}
+
+void BenchKdf()
+{
+	Hash::Value hv;
+	GenRandom(hv);
+
+	HKdf::Ptr pKdf;
+	HKdf::Create(pKdf, hv);
+
+	Scalar::Native sk;
+	Point::Native pt;
+
+	for (Meter bm("HKdf.DeriveKey"); bm.ShouldContinue(); )
+	{
+		for (uint32_t i = 0; i < bm.N; i++)
+		{
+			hv.Inc();
+			pKdf->DeriveKey(sk, hv);
+		}
+	}
+
+	for (Meter bm("HKdf.DerivePKeyG"); bm.ShouldContinue(); )
+	{
+		for (uint32_t i = 0; i < bm.N; i++)
+		{
+			hv.Inc();
+			pKdf->DerivePKeyG(pt, hv);
+		}
+	}
+}
+
+void BenchAes()
+{
+	Hash::Value hv;
+	GenRandom(hv);
+
+	AES::Encoder enc;
+
+	for (Meter bm("AES.Init"); bm.ShouldContinue(); )
+	{
+		for (uint32_t i = 0; i < bm.N; i++)
+			enc.Init(hv.m_pData);
+	}
+
+	enc.Init(hv.m_pData);
+	AES::StreamCipher asc;
+	asc.Reset();
+
+	uint8_t pBuf[0x400];
+	GenRandom(pBuf, sizeof(pBuf));
+
+	for (Meter bm("AES.XCrypt.1K"); bm.ShouldContinue(); )
+	{
+		for (uint32_t i = 0; i < bm.N; i++)
+			asc.XCrypt(enc, pBuf, sizeof(pBuf));
+	}
+}
+
+void RunAll()
+{
+	BenchMultiMac();
+	BenchBulletproof();
+
+	BenchLelantus(4, 3);
+	BenchLelantus(4, 5);
+	BenchLelantus(4, 6);
+	BenchLelantus(4, 8); // the shielded pool config
+
+	BenchHash();
+	BenchKdf();
+	BenchAes();
+}
+
+bool LoadBaseline(const char* szPath, std::map<std::string, double>& res)
+{
+	std::ifstream fs(szPath);
+	if (!fs)
+		return false;
+
+	std::string sLine;
+	while (std::getline(fs, sLine))
+	{
+		size_t n = sLine.find(',');
+		if (std::string::npos == n)
+			continue;
+
+		res[sLine.substr(0, n)] = atof(sLine.c_str() + n + 1);
+	}
+
+	return true;
+}
+
+uint32_t CompareBaseline(const std::map<std::string, double>& mapBase, double fTolerance)
+{
+	uint32_t nRegressions = 0;
+
+	for (const auto& r : g_vResults)
+	{
+		auto it = mapBase.find(r.m_sName);
+		if ((mapBase.end() == it) || (it->second <= 0.))
+			continue;
+
+		double fRatio = r.m_us / it->second;
+		if (fRatio > 1. + fTolerance)
+		{
+			fprintf(stderr, "Regression: %s %.3f -> %.3f us (+%.1f%%)\n", r.m_sName.c_str(), it->second, r.m_us, (fRatio - 1.) * 100.);
+			nRegressions++;
+		}
+	}
+
+	return nRegressions;
+}
+
+} // namespace ECC
+
+int main(int argc, char* argv[])
+{
+	using namespace ECC;
+
+	const char* szBaseline = nullptr;
+	double fTolerance = 0.1;
+
+	for (int i = 1; i < argc; i++)
+	{
+		const char* szArg = argv[i];
+		const char* szVal = (i + 1 < argc) ? argv[i + 1] : nullptr;
+		if (!szVal)
+		{
+			fprintf(stderr, "Missing value for %s\n", szArg);
+			return 2;
+		}
+		i++;
+
+		if (!strcmp(szArg, "--filter"))
+			g_Cfg.m_sFilter = szVal;
+		else if (!strcmp(szArg, "--time"))
+			g_Cfg.m_Time_s = atof(szVal);
+		else if (!strcmp(szArg, "--threads"))
+			g_Cfg.m_Threads = static_cast<uint32_t>(atoi(szVal));
+		else if (!strcmp(szArg, "--baseline"))
+			szBaseline = szVal;
+		else if (!strcmp(szArg, "--tolerance"))
+			fTolerance = atof(szVal) * 0.01;
+		else
+		{
+			fprintf(stderr, "Unknown option %s\n", szArg);
+			return 2;
+		}
+	}
+
+	std::map<std::string, double> mapBase;
+	if (szBaseline && !LoadBaseline(szBaseline, mapBase))
+	{
+		fprintf(stderr, "Can't read the baseline %s\n", szBaseline);
+		return 2;
+	}
+
+	printf("name,us_per_op,ops\n");
+
+	{
+		// the parallel code paths split among the threads of the Executor in scope
+		std::unique_ptr<beam::ExecutorMT_R> pEx;
+		std::unique_ptr<beam::Executor::Scope> pScope;
+		if (g_Cfg.m_Threads > 1)
+		{
+			pEx = std::make_unique<beam::ExecutorMT_R>();
+			pEx->set_Threads(g_Cfg.m_Threads);
+			pScope = std::make_unique<beam::Executor::Scope>(*pEx);
+		}
+
+		RunAll();
+	}
+
+	uint32_t nRegressions = szBaseline ? CompareBaseline(mapBase, fTolerance) : 0;
+
+	return (g_Errors || nRegressions) ? 1 : 0;
+}
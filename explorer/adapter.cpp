@@ -20,6 +20,7 @@
 #include "http/http_json_serializer.h"
 #include "utility/helpers.h"
 #include "utility/logger.h"
+#include "utility/io/asyncevent.h"
 
 #include "wallet/core/common.h"
 #include "wallet/core/common_utils.h"
@@ -229,6 +230,7 @@ public:
     }
 
     virtual ~Adapter() {
+        m_ReadPool.Stop();
         if (_nextHook) *_hook = _nextHook;
     }
 
@@ -384,13 +386,24 @@ private:
 #pragma pack (pop)
 
 
+    // treasury totals never change once calculated, keep them in memory
+    Totals m_TreasuryTotals;
+    bool m_TreasuryTotalsValid = false;
+
     void get_TreasuryTotals(Totals& ret)
     {
-        auto& db = _node.get_Processor().get_DB();
+        if (!m_TreasuryTotalsValid)
+        {
+            auto& db = _node.get_Processor().get_DB();
 
-        Blob blob(&ret, sizeof(ret));
-        if (!db.ParamGet(NodeDB::ParamID::TreasuryTotals, nullptr, &blob, nullptr))
-            CalculateTreasuryTotals(ret);
+            Blob blob(&m_TreasuryTotals, sizeof(m_TreasuryTotals));
+            if (!db.ParamGet(NodeDB::ParamID::TreasuryTotals, nullptr, &blob, nullptr))
+                CalculateTreasuryTotals(m_TreasuryTotals);
+
+            m_TreasuryTotalsValid = true;
+        }
+
+        ret = m_TreasuryTotals;
     }
 
     void CalculateTreasuryTotals(Totals& ret)
@@ -414,6 +427,9 @@ private:
 
         auto ver = s_TotalsVer; // copy value, don't use static const in the following expression (this will lead to link error on gcc)
         _node.get_Processor().get_DB().ParamSet(NodeDB::ParamID::TreasuryTotals, &ver, &blob);
+
+        m_TreasuryTotals = ret;
+        m_TreasuryTotalsValid = true;
     }
 
     void OnTotalsTxo(Totals::CountAndSize& dst, NodeDB::WalkerTxo& wlk)
@@ -559,11 +575,23 @@ private:
         if (_nextHook)
             _nextHook->OnStateChanged();
 
+        m_StateVersion++;
         EnsureHaveCumulativeStats();
+
+        if (m_pListener)
+            m_pListener->OnNewTip(_nodeBackend.m_Cursor.m_Full.m_Height);
     }
 
     void OnRolledBack(const Block::SystemState::ID& id) override {
         if (_nextHook) _nextHook->OnRolledBack(id);
+        m_StateVersion++;
+        m_mapContractBrief.clear(); // the same heights may be re-applied with different blocks
+        m_hContractBrief = 0;
+    }
+
+    Height get_HeightImmutable() override
+    {
+        return _nodeBackend.get_LowestReturnHeight();
     }
 
     struct TresEntry
@@ -733,6 +761,9 @@ private:
                 }
             }
 
+            Node::MemReport mr;
+            _node.get_MemReport(mr);
+
             char buf[80];
             json j{
                     { "timestamp", c.m_Full.m_TimeStamp },
@@ -743,7 +774,19 @@ private:
                     { "peers_count", _node.get_AcessiblePeerCount() },
                     { "shielded_outputs_total", _nodeBackend.m_Extra.m_ShieldedOutputs },
                     { "shielded_outputs_per_24h", shieldedPer24h },
-                    { "shielded_possible_ready_in_hours", shieldedPer24h ? std::to_string(possibleShieldedReadyHours) : "-" }
+                    { "shielded_possible_ready_in_hours", shieldedPer24h ? std::to_string(possibleShieldedReadyHours) : "-" },
+                    { "memory", {
+                        { "process", mr.m_Process },
+                        { "txpool", mr.m_TxPool },
+                        { "txpool_stem", mr.m_TxStem },
+                        { "txpool_dependent", mr.m_TxDependent },
+                        { "validated_cache", mr.m_ValidatedCache },
+                        { "peer_buffers", mr.m_PeerBuffers },
+                        { "mapped", mr.m_Mapped },
+                        { "db", mr.m_Db },
+                        { "bbs", mr.m_Bbs },
+                        { "shed", mr.m_Shed }
+                    }}
             };
             return j;
         }
@@ -1556,10 +1599,66 @@ private:
         }
     }
 
+    // Brief contract descriptions (parser method 1), rendered for each contract in the lists and version histories.
+    // The brief may depend on the contract state (i.e. the upgradable wrappers), so an entry is dropped once its contract is invoked.
+    // The invocations are known from the KrnInfo, recorded for each block when the rich info is on
+    struct ContractBrief
+    {
+        bvm2::ShaderID m_Sid;
+        std::string m_sRes;
+    };
+
+    std::map<bvm2::ContractID, ContractBrief> m_mapContractBrief;
+    Height m_hContractBrief = 0; // valid up to this height
+
+    void ValidateContractBriefs()
+    {
+        Height h = _nodeBackend.m_Cursor.m_Full.m_Height;
+        if (h == m_hContractBrief)
+            return;
+
+        auto& db = _nodeBackend.get_DB();
+
+        if ((h < m_hContractBrief) || (h - m_hContractBrief > 100) || !db.ParamIntGetDef(NodeDB::ParamID::RichContractInfo))
+            m_mapContractBrief.clear();
+        else
+        {
+            NodeDB::KrnInfo::Walker wlk;
+            for (db.KrnInfoEnum(wlk, HeightPos(m_hContractBrief + 1), HeightPos(h, static_cast<uint32_t>(-1))); wlk.MoveNext(); )
+                m_mapContractBrief.erase(wlk.m_Entry.m_Cid);
+        }
+
+        m_hContractBrief = h;
+    }
+
+    void get_ContractBrief(std::string& sRes, const bvm2::ShaderID& sid, const bvm2::ContractID& cid)
+    {
+        ValidateContractBriefs();
+
+        auto it = m_mapContractBrief.find(cid);
+        if ((m_mapContractBrief.end() != it) && (it->second.m_Sid == sid))
+        {
+            sRes = it->second.m_sRes;
+            return;
+        }
+
+        _nodeBackend.get_ContractDescr(sid, cid, sRes, false);
+
+        if (!_nodeBackend.get_DB().ParamIntGetDef(NodeDB::ParamID::RichContractInfo))
+            return; // can't track the changes
+
+        auto& x = m_mapContractBrief[cid];
+        x.m_Sid = sid;
+        x.m_sRes = sRes;
+    }
+
     void get_ContractDescr(ExtraInfo::Writer& wr, const bvm2::ShaderID& sid, const bvm2::ContractID& cid, bool bFullState)
     {
         std::string sExtra;
-        _nodeBackend.get_ContractDescr(sid, cid, sExtra, bFullState);
+        if (bFullState)
+            _nodeBackend.get_ContractDescr(sid, cid, sExtra, true);
+        else
+            get_ContractBrief(sExtra, sid, cid);
 
         wr.ParseSafe(sExtra);
 
@@ -2015,11 +2114,11 @@ private:
 
     json get_asset_history(Asset::ID aid, Height hMin, Height hMax, uint32_t nMaxOps)
     {
+        nMaxOps = std::min(nMaxOps, 2000u); // must be capped before walking, otherwise the whole asset history is read
+
         AssetHistoryWalker wlk;
         wlk.Enum(_nodeBackend, aid, hMin, hMax, nMaxOps);
 
-        nMaxOps = std::min(nMaxOps, 2000u);
-
         ExtraInfo::Writer wrArr(json::array());
         wrArr.m_json.push_back(json::array({
             MakeTableHdr("Height"),
@@ -2369,12 +2468,55 @@ private:
         void OnData_SizeCompressed_Rel() { m_json.push_back(m_This.MakeDecimalDelta(m_pThis->get_ChainSize(false) - m_pPrev->get_ChainSize(false)).m_sz); }
     };
 
+    struct HdrsRequest
+    {
+        Height m_hMax;
+        uint64_t m_nMax;
+        uint64_t m_dh;
+        std::vector<TotalsCol> m_vCols;
+        Totals m_TreasuryTotals;
+    };
+
+    // reactor thread: caps the range w.r.t. the current tip, and prepares the data that isn't read from the DB
+    void PrepareHdrsRequest(HdrsRequest& r, uint64_t hMax, uint64_t nMax, uint64_t dh, const TotalsCol* pCols, uint32_t nCols)
+    {
+        r.m_hMax = std::min<Height>(hMax, _nodeBackend.m_Cursor.m_Full.m_Height);
+        r.m_nMax = std::min<uint64_t>(nMax, 2048u);
+        r.m_dh = std::max<uint64_t>(dh, 1u);
+        r.m_vCols.assign(pCols, pCols + nCols);
+
+        get_TreasuryTotals(r.m_TreasuryTotals);
+        get_TimeStampGenesis(); // cached, won't touch the node state during the request
+    }
+
     json get_hdrs(uint64_t hMax, uint64_t nMax, uint64_t dh, const TotalsCol* pCols, uint32_t nCols) override
     {
-        std::setmin(nMax, 2048u);
-        std::setmin(hMax, _nodeBackend.m_Cursor.m_Full.m_Height);
+        HdrsRequest r;
+        PrepareHdrsRequest(r, hMax, nMax, dh, pCols, nCols);
+        return get_hdrs_Internal(_nodeBackend.get_DB(), r);
+    }
 
-        std::setmax(dh, 1u);
+    // may run on a worker thread, accesses the node state via the given DB only
+    json get_hdrs_Internal(NodeDB& db, const HdrsRequest& r)
+    {
+        Height hMax = r.m_hMax;
+        uint64_t nMax = r.m_nMax;
+        uint64_t dh = r.m_dh;
+        const TotalsCol* pCols = r.m_vCols.empty() ? nullptr : &r.m_vCols.front();
+        uint32_t nCols = static_cast<uint32_t>(r.m_vCols.size());
+
+        // Totals in the state extra are cumulative, so each row costs a single lookup regardless of dh
+        auto fnRead = [&db, &r](ColFmt::Data& d, const NodeDB::StateID& sid)
+        {
+            if (sid.m_Height >= Rules::HeightGenesis)
+                db.get_StateWithExtra(sid.m_Row, d.m_Hdr, static_cast<StateData*>(&d), sizeof(StateData));
+            else
+            {
+                ZeroObject(d.m_Hdr);
+                ZeroObject(static_cast<StateData&>(d));
+                d.m_Totals = r.m_TreasuryTotals;
+            }
+        };
 
         json jRet = json::array();
 
@@ -2403,8 +2545,6 @@ private:
 
         if (hMax && nMax)
         {
-            auto& db = _nodeBackend.get_DB();
-
             ColFmt::Data pData[2];
             uint32_t iIdxData = 0;
 
@@ -2412,8 +2552,7 @@ private:
             sid.m_Height = hMax;
             sid.m_Row = db.FindActiveStateStrict(hMax);
 
-            get_StateTotals(pData[iIdxData], sid);
-            db.get_State(sid.m_Row, pData[iIdxData].m_Hdr);
+            fnRead(pData[iIdxData], sid);
 
             while (true)
             {
@@ -2434,16 +2573,11 @@ private:
                         sid.m_Height -= dh;
                         sid.m_Row = db.FindActiveStateStrict(sid.m_Height);
                     }
-
-                    db.get_State(sid.m_Row, d0.m_Hdr);
                 }
                 else
-                {
                     ZeroObject(sid);
-                    ZeroObject(d0.m_Hdr);
-                }
 
-                get_StateTotals(d0, sid);
+                fnRead(d0, sid);
 
                 for (uint32_t iCol = 0; iCol < nCols; iCol++)
                 {
@@ -2817,6 +2951,60 @@ private:
         return result;
     }
 
+    json get_perf() override
+    {
+        typedef NodeProcessor::PerfStats PerfStats;
+        const PerfStats& ps = _nodeBackend.m_PerfStats;
+
+        json result = json::object();
+
+        for (uint32_t i = 0; i < PerfStats::Stage::count; i++)
+        {
+            auto eStage = static_cast<PerfStats::Stage::Enum>(i);
+            const PerfStats::Counter& c = ps.m_p[i];
+
+            uint64_t nCount = c.m_Count;
+            uint64_t nTotal_us = c.m_Total_us;
+
+            // log2 histogram, bucket i stands for [2^i, 2^(i+1)) us. Trailing empty buckets are omitted
+            json jHist = json::array();
+            uint32_t nBuckets = PerfStats::Counter::s_Buckets;
+            while (nBuckets && !c.m_pHist[nBuckets - 1])
+                nBuckets--;
+            for (uint32_t iBucket = 0; iBucket < nBuckets; iBucket++)
+                jHist.push_back(c.m_pHist[iBucket].load());
+
+            result[PerfStats::Stage::get_Name(eStage)] = json{
+                { "count", nCount },
+                { "total_us", nTotal_us },
+                { "avg_us", nCount ? (nTotal_us / nCount) : 0 },
+                { "max_us", c.m_Max_us.load() },
+                { "hist_log2_us", std::move(jHist) }
+            };
+        }
+
+        const PerfStats::Contracts& pc = ps.m_Contracts;
+        uint64_t nWaves = pc.m_Waves;
+        result["contracts"] = json{
+            { "blocks", pc.m_Blocks.load() },
+            { "kernels", pc.m_Kernels.load() },
+            { "waves", nWaves },
+            { "parallelism_pct", nWaves ? (pc.m_Kernels * 100 / nWaves) : 0 }
+        };
+
+        io::BufferPoolStats bps = io::get_buffer_pool_stats();
+        uint64_t nPooled = bps.hits + bps.misses;
+        result["buffer_pool"] = json{
+            { "hits", bps.hits },
+            { "misses", bps.misses },
+            { "unpooled", bps.unpooled },
+            { "dropped", bps.dropped },
+            { "hit_rate_pct", nPooled ? (bps.hits * 100 / nPooled) : 0 }
+        };
+
+        return result;
+    }
+
 #ifdef BEAM_ATOMIC_SWAP_SUPPORT
     json get_swap_offers() override
     {
@@ -2918,6 +3106,157 @@ private:
     }
 #endif  // BEAM_ATOMIC_SWAP_SUPPORT
 
+    struct ReadPool
+        :public ExecutorMT_R
+    {
+        struct Job
+        {
+            typedef std::unique_ptr<Job> Ptr;
+
+            AsyncResult::Ptr m_pRes;
+            bool m_bFailed = false;
+
+            virtual ~Job() = default;
+            virtual json Exec(NodeDB&) = 0;
+        };
+
+        struct MyContext
+            :public Executor::Context
+        {
+            NodeDB m_DB;
+        };
+
+        struct Task
+            :public Executor::TaskAsync
+        {
+            ReadPool* m_pThis;
+            Job::Ptr m_pJob;
+
+            void Exec(Executor::Context& ctx) override
+            {
+                NodeDB& db = static_cast<MyContext&>(ctx).m_DB;
+                m_pJob->m_bFailed = true;
+
+                if (db.IsOpen())
+                {
+                    try {
+                        m_pJob->m_pRes->m_Json = m_pJob->Exec(db);
+                        m_pJob->m_bFailed = false;
+                    } catch (const std::exception& e) {
+                        BEAM_LOG_DEBUG() << "Explorer read query failed: " << e.what(); // i.e. the read connection lags behind the tip
+                    }
+                }
+
+                {
+                    std::unique_lock<std::mutex> scope(m_pThis->m_Mutex);
+                    m_pThis->m_vDone.push_back(std::move(m_pJob));
+                }
+
+                m_pThis->m_pEvtDone->post();
+            }
+        };
+
+        std::string m_sPath;
+        uint32_t m_nThreads = 0;
+        std::mutex m_Mutex;
+        std::vector<Job::Ptr> m_vDone; // protected by m_Mutex
+        io::AsyncEvent::Ptr m_pEvtDone;
+
+        void RunThread(uint32_t iThread) override
+        {
+            MyContext ctx;
+            ctx.m_iThread = iThread;
+
+            try {
+                ctx.m_DB.OpenReadOnly(m_sPath.c_str());
+            } catch (const std::exception& e) {
+                BEAM_LOG_WARNING() << "Explorer read DB connection failed: " << e.what(); // the jobs will fall back to the reactor thread
+                ctx.m_DB.Close();
+            }
+
+            RunThreadCtx(ctx);
+        }
+
+        ~ReadPool() { Stop(); }
+
+        IMPLEMENT_GET_PARENT_OBJ(Adapter, m_ReadPool)
+
+        void Post(Job::Ptr&& pJob)
+        {
+            if (!m_pEvtDone)
+                m_pEvtDone = io::AsyncEvent::create(io::Reactor::get_Current(), [this]() { OnDone(); });
+
+            auto pTask = std::make_unique<Task>();
+            pTask->m_pThis = this;
+            pTask->m_pJob = std::move(pJob);
+            Push(std::move(pTask));
+        }
+
+        void OnDone()
+        {
+            std::vector<Job::Ptr> v;
+            {
+                std::unique_lock<std::mutex> scope(m_Mutex);
+                v.swap(m_vDone);
+            }
+
+            for (auto& pJob : v)
+            {
+                auto& res = *pJob->m_pRes;
+                if (pJob->m_bFailed)
+                {
+                    // retry on the main DB connection
+                    try {
+                        res.m_Json = pJob->Exec(get_ParentObj()._nodeBackend.get_DB());
+                    } catch (const std::exception& e) {
+                        res.m_sErr = e.what();
+                    }
+                }
+
+                res.OnDone();
+            }
+        }
+
+    } m_ReadPool;
+
+    struct HdrsJob
+        :public ReadPool::Job
+    {
+        Adapter& m_This;
+        HdrsRequest m_Req;
+
+        HdrsJob(Adapter& x) :m_This(x) {}
+
+        json Exec(NodeDB& db) override
+        {
+            return m_This.get_hdrs_Internal(db, m_Req);
+        }
+    };
+
+    void set_ReadThreads(uint32_t nThreads) override
+    {
+        m_ReadPool.m_nThreads = nThreads;
+        if (nThreads)
+        {
+            m_ReadPool.m_sPath = _node.m_Cfg.m_sPathLocal;
+            m_ReadPool.set_Threads(nThreads);
+            _node.m_Cfg.m_ProcessorParams.m_SharedDB = true; // WAL mode, allows concurrent read-only connections
+        }
+    }
+
+    bool get_hdrs_async(const AsyncResult::Ptr& pRes, uint64_t hMax, uint64_t nMax, uint64_t dh, const TotalsCol* pCols, uint32_t nCols) override
+    {
+        if (!m_ReadPool.m_nThreads)
+            return false;
+
+        auto pJob = std::make_unique<HdrsJob>(*this);
+        PrepareHdrsRequest(pJob->m_Req, hMax, nMax, dh, pCols, nCols);
+        pJob->m_pRes = pRes;
+
+        m_ReadPool.Post(std::move(pJob));
+        return true;
+    }
+
     HttpMsgCreator _packer;
 
     // node db interface
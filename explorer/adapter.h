@@ -59,12 +59,20 @@ struct IAdapter {
     };
 
     Mode m_Mode = Mode::Legacy;
+    uint64_t m_StateVersion = 0; // incremented on each tip change
+
+    struct IListener {
+        virtual void OnNewTip(Height) = 0; // reactor thread, after the tip has changed (incl. rollbacks) and the totals are updated
+    };
+
+    IListener* m_pListener = nullptr;
 
     using Ptr = std::unique_ptr<IAdapter>;
 
     virtual ~IAdapter() = default;
 
     virtual void Initialize() = 0; // call after node init
+    virtual Height get_HeightImmutable() = 0; // blocks below can't be rolled back
 
     /// Returns body for /status request
     virtual json get_status() = 0;
@@ -72,7 +80,24 @@ struct IAdapter {
     virtual json get_block_by_kernel(const Blob& key) = 0;
     virtual json get_blocks(uint64_t startHeight, uint64_t n) = 0;
     virtual json get_hdrs(uint64_t hMax, uint64_t nMax, uint64_t dh, const TotalsCol* pCols, uint32_t nCols) = 0;
+
+    // Requests that depend on the committed DB state only may be served by the worker threads, each with its own read-only DB connection
+    struct AsyncResult
+    {
+        typedef std::shared_ptr<AsyncResult> Ptr;
+
+        json m_Json;
+        std::string m_sErr; // set on failure
+
+        virtual ~AsyncResult() = default;
+        virtual void OnDone() = 0; // reactor thread
+    };
+
+    virtual void set_ReadThreads(uint32_t) = 0; // call before node init. 0 = no workers
+    // returns false if there are no workers, then the request should be served synchronously
+    virtual bool get_hdrs_async(const AsyncResult::Ptr&, uint64_t hMax, uint64_t nMax, uint64_t dh, const TotalsCol* pCols, uint32_t nCols) = 0;
     virtual json get_peers() = 0;
+    virtual json get_perf() = 0;
 
 #ifdef BEAM_ATOMIC_SWAP_SUPPORT
     virtual json get_swap_offers() = 0;
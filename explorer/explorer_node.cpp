@@ -1,5 +1,6 @@
 #include "server.h"
 #include "adapter.h"
+#include "push_server.h"
 #include "wallet/core/secstring.h"
 #include "core/ecc_native.h"
 #include "core/block_rw.h"
@@ -23,6 +24,14 @@ using namespace std;
 #define LOG_FILES_DIR "logs"
 #define FILES_PREFIX "explorer-node"
 #define API_PORT_PARAMETER "api_port"
+#define CACHE_IMMUTABLE_PARAMETER "response_cache_immutable_mb"
+#define CACHE_TIP_PARAMETER "response_cache_tip_mb"
+#define READ_THREADS_PARAMETER "explorer_read_threads"
+#define PUSH_PORT_PARAMETER "push_ws_port"
+#define IDLE_TIMEOUT_PARAMETER "connection_idle_timeout_s"
+#define MAX_CONN_PER_IP_PARAMETER "max_connections_per_ip"
+#define RATE_LIMIT_PARAMETER "rate_limit_ms"
+#define RATE_BURST_PARAMETER "rate_burst_ms"
 
 struct Options {
     std::string nodeDbFilename;
@@ -38,6 +47,14 @@ struct Options {
     ByteBuffer m_RichParser;
     bool m_RichParserChanged = false;
     bool m_LogTrafic = false;
+    uint32_t m_CacheImmutable_MB;
+    uint32_t m_CacheTip_MB;
+    uint32_t m_ReadThreads;
+    uint16_t m_PushPort;
+    uint32_t m_IdleTimeout_s;
+    uint32_t m_MaxConnPerIp;
+    uint32_t m_RateLimit_ms;
+    uint32_t m_RateBurst_ms;
 };
 
 static bool parse_cmdline(int argc, char* argv[], Options& o);
@@ -57,7 +74,8 @@ int main(int argc, char* argv[]) {
 
     int retCode = 0;
     try {
-        io::Reactor::Ptr reactor = io::Reactor::create();
+        SafeReactor::Ptr safeReactor = SafeReactor::create();
+        io::Reactor::Ptr reactor = safeReactor->ptr();
         io::Reactor::Scope scope(*reactor);
         io::Reactor::GracefulIntHandler gih(*reactor);
         io::Timer::Ptr logRotateTimer = io::Timer::create(*reactor);
@@ -67,9 +85,22 @@ int main(int argc, char* argv[]) {
         Node node;
         setup_node(node, options);
         explorer::IAdapter::Ptr adapter = explorer::create_adapter(node);
+        adapter->set_ReadThreads(options.m_ReadThreads);
         node.Initialize();
         adapter->Initialize();
         explorer::Server server(*adapter, *reactor, options.explorerListenTo, options.accessControlFile, options.whitelist);
+        server.set_cache_size(static_cast<uint64_t>(options.m_CacheImmutable_MB) << 20, static_cast<uint64_t>(options.m_CacheTip_MB) << 20);
+        server.set_connection_limits(options.m_IdleTimeout_s, options.m_MaxConnPerIp);
+        server.set_rate_limit(options.m_RateLimit_ms, options.m_RateBurst_ms);
+
+        std::unique_ptr<explorer::PushServer> pushServer;
+        if (options.m_PushPort)
+        {
+            WebSocketServer::Options wsOptions;
+            wsOptions.port = options.m_PushPort;
+            pushServer = std::make_unique<explorer::PushServer>(*adapter, safeReactor, wsOptions);
+        }
+
         BEAM_LOG_INFO() << "Node listens to " << options.nodeListenTo << ", explorer listens to " << options.explorerListenTo;
         reactor->run();
         BEAM_LOG_INFO() << "Done";
@@ -104,6 +135,14 @@ bool parse_cmdline(int argc, char* argv[], Options& o) {
         (cli::CONFIG_FILE_PATH, po::value<std::string>()->default_value("explorer-node.cfg"), "path to the config file")
         (cli::CONTRACT_RICH_PARSER, po::value<std::string>(), "Optional shader to parse contract invocation info")
         (g_szTraficLog, po::value<bool>()->default_value(false), "Log trafic")
+        (CACHE_IMMUTABLE_PARAMETER, po::value<uint32_t>()->default_value(64), "response cache for the blocks below the rollback horizon, MB")
+        (CACHE_TIP_PARAMETER, po::value<uint32_t>()->default_value(16), "response cache for the current tip, MB")
+        (READ_THREADS_PARAMETER, po::value<uint32_t>()->default_value(2), "number of threads serving heavy explorer requests from the DB, off the node thread (0 = node thread)")
+        (PUSH_PORT_PARAMETER, po::value<uint16_t>()->default_value(0), "port for the websocket push of new blocks and status (0 = disabled)")
+        (IDLE_TIMEOUT_PARAMETER, po::value<uint32_t>()->default_value(60), "keep-alive connections without requests are closed after this period, seconds")
+        (MAX_CONN_PER_IP_PARAMETER, po::value<uint32_t>()->default_value(0), "max simultaneous connections from a single IP (0 = unlimited, i.e. behind a load balancer)")
+        (RATE_LIMIT_PARAMETER, po::value<uint32_t>()->default_value(0), "server time per second a single IP may consume, ms. Requests are weighted by their measured cost (0 = unlimited)")
+        (RATE_BURST_PARAMETER, po::value<uint32_t>()->default_value(5000), "server time a single IP may consume in a burst, ms")
     ;
 
     cliOptions.add(createRulesOptionsDescription());
@@ -184,6 +223,14 @@ bool parse_cmdline(int argc, char* argv[], Options& o) {
         }
 
         o.m_LogTrafic = vm[g_szTraficLog].as<bool>();
+        o.m_CacheImmutable_MB = vm[CACHE_IMMUTABLE_PARAMETER].as<uint32_t>();
+        o.m_CacheTip_MB = vm[CACHE_TIP_PARAMETER].as<uint32_t>();
+        o.m_ReadThreads = vm[READ_THREADS_PARAMETER].as<uint32_t>();
+        o.m_PushPort = vm[PUSH_PORT_PARAMETER].as<uint16_t>();
+        o.m_IdleTimeout_s = vm[IDLE_TIMEOUT_PARAMETER].as<uint32_t>();
+        o.m_MaxConnPerIp = vm[MAX_CONN_PER_IP_PARAMETER].as<uint32_t>();
+        o.m_RateLimit_ms = vm[RATE_LIMIT_PARAMETER].as<uint32_t>();
+        o.m_RateBurst_ms = vm[RATE_BURST_PARAMETER].as<uint32_t>();
 
 #ifdef WIN32
         WSADATA wsaData = { };
@@ -0,0 +1,148 @@
+// Copyright 2018 The Beam Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "push_server.h"
+#include "utility/logger.h"
+
+namespace beam { namespace explorer {
+
+namespace {
+
+#define STS "Explorer push: "
+
+static const Height MAX_BLOCKS_PER_PUSH = 16; // on bigger jumps (i.e. sync) only the most recent blocks are pushed
+
+} //namespace
+
+PushServer::PushServer(IAdapter& adapter, SafeReactor::Ptr reactor, const Options& options) :
+    WebSocketServer(std::move(reactor), options),
+    _backend(adapter)
+{
+    assert(!_backend.m_pListener);
+    _backend.m_pListener = this;
+}
+
+PushServer::~PushServer() {
+    _backend.m_pListener = nullptr;
+}
+
+WebSocketServer::ClientHandler::Ptr PushServer::ReactorThread_onNewWSClient(SendFunc send, CloseFunc close) {
+    auto pClient = std::make_shared<Client>(*this, std::move(send), std::move(close));
+
+    // cleanup the gone ones
+    for (size_t i = 0; i < _clients.size(); ) {
+        if (_clients[i].expired()) {
+            _clients[i] = std::move(_clients.back());
+            _clients.pop_back();
+        } else {
+            i++;
+        }
+    }
+
+    _clients.push_back(pClient);
+    return pClient;
+}
+
+void PushServer::Client::ReactorThread_onWSDataReceived(std::string&& data) {
+    uint32_t topicsPrev = _topics;
+
+    try {
+        auto j = nlohmann::json::parse(data);
+
+        for (int iSub = 0; iSub < 2; iSub++) {
+            auto it = j.find(iSub ? "subscribe" : "unsubscribe");
+            if (j.end() == it)
+                continue;
+
+            for (const auto& jTopic : *it) {
+                const auto& s = jTopic.get<std::string>();
+
+                uint32_t msk = 0;
+                if (s == "status")
+                    msk = Topic::Status;
+                else if (s == "blocks")
+                    msk = Topic::Blocks;
+                else
+                    throw std::runtime_error("unknown topic " + s);
+
+                if (iSub)
+                    _topics |= msk;
+                else
+                    _topics &= ~msk;
+            }
+        }
+    } catch (const std::exception& e) {
+        BEAM_LOG_WARNING() << STS << "bad request: " << e.what();
+        _close("bad request");
+        return;
+    }
+
+    if ((_topics & ~topicsPrev) & Topic::Status) {
+        // don't wait for the next block
+        send(make_msg("status", _this._backend.get_status()));
+    }
+}
+
+void PushServer::Client::send(const std::string& msg) {
+    std::string s(msg);
+    _send(std::move(s));
+}
+
+std::string PushServer::make_msg(const char* szType, nlohmann::json&& jData) {
+    nlohmann::json j{
+        { "type", szType },
+        { "data", std::move(jData) }
+    };
+    return j.dump();
+}
+
+void PushServer::broadcast(Topic t, const std::string& msg) {
+    for (const auto& wp : _clients) {
+        auto pClient = wp.lock();
+        if (pClient && (pClient->_topics & t))
+            pClient->send(msg);
+    }
+}
+
+void PushServer::OnNewTip(Height h) {
+    uint32_t topics = 0;
+    for (const auto& wp : _clients) {
+        auto pClient = wp.lock();
+        if (pClient)
+            topics |= pClient->_topics;
+    }
+
+    // the block range is tracked even if no one listens, so that a new subscriber won't receive the backlog
+    Height h0 = (h > _hLastPushed) ? _hLastPushed : (h ? h - 1 : 0); // on rollback the new tip replaces the old one
+    _hLastPushed = h;
+
+    try {
+        if (Topic::Blocks & topics) {
+            if (h - h0 > MAX_BLOCKS_PER_PUSH)
+                h0 = h - MAX_BLOCKS_PER_PUSH;
+
+            // the response is built once and shared by all the subscribers
+            for (Height hBlock = h0 + 1; hBlock <= h; hBlock++)
+                broadcast(Topic::Blocks, make_msg("block", _backend.get_block(hBlock)));
+        }
+
+        if (Topic::Status & topics)
+            broadcast(Topic::Status, make_msg("status", _backend.get_status()));
+
+    } catch (const std::exception& e) {
+        BEAM_LOG_WARNING() << STS << "push failed: " << e.what();
+    }
+}
+
+}} //namespaces
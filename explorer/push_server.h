@@ -0,0 +1,71 @@
+// Copyright 2018 The Beam Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include "adapter.h"
+#include "websocket/websocket_server.h"
+#include <vector>
+
+namespace beam { namespace explorer {
+
+// WebSocket endpoint that pushes the explorer state to the subscribed clients, instead of them polling /status and /blocks.
+// Client -> server: {"subscribe":["status","blocks"]}, {"unsubscribe":[...]}
+// Server -> client: {"type":"status","data":{...}} on each tip change, {"type":"block","data":{...}} for each new block
+class PushServer
+    :public WebSocketServer
+    ,private IAdapter::IListener
+{
+public:
+    PushServer(IAdapter& adapter, SafeReactor::Ptr reactor, const Options& options);
+    ~PushServer();
+
+private:
+    enum Topic : uint32_t {
+        Status = 1,
+        Blocks = 2,
+    };
+
+    struct Client
+        :public ClientHandler
+    {
+        PushServer& _this;
+        SendFunc _send;
+        CloseFunc _close;
+        uint32_t _topics = 0;
+
+        Client(PushServer& x, SendFunc&& send, CloseFunc&& close)
+            :_this(x)
+            ,_send(std::move(send))
+            ,_close(std::move(close))
+        {}
+
+        void ReactorThread_onWSDataReceived(std::string&&) override;
+        void send(const std::string&);
+    };
+
+    ClientHandler::Ptr ReactorThread_onNewWSClient(SendFunc, CloseFunc) override;
+
+    // IAdapter::IListener
+    void OnNewTip(Height) override;
+
+    void broadcast(Topic, const std::string&);
+    static std::string make_msg(const char* szType, nlohmann::json&&);
+
+    IAdapter& _backend;
+    std::vector<std::weak_ptr<Client> > _clients; // owned by the sessions, may be destroyed on the websocket thread
+    Height _hLastPushed = 0;
+};
+
+}} //namespaces
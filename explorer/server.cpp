@@ -17,7 +17,10 @@
 #include "utility/logger.h"
 #include <boost/filesystem.hpp>
 #include <boost/algorithm/string/trim.hpp>
+#include <boost/algorithm/string/predicate.hpp>
 #include <fstream>
+#include <deque>
+#include <chrono>
 #include "../core/ecc.h"
 #include "../core/block_crypt.h"
 
@@ -29,8 +32,21 @@ namespace {
 
 static const uint64_t SERVER_RESTART_TIMER = 1;
 static const uint64_t ACL_REFRESH_TIMER = 2;
+static const uint64_t IDLE_CHECK_TIMER = 3;
 static const unsigned SERVER_RESTART_INTERVAL = 1000;
 static const unsigned ACL_REFRESH_INTERVAL = 5555;
+static const uint64_t CACHE_IMMUTABLE_SIZE = 64 * 1024 * 1024;
+static const uint64_t CACHE_TIP_SIZE = 16 * 1024 * 1024;
+static const size_t MAX_DEFERRED_REQUESTS = 16; // pipelined while an async request is in progress
+static const uint32_t IDLE_TIMEOUT_S = 60;
+static const unsigned IDLE_CHECK_INTERVAL = 5000;
+static const size_t GZIP_MIN_SIZE = 1024; // smaller responses are sent as-is
+static const uint64_t REQUEST_BASE_COST_US = 200; // charged on top of the measured time, so that cached responses aren't free
+
+uint64_t get_time_us()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
 
 } //namespace
 
@@ -45,6 +61,54 @@ Server::Server(IAdapter& adapter, io::Reactor& reactor, io::Address bindAddress,
 {
     _timers.set_timer(SERVER_RESTART_TIMER, 0, BIND_THIS_MEMFN(start_server));
     _timers.set_timer(ACL_REFRESH_TIMER, ACL_REFRESH_INTERVAL, BIND_THIS_MEMFN(refresh_acl));
+    set_cache_size(CACHE_IMMUTABLE_SIZE, CACHE_TIP_SIZE);
+    set_connection_limits(IDLE_TIMEOUT_S, 0);
+    _timers.set_timer(IDLE_CHECK_TIMER, IDLE_CHECK_INTERVAL, BIND_THIS_MEMFN(check_idle));
+}
+
+void Server::set_connection_limits(uint32_t idleTimeout_s, uint32_t maxPerIp) {
+    m_ConnStats.m_IdleTimeout_ms = idleTimeout_s * 1000;
+    m_ConnStats.m_MaxPerIp = maxPerIp;
+}
+
+void Server::set_rate_limit(uint32_t rate_ms, uint32_t burst_ms) {
+    _acl.set_rate_limit(rate_ms, burst_ms);
+}
+
+void Server::charge_request(uint64_t id, int dir, uint64_t tStart_us) {
+    uint64_t dt_us = get_time_us() - tStart_us;
+
+    auto& avg = m_pDirCost_us[dir];
+    avg = (avg * 7 + dt_us) / 8;
+
+    _acl.charge(io::Address::from_u64(id), dt_us + REQUEST_BASE_COST_US);
+}
+
+void Server::check_idle() {
+    uint64_t now_ms = local_timestamp_msec();
+
+    std::vector<uint64_t> vIdle;
+    for (const auto& x : m_ConnStats.m_LastActive_ms) {
+        if ((now_ms - x.second > m_ConnStats.m_IdleTimeout_ms) && (m_AsyncPending.end() == m_AsyncPending.find(x.first)))
+            vIdle.push_back(x.first);
+    }
+
+    for (auto id : vIdle) {
+        BEAM_LOG_DEBUG() << STS << "-peer " << io::Address::from_u64(id) << " : idle";
+        auto it = _connections.find(id);
+        if (_connections.end() != it)
+            it->second->shutdown();
+        drop_connection(id);
+    }
+
+    _timers.set_timer(IDLE_CHECK_TIMER, IDLE_CHECK_INTERVAL, BIND_THIS_MEMFN(check_idle));
+}
+
+void Server::set_cache_size(uint64_t immutableSize, uint64_t tipSize) {
+    m_Cache.m_Immutable.m_SizeMax = immutableSize;
+    m_Cache.m_Immutable.ShrinkTo(immutableSize);
+    m_Cache.m_Tip.m_SizeMax = tipSize;
+    m_Cache.m_Tip.ShrinkTo(tipSize);
 }
 
 void Server::start_server() {
@@ -63,6 +127,7 @@ void Server::start_server() {
 
 void Server::refresh_acl() {
     _acl.refresh();
+    _acl.purge();
     _timers.set_timer(ACL_REFRESH_TIMER, ACL_REFRESH_INTERVAL, BIND_THIS_MEMFN(refresh_acl));
 }
 
@@ -80,6 +145,18 @@ void Server::on_stream_accepted(io::TcpStream::Ptr&& newStream, io::ErrorCode er
             }
         }
 
+        if (m_ConnStats.m_MaxPerIp && (m_ConnStats.m_PerIp[peer.ip()] >= m_ConnStats.m_MaxPerIp))
+        {
+            BEAM_LOG_DEBUG() << STS << peer << " too many connections, closing";
+            return;
+        }
+
+        if (_connections.end() != _connections.find(peer.u64()))
+            drop_connection(peer.u64()); // stale
+
+        m_ConnStats.m_PerIp[peer.ip()]++;
+        m_ConnStats.m_LastActive_ms[peer.u64()] = local_timestamp_msec();
+
         newStream->enable_keepalive(1);
         BEAM_LOG_DEBUG() << STS << "+peer " << peer;
         _connections[peer.u64()] = std::make_unique<HttpConnection>(
@@ -102,15 +179,12 @@ void Server::on_stream_accepted(io::TcpStream::Ptr&& newStream, io::ErrorCode er
 
 void json2Msg(const json& obj, io::SerializedMsg& out)
 {
-
-    io::SerializedMsg sm;
-    io::SharedBuffer body;
+    // serialized directly into the send fragments, they're written to the socket (and kept in the cache) as-is.
+    // Don't normalize: for big responses this would allocate and copy the whole body once more
     HttpMsgCreator packer(4096);
 
-    if (!serialize_json_msg(sm, packer, obj))
+    if (!serialize_json_msg(out, packer, obj))
         Exc::Fail("couldn't serialized");
-
-    out.push_back(io::normalize(sm, false));
 }
 
 struct HtmlConverter
@@ -553,6 +627,153 @@ void jsonExp(json& obj, uint32_t nDepth)
 }
 
 
+void make_body(json& j, IAdapter::Mode mode, const std::string& path, io::SerializedMsg& out)
+{
+    switch (mode)
+    {
+    case IAdapter::Mode::AutoHtml:
+        {
+            HtmlConverter cvt(path);
+            cvt.Convert(j);
+            cvt.get_Res(out);
+        }
+        break;
+
+    case IAdapter::Mode::ExplicitType:
+        jsonExp(j, 0);
+        // no break;
+
+    default:
+        json2Msg(j, out);
+    }
+}
+
+struct HdrsArgs
+{
+    Height m_hMax;
+    uint32_t m_nMax;
+    Height m_dh;
+    IAdapter::TotalsCol m_pCols[(uint32_t) IAdapter::TotalsCol::count];
+    uint32_t m_nCols = 0;
+};
+
+void parse_hdrs_args(const HttpUrl& url, HdrsArgs& a)
+{
+    a.m_hMax = url.get_int_arg("hMax", std::numeric_limits<int64_t>::max());
+    a.m_nMax = (uint32_t) url.get_int_arg("nMax", static_cast<uint32_t>(-1));
+    a.m_dh = url.get_int_arg("dh", static_cast<uint32_t>(1));
+
+    typedef IAdapter::TotalsCol C;
+
+    C* pCols = a.m_pCols;
+    uint32_t& nCols = a.m_nCols;
+
+    auto it = url.args.find("cols");
+    if (url.args.end() == it)
+    {
+        // defaults
+        pCols[nCols++] = C::Hash_Abs;
+        pCols[nCols++] = C::Time_Abs;
+        pCols[nCols++] = C::Difficulty_Rel;
+        pCols[nCols++] = C::Fee_Rel;
+        pCols[nCols++] = C::Kernels_Rel;
+        pCols[nCols++] = C::MwOutputs_Rel;
+        pCols[nCols++] = C::MwInputs_Rel;
+        pCols[nCols++] = C::ShOutputs_Rel;
+        pCols[nCols++] = C::ShInputs_Rel;
+        pCols[nCols++] = C::ContractCalls_Rel;
+
+        assert(nCols <= _countof(a.m_pCols));
+    }
+    else
+    {
+        for (char ch : it->second)
+        {
+            C val;
+
+            switch (ch)
+            {
+        #define COL_CASE(chAbs, chRel, type) \
+            case chAbs: val = C::type##_Abs; break; \
+            case chRel: val = C::type##_Rel; break;
+
+            case 'H': val = C::Hash_Abs; break;
+            COL_CASE('T', 't', Time)
+            COL_CASE('G', 'g', Age)
+            COL_CASE('D', 'd', Difficulty)
+            COL_CASE('F', 'f', Fee)
+            COL_CASE('K', 'k', Kernels)
+            COL_CASE('O', 'o', MwOutputs)
+            COL_CASE('I', 'i', MwInputs)
+            COL_CASE('U', 'u', MwUtxos)
+            COL_CASE('Z', 'z', ShOutputs)
+            COL_CASE('Y', 'y', ShInputs)
+            COL_CASE('B', 'b', ContractsActive)
+            COL_CASE('P', 'p', ContractCalls)
+            COL_CASE('C', 'c', SizeCompressed)
+            COL_CASE('A', 'a', SizeArchive)
+
+            default:
+                val = C::count;
+            }
+
+            if (C::count != val)
+            {
+                assert(nCols < _countof(a.m_pCols));
+                pCols[nCols++] = val;
+
+                if (_countof(a.m_pCols) == nCols)
+                    break; // too many columns, truncate
+            }
+        }
+    }
+}
+
+struct Server::AsyncRequest
+    :public IAdapter::AsyncResult
+{
+    Server* m_pThis = nullptr; // reset if the server or the connection is gone
+    uint64_t m_ConnID;
+    std::string m_Path;
+    IAdapter::Mode m_Mode;
+    ResponseCache::Tier* m_pTier;
+    uint64_t m_StateVersion;
+    uint64_t m_Start_us; // for the rate limit, incl. the time in the worker queue
+    std::deque<std::string> m_vDeferred; // subsequent requests on the same connection, answered in order
+
+    void OnDone() override
+    {
+        if (m_pThis)
+            m_pThis->on_async_done(*this);
+    }
+};
+
+Server::~Server()
+{
+    for (auto& x : m_AsyncPending)
+        x.second->m_pThis = nullptr;
+}
+
+void Server::drop_connection(uint64_t id)
+{
+    auto it = m_AsyncPending.find(id);
+    if (m_AsyncPending.end() != it)
+    {
+        it->second->m_pThis = nullptr;
+        m_AsyncPending.erase(it);
+    }
+
+    if (_connections.erase(id))
+    {
+        m_ConnStats.m_LastActive_ms.erase(id);
+        m_ConnStats.m_Gzip.erase(id);
+
+        auto itIp = m_ConnStats.m_PerIp.find(io::Address::from_u64(id).ip());
+        if ((m_ConnStats.m_PerIp.end() != itIp) && !--itIp->second)
+            m_ConnStats.m_PerIp.erase(itIp);
+    }
+}
+
 bool Server::on_request(uint64_t id, const HttpMsgReader::Message& msg)
 {
     auto it = _connections.find(id);
@@ -560,18 +781,54 @@ bool Server::on_request(uint64_t id, const HttpMsgReader::Message& msg)
 
     if (msg.what != HttpMsgReader::http_message || !msg.msg) {
         BEAM_LOG_DEBUG() << STS << "-peer " << io::Address::from_u64(id) << " : " << msg.error_str();
-        _connections.erase(id);
+        drop_connection(id);
         return false;
     }
 
-    enum struct DirType
+    const std::string& path = msg.msg->get_path();
+    m_ConnStats.m_LastActive_ms[id] = local_timestamp_msec();
+
+    if (HttpMsgCreator::accepts_gzip(msg.msg->get_header("Accept-Encoding")))
+        m_ConnStats.m_Gzip.insert(id);
+    else
+        m_ConnStats.m_Gzip.erase(id);
+
+    auto itAsync = m_AsyncPending.find(id);
+    if (m_AsyncPending.end() != itAsync)
     {
-        Unused,
-#define THE_MACRO(dir) dir,
-        ExplorerNodeDirs(THE_MACRO)
-#undef THE_MACRO
-    };
+        auto& v = itAsync->second->m_vDeferred;
+        if (v.size() < MAX_DEFERRED_REQUESTS)
+        {
+            v.push_back(path);
+            return true;
+        }
+
+        BEAM_LOG_DEBUG() << STS << "-peer " << io::Address::from_u64(id) << " : too many pipelined requests";
+        it->second->shutdown();
+        drop_connection(id);
+        return false;
+    }
+
+    bool keepalive = process_request(id, path);
 
+    if (keepalive && (m_AsyncPending.end() == m_AsyncPending.find(id)))
+    {
+        // answered, honor the client's wish to close
+        const std::string& sConnection = msg.msg->get_header("Connection");
+        if (boost::algorithm::iequals(sConnection, "close"))
+            keepalive = false;
+    }
+
+    if (!keepalive)
+    {
+        it->second->shutdown();
+        drop_connection(id);
+    }
+    return keepalive;
+}
+
+bool Server::process_request(uint64_t id, const std::string& path)
+{
     if (m_Dirs.empty())
     {
 #define THE_MACRO(dir) m_Dirs[#dir] = (int) DirType::dir;
@@ -579,8 +836,7 @@ bool Server::on_request(uint64_t id, const HttpMsgReader::Message& msg)
 #undef THE_MACRO
     }
 
-    const std::string& path = msg.msg->get_path();
-    const HttpConnection::Ptr& conn = it->second;
+    const HttpConnection::Ptr& conn = _connections[id];
 
     json (Server::*pFn)(const HttpConnection::Ptr&) = 0;
 
@@ -597,72 +853,317 @@ bool Server::on_request(uint64_t id, const HttpMsgReader::Message& msg)
         }
     }
 
-    bool keepalive = false;
+    if (!pFn)
+    {
+        send(conn, 404, "Not Found");
+        return false;
+    }
 
-    if (pFn)
+    if (_currentUrl.args.end() != _currentUrl.args.find("htm"))
+        _backend.m_Mode = IAdapter::Mode::AutoHtml;
+    else
     {
-        if (_currentUrl.args.end() != _currentUrl.args.find("htm"))
-            _backend.m_Mode = IAdapter::Mode::AutoHtml;
+        if (_currentUrl.args.end() != _currentUrl.args.find("exp_am"))
+            _backend.m_Mode = IAdapter::Mode::ExplicitType;
         else
+            _backend.m_Mode = IAdapter::Mode::Legacy;
+    }
+
+    _body.clear();
+
+    //bool validKey = _acl.check(_currentUrl.args["m"], _currentUrl.args["n"], _currentUrl.args["h"]);
+    bool validKey = _acl.check(conn->peer_address());
+    if (!validKey)
+    {
+        send(conn, 403, "Forbidden");
+        return false;
+    }
+
+    int dir = _currentUrl.dir;
+    if (!_acl.admit(conn->peer_address(), m_pDirCost_us[dir] + REQUEST_BASE_COST_US))
+    {
+        send(conn, 429, "Too Many Requests");
+        return false;
+    }
+
+    struct CostScope
+    {
+        Server& m_This;
+        uint64_t m_ID;
+        int m_Dir;
+        uint64_t m_Start_us = get_time_us();
+        bool m_Async = false; // charged once done
+
+        ~CostScope()
         {
-            if (_currentUrl.args.end() != _currentUrl.args.find("exp_am"))
-                _backend.m_Mode = IAdapter::Mode::ExplicitType;
-            else
-                _backend.m_Mode = IAdapter::Mode::Legacy;
+            if (!m_Async)
+                m_This.charge_request(m_ID, m_Dir, m_Start_us);
         }
+    } cs{ *this, id, dir };
 
-        _body.clear();
+    ResponseCache::Tier* pTier = get_cache_tier((DirType) _currentUrl.dir);
+    const ResponseCache::Entry* pCached = pTier ? pTier->Find(path) : nullptr;
+    if (pCached)
+    {
+        bool isGzip = !pCached->m_BodyGz.empty() && m_ConnStats.m_Gzip.count(id);
+        _body = isGzip ? pCached->m_BodyGz : pCached->m_Body;
+        return send(conn, 200, "OK", pCached->m_IsHtml, isGzip);
+    }
 
-        //bool validKey = _acl.check(_currentUrl.args["m"], _currentUrl.args["n"], _currentUrl.args["h"]);
-        bool validKey = _acl.check(conn->peer_address());
-        if (!validKey)
-            send(conn, 403, "Forbidden");
-        else
+    try
+    {
+        if ((DirType::hdrs == (DirType) _currentUrl.dir) && start_hdrs_async(id, path, pTier))
         {
-            try
-            {
-                json j = (this->*pFn)(conn);
+            cs.m_Async = true;
+            return true; // the response will follow
+        }
 
-                io::SerializedMsg sm;
+        json j = (this->*pFn)(conn);
+        make_body(j, _backend.m_Mode, path, _body);
 
-                switch (_backend.m_Mode)
-                {
-                case IAdapter::Mode::AutoHtml:
-                    {
-                        HtmlConverter cvt(path);
-                        cvt.Convert(j);
-                        cvt.get_Res(_body);
-                    }
-                    break;
+        bool isHtml = (IAdapter::Mode::AutoHtml == _backend.m_Mode);
+        bool isGzip = encode_body(id, path, pTier, isHtml);
 
-                case IAdapter::Mode::ExplicitType:
-                    jsonExp(j, 0);
-                    // no break;
+        return send(conn, 200, "OK", isHtml, isGzip);
+    }
+    catch (const std::exception& e)
+    {
+        std::ostringstream os;
+        os << "Internal error: " << e.what();
+        send(conn, 500, os.str().c_str());
+    }
 
-                default:
-                    json2Msg(j, _body);
-                }
+    return false;
+}
 
-                keepalive = send(conn, 200, "OK", IAdapter::Mode::AutoHtml == _backend.m_Mode);
-            }
-            catch (const std::exception& e)
-            {
-                std::ostringstream os;
-                os << "Internal error: " << e.what();
-                send(conn, 500, os.str().c_str());
-            }
+bool Server::encode_body(uint64_t id, const std::string& path, ResponseCache::Tier* pTier, bool isHtml)
+{
+    bool accepts = m_ConnStats.m_Gzip.count(id) > 0;
+
+    // cached responses are compressed once, regardless of the current client
+    io::SerializedMsg bodyGz;
+    if (accepts || pTier)
+        HttpMsgCreator::gzip_body(bodyGz, _body, GZIP_MIN_SIZE);
+
+    if (pTier)
+        pTier->Insert(path, _body, bodyGz, isHtml);
+
+    if (!accepts || bodyGz.empty())
+        return false;
+
+    _body.swap(bodyGz);
+    return true;
+}
+
+void Server::on_async_done(AsyncRequest& r)
+{
+    uint64_t id = r.m_ConnID;
+
+    auto itAsync = m_AsyncPending.find(id);
+    assert((m_AsyncPending.end() != itAsync) && (itAsync->second.get() == &r));
+    auto pReq = std::move(itAsync->second); // keep it alive
+    m_AsyncPending.erase(itAsync);
+    pReq->m_pThis = nullptr;
+
+    charge_request(id, (int) DirType::hdrs, r.m_Start_us);
+
+    auto it = _connections.find(id);
+    if (_connections.end() == it)
+        return;
+
+    const HttpConnection::Ptr& conn = it->second;
+    bool keepalive = false;
+    _body.clear();
+    m_ConnStats.m_LastActive_ms[id] = local_timestamp_msec();
+
+    if (r.m_sErr.empty())
+    {
+        try
+        {
+            make_body(r.m_Json, r.m_Mode, r.m_Path, _body);
+
+            bool isHtml = (IAdapter::Mode::AutoHtml == r.m_Mode);
+            auto* pTier = (r.m_StateVersion == _backend.m_StateVersion) ? r.m_pTier : nullptr;
+            bool isGzip = encode_body(id, r.m_Path, pTier, isHtml);
+
+            keepalive = send(conn, 200, "OK", isHtml, isGzip);
         }
+        catch (const std::exception& e)
+        {
+            r.m_sErr = e.what();
+        }
+    }
 
+    if (!r.m_sErr.empty())
+    {
+        std::ostringstream os;
+        os << "Internal error: " << r.m_sErr;
+        send(conn, 500, os.str().c_str());
+    }
+
+    // serve the requests that came meanwhile
+    while (keepalive && !r.m_vDeferred.empty())
+    {
+        std::string path = std::move(r.m_vDeferred.front());
+        r.m_vDeferred.pop_front();
+
+        keepalive = process_request(id, path);
+
+        itAsync = m_AsyncPending.find(id);
+        if (m_AsyncPending.end() != itAsync)
+        {
+            // went async again, the rest waits for it
+            auto& v = itAsync->second->m_vDeferred;
+            v.insert(v.end(), std::make_move_iterator(r.m_vDeferred.begin()), std::make_move_iterator(r.m_vDeferred.end()));
+            return;
+        }
     }
-    else
-        send(conn, 404, "Not Found");
 
     if (!keepalive)
     {
         conn->shutdown();
-        _connections.erase(it);
+        drop_connection(id);
     }
-    return keepalive;
+}
+
+bool Server::start_hdrs_async(uint64_t id, const std::string& path, ResponseCache::Tier* pTier)
+{
+    HdrsArgs args;
+    parse_hdrs_args(_currentUrl, args);
+
+    auto pReq = std::make_shared<AsyncRequest>();
+    pReq->m_ConnID = id;
+    pReq->m_Path = path;
+    pReq->m_Mode = _backend.m_Mode;
+    pReq->m_pTier = pTier;
+    pReq->m_StateVersion = _backend.m_StateVersion;
+    pReq->m_Start_us = get_time_us();
+
+    if (!_backend.get_hdrs_async(pReq, args.m_hMax, args.m_nMax, args.m_dh, args.m_pCols, args.m_nCols))
+        return false;
+
+    pReq->m_pThis = this;
+    m_AsyncPending[id] = std::move(pReq);
+    return true;
+}
+
+Server::ResponseCache::Tier* Server::get_cache_tier(DirType dir)
+{
+    if (m_Cache.m_StateVersion != _backend.m_StateVersion)
+    {
+        m_Cache.m_StateVersion = _backend.m_StateVersion;
+        m_Cache.m_Tip.ShrinkTo(0);
+    }
+
+    Height hImmutable = _backend.get_HeightImmutable();
+    if (hImmutable < m_Cache.m_hImmutable)
+        m_Cache.m_Immutable.ShrinkTo(0); // manual rollback below the horizon
+    m_Cache.m_hImmutable = hImmutable;
+
+    switch (dir)
+    {
+    case DirType::block:
+        if (_currentUrl.args.end() == _currentUrl.args.find("kernel"))
+        {
+            auto h = _currentUrl.get_int_arg("height", 0);
+            if ((h >= 0) && (static_cast<Height>(h) < hImmutable))
+                return &m_Cache.m_Immutable;
+        }
+        return &m_Cache.m_Tip;
+
+    case DirType::blocks:
+        {
+            auto h = _currentUrl.get_int_arg("height", 0);
+            auto n = _currentUrl.get_int_arg("n", 0);
+            if ((h > 0) && (n >= 0) && (static_cast<Height>(h) + std::max<int64_t>(n, 1) <= hImmutable))
+                return &m_Cache.m_Immutable;
+        }
+        return &m_Cache.m_Tip;
+
+    case DirType::hdrs:
+        {
+            auto h = _currentUrl.get_int_arg("hMax", std::numeric_limits<int64_t>::max());
+            if ((h >= 0) && (static_cast<Height>(h) < hImmutable))
+                return &m_Cache.m_Immutable;
+        }
+        return &m_Cache.m_Tip;
+
+    case DirType::status:
+    case DirType::contracts:
+    case DirType::contract:
+    case DirType::asset:
+    case DirType::assets:
+        return &m_Cache.m_Tip;
+
+    default:
+        return nullptr; // peers, perf, swaps: not bound to the chain state
+    }
+}
+
+void Server::ResponseCache::Tier::Delete(Entry& x)
+{
+    assert(m_SizeCurrent >= x.m_Size);
+    m_SizeCurrent -= x.m_Size;
+
+    m_Keys.erase(KeySet::s_iterator_to(x.m_Key));
+    m_Mru.erase(MruList::s_iterator_to(x.m_Mru));
+    delete &x;
+}
+
+void Server::ResponseCache::Tier::ShrinkTo(uint64_t nSize)
+{
+    while (m_SizeCurrent > nSize)
+        Delete(m_Mru.back().get_ParentObj());
+}
+
+const Server::ResponseCache::Entry* Server::ResponseCache::Tier::Find(const std::string& path)
+{
+    if (m_Keys.empty())
+        return nullptr;
+
+    Entry::Key k;
+    k.m_Value = path;
+
+    auto it = m_Keys.find(k);
+    if (m_Keys.end() == it)
+        return nullptr;
+
+    Entry& x = it->get_ParentObj();
+    m_Mru.erase(MruList::s_iterator_to(x.m_Mru));
+    m_Mru.push_front(x.m_Mru);
+
+    return &x;
+}
+
+void Server::ResponseCache::Tier::Insert(const std::string& path, const io::SerializedMsg& body, const io::SerializedMsg& bodyGz, bool isHtml)
+{
+    uint64_t nSize = sizeof(Entry) + path.size();
+    for (const auto& f : body)
+        nSize += f.size;
+    for (const auto& f : bodyGz)
+        nSize += f.size;
+
+    if (nSize > m_SizeMax)
+        return;
+
+    std::unique_ptr<Entry> pEntry(new Entry);
+    pEntry->m_Key.m_Value = path;
+
+    auto it = m_Keys.find(pEntry->m_Key);
+    if (m_Keys.end() != it)
+        Delete(it->get_ParentObj());
+
+    ShrinkTo(m_SizeMax - nSize);
+
+    pEntry->m_Body = body;
+    pEntry->m_BodyGz = bodyGz;
+    pEntry->m_IsHtml = isHtml;
+    pEntry->m_Size = nSize;
+
+    m_Keys.insert(pEntry->m_Key);
+    m_Mru.push_front(pEntry->m_Mru);
+    m_SizeCurrent += nSize;
+    pEntry.release();
 }
 
 #define OnRequest(dir) json Server::on_request_##dir(const HttpConnection::Ptr& conn)
@@ -716,76 +1217,9 @@ OnRequest(blocks)
 
 OnRequest(hdrs)
 {
-    Height hTop = _currentUrl.get_int_arg("hMax", std::numeric_limits<int64_t>::max());
-    uint32_t n = (uint32_t) _currentUrl.get_int_arg("nMax", static_cast<uint32_t>(-1));
-    Height dh = _currentUrl.get_int_arg("dh", static_cast<uint32_t>(1));
-
-    typedef IAdapter::TotalsCol C;
-
-    C pCols[(uint32_t) C::count];
-    uint32_t nCols = 0;
-
-    auto it = _currentUrl.args.find("cols");
-    if (_currentUrl.args.end() == it)
-    {
-        // defaults
-        pCols[nCols++] = C::Hash_Abs;
-        pCols[nCols++] = C::Time_Abs;
-        pCols[nCols++] = C::Difficulty_Rel;
-        pCols[nCols++] = C::Fee_Rel;
-        pCols[nCols++] = C::Kernels_Rel;
-        pCols[nCols++] = C::MwOutputs_Rel;
-        pCols[nCols++] = C::MwInputs_Rel;
-        pCols[nCols++] = C::ShOutputs_Rel;
-        pCols[nCols++] = C::ShInputs_Rel;
-        pCols[nCols++] = C::ContractCalls_Rel;
-
-        assert(nCols <= _countof(pCols));
-    }
-    else
-    {
-        for (char ch : it->second)
-        {
-            C val;
-
-            switch (ch)
-            {
-        #define COL_CASE(chAbs, chRel, type) \
-            case chAbs: val = C::type##_Abs; break; \
-            case chRel: val = C::type##_Rel; break;
-
-            case 'H': val = C::Hash_Abs; break;
-            COL_CASE('T', 't', Time)
-            COL_CASE('G', 'g', Age)
-            COL_CASE('D', 'd', Difficulty)
-            COL_CASE('F', 'f', Fee)
-            COL_CASE('K', 'k', Kernels)
-            COL_CASE('O', 'o', MwOutputs)
-            COL_CASE('I', 'i', MwInputs)
-            COL_CASE('U', 'u', MwUtxos)
-            COL_CASE('Z', 'z', ShOutputs)
-            COL_CASE('Y', 'y', ShInputs)
-            COL_CASE('B', 'b', ContractsActive)
-            COL_CASE('P', 'p', ContractCalls)
-            COL_CASE('C', 'c', SizeCompressed)
-            COL_CASE('A', 'a', SizeArchive)
-
-            default:
-                val = C::count;
-            }
-
-            if (C::count != val)
-            {
-                assert(nCols < _countof(pCols));
-                pCols[nCols++] = val;
-
-                if (_countof(pCols) == nCols)
-                    break; // too many columns, truncate
-            }
-        }
-    }
-
-    return _backend.get_hdrs(hTop, n, dh, pCols, nCols);
+    HdrsArgs args;
+    parse_hdrs_args(_currentUrl, args);
+    return _backend.get_hdrs(args.m_hMax, args.m_nMax, args.m_dh, args.m_pCols, args.m_nCols);
 }
 
 OnRequest(peers)
@@ -793,6 +1227,11 @@ OnRequest(peers)
     return _backend.get_peers();
 }
 
+OnRequest(perf)
+{
+    return _backend.get_perf();
+}
+
 OnRequest(swap_offers)
 {
     return _backend.get_swap_offers();
@@ -839,26 +1278,35 @@ OnRequest(assets)
     return _backend.get_assets_at(height);
 }
 
-bool Server::send(const HttpConnection::Ptr& conn, int code, const char* message, bool isHtml)
+bool Server::send(const HttpConnection::Ptr& conn, int code, const char* message, bool isHtml, bool isGzip)
 {
     assert(conn);
 
     size_t bodySize = 0;
     for (const auto& f : _body) { bodySize += f.size; }
 
-    HeaderPair pHp[2];
+    HeaderPair pHp[4];
     ZeroObject(pHp);
     pHp[0].head = "Access-Control-Allow-Origin";
     pHp[0].content_str = "*";
     pHp[1].head = "Access-Control-Allow-Headers";
     pHp[1].content_str = "*";
+    pHp[2].head = "Vary";
+    pHp[2].content_str = "Accept-Encoding";
+    size_t nHp = 3;
+
+    if (isGzip)
+    {
+        pHp[nHp].head = "Content-Encoding";
+        pHp[nHp++].content_str = "gzip";
+    }
 
     bool ok = _msgCreator.create_response(
         _headers,
         code,
         message,
         pHp, //headers,
-        _countof(pHp), //sizeof(headers) / sizeof(HeaderPair),
+        nHp,
         1,
         isHtml ? "text/html" : "application/json",
         bodySize
@@ -919,4 +1367,58 @@ bool Server::IPAccessControl::check(io::Address peerAddress) {
     return _ips.count(peerAddress.ip()) > 0;
 }
 
+void Server::IPAccessControl::set_rate_limit(uint32_t rate_ms, uint32_t burst_ms) {
+    _rate_us = static_cast<uint64_t>(rate_ms) * 1000;
+    _burst_us = static_cast<uint64_t>(std::max(burst_ms, rate_ms)) * 1000;
+    _buckets.clear();
+}
+
+Server::IPAccessControl::Bucket* Server::IPAccessControl::get_bucket(io::Address peerAddress) {
+    static const uint32_t localhostIP = io::Address::localhost().ip();
+    if (!_rate_us || peerAddress.ip() == localhostIP) return nullptr; // a local proxy is limited on its side
+
+    uint64_t now_ms = local_timestamp_msec();
+
+    auto it = _buckets.find(peerAddress.ip());
+    if (_buckets.end() == it) {
+        Bucket& b = _buckets[peerAddress.ip()];
+        b.m_Balance_us = _burst_us;
+        b.m_Refilled_ms = now_ms;
+        return &b;
+    }
+
+    refill(it->second, now_ms);
+    return &it->second;
+}
+
+void Server::IPAccessControl::refill(Bucket& b, uint64_t now_ms) {
+    if (now_ms > b.m_Refilled_ms) {
+        uint64_t dt_ms = std::min<uint64_t>(now_ms - b.m_Refilled_ms, 3600 * 1000);
+        b.m_Balance_us = std::min<int64_t>(b.m_Balance_us + static_cast<int64_t>(dt_ms * _rate_us / 1000), _burst_us);
+        b.m_Refilled_ms = now_ms;
+    }
+}
+
+bool Server::IPAccessControl::admit(io::Address peerAddress, uint64_t expected_us) {
+    Bucket* pB = get_bucket(peerAddress);
+    return !pB || (pB->m_Balance_us >= static_cast<int64_t>(std::min(expected_us, _burst_us)));
+}
+
+void Server::IPAccessControl::charge(io::Address peerAddress, uint64_t cost_us) {
+    Bucket* pB = get_bucket(peerAddress);
+    if (pB) // the debt is capped, so that an expensive request doesn't lock the client out for long
+        pB->m_Balance_us = std::max<int64_t>(pB->m_Balance_us - static_cast<int64_t>(cost_us), -static_cast<int64_t>(_burst_us));
+}
+
+void Server::IPAccessControl::purge() {
+    uint64_t now_ms = local_timestamp_msec();
+    for (auto it = _buckets.begin(); _buckets.end() != it; ) {
+        refill(it->second, now_ms);
+        if (it->second.m_Balance_us >= static_cast<int64_t>(_burst_us))
+            it = _buckets.erase(it);
+        else
+            ++it;
+    }
+}
+
 }} //namespaces
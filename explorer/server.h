@@ -17,6 +17,7 @@
 #include "utility/io/tcpserver.h"
 #include "utility/io/coarsetimer.h"
 #include "utility/helpers.h"
+#include "utility/containers.h"
 #include <string_view>
 #include <set>
 #include "nlohmann/json.hpp"
@@ -32,7 +33,8 @@
     macro(contracts) \
     macro(contract) \
     macro(asset) \
-    macro(assets)
+    macro(assets) \
+    macro(perf)
 
 namespace beam { namespace explorer {
 
@@ -41,8 +43,107 @@ struct IAdapter;
 class Server {
 public:
     Server(IAdapter& adapter, io::Reactor& reactor, io::Address bindAddress, const std::string& keysFileName, const std::vector<uint32_t>& whitelist);
+    ~Server();
+
+    // response cache budgets, in bytes. 0 disables the tier
+    void set_cache_size(uint64_t immutableSize, uint64_t tipSize);
+
+    // keep-alive connections are closed after idleTimeout_s without requests. maxPerIp: 0 = unlimited (i.e. behind a load balancer)
+    void set_connection_limits(uint32_t idleTimeout_s, uint32_t maxPerIp);
+
+    // per-IP budget of the server time spent on requests: refilled at rate_ms per second, up to burst_ms. rate_ms = 0 disables
+    void set_rate_limit(uint32_t rate_ms, uint32_t burst_ms);
 
 private:
+    enum struct DirType
+    {
+        Unused,
+#define THE_MACRO(dir) dir,
+        ExplorerNodeDirs(THE_MACRO)
+#undef THE_MACRO
+        count
+    };
+
+    uint64_t m_pDirCost_us[(size_t) DirType::count] = { 0 }; // moving average of the measured cost, per endpoint
+    void charge_request(uint64_t id, int dir, uint64_t tStart_us);
+
+    // Serialized responses, keyed by the request path (incl. args).
+    // Immutable tier: blocks below the rollback horizon, kept across tip changes.
+    // Tip tier: the rest of the state-dependent responses, dropped once the tip changes
+    struct ResponseCache
+    {
+        struct Entry
+        {
+            struct Key
+                :public boost::intrusive::set_base_hook<>
+            {
+                std::string m_Value;
+                bool operator < (const Key& x) const { return m_Value < x.m_Value; }
+                IMPLEMENT_GET_PARENT_OBJ(Entry, m_Key)
+            } m_Key;
+
+            struct Mru
+                :public boost::intrusive::list_base_hook<>
+            {
+                IMPLEMENT_GET_PARENT_OBJ(Entry, m_Mru)
+            } m_Mru;
+
+            io::SerializedMsg m_Body;
+            io::SerializedMsg m_BodyGz; // empty if not worth compressing
+            bool m_IsHtml;
+            uint64_t m_Size;
+        };
+
+        typedef boost::intrusive::multiset<Entry::Key> KeySet;
+        typedef boost::intrusive::list<Entry::Mru> MruList;
+
+        struct Tier
+        {
+            KeySet m_Keys;
+            MruList m_Mru;
+            uint64_t m_SizeMax = 0;
+            uint64_t m_SizeCurrent = 0;
+
+            ~Tier() { ShrinkTo(0); }
+
+            void ShrinkTo(uint64_t);
+            void Delete(Entry&);
+            const Entry* Find(const std::string& path); // modifies MRU if found
+            void Insert(const std::string& path, const io::SerializedMsg& body, const io::SerializedMsg& bodyGz, bool isHtml);
+        };
+
+        Tier m_Immutable;
+        Tier m_Tip;
+        uint64_t m_StateVersion = 0;
+        Height m_hImmutable = 0;
+    };
+
+    ResponseCache m_Cache;
+    ResponseCache::Tier* get_cache_tier(DirType);
+
+    // Requests served by the adapter workers. The connection input is queued meanwhile, to keep the order of the responses
+    struct AsyncRequest;
+    std::map<uint64_t, std::shared_ptr<AsyncRequest> > m_AsyncPending; // by connection id
+
+    struct ConnStats
+    {
+        std::map<uint64_t, uint64_t> m_LastActive_ms; // by connection id
+        std::map<uint32_t, uint32_t> m_PerIp;
+        std::set<uint64_t> m_Gzip; // connections that accept gzip, as of their last request
+        uint32_t m_IdleTimeout_ms;
+        uint32_t m_MaxPerIp;
+    } m_ConnStats;
+
+    void check_idle();
+
+    // compresses _body if the client accepts it (or for the cache), and caches it. Returns true if _body is now gzip
+    bool encode_body(uint64_t id, const std::string& path, ResponseCache::Tier*, bool isHtml);
+
+    bool process_request(uint64_t id, const std::string& path); // returns keepalive
+    bool start_hdrs_async(uint64_t id, const std::string& path, ResponseCache::Tier*);
+    void on_async_done(AsyncRequest&);
+    void drop_connection(uint64_t id);
+
     class IPAccessControl {
     public:
         explicit IPAccessControl(const std::string& ipsFileName);
@@ -50,11 +151,30 @@ private:
         bool check(io::Address peerAddress);
 
         void refresh();
+
+        // token buckets, in microseconds of the server time
+        void set_rate_limit(uint32_t rate_ms, uint32_t burst_ms);
+        bool admit(io::Address peerAddress, uint64_t expected_us); // false if the remaining budget doesn't cover the expected cost
+        void charge(io::Address peerAddress, uint64_t cost_us);
+        void purge(); // forget the buckets that are full again
     private:
         bool _enabled;
         std::string _ipsFileName;
         time_t _lastModified;
         std::set<uint32_t> _ips;
+
+        struct Bucket
+        {
+            int64_t m_Balance_us; // may go negative, the actual cost is known only after the request
+            uint64_t m_Refilled_ms;
+        };
+
+        std::map<uint32_t, Bucket> _buckets;
+        uint64_t _rate_us = 0; // per second
+        uint64_t _burst_us = 0;
+
+        Bucket* get_bucket(io::Address peerAddress);
+        void refill(Bucket&, uint64_t now_ms);
     };
 
     void start_server();
@@ -63,7 +183,7 @@ private:
     void on_stream_accepted(io::TcpStream::Ptr&& newStream, io::ErrorCode errorCode);
 
     bool on_request(uint64_t id, const HttpMsgReader::Message& msg);
-    bool send(const HttpConnection::Ptr& conn, int code, const char* message, bool isHtml = false);
+    bool send(const HttpConnection::Ptr& conn, int code, const char* message, bool isHtml = false, bool isGzip = false);
 
 #define THE_MACRO(dir) nlohmann::json on_request_##dir(const HttpConnection::Ptr& conn);
     ExplorerNodeDirs(THE_MACRO)
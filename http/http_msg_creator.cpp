@@ -14,7 +14,10 @@
 
 #include "http_msg_creator.h"
 #include "utility/logger.h"
+#include "utility/compress.h"
+#include <string_view>
 #include <stdio.h>
+#include <stdlib.h>
 #include <stdarg.h>
 #include <assert.h>
 
@@ -123,4 +126,48 @@ bool HttpMsgCreator::create_response(
     return create_message(_fragmentWriter, headers, num_headers, content_type, bodySize);
 }
 
+bool HttpMsgCreator::accepts_gzip(const std::string& acceptEncoding) {
+    // i.e. "gzip, deflate;q=0.5, br", "*", "gzip;q=0"
+    std::string_view s(acceptEncoding);
+    while (!s.empty()) {
+        auto pos = s.find(',');
+        std::string_view item = s.substr(0, pos);
+        s = (std::string_view::npos == pos) ? std::string_view() : s.substr(pos + 1);
+
+        std::string_view params;
+        pos = item.find(';');
+        if (std::string_view::npos != pos) {
+            params = item.substr(pos + 1);
+            item = item.substr(0, pos);
+        }
+
+        while (!item.empty() && (' ' == item.front())) item.remove_prefix(1);
+        while (!item.empty() && (' ' == item.back())) item.remove_suffix(1);
+
+        if ((item != "gzip") && (item != "*"))
+            continue;
+
+        pos = params.find("q=");
+        if (std::string_view::npos == pos)
+            return true;
+
+        params = params.substr(pos + 2);
+        return !params.empty() && (strtod(std::string(params).c_str(), nullptr) > 0.);
+    }
+    return false;
+}
+
+bool HttpMsgCreator::gzip_body(io::SerializedMsg& out, const io::SerializedMsg& body, size_t minSize) {
+    io::SharedBuffer src = io::normalize(body, false);
+    if (src.size < minSize) return false;
+
+    auto p = io::alloc_heap(gzip::get_max_compressed_size(src.size));
+    size_t n = gzip::compress(p.first, src.data, src.size);
+    if (n >= src.size) return false;
+
+    out.clear();
+    out.emplace_back(p.first, n); // copy, don't hold the worst-case sized buffer (the result may be cached)
+    return true;
+}
+
 } //namepsace
@@ -15,6 +15,7 @@
 #pragma once
 #include "utility/io/fragment_writer.h"
 #include "nlohmann/json_fwd.hpp"
+#include <string>
 
 namespace beam {
 
@@ -78,6 +79,12 @@ public:
         _currentMsg = 0;
     }
 
+    /// Content-Encoding negotiation: true if the client's Accept-Encoding value allows gzip
+    static bool accepts_gzip(const std::string& acceptEncoding);
+
+    /// Compresses the body into out (gzip). Returns false if it's smaller than minSize or doesn't shrink, then it should be sent as-is
+    static bool gzip_body(io::SerializedMsg& out, const io::SerializedMsg& body, size_t minSize);
+
 private:
     io::FragmentWriter _fragmentWriter;
     io::SerializedMsg* _currentMsg;
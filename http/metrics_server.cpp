@@ -0,0 +1,97 @@
+// Copyright 2018 The Beam Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "metrics_server.h"
+#include "utility/metrics.h"
+#include "utility/helpers.h"
+#include "utility/logger.h"
+
+namespace beam {
+
+namespace {
+
+#define STS "Metrics server: "
+
+static const size_t MAX_REQUEST_BODY = 1024;
+
+} //namespace
+
+MetricsServer::MetricsServer(io::Reactor& reactor, io::Address bindAddress) :
+    _msgCreator(2000)
+{
+    _server = io::TcpServer::create(reactor, bindAddress, BIND_THIS_MEMFN(on_stream_accepted));
+    BEAM_LOG_INFO() << STS << "listens to " << bindAddress;
+}
+
+void MetricsServer::on_stream_accepted(io::TcpStream::Ptr&& newStream, io::ErrorCode errorCode) {
+    if (errorCode != 0) {
+        BEAM_LOG_ERROR() << STS << io::error_str(errorCode);
+        return;
+    }
+
+    auto peer = newStream->peer_address();
+    _connections[peer.u64()] = std::make_unique<HttpConnection>(
+        peer.u64(),
+        BaseConnection::inbound,
+        BIND_THIS_MEMFN(on_request),
+        MAX_REQUEST_BODY,
+        MAX_REQUEST_BODY,
+        std::move(newStream)
+    );
+}
+
+bool MetricsServer::on_request(uint64_t id, const HttpMsgReader::Message& msg) {
+    auto it = _connections.find(id);
+    if (it == _connections.end()) return false;
+
+    if (msg.what != HttpMsgReader::http_message || !msg.msg) {
+        _connections.erase(it);
+        return false;
+    }
+
+    bool ok;
+    const std::string& path = msg.msg->get_path();
+    if ((path == "/metrics") || (path.rfind("/metrics?", 0) == 0)) {
+        _body.clear();
+        metrics::Registry::get().Collect(_body);
+        ok = send(*it->second, 200, "OK", _body);
+    } else {
+        ok = send(*it->second, 404, "Not Found", "not found\n"); // non-empty, otherwise there's no content length
+    }
+
+    if (!ok || (msg.msg->get_header("Connection") == "close")) {
+        it->second->shutdown();
+        _connections.erase(it);
+        return false;
+    }
+
+    return true;
+}
+
+bool MetricsServer::send(HttpConnection& conn, int code, const char* message, const std::string& body) {
+    io::SerializedMsg headers;
+    if (!_msgCreator.create_response(headers, code, message, nullptr, 0, 1, "text/plain; version=0.0.4", body.size())) {
+        BEAM_LOG_ERROR() << STS << "cannot create response";
+        return false;
+    }
+
+    auto result = conn.write_msg(headers, false);
+    if (result) {
+        result = conn.write_msg(io::SharedBuffer(body.data(), body.size()));
+    }
+
+    return !!result;
+}
+
+} //namespace
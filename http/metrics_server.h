@@ -0,0 +1,40 @@
+// Copyright 2018 The Beam Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+#include "http_connection.h"
+#include "http_msg_creator.h"
+#include "utility/io/tcpserver.h"
+#include <map>
+
+namespace beam {
+
+/// Serves the process metrics (metrics::Registry) on GET /metrics, in the Prometheus text format.
+/// Must run on the reactor thread of the metric sources
+class MetricsServer {
+public:
+    MetricsServer(io::Reactor& reactor, io::Address bindAddress);
+
+private:
+    void on_stream_accepted(io::TcpStream::Ptr&& newStream, io::ErrorCode errorCode);
+    bool on_request(uint64_t id, const HttpMsgReader::Message& msg);
+    bool send(HttpConnection& conn, int code, const char* message, const std::string& body);
+
+    HttpMsgCreator _msgCreator;
+    io::TcpServer::Ptr _server;
+    std::map<uint64_t, HttpConnection::Ptr> _connections;
+    std::string _body;
+};
+
+} //namespace
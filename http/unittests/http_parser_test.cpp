@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #include "http/http_msg_reader.h"
+#include "http/http_msg_creator.h"
 #include "utility/helpers.h"
 #include "utility/logger.h"
 
@@ -277,6 +278,31 @@ int test_query_strings() {
     return errors;
 }
 
+int test_accept_encoding() {
+    int errors = 0;
+
+    if (!HttpMsgCreator::accepts_gzip("gzip")) ++errors;
+    if (!HttpMsgCreator::accepts_gzip("deflate, gzip;q=1.0, br")) ++errors;
+    if (!HttpMsgCreator::accepts_gzip("br;q=1.0, *;q=0.5")) ++errors;
+    if (HttpMsgCreator::accepts_gzip("")) ++errors;
+    if (HttpMsgCreator::accepts_gzip("deflate, br")) ++errors;
+    if (HttpMsgCreator::accepts_gzip("gzip;q=0")) ++errors;
+    if (HttpMsgCreator::accepts_gzip("xgzip")) ++errors;
+
+    std::string s;
+    for (int i = 0; i < 1000; i++)
+        s += "{\"height\":" + std::to_string(i) + "},";
+
+    io::SerializedMsg body, out;
+    body.emplace_back(s.c_str(), s.size() / 2);
+    body.emplace_back(s.c_str() + s.size() / 2, s.size() - s.size() / 2);
+
+    if (!HttpMsgCreator::gzip_body(out, body, 100) || (out.size() != 1) || (out[0].size >= s.size())) ++errors;
+    if (HttpMsgCreator::gzip_body(out, body, s.size() + 1)) ++errors; // below the threshold
+
+    return REPORT(errors);
+}
+
 } //namespace
 
 int main() {
@@ -292,6 +318,7 @@ int main() {
         retCode += test_multiple();
         retCode += test_chunked();
         retCode += test_query_strings();
+        retCode += test_accept_encoding();
     } catch (const exception& e) {
         BEAM_LOG_ERROR() << e.what();
         retCode = 255;
@@ -1563,16 +1563,23 @@ static void RangeProof_Calculate_S(RangeProof* const p, RangeProof_Worker* const
 	// Each element size is sizeof(secp256k1_scalar) + sizeof(MultiMac_WNaf) == 34 bytes
 	//
 	// This requires of 4.25K stack memory
+	//
+	// Each extra iteration costs 256 point doublings, so the target may define BeamCrypto_RangeproofNaggle
+	// to the largest value that fits its stack budget (i.e. 43 would take 3 iterations, 64 - 2 iterations).
+	// Doesn't affect the secure part: rho is always multiplied within the 1st iteration.
 #define nDims (sizeof(Amount) * 8)
 #define Calc_S_Naggle_Max (nDims * 2)
 
-#ifdef BeamCrypto_ScarceStack
+#ifdef BeamCrypto_RangeproofNaggle
+#	define Calc_S_Naggle BeamCrypto_RangeproofNaggle
+#elif defined(BeamCrypto_ScarceStack)
 #	define Calc_S_Naggle 22 // would take 6 iterations
 #else // BeamCrypto_ScarceStack
 #	define Calc_S_Naggle Calc_S_Naggle_Max // use max
 #endif // BeamCrypto_ScarceStack
 
 	static_assert(Calc_S_Naggle <= Calc_S_Naggle_Max, "Naggle too large");
+	static_assert(Calc_S_Naggle > 0, "Naggle too small");
 
 #ifdef BeamCrypto_ExternalGej
 
@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #include <iostream>
+#include <chrono>
 
 #include "../core/ecc_native.h"
 #include "../core/block_crypt.h"
@@ -1650,7 +1651,202 @@ void TestKeyKeeperTxs()
 	verify_test(kkw.InvokeOnBoth(mS) != KeyKeeperHwEmu::Status::Success); // Sender Phase2 can be called only once, the slot must have been invalidated
 }
 
-int main()
+/////////////////////////////////////////////
+// Benchmark
+//
+// Run as "hw_crypto_test bench". Prints the time and ops/sec per kernel, and the approximate stack high-water mark.
+// The hw_crypto code doesn't use heap, all its working memory is on the stack, hence this is the metric to watch for the signer firmware.
+// The same kernels are built for the device profile (BeamCrypto_ScarceStack) by the hw_crypto_test_scarce target.
+
+#ifdef _MSC_VER
+#	define BENCHMARK_NOINLINE __declspec(noinline)
+#else // _MSC_VER
+#	define BENCHMARK_NOINLINE __attribute__((noinline))
+#endif // _MSC_VER
+
+struct BenchmarkMeter
+{
+	const char* m_sz;
+
+	uint64_t m_Start;
+	uint64_t m_Cycles;
+
+	uint32_t N;
+
+	static uint64_t get_Time()
+	{
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+	BenchmarkMeter(const char* sz)
+		:m_sz(sz)
+		,m_Cycles(0)
+		,N(1)
+	{
+		m_Start = get_Time();
+	}
+
+	bool ShouldContinue()
+	{
+		m_Cycles += N;
+
+		double dt_s = double(get_Time() - m_Start) * 1e-9;
+		if (dt_s >= 1.)
+		{
+			printf("%-24s: %10.2f us, %10.2f ops/sec", m_sz, dt_s * 1e6 / double(m_Cycles), double(m_Cycles) / dt_s);
+			return false;
+		}
+
+		if (dt_s < 0.5)
+			N <<= 1;
+
+		return true;
+	}
+};
+
+struct StackMeter
+{
+	// Paint the stack area below the caller frame, run the kernel once, and see how deep it was overwritten.
+	static const uint32_t s_Size = 0x10000;
+	static const uint8_t s_Pattern = 0xa5;
+
+	static const volatile uint8_t* s_pArea;
+
+	static BENCHMARK_NOINLINE void Paint()
+	{
+		volatile uint8_t pArea[s_Size];
+		for (uint32_t i = 0; i < s_Size; i++)
+			pArea[i] = s_Pattern;
+
+		s_pArea = pArea;
+	}
+
+	static uint32_t get_Used()
+	{
+		// assume the stack grows down
+		uint32_t i = 0;
+		for (; i < s_Size; i++)
+			if (s_Pattern != s_pArea[i])
+				break;
+
+		return s_Size - i;
+	}
+
+	template <typename TFunc>
+	static void Print(const TFunc& func)
+	{
+		Paint();
+		func();
+		printf(", stack: %u bytes\n", get_Used());
+	}
+};
+
+const volatile uint8_t* StackMeter::s_pArea = nullptr;
+
+template <typename TFunc>
+void RunBenchmarkKernel(const char* sz, const TFunc& func)
+{
+	BenchmarkMeter bm(sz);
+	do
+	{
+		for (uint32_t i = 0; i < bm.N; i++)
+			func();
+
+	} while (bm.ShouldContinue());
+
+	StackMeter::Print(func);
+}
+
+void RunBenchmark()
+{
+#ifdef BeamCrypto_ScarceStack
+	printf("Benchmark (scarce stack)...\n");
+#else // BeamCrypto_ScarceStack
+	printf("Benchmark...\n");
+#endif // BeamCrypto_ScarceStack
+
+	ECC::Hash::Value hv;
+	ECC::GenRandom(hv);
+
+	hw::Kdf kdf;
+	hw::Kdf_Init(&kdf, &Ecc2BC(hv));
+
+	ECC::Scalar::Native sk;
+	SetRandom(sk);
+
+	RunBenchmarkKernel("Kdf.Init", [&]() {
+		hw::Kdf kdf2;
+		hw::Kdf_Init(&kdf2, &Ecc2BC(hv));
+	});
+
+	RunBenchmarkKernel("Kdf.getChild", [&]() {
+		hw::Kdf kdf2;
+		hw::Kdf_getChild(&kdf2, 12, &kdf);
+	});
+
+	RunBenchmarkKernel("Kdf.Derive.SKey", [&]() {
+		hw::Kdf_Derive_SKey(&kdf, &Ecc2BC(hv), &sk.get_Raw());
+	});
+
+	hw::CoinID cid;
+	ZeroObject(cid);
+	cid.m_Amount = 100500;
+	cid.m_Idx = 34;
+
+	hw::CompactPoint comm;
+
+	RunBenchmarkKernel("CoinID.getSkComm", [&]() {
+		hw::CoinID_getSkComm(&kdf, &cid, &sk.get_Raw(), &comm);
+	});
+
+	hw::Signature sig;
+	ECC::Point::Native pkN = ECC::Context::get().G * sk;
+	ECC::Point pk = pkN;
+
+	RunBenchmarkKernel("Signature.Sign", [&]() {
+		hw::Signature_Sign(&sig, &Ecc2BC(hv), &sk.get_Raw());
+	});
+
+	RunBenchmarkKernel("Signature.Verify", [&]() {
+		verify_test(hw::Signature_IsValid(&sig, &Ecc2BC(hv), &Ecc2BC(pk)));
+	});
+
+	hw::CompactPoint pT[2];
+	for (uint32_t i = 0; i < _countof(pT); i++)
+	{
+		ECC::Point::Native ptN;
+		SetRandom(ptN);
+		ECC::Point pt = ptN;
+		pT[i] = Ecc2BC(pt);
+	}
+
+	hw::CompactPoint pTOut[2];
+
+	hw::RangeProof rp;
+	rp.m_pKdf = &kdf;
+	rp.m_Cid = cid;
+	rp.m_pT_In = pT;
+	rp.m_pT_Out = pTOut;
+	rp.m_pKExtra = nullptr;
+	rp.m_pTauX = &sk.get_Raw();
+	rp.m_pAssetGen = nullptr;
+
+	RunBenchmarkKernel("RangeProof.Calculate", [&]() {
+		verify_test(hw::RangeProof_Calculate(&rp));
+	});
+
+	KeyKeeperWrap kkw(hv);
+
+	RunBenchmarkKernel("Shielded.Voucher", [&]() {
+		wallet::IPrivateKeyKeeper2::Method::CreateVoucherShielded m;
+		m.m_Count = 1;
+		m.m_iEndpoint = 12;
+		m.m_Nonce = 776U;
+		verify_test(Cast::Down<wallet::IPrivateKeyKeeper2>(kkw.m_kkEmu).InvokeSync(m) == wallet::IPrivateKeyKeeper2::Status::Success);
+	});
+}
+
+int main(int argc, char* argv[])
 {
 	Rules::get().CA.Enabled = true;
 	Rules::get().pForks[1].m_Height = g_hFork;
@@ -1682,6 +1878,9 @@ int main()
 	TestPKdfExport();
 	TestKeyKeeperTxs();
 
+	if ((argc > 1) && !strcmp(argv[1], "bench"))
+		RunBenchmark();
+
 	printf("All done\n");
 
 #ifdef BeamCrypto_ExternalGej
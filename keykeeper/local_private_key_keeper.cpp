@@ -16,6 +16,7 @@
 #include "core/shielded.h"
 #include "utility/logger.h"
 #include "utility/executor.h"
+#include <condition_variable>
 
 namespace beam::wallet
 {
@@ -29,6 +30,133 @@ namespace beam::wallet
     {
     }
 
+    struct LocalPrivateKeyKeeper2::Workers
+    {
+        struct Task
+            :public TaskFin
+        {
+            Key::IKdf::Ptr m_pKdf;
+            virtual void Exec() = 0;
+        };
+
+        LocalPrivateKeyKeeper2& m_This;
+        std::vector<MyThread> m_vThreads;
+
+        std::mutex m_MutexIn;
+        std::condition_variable m_NewIn;
+        TaskList m_queIn;
+        bool m_Run = true;
+
+        Workers(LocalPrivateKeyKeeper2& x, uint32_t nThreads)
+            :m_This(x)
+        {
+            m_vThreads.resize(nThreads);
+            for (auto& t : m_vThreads)
+                t = MyThread(&Workers::Thread, this, Rules::get());
+        }
+
+        ~Workers()
+        {
+            {
+                std::unique_lock<std::mutex> scope(m_MutexIn);
+                m_Run = false;
+                m_NewIn.notify_all();
+            }
+
+            for (auto& t : m_vThreads)
+                if (t.joinable())
+                    t.join();
+        }
+
+        void PushIn(Task::Ptr& p)
+        {
+            std::unique_lock<std::mutex> scope(m_MutexIn);
+            m_queIn.Push(p);
+            m_NewIn.notify_one();
+        }
+
+        void Thread(const Rules& r)
+        {
+            Rules::Scope scopeRules(r);
+
+            while (true)
+            {
+                Task::Ptr pTask;
+
+                {
+                    std::unique_lock<std::mutex> scope(m_MutexIn);
+                    while (true)
+                    {
+                        if (!m_Run)
+                            return;
+
+                        if (!m_queIn.empty())
+                        {
+                            m_queIn.Pop(pTask);
+                            break;
+                        }
+
+                        m_NewIn.wait(scope);
+                    }
+                }
+
+                Cast::Up<Task>(*pTask).Exec();
+                m_This.PushOut(pTask);
+            }
+        }
+    };
+
+    LocalPrivateKeyKeeper2::~LocalPrivateKeyKeeper2()
+    {
+        // the workers don't touch the derived object, only the kdf and the marshaller
+        m_pWorkers.reset();
+    }
+
+    void LocalPrivateKeyKeeper2::set_WorkerThreads(uint32_t n)
+    {
+        m_pWorkers.reset();
+        m_WorkerThreads = n;
+    }
+
+    template <typename TMethod>
+    void LocalPrivateKeyKeeper2::InvokeOnWorker(TMethod& m, const Handler::Ptr& pHandler)
+    {
+        struct MyTask :public Workers::Task {
+            TMethod* m_pM;
+            virtual void Exec() override { m_Status = InvokeStateless(m_pKdf, *m_pM); }
+        };
+
+        if (!m_pWorkers)
+        {
+            EnsureEvtOut(); // on the caller thread
+            m_pWorkers = std::make_unique<Workers>(*this, m_WorkerThreads);
+        }
+
+        Task::Ptr pTask = std::make_unique<MyTask>();
+        pTask->m_pHandler = pHandler;
+        Cast::Up<MyTask>(*pTask).m_pKdf = m_pKdf;
+        Cast::Up<MyTask>(*pTask).m_pM = &m;
+
+        m_pWorkers->PushIn(pTask);
+    }
+
+    void LocalPrivateKeyKeeper2::InvokeAsync(Method::CreateOutput& m, const Handler::Ptr& pHandler)
+    {
+        // the trustless check (see InvokeSync) is done here, on the caller thread
+        if (m_WorkerThreads && (!IsTrustless() || Rules::get().IsPastFork_<1>(m.m_hScheme)))
+            InvokeOnWorker(m, pHandler);
+        else
+            PrivateKeyKeeper_AsyncNotify::InvokeAsync(m, pHandler);
+    }
+
+    void LocalPrivateKeyKeeper2::InvokeAsync(Method::CreateInputShielded& m, const Handler::Ptr& pHandler)
+    {
+        if (!m_WorkerThreads)
+            PrivateKeyKeeper_AsyncNotify::InvokeAsync(m, pHandler);
+        else
+            InvokeOnWorker(m, pHandler);
+    }
+
     struct LocalPrivateKeyKeeper2::Aggregation
     {
         LocalPrivateKeyKeeper2& m_This;
@@ -280,17 +408,32 @@ namespace beam::wallet
                 return Status::Unspecified; // blinding factor can be tampered without user permission
         }
 
+        return InvokeStateless(m_pKdf, x);
+    }
+
+    IPrivateKeyKeeper2::Status::Type LocalPrivateKeyKeeper2::InvokeStateless(const Key::IKdf::Ptr& pKdf, Method::CreateOutput& x)
+    {
         x.m_pResult.reset(new Output);
 
         Asset::Proof::Params::Override po(x.m_AidMax);
 
+        // asset proof and rangeproof are generated in parallel
+        ExecutorMT_R exec;
+        exec.set_Threads(2);
+        Executor::Scope scope(exec);
+
         Scalar::Native sk;
-        x.m_pResult->Create(x.m_hScheme, sk, *x.m_Cid.get_ChildKdf(m_pKdf), x.m_Cid, *m_pKdf, Output::OpCode::Standard, &x.m_User);
+        x.m_pResult->Create(x.m_hScheme, sk, *x.m_Cid.get_ChildKdf(pKdf), x.m_Cid, *pKdf, Output::OpCode::Standard, &x.m_User);
 
         return Status::Success;
     }
 
     IPrivateKeyKeeper2::Status::Type LocalPrivateKeyKeeper2::InvokeSync(Method::CreateInputShielded& x)
+    {
+        return InvokeStateless(m_pKdf, x);
+    }
+
+    IPrivateKeyKeeper2::Status::Type LocalPrivateKeyKeeper2::InvokeStateless(const Key::IKdf::Ptr& pKdf, Method::CreateInputShielded& x)
     {
         assert(x.m_pKernel && x.m_pList);
 
@@ -299,10 +442,10 @@ namespace beam::wallet
         Lelantus::Prover prover(*x.m_pList, x.m_pKernel->m_SpendProof);
 
         ShieldedTxo::DataParams sdp;
-        sdp.Set(*m_pKdf, x);
+        sdp.Set(*pKdf, x);
 
         Key::IKdf::Ptr pSerialPrivate;
-        ShieldedTxo::Viewer::GenerateSerPrivate(pSerialPrivate, *m_pKdf, x.m_Key.m_nIdx);
+        ShieldedTxo::Viewer::GenerateSerPrivate(pSerialPrivate, *pKdf, x.m_Key.m_nIdx);
         pSerialPrivate->DeriveKey(prover.m_Witness.m_SpendSk, sdp.m_Ticket.m_SerialPreimage);
 
         prover.m_Witness.m_L = x.m_iIdx;
@@ -311,7 +454,7 @@ namespace beam::wallet
         prover.m_Witness.m_V = sdp.m_Output.m_Value;
 
         x.m_pKernel->UpdateMsg();
-        x.get_SkOut(prover.m_Witness.m_R_Output, x.m_pKernel->m_Fee, *m_pKdf);
+        x.get_SkOut(prover.m_Witness.m_R_Output, x.m_pKernel->m_Fee, *pKdf);
 
         ExecutorMT_R exec;
         Executor::Scope scope(exec);
@@ -30,9 +30,21 @@ namespace beam::wallet
 
         struct Aggregation;
 
+        // the heavy methods that only need the kdf, can run on any thread
+        static Status::Type InvokeStateless(const ECC::Key::IKdf::Ptr&, Method::CreateOutput&);
+        static Status::Type InvokeStateless(const ECC::Key::IKdf::Ptr&, Method::CreateInputShielded&);
+
+        struct Workers;
+        std::unique_ptr<Workers> m_pWorkers;
+        uint32_t m_WorkerThreads = 0;
+
+        template <typename TMethod>
+        void InvokeOnWorker(TMethod&, const Handler::Ptr&);
+
     public:
 
         LocalPrivateKeyKeeper2(const ECC::Key::IKdf::Ptr&);
+        ~LocalPrivateKeyKeeper2();
 
 #define THE_MACRO(method) \
         virtual Status::Type InvokeSync(Method::method& m) override;
@@ -40,6 +52,15 @@ namespace beam::wallet
         KEY_KEEPER_METHODS(THE_MACRO)
 #undef THE_MACRO
 
+        // Number of threads for the async creation of outputs and shielded inputs, so that many of them
+        // (large payouts) are built in parallel and don't block the caller. By default (0) they run on the caller thread.
+        // The threads are started on demand. Should be set before the async invocations
+        void set_WorkerThreads(uint32_t);
+
+        using PrivateKeyKeeper_AsyncNotify::InvokeAsync;
+        void InvokeAsync(Method::CreateOutput&, const Handler::Ptr&) override;
+        void InvokeAsync(Method::CreateInputShielded&, const Handler::Ptr&) override;
+
     protected:
 
         ECC::Key::IKdf::Ptr m_pKdf;
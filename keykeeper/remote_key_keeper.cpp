@@ -157,6 +157,44 @@ namespace beam::wallet
         return m_Slots;
     }
 
+    bool RemoteKeyKeeper::Cache::get_Kdf(Key::IPKdf::Ptr& pRes, KdfType eType)
+    {
+        if (KdfType::Root == eType)
+            return get_Owner(pRes);
+
+        pRes = m_pSbbs;
+        return pRes != nullptr;
+    }
+
+    void RemoteKeyKeeper::Cache::set_Kdf(const Key::IPKdf::Ptr& pRes, KdfType eType)
+    {
+        if (KdfType::Root == eType)
+            set_Owner(pRes);
+        else
+        {
+            if (!m_pSbbs)
+                m_pSbbs = pRes;
+        }
+    }
+
+    bool RemoteKeyKeeper::Cache::get_Commitment(ECC::Point& res, const ECC::Hash::Value& hvCid)
+    {
+        auto it = m_mapCommitments.find(hvCid);
+        if (m_mapCommitments.end() == it)
+            return false;
+
+        res = it->second;
+        return true;
+    }
+
+    void RemoteKeyKeeper::Cache::set_Commitment(const ECC::Point& res, const ECC::Hash::Value& hvCid)
+    {
+        if (m_mapCommitments.size() >= s_MaxCommitments)
+            m_mapCommitments.clear();
+
+        m_mapCommitments[hvCid] = res;
+    }
+
 
     RemoteKeyKeeper::Status::Type RemoteKeyKeeper::DeduceStatus(uint8_t* pBuf, uint32_t nResponse, uint32_t nResponseActual)
     {
@@ -203,6 +241,13 @@ namespace beam::wallet
 	    static Amount CalcTxBalance(Asset::ID* pAid, const Method::TxCommon&);
 	    static void CalcTxBalance(Amount&, Asset::ID* pAid, Amount, Asset::ID);
 
+        static bool IsPipelined(const Method::get_Kdf*) { return true; }
+        static bool IsPipelined(const Method::get_NumSlots*) { return true; }
+        static bool IsPipelined(const Method::get_Commitment*) { return true; }
+        static bool IsPipelined(const Method::CreateOutput*) { return true; }
+        template <typename TMethod>
+        static bool IsPipelined(const TMethod*) { return false; }
+
 
         struct RemoteCall
             :public IPrivateKeyKeeper2::Handler
@@ -499,12 +544,9 @@ namespace beam::wallet
         switch (m.m_Type)
         {
         case KdfType::Root:
-            if (m_Cache.get_Owner(m.m_pPKdf))
-                return Status::Success;
-
-            // no break;
-
         case KdfType::Sbbs:
+            if (m_Cache.get_Kdf(m.m_pPKdf, m.m_Type))
+                return Status::Success;
             break;
 
         default:
@@ -541,7 +583,7 @@ namespace beam::wallet
         {
             if (!m_Phase)
             {
-                if ((KdfType::Root == m_M.m_Type) && m_This.m_Cache.get_Owner(m_M.m_pPKdf))
+                if (m_This.m_Cache.get_Kdf(m_M.m_pPKdf, m_M.m_Type))
                 {
                     Fin();
                     return;
@@ -566,8 +608,7 @@ namespace beam::wallet
                 auto pPKdf = std::make_shared<ECC::HKdfPub>();
                 if (pPKdf->Import(p))
                 {
-                    if (KdfType::Root == m_M.m_Type)
-                        m_This.m_Cache.set_Owner(pPKdf);
+                    m_This.m_Cache.set_Kdf(pPKdf, m_M.m_Type);
 
                     m_M.m_pPKdf = std::move(pPKdf);
                     Fin();
@@ -658,6 +699,7 @@ namespace beam::wallet
         }
 
         Method::get_Commitment& m_M;
+        ECC::Hash::Value m_hvCid;
 
         void Update() override
         {
@@ -666,10 +708,17 @@ namespace beam::wallet
                 hw::Proto::GetImage::Out msg;
                 if (m_M.m_Cid.get_ChildKdfIndex(msg.m_iChild))
                 {
+                    m_M.m_Cid.get_Hash(m_hvCid);
+                    if (m_This.m_Cache.get_Commitment(m_M.m_Result, m_hvCid))
+                    {
+                        Fin();
+                        return;
+                    }
+
                     msg.m_bG = 1;
                     msg.m_bJ = 1;
 
-                    m_M.m_Cid.get_Hash(Cast::Reinterpret<ECC::Hash::Value>(msg.m_hvSrc));
+                    Cast::Reinterpret<ECC::Hash::Value>(msg.m_hvSrc) = m_hvCid;
 
                     SendReq_T(msg);
                 }
@@ -695,6 +744,7 @@ namespace beam::wallet
                 CoinID::Worker(m_M.m_Cid).Recover(ptG, ptJ);
 
                 ptG.Export(m_M.m_Result);
+                m_This.m_Cache.set_Commitment(m_M.m_Result, m_hvCid);
                 Fin();
             }
 
@@ -1701,7 +1751,8 @@ namespace beam::wallet
  \
     void RemoteKeyKeeper::InvokeAsync(Method::method& m, const Handler::Ptr& h) \
     { \
-        if (m_InProgress) \
+        bool bPipelined = Impl::IsPipelined(&m); \
+        if (!m_lstPending.empty() || !CanStart(bPipelined)) \
         { \
             struct MyPending :public Pending \
             { \
@@ -1712,34 +1763,54 @@ namespace beam::wallet
             m_lstPending.push_back(*p); \
             p->m_pMethod = &m; \
             p->m_pHandler = h; \
+            p->m_Pipelined = bPipelined; \
         } \
         else \
+        { \
+            OnStart(bPipelined); \
             InvokeAsyncStart(m, Handler::Ptr(h)); \
+        } \
     }
 
     KEY_KEEPER_METHODS(THE_MACRO)
 #undef THE_MACRO
 
+    bool RemoteKeyKeeper::CanStart(bool bPipelined) const
+    {
+        if (!m_InProgress)
+            return true;
+
+        return bPipelined && !m_Exclusive && (m_InProgress < s_MaxPipelined);
+    }
+
+    void RemoteKeyKeeper::OnStart(bool bPipelined)
+    {
+        if (!m_InProgress)
+            m_Exclusive = !bPipelined;
+    }
+
     void RemoteKeyKeeper::CheckPending()
     {
-        while (!m_lstPending.empty() && !m_InProgress)
+        if (m_CheckingPending)
+            return; // the call started below has completed immediately
+
+        struct RecursionPreventor {
+            bool& m_Var;
+            RecursionPreventor(bool& var) :m_Var(var) { m_Var = true; }
+            ~RecursionPreventor() { m_Var = false; }
+
+        } rp(m_CheckingPending);
+
+        // in order, the exclusive call waits for the pipelined ones and blocks those after it
+        while (!m_lstPending.empty() && CanStart(m_lstPending.front().m_Pipelined))
         {
             auto& x = m_lstPending.front();
             std::unique_ptr<Pending> pGuard(&x);
             m_lstPending.pop_front();
 
             assert(x.m_pHandler);
-            //if (x.m_pHandler.use_count() > 1) // already cancelled?
-            {
-                struct RecursionPreventor {
-                    uint32_t& m_Var;
-                    RecursionPreventor(uint32_t& var) :m_Var(var) { m_Var++;  }
-                    ~RecursionPreventor() { m_Var--; }
-
-                } rp(m_InProgress);
-
-                x.Start(*this);
-            }
+            OnStart(x.m_Pipelined);
+            x.Start(*this);
         }
     }
 }
@@ -31,6 +31,7 @@ namespace beam::wallet
             typedef intrusive::list_autoclear<Pending> List;
 
             Handler::Ptr m_pHandler;
+            bool m_Pipelined;
 
             virtual ~Pending() {}
             virtual void Start(RemoteKeyKeeper&) = 0;
@@ -38,8 +39,16 @@ namespace beam::wallet
 
         Pending::List m_lstPending;
         void CheckPending();
+        bool CanStart(bool bPipelined) const;
+        void OnStart(bool bPipelined);
+
+        // Calls that neither depend on nor change the device state (get_Kdf, get_Commitment, CreateOutput) are pipelined:
+        // the next one is sent while the previous is computed locally. Others run exclusively
+        static const uint32_t s_MaxPipelined = 16; // calls in progress, including the nested ones
 
         uint32_t m_InProgress = 0;
+        bool m_Exclusive = false;
+        bool m_CheckingPending = false;
 
 #define THE_MACRO(method) \
         void InvokeAsyncStart(Method::method& m, Handler::Ptr&&);
@@ -73,12 +82,23 @@ namespace beam::wallet
             //std::mutex m_Mutex;
 
             Key::IPKdf::Ptr m_pOwner;
+            Key::IPKdf::Ptr m_pSbbs;
 
             uint32_t m_Slots = 0;
             uint32_t get_NumSlots();
 
             bool get_Owner(Key::IPKdf::Ptr&);
             void set_Owner(const Key::IPKdf::Ptr&);
+
+            bool get_Kdf(Key::IPKdf::Ptr&, KdfType);
+            void set_Kdf(const Key::IPKdf::Ptr&, KdfType);
+
+            // commitments computed by the device, by the CoinID hash. Bounded, reset when full
+            static const size_t s_MaxCommitments = 4096;
+            std::map<ECC::Hash::Value, ECC::Point> m_mapCommitments;
+
+            bool get_Commitment(ECC::Point&, const ECC::Hash::Value&);
+            void set_Commitment(const ECC::Point&, const ECC::Hash::Value&);
         };
 
         Cache m_Cache;
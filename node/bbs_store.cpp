@@ -0,0 +1,233 @@
+// Copyright 2018 The Beam Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "bbs_store.h"
+
+namespace beam {
+
+void BbsStore::Element::Export(Data& d) const
+{
+	d.m_Key = m_ByKey.m_Key;
+	d.m_Channel = m_ByChannel.m_Key.m_Channel;
+	d.m_TimePosted = m_TimePosted;
+	d.m_Message = Blob(m_Message);
+	d.m_Nonce = m_Nonce;
+}
+
+BbsStore::Element* BbsStore::Find(const Key& key)
+{
+	KeySet::iterator it = m_setKeys.find(key, Element::ByKey::Comparator());
+	return (m_setKeys.end() == it) ? nullptr : &it->get_ParentObj();
+}
+
+BbsStore::Element* BbsStore::Insert(const Data& d)
+{
+	assert(!Find(d.m_Key));
+
+	Element* p = new Element;
+	p->m_TimePosted = d.m_TimePosted;
+	p->m_Nonce = d.m_Nonce;
+	d.m_Message.Export(p->m_Message);
+
+	p->m_ByKey.m_Key = d.m_Key;
+	p->m_BySeq.m_Key = ++m_LastID;
+	p->m_ByChannel.m_Key.m_Channel = d.m_Channel;
+	p->m_ByChannel.m_Key.m_ID = m_LastID;
+
+	m_setKeys.insert(p->m_ByKey);
+	m_setSeq.insert(m_setSeq.end(), p->m_BySeq);
+	m_setChannel.insert(p->m_ByChannel);
+	m_mapBuckets[get_BucketIdx(d.m_TimePosted)].push_back(p->m_InBucket);
+
+	m_Totals.m_Count++;
+	m_Totals.m_Size += d.m_Message.n;
+
+	return p;
+}
+
+void BbsStore::DeleteInternal(Element& x)
+{
+	m_setKeys.erase(KeySet::s_iterator_to(x.m_ByKey));
+	m_setSeq.erase(SeqSet::s_iterator_to(x.m_BySeq));
+	m_setChannel.erase(ChannelSet::s_iterator_to(x.m_ByChannel));
+
+	m_Totals.m_Count--;
+	m_Totals.m_Size -= x.m_Message.size();
+
+	delete &x;
+}
+
+void BbsStore::Delete(Element& x)
+{
+	BucketMap::iterator it = m_mapBuckets.find(get_BucketIdx(x.m_TimePosted));
+	assert(m_mapBuckets.end() != it);
+
+	it->second.erase(Bucket::s_iterator_to(x.m_InBucket));
+	if (it->second.empty())
+		m_mapBuckets.erase(it);
+
+	DeleteInternal(x);
+}
+
+void BbsStore::DeleteOlder(Timestamp ts)
+{
+	Timestamp iBucketLast = get_BucketIdx(ts);
+
+	while (!m_mapBuckets.empty())
+	{
+		BucketMap::iterator it = m_mapBuckets.begin();
+		if (it->first > iBucketLast)
+			break;
+
+		Bucket& b = it->second;
+
+		if (it->first < iBucketLast)
+		{
+			// the whole bucket is older
+			while (!b.empty())
+			{
+				Element& x = b.front().get_ParentObj();
+				b.pop_front();
+				DeleteInternal(x);
+			}
+		}
+		else
+		{
+			// partially
+			for (Bucket::iterator itB = b.begin(); b.end() != itB; )
+			{
+				Element& x = (itB++)->get_ParentObj();
+				if (x.m_TimePosted < ts)
+				{
+					b.erase(Bucket::s_iterator_to(x.m_InBucket));
+					DeleteInternal(x);
+				}
+			}
+
+			if (!b.empty())
+				break;
+		}
+
+		m_mapBuckets.erase(it);
+	}
+}
+
+void BbsStore::Clear()
+{
+	for (BucketMap::iterator it = m_mapBuckets.begin(); m_mapBuckets.end() != it; ++it)
+	{
+		Bucket& b = it->second;
+		while (!b.empty())
+		{
+			Element& x = b.front().get_ParentObj();
+			b.pop_front();
+			DeleteInternal(x);
+		}
+	}
+
+	m_mapBuckets.clear();
+	assert(!m_Totals.m_Count);
+}
+
+uint64_t BbsStore::FindCursor(Timestamp ts) const
+{
+	uint64_t id = m_LastID + 1;
+
+	for (BucketMap::const_iterator it = m_mapBuckets.lower_bound(get_BucketIdx(ts)); m_mapBuckets.end() != it; ++it)
+	{
+		const Bucket& b = it->second;
+		for (Bucket::const_iterator itB = b.begin(); b.end() != itB; ++itB)
+		{
+			const Element& x = itB->get_ParentObj();
+			if (x.m_TimePosted >= ts)
+			{
+				// the bucket is in the arrival order, the rest is newer
+				std::setmin(id, x.get_ID());
+				break;
+			}
+		}
+	}
+
+	return id;
+}
+
+BbsStore::Element* BbsStore::get_Next(uint64_t id)
+{
+	SeqSet::iterator it = m_setSeq.upper_bound(id, Element::BySeq::Comparator());
+	return (m_setSeq.end() == it) ? nullptr : &it->get_ParentObj();
+}
+
+BbsStore::Element* BbsStore::get_Next(BbsChannel ch, uint64_t id)
+{
+	ChannelSeq key;
+	key.m_Channel = ch;
+	key.m_ID = id;
+
+	ChannelSet::iterator it = m_setChannel.upper_bound(key, Element::ByChannel::Comparator());
+	if (m_setChannel.end() == it)
+		return nullptr;
+
+	Element& x = it->get_ParentObj();
+	return (x.m_ByChannel.m_Key.m_Channel == ch) ? &x : nullptr;
+}
+
+BbsStore::Element* BbsStore::get_Oldest()
+{
+	return m_setSeq.empty() ? nullptr : &m_setSeq.begin()->get_ParentObj();
+}
+
+Timestamp BbsStore::get_MaxTime() const
+{
+	if (m_mapBuckets.empty())
+		return 0;
+
+	Timestamp ts = 0;
+	const Bucket& b = m_mapBuckets.rbegin()->second;
+	for (Bucket::const_iterator it = b.begin(); b.end() != it; ++it)
+		std::setmax(ts, it->get_ParentObj().m_TimePosted);
+
+	return ts;
+}
+
+uint64_t BbsStore::get_MemSize() const
+{
+	// the map nodes are shared by many messages, negligible
+	return m_Totals.m_Size + m_Totals.m_Count * static_cast<uint64_t>(sizeof(Element));
+}
+
+void BbsStore::Load(NodeDB& db)
+{
+	NodeDB::WalkerBbs wlk;
+	for (db.EnumAllBbsData(wlk); wlk.MoveNext(); )
+		if (!Find(wlk.m_Data.m_Key))
+			Insert(wlk.m_Data);
+}
+
+void BbsStore::Save(NodeDB& db)
+{
+	NodeDB::Transaction t(db);
+
+	db.BbsDelAll();
+
+	Data d;
+	for (SeqSet::iterator it = m_setSeq.begin(); m_setSeq.end() != it; ++it)
+	{
+		it->get_ParentObj().Export(d);
+		db.BbsIns(d);
+	}
+
+	t.Commit();
+}
+
+} // namespace beam
@@ -0,0 +1,116 @@
+// Copyright 2018 The Beam Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include "db.h"
+#include "../utility/containers.h"
+#include <map>
+
+namespace beam {
+
+// In-memory store of the BBS messages.
+// Indexed by the key, by the arrival order (ID, assigned sequentially), and by channel and ID.
+// For the expiration the messages are grouped in buckets by the posted time, an expired bucket is dropped as a whole.
+// The DB is used only to keep the messages across restarts (Load/Save).
+class BbsStore
+{
+public:
+	typedef NodeDB::WalkerBbs::Key Key;
+	typedef NodeDB::WalkerBbs::Data Data;
+
+	static const Timestamp s_Bucket_s = 60;
+
+	struct ChannelSeq
+	{
+		BbsChannel m_Channel;
+		uint64_t m_ID;
+
+		bool operator < (const ChannelSeq& x) const {
+			return (m_Channel != x.m_Channel) ? (m_Channel < x.m_Channel) : (m_ID < x.m_ID);
+		}
+	};
+
+	struct Element
+	{
+		struct ByKey
+			:public intrusive::set_base_hook<Key>
+		{
+			IMPLEMENT_GET_PARENT_OBJ(Element, m_ByKey)
+		} m_ByKey;
+
+		struct BySeq
+			:public intrusive::set_base_hook<uint64_t>
+		{
+			IMPLEMENT_GET_PARENT_OBJ(Element, m_BySeq)
+		} m_BySeq;
+
+		struct ByChannel
+			:public intrusive::set_base_hook<ChannelSeq>
+		{
+			IMPLEMENT_GET_PARENT_OBJ(Element, m_ByChannel)
+		} m_ByChannel;
+
+		struct InBucket
+			:public boost::intrusive::list_base_hook<>
+		{
+			IMPLEMENT_GET_PARENT_OBJ(Element, m_InBucket)
+		} m_InBucket;
+
+		Timestamp m_TimePosted;
+		uint32_t m_Nonce;
+		ByteBuffer m_Message;
+
+		uint64_t get_ID() const { return m_BySeq.m_Key; }
+		void Export(Data&) const; // the message points to the element
+	};
+
+	typedef boost::intrusive::multiset<Element::ByKey> KeySet;
+	typedef boost::intrusive::multiset<Element::BySeq> SeqSet;
+	typedef boost::intrusive::multiset<Element::ByChannel> ChannelSet;
+	typedef boost::intrusive::list<Element::InBucket> Bucket;
+	typedef std::map<Timestamp, Bucket> BucketMap; // by posted time / s_Bucket_s, each in the arrival order
+
+	KeySet m_setKeys;
+	SeqSet m_setSeq;
+	ChannelSet m_setChannel;
+	BucketMap m_mapBuckets;
+
+	NodeDB::BbsTotals m_Totals = { 0, 0 }; // messages and their size
+	uint64_t m_LastID = 0;
+
+	~BbsStore() { Clear(); }
+
+	Element* Find(const Key&);
+	Element* Insert(const Data&); // the key must be unique (if not sure - first try to find it)
+	void Delete(Element&);
+	void DeleteOlder(Timestamp); // posted before it
+	void Clear();
+
+	uint64_t FindCursor(Timestamp) const; // lowest ID of the messages posted at or after it, LastID + 1 if none
+	Element* get_Next(uint64_t id); // in the arrival order
+	Element* get_Next(BbsChannel, uint64_t id);
+	Element* get_Oldest(); // by arrival
+	Timestamp get_MaxTime() const;
+	uint64_t get_MemSize() const; // estimated
+
+	void Load(NodeDB&);
+	void Save(NodeDB&); // replaces the DB contents
+
+private:
+	static Timestamp get_BucketIdx(Timestamp t) { return t / s_Bucket_s; }
+	void DeleteInternal(Element&);
+};
+
+} // namespace beam
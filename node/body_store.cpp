@@ -0,0 +1,202 @@
+// Copyright 2018 The Beam Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "body_store.h"
+#include "../utility/common.h"
+
+namespace beam {
+
+const char* BodyStore::Column::get_Suffix(Enum e)
+{
+	switch (e)
+	{
+	case Perishable: return "bp";
+	case Eternal: return "be";
+	case Rollback: return "rb";
+	default: // suppress warning
+		break;
+	}
+
+	return "";
+}
+
+std::string BodyStore::get_Path(const std::string& sBase, Column::Enum eCol, uint32_t iSeg)
+{
+	char sz[0x20];
+	snprintf(sz, _countof(sz), ".%s.%05u", Column::get_Suffix(eCol), iSeg);
+	return sBase + sz;
+}
+
+void BodyStore::Open(const char* szPathBase, const Bounds& b)
+{
+	Close();
+	m_sPathBase = szPathBase;
+	m_Bounds = b;
+}
+
+void BodyStore::Close()
+{
+	for (uint32_t i = 0; i < Column::count; i++)
+		m_pSegs[i].clear();
+
+	m_sPathBase.clear();
+	m_bRolledOver = false;
+}
+
+BodyStore::Segment& BodyStore::get_Segment(Column::Enum eCol, uint32_t iSeg, bool bCreate)
+{
+	assert(IsOpen());
+	SegmentMap& m = m_pSegs[eCol];
+
+	auto it = m.find(iSeg);
+	if (m.end() != it)
+		return *it->second;
+
+	auto pSeg = std::make_unique<Segment>();
+	pSeg->m_File.Open(get_Path(m_sPathBase, eCol, iSeg).c_str());
+
+	if (pSeg->m_File.m_nMapping != s_SegmentSize)
+	{
+		if (!bCreate)
+			throw std::runtime_error("Body store segment missing or truncated");
+
+		// preallocate, the whole segment is mapped at once, so that the mapping is never moved
+		pSeg->m_File.CloseMapping();
+		pSeg->m_File.Resize(s_SegmentSize);
+		pSeg->m_File.OpenMapping();
+	}
+
+	Segment& seg = *pSeg;
+	m[iSeg] = std::move(pSeg);
+	return seg;
+}
+
+uint64_t BodyStore::Append(Column::Enum eCol, const Blob& x)
+{
+	uint64_t nSize = sizeof(uint32_t) + static_cast<uint64_t>(x.n);
+	if (nSize > s_SegmentSize)
+		throw std::runtime_error("Body store record too large");
+
+	uint64_t& hi = m_Bounds.m_pHi[eCol];
+
+	uint64_t nOffset = hi % s_SegmentSize;
+	if (nOffset + nSize > s_SegmentSize)
+	{
+		// records don't cross segments
+		hi += s_SegmentSize - nOffset;
+		nOffset = 0;
+	}
+
+	if (!nOffset && (hi > m_Bounds.m_pLo[eCol]))
+		m_bRolledOver = true;
+
+	Segment& seg = get_Segment(eCol, static_cast<uint32_t>(hi / s_SegmentSize), true);
+
+	uint8_t* p = seg.m_File.m_pMapping + nOffset;
+	memcpy(p, &x.n, sizeof(x.n));
+	if (x.n)
+		memcpy(p + sizeof(x.n), x.p, x.n);
+
+	seg.m_Dirty = true;
+
+	uint64_t ref = hi;
+	hi += nSize;
+	return ref;
+}
+
+Blob BodyStore::get_At(Column::Enum eCol, uint64_t ref)
+{
+	if ((ref < m_Bounds.m_pLo[eCol]) || (ref >= m_Bounds.m_pHi[eCol]))
+		throw std::runtime_error("Body store ref out of bounds");
+
+	Segment& seg = get_Segment(eCol, static_cast<uint32_t>(ref / s_SegmentSize), false);
+
+	uint64_t nOffset = ref % s_SegmentSize;
+	if (nOffset + sizeof(uint32_t) > s_SegmentSize)
+		throw std::runtime_error("Body store ref invalid");
+
+	const uint8_t* p = seg.m_File.m_pMapping + nOffset;
+
+	Blob res;
+	memcpy(&res.n, p, sizeof(res.n));
+	if (nOffset + sizeof(uint32_t) + res.n > s_SegmentSize)
+		throw std::runtime_error("Body store record invalid");
+
+	res.p = p + sizeof(uint32_t);
+	return res;
+}
+
+void BodyStore::Flush()
+{
+	for (uint32_t i = 0; i < Column::count; i++)
+	{
+		for (auto& x : m_pSegs[i])
+		{
+			Segment& seg = *x.second;
+			if (seg.m_Dirty)
+			{
+				seg.m_File.Flush();
+				seg.m_Dirty = false;
+			}
+		}
+	}
+}
+
+void BodyStore::DeleteBelow(Column::Enum eCol, uint64_t refMin)
+{
+	uint64_t& lo = m_Bounds.m_pLo[eCol];
+	const uint64_t hi = m_Bounds.m_pHi[eCol];
+
+	std::setmin(refMin, hi);
+	refMin -= refMin % s_SegmentSize;
+
+	for (; lo < refMin; lo += s_SegmentSize)
+	{
+		uint32_t iSeg = static_cast<uint32_t>(lo / s_SegmentSize);
+		m_pSegs[eCol].erase(iSeg);
+		DeleteFile(get_Path(m_sPathBase, eCol, iSeg).c_str());
+	}
+}
+
+void BodyStore::CopyFiles(const char* szSrcBase, const char* szDstBase, const Bounds& b)
+{
+	std::string sSrc(szSrcBase), sDst(szDstBase);
+	ByteBuffer buf(1024 * 1024);
+
+	for (uint32_t i = 0; i < Column::count; i++)
+	{
+		auto eCol = static_cast<Column::Enum>(i);
+		if (b.m_pHi[i] <= b.m_pLo[i])
+			continue;
+
+		uint32_t iSeg0 = static_cast<uint32_t>(b.m_pLo[i] / s_SegmentSize);
+		uint32_t iSeg1 = static_cast<uint32_t>((b.m_pHi[i] - 1) / s_SegmentSize);
+
+		for (uint32_t iSeg = iSeg0; iSeg <= iSeg1; iSeg++)
+		{
+			std::FStream fSrc, fDst;
+			fSrc.Open(get_Path(sSrc, eCol, iSeg).c_str(), true, true);
+			fDst.Open(get_Path(sDst, eCol, iSeg).c_str(), false, true);
+
+			while (fSrc.get_Remaining())
+			{
+				size_t n = static_cast<size_t>(std::min<uint64_t>(fSrc.get_Remaining(), buf.size()));
+				fSrc.read(&buf.front(), n);
+				fDst.write(&buf.front(), n);
+			}
+		}
+	}
+}
+
+} // namespace beam
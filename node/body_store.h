@@ -0,0 +1,83 @@
+// Copyright 2018 The Beam Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include "../core/mapped_file.h"
+#include "../core/block_crypt.h"
+#include <map>
+
+namespace beam {
+
+// Append-only store for block bodies and rollback data, outside of the DB.
+// Each column is a sequence of fixed-size memory-mapped segment files. A record is referenced by its global offset (ref), the DB keeps only refs.
+// Records are never modified. A segment file is deleted once none of its records is referenced.
+class BodyStore
+{
+public:
+
+	struct Column
+	{
+		enum Enum {
+			Perishable,
+			Eternal,
+			Rollback,
+			count
+		};
+
+		static const char* get_Suffix(Enum);
+	};
+
+	static const uint64_t s_SegmentSize = 64 * 1024 * 1024;
+
+	struct Bounds
+	{
+		uint64_t m_pLo[Column::count]; // start of the first existing segment
+		uint64_t m_pHi[Column::count]; // next append position
+	};
+
+	void Open(const char* szPathBase, const Bounds&);
+	void Close();
+	bool IsOpen() const { return !m_sPathBase.empty(); }
+
+	uint64_t Append(Column::Enum, const Blob&);
+	Blob get_At(Column::Enum, uint64_t ref); // points into the mapping, remains valid while the store is open
+	void Flush(); // sync the segments modified since the last flush
+
+	const Bounds& get_Bounds() const { return m_Bounds; }
+
+	bool m_bRolledOver = false; // new segment(s) started, the old ones may be unreferenced
+	void DeleteBelow(Column::Enum, uint64_t refMin); // delete the segments that lie entirely below the given ref
+
+	static void CopyFiles(const char* szSrcBase, const char* szDstBase, const Bounds&);
+
+private:
+
+	struct Segment
+	{
+		MappedFileRaw m_File;
+		bool m_Dirty = false;
+	};
+
+	typedef std::map<uint32_t, std::unique_ptr<Segment> > SegmentMap;
+
+	std::string m_sPathBase;
+	Bounds m_Bounds;
+	SegmentMap m_pSegs[Column::count];
+
+	static std::string get_Path(const std::string& sBase, Column::Enum, uint32_t iSeg);
+	Segment& get_Segment(Column::Enum, uint32_t iSeg, bool bCreate);
+};
+
+} // namespace beam
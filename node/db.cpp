@@ -17,7 +17,11 @@
 #include "../core/peer_manager.h"
 #include "../utility/logger.h"
 #include "../utility/byteorder.h"
+#include "../utility/metrics.h"
 #include <algorithm>
+#include <thread>
+#include <mutex>
+#include <atomic>
 
 namespace beam {
 
@@ -76,6 +80,8 @@ namespace beam {
 #define TblPeer_Rating			"Rating"
 #define TblPeer_Addr			"Address"
 #define TblPeer_LastSeen		"LastSeen"
+#define TblPeer_Rtt				"Rtt"
+#define TblPeer_LastGood		"LastGood"
 
 #define TblBbs					"Bbs"
 #define TblBbs_ID				"ID"
@@ -94,6 +100,10 @@ namespace beam {
 #define TblTxo_Value			"Value"
 #define TblTxo_SpendHeight		"SpendHeight"
 
+#define TblTxoFull				"TxoFull"
+#define TblTxoFull_ID			"ID"
+#define TblTxoFull_Value		"Value"
+
 #define TblStreams				"Streams"
 #define TblStream_ID			"ID"
 #define TblStream_Value			"Value"
@@ -116,6 +126,7 @@ namespace beam {
 #define TblAssetEvts_Height		"Height"
 #define TblAssetEvts_Index		"Seq"
 #define TblAssetEvts_Data		"Data"
+#define TblIdxAssetEvts_1		"[Idx" TblAssetEvts "_1" "] ON [" TblAssetEvts "] ([" TblAssetEvts_ID "],[" TblAssetEvts_Height  "],[" TblAssetEvts_Index "])"
 
 #define TblShieldedStatistic			"ShieldedStatistic"
 #define TblShieldedStatistic_Height		"Height"
@@ -129,6 +140,7 @@ namespace beam {
 #define TblContractLogs_Pos		"Pos"
 #define TblContractLogs_Key		"Key"
 #define TblContractLogs_Data	"Data"
+#define TblIdxContractLogs_Key	"[Idx" TblContractLogs "_Key" "] ON [" TblContractLogs "] ([" TblContractLogs_Key "],[" TblContractLogs_Pos "])"
 
 #define TblCache				"Cache"
 #define TblCache_Key			"Key"
@@ -139,6 +151,7 @@ namespace beam {
 #define TblKrnInfo_Pos			"Pos"
 #define TblKrnInfo_Key			"Key"
 #define TblKrnInfo_Data			"Data"
+#define TblIdxKrnInfo_Key		"[Idx" TblKrnInfo "_Key" "] ON [" TblKrnInfo "] ([" TblKrnInfo_Key "],[" TblKrnInfo_Pos "])"
 
 NodeDB::NodeDB()
 	:m_pDb(nullptr)
@@ -188,6 +201,8 @@ void NodeDB::Statement::Close()
 
 void NodeDB::Close()
 {
+	m_BodyStore.Close();
+
 	if (m_pDb)
 	{
 		for (size_t i = 0; i < _countof(m_pPrep); i++)
@@ -270,6 +285,11 @@ bool NodeDB::Recordset::IsNull(int col)
 	return SQLITE_NULL == sqlite3_column_type(m_pStmt, col);
 }
 
+bool NodeDB::Recordset::IsInteger(int col)
+{
+	return SQLITE_INTEGER == sqlite3_column_type(m_pStmt, col);
+}
+
 void NodeDB::Recordset::putNull(int col)
 {
 	m_pDB->TestRet(sqlite3_bind_null(m_pStmt, col+1));
@@ -359,13 +379,16 @@ const void* NodeDB::Recordset::get_BlobStrict(int col, uint32_t n)
 	return x.p;
 }
 
-void NodeDB::Open(const char* szPath)
+void NodeDB::Open(const char* szPath, bool bShared /* = false */)
 {
 	TestRet(sqlite3_open_v2(szPath, &m_pDb, SQLITE_OPEN_READWRITE | SQLITE_OPEN_NOMUTEX | SQLITE_OPEN_CREATE, NULL));
 	// Attempt to fix the "busy" error when PC goes to sleep and then awakes. Try the busy handler with non-zero timeout (maybe a single retry would be enough)
 	sqlite3_busy_timeout(m_pDb, 5000);
 
-	ExecTextOut("PRAGMA locking_mode = EXCLUSIVE");
+	if (bShared)
+		ExecTextOut("PRAGMA journal_mode = WAL"); // readers don't block the writer, and see the last committed state
+	else
+		ExecTextOut("PRAGMA locking_mode = EXCLUSIVE");
 	ExecTextOut("PRAGMA journal_size_limit=1048576"); // limit journal file, otherwise it may remain huge even after tx commit, until the app is closed
 
 	bool bCreate;
@@ -375,7 +398,10 @@ void NodeDB::Open(const char* szPath)
 		bCreate = !rs.Step();
 	}
 
-	const uint64_t nVersionTop = 37;
+	const uint64_t nVersionTop = 39;
+
+	if (bCreate)
+		ExecQuick("PRAGMA auto_vacuum = INCREMENTAL"); // must be set before the tables are created
 
 
 	Transaction t(*this);
@@ -478,6 +504,15 @@ void NodeDB::Open(const char* szPath)
 			ExecQuick("DROP TABLE IF EXISTS " TblAccounts);
 
 			CreateTables36();
+			// no break;
+
+		case 37: // non-naked Txos split
+			CreateTables37();
+			// no break;
+
+		case 38: // peer latency and last good time
+			ExecQuick("ALTER TABLE " TblPeer " ADD COLUMN [" TblPeer_Rtt "] INTEGER NOT NULL DEFAULT 0");
+			ExecQuick("ALTER TABLE " TblPeer " ADD COLUMN [" TblPeer_LastGood "] INTEGER NOT NULL DEFAULT 0");
 
 			ParamIntSet(ParamID::DbVer, nVersionTop);
 
@@ -495,14 +530,235 @@ void NodeDB::Open(const char* szPath)
 		}
 	}
 
+	OpenBodyStore();
+
 	t.Commit();
 }
 
 void NodeDB::CheckIntegrity()
 {
-	std::string s = ExecTextOut("PRAGMA integrity_check");
-	if (s != "ok")
-		ThrowError(("sqlite integrity: " + s).c_str());
+	CheckPragma("PRAGMA integrity_check");
+}
+
+void NodeDB::CheckPragma(const char* szSql)
+{
+	// don't use ExecTextOut, it'd run it twice
+	Statement s;
+	Prepare(s, szSql);
+
+	std::string sRes;
+	if (ExecStep(s.m_pStmt))
+		sRes = (const char*) sqlite3_column_text(s.m_pStmt, 0);
+
+	if (sRes != "ok")
+		ThrowError(("sqlite integrity: " + sRes).c_str());
+}
+
+uint64_t NodeDB::CountRows(const std::string& sSql)
+{
+	Statement s;
+	Prepare(s, sSql.c_str());
+
+	if (!ExecStep(s.m_pStmt))
+		ThrowInconsistent();
+
+	return sqlite3_column_int64(s.m_pStmt, 0);
+}
+
+void NodeDB::CheckIntegrityParallel(const char* szPath, uint32_t nThreads)
+{
+	struct Table
+	{
+		std::string m_sName;
+		std::vector<std::string> m_vIndexes;
+	};
+
+	struct Context
+	{
+		std::string m_sPath;
+		std::vector<Table> m_vTables; // [0] is reserved for the quick_check
+		std::atomic<size_t> m_iNext;
+		std::mutex m_Mutex;
+		std::string m_sErr;
+
+		void RunThread()
+		{
+			try
+			{
+				NodeDB db;
+				db.TestRet(sqlite3_open_v2(m_sPath.c_str(), &db.m_pDb, SQLITE_OPEN_READWRITE | SQLITE_OPEN_NOMUTEX, NULL));
+				sqlite3_busy_timeout(db.m_pDb, 5000);
+
+				while (true)
+				{
+					size_t i = m_iNext++;
+					if (i >= m_vTables.size())
+						break;
+
+					if (!i)
+						db.CheckPragma("PRAGMA quick_check");
+					else
+						CheckTable(db, m_vTables[i]);
+				}
+			}
+			catch (const std::exception& e)
+			{
+				std::unique_lock<std::mutex> scope(m_Mutex);
+				if (m_sErr.empty())
+					m_sErr = e.what();
+			}
+		}
+
+		static void CheckTable(NodeDB& db, const Table& t)
+		{
+			uint64_t n = db.CountRows("SELECT COUNT(*) FROM [" + t.m_sName + "] NOT INDEXED");
+
+			for (const auto& sIdx : t.m_vIndexes)
+			{
+				if (db.CountRows("SELECT COUNT(*) FROM [" + t.m_sName + "] INDEXED BY [" + sIdx + "]") != n)
+					ThrowError(("sqlite integrity: index mismatch " + sIdx).c_str());
+			}
+		}
+
+	} ctx;
+
+	ctx.m_sPath = szPath;
+	ctx.m_vTables.resize(1);
+	ctx.m_iNext = 0;
+
+	{
+		// the 1st connection also recovers the hot journal, if there is one
+		NodeDB db;
+		db.TestRet(sqlite3_open_v2(szPath, &db.m_pDb, SQLITE_OPEN_READWRITE | SQLITE_OPEN_NOMUTEX | SQLITE_OPEN_CREATE, NULL));
+
+		Statement s;
+		db.Prepare(s, "SELECT type,name,tbl_name FROM sqlite_master WHERE type IN ('table','index') AND sql IS NOT NULL ORDER BY type DESC");
+
+		while (db.ExecStep(s.m_pStmt))
+		{
+			std::string sType = (const char*) sqlite3_column_text(s.m_pStmt, 0);
+			std::string sName = (const char*) sqlite3_column_text(s.m_pStmt, 1);
+
+			if (sType == "table")
+				ctx.m_vTables.emplace_back().m_sName = std::move(sName);
+			else
+			{
+				std::string sTbl = (const char*) sqlite3_column_text(s.m_pStmt, 2);
+				for (auto& t : ctx.m_vTables)
+					if (t.m_sName == sTbl)
+						t.m_vIndexes.push_back(std::move(sName));
+			}
+		}
+	}
+
+	std::setmax(nThreads, 1U);
+	std::setmin(nThreads, static_cast<uint32_t>(ctx.m_vTables.size()));
+
+	std::vector<std::thread> vThreads;
+	for (uint32_t i = 1; i < nThreads; i++)
+		vThreads.emplace_back(&Context::RunThread, &ctx);
+
+	ctx.RunThread();
+
+	for (auto& t : vThreads)
+		t.join();
+
+	if (!ctx.m_sErr.empty())
+		ThrowError(ctx.m_sErr.c_str());
+}
+
+void NodeDB::CheckIntegrityRecent(Height hFrom)
+{
+	StateID sid;
+	get_Cursor(sid);
+
+	std::setmax(hFrom, Rules::HeightGenesis);
+
+	TxoID idPrev = 0;
+	if (hFrom > Rules::HeightGenesis)
+		idPrev = get_StateTxos(FindActiveStateStrict(hFrom - 1));
+
+	ByteBuffer bbP, bbE, bbRB;
+
+	for (Height h = hFrom; h <= sid.m_Height; h++)
+	{
+		uint64_t rowid = FindActiveStateStrict(h);
+
+		Block::SystemState::Full s;
+		get_State(rowid, s);
+		if (s.m_Height != h)
+			ThrowInconsistent();
+
+		// bodies must be readable (can be erased, if below the horizon)
+		bbP.clear();
+		bbE.clear();
+		bbRB.clear();
+		GetStateBlock(rowid, &bbP, &bbE, &bbRB);
+
+		TxoID id = get_StateTxos(rowid);
+		if (id < idPrev)
+			ThrowInconsistent();
+		idPrev = id;
+	}
+
+	if (sid.m_Row)
+	{
+		// no Txos beyond the cursor
+		WalkerTxo wlk;
+		EnumTxos(wlk, get_StateTxos(sid.m_Row));
+		if (wlk.MoveNext())
+			ThrowInconsistent();
+	}
+}
+
+bool NodeDB::IsBulkLoad()
+{
+	return ParamIntGetDef(ParamID::BulkLoad) != 0;
+}
+
+void NodeDB::BulkLoadBegin()
+{
+	if (!IsBulkLoad())
+	{
+		// those are used by explorer/peer queries only
+		ExecQuick("DROP INDEX IF EXISTS [Idx" TblAssetEvts "_1]");
+		ExecQuick("DROP INDEX IF EXISTS [Idx" TblContractLogs "_Key]");
+		ExecQuick("DROP INDEX IF EXISTS [Idx" TblKrnInfo "_Key]");
+
+		ParamIntSet(ParamID::BulkLoad, 1);
+	}
+
+	if (m_BulkLoadPrev.m_sCacheSize.empty())
+	{
+		m_BulkLoadPrev.m_sCacheSize = ExecTextOut("PRAGMA cache_size");
+		m_BulkLoadPrev.m_sSynchronous = ExecTextOut("PRAGMA synchronous");
+
+		ExecQuick("PRAGMA cache_size = -262144"); // 256MB
+		ExecQuick("PRAGMA synchronous = OFF");
+	}
+}
+
+void NodeDB::BulkLoadEnd()
+{
+	if (IsBulkLoad())
+	{
+		CreateIndexesDeferred();
+		ParamDelSafe(ParamID::BulkLoad);
+	}
+
+	if (!m_BulkLoadPrev.m_sCacheSize.empty())
+	{
+		ExecQuick(("PRAGMA cache_size = " + m_BulkLoadPrev.m_sCacheSize).c_str());
+		ExecQuick(("PRAGMA synchronous = " + m_BulkLoadPrev.m_sSynchronous).c_str());
+		m_BulkLoadPrev.m_sCacheSize.clear();
+	}
+}
+
+void NodeDB::CreateIndexesDeferred()
+{
+	ExecQuick("CREATE INDEX IF NOT EXISTS " TblIdxAssetEvts_1 ";");
+	ExecQuick("CREATE INDEX IF NOT EXISTS " TblIdxContractLogs_Key ";");
+	ExecQuick("CREATE INDEX IF NOT EXISTS " TblIdxKrnInfo_Key ";");
 }
 
 void NodeDB::Create()
@@ -566,7 +822,9 @@ void NodeDB::Create()
 		"[" TblPeer_Key			"] BLOB NOT NULL,"
 		"[" TblPeer_Rating		"] INTEGER NOT NULL,"
 		"[" TblPeer_Addr		"] INTEGER NOT NULL,"
-		"[" TblPeer_LastSeen	"] INTEGER NOT NULL)");
+		"[" TblPeer_LastSeen	"] INTEGER NOT NULL,"
+		"[" TblPeer_Rtt			"] INTEGER NOT NULL DEFAULT 0,"
+		"[" TblPeer_LastGood	"] INTEGER NOT NULL DEFAULT 0)");
 
 	ExecQuick("CREATE TABLE [" TblBbs "] ("
 		"[" TblBbs_ID		"] INTEGER PRIMARY KEY AUTOINCREMENT,"
@@ -600,6 +858,7 @@ void NodeDB::Create()
 	CreateTables30();
 	CreateTables31();
 	CreateTables36();
+	CreateTables37();
 }
 
 void NodeDB::CreateTables20()
@@ -621,7 +880,7 @@ void NodeDB::CreateTables21()
 		"[" TblAssetEvts_Index		"] INTEGER NOT NULL,"
 		"[" TblAssetEvts_Data		"] BLOB)");
 
-	ExecQuick("CREATE INDEX [Idx" TblAssetEvts "_1" "] ON [" TblAssetEvts "] ([" TblAssetEvts_ID "],[" TblAssetEvts_Height  "],[" TblAssetEvts_Index "]);");
+	ExecQuick("CREATE INDEX " TblIdxAssetEvts_1 ";");
 	ExecQuick("CREATE INDEX [Idx" TblAssetEvts "_2" "] ON [" TblAssetEvts "] ([" TblAssetEvts_Height  "],[" TblAssetEvts_Index "]);");
 }
 
@@ -647,7 +906,7 @@ void NodeDB::CreateTables27()
 		"[" TblContractLogs_Data		"] BLOB NOT NULL"
 		") WITHOUT ROWID");
 
-	ExecQuick("CREATE INDEX [Idx" TblContractLogs "_Key" "] ON [" TblContractLogs "] ([" TblContractLogs_Key "],[" TblContractLogs_Pos "]);");
+	ExecQuick("CREATE INDEX " TblIdxContractLogs_Key ";");
 }
 
 void NodeDB::CreateTables28()
@@ -669,7 +928,7 @@ void NodeDB::CreateTables30()
 		"[" TblKrnInfo_Data		"] BLOB NOT NULL"
 		") WITHOUT ROWID");
 
-	ExecQuick("CREATE INDEX [Idx" TblKrnInfo "_Key" "] ON [" TblKrnInfo "] ([" TblKrnInfo_Key "],[" TblKrnInfo_Pos "]);");
+	ExecQuick("CREATE INDEX " TblIdxKrnInfo_Key ";");
 }
 
 void NodeDB::CreateTables31()
@@ -704,11 +963,171 @@ void NodeDB::CreateTables36()
 		"[" TblAccounts_TxoHi	"] INTEGER NOT NULL)");
 }
 
+void NodeDB::CreateTables37()
+{
+	ExecQuick("CREATE TABLE [" TblTxoFull "] ("
+		"[" TblTxoFull_ID		"] INTEGER NOT NULL PRIMARY KEY,"
+		"[" TblTxoFull_Value	"] BLOB NOT NULL)");
+}
+
 void NodeDB::Vacuum()
 {
 	ExecQuick("VACUUM");
 }
 
+uint64_t NodeDB::get_MemUsed()
+{
+	static const int s_pOps[] = {
+		SQLITE_DBSTATUS_CACHE_USED,
+		SQLITE_DBSTATUS_SCHEMA_USED,
+		SQLITE_DBSTATUS_STMT_USED,
+	};
+
+	uint64_t nRes = 0;
+	for (size_t i = 0; i < _countof(s_pOps); i++)
+	{
+		int nCur = 0, nHi = 0;
+		if (SQLITE_OK == sqlite3_db_status(m_pDb, s_pOps[i], &nCur, &nHi, 0))
+			nRes += nCur;
+	}
+
+	return nRes;
+}
+
+void NodeDB::ReleaseMemory()
+{
+	sqlite3_db_release_memory(m_pDb);
+}
+
+bool NodeDB::IsIncrementalVacuum()
+{
+	return PragmaGetInt("PRAGMA auto_vacuum") == 2;
+}
+
+void NodeDB::SetIncrementalVacuum()
+{
+	ExecQuick("PRAGMA auto_vacuum = INCREMENTAL");
+}
+
+uint32_t NodeDB::VacuumStep(uint32_t nPages)
+{
+	uint64_t n0 = get_FreePages();
+	if (!n0)
+		return 0;
+
+	char sz[0x40];
+	snprintf(sz, _countof(sz), "PRAGMA incremental_vacuum(%u)", nPages);
+
+	Statement s;
+	Prepare(s, sz);
+	while (ExecStep(s.m_pStmt))
+		;
+
+	uint64_t n1 = get_FreePages();
+	return (n0 > n1) ? static_cast<uint32_t>(n0 - n1) : 0;
+}
+
+uint64_t NodeDB::get_FreePages()
+{
+	return PragmaGetInt("PRAGMA freelist_count");
+}
+
+uint32_t NodeDB::get_PageSize()
+{
+	return static_cast<uint32_t>(PragmaGetInt("PRAGMA page_size"));
+}
+
+uint64_t NodeDB::PragmaGetInt(const char* szSql)
+{
+	Statement s;
+	Prepare(s, szSql);
+
+	return ExecStep(s.m_pStmt) ? sqlite3_column_int64(s.m_pStmt, 0) : 0;
+}
+
+void NodeDB::OpenReadOnly(const char* szPath)
+{
+	TestRet(sqlite3_open_v2(szPath, &m_pDb, SQLITE_OPEN_READONLY | SQLITE_OPEN_NOMUTEX, NULL));
+	sqlite3_busy_timeout(m_pDb, 5000);
+}
+
+void NodeDB::OpenCheckpointer(const char* szPath)
+{
+	TestRet(sqlite3_open_v2(szPath, &m_pDb, SQLITE_OPEN_READWRITE | SQLITE_OPEN_NOMUTEX, NULL));
+}
+
+void NodeDB::SetWalManualCheckpoint()
+{
+	ExecTextOut("PRAGMA wal_autocheckpoint = 0");
+	ExecTextOut("PRAGMA synchronous = NORMAL"); // in WAL mode the DB remains consistent, only the most recent commits may be lost on power failure
+}
+
+void NodeDB::SetMmapSize(uint64_t n)
+{
+	char sz[0x40];
+	snprintf(sz, _countof(sz), "PRAGMA mmap_size = %llu", static_cast<unsigned long long>(n));
+	ExecTextOut(sz);
+}
+
+bool NodeDB::WalCheckpoint()
+{
+	int nLog = 0, nDone = 0;
+	int ret = sqlite3_wal_checkpoint_v2(m_pDb, nullptr, SQLITE_CHECKPOINT_PASSIVE, &nLog, &nDone);
+	if (SQLITE_BUSY == ret)
+		return false;
+
+	TestRet(ret);
+	return (nLog == nDone);
+}
+
+void NodeDB::VacuumInto(const char* szPath)
+{
+	Statement s;
+	Prepare(s, "VACUUM INTO ?");
+	TestRet(sqlite3_bind_text(s.m_pStmt, 1, szPath, -1, SQLITE_TRANSIENT));
+	ExecStep(s.m_pStmt);
+}
+
+void NodeDB::ExportSnapshot(const char* szPath)
+{
+	VacuumInto(szPath);
+
+	if (m_BodyStore.IsOpen())
+		BodyStore::CopyFiles(sqlite3_db_filename(m_pDb, "main"), szPath, m_BodyStoreSaved);
+
+	NodeDB db;
+	db.Open(szPath);
+
+	Transaction t(db);
+
+	db.ParamDelSafe(ParamID::MyID);
+	db.ParamDelSafe(ParamID::MappingStamp); // the image is not exported, would be rebuilt
+	db.ParamDelSafe(ParamID::LastRecoveryHeight);
+	db.ParamDelSafe(ParamID::ValidatedCache);
+	db.ParamDelSafe(ParamID::CacheState);
+
+	db.ExecQuick("DELETE FROM " TblPeer);
+	db.ExecQuick("DELETE FROM " TblBbs);
+	db.ExecQuick("DELETE FROM " TblDummy);
+	db.ExecQuick("DELETE FROM " TblEvents);
+	db.ExecQuick("DELETE FROM " TblAccounts);
+	db.ExecQuick("DELETE FROM " TblCache);
+
+	t.Commit();
+}
+
+void NodeDB::ImportSnapshot(const char* szSnapshot, const char* szPath)
+{
+	NodeDB db;
+	db.TestRet(sqlite3_open_v2(szSnapshot, &db.m_pDb, SQLITE_OPEN_READONLY | SQLITE_OPEN_NOMUTEX, NULL));
+	db.VacuumInto(szPath);
+
+	BodyStore::Bounds b;
+	Blob blob(&b, sizeof(b));
+	if (db.ParamGet(ParamID::BodyStore, nullptr, &blob))
+		BodyStore::CopyFiles(szSnapshot, szPath, b);
+}
+
 void NodeDB::ExecQuick(const char* szSql)
 {
 	int n = sqlite3_total_changes(m_pDb);
@@ -802,6 +1221,93 @@ sqlite3_stmt* NodeDB::get_Statement(Query::Enum val, const char* sql)
 }
 
 
+NodeDB::InsertBatch::InsertBatch(NodeDB& db, Query::Enum qRow, Query::Enum qBatch, const char* szInsert, uint32_t nCols)
+	:m_DB(db)
+	,m_qRow(qRow)
+	,m_qBatch(qBatch)
+	,m_szInsert(szInsert)
+	,m_nCols(nCols)
+{
+	assert(nCols && (nCols * s_Rows <= 999)); // SQLITE_MAX_VARIABLE_NUMBER
+}
+
+NodeDB::InsertBatch::Value& NodeDB::InsertBatch::PutNext()
+{
+	if (m_vVals.size() == m_nVals)
+		m_vVals.emplace_back();
+	return m_vVals[m_nVals++];
+}
+
+void NodeDB::InsertBatch::put(uint64_t x)
+{
+	Value& v = PutNext();
+	v.m_IsBlob = false;
+	v.m_Int = x;
+
+	if (m_nVals == m_nCols * s_Rows)
+	{
+		Exec(m_qBatch, 0, s_Rows);
+		m_nVals = 0;
+	}
+}
+
+void NodeDB::InsertBatch::put(const Blob& x)
+{
+	Value& v = PutNext();
+	v.m_IsBlob = true;
+	x.Export(v.m_Blob);
+
+	if (m_nVals == m_nCols * s_Rows)
+	{
+		Exec(m_qBatch, 0, s_Rows);
+		m_nVals = 0;
+	}
+}
+
+void NodeDB::InsertBatch::Flush()
+{
+	assert(!(m_nVals % m_nCols));
+	uint32_t nRows = m_nVals / m_nCols;
+
+	for (uint32_t i = 0; i < nRows; i++)
+		Exec(m_qRow, i * m_nCols, 1);
+
+	m_nVals = 0;
+}
+
+void NodeDB::InsertBatch::Exec(Query::Enum q, uint32_t iVal0, uint32_t nRows)
+{
+	std::string sSql;
+	if (!m_DB.m_pPrep[q].m_pStmt)
+	{
+		// build it only once
+		sSql = m_szInsert;
+		for (uint32_t iRow = 0; iRow < nRows; iRow++)
+		{
+			sSql += iRow ? ",(" : "(";
+			for (uint32_t iCol = 0; iCol < m_nCols; iCol++)
+				sSql += iCol ? ",?" : "?";
+			sSql += ')';
+		}
+	}
+
+	Recordset rs(m_DB, q, sSql.c_str());
+
+	uint32_t nVals = nRows * m_nCols;
+	for (uint32_t i = 0; i < nVals; i++)
+	{
+		const Value& v = m_vVals[iVal0 + i];
+		if (v.m_IsBlob)
+			rs.put(i, Blob(v.m_Blob));
+		else
+			rs.put(i, v.m_Int);
+	}
+
+	rs.Step();
+	if (m_DB.get_RowsChanged() != static_cast<int>(nRows))
+		ThrowError("batch insert failed");
+}
+
 int NodeDB::get_RowsChanged() const
 {
 	return sqlite3_changes(m_pDb);
@@ -908,8 +1414,12 @@ void NodeDB::Transaction::Start(NodeDB& db)
 
 void NodeDB::Transaction::Commit()
 {
+	BEAM_METRICS_SCOPE("NodeDB.Commit");
+
 	assert(m_pDB);
+	m_pDB->OnBeforeCommit();
 	m_pDB->ExecStep(Query::Commit, "COMMIT");
+	m_pDB->OnAfterCommit();
 	m_pDB = NULL;
 }
 
@@ -1481,6 +1991,33 @@ uint32_t NodeDB::get_StateExtra(uint64_t rowid, void* pOut, uint32_t nSize)
 	return b.n;
 }
 
+uint32_t NodeDB::get_StateWithExtra(uint64_t rowid, Block::SystemState::Full& out, void* pOut, uint32_t nSize)
+{
+#define THE_MACRO_1(dbname, extname) TblStates_##dbname ","
+	Recordset rs(*this, Query::StateGetWithExtra, "SELECT " StateCvt_Fields(THE_MACRO_1, THE_MACRO_NOP0) TblStates_Extra " FROM " TblStates " WHERE rowid=?");
+#undef THE_MACRO_1
+
+	rs.put(0, rowid);
+	rs.StepStrict();
+
+	int iCol = 0;
+
+#define THE_MACRO_1(dbname, extname) rs.get(iCol++, out.extname);
+	StateCvt_Fields(THE_MACRO_1, THE_MACRO_NOP0)
+#undef THE_MACRO_1
+
+	memset0(pOut, nSize);
+
+	if (rs.IsNull(iCol))
+		return 0;
+
+	Blob b;
+	rs.get(iCol, b);
+
+	memcpy(pOut, b.p, std::min(b.n, nSize));
+	return b.n;
+}
+
 void NodeDB::set_StateInputs(uint64_t rowid, StateInput* p, size_t n)
 {
 	Recordset rs(*this, Query::StateSetInputs, "UPDATE " TblStates " SET " TblStates_Inputs "=? WHERE rowid=?");
@@ -1549,7 +2086,7 @@ void NodeDB::set_StateTxosAndExtra(uint64_t rowid, const TxoID* pId, const Blob*
 	if (pExtra)
 		rs.put(1, *pExtra);
 	if (pRB)
-		rs.put(2, *pRB);
+		PutBody(rs, 2, *pRB, BodyStore::Column::Rollback);
 	rs.put(3, rowid);
 	rs.Step();
 	TestChanged1Row();
@@ -1558,7 +2095,7 @@ void NodeDB::set_StateTxosAndExtra(uint64_t rowid, const TxoID* pId, const Blob*
 void NodeDB::set_StateRB(uint64_t rowid, const Blob& rb)
 {
 	Recordset rs(*this, Query::StateSetRB, "UPDATE " TblStates " SET " TblStates_Rollback "=? WHERE rowid=?");
-	rs.put(0, rb);
+	PutBody(rs, 0, rb, BodyStore::Column::Rollback);
 	rs.put(1, rowid);
 	rs.Step();
 	TestChanged1Row();
@@ -1607,9 +2144,9 @@ void NodeDB::SetStateBlock(uint64_t rowid, const Blob& bodyP, const Blob& bodyE,
 {
 	Recordset rs(*this, Query::StateSetBlock, "UPDATE " TblStates " SET " TblStates_BodyP "=?," TblStates_BodyE "=?," TblStates_Peer "=? WHERE rowid=?");
 	if (bodyP.n)
-		rs.put(0, bodyP);
+		PutBody(rs, 0, bodyP, BodyStore::Column::Perishable);
 	if (bodyE.n)
-		rs.put(1, bodyE);
+		PutBody(rs, 1, bodyE, BodyStore::Column::Eternal);
 	rs.put(2, peer);
 	rs.put(3, rowid);
 
@@ -1623,12 +2160,138 @@ void NodeDB::GetStateBlock(uint64_t rowid, ByteBuffer* pP, ByteBuffer* pE, ByteB
 	rs.put(0, rowid);
 	rs.StepStrict();
 
-	if (pP && !rs.IsNull(0))
-		rs.get(0, *pP);
-	if (pE && !rs.IsNull(1))
-		rs.get(1, *pE);
-	if (pRB && !rs.IsNull(2))
-		rs.get(2, *pRB);
+	if (pP)
+		GetBody(rs, 0, *pP, BodyStore::Column::Perishable);
+	if (pE)
+		GetBody(rs, 1, *pE, BodyStore::Column::Eternal);
+	if (pRB)
+		GetBody(rs, 2, *pRB, BodyStore::Column::Rollback);
+}
+
+bool NodeDB::GetStateBlockRef(uint64_t rowid, Blob* pP, Blob* pE)
+{
+	if (!m_BodyStore.IsOpen())
+		return false;
+
+	Recordset rs(*this, Query::StateGetBlock, "SELECT " TblStates_BodyP "," TblStates_BodyE "," TblStates_Rollback " FROM " TblStates " WHERE rowid=?");
+	rs.put(0, rowid);
+	rs.StepStrict();
+
+	return
+		GetBodyRef(rs, 0, pP, BodyStore::Column::Perishable) &&
+		GetBodyRef(rs, 1, pE, BodyStore::Column::Eternal);
+}
+
+bool NodeDB::GetBodyRef(Recordset& rs, int col, Blob* pBlob, BodyStore::Column::Enum eCol)
+{
+	if (!pBlob)
+		return true;
+
+	if (!rs.IsInteger(col))
+		return false;
+
+	uint64_t ref;
+	rs.get(col, ref);
+	*pBlob = m_BodyStore.get_At(eCol, ref);
+	return true;
+}
+
+void NodeDB::PutBody(Recordset& rs, int col, const Blob& x, BodyStore::Column::Enum eCol)
+{
+	if (m_BodyStore.IsOpen())
+		rs.put(col, m_BodyStore.Append(eCol, x));
+	else
+		rs.put(col, x);
+}
+
+void NodeDB::GetBody(Recordset& rs, int col, ByteBuffer& buf, BodyStore::Column::Enum eCol)
+{
+	if (rs.IsNull(col))
+		return;
+
+	if (rs.IsInteger(col))
+	{
+		if (!m_BodyStore.IsOpen())
+			ThrowInconsistent();
+
+		uint64_t ref;
+		rs.get(col, ref);
+		Blob x = m_BodyStore.get_At(eCol, ref);
+		buf.assign(x.p ? (const uint8_t*) x.p : nullptr, (const uint8_t*) x.p + x.n);
+	}
+	else
+		rs.get(col, buf);
+}
+
+void NodeDB::EnableBodyStore()
+{
+	if (m_BodyStore.IsOpen())
+		return;
+
+	ZeroObject(m_BodyStoreSaved);
+	Blob blob(&m_BodyStoreSaved, sizeof(m_BodyStoreSaved));
+	ParamSet(ParamID::BodyStore, nullptr, &blob);
+
+	OpenBodyStore();
+}
+
+void NodeDB::OpenBodyStore()
+{
+	Blob blob(&m_BodyStoreSaved, sizeof(m_BodyStoreSaved));
+	if (ParamGet(ParamID::BodyStore, nullptr, &blob))
+		m_BodyStore.Open(sqlite3_db_filename(m_pDb, "main"), m_BodyStoreSaved);
+}
+
+void NodeDB::OnBeforeCommit()
+{
+	if (!m_BodyStore.IsOpen())
+		return;
+
+	m_BodyStore.Flush(); // the data must be on disk before it's referenced by the committed DB
+
+	BodyStore::Bounds b = m_BodyStore.get_Bounds();
+
+	if (m_BodyStore.m_bRolledOver)
+	{
+		// find the lowest referenced records. The segments below them will be deleted after the commit
+		static const char* s_ppSql[] = {
+			"SELECT MIN(" TblStates_BodyP ") FROM " TblStates " WHERE typeof(" TblStates_BodyP ")='integer'",
+			"SELECT MIN(" TblStates_BodyE ") FROM " TblStates " WHERE typeof(" TblStates_BodyE ")='integer'",
+			"SELECT MIN(" TblStates_Rollback ") FROM " TblStates " WHERE typeof(" TblStates_Rollback ")='integer'",
+		};
+		static_assert(_countof(s_ppSql) == BodyStore::Column::count);
+
+		for (uint32_t i = 0; i < BodyStore::Column::count; i++)
+		{
+			Statement s;
+			Prepare(s, s_ppSql[i]);
+			if (ExecStep(s.m_pStmt) && (SQLITE_NULL != sqlite3_column_type(s.m_pStmt, 0)))
+				b.m_pLo[i] = sqlite3_column_int64(s.m_pStmt, 0);
+			else
+				b.m_pLo[i] = b.m_pHi[i];
+
+			b.m_pLo[i] -= b.m_pLo[i] % BodyStore::s_SegmentSize;
+			std::setmax(b.m_pLo[i], m_BodyStore.get_Bounds().m_pLo[i]);
+		}
+	}
+
+	if (memcmp(&b, &m_BodyStoreSaved, sizeof(b)))
+	{
+		m_BodyStoreSaved = b;
+		Blob blob(&b, sizeof(b));
+		ParamSet(ParamID::BodyStore, nullptr, &blob);
+	}
+}
+
+void NodeDB::OnAfterCommit()
+{
+	if (!m_BodyStore.IsOpen() || !m_BodyStore.m_bRolledOver)
+		return;
+
+	m_BodyStore.m_bRolledOver = false;
+
+	for (uint32_t i = 0; i < BodyStore::Column::count; i++)
+		m_BodyStore.DeleteBelow(static_cast<BodyStore::Column::Enum>(i), m_BodyStoreSaved.m_pLo[i]);
 }
 
 void NodeDB::DelStateBlockPP(uint64_t rowid)
@@ -2049,7 +2712,7 @@ bool NodeDB::WalkerAccount::MoveNext()
 
 void NodeDB::EnumPeers(WalkerPeer& x)
 {
-	x.m_Rs.Reset(*this, Query::PeerEnum, "SELECT " TblPeer_Key "," TblPeer_Rating "," TblPeer_Addr "," TblPeer_LastSeen " FROM " TblPeer);
+	x.m_Rs.Reset(*this, Query::PeerEnum, "SELECT " TblPeer_Key "," TblPeer_Rating "," TblPeer_Addr "," TblPeer_LastSeen "," TblPeer_Rtt "," TblPeer_LastGood " FROM " TblPeer);
 }
 
 bool NodeDB::WalkerPeer::MoveNext()
@@ -2060,6 +2723,8 @@ bool NodeDB::WalkerPeer::MoveNext()
 	m_Rs.get(1, m_Data.m_Rating);
 	m_Rs.get(2, m_Data.m_Address);
 	m_Rs.get(3, m_Data.m_LastSeen);
+	m_Rs.get(4, m_Data.m_Rtt_ms);
+	m_Rs.get(5, m_Data.m_LastGood);
 	return true;
 }
 
@@ -2071,11 +2736,13 @@ void NodeDB::PeersDel()
 
 void NodeDB::PeerIns(const WalkerPeer::Data& d)
 {
-	Recordset rs(*this, Query::PeerAdd, "INSERT INTO " TblPeer "(" TblPeer_Key "," TblPeer_Rating "," TblPeer_Addr "," TblPeer_LastSeen ") VALUES(?,?,?,?)");
+	Recordset rs(*this, Query::PeerAdd, "INSERT INTO " TblPeer "(" TblPeer_Key "," TblPeer_Rating "," TblPeer_Addr "," TblPeer_LastSeen "," TblPeer_Rtt "," TblPeer_LastGood ") VALUES(?,?,?,?,?,?)");
 	rs.put(0, d.m_ID);
 	rs.put(1, d.m_Rating);
 	rs.put(2, d.m_Address);
 	rs.put(3, d.m_LastSeen);
+	rs.put(4, d.m_Rtt_ms);
+	rs.put(5, d.m_LastGood);
 	rs.Step();
 	TestChanged1Row();
 }
@@ -2141,6 +2808,17 @@ void NodeDB::get_BbsTotals(BbsTotals& x)
 #define TblBbs_InsFieldsListed TblBbs_Key "," TblBbs_Channel "," TblBbs_Time "," TblBbs_Msg "," TblBbs_Nonce
 #define TblBbs_AllFieldsListed TblBbs_ID "," TblBbs_InsFieldsListed
 
+void NodeDB::EnumAllBbsData(WalkerBbs& x)
+{
+	x.m_Rs.Reset(*this, Query::BbsEnumAllData, "SELECT " TblBbs_AllFieldsListed " FROM " TblBbs " ORDER BY " TblBbs_ID);
+}
+
+void NodeDB::BbsDelAll()
+{
+	Recordset rs(*this, Query::BbsDelAll, "DELETE FROM " TblBbs);
+	rs.Step();
+}
+
 void NodeDB::EnumBbsCSeq(WalkerBbs& x)
 {
 	x.m_Rs.Reset(*this, Query::BbsEnumCSeq, "SELECT " TblBbs_AllFieldsListed " FROM " TblBbs " WHERE " TblBbs_Channel "=? AND " TblBbs_ID ">? ORDER BY " TblBbs_ID);
@@ -2364,12 +3042,70 @@ Height NodeDB::FindKernel(const Blob& key)
 	return h;
 }
 
-void NodeDB::TxoAdd(TxoID id, const Blob& b)
+void NodeDB::EnumKernels(WalkerKernel& wlk, Height hMin)
+{
+	wlk.m_Rs.Reset(*this, Query::KernelEnum, "SELECT " TblKernels_Key " FROM " TblKernels " WHERE " TblKernels_Height ">=?");
+	wlk.m_Rs.put(0, hMin);
+}
+
+bool NodeDB::WalkerKernel::MoveNext()
+{
+	if (!m_Rs.Step())
+		return false;
+
+	m_Rs.get(0, m_ID);
+	return true;
+}
+
+uint64_t NodeDB::get_KernelsCount(Height hMin)
+{
+	Recordset rs(*this, Query::KernelCount, "SELECT COUNT(*) FROM " TblKernels " WHERE " TblKernels_Height ">=?");
+	rs.put(0, hMin);
+	rs.StepStrict();
+
+	uint64_t nRet;
+	rs.get(0, nRet);
+	return nRet;
+}
+
+void NodeDB::TxoAdd(TxoID id, const Blob& b, const Blob* pFull)
 {
 	Recordset rs(*this, Query::TxoAdd, "INSERT INTO " TblTxo "(" TblTxo_ID "," TblTxo_Value ") VALUES(?,?)");
 	rs.put(0, id);
 	rs.put(1, b);
 	rs.Step();
+
+	if (pFull)
+	{
+		rs.Reset(*this, Query::TxoFullAdd, "INSERT INTO " TblTxoFull "(" TblTxoFull_ID "," TblTxoFull_Value ") VALUES(?,?)");
+		rs.put(0, id);
+		rs.put(1, *pFull);
+		rs.Step();
+	}
+}
+
+NodeDB::TxoAdder::TxoAdder(NodeDB& db)
+	:m_Txo(db, Query::TxoAdd, Query::TxoAddBatch, "INSERT INTO " TblTxo "(" TblTxo_ID "," TblTxo_Value ") VALUES", 2)
+	,m_Full(db, Query::TxoFullAdd, Query::TxoFullAddBatch, "INSERT INTO " TblTxoFull "(" TblTxoFull_ID "," TblTxoFull_Value ") VALUES", 2)
+{
+}
+
+void NodeDB::TxoAdder::Add(TxoID id, const Blob& b, const Blob* pFull)
+{
+	m_Txo.put(id);
+	m_Txo.put(b);
+
+	if (pFull)
+	{
+		m_Full.put(id);
+		m_Full.put(*pFull);
+	}
+}
+
+void NodeDB::TxoAdder::Flush()
+{
+	m_Txo.Flush();
+	m_Full.Flush();
 }
 
 void NodeDB::TxoDel(TxoID id)
@@ -2378,6 +3114,10 @@ void NodeDB::TxoDel(TxoID id)
 	rs.put(0, id);
 	rs.Step();
 	TestChanged1Row();
+
+	rs.Reset(*this, Query::TxoFullDel, "DELETE FROM " TblTxoFull " WHERE " TblTxoFull_ID "=?");
+	rs.put(0, id);
+	rs.Step();
 }
 
 void NodeDB::TxoDelFrom(TxoID id)
@@ -2385,6 +3125,10 @@ void NodeDB::TxoDelFrom(TxoID id)
 	Recordset rs(*this, Query::TxoDelFrom, "DELETE FROM " TblTxo " WHERE " TblTxo_ID ">=?");
 	rs.put(0, id);
 	rs.Step();
+
+	rs.Reset(*this, Query::TxoFullDelFrom, "DELETE FROM " TblTxoFull " WHERE " TblTxoFull_ID ">=?");
+	rs.put(0, id);
+	rs.Step();
 }
 
 void NodeDB::TxoSetSpent(TxoID id, Height h)
@@ -2398,9 +3142,39 @@ void NodeDB::TxoSetSpent(TxoID id, Height h)
 	TestChanged1Row();
 }
 
+void NodeDB::TxoSetSpent(const TxoID* p, size_t nCount, Height h)
+{
+	const uint32_t nBatch = InsertBatch::s_Rows;
+
+	for ( ; nCount >= nBatch; p += nBatch, nCount -= nBatch)
+	{
+		std::string sSql;
+		if (!m_pPrep[Query::TxoSetSpentBatch].m_pStmt)
+		{
+			sSql = "UPDATE " TblTxo " SET " TblTxo_SpendHeight "=? WHERE " TblTxo_ID " IN (?";
+			for (uint32_t i = 1; i < nBatch; i++)
+				sSql += ",?";
+			sSql += ')';
+		}
+
+		Recordset rs(*this, Query::TxoSetSpentBatch, sSql.c_str());
+		if (MaxHeight != h)
+			rs.put(0, h);
+		for (uint32_t i = 0; i < nBatch; i++)
+			rs.put(i + 1, p[i]);
+
+		rs.Step();
+		if (get_RowsChanged() != static_cast<int>(nBatch))
+			ThrowError("batch update failed");
+	}
+
+	for (size_t i = 0; i < nCount; i++)
+		TxoSetSpent(p[i], h);
+}
+
 void NodeDB::EnumTxos(WalkerTxo& wlk, TxoID id0)
 {
-	wlk.m_Rs.Reset(*this, Query::TxoEnum, "SELECT " TblTxo_ID "," TblTxo_Value "," TblTxo_SpendHeight " FROM " TblTxo " WHERE " TblTxo_ID ">=? ORDER BY " TblTxo_ID);
+	wlk.m_Rs.Reset(*this, Query::TxoEnum, "SELECT T." TblTxo_ID ",IFNULL(F." TblTxoFull_Value ",T." TblTxo_Value "),T." TblTxo_SpendHeight " FROM " TblTxo " T LEFT JOIN " TblTxoFull " F ON F." TblTxoFull_ID "=T." TblTxo_ID " WHERE T." TblTxo_ID ">=? ORDER BY T." TblTxo_ID);
 	wlk.m_Rs.put(0, id0);
 }
 
@@ -2427,11 +3201,24 @@ void NodeDB::TxoSetValue(TxoID id, const Blob& v)
 	rs.put(1, id);
 	rs.Step();
 	TestChanged1Row();
+
+	rs.Reset(*this, Query::TxoFullDel, "DELETE FROM " TblTxoFull " WHERE " TblTxoFull_ID "=?");
+	rs.put(0, id);
+	rs.Step();
 }
 
 void NodeDB::TxoGetValue(WalkerTxo& wlk, TxoID id0)
 {
-	wlk.m_Rs.Reset(*this, Query::TxoGetValue, "SELECT " TblTxo_Value " FROM " TblTxo " WHERE " TblTxo_ID "=?");
+	wlk.m_Rs.Reset(*this, Query::TxoGetValue, "SELECT IFNULL(F." TblTxoFull_Value ",T." TblTxo_Value ") FROM " TblTxo " T LEFT JOIN " TblTxoFull " F ON F." TblTxoFull_ID "=T." TblTxo_ID " WHERE T." TblTxo_ID "=?");
+	wlk.m_Rs.put(0, id0);
+
+	wlk.m_Rs.StepStrict();
+	wlk.m_Rs.get(0, wlk.m_Value);
+}
+
+void NodeDB::TxoGetNaked(WalkerTxo& wlk, TxoID id0)
+{
+	wlk.m_Rs.Reset(*this, Query::TxoGetNaked, "SELECT " TblTxo_Value " FROM " TblTxo " WHERE " TblTxo_ID "=?");
 	wlk.m_Rs.put(0, id0);
 
 	wlk.m_Rs.StepStrict();
@@ -2467,21 +3254,74 @@ void NodeDB::StreamMmr::ResizeTo(uint64_t nCount)
 {
 	m_DB.StreamResize(m_eType, get_TotalHashes(nCount, m_hStoreFrom) * sizeof(Merkle::Hash), get_TotalHashes(m_Count, m_hStoreFrom) * sizeof(Merkle::Hash));
 	m_Count = nCount;
+
+	// elements of complete subtrees only
+	for (size_t i = 0; i < m_vPinned.size(); i++)
+	{
+		uint8_t h = static_cast<uint8_t>(m_hPinFrom + i);
+		uint64_t n = nCount >> h;
+
+		PinnedLevel& x = m_vPinned[i];
+		if (x.m_vValid.size() > n)
+		{
+			x.m_vHashes.resize(n);
+			x.m_vValid.resize(n);
+		}
+	}
+}
+
+void NodeDB::StreamMmr::SetPinFrom(uint8_t hFrom)
+{
+	m_hPinFrom = hFrom;
+	m_vPinned.clear();
+	if (hFrom < Merkle::Position::HMax)
+		m_vPinned.resize(Merkle::Position::HMax - hFrom);
+}
+
+bool NodeDB::StreamMmr::PinnedFind(Merkle::Hash& hv, const Merkle::Position& pos) const
+{
+	if (pos.H < m_hPinFrom)
+		return false;
+
+	const PinnedLevel& x = m_vPinned[pos.H - m_hPinFrom];
+	if ((pos.X >= x.m_vValid.size()) || !x.m_vValid[pos.X])
+		return false;
+
+	hv = x.m_vHashes[pos.X];
+	return true;
+}
+
+void NodeDB::StreamMmr::PinnedAdd(const Merkle::Hash& hv, const Merkle::Position& pos)
+{
+	if (pos.H < m_hPinFrom)
+		return;
+
+	PinnedLevel& x = m_vPinned[pos.H - m_hPinFrom];
+	if (pos.X >= x.m_vValid.size())
+	{
+		x.m_vHashes.resize(pos.X + 1);
+		x.m_vValid.resize(pos.X + 1, false);
+	}
+
+	x.m_vHashes[pos.X] = hv;
+	x.m_vValid[pos.X] = true;
 }
 
 void NodeDB::StreamMmr::LoadElement(Merkle::Hash& hv, const Merkle::Position& pos) const
 {
-	if (CacheFind(hv, pos))
+	if (CacheFind(hv, pos) || PinnedFind(hv, pos))
 		return;
 
 	m_DB.StreamIO(m_eType, Pos2Idx(pos, m_hStoreFrom) * sizeof(Merkle::Hash), hv.m_pData, hv.nBytes, false);
 	Cast::NotConst(this)->CacheAdd(hv, pos);
+	Cast::NotConst(this)->PinnedAdd(hv, pos);
 }
 
 void NodeDB::StreamMmr::SaveElement(const Merkle::Hash& hv, const Merkle::Position& pos)
 {
 	m_DB.StreamIO(m_eType, Pos2Idx(pos, m_hStoreFrom) * sizeof(Merkle::Hash), Cast::NotConst(hv.m_pData), hv.nBytes, true);
 	CacheAdd(hv, pos);
+	PinnedAdd(hv, pos);
 }
 
 bool NodeDB::StreamMmr::CacheFind(Merkle::Hash& hv, const Merkle::Position& pos) const
@@ -2769,7 +3609,38 @@ void NodeDB::CacheSetMaxSize(uint64_t nSize)
 }
 
 
-void NodeDB::CacheInsert(const Blob& key, const Blob& data)
+void NodeDB::CacheSetMemMaxSize(CacheCategory::Enum eCat, uint64_t nSize)
+{
+	m_MemCache.SetMaxSize(eCat, nSize);
+}
+
+void NodeDB::CacheInsert(const Blob& key, const Blob& data, CacheCategory::Enum eCat)
+{
+	m_MemCache.Insert(eCat, key, data);
+
+	if (CacheCategory::KernelProof != eCat)
+		CacheInsertDB(key, data);
+}
+
+bool NodeDB::CacheFind(const Blob& key, ByteBuffer& res, CacheCategory::Enum eCat)
+{
+	if (m_MemCache.Find(eCat, key, res))
+		return true;
+
+	MemCache::Stats& s = m_MemCache.m_pTier[eCat].m_Stats;
+
+	if ((CacheCategory::KernelProof == eCat) || !CacheFindDB(key, res))
+	{
+		s.m_Misses++;
+		return false;
+	}
+
+	s.m_HitsDB++;
+	m_MemCache.Insert(eCat, key, res);
+	return true;
+}
+
+void NodeDB::CacheInsertDB(const Blob& key, const Blob& data)
 {
 	CacheState cs;
 	get_CacheState(cs);
@@ -2788,7 +3659,7 @@ void NodeDB::CacheInsert(const Blob& key, const Blob& data)
 	set_CacheState(cs);
 }
 
-bool NodeDB::CacheFind(const Blob& key, ByteBuffer& res)
+bool NodeDB::CacheFindDB(const Blob& key, ByteBuffer& res)
 {
 	Recordset rs(*this, Query::CacheFind, "SELECT rowid FROM " TblCache " WHERE " TblCache_Key "=?");
 	rs.put(0, key);
@@ -2822,6 +3693,84 @@ bool NodeDB::CacheFind(const Blob& key, ByteBuffer& res)
 	return true;
 }
 
+void NodeDB::MemCache::Clear()
+{
+	for (uint32_t i = 0; i < CacheCategory::count; i++)
+		ShrinkTo(m_pTier[i], 0);
+}
+
+void NodeDB::MemCache::Delete(Tier& t, Entry& x)
+{
+	assert(t.m_Stats.m_SizeCurrent >= x.get_Size());
+	t.m_Stats.m_SizeCurrent -= x.get_Size();
+	t.m_Stats.m_Count--;
+
+	t.m_Keys.erase(KeySet::s_iterator_to(x.m_Key));
+	t.m_Mru.erase(MruList::s_iterator_to(x.m_Mru));
+	delete &x;
+}
+
+void NodeDB::MemCache::ShrinkTo(Tier& t, uint64_t nSize)
+{
+	while (t.m_Stats.m_SizeCurrent > nSize)
+		Delete(t, t.m_Mru.back().get_ParentObj());
+}
+
+void NodeDB::MemCache::SetMaxSize(CacheCategory::Enum eCat, uint64_t nSize)
+{
+	Tier& t = m_pTier[eCat];
+	t.m_Stats.m_SizeMax = nSize;
+	ShrinkTo(t, nSize);
+}
+
+bool NodeDB::MemCache::Find(CacheCategory::Enum eCat, const Blob& key, ByteBuffer& res)
+{
+	Tier& t = m_pTier[eCat];
+	if (t.m_Keys.empty())
+		return false;
+
+	Entry::Key k;
+	key.Export(k.m_Value);
+
+	KeySet::iterator it = t.m_Keys.find(k);
+	if (t.m_Keys.end() == it)
+		return false;
+
+	Entry& x = it->get_ParentObj();
+	t.m_Mru.erase(MruList::s_iterator_to(x.m_Mru));
+	t.m_Mru.push_front(x.m_Mru);
+
+	res = x.m_Data;
+	t.m_Stats.m_Hits++;
+	return true;
+}
+
+void NodeDB::MemCache::Insert(CacheCategory::Enum eCat, const Blob& key, const Blob& data)
+{
+	Tier& t = m_pTier[eCat];
+
+	std::unique_ptr<Entry> pEntry(new Entry);
+	key.Export(pEntry->m_Key.m_Value);
+
+	uint64_t nSize = pEntry->get_Size() + data.n;
+	if (nSize > t.m_Stats.m_SizeMax)
+		return;
+
+	KeySet::iterator it = t.m_Keys.find(pEntry->m_Key);
+	if (t.m_Keys.end() != it)
+		Delete(t, it->get_ParentObj());
+
+	ShrinkTo(t, t.m_Stats.m_SizeMax - nSize);
+
+	data.Export(pEntry->m_Data);
+	t.m_Keys.insert(pEntry->m_Key);
+	t.m_Mru.push_front(pEntry->m_Mru);
+
+	t.m_Stats.m_SizeCurrent += nSize;
+	t.m_Stats.m_Count++;
+	pEntry.release();
+}
+
 
 const Asset::ID NodeDB::s_AssetEmpty0 = Asset::s_MaxCount;
 
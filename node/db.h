@@ -17,6 +17,9 @@
 #include "core/common.h"
 #include "core/block_crypt.h"
 #include "sqlite/sqlite3.h"
+#include "body_store.h"
+#include <boost/intrusive/list.hpp>
+#include <boost/intrusive/set.hpp>
 
 namespace beam {
 
@@ -64,6 +67,10 @@ public:
 			Flags1, // used for 2-stage migration, where the 2nd stage is performed by the Processor
 			CacheState,
 			TreasuryTotals, // for use in explorer node
+			ValidatedCache, // snapshot of the validated tx cache, saved on shutdown
+			BulkLoad, // set while in bulk-load mode, i.e. some indexes are dropped
+			BodyStore, // bounds of the external body store, if used
+			DirtyFrom, // set while the node is running: the height starting from which the data may be modified. Left on unclean shutdown
 		};
 	};
 
@@ -105,6 +112,7 @@ public:
 			StateSetPeer,
 			StateGetPeer,
 			StateGetExtra,
+			StateGetWithExtra,
 			StateSetInputs,
 			StateGetInputs,
 			StateSetTxosAndExtra,
@@ -151,6 +159,8 @@ public:
 			BbsIns,
 			BbsMaxTime,
 			BbsTotals,
+			BbsEnumAllData,
+			BbsDelAll,
 			DummyIns,
 			DummyFindLowest,
 			DummyFind,
@@ -159,6 +169,8 @@ public:
 			KernelIns,
 			KernelFind,
 			KernelDel,
+			KernelEnum,
+			KernelCount,
 			TxoAdd,
 			TxoDel,
 			TxoDelFrom,
@@ -167,6 +179,13 @@ public:
 			TxoEnumBySpentMigrate,
 			TxoSetValue,
 			TxoGetValue,
+			TxoGetNaked,
+			TxoFullAdd,
+			TxoFullDel,
+			TxoFullDelFrom,
+			TxoAddBatch,
+			TxoFullAddBatch,
+			TxoSetSpentBatch,
 			FindHeightBelow,
 			StreamIns,
 			StreamDel,
@@ -248,14 +267,53 @@ public:
 	virtual ~NodeDB();
 
 	void Close();
-	void Open(const char* szPath);
+	void Open(const char* szPath, bool bShared = false); // shared: WAL mode, allows concurrent read-only connections
+	void OpenReadOnly(const char* szPath); // secondary connection, sees the last committed state
+	void OpenCheckpointer(const char* szPath); // secondary connection, used for WAL checkpoints only
+
+	void SetWalManualCheckpoint(); // disable auto-checkpoints by the writer. Commits are synced only on checkpoints
+	void SetMmapSize(uint64_t); // sqlite memory-mapped I/O, reads (including streams) become memory reads
+	bool WalCheckpoint(); // passive, doesn't wait for readers/writers. Returns true if the whole WAL is checkpointed
 	bool IsOpen() const
 	{
 		return nullptr != m_pDb;
 	}
 
 	void Vacuum();
+
+	// Online compaction. Requires the incremental auto-vacuum mode: new DBs are created in it, existing are converted by the (full) vacuum.
+	bool IsIncrementalVacuum();
+	void SetIncrementalVacuum(); // takes effect on the next vacuum
+	uint32_t VacuumStep(uint32_t nPages); // returns the number of pages released (takes effect on commit)
+	uint64_t get_FreePages();
+	uint32_t get_PageSize();
+
+	uint64_t get_MemUsed(); // sqlite heap of this connection: page cache, schema, prepared statements
+	void ReleaseMemory(); // frees the unused page cache
+
 	void CheckIntegrity();
+	// Splits the check across the connections: sqlite quick_check on one, traversal of all the tables and indexes (with entry count match) on the others.
+	// Must be called before the DB is opened.
+	static void CheckIntegrityParallel(const char* szPath, uint32_t nThreads);
+	// Checks only the recent data, that may have been modified by the session that wasn't shut down properly
+	void CheckIntegrityRecent(Height hFrom);
+
+	// Bulk-load mode, for the initial sync. The secondary indexes that aren't used by the blocks interpretation are dropped,
+	// and rebuilt once the mode is over. Larger page cache, no syncs (the pragmas are per-connection, should be re-applied after reopen).
+	void BulkLoadBegin();
+	void BulkLoadEnd();
+	bool IsBulkLoad();
+
+	// Keep block bodies and rollback data in the external append-only store (next to the DB file), the DB keeps only the refs.
+	// Once enabled it's used for all the new data. Existing data remains in the DB, both are readable.
+	// Used by the main (writer) connection only.
+	void EnableBodyStore();
+	bool IsBodyStore() const { return m_BodyStore.IsOpen(); }
+
+	// Node state snapshot: a compact copy of the DB, w/o node-local data (identity, peers, bbs, owned events).
+	// Export must be called outside of a transaction. Import creates a new DB from the snapshot, the snapshot file is not modified.
+	void ExportSnapshot(const char* szPath);
+	static void ImportSnapshot(const char* szSnapshot, const char* szPath);
 
 	virtual void OnModified() {}
 
@@ -300,6 +358,7 @@ public:
 
 		void putNull(int col);
 		bool IsNull(int col);
+		bool IsInteger(int col);
 
 		void put(int col, const Merkle::Hash& x) { put_As(col, x); }
 		void get(int col, Merkle::Hash& x) { get_As(col, x); }
@@ -309,6 +368,43 @@ public:
 		void putZeroBlob(int col, uint32_t nSize);
 	};
 
+	// Multi-row INSERT. The rows are buffered (values are copied), and inserted by a single statement once s_Rows are complete.
+	// The rest is inserted row-by-row on Flush. Both statements are prepared once and reused, like all the others.
+	class InsertBatch
+	{
+	public:
+		static const uint32_t s_Rows = 32;
+
+		// szInsert: "INSERT INTO Tbl(col1,col2,...) VALUES"
+		InsertBatch(NodeDB&, Query::Enum qRow, Query::Enum qBatch, const char* szInsert, uint32_t nCols);
+
+		// values of the next row, in the order of columns
+		void put(uint64_t);
+		void put(const Blob&);
+
+		void Flush();
+
+	private:
+		struct Value
+		{
+			uint64_t m_Int;
+			ByteBuffer m_Blob;
+			bool m_IsBlob;
+		};
+
+		NodeDB& m_DB;
+		Query::Enum m_qRow;
+		Query::Enum m_qBatch;
+		const char* m_szInsert;
+		uint32_t m_nCols;
+
+		std::vector<Value> m_vVals; // not shrunk, the buffers are reused
+		uint32_t m_nVals = 0;
+
+		Value& PutNext();
+		void Exec(Query::Enum, uint32_t iVal0, uint32_t nRows);
+	};
+
 	int get_RowsChanged() const;
 	uint64_t get_LastInsertRowID() const;
 
@@ -354,6 +450,7 @@ public:
 	bool get_Peer(uint64_t rowid, PeerID&);
 
 	uint32_t get_StateExtra(uint64_t rowid, void*, uint32_t nSize);
+	uint32_t get_StateWithExtra(uint64_t rowid, Block::SystemState::Full&, void*, uint32_t nSize); // header and extra in a single lookup
 	TxoID get_StateTxos(uint64_t rowid);
 
 	void set_StateTxosAndExtra(uint64_t rowid, const TxoID*, const Blob* pExtra, const Blob* pRB);
@@ -362,6 +459,8 @@ public:
 
 	void SetStateBlock(uint64_t rowid, const Blob& bodyP, const Blob& bodyE, const PeerID&);
 	void GetStateBlock(uint64_t rowid, ByteBuffer* pP, ByteBuffer* pE, ByteBuffer* pRB);
+	// w/o copying. Fails unless all the requested parts are in the body store, the result points into its mapping (valid until the next commit)
+	bool GetStateBlockRef(uint64_t rowid, Blob* pP, Blob* pE);
 	void DelStateBlockPP(uint64_t rowid); // delete perishable, peer. Keep eternal, extra, txos, rollback
 	void DelStateBlockPPR(uint64_t rowid); // delete perishable, rollback, peer. Keep eternal, extra, txos
 	void DelStateBlockAll(uint64_t rowid); // delete perishable, peer, eternal, extra, txos, rollback
@@ -487,6 +586,8 @@ public:
 			uint32_t m_Rating;
 			uint64_t m_Address;
 			Timestamp m_LastSeen;
+			uint32_t m_Rtt_ms = 0; // 0 - unknown
+			Timestamp m_LastGood = 0; // when data was last downloaded from it
 		} m_Data;
 
 		bool MoveNext();
@@ -555,6 +656,8 @@ public:
 	};
 
 	void EnumAllBbs(WalkerBbsTimeLen&); // ordered by m_ID.
+	void EnumAllBbsData(WalkerBbs&); // ordered by m_ID.
+	void BbsDelAll();
 
 	struct IBbsHistogram {
 		virtual bool OnChannel(BbsChannel, uint64_t nCount) = 0;
@@ -572,12 +675,35 @@ public:
 	void DeleteKernel(const Blob&, Height h);
 	Height FindKernel(const Blob&); // in case of duplicates - returning the one with the largest Height
 
+	struct WalkerKernel
+	{
+		Recordset m_Rs;
+		Merkle::Hash m_ID;
+
+		bool MoveNext();
+	};
+
+	void EnumKernels(WalkerKernel&, Height hMin); // unordered
+	uint64_t get_KernelsCount(Height hMin);
+
 	uint64_t FindStateWorkGreater(const Difficulty::Raw&);
 
-	void TxoAdd(TxoID, const Blob&);
+	void TxoAdd(TxoID, const Blob&, const Blob* pFull); // if pFull is specified - the value must be naked, the full one is kept in a separate table until TxoSetValue
 	void TxoDel(TxoID);
 	void TxoDelFrom(TxoID);
 	void TxoSetSpent(TxoID, Height);
+	void TxoSetSpent(const TxoID*, size_t nCount, Height); // batched
+
+	// batched TxoAdd. Must be flushed before the Txos are accessed
+	struct TxoAdder
+	{
+		InsertBatch m_Txo;
+		InsertBatch m_Full;
+
+		TxoAdder(NodeDB&);
+		void Add(TxoID, const Blob&, const Blob* pFull);
+		void Flush();
+	};
 
 	struct WalkerTxo
 	{
@@ -592,6 +718,7 @@ public:
 	void EnumTxos(WalkerTxo&, TxoID id0);
 	void TxoSetValue(TxoID, const Blob&);
 	void TxoGetValue(WalkerTxo&, TxoID);
+	void TxoGetNaked(WalkerTxo&, TxoID); // may return the full value as well (if not split), w/o reading the separate table
 
 	void ShieldedResize(uint64_t n, uint64_t n0) {
 		StreamResize_T<ECC::Point::Storage>(StreamType::Shielded, n, n0);
@@ -647,6 +774,10 @@ public:
 		void ShrinkTo(uint64_t nCount);
 		void ResizeTo(uint64_t nCount);
 
+		// Keep all the elements starting from the specified level in memory, filled on demand. The upper levels are relatively small,
+		// and needed by every proof. Merkle::Position::HMax to disable
+		void SetPinFrom(uint8_t hFrom);
+
 	protected:
 		// Mmr
 		virtual void LoadElement(Merkle::Hash& hv, const Merkle::Position& pos) const override;
@@ -670,6 +801,18 @@ public:
 
 		bool CacheFind(Merkle::Hash& hv, const Merkle::Position& pos) const;
 		void CacheAdd(const Merkle::Hash& hv, const Merkle::Position& pos);
+
+		struct PinnedLevel
+		{
+			std::vector<Merkle::Hash> m_vHashes;
+			std::vector<bool> m_vValid;
+		};
+
+		uint8_t m_hPinFrom = Merkle::Position::HMax;
+		std::vector<PinnedLevel> m_vPinned; // levels starting from m_hPinFrom
+
+		bool PinnedFind(Merkle::Hash& hv, const Merkle::Position& pos) const;
+		void PinnedAdd(const Merkle::Hash& hv, const Merkle::Position& pos);
 	};
 
 	class StatesMmr
@@ -693,9 +836,81 @@ public:
 	void UniqueDeleteStrict(const Blob& key);
 	void UniqueDeleteAll();
 
-	void CacheInsert(const Blob& key, const Blob& data);
-	bool CacheFind(const Blob& key, ByteBuffer&);
+	struct CacheCategory
+	{
+		enum Enum {
+			Generic,
+			Body,
+			KernelProof, // depends on the tip, not saved in the DB
+			ContractVars,
+			ShieldedList,
+			count
+		};
+	};
+
+	// In-memory tier in front of the DB cache, with a separate budget per category. All budgets are zero (disabled) by default
+	struct MemCache
+	{
+		struct Entry
+		{
+			struct Key
+				:public boost::intrusive::set_base_hook<>
+			{
+				ByteBuffer m_Value;
+				bool operator < (const Key& x) const { return Blob(m_Value) < Blob(x.m_Value); }
+				IMPLEMENT_GET_PARENT_OBJ(Entry, m_Key)
+			} m_Key;
+
+			struct Mru
+				:public boost::intrusive::list_base_hook<>
+			{
+				IMPLEMENT_GET_PARENT_OBJ(Entry, m_Mru)
+			} m_Mru;
+
+			ByteBuffer m_Data;
+
+			uint64_t get_Size() const { return sizeof(*this) + m_Key.m_Value.size() + m_Data.size(); }
+		};
+
+		typedef boost::intrusive::multiset<Entry::Key> KeySet;
+		typedef boost::intrusive::list<Entry::Mru> MruList;
+
+		struct Stats
+		{
+			uint64_t m_Hits = 0;
+			uint64_t m_HitsDB = 0; // missed in memory, found in the DB
+			uint64_t m_Misses = 0;
+			uint64_t m_SizeMax = 0;
+			uint64_t m_SizeCurrent = 0;
+			uint64_t m_Count = 0;
+		};
+
+		struct Tier
+		{
+			KeySet m_Keys;
+			MruList m_Mru;
+			Stats m_Stats;
+		};
+
+		Tier m_pTier[CacheCategory::count];
+
+		~MemCache() { Clear(); }
+
+		void Clear();
+		void SetMaxSize(CacheCategory::Enum, uint64_t);
+		bool Find(CacheCategory::Enum, const Blob& key, ByteBuffer&); // modifies MRU if found
+		void Insert(CacheCategory::Enum, const Blob& key, const Blob& data);
+
+	private:
+		void Delete(Tier&, Entry&);
+		void ShrinkTo(Tier&, uint64_t);
+	};
+
+	void CacheInsert(const Blob& key, const Blob& data, CacheCategory::Enum = CacheCategory::Generic);
+	bool CacheFind(const Blob& key, ByteBuffer&, CacheCategory::Enum = CacheCategory::Generic);
 	void CacheSetMaxSize(uint64_t);
+	void CacheSetMemMaxSize(CacheCategory::Enum, uint64_t);
+	const MemCache::Stats& get_MemCacheStats(CacheCategory::Enum eCat) const { return m_MemCache.m_pTier[eCat].m_Stats; }
 
 #pragma pack (push, 1)
 	struct CacheState
@@ -827,8 +1042,11 @@ private:
 	Statement m_pPrep[Query::count];
 
 	void Prepare(Statement&, const char*);
+	void VacuumInto(const char* szPath);
 
 	void TestRet(int);
+	void CheckPragma(const char*);
+	uint64_t CountRows(const std::string&);
 	void ThrowSqliteError(int);
 	static void ThrowError(const char*);
 	static void ThrowInconsistent();
@@ -843,8 +1061,26 @@ private:
 	void CreateTables30();
 	void CreateTables31();
 	void CreateTables36();
+	void CreateTables37();
+	void CreateIndexesDeferred();
 	void ExecQuick(const char*);
+
+	BodyStore m_BodyStore;
+	BodyStore::Bounds m_BodyStoreSaved; // as committed
+	void OpenBodyStore();
+	void OnBeforeCommit();
+	void OnAfterCommit();
+	void PutBody(Recordset&, int col, const Blob&, BodyStore::Column::Enum);
+	bool GetBodyRef(Recordset&, int col, Blob*, BodyStore::Column::Enum);
+	void GetBody(Recordset&, int col, ByteBuffer&, BodyStore::Column::Enum);
+
+	struct BulkLoadPrev
+	{
+		std::string m_sCacheSize;
+		std::string m_sSynchronous;
+	} m_BulkLoadPrev; // pragmas to restore, empty if not applied
 	std::string ExecTextOut(const char*);
+	uint64_t PragmaGetInt(const char*);
 	bool ExecStep(sqlite3_stmt*);
 	int ExecStepRaw(sqlite3_stmt*);
 	bool ExecStep(Query::Enum, const char*); // returns true while there's a row
@@ -889,6 +1125,9 @@ private:
 	Asset::ID AssetFindMinFree(Asset::ID nMin);
 
 	void set_CacheState(CacheState&); // auto cleans the cache if necessary
+	void CacheInsertDB(const Blob& key, const Blob& data);
+	bool CacheFindDB(const Blob& key, ByteBuffer&);
+	MemCache m_MemCache;
 };
 
 
@@ -29,6 +29,7 @@
 #include "../bvm/bvm2.h"
 
 #include "pow/external_pow.h"
+#include <cmath>
 
 namespace beam {
 
@@ -52,6 +53,8 @@ void Node::SyncStatus::ToRelative(Height hDone0)
 
 void Node::RefreshCongestions()
 {
+	m_Processor.m_bCongestionsPending = false; // satisfies the pending async request, if any
+
 	for (TaskSet::iterator it = m_setTasks.begin(); m_setTasks.end() != it; ++it)
 		it->m_bNeeded = false;
 
@@ -82,7 +85,10 @@ void Node::UpdateSyncStatus()
 			{
 				Peer& peer = *it;
 				if ((Peer::Flags::Connected & peer.m_Flags) && !(Peer::Flags::Probe & peer.m_Flags))
+				{
 					peer.SendLogin();
+					peer.MaybeSendTxSketch();
+				}
 			}
 
 		}
@@ -322,6 +328,20 @@ void Node::Wanted::OnTimer()
 
 void Node::TryAssignTask(Task& t)
 {
+	if (t.m_Key.second && !m_PeerMan.m_LiveSet.empty())
+	{
+		// Bodies: prefer the peers that don't transfer blocks currently, unless they're much slower than the best one.
+		// The load is spread, and the faster peers, which finish sooner, naturally get more of it.
+		uint32_t nRatingMin = m_PeerMan.m_LiveSet.begin()->m_p->m_pInfo->m_RawRating.m_Value / 4;
+
+		for (PeerMan::LiveSet::iterator it = m_PeerMan.m_LiveSet.begin(); m_PeerMan.m_LiveSet.end() != it; ++it)
+		{
+			Peer& p = *it->m_p;
+			if ((p.m_pInfo->m_RawRating.m_Value >= nRatingMin) && !p.get_BlockTasks() && TryAssignTask(t, p))
+				return;
+		}
+	}
+
 	// Prioritize w.r.t. rating!
 	for (PeerMan::LiveSet::iterator it = m_PeerMan.m_LiveSet.begin(); m_PeerMan.m_LiveSet.end() != it; ++it)
 	{
@@ -331,6 +351,74 @@ void Node::TryAssignTask(Task& t)
 	}
 }
 
+Node::Task* Node::FindTaskInFlight(const Task::Key& key)
+{
+	Task tKey;
+	tKey.m_Key = key;
+
+	auto range = m_setTasks.equal_range(tKey);
+	for (TaskSet::iterator it = range.first; range.second != it; ++it)
+		if (it->m_pOwner)
+			return &(*it);
+
+	return nullptr;
+}
+
+uint32_t Node::get_HedgeDelay_ms(const Peer& p)
+{
+	// 0 - don't hedge
+	if (!m_Cfg.m_Hedge.m_Quantile)
+		return 0;
+
+	const NodeProcessor::PerfStats::Counter& c = m_Processor.m_PerfStats.m_p[NodeProcessor::PerfStats::Stage::BodyDownload];
+	if (c.m_Count.load(std::memory_order_relaxed) < m_Cfg.m_Hedge.m_MinSamples)
+		return 0;
+
+	uint64_t dt_ms = c.get_Quantile_us(m_Cfg.m_Hedge.m_Quantile) / 1000;
+	std::setmax(dt_ms, static_cast<uint64_t>(m_Cfg.m_Hedge.m_MinDelay_ms));
+	std::setmax(dt_ms, static_cast<uint64_t>(p.m_Rtt_ms) * 2);
+
+	return static_cast<uint32_t>(std::min<uint64_t>(dt_ms, static_cast<uint32_t>(-1)));
+}
+
+bool Node::TryHedgeTask(Task& t)
+{
+	assert(t.m_pOwner && t.m_Key.second);
+	const Peer& owner = *t.m_pOwner;
+	uint32_t nRating = owner.m_pInfo ? owner.m_pInfo->m_RawRating.m_Value : 0;
+
+	Task* pTask = new Task;
+	pTask->m_Key = t.m_Key;
+	pTask->m_sidTrg = t.m_sidTrg;
+	pTask->m_bNeeded = true;
+	pTask->m_nCount = 0;
+	pTask->m_bRange = false;
+	pTask->m_bCompact = false;
+	pTask->m_bHedged = true;
+	pTask->m_bHedge = true;
+	pTask->m_pOwner = NULL;
+
+	m_setTasks.insert(*pTask);
+	m_lstTasksUnassigned.push_back(*pTask);
+
+	// only to a faster peer that doesn't transfer blocks currently
+	for (PeerMan::LiveSet::iterator it = m_PeerMan.m_LiveSet.begin(); m_PeerMan.m_LiveSet.end() != it; ++it)
+	{
+		Peer& p = *it->m_p;
+		if ((&p == &owner) || (p.m_pInfo->m_RawRating.m_Value <= nRating) || p.get_BlockTasks())
+			continue;
+
+		if (TryAssignTask(*pTask, p))
+		{
+			BEAM_LOG_INFO() << "Hedged " << t.m_Key.first << " from " << owner.m_RemoteAddr << " to " << p.m_RemoteAddr;
+			return true;
+		}
+	}
+
+	DeleteUnassignedTask(*pTask);
+	return false;
+}
+
 bool Node::TryAssignTask(Task& t, Peer& p)
 {
     if (!p.ShouldAssignTasks())
@@ -361,24 +449,46 @@ bool Node::TryAssignTask(Task& t, Peer& p)
         return false;
 
     // check if the peer currently transfers a block
-    uint32_t nBlocks = 0;
-	for (TaskList::iterator it = p.m_lstTasks.begin(); p.m_lstTasks.end() != it; ++it)
-	{
-		if (it->m_Key.second)
-			nBlocks++;
-	}
+    uint32_t nBlocks = p.get_BlockTasks();
 
 	// assign
 	if (t.m_Key.second)
 	{
-		if (m_nTasksPackBody >= m_Cfg.m_MaxConcurrentBlocksRequest)
-			return false; // too many blocks requested
+		// fast-sync range, limited by its own height
+		bool bRange =
+			m_Processor.IsFastSync() &&
+			t.m_Key.first.m_Height &&
+			(t.m_sidTrg.m_Height <= m_Processor.m_SyncData.m_Target.m_Height);
+
+		if (bRange)
+		{
+			if (nBlocks)
+				return false; // spread the ranges across different peers
+
+			if ((m_nTasksPackRange >= m_Cfg.m_FastSync.m_MaxRanges) && !t.m_bHedge)
+				return false;
+		}
+		else
+		{
+			if ((m_nTasksPackBody >= m_Cfg.m_MaxConcurrentBlocksRequest) && !t.m_bHedge)
+				return false; // too many blocks requested
+		}
 
 		Height hCountExtra = t.m_sidTrg.m_Height - t.m_Key.first.m_Height;
 
 		proto::GetBodyPack msg;
 
-		if (t.m_Key.first.m_Height <= m_Processor.m_SyncData.m_Target.m_Height)
+		if (bRange)
+		{
+			msg.m_Top.m_Height = t.m_sidTrg.m_Height;
+			m_Processor.get_DB().get_StateHash(t.m_sidTrg.m_Row, msg.m_Top.m_Hash);
+
+			msg.m_CountExtra = hCountExtra;
+			msg.m_Height0 = m_Processor.m_SyncData.m_h0;
+			msg.m_HorizonLo1 = m_Processor.m_SyncData.m_TxoLo;
+			msg.m_HorizonHi1 = m_Processor.m_SyncData.m_Target.m_Height;
+		}
+		else if (t.m_Key.first.m_Height <= m_Processor.m_SyncData.m_Target.m_Height)
 		{
 			// fast-sync mode, diluted blocks request.
 			msg.m_Top.m_Height = m_Processor.m_SyncData.m_Target.m_Height;
@@ -398,12 +508,27 @@ bool Node::TryAssignTask(Task& t, Peer& p)
 			msg.m_Top.m_Height = t.m_sidTrg.m_Height;
 			m_Processor.get_DB().get_StateHash(t.m_sidTrg.m_Row, msg.m_Top.m_Hash);
 			msg.m_CountExtra = hCountExtra;
+
+			// a single new block, most of its txs are probably already in our pool
+			t.m_bCompact = !hCountExtra && m_Cfg.m_CompactBodies && (p.get_Ext() >= 11);
 		}
 
-		p.Send(msg);
+		if (t.m_bCompact)
+		{
+			proto::GetBodyCompact msgC;
+			msgC.m_ID = t.m_Key.first;
+			p.Send(msgC);
+		}
+		else
+			p.Send(msg);
 
 		t.m_nCount = std::min(static_cast<uint32_t>(msg.m_CountExtra), m_Cfg.m_BandwidthCtl.m_MaxBodyPackCount) + 1; // just an estimate, the actual num of blocks can be smaller
-		m_nTasksPackBody += t.m_nCount;
+		t.m_bRange = bRange;
+
+		if (bRange)
+			m_nTasksPackRange++;
+		else
+			m_nTasksPackBody += t.m_nCount;
 
         t.m_h0 = m_Processor.m_SyncData.m_h0;
         t.m_hTxoLo = m_Processor.m_SyncData.m_TxoLo;
@@ -460,6 +585,8 @@ bool Node::TryAssignTask(Task& t, Peer& p)
 
 void Node::Peer::SetTimerWrtFirstTask()
 {
+	m_HedgeTimeout_ms = 0;
+
 	if (m_lstTasks.empty())
 	{
 		assert(m_pTimerRequest);
@@ -467,12 +594,23 @@ void Node::Peer::SetTimerWrtFirstTask()
 	}
 	else
 	{
-		// TODO - timer w.r.t. rating, i.e. should not exceed much the best avail peer rating
+		const Task& t = m_lstTasks.front();
 
-		uint32_t timeout_ms = m_lstTasks.front().m_Key.second ?
+		uint32_t timeout_ms = t.m_Key.second ?
 			m_This.m_Cfg.m_Timeout.m_GetBlock_ms :
 			m_This.m_Cfg.m_Timeout.m_GetState_ms;
 
+		if (t.m_Key.second && !t.m_bHedged)
+		{
+			// wake up earlier, to duplicate the request if this peer is a straggler
+			uint32_t dtHedge_ms = m_This.get_HedgeDelay_ms(*this);
+			if (dtHedge_ms && (dtHedge_ms < timeout_ms))
+			{
+				m_HedgeTimeout_ms = timeout_ms - dtHedge_ms;
+				timeout_ms = dtHedge_ms;
+			}
+		}
+
 		if (!m_pTimerRequest)
 			m_pTimerRequest = io::Timer::create(io::Reactor::get_Current());
 
@@ -496,6 +634,10 @@ void Node::Processor::RequestData(const Block::SystemState::ID& id, bool bBlock,
         pTask->m_sidTrg = sidTrg;
 		pTask->m_bNeeded = true;
         pTask->m_nCount = 0;
+        pTask->m_bRange = false;
+        pTask->m_bCompact = false;
+        pTask->m_bHedged = false;
+        pTask->m_bHedge = false;
         pTask->m_pOwner = NULL;
 
         get_ParentObj().m_setTasks.insert(*pTask);
@@ -506,11 +648,25 @@ void Node::Processor::RequestData(const Block::SystemState::ID& id, bool bBlock,
 	}
 	else
 	{
-		Node::Task& t = *it;
-		t.m_bNeeded = true;
+		// there may be 2 copies of the task (hedged request)
+		Node::Task* pUnassigned = nullptr;
+		bool bInFlight = false;
+
+		auto range = get_ParentObj().m_setTasks.equal_range(tKey);
+		for (it = range.first; range.second != it; ++it)
+		{
+			Node::Task& t = *it;
+			t.m_bNeeded = true;
+
+			if (t.m_pOwner)
+				bInFlight = true;
+			else
+				pUnassigned = &t;
+		}
 
-		if (!t.m_pOwner)
+		if (pUnassigned && !bInFlight)
 		{
+			Node::Task& t = *pUnassigned;
 			if (t.m_sidTrg.m_Height < sidTrg.m_Height)
 				t.m_sidTrg = sidTrg;
 
@@ -631,6 +787,7 @@ void Node::DeleteOutdated()
 void Node::Processor::OnNewState()
 {
     m_Cwp.Reset();
+    m_CwpCropped.clear();
 
 	if (!IsTreasuryHandled())
         return;
@@ -648,18 +805,25 @@ void Node::Processor::OnNewState()
     if (get_ParentObj().m_Miner.IsEnabled())
     {
         get_ParentObj().m_Miner.HardAbortSafe();
+        get_ParentObj().m_Miner.m_bEmptyFirst = true;
         get_ParentObj().m_Miner.SetTimer(0, true); // async start mining
     }
 
     proto::NewTip msg;
     msg.m_Description = m_Cursor.m_Full;
 
+    // cluster members first, they relay it further with the lowest latency
+    bool bCluster = !get_ParentObj().m_Beacon.m_mapCluster.empty();
+    for (uint32_t iPass = bCluster ? 0 : 1; iPass < 2; iPass++)
     for (PeerList::iterator it = get_ParentObj().m_lstPeers.begin(); get_ParentObj().m_lstPeers.end() != it; ++it)
     {
         Peer& peer = *it;
         if (!(Peer::Flags::Connected & peer.m_Flags))
             continue;
 
+        if (bCluster && (peer.IsClusterMember() == !!iPass))
+            continue;
+
 		if (msg.m_Description.m_Height >= Rules::HeightGenesis)
 		{
 			if (!NodeProcessor::IsRemoteTipNeeded(msg.m_Description, peer.m_Tip))
@@ -674,7 +838,11 @@ void Node::Processor::OnNewState()
         peer.Send(msg);
     }
 
-    get_ParentObj().RefreshCongestions();
+    // after the tip, so that the events can be requested at once
+    for (PeerList::iterator it = get_ParentObj().m_lstPeers.begin(); get_ParentObj().m_lstPeers.end() != it; ++it)
+        it->MaybeSendEventsNew();
+
+    RefreshCongestionsAsync();
 
 	IObserver* pObserver = get_ParentObj().m_Cfg.m_Observer;
 	if (pObserver)
@@ -799,6 +967,8 @@ void Node::Processor::OnRolledBack()
 
 void Node::Processor::MyExecutorMT::RunThread(uint32_t iThread)
 {
+    ApplyPlacement(get_ParentObj().get_ParentObj().m_Cfg.m_Placement.m_Verification, "verification");
+
     MyExecutor::MyContext ctx;
     ctx.m_iThread = iThread;
     ECC::InnerProduct::BatchContext::Scope scope(ctx.m_BatchCtx);
@@ -840,21 +1010,65 @@ void Node::Processor::OnGoUpTimer()
 	get_ParentObj().UpdateSyncStatus();
 }
 
+void Node::Processor::RefreshCongestionsAsync()
+{
+	if (!m_bCongestionsPending)
+	{
+		if (!m_pCongestionsTimer)
+			m_pCongestionsTimer = io::Timer::create(io::Reactor::get_Current());
+
+		m_pCongestionsTimer->start(0, false, [this]() { OnCongestionsTimer(); });
+
+		m_bCongestionsPending = true;
+	}
+}
+
+void Node::Processor::OnCongestionsTimer()
+{
+	if (m_bCongestionsPending)
+		get_ParentObj().RefreshCongestions(); // resets the flag
+}
+
+void Node::Processor::StartCompaction()
+{
+	if (!m_pCompactionTimer)
+		m_pCompactionTimer = io::Timer::create(io::Reactor::get_Current());
+
+	m_pCompactionTimer->start(get_ParentObj().m_Cfg.m_Compaction.m_Period_ms, true, [this]() { OnCompactionTimer(); });
+}
+
+void Node::Processor::OnCompactionTimer()
+{
+	if (CompactStep(get_ParentObj().m_Cfg.m_Compaction.m_Budget_ms))
+		OnModified(); // commit soon
+}
+
 void Node::Processor::Stop()
 {
     m_ExecutorMT.Stop();
     m_bGoUpPending = false;
     m_bFlushPending = false;
+    m_bCongestionsPending = false;
 
     if (m_pGoUpTimer)
     {
         m_pGoUpTimer->cancel();
     }
 
+    if (m_pCongestionsTimer)
+    {
+        m_pCongestionsTimer->cancel();
+    }
+
     if (m_pFlushTimer)
     {
         m_pFlushTimer->cancel();
     }
+
+    if (m_pCompactionTimer)
+    {
+        m_pCompactionTimer->cancel();
+    }
 }
 
 Height Node::Processor::get_MaxAutoRollback()
@@ -967,6 +1181,7 @@ Node::Peer* Node::AllocPeer(const beam::io::Address& addr)
     m_lstPeers.push_back(*pPeer);
 
 	pPeer->m_UnsentHiMark = m_Cfg.m_BandwidthCtl.m_Drown;
+	pPeer->m_MeasureMsgs = true;
     pPeer->m_pInfo = NULL;
     pPeer->m_Flags = 0;
     pPeer->m_Port = 0;
@@ -998,8 +1213,16 @@ void Node::Keys::SetSingleKey(const Key::IKdf::Ptr& pKdf)
         m_pMiner = MasterKey::get_Child(*pKdf, m_nMinerSubIndex);
 }
 
+void Node::ApplyPlacement(const ThreadPlacement& tp, const char* szRole)
+{
+    if (!tp.apply())
+        BEAM_LOG_WARNING() << "Couldn't apply the " << szRole << " thread placement";
+}
+
 void Node::Initialize(IExternalPOW* externalPOW)
 {
+    ApplyPlacement(m_Cfg.m_Placement.m_Reactor, "reactor");
+
     if (m_Cfg.m_VerificationThreads < 0)
         // use all the cores, don't subtract 'mining threads'. Verification has higher priority
         m_Cfg.m_VerificationThreads = m_Processor.m_ExecutorMT.get_Threads();
@@ -1007,8 +1230,33 @@ void Node::Initialize(IExternalPOW* externalPOW)
     m_Processor.m_ExecutorMT.set_Threads(std::max<uint32_t>(m_Cfg.m_VerificationThreads, 1U));
 
     m_Processor.m_Horizon = m_Cfg.m_Horizon;
+    m_Processor.m_BatchVerify.m_MaxBlocks = m_Cfg.m_VerificationBatchBlocks;
+
+    if (m_Cfg.m_ReadThreads)
+    {
+        m_ReadPath.set_Threads(m_Cfg.m_ReadThreads);
+        m_Cfg.m_ProcessorParams.m_SharedDB = true;
+    }
+
+    if (m_Cfg.m_Wal.m_Enabled)
+    {
+        m_Cfg.m_ProcessorParams.m_SharedDB = true;
+        m_Cfg.m_ProcessorParams.m_WalManualCheckpoint = true;
+    }
+
+    if (m_Cfg.m_Compaction.m_Period_ms)
+        m_Cfg.m_ProcessorParams.m_IncrementalVacuum = true;
+
+    m_Processor.m_SyncRanges.m_Count = m_Cfg.m_FastSync.m_MaxRanges;
+    m_Processor.m_SyncRanges.m_Size = m_Cfg.m_FastSync.m_RangeSize;
     m_Processor.Initialize(m_Cfg.m_sPathLocal.c_str(), m_Cfg.m_ProcessorParams, m_Cfg.m_Observer ? m_Cfg.m_Observer->GetLongActionHandler() : nullptr);
 
+    if (m_Cfg.m_Compaction.m_Period_ms)
+        m_Processor.StartCompaction();
+
+    if (m_Cfg.m_Wal.m_Enabled)
+        m_WalCheckpointer.Start(m_Cfg.m_sPathLocal, m_Cfg.m_Wal.m_CheckpointInterval_ms);
+
 	if (m_Cfg.m_ProcessorParams.m_EraseSelfID)
 	{
 		m_Processor.get_DB().ParamSet(NodeDB::ParamID::MyID, nullptr, nullptr);
@@ -1037,20 +1285,29 @@ void Node::Initialize(IExternalPOW* externalPOW)
 
     if (m_Cfg.m_Listen.port())
     {
-        m_Server.Listen(m_Cfg.m_Listen);
+        m_Server.Listen(m_Cfg.m_Listen, m_Cfg.m_ListenReusePort);
         if (m_Cfg.m_BeaconPeriod_ms)
             m_Beacon.Start();
     }
 
     m_PeerMan.Initialize();
     m_Miner.Initialize(externalPOW);
-	m_Processor.get_DB().get_BbsTotals(m_Bbs.m_Totals);
+    m_MemCtl.Initialize();
+
+    metrics::Registry::get().Add(m_Metrics);
+	if (m_Cfg.m_Bbs.m_Persist && m_Cfg.m_Bbs.IsEnabled())
+		m_Bbs.m_Store.Load(m_Processor.get_DB());
+	else
+		m_Processor.get_DB().BbsDelAll();
+
     m_Bbs.Cleanup();
-	m_Bbs.m_HighestPosted_s = m_Processor.get_DB().get_BbsMaxTime();
+	m_Bbs.m_HighestPosted_s = m_Bbs.m_Store.get_MaxTime();
 
     if (m_Cfg.m_TestMode.m_FakePowSolveTime_ms && Rules::get().FakePoW)
         m_PostStartSynced = true;
 
+    if (m_Cfg.m_PersistTxPool)
+        LoadTxPool();
 }
 
 uint32_t Node::get_AcessiblePeerCount() const
@@ -1360,25 +1617,20 @@ bool Node::Bbs::IsInLimits() const
 	const NodeDB::BbsTotals& lims = get_ParentObj().m_Cfg.m_Bbs.m_Limit;
 
 	return
-		(m_Totals.m_Count <= lims.m_Count) &&
-		(m_Totals.m_Size <= lims.m_Size);
+		(m_Store.m_Totals.m_Count <= lims.m_Count) &&
+		(m_Store.m_Totals.m_Size <= lims.m_Size);
 }
 
 void Node::Bbs::Cleanup()
 {
-	NodeDB& db = get_ParentObj().m_Processor.get_DB();
-	NodeDB::WalkerBbsTimeLen wlk;
-
-	Timestamp ts = getTimestamp() - get_ParentObj().m_Cfg.m_Bbs.m_MessageTimeout_s;
+	m_Store.DeleteOlder(getTimestamp() - get_ParentObj().m_Cfg.m_Bbs.m_MessageTimeout_s);
 
-	for (db.EnumAllBbs(wlk); wlk.MoveNext(); )
+	while (!IsInLimits())
 	{
-		if (IsInLimits() && (wlk.m_Time >= ts))
+		BbsStore::Element* p = m_Store.get_Oldest();
+		if (!p)
 			break;
-
-		db.BbsDel(wlk.m_ID);
-		m_Totals.m_Count--;
-		m_Totals.m_Size -= wlk.m_Size;
+		m_Store.Delete(*p);
 	}
 
 	m_LastCleanup_ms = GetTime_ms();
@@ -1395,9 +1647,206 @@ void Node::Bbs::MaybeCleanup()
 	Cleanup();
 }
 
+void Node::get_MemReport(MemReport& r)
+{
+	ZeroObject(r);
+
+	r.m_Process = get_process_rss();
+	r.m_TxPool = m_TxPool.m_Totals.m_Size;
+
+	for (auto it = m_Dandelion.m_setTime.begin(); m_Dandelion.m_setTime.end() != it; it++)
+		r.m_TxStem += it->get_ParentObj().m_Stats.m_Size + sizeof(TxPool::Stem::Element);
+
+	for (auto it = m_TxDependent.m_setTxs.begin(); m_TxDependent.m_setTxs.end() != it; it++)
+		r.m_TxDependent += it->get_ParentObj().m_Size + sizeof(TxPool::Dependent::Element);
+
+	r.m_ValidatedCache = m_Processor.m_ValCache.m_Mru.size() * sizeof(NodeProcessor::ValidatedCache::Entry);
+
+	for (PeerList::iterator it = m_lstPeers.begin(); m_lstPeers.end() != it; it++)
+	{
+		r.m_PeerBuffers += it->get_Unsent();
+		r.m_Peers++;
+	}
+
+	r.m_Mapped = m_Processor.get_MappedSize();
+	r.m_Db = m_Processor.get_DB().get_MemUsed();
+	r.m_Bbs = m_Bbs.m_Store.get_MemSize();
+	r.m_Shed = m_MemCtl.m_Shed;
+}
+
+void Node::MemReport::Print(std::ostream& os) const
+{
+	const uint32_t nMB = 1024 * 1024;
+
+	os
+		<< "Memory (MB): process=" << (m_Process / nMB)
+		<< ", txpool=" << (m_TxPool / nMB)
+		<< ", stem=" << (m_TxStem / nMB)
+		<< ", dependent=" << (m_TxDependent / nMB)
+		<< ", valcache=" << (m_ValidatedCache / nMB)
+		<< ", peers=" << (m_PeerBuffers / nMB) << " (" << m_Peers << ")"
+		<< ", mapped=" << (m_Mapped / nMB)
+		<< ", db=" << (m_Db / nMB)
+		<< ", bbs=" << (m_Bbs / nMB)
+		<< ", shed=" << m_Shed;
+}
+
+void Node::MemCtl::Initialize()
+{
+	const Config::Memory& cfg = get_ParentObj().m_Cfg.m_Memory;
+	if (!cfg.m_SoftLimit && !cfg.m_ReportPeriod_s)
+		return;
+
+	m_pTimer = io::Timer::create(io::Reactor::get_Current());
+	m_pTimer->start(cfg.m_Check_ms, true, [this]() { OnTimer(); });
+}
+
+void Node::MemCtl::OnTimer()
+{
+	Node& n = get_ParentObj();
+	const Config::Memory& cfg = n.m_Cfg.m_Memory;
+
+	if (cfg.m_ReportPeriod_s)
+	{
+		m_SinceReport_ms += cfg.m_Check_ms;
+		if (m_SinceReport_ms >= cfg.m_ReportPeriod_s * 1000)
+		{
+			m_SinceReport_ms = 0;
+
+			MemReport r;
+			n.get_MemReport(r);
+
+			std::ostringstream os;
+			r.Print(os);
+			BEAM_LOG_INFO() << os.str();
+		}
+	}
+
+	if (cfg.m_SoftLimit)
+	{
+		uint64_t nRss = get_process_rss();
+		if (nRss > cfg.m_SoftLimit)
+		{
+			BEAM_LOG_WARNING() << "Memory soft limit exceeded: " << (nRss >> 20) << " MB. Shedding";
+			Shed();
+		}
+	}
+}
+
+void Node::MemCtl::Shed()
+{
+	Node& n = get_ParentObj();
+	m_Shed++;
+
+	auto& vc = n.m_Processor.m_ValCache; // alias
+	vc.ShrinkTo(static_cast<uint32_t>(vc.m_Mru.size() / 2));
+
+	// the least profitable (and outdated) txs first, same as when the pool limits are hit
+	uint64_t nPoolTrg = n.m_TxPool.m_Totals.m_Size / 2;
+	while (n.m_TxPool.m_Totals.m_Size > nPoolTrg)
+	{
+		TxPool::Fluff::Element* pDel = n.m_TxPool.get_EvictCandidate();
+		if (!pDel)
+			break;
+		n.m_TxPool.Evict(*pDel);
+	}
+
+	n.m_Processor.m_CwpCropped.clear();
+	n.m_Processor.get_DB().ReleaseMemory();
+
+	trim_heap();
+}
+
+const char* Node::Metrics::get_MsgName(uint32_t iCode)
+{
+	switch (iCode)
+	{
+#define THE_MACRO(code, msg) case code: return #msg;
+		BeamNodeMsgsAll(THE_MACRO)
+#undef THE_MACRO
+	}
+
+	return "unknown";
+}
+
+void Node::Metrics::WriteMetrics(metrics::Writer& w)
+{
+	Node& n = get_ParentObj();
+
+	w.Type("beam_node_height", "gauge", "Height of the current tip");
+	w.Value("beam_node_height", uint64_t(n.m_Processor.m_Cursor.m_ID.m_Height));
+
+	w.Type("beam_node_peers", "gauge", "Connected peers");
+	w.Value("beam_node_peers", uint64_t(n.m_lstPeers.size()));
+
+	w.Type("beam_node_peers_known", "gauge", "Known peer addresses");
+	w.Value("beam_node_peers_known", uint64_t(n.get_AcessiblePeerCount()));
+
+	static const char* s_pDirs[] = { "in", "out" };
+	char szLabels[0x80];
+
+	w.Type("beam_node_msgs_total", "counter", "Peer messages, by type and direction");
+	for (uint32_t iCode = 0; iCode < _countof(m_pMsgs); iCode++)
+		for (uint32_t iDir = 0; iDir < 2; iDir++)
+			if (m_pMsgs[iCode].m_pCount[iDir])
+			{
+				snprintf(szLabels, sizeof(szLabels), "type=\"%s\",dir=\"%s\"", get_MsgName(iCode), s_pDirs[iDir]);
+				w.Value("beam_node_msgs_total", m_pMsgs[iCode].m_pCount[iDir], szLabels);
+			}
+
+	w.Type("beam_node_msg_bytes_total", "counter", "Peer message bytes, by type and direction");
+	for (uint32_t iCode = 0; iCode < _countof(m_pMsgs); iCode++)
+		for (uint32_t iDir = 0; iDir < 2; iDir++)
+			if (m_pMsgs[iCode].m_pCount[iDir])
+			{
+				snprintf(szLabels, sizeof(szLabels), "type=\"%s\",dir=\"%s\"", get_MsgName(iCode), s_pDirs[iDir]);
+				w.Value("beam_node_msg_bytes_total", m_pMsgs[iCode].m_pBytes[iDir], szLabels);
+			}
+
+	w.Type("beam_node_txpool_txs", "gauge", "Transactions in the pools");
+	w.Value("beam_node_txpool_txs", uint64_t(n.m_TxPool.m_setTxs.size()), "pool=\"fluff\"");
+	w.Value("beam_node_txpool_txs", uint64_t(n.m_Dandelion.m_setTime.size()), "pool=\"stem\"");
+	w.Value("beam_node_txpool_txs", uint64_t(n.m_TxDependent.m_setTxs.size()), "pool=\"dependent\"");
+
+	w.Type("beam_node_txpool_evicted_total", "counter", "Transactions evicted from the pool due to its limits");
+	w.Value("beam_node_txpool_evicted_total", n.m_TxPool.m_Totals.m_Evicted);
+
+	MemReport mr;
+	n.get_MemReport(mr);
+
+	w.Type("beam_node_memory_bytes", "gauge", "Memory per subsystem, estimated");
+	w.Value("beam_node_memory_bytes", mr.m_Process, "subsystem=\"process\"");
+	w.Value("beam_node_memory_bytes", mr.m_TxPool, "subsystem=\"txpool\"");
+	w.Value("beam_node_memory_bytes", mr.m_TxStem, "subsystem=\"txpool_stem\"");
+	w.Value("beam_node_memory_bytes", mr.m_TxDependent, "subsystem=\"txpool_dependent\"");
+	w.Value("beam_node_memory_bytes", mr.m_ValidatedCache, "subsystem=\"validated_cache\"");
+	w.Value("beam_node_memory_bytes", mr.m_PeerBuffers, "subsystem=\"peer_buffers\"");
+	w.Value("beam_node_memory_bytes", mr.m_Mapped, "subsystem=\"mapped\"");
+	w.Value("beam_node_memory_bytes", mr.m_Db, "subsystem=\"db\"");
+	w.Value("beam_node_memory_bytes", mr.m_Bbs, "subsystem=\"bbs\"");
+
+	const auto& vc = n.m_Processor.m_ValCache;
+	w.Type("beam_node_valcache_lookups_total", "counter", "Validated tx cache lookups, by result");
+	w.Value("beam_node_valcache_lookups_total", vc.m_Hits.load(), "result=\"hit\"");
+	w.Value("beam_node_valcache_lookups_total", vc.m_Misses.load(), "result=\"miss\"");
+
+	// HandleBlock - block apply, CommitDB - DB commit
+	typedef NodeProcessor::PerfStats PerfStats;
+	const PerfStats& ps = n.m_Processor.m_PerfStats;
+
+	w.Type("beam_node_stage_seconds", "histogram", "Latency of the node processing stages");
+	for (uint32_t i = 0; i < PerfStats::Stage::count; i++)
+	{
+		const PerfStats::Counter& c = ps.m_p[i];
+		snprintf(szLabels, sizeof(szLabels), "stage=\"%s\"", PerfStats::Stage::get_Name(static_cast<PerfStats::Stage::Enum>(i)));
+		w.Hist("beam_node_stage_seconds", c.m_pHist, PerfStats::Counter::s_Buckets, c.m_Count, c.m_Total_us, szLabels);
+	}
+}
+
 Node::~Node()
 {
     BEAM_LOG_INFO() << "Node stopping...";
+    metrics::Registry::get().Remove(m_Metrics);
 
     m_Miner.HardAbortSafe();
 	if (m_Miner.m_External.m_pSolver)
@@ -1414,6 +1863,15 @@ Node::~Node()
     }
     m_Miner.m_vThreads.clear();
 
+    m_ReadPath.Stop();
+    m_WalCheckpointer.Stop();
+
+    if (m_Cfg.m_PersistTxPool && m_Processor.get_DB().IsOpen())
+        SaveTxPool();
+
+    if (m_Cfg.m_Bbs.m_Persist && m_Cfg.m_Bbs.IsEnabled() && m_Processor.get_DB().IsOpen())
+        m_Bbs.m_Store.Save(m_Processor.get_DB());
+
     for (PeerList::iterator it = m_lstPeers.begin(); m_lstPeers.end() != it; ++it)
         it->m_LoginFlags = 0; // prevent re-assigning of tasks in the next loop
 
@@ -1438,6 +1896,20 @@ void Node::Peer::OnRequestTimeout()
 	assert(Flags::Connected & m_Flags);
 	assert(!m_lstTasks.empty());
 
+	if (m_HedgeTimeout_ms)
+	{
+		// the request is late, but not timed-out yet
+		uint32_t dt_ms = m_HedgeTimeout_ms;
+		m_HedgeTimeout_ms = 0;
+
+		Task& t = m_lstTasks.front();
+		t.m_bHedged = true;
+		m_This.TryHedgeTask(t);
+
+		m_pTimerRequest->start(dt_ms, false, [this]() { OnRequestTimeout(); });
+		return;
+	}
+
 	BEAM_LOG_WARNING() << "Peer " << m_RemoteAddr << " request timeout";
 
 	if (m_pInfo)
@@ -1485,6 +1957,18 @@ void Node::Peer::OnTrafic(uint8_t msgCode, uint32_t msgSize, bool bOut)
 {
     if (m_This.m_Cfg.m_LogTraficUsage)
         std::cout << "** " << (bOut ? "<-" : "->") << " " << m_RemoteAddr << " Size=" << msgSize << ", Msg=" << static_cast<uint32_t>(msgCode) << '\n';
+
+    if (bOut)
+        m_Bulk.m_BytesOut += msgSize;
+
+    Metrics::Msg& x = m_This.m_Metrics.m_pMsgs[msgCode];
+    x.m_pCount[bOut]++;
+    x.m_pBytes[bOut] += msgSize;
+}
+
+void Node::Peer::OnMsgTiming(uint8_t msgCode, uint64_t dt_us)
+{
+    m_This.m_Processor.m_PerfStats.m_p[NodeProcessor::PerfStats::Stage::PeerMsg].Add(dt_us);
 }
 
 void Node::Peer::OnConnectedSecure()
@@ -1570,6 +2054,7 @@ void Node::Peer::OnMsg(proto::Authentication&& msg)
 	}
 
     MaybeSendSerif();
+    MaybeSendEventsNew();
 
     if (proto::IDType::Node != msg.m_IDType)
         return;
@@ -1718,6 +2203,11 @@ bool Node::Peer::ShouldFinalizeMining()
         m_This.m_Cfg.m_PreferOnlineMining;
 }
 
+bool Node::Peer::IsClusterMember() const
+{
+    return m_pInfo && m_This.m_Beacon.IsClusterMember(m_pInfo->m_ID.m_Key);
+}
+
 void Node::Peer::OnMsg(proto::Bye&& msg)
 {
     BEAM_LOG_VERBOSE() << "Peer " << m_RemoteAddr << " Received Bye." << msg.m_Reason;
@@ -1785,22 +2275,62 @@ void Node::Peer::ReleaseTask(Task& t)
 
     if (t.m_nCount)
     {
-        uint32_t& nCounter = t.m_Key.second ? m_This.m_nTasksPackBody : m_This.m_nTasksPackHdr;
-        assert(nCounter >= t.m_nCount);
+        if (t.m_bRange)
+        {
+            assert(m_This.m_nTasksPackRange);
+            m_This.m_nTasksPackRange--;
+            t.m_bRange = false;
+        }
+        else
+        {
+            uint32_t& nCounter = t.m_Key.second ? m_This.m_nTasksPackBody : m_This.m_nTasksPackHdr;
+            assert(nCounter >= t.m_nCount);
 
-        nCounter -= t.m_nCount;
+            nCounter -= t.m_nCount;
+        }
 		t.m_nCount = 0;
     }
 
+    if (t.m_bCompact)
+    {
+        if (&m_lstTasks.front() == &t)
+            m_pCompactBody.reset();
+        t.m_bCompact = false;
+    }
+
     m_lstTasks.erase(TaskList::s_iterator_to(t));
     m_This.m_lstTasksUnassigned.push_back(t);
 
     if (t.m_bNeeded)
-        m_This.TryAssignTask(t);
+    {
+        Task* pCopy = m_This.FindTaskInFlight(t.m_Key);
+        if (pCopy)
+        {
+            // hedged, the other copy is still in flight
+            pCopy->m_bNeeded = true;
+            m_This.DeleteUnassignedTask(t);
+        }
+        else
+        {
+            t.m_bHedge = false;
+            m_This.TryAssignTask(t);
+        }
+    }
     else
         m_This.DeleteUnassignedTask(t);
 }
 
+uint32_t Node::Peer::get_BlockTasks() const
+{
+    uint32_t nBlocks = 0;
+    for (TaskList::const_iterator it = m_lstTasks.begin(); m_lstTasks.end() != it; ++it)
+    {
+        if (it->m_Key.second)
+            nBlocks++;
+    }
+    return nBlocks;
+}
+
 void Node::Peer::DeleteSelf(bool bIsError, uint8_t nByeReason)
 {
     BEAM_LOG_VERBOSE() << "-Peer " << m_RemoteAddr;
@@ -1827,6 +2357,16 @@ void Node::Peer::DeleteSelf(bool bIsError, uint8_t nByeReason)
     ReleaseTasks();
     Unsubscribe();
 
+    for (const auto& pQ : m_vReadQueries)
+        pQ->m_pPeer = nullptr; // the result will be discarded
+    m_vReadQueries.clear();
+
+    if (m_pHdrPack)
+    {
+        m_pHdrPack->m_pPeer = nullptr;
+        m_pHdrPack.reset();
+    }
+
     if (m_pInfo)
     {
 		PeerMan::PeerInfoPlus& pip = *m_pInfo;
@@ -1944,7 +2484,7 @@ void Node::Peer::OnMsg(proto::NewTip&& msg)
 
         case NodeProcessor::DataStatus::Accepted:
 			// don't give explicit reward for this header. Instead - most likely we'll request this block from that peer, and it'll have a chance to boost its rating
-            m_This.RefreshCongestions();
+            m_This.m_Processor.RefreshCongestionsAsync();
             break; // since we made OnPeerInsane handling asynchronous - no need to return rapidly
 
         default:
@@ -1976,7 +2516,7 @@ void Node::Peer::OnFirstTaskDone()
     SetTimerWrtFirstTask();
 
 	// Refrain from using TakeTasks(), it will only try to assign tasks to this peer
-	m_This.RefreshCongestions();
+	m_This.m_Processor.RefreshCongestionsAsync();
 	m_This.m_Processor.TryGoUpAsync();
 }
 
@@ -1985,6 +2525,9 @@ void Node::Peer::ModifyRatingWrtData(size_t nSize)
 	PeerManager::TimePoint tp;
 	uint32_t dt_ms = tp.get() - get_FirstTask().m_TimeAssigned_ms;
 
+	typedef NodeProcessor::PerfStats::Stage Stage;
+	m_This.m_Processor.m_PerfStats.m_p[get_FirstTask().m_Key.second ? Stage::BodyDownload : Stage::HdrDownload].Add(static_cast<uint64_t>(dt_ms) * 1000);
+
 	// Calculate the weighted average of the effective bandwidth.
 	// We assume the "previous" bandwidth bw0 was calculated within "previous" window t0, and the total download amount was v0 = t0 * bw0.
 	// Hence, after accounting for newly-downloaded data, the average bandwidth becomes:
@@ -2002,6 +2545,18 @@ void Node::Peer::ModifyRatingWrtData(size_t nSize)
 
 	uint32_t nRatingAvg = PeerManager::Rating::FromBps(bwAvg);
 
+	if (nSize)
+	{
+		// latency, w/o the estimated transfer time
+		uint64_t dtTransfer_ms = bw0 ? (static_cast<uint64_t>(nSize) * 1000 / bw0) : 0;
+		uint32_t dtRtt_ms = (dt_ms > dtTransfer_ms) ? static_cast<uint32_t>(dt_ms - dtTransfer_ms) : 0;
+
+		m_Rtt_ms = m_Rtt_ms ? static_cast<uint32_t>((static_cast<uint64_t>(m_Rtt_ms) * 7 + dtRtt_ms) / 8) : dtRtt_ms;
+
+		m_pInfo->m_Rtt_ms = std::max(m_Rtt_ms, 1U); // 0 means unknown
+		m_pInfo->m_LastGood = getTimestamp();
+	}
+
 	m_This.m_PeerMan.m_LiveSet.erase(PeerMan::LiveSet::s_iterator_to(Cast::Up<PeerMan::PeerInfoPlus>(m_pInfo)->m_Live));
 	m_This.m_PeerMan.SetRating(*m_pInfo, nRatingAvg);
 	m_This.m_PeerMan.m_LiveSet.insert(Cast::Up<PeerMan::PeerInfoPlus>(m_pInfo)->m_Live);
@@ -2116,50 +2671,252 @@ void Node::Peer::OnMsg(proto::HdrPack&& msg)
 		ThrowUnexpected();
 	}
 
-	std::vector<Block::SystemState::Full> v;
-	if (!m_This.DecodeAndCheckHdrs(v, msg))
-        ThrowUnexpected();
-
-	// just to be pedantic
-	Block::SystemState::ID idLast;
-	v.back().get_ID(idLast);
-	if (idLast != t.m_Key.first)
+	if (msg.m_vElements.empty() || (msg.m_vElements.size() > proto::g_HdrPackMaxSize))
 		ThrowUnexpected();
 
-    for (size_t i = 0; i < v.size(); i++)
-    {
-        NodeProcessor::DataStatus::Enum eStatus = m_This.m_Processor.OnStateSilent(v[i], m_pInfo->m_ID.m_Key, idLast, true);
-        switch (eStatus)
-        {
-        case NodeProcessor::DataStatus::Invalid:
-			// though PoW was already tested, header can still be invalid. For instance, due to improper Timestamp
-			ThrowUnexpected();
-			break;
-
-        case NodeProcessor::DataStatus::Accepted:
-			// no break;
-
-        default:
-            break; // suppress warning
-        }
-    }
+	auto pPack = std::make_shared<HdrVerifier::Pack>();
+	proto::FlyClient::Data::DecodedHdrPack::Decode(pPack->m_vStates, msg);
 
-	BEAM_LOG_INFO() << "Hdr pack received " << msg.m_Prefix.m_Height << "-" << idLast;
+	// just to be pedantic
+	pPack->m_vStates.back().get_ID(pPack->m_idLast);
+	if (pPack->m_idLast != t.m_Key.first)
+		ThrowUnexpected();
 
 	ModifyRatingWrtData(sizeof(msg.m_Prefix) + msg.m_vElements.size() * sizeof(msg.m_vElements.front()));
 
-	OnFirstTaskDone(NodeProcessor::DataStatus::Accepted);
-	m_This.UpdateSyncStatus();
+	// the task is complete, the verification time should not be accounted as the peer latency
+	if (m_pTimerRequest)
+		m_pTimerRequest->cancel();
+
+	m_This.m_HdrVerifier.Post(*this, std::move(pPack));
 }
 
-void Node::Peer::OnMsg(proto::GetBody&& msg)
+void Node::Peer::OnHdrPackVerified(HdrVerifier::Pack& pack)
 {
-	proto::GetBodyPack msg2;
-	msg2.m_Top = msg.m_ID;
+	try {
+		if (!pack.m_bValid)
+			ThrowUnexpected();
+
+		assert(!m_lstTasks.empty() && (get_FirstTask().m_Key.first == pack.m_idLast));
+
+		for (size_t i = 0; i < pack.m_vStates.size(); i++)
+		{
+			Block::SystemState::ID id;
+			NodeProcessor::DataStatus::Enum eStatus = m_This.m_Processor.OnStateSilent(pack.m_vStates[i], m_pInfo->m_ID.m_Key, id, true);
+			switch (eStatus)
+			{
+			case NodeProcessor::DataStatus::Invalid:
+				// though PoW was already tested, header can still be invalid. For instance, due to improper Timestamp
+				ThrowUnexpected();
+				break;
+
+			case NodeProcessor::DataStatus::Accepted:
+				// no break;
+
+			default:
+				break; // suppress warning
+			}
+		}
+
+		BEAM_LOG_INFO() << "Hdr pack received " << pack.m_vStates.front().m_Height << "-" << pack.m_idLast;
+
+		OnFirstTaskDone(NodeProcessor::DataStatus::Accepted);
+		m_This.UpdateSyncStatus();
+
+	} catch (const std::exception& e) {
+		OnExc(e);
+		return; // may be deleted
+	}
+
+	ResumeInput(); // may be deleted
+}
+
+struct Node::HdrVerifier::Task
+	:public Executor::TaskAsync
+{
+	HdrVerifier* m_pThis;
+	Pack::Ptr m_pPack;
+	uint32_t m_i0;
+	uint32_t m_nCount;
+
+	virtual void Exec(Executor::Context&) override
+	{
+		Pack& p = *m_pPack;
+		for (uint32_t i = 0; (i < m_nCount) && p.m_bValid; i++)
+			if (!p.m_vStates[m_i0 + i].IsValid())
+				p.m_bValid = false;
+
+		if (--p.m_nPending)
+			return;
+
+		std::unique_lock<std::mutex> scope(m_pThis->m_Mutex);
+		m_pThis->m_vDone.push_back(std::move(m_pPack));
+		m_pThis->m_pEvtDone->post();
+	}
+};
+
+void Node::HdrVerifier::Post(Peer& p, Pack::Ptr&& pPack)
+{
+	assert(!p.m_pHdrPack);
+
+	if (!m_pEvtDone)
+		m_pEvtDone = io::AsyncEvent::create(io::Reactor::get_Current(), [this]() { OnDone(); });
+
+	Executor& ex = get_ParentObj().m_Processor.get_Executor();
+
+	// split into portions, each is verified by a separate task
+	uint32_t nTotal = static_cast<uint32_t>(pPack->m_vStates.size());
+	uint32_t nTasks = std::min(ex.get_Threads(), (nTotal + s_MinPortion - 1) / s_MinPortion);
+	std::setmax(nTasks, 1U);
+
+	pPack->m_pPeer = &p;
+	pPack->m_bValid = true;
+	pPack->m_nPending = nTasks;
+
+	p.m_pHdrPack = pPack;
+	p.SuspendInput();
+
+	for (uint32_t iTask = 0, i0 = 0; iTask < nTasks; iTask++)
+	{
+		uint32_t i1 = static_cast<uint32_t>(static_cast<uint64_t>(nTotal) * (iTask + 1) / nTasks);
+
+		auto pTask = std::make_unique<Task>();
+		pTask->m_pThis = this;
+		pTask->m_pPack = pPack;
+		pTask->m_i0 = i0;
+		pTask->m_nCount = i1 - i0;
+		pTask->m_Priority = Executor::Priority::High; // the sync is stalled meanwhile
+		ex.Push(std::move(pTask));
+
+		i0 = i1;
+	}
+}
+
+void Node::HdrVerifier::OnDone()
+{
+	std::vector<Pack::Ptr> v;
+	{
+		std::unique_lock<std::mutex> scope(m_Mutex);
+		v.swap(m_vDone);
+	}
+
+	for (const auto& pPack : v)
+	{
+		Peer* pPeer = pPack->m_pPeer;
+		if (!pPeer)
+			continue; // peer is gone
+
+		assert(pPeer->m_pHdrPack == pPack);
+		pPeer->m_pHdrPack.reset();
+		pPack->m_pPeer = nullptr;
+
+		pPeer->OnHdrPackVerified(*pPack);
+	}
+}
+
+void Node::Peer::OnMsg(proto::GetBody&& msg)
+{
+	proto::GetBodyPack msg2;
+	msg2.m_Top = msg.m_ID;
 	OnMsg(std::move(msg2));
 }
 
 void Node::Peer::OnMsg(proto::GetBodyPack&& msg)
+{
+	uint32_t nWait_ms;
+	if (ShouldDeferBulk(nWait_ms))
+	{
+		m_Bulk.m_pPending = std::make_unique<proto::GetBodyPack>(std::move(msg));
+		m_Bulk.m_PendingTag = m_TagIn;
+		SuspendInput();
+
+		if (!m_Bulk.m_pTimer)
+			m_Bulk.m_pTimer = io::Timer::create(io::Reactor::get_Current());
+		m_Bulk.m_pTimer->start(nWait_ms, false, [this]() { OnBulkTimer(); });
+		return;
+	}
+
+	ServeBulk(msg);
+}
+
+void Node::Peer::OnBulkTimer()
+{
+	assert(m_Bulk.m_pPending);
+
+	uint32_t nWait_ms;
+	if (ShouldDeferBulk(nWait_ms))
+	{
+		m_Bulk.m_pTimer->start(nWait_ms, false, [this]() { OnBulkTimer(); });
+		return;
+	}
+
+	auto pMsg = std::move(m_Bulk.m_pPending);
+
+	try {
+		TagScope scope(m_TagOut, m_Bulk.m_PendingTag);
+		ServeBulk(*pMsg);
+	} catch (const std::exception& e) {
+		OnExc(e);
+		return; // may be deleted
+	}
+
+	ResumeInput(); // may be deleted
+}
+
+Node::Config::BandwidthCtl::PeerClass::Enum Node::Peer::get_Class() const
+{
+	typedef Config::BandwidthCtl::PeerClass PeerClass;
+
+	if (Flags::Owner & m_Flags)
+		return PeerClass::Owner;
+	return m_pInfo ? PeerClass::Full : PeerClass::Light;
+}
+
+bool Node::Peer::ShouldDeferBulk(uint32_t& nWait_ms)
+{
+	const Config::BandwidthCtl& bc = m_This.m_Cfg.m_BandwidthCtl;
+
+	if (get_Unsent() > bc.m_BulkBacklog)
+	{
+		nWait_ms = Bulk::s_Poll_ms;
+		return true;
+	}
+
+	const Config::BandwidthCtl::Bucket& b = bc.m_pBulk[get_Class()];
+	if (!b.m_Rate)
+		return false;
+
+	uint32_t t_ms = GetTime_ms();
+	if (m_Bulk.m_bInit)
+	{
+		uint32_t dt_ms = t_ms - m_Bulk.m_Refill_ms;
+		m_Bulk.m_Tokens += static_cast<int64_t>(b.m_Rate) * dt_ms / 1000;
+		std::setmin(m_Bulk.m_Tokens, static_cast<int64_t>(b.m_Burst));
+	}
+	else
+	{
+		m_Bulk.m_Tokens = b.m_Burst;
+		m_Bulk.m_bInit = true;
+	}
+	m_Bulk.m_Refill_ms = t_ms;
+
+	if (m_Bulk.m_Tokens >= 0)
+		return false;
+
+	nWait_ms = static_cast<uint32_t>(-m_Bulk.m_Tokens * 1000 / b.m_Rate) + 1;
+	return true;
+}
+
+void Node::Peer::ServeBulk(const proto::GetBodyPack& msg)
+{
+	uint64_t nBytes0 = m_Bulk.m_BytesOut;
+	ServeBodyPack(msg);
+
+	if (m_Bulk.m_bInit)
+		m_Bulk.m_Tokens -= static_cast<int64_t>(m_Bulk.m_BytesOut - nBytes0);
+}
+
+void Node::Peer::ServeBodyPack(const proto::GetBodyPack& msg)
 {
 	Processor& p = m_This.m_Processor; // alias
 
@@ -2185,6 +2942,9 @@ void Node::Peer::OnMsg(proto::GetBodyPack&& msg)
 					sid.m_Height -= msg.m_CountExtra;
 					Height hMax = std::min(msg.m_Top.m_Height, sid.m_Height + m_This.m_Cfg.m_BandwidthCtl.m_MaxBodyPackCount);
 
+					if (SendBodyPackRef(sid, hMax, msg))
+						return;
+
 					for (; sid.m_Height <= hMax; sid.m_Height++)
 					{
 						sid.m_Row = p.FindActiveAtStrict(sid.m_Height);
@@ -2209,6 +2969,13 @@ void Node::Peer::OnMsg(proto::GetBodyPack&& msg)
 			}
 			else
 			{
+				proto::BodyBuffersRef bbr;
+				if (GetBlockRef(bbr, sid, msg))
+				{
+					SendBody(bbr);
+					return;
+				}
+
 				proto::Body msgBody;
 				if (GetBlock(msgBody.m_Body, sid, msg, false))
 				{
@@ -2293,6 +3060,76 @@ bool Node::Peer::GetBlock(proto::BodyBuffers& out, const NodeDB::StateID& sid, c
 	return true;
 }
 
+bool Node::Peer::GetBlockRef(proto::BodyBuffersRef& out, const NodeDB::StateID& sid, const proto::GetBodyPack& msg)
+{
+	// only the parts that are sent as-is
+	Blob* pP = nullptr;
+	Blob* pE = nullptr;
+
+	switch (msg.m_FlagE)
+	{
+	case proto::BodyBuffers::Full:
+		pE = &out.m_Eternal;
+		break;
+	case proto::BodyBuffers::None:
+		break;
+	default:
+		return false;
+	}
+
+	switch (msg.m_FlagP)
+	{
+	case proto::BodyBuffers::Full:
+		pP = &out.m_Perishable;
+		break;
+	case proto::BodyBuffers::None:
+		break;
+	default:
+		return false;
+	}
+
+	return m_This.m_Processor.GetBlockRef(sid, pE, pP, msg.m_Height0, msg.m_HorizonLo1, msg.m_HorizonHi1);
+}
+
+bool Node::Peer::SendBodyPackRef(NodeDB::StateID sid, Height hMax, const proto::GetBodyPack& msg)
+{
+	Processor& p = m_This.m_Processor; // alias
+	if (!p.get_DB().IsBodyStore())
+		return false;
+
+	std::vector<proto::BodyBuffersRef> v;
+	size_t nSize = 0;
+
+	for (; sid.m_Height <= hMax; sid.m_Height++)
+	{
+		sid.m_Row = p.FindActiveAtStrict(sid.m_Height);
+
+		proto::BodyBuffersRef bbr;
+		if (!GetBlockRef(bbr, sid, msg))
+			break; // the rest will be requested again
+
+		nSize += bbr.m_Eternal.n + bbr.m_Perishable.n;
+		v.push_back(bbr);
+
+		if (nSize >= m_This.m_Cfg.m_BandwidthCtl.m_MaxBodyPackSize)
+			break;
+	}
+
+	if (v.empty())
+		return false;
+
+	// the bodies are sent straight from the mapping, the socket write would fault their pages in one by one.
+	// Kick off the reads for the whole pack at once, so that the disk sees them as a batch
+	for (const auto& bbr : v)
+	{
+		MappedFileRaw::WillNeed(bbr.m_Eternal.p, bbr.m_Eternal.n);
+		MappedFileRaw::WillNeed(bbr.m_Perishable.p, bbr.m_Perishable.n);
+	}
+
+	SendBodyPack(v);
+	return true;
+}
+
 bool Node::Peer::ShouldAcceptBodyPack()
 {
     Task& t = get_FirstTask();
@@ -2381,6 +3218,273 @@ void Node::Peer::OnMsg(proto::BodyPack&& msg)
 	OnFirstTaskDone(eStatus);
 }
 
+bool Node::Peer::LoadBody(Block::Body& block, proto::BodyBuffers& bb, const Block::SystemState::ID& id)
+{
+	Processor& p = m_This.m_Processor; // alias
+
+	NodeDB::StateID sid;
+	sid.m_Row = p.get_DB().StateFindSafe(id);
+	if (!sid.m_Row)
+		return false;
+	sid.m_Height = id.m_Height;
+
+	proto::GetBodyPack msg; // full body
+	if (!GetBlock(bb, sid, msg, false))
+		return false;
+
+	Deserializer der;
+	der.reset(bb.m_Perishable);
+	der & Cast::Down<Block::BodyBase>(block);
+	der & Cast::Down<TxVectors::Perishable>(block);
+
+	der.reset(bb.m_Eternal);
+	der & Cast::Down<TxVectors::Eternal>(block);
+
+	return true;
+}
+
+void Node::Peer::OnMsg(proto::GetBodyCompact&& msg)
+{
+	Block::Body block;
+	proto::BodyBuffers bb;
+	if (!msg.m_ID.m_Height || !LoadBody(block, bb, msg.m_ID))
+	{
+		Send(proto::DataMissing());
+		return;
+	}
+
+	proto::BodyCompact msgOut;
+	msgOut.m_Offset = block.m_Offset;
+	proto::CompactBody::get_Hash(msgOut.m_BodyHash, bb.m_Perishable, bb.m_Eternal);
+
+	msgOut.m_Inputs.reserve(block.m_vInputs.size());
+	for (const auto& pInp : block.m_vInputs)
+		msgOut.m_Inputs.push_back(proto::CompactBody::get_ShortID(pInp->m_Commitment));
+
+	msgOut.m_Outputs.reserve(block.m_vOutputs.size());
+	for (const auto& pOutp : block.m_vOutputs)
+		msgOut.m_Outputs.push_back(proto::CompactBody::get_ShortID(pOutp->m_Commitment));
+
+	msgOut.m_Kernels.reserve(block.m_vKernels.size());
+	for (const auto& pKrn : block.m_vKernels)
+		msgOut.m_Kernels.push_back(proto::CompactBody::get_ShortID(pKrn->m_Internal.m_ID));
+
+	Send(msgOut);
+}
+
+void Node::Peer::OnMsg(proto::GetBodyElements&& msg)
+{
+	Block::Body block;
+	proto::BodyBuffers bb;
+	if (!LoadBody(block, bb, msg.m_ID))
+	{
+		Send(proto::DataMissing());
+		return;
+	}
+
+	proto::BodyElements msgOut;
+	msgOut.m_Elements = std::make_shared<Transaction>();
+	TxVectors::Writer wtx(*msgOut.m_Elements, *msgOut.m_Elements);
+
+	for (uint32_t i : msg.m_Inputs)
+	{
+		if (i >= block.m_vInputs.size())
+			ThrowUnexpected();
+		wtx.Write(*block.m_vInputs[i]);
+	}
+
+	for (uint32_t i : msg.m_Outputs)
+	{
+		if (i >= block.m_vOutputs.size())
+			ThrowUnexpected();
+		wtx.Write(*block.m_vOutputs[i]);
+	}
+
+	for (uint32_t i : msg.m_Kernels)
+	{
+		if (i >= block.m_vKernels.size())
+			ThrowUnexpected();
+		wtx.Write(*block.m_vKernels[i]);
+	}
+
+	Send(msgOut);
+}
+
+void Node::Peer::ReconstructFromPool(Block::Body& block, const proto::BodyCompact& msg)
+{
+	// short ID -> index in the block. Ambiguous IDs are left for the explicit request
+	typedef std::map<uint64_t, uint32_t> IdxMap;
+	const uint32_t nAmbiguous = static_cast<uint32_t>(-1);
+
+	struct Idx
+	{
+		IdxMap m_Map;
+
+		void Init(const std::vector<uint64_t>& v, uint32_t nAmbiguous)
+		{
+			for (uint32_t i = 0; i < v.size(); i++)
+			{
+				auto res = m_Map.emplace(v[i], i);
+				if (!res.second)
+					res.first->second = nAmbiguous;
+			}
+		}
+
+		uint32_t Find(uint64_t id, uint32_t nAmbiguous) const
+		{
+			auto it = m_Map.find(id);
+			return (m_Map.end() == it) ? nAmbiguous : it->second;
+		}
+
+	} pIdx[3];
+
+	pIdx[0].Init(msg.m_Inputs, nAmbiguous);
+	pIdx[1].Init(msg.m_Outputs, nAmbiguous);
+	pIdx[2].Init(msg.m_Kernels, nAmbiguous);
+
+	block.m_vInputs.resize(msg.m_Inputs.size());
+	block.m_vOutputs.resize(msg.m_Outputs.size());
+	block.m_vKernels.resize(msg.m_Kernels.size());
+
+	const TxPool::Fluff& txp = m_This.m_TxPool;
+	for (auto it = txp.m_setTxs.begin(); txp.m_setTxs.end() != it; ++it)
+	{
+		const Transaction& tx = *it->get_ParentObj().m_pValue;
+
+		for (const auto& pInp : tx.m_vInputs)
+		{
+			uint32_t i = pIdx[0].Find(proto::CompactBody::get_ShortID(pInp->m_Commitment), nAmbiguous);
+			if ((nAmbiguous != i) && !block.m_vInputs[i])
+			{
+				block.m_vInputs[i].reset(new Input);
+				*block.m_vInputs[i] = *pInp;
+			}
+		}
+
+		for (const auto& pOutp : tx.m_vOutputs)
+		{
+			uint32_t i = pIdx[1].Find(proto::CompactBody::get_ShortID(pOutp->m_Commitment), nAmbiguous);
+			if ((nAmbiguous != i) && !block.m_vOutputs[i])
+			{
+				block.m_vOutputs[i].reset(new Output);
+				*block.m_vOutputs[i] = *pOutp;
+			}
+		}
+
+		for (const auto& pKrn : tx.m_vKernels)
+		{
+			uint32_t i = pIdx[2].Find(proto::CompactBody::get_ShortID(pKrn->m_Internal.m_ID), nAmbiguous);
+			if ((nAmbiguous != i) && !block.m_vKernels[i])
+				pKrn->Clone(block.m_vKernels[i]);
+		}
+	}
+}
+
+void Node::Peer::OnMsg(proto::BodyCompact&& msg)
+{
+	Task& t = get_FirstTask();
+	if (!t.m_bCompact || m_pCompactBody)
+		ThrowUnexpected();
+
+	auto pC = std::make_unique<CompactBody>();
+	pC->m_ID = t.m_Key.first;
+	pC->m_hvBody = msg.m_BodyHash;
+
+	Block::Body& block = pC->m_Body;
+	block.ZeroInit();
+	block.m_Offset = msg.m_Offset;
+
+	ReconstructFromPool(block, msg);
+
+	proto::GetBodyElements& msgOut = pC->m_Missing;
+	msgOut.m_ID = pC->m_ID;
+
+	for (uint32_t i = 0; i < block.m_vInputs.size(); i++)
+		if (!block.m_vInputs[i])
+			msgOut.m_Inputs.push_back(i);
+
+	for (uint32_t i = 0; i < block.m_vOutputs.size(); i++)
+		if (!block.m_vOutputs[i])
+			msgOut.m_Outputs.push_back(i);
+
+	for (uint32_t i = 0; i < block.m_vKernels.size(); i++)
+		if (!block.m_vKernels[i])
+			msgOut.m_Kernels.push_back(i);
+
+	BEAM_LOG_INFO() << pC->m_ID << " Compact body, missing " << msgOut.m_Inputs.size() << "/" << block.m_vInputs.size() << " inputs, "
+		<< msgOut.m_Outputs.size() << "/" << block.m_vOutputs.size() << " outputs, "
+		<< msgOut.m_Kernels.size() << "/" << block.m_vKernels.size() << " kernels";
+
+	if (msgOut.m_Inputs.empty() && msgOut.m_Outputs.empty() && msgOut.m_Kernels.empty())
+		FinishCompactBody(*pC);
+	else
+	{
+		Send(msgOut);
+		m_pCompactBody = std::move(pC);
+	}
+}
+
+void Node::Peer::OnMsg(proto::BodyElements&& msg)
+{
+	if (!m_pCompactBody || !msg.m_Elements)
+		ThrowUnexpected();
+
+	std::unique_ptr<CompactBody> pC = std::move(m_pCompactBody);
+	Block::Body& block = pC->m_Body;
+	const proto::GetBodyElements& req = pC->m_Missing;
+	Transaction& tx = *msg.m_Elements;
+
+	if ((tx.m_vInputs.size() != req.m_Inputs.size()) ||
+		(tx.m_vOutputs.size() != req.m_Outputs.size()) ||
+		(tx.m_vKernels.size() != req.m_Kernels.size()))
+		ThrowUnexpected();
+
+	for (size_t i = 0; i < req.m_Inputs.size(); i++)
+		block.m_vInputs[req.m_Inputs[i]] = std::move(tx.m_vInputs[i]);
+	for (size_t i = 0; i < req.m_Outputs.size(); i++)
+		block.m_vOutputs[req.m_Outputs[i]] = std::move(tx.m_vOutputs[i]);
+	for (size_t i = 0; i < req.m_Kernels.size(); i++)
+		block.m_vKernels[req.m_Kernels[i]] = std::move(tx.m_vKernels[i]);
+
+	FinishCompactBody(*pC);
+}
+
+void Node::Peer::FinishCompactBody(CompactBody& c)
+{
+	Task& t = get_FirstTask();
+	if (!t.m_bCompact || (t.m_Key.first != c.m_ID))
+		ThrowUnexpected();
+
+	proto::Body msg;
+
+	Serializer ser;
+	ser & Cast::Down<Block::BodyBase>(c.m_Body);
+	ser & Cast::Down<TxVectors::Perishable>(c.m_Body);
+	ser.swap_buf(msg.m_Body.m_Perishable);
+
+	ser.reset();
+	ser & Cast::Down<TxVectors::Eternal>(c.m_Body);
+	ser.swap_buf(msg.m_Body.m_Eternal);
+
+	Merkle::Hash hv;
+	proto::CompactBody::get_Hash(hv, msg.m_Body.m_Perishable, msg.m_Body.m_Eternal);
+
+	t.m_bCompact = false;
+
+	if (hv != c.m_hvBody)
+	{
+		// short ID collision, or the peer is cheating. Request the full body
+		BEAM_LOG_INFO() << c.m_ID << " Compact body reconstruction mismatch, requesting full";
+
+		proto::GetBodyPack msgFull;
+		msgFull.m_Top = c.m_ID;
+		Send(msgFull);
+		return;
+	}
+
+	OnMsg(std::move(msg));
+}
+
 void Node::Peer::OnFirstTaskDone(NodeProcessor::DataStatus::Enum eStatus)
 {
     if (NodeProcessor::DataStatus::Invalid == eStatus)
@@ -2416,13 +3520,14 @@ void Node::Peer::OnMsg(proto::NewTransaction&& msg)
     }
     else
     {
-        m_This.OnTransactionDeferred(std::move(msg.m_Transaction), std::move(msg.m_Context), pSender, msg.m_Fluff);
+        m_This.OnTransactionDeferred(std::move(msg.m_Transaction), std::move(msg.m_Context), pSender, msg.m_Fluff, !!(Flags::Owner & m_Flags));
     }
 }
 
-void Node::OnTransactionDeferred(Transaction::Ptr&& pTx, std::unique_ptr<Merkle::Hash>&& pCtx, const PeerID* pSender, bool bFluff)
+void Node::OnTransactionDeferred(Transaction::Ptr&& pTx, std::unique_ptr<Merkle::Hash>&& pCtx, const PeerID* pSender, bool bFluff, bool bOwn)
 {
     TxDeferred::Element txd;
+    txd.m_Priority = TxDeferred::get_Priority(*pTx, m_Processor.m_Cursor.m_ID.m_Height + 1, bOwn);
     txd.m_pTx = std::move(pTx);
     txd.m_pCtx = std::move(pCtx);
     txd.m_Fluff = bFluff;
@@ -2442,22 +3547,328 @@ void Node::OnTransactionDeferred(Transaction::Ptr&& pTx, std::unique_ptr<Merkle:
 
     if (m_TxDeferred.m_lst.empty())
         m_TxDeferred.start();
-    else
+
+    m_TxDeferred.Insert(std::move(txd));
+
+    // drop the least prioritized, which may be the new one
+    while (m_TxDeferred.m_lst.size() > m_Cfg.m_MaxDeferredTransactions)
+        m_TxDeferred.m_lst.pop_back();
+
+    m_TxDeferred.TryVerify();
+}
+
+std::string Node::get_TxPoolPath() const
+{
+    return m_Cfg.m_sPathLocal + ".txpool";
+}
+
+void Node::SaveTxPool()
+{
+    struct Record
+    {
+        Transaction::Ptr m_pTx;
+        Amount m_Fee; // profit metadata, defines the re-submission order
+        uint32_t m_Size;
+        bool m_Fluff;
+    };
+
+    std::vector<Record> v;
+
+    for (auto it = m_TxPool.m_setTxs.begin(); m_TxPool.m_setTxs.end() != it; ++it)
+    {
+        const TxPool::Fluff::Element& x = it->get_ParentObj();
+        if (TxPool::Fluff::State::Outdated == x.m_State)
+            continue;
+
+        v.push_back({ x.m_pValue, x.m_Profit.m_Stats.m_Fee, x.m_Profit.m_Stats.m_Size, true });
+    }
+
+    for (auto it = m_Dandelion.m_setProfit.begin(); m_Dandelion.m_setProfit.end() != it; ++it)
     {
-        while (m_TxDeferred.m_lst.size() > m_Cfg.m_MaxDeferredTransactions)
-            m_TxDeferred.m_lst.pop_front();
+        const TxPool::Stem::Element& x = it->get_ParentObj();
+        if (x.m_pValue)
+            v.push_back({ x.m_pValue, x.m_Profit.m_Stats.m_Fee, x.m_Profit.m_Stats.m_Size, false });
     }
 
-    m_TxDeferred.m_lst.push_back(std::move(txd));
+    // not verified yet. Dependent txs are not saved, their context is unlikely to survive
+    for (const auto& x : m_TxDeferred.m_lst)
+        if (!x.m_pCtx)
+            v.push_back({ x.m_pTx, 0, 0, x.m_Fluff });
+
+    std::string sPath = get_TxPoolPath();
+
+    try
+    {
+        std::FStream f;
+        f.Open(sPath.c_str(), false, true);
+
+        yas::binary_oarchive<std::FStream, SERIALIZE_OPTIONS> ser(f);
+
+        uint32_t nVersion = 1, nCount = static_cast<uint32_t>(v.size());
+        ser & nVersion;
+        ser & nCount;
+
+        for (const auto& x : v)
+        {
+            ser & x.m_Fluff;
+            ser & x.m_Fee;
+            ser & x.m_Size;
+            ser & *x.m_pTx;
+        }
+
+        f.Flush();
+
+        BEAM_LOG_INFO() << "Tx pool saved, " << nCount << " txs";
+    }
+    catch (const std::exception& e)
+    {
+        BEAM_LOG_WARNING() << "Tx pool save failed: " << e.what();
+        beam::DeleteFile(sPath.c_str());
+    }
 }
 
-void Node::TxDeferred::OnSchedule()
+void Node::LoadTxPool()
+{
+    std::string sPath = get_TxPoolPath();
+
+    std::FStream f;
+    if (!f.Open(sPath.c_str(), true))
+        return;
+
+    struct Record
+        :public TxPool::Profit
+    {
+        Transaction::Ptr m_pTx;
+        bool m_Fluff;
+    };
+
+    std::vector<Record> v;
+
+    try
+    {
+        yas::binary_iarchive<std::FStream, SERIALIZE_OPTIONS> der(f);
+
+        uint32_t nVersion = 0, nCount = 0;
+        der & nVersion;
+        if (1 != nVersion)
+            throw std::runtime_error("unsupported version");
+
+        der & nCount;
+        v.reserve(std::min(nCount, m_Cfg.m_MaxDeferredTransactions));
+
+        for (uint32_t i = 0; i < nCount; i++)
+        {
+            Record& x = v.emplace_back();
+            ZeroObject(x.m_Stats);
+
+            der & x.m_Fluff;
+            der & x.m_Stats.m_Fee;
+            der & x.m_Stats.m_Size;
+
+            x.m_pTx = std::make_shared<Transaction>();
+            der & *x.m_pTx;
+        }
+    }
+    catch (const std::exception& e)
+    {
+        BEAM_LOG_WARNING() << "Tx pool load failed: " << e.what();
+        v.clear();
+    }
+
+    f.Close();
+    beam::DeleteFile(sPath.c_str()); // re-written on the next shutdown
+
+    // most profitable first, they're verified first, and survive the deferred queue limit. Unknown profit (not verified) go last
+    std::stable_sort(v.begin(), v.end(), [](const Record& a, const Record& b)
+    {
+        if (!a.m_Stats.m_Size || !b.m_Stats.m_Size)
+            return a.m_Stats.m_Size > b.m_Stats.m_Size;
+        return a < b;
+    });
+
+    if (v.size() > m_Cfg.m_MaxDeferredTransactions)
+        v.resize(m_Cfg.m_MaxDeferredTransactions);
+
+    for (auto& x : v)
+        OnTransactionDeferred(std::move(x.m_pTx), nullptr, nullptr, x.m_Fluff);
+
+    BEAM_LOG_INFO() << "Tx pool loaded, " << v.size() << " txs re-submitted";
+}
+
+struct Node::TxDeferred::VerifyTask
+    :public Executor::TaskAsync
 {
+    TxDeferred* m_pThis;
+    Verification::Ptr m_pVerify;
+
+    virtual void Exec(Executor::Context&) override
+    {
+        Verification& v = *m_pVerify;
+
+        // don't use the thread batch context, it may contain pending block verification
+        ECC::InnerProduct::BatchContextEx<4> bc;
+        ECC::InnerProduct::BatchContext::Scope scope(bc);
+
+        try {
+            v.m_Ctx.ValidateAndSummarizeStrict(*v.m_pTx, v.m_pTx->get_Reader());
+
+            if (!bc.Flush())
+                Exc::Fail("Batch verification");
+
+            v.m_bValid = true;
+        } catch (const std::exception& e) {
+            v.m_sErr = e.what();
+        }
+
+        std::unique_lock<std::mutex> scopeDone(m_pThis->m_Mutex);
+        m_pThis->m_vDone.push_back(std::move(m_pVerify));
+        m_pThis->m_pEvtDone->post();
+    }
+};
+
+void Node::TxDeferred::TryVerify()
+{
+    const Config::TxVerify& cfg = get_ParentObj().m_Cfg.m_TxVerify;
+
+    uint32_t n = 0;
+    for (auto it = m_lst.begin(); (m_lst.end() != it) && (n < s_Window) && (m_nInFlight < cfg.m_MaxInFlight); ++it, ++n)
+    {
+        Element& x = *it;
+        if (x.m_pVerify)
+            continue;
+
+        uint32_t& nPeer = m_mapInFlight[x.m_Sender];
+        if (nPeer >= cfg.m_MaxPerPeer)
+            continue;
+
+        nPeer++;
+        m_nInFlight++;
+
+        if (!m_pEvtDone)
+            m_pEvtDone = io::AsyncEvent::create(io::Reactor::get_Current(), [this]() { OnVerified(); });
+
+        auto pV = std::make_shared<Verification>();
+        pV->m_pTx = x.m_pTx;
+        pV->m_Sender = x.m_Sender;
+        pV->m_hMin = get_ParentObj().m_Processor.m_Cursor.m_ID.m_Height + 1;
+        pV->m_Ctx.m_Height.m_Min = pV->m_hMin;
+        x.m_pVerify = pV;
+
+        auto pTask = std::make_unique<VerifyTask>();
+        pTask->m_pThis = this;
+        pTask->m_pVerify = std::move(pV);
+        get_ParentObj().m_Processor.get_Executor().Push(std::move(pTask)); // low priority
+    }
+}
+
+void Node::TxDeferred::OnVerified()
+{
+    std::vector<Verification::Ptr> v;
+    {
+        std::unique_lock<std::mutex> scope(m_Mutex);
+        v.swap(m_vDone);
+    }
+
+    for (const auto& pV : v)
+    {
+        pV->m_bDone = true;
+
+        assert(m_nInFlight);
+        m_nInFlight--;
+
+        auto it = m_mapInFlight.find(pV->m_Sender);
+        assert(m_mapInFlight.end() != it);
+        if (!--it->second)
+            m_mapInFlight.erase(it);
+    }
+
+    TryVerify();
+
     if (!m_lst.empty())
+        start();
+}
+
+uint64_t Node::TxDeferred::get_Priority(const Transaction& tx, Height h, bool bOwn)
+{
+    // the tx is not verified yet, the fee is as declared by its kernels
+    TxStats s;
+    tx.get_Reader().AddStats(s);
+
+    Amount fee = AmountBig::get_Hi(s.m_Fee) ? static_cast<Amount>(-1) : AmountBig::get_Lo(s.m_Fee);
+    Amount feeMin = Transaction::FeeSettings::get(h).Calculate(s);
+
+    // relative fee, in 1/256 units
+    uint64_t nRatio = static_cast<uint32_t>(-1);
+    if (feeMin && !(fee >> 56))
+        std::setmin(nRatio, (fee << 8) / feeMin);
+
+    return (static_cast<uint64_t>(bOwn) << 32) | nRatio;
+}
+
+void Node::TxDeferred::Insert(Element&& x)
+{
+    // after all the txs of the same or higher priority, and the previous txs of the same sender
+    auto it = m_lst.end();
+    while (m_lst.begin() != it)
+    {
+        auto itPrev = std::prev(it);
+        if ((itPrev->m_Priority >= x.m_Priority) || (itPrev->m_Sender == x.m_Sender))
+            break;
+        it = itPrev;
+    }
+
+    m_lst.insert(it, std::move(x));
+}
+
+std::list<Node::TxDeferred::Element>::iterator Node::TxDeferred::FindReady()
+{
+    if (!get_ParentObj().m_Cfg.m_TxVerify.m_MaxInFlight)
+        return m_lst.begin(); // sync mode
+
+    // pick the first verified tx, but preserve the order of txs from the same sender
+    std::set<PeerID> setBlocked;
+
+    uint32_t n = 0;
+    for (auto it = m_lst.begin(); (m_lst.end() != it) && (n < s_Window); ++it, ++n)
+    {
+        Element& x = *it;
+        if (x.m_pVerify && x.m_pVerify->m_bDone && (setBlocked.end() == setBlocked.find(x.m_Sender)))
+            return it;
+
+        setBlocked.insert(x.m_Sender);
+    }
+
+    return m_lst.end();
+}
+
+void Node::TxDeferred::OnSchedule()
+{
+    uint32_t t0_ms = GetTime_ms();
+    const uint32_t nBudget_ms = get_ParentObj().m_Cfg.m_TxVerify.m_Budget_ms;
+
+    while (true)
     {
-        TxDeferred::Element& x = m_lst.front();
+        auto it = FindReady();
+        if (m_lst.end() == it)
+        {
+            if (!m_lst.empty())
+            {
+                cancel(); // resumed once pending verifications complete
+                return;
+            }
+            break;
+        }
+
+        TxDeferred::Element& x = *it;
+
+        m_pCurrent = x.m_pVerify.get();
         get_ParentObj().OnTransaction(std::move(x.m_pTx), std::move(x.m_pCtx), &x.m_Sender, x.m_Fluff, nullptr);
-        m_lst.pop_front();
+        m_pCurrent = nullptr;
+
+        m_lst.erase(it);
+
+        if (m_lst.empty() || (GetTime_ms() - t0_ms >= nBudget_ms))
+            break;
     }
 
     if (m_lst.empty())
@@ -2514,7 +3925,19 @@ uint8_t Node::ValidateTx2(Transaction::Context& ctx, const Transaction& tx, uint
     ctx.m_Height.m_Min = m_Processor.m_Cursor.m_ID.m_Height + 1;
 
     std::string sErr;
-    bool bValid = m_Processor.ValidateAndSummarize(ctx, tx, tx.get_Reader(), sErr);
+    bool bValid;
+
+    const TxDeferred::Verification* pV = m_TxDeferred.m_pCurrent;
+    if (pV && (pV->m_pTx.get() == &tx) && (pV->m_hMin == ctx.m_Height.m_Min))
+    {
+        // already verified by the executor
+        ctx = pV->m_Ctx;
+        bValid = pV->m_bValid;
+        sErr = pV->m_sErr;
+    }
+    else
+        bValid = m_Processor.ValidateAndSummarize(ctx, tx, tx.get_Reader(), sErr);
+
     if (bValid)
     {
         try {
@@ -2722,6 +4145,12 @@ uint8_t Node::OnTransactionStem(Transaction::Ptr&& ptx, std::ostream* pExtraInfo
         }
     }
 
+    if (!pF && !m_TxPool.TryReplace(*ptx, stats))
+    {
+        LogTxStem(*ptx, "conflicts with a more profitable tx");
+        return proto::TxStatus::Obscured;
+    }
+
     bool bDontAggregate = true;
     if (!pF)
     {
@@ -2762,7 +4191,10 @@ uint8_t Node::OnTransactionStem(Transaction::Ptr&& ptx, std::ostream* pExtraInfo
         m_Dandelion.InsertAggr(*pGuard);
         auto* pElem = pGuard.release();
 
-        PerformAggregation(*pElem);
+        if (m_Cfg.m_Dandelion.m_BatchPeriod_ms)
+            m_Dandelion.OnBatchElement(*pElem);
+        else
+            PerformAggregation(*pElem);
     }
 
     return proto::TxStatus::Ok;
@@ -3067,20 +4499,24 @@ uint8_t Node::OnTransactionFluff(Transaction::Ptr&& ptxArg, std::ostream* pExtra
 
     if (!pF)
     {
-        pF = m_TxPool.AddValidTx(std::move(ptx), (pStats ? *pStats : stats), keyTx, TxPool::Fluff::State::Fluffed);
+        const TxPool::Stats& statsNew = pStats ? *pStats : stats;
+        if (!m_TxPool.TryReplace(*ptx, statsNew))
+            return proto::TxStatus::Obscured; // conflicting kernel, the existing tx is at least as profitable
+
+        pF = m_TxPool.AddValidTx(std::move(ptx), statsNew, keyTx, TxPool::Fluff::State::Fluffed);
         m_Wtx.Delete(keyTx);
     }
 
-    while (m_TxPool.m_setProfit.size() + m_TxPool.m_lstOutdated.size() > m_Cfg.m_MaxPoolTransactions)
+    while (IsTxPoolOverLimit())
     {
-        TxPool::Fluff::Element& txDel = m_TxPool.m_lstOutdated.empty() ?
-            m_TxPool.m_setProfit.rbegin()->get_ParentObj() :
-            m_TxPool.m_lstOutdated.front().get_ParentObj();
+        TxPool::Fluff::Element* pDel = m_TxPool.get_EvictCandidate();
+        if (!pDel)
+            break;
 
-        if (&txDel == pF)
+        if (pDel == pF)
             pF = nullptr; // Anti-spam protection: in case the maximum pool capacity is reached - ensure this tx is any better BEFORE broadcasting ti
 
-        m_TxPool.Delete(txDel);
+        m_TxPool.Evict(*pDel);
     }
 
     if (pF)
@@ -3089,10 +4525,29 @@ uint8_t Node::OnTransactionFluff(Transaction::Ptr&& ptxArg, std::ostream* pExtra
     return proto::TxStatus::Ok;
 }
 
+bool Node::IsTxPoolOverLimit() const
+{
+    if (m_TxPool.m_setProfit.size() + m_TxPool.m_lstOutdated.size() > m_Cfg.m_MaxPoolTransactions)
+        return true;
+
+    return m_Cfg.m_MaxPoolSize && (m_TxPool.m_Totals.m_Size > m_Cfg.m_MaxPoolSize);
+}
+
 void Node::OnTransactionFluff(TxPool::Fluff::Element& x, const PeerID* pSender)
 {
     m_TxPool.SetState(x, TxPool::Fluff::State::Fluffed);
 
+    if (m_Cfg.m_TxTrickle.m_Mean_ms)
+        m_TxTrickle.OnNewTx(); // would be announced from the send queue
+    else
+        BroadcastFluff(x, pSender);
+
+    if (!m_Miner.IsFullFor(x.m_Profit))
+        m_Miner.SoftRestart();
+}
+
+void Node::BroadcastFluff(TxPool::Fluff::Element& x, const PeerID* pSender)
+{
     proto::HaveTransaction msgOut;
     msgOut.m_ID = x.m_Tx.m_Key;
 
@@ -3107,8 +4562,87 @@ void Node::OnTransactionFluff(TxPool::Fluff::Element& x, const PeerID* pSender)
         peer.Send(msgOut);
         peer.SetTxCursor(x.m_pSend);
     }
+}
+
+void Node::TxTrickle::OnNewTx()
+{
+    if (m_bArmed)
+        return;
+
+    // was idle. Don't announce to the peers whose due time has passed right away, that would reveal the arrival time
+    Node& n = get_ParentObj();
+    uint32_t t_ms = GetTime_ms();
+
+    for (PeerList::iterator it = n.m_lstPeers.begin(); n.m_lstPeers.end() != it; ++it)
+    {
+        Peer& peer = *it;
+        if (static_cast<int32_t>(t_ms - peer.m_TrickleDue_ms) >= 0)
+            peer.m_TrickleDue_ms = t_ms + get_Delay_ms(peer);
+    }
+
+    Arm();
+}
+
+void Node::TxTrickle::Arm()
+{
+    if (!m_pTimer)
+        m_pTimer = io::Timer::create(io::Reactor::get_Current());
+
+    m_pTimer->start(s_Slice_ms, false, [this]() { OnTimer(); });
+    m_bArmed = true;
+}
+
+void Node::TxTrickle::OnTimer()
+{
+    m_bArmed = false;
+
+    Node& n = get_ParentObj();
+    uint32_t t_ms = GetTime_ms();
+    bool bPending = false;
+
+    for (PeerList::iterator it = n.m_lstPeers.begin(); n.m_lstPeers.end() != it; ++it)
+    {
+        Peer& peer = *it;
+        if (!peer.HasTxBacklog())
+            continue;
+
+        if (static_cast<int32_t>(t_ms - peer.m_TrickleDue_ms) < 0)
+        {
+            bPending = true;
+            continue;
+        }
+
+        peer.BroadcastTxs(); // if chocking - will be resumed once it's not
+        peer.m_TrickleDue_ms = t_ms + get_Delay_ms(peer);
+    }
+
+    if (bPending)
+        Arm();
+}
+
+uint32_t Node::TxTrickle::get_Delay_ms(const Peer& peer)
+{
+    const Config::TxTrickle& cfg = get_ParentObj().m_Cfg.m_TxTrickle;
+
+    uint32_t nMean_ms = cfg.m_Mean_ms;
+    if (Peer::Flags::Accepted & peer.m_Flags)
+        nMean_ms *= cfg.m_InboundFactor;
+
+    if (!m_Rnd)
+    {
+        ECC::GenRandom(&m_Rnd, sizeof(m_Rnd));
+        m_Rnd |= 1;
+    }
+
+    // xorshift64, not a secret
+    m_Rnd ^= m_Rnd << 13;
+    m_Rnd ^= m_Rnd >> 7;
+    m_Rnd ^= m_Rnd << 17;
 
-    m_Miner.SoftRestart();
+    double u = static_cast<double>((m_Rnd >> 11) + 1) / static_cast<double>(1ULL << 53); // (0, 1]
+    double dt_ms = -std::log(u) * nMean_ms;
+
+    return static_cast<uint32_t>(std::min(dt_ms, nMean_ms * 4.)); // the tail is cut
 }
 
 uint8_t Node::OnTransactionDependent(Transaction::Ptr&& pTx, const Merkle::Hash& hvCtx, const PeerID* pSender, bool bFluff, std::ostream* pExtraInfo)
@@ -3210,6 +4744,61 @@ void Node::Dandelion::OnTimedOut(Element& x)
     get_ParentObj().m_Dandelion.Delete(x);
 }
 
+void Node::Dandelion::OnBatchElement(Element& x)
+{
+    const Config::Dandelion& d = get_ParentObj().m_Cfg.m_Dandelion; // alias
+
+    get_ParentObj().LogTxStem(*x.m_pValue, "Batch aggregation pending");
+    SetTimer(d.m_AggregationTime_ms, x);
+
+    if (m_setProfit.size() >= d.m_BatchSize)
+        AggregateBatch();
+    else
+    {
+        if (!m_bBatchPending)
+        {
+            if (!m_pBatchTimer)
+                m_pBatchTimer = io::Timer::create(io::Reactor::get_Current());
+
+            m_pBatchTimer->start(d.m_BatchPeriod_ms, false, [this]() { OnBatchTimer(); });
+            m_bBatchPending = true;
+        }
+    }
+}
+
+void Node::Dandelion::OnBatchTimer()
+{
+    m_bBatchPending = false;
+    AggregateBatch();
+}
+
+void Node::Dandelion::AggregateBatch()
+{
+    if (m_bBatchPending)
+    {
+        m_pBatchTimer->cancel();
+        m_bBatchPending = false;
+    }
+
+    Node& n = get_ParentObj();
+
+    std::vector<Element*> vRes;
+    TxPool::Stem::AggregateBatch(n.m_Processor.get_Executor(), n.m_Cfg.m_Dandelion.m_OutputsMax, vRes);
+
+    for (Element* p : vRes)
+    {
+        Element& x = *p;
+        n.LogTxStem(*x.m_pValue, "Aggregated so far");
+
+        if (x.m_pValue->m_vOutputs.size() >= n.m_Cfg.m_Dandelion.m_OutputsMin)
+        {
+            n.OnTransactionAggregated(std::move(x.m_pValue), x.m_Profit.m_Stats);
+            Delete(x);
+        }
+        // otherwise wait for more, until the aggregation timeout
+    }
+}
+
 bool Node::Dandelion::ValidateTxContext(const Transaction& tx, const HeightRange& hr, const AmountBig::Number& fees, Amount& feeReserve)
 {
     uint32_t nBvmCharge = 0;
@@ -3266,6 +4855,21 @@ void Node::Peer::OnLogin(proto::Login&& msg, uint32_t nFlagsPrev)
 
     MaybeSendSerif();
     MaybeSendDependent();
+    MaybeSendEventsNew();
+
+	if ((get_Ext() >= 12) &&
+		!(proto::LoginFlags::SpreadingTransactions & nFlagsPrev) &&
+		(proto::LoginFlags::SpreadingTransactions & m_LoginFlags))
+	{
+		// the peer sends its sketch along with this flag. Skip the current backlog until then, announce only the new txs
+		m_Flags |= Flags::TxSketchWait;
+
+		TxPool::Fluff::SendQueue& q = m_This.m_TxPool.m_SendQueue;
+		if (!m_pCursorTx && !q.empty())
+			SetTxCursor(&q.back());
+	}
+
+	MaybeSendTxSketch();
 
 	if (b != ShouldFinalizeMining()) {
 		// stupid compiler insists on parentheses!
@@ -3310,6 +4914,39 @@ void Node::Peer::SetTxCursor(TxPool::Fluff::Element::Send* p)
 		m_pCursorTx->m_Refs++;
 }
 
+struct Node::Peer::TxAnnouncer
+{
+	// batches the announcements if the peer supports it
+	Peer& m_Peer;
+	proto::HaveTransactions m_Msg;
+
+	TxAnnouncer(Peer& p) :m_Peer(p) {}
+
+	void Add(const Transaction::KeyType& key)
+	{
+		if (m_Peer.get_Ext() < 14)
+		{
+			proto::HaveTransaction msg;
+			msg.m_ID = key;
+			m_Peer.Send(msg);
+			return;
+		}
+
+		m_Msg.m_IDs.push_back(key);
+		if (m_Msg.m_IDs.size() >= proto::g_TxAnnounceMaxSize)
+			Flush();
+	}
+
+	void Flush()
+	{
+		if (!m_Msg.m_IDs.empty())
+		{
+			m_Peer.Send(m_Msg);
+			m_Msg.m_IDs.clear();
+		}
+	}
+};
+
 void Node::Peer::BroadcastTxs()
 {
 	if (!(proto::LoginFlags::SpreadingTransactions & m_LoginFlags))
@@ -3320,6 +4957,8 @@ void Node::Peer::BroadcastTxs()
 	if (IsChocking())
 		return;
 
+	TxAnnouncer ta(*this);
+
 	for (size_t nExtra = 0; ; )
 	{
 		TxPool::Fluff::SendQueue::iterator itNext;
@@ -3340,14 +4979,26 @@ void Node::Peer::BroadcastTxs()
 			continue; // already deleted
         auto& x = *m_pCursorTx->m_pThis;
 
-		proto::HaveTransaction msgOut;
-		msgOut.m_ID = x.m_Tx.m_Key;
-		Send(msgOut);
+		ta.Add(x.m_Tx.m_Key);
 
 		nExtra += x.m_Profit.m_Stats.m_Size;
 		if (IsChocking(nExtra))
 			break;
 	}
+
+	ta.Flush();
+}
+
+bool Node::Peer::HasTxBacklog() const
+{
+	if (!(proto::LoginFlags::SpreadingTransactions & m_LoginFlags))
+		return false;
+
+	const TxPool::Fluff::SendQueue& q = m_This.m_TxPool.m_SendQueue;
+	if (q.empty())
+		return false;
+
+	return !m_pCursorTx || (&q.back() != m_pCursorTx);
 }
 void Node::Peer::BroadcastBbs()
 {
@@ -3361,22 +5012,19 @@ void Node::Peer::BroadcastBbs()
 
 	size_t nExtra = 0;
 
-	NodeDB& db = m_This.m_Processor.get_DB();
-	NodeDB::WalkerBbsLite wlk;
-
-	wlk.m_ID = m_CursorBbs;
-	for (db.EnumAllBbsSeq(wlk); wlk.MoveNext(); )
+	BbsStore& st = m_This.m_Bbs.m_Store;
+	for (BbsStore::Element* p = st.get_Next(m_CursorBbs); p; p = st.get_Next(m_CursorBbs))
 	{
 		proto::BbsHaveMsg msgOut;
-		msgOut.m_Key = wlk.m_Key;
+		msgOut.m_Key = p->m_ByKey.m_Key;
 		Send(msgOut);
 
-		nExtra += wlk.m_Size;
+		m_CursorBbs = p->get_ID();
+
+		nExtra += p->m_Message.size();
 		if (IsChocking(nExtra))
 			break;
 	}
-
-	m_CursorBbs = wlk.m_ID;
 }
 
 void Node::Peer::MaybeSendSerif()
@@ -3393,6 +5041,23 @@ void Node::Peer::MaybeSendSerif()
     m_Flags |= Flags::SerifSent;
 }
 
+void Node::Peer::MaybeSendEventsNew()
+{
+    if (!(Flags::Viewer & m_Flags) || !(proto::LoginFlags::WantEvents & m_LoginFlags))
+        return;
+    assert(m_pAccount);
+
+    // the 1st one is sent unconditionally, it tells the wallet it may stop polling
+    if (m_nEventsSent == m_pAccount->m_nEvents)
+        return;
+
+    m_nEventsSent = m_pAccount->m_nEvents;
+
+    proto::EventsNew msg;
+    msg.m_Height = m_This.m_Processor.m_Cursor.m_Full.m_Height;
+    Send(msg);
+}
+
 void Node::Peer::MaybeSendDependent()
 {
     auto& vec = m_Dependent.m_vSent; // alias
@@ -3469,6 +5134,19 @@ void Node::Peer::OnMsg(proto::HaveTransaction&& msg)
     Send(msgOut);
 }
 
+void Node::Peer::OnMsg(proto::HaveTransactions&& msg)
+{
+    if (msg.m_IDs.size() > proto::g_TxAnnounceMaxSize)
+        ThrowUnexpected();
+
+    for (size_t i = 0; i < msg.m_IDs.size(); i++)
+    {
+        proto::HaveTransaction msg1;
+        msg1.m_ID = msg.m_IDs[i];
+        OnMsg(std::move(msg1));
+    }
+}
+
 void Node::Peer::OnMsg(proto::GetTransaction&& msg)
 {
     TxPool::Fluff::Element::Tx key;
@@ -3481,6 +5159,89 @@ void Node::Peer::OnMsg(proto::GetTransaction&& msg)
     SendTx(it->get_ParentObj().m_pValue, true);
 }
 
+void Node::Peer::MaybeSendTxSketch()
+{
+	// follows our 1st login with SpreadingTransactions, once the peer's extension is known
+	if ((Flags::TxSketchSent & m_Flags) || !m_This.m_PostStartSynced || (get_Ext() < 12))
+		return;
+
+	m_Flags |= Flags::TxSketchSent;
+
+	const TxPool::Fluff& txp = m_This.m_TxPool;
+
+	proto::TxSketch msg;
+	if (m_This.m_Cfg.m_TxSketchCells && !txp.m_setTxs.empty())
+	{
+		msg.m_Sketch.Init(m_This.m_Cfg.m_TxSketchCells);
+
+		// all the txs we have, regardless to the state
+		for (auto it = txp.m_setTxs.begin(); txp.m_setTxs.end() != it; ++it)
+			msg.m_Sketch.Add(proto::InvSketch::get_ShortID(it->m_Key));
+	}
+
+	Send(msg);
+}
+
+void Node::Peer::OnMsg(proto::TxSketch&& msg)
+{
+	if (!(Flags::TxSketchWait & m_Flags))
+		return; // not expected, or we've already sent everything
+
+	m_Flags &= ~Flags::TxSketchWait;
+
+	if (!msg.m_Sketch.IsValid())
+		ThrowUnexpected();
+
+	TxPool::Fluff::SendQueue& q = m_This.m_TxPool.m_SendQueue;
+
+	std::vector<uint64_t> vMine, vTheirs;
+	bool bDecoded = !msg.m_Sketch.IsEmpty();
+	if (bDecoded)
+	{
+		proto::InvSketch sk;
+		sk.Init(static_cast<uint32_t>(msg.m_Sketch.m_vCount.size()));
+
+		for (auto it = q.begin(); q.end() != it; ++it)
+			if (it->m_pThis)
+				sk.Add(proto::InvSketch::get_ShortID(it->m_pThis->m_Tx.m_Key));
+
+		sk.Subtract(msg.m_Sketch);
+
+		bDecoded = sk.Decode(vMine, vTheirs);
+	}
+
+	if (!bDecoded)
+	{
+		// announce everything from the beginning. Some txs may be announced twice, that's ok
+		BEAM_LOG_VERBOSE() << "Peer " << m_RemoteAddr << " Tx sketch not decoded, full announce";
+
+		SetTxCursor(nullptr);
+		BroadcastTxs();
+		return;
+	}
+
+	BEAM_LOG_VERBOSE() << "Peer " << m_RemoteAddr << " Tx sketch diff: " << vMine.size() << " to announce, " << vTheirs.size() << " missing";
+
+	if (vMine.empty())
+		return;
+
+	std::sort(vMine.begin(), vMine.end());
+
+	TxAnnouncer ta(*this);
+
+	for (auto it = q.begin(); q.end() != it; ++it)
+	{
+		if (!it->m_pThis)
+			continue;
+
+		const Transaction::KeyType& key = it->m_pThis->m_Tx.m_Key;
+		if (std::binary_search(vMine.begin(), vMine.end(), proto::InvSketch::get_ShortID(key)))
+			ta.Add(key);
+	}
+
+	ta.Flush();
+}
+
 void Node::Peer::SendTx(Transaction::Ptr& ptx, bool bFluff, const Merkle::Hash* pCtx /* = nullptr */)
 {
     struct MyMsg :public proto::NewTransaction {
@@ -3584,18 +5345,171 @@ void Node::Peer::OnMsg(proto::GetProofKernel&& msg)
 void Node::Peer::OnMsg(proto::GetProofKernel2&& msg)
 {
     proto::ProofKernel2 msgOut;
+    get_ProofKernel2(msgOut, msg.m_ID, msg.m_Fetch);
+    Send(msgOut);
+}
+
+void Node::Peer::OnMsg(proto::GetProofKernel2Batch&& msg)
+{
+    if (msg.m_IDs.size() > proto::g_ProofBatchMaxSize)
+        ThrowUnexpected();
+
+    proto::ProofKernel2Batch msgOut;
+    msgOut.m_Results.resize(msg.m_IDs.size());
+
+    for (size_t i = 0; i < msg.m_IDs.size(); i++)
+        get_ProofKernel2(msgOut.m_Results[i], msg.m_IDs[i], msg.m_Fetch);
+
+    Send(msgOut);
+}
 
+void Node::Peer::get_ProofKernel2(proto::ProofKernel2& msgOut, const Merkle::Hash& id, bool bFetch)
+{
 	Processor& p = m_This.m_Processor;
 	if (!p.IsFastSync())
-		msgOut.m_Height = p.get_ProofKernel(msgOut.m_Proof, msg.m_Fetch ? &msgOut.m_Kernel : NULL, msg.m_ID);
+	{
+		NodeDB& db = p.get_DB();
+		bool bCache = db.get_MemCacheStats(NodeDB::CacheCategory::KernelProof).m_SizeMax > 0;
+
+		// the proof is valid for the current tip only
+#pragma pack (push, 1)
+		struct CacheKey
+		{
+			Merkle::Hash m_Tip;
+			Merkle::Hash m_ID;
+			uint8_t m_Fetch;
+		} key;
+#pragma pack (pop)
+
+		ByteBuffer buf;
+
+		if (bCache)
+		{
+			key.m_Tip = p.m_Cursor.m_ID.m_Hash;
+			key.m_ID = id;
+			key.m_Fetch = bFetch ? 1 : 0;
+
+			if (db.CacheFind(Blob(&key, sizeof(key)), buf, NodeDB::CacheCategory::KernelProof))
+			{
+				Deserializer der;
+				der.reset(buf);
+				der & msgOut;
+				return;
+			}
+		}
+
+		msgOut.m_Height = p.get_ProofKernel(msgOut.m_Proof, bFetch ? &msgOut.m_Kernel : NULL, id);
+
+		if (bCache)
+		{
+			Serializer ser;
+			ser & msgOut;
+			ser.swap_buf(buf);
+			db.CacheInsert(Blob(&key, sizeof(key)), buf, NodeDB::CacheCategory::KernelProof);
+		}
+	}
+}
+
+void Node::Peer::OnMsg(proto::GetProofUtxo&& msg)
+{
+    proto::ProofUtxo msgOut;
+    get_ProofUtxo(msgOut, msg.m_Utxo, msg.m_MaturityMin);
+    Send(msgOut);
+}
+
+void Node::Peer::OnMsg(proto::GetProofUtxoBatch&& msg)
+{
+    if (msg.m_Utxos.size() > proto::g_ProofBatchMaxSize)
+        ThrowUnexpected();
+
+    proto::ProofUtxoBatch msgOut;
+    msgOut.m_Results.resize(msg.m_Utxos.size());
+
+    for (size_t i = 0; i < msg.m_Utxos.size(); i++)
+        get_ProofUtxo(msgOut.m_Results[i], msg.m_Utxos[i], msg.m_MaturityMin);
+
+    Send(msgOut);
+}
+
+void Node::Peer::OnMsg(proto::GetProofUtxoMulti&& msg)
+{
+    if (msg.m_Utxos.size() > proto::g_ProofBatchMaxSize)
+        ThrowUnexpected();
+
+    proto::ProofUtxoMulti msgOut;
+    msgOut.m_States.resize(msg.m_Utxos.size());
+
+	Processor& p = m_This.m_Processor;
+
+	// the UTXO tree root is a separate element of the definition since Fork3
+	if (!p.IsFastSync() && Rules::get().IsPastFork_<3>(p.m_Cursor.m_ID.m_Height))
+	{
+        struct Traveler :public UtxoTree::ITraveler
+        {
+            std::vector<Input::State>* m_pRes;
+            UtxoTree::MultiProofBuilder m_Bld;
+
+            virtual bool OnLeaf(const RadixTree::Leaf& x) override {
+
+                const UtxoTree::MyLeaf& v = Cast::Up<UtxoTree::MyLeaf>(x);
+                UtxoTree::Key::Data d;
+                d = v.m_Key;
+
+                Input::State& ret = m_pRes->emplace_back();
+                ret.m_Count = v.get_Count();
+                ret.m_Maturity = d.m_Maturity;
+
+                m_Bld.Add(*m_pCu);
+
+                return m_pRes->size() < Input::Proof::s_EntriesMax;
+            }
+        } t;
+
+		UtxoTree::Cursor cu;
+		t.m_pCu = &cu;
+
+		for (size_t i = 0; i < msg.m_Utxos.size(); i++)
+		{
+			UtxoTree::Key kMin, kMax;
+
+			UtxoTree::Key::Data d;
+			d.m_Commitment = msg.m_Utxos[i];
+			d.m_Maturity = msg.m_MaturityMin;
+			kMin = d;
+			d.m_Maturity = Height(-1);
+			kMax = d;
+
+			t.m_pBound[0] = kMin.V.m_pData;
+			t.m_pBound[1] = kMax.V.m_pData;
+			t.m_pRes = &msgOut.m_States[i];
+
+			p.get_Utxos().Traverse(t);
+		}
+
+		if (!t.m_Bld.IsEmpty())
+		{
+			p.get_Utxos().get_MultiProof(msgOut.m_Proof, t.m_Bld);
+
+            struct MyProofBuilder
+                :public NodeProcessor::ProofBuilder
+            {
+                using ProofBuilder::ProofBuilder;
+                virtual bool get_Utxos(Merkle::Hash&) override { return false; }
+            };
+
+            MyProofBuilder pb(p, msgOut.m_ProofRoot);
+            pb.GenerateProof();
+		}
+	}
+
     Send(msgOut);
 }
 
-void Node::Peer::OnMsg(proto::GetProofUtxo&& msg)
+void Node::Peer::get_ProofUtxo(proto::ProofUtxo& msgOut, const ECC::Point& comm, Height hMaturityMin)
 {
     struct Traveler :public UtxoTree::ITraveler
     {
-        proto::ProofUtxo m_Msg;
+        proto::ProofUtxo& m_Msg;
         NodeProcessor& m_Proc;
 
         virtual bool OnLeaf(const RadixTree::Leaf& x) override {
@@ -3623,11 +5537,11 @@ void Node::Peer::OnMsg(proto::GetProofUtxo&& msg)
             return m_Msg.m_Proofs.size() < Input::Proof::s_EntriesMax;
         }
 
-        Traveler(NodeProcessor& np) :m_Proc(np) {}
+        Traveler(proto::ProofUtxo& msg, NodeProcessor& np) :m_Msg(msg), m_Proc(np) {}
     };
 
 	Processor& p = m_This.m_Processor;
-    Traveler t(p);
+    Traveler t(msgOut, p);
 
 	if (!p.IsFastSync())
 	{
@@ -3638,8 +5552,8 @@ void Node::Peer::OnMsg(proto::GetProofUtxo&& msg)
 		UtxoTree::Key kMin, kMax;
 
 		UtxoTree::Key::Data d;
-		d.m_Commitment = msg.m_Utxo;
-		d.m_Maturity = msg.m_MaturityMin;
+		d.m_Commitment = comm;
+		d.m_Maturity = hMaturityMin;
 		kMin = d;
 		d.m_Maturity = Height(-1);
 		kMax = d;
@@ -3649,8 +5563,6 @@ void Node::Peer::OnMsg(proto::GetProofUtxo&& msg)
 
         p.get_Utxos().Traverse(t);
 	}
-
-    Send(t.m_Msg);
 }
 
 void Node::Processor::GenerateProofShielded(Merkle::Proof& p, const uintBigFor<TxoID>::Type& mmrIdx)
@@ -3823,18 +5735,34 @@ bool Node::Processor::BuildCwp()
     return true;
 }
 
-void Node::Peer::OnMsg(proto::GetProofChainWork&& msg)
+const ByteBuffer& Node::Processor::get_CwpCropped(const Difficulty::Raw& lowerBound)
 {
+    auto it = m_CwpCropped.find(lowerBound);
+    if (m_CwpCropped.end() != it)
+        return it->second;
+
+    if (m_CwpCropped.size() >= s_CwpCroppedMax)
+        m_CwpCropped.clear(); // too many distinct bounds, unlikely
+
     proto::ProofChainWork msgOut;
+    msgOut.m_Proof.m_LowerBound = lowerBound;
+    BEAM_VERIFY(msgOut.m_Proof.Crop(m_Cwp));
+
+    Serializer ser;
+    ser & msgOut;
+
+    ByteBuffer& buf = m_CwpCropped[lowerBound];
+    ser.swap_buf(buf);
+    return buf;
+}
 
+void Node::Peer::OnMsg(proto::GetProofChainWork&& msg)
+{
     Processor& p = m_This.m_Processor;
     if (!p.IsFastSync() && p.BuildCwp())
-    {
-        msgOut.m_Proof.m_LowerBound = msg.m_LowerBound;
-        BEAM_VERIFY(msgOut.m_Proof.Crop(p.m_Cwp));
-    }
-
-    Send(msgOut);
+        SendSerialized(proto::ProofChainWork::s_Code, p.get_CwpCropped(msg.m_LowerBound));
+    else
+        Send(proto::ProofChainWork());
 }
 
 void Node::Peer::OnMsg(proto::PeerInfoSelf&& msg)
@@ -3884,32 +5812,29 @@ void Node::Peer::OnMsg(proto::BbsMsg&& msg)
     if (msg.m_TimePosted + Rules::get().DA.MaxAhead_s < m_This.m_Bbs.m_HighestPosted_s)
         return; // don't allow too much out-of-order messages
 
-    NodeDB& db = m_This.m_Processor.get_DB();
-    NodeDB::WalkerBbs wlk;
+    BbsStore::Data d;
 
-    wlk.m_Data.m_Channel = msg.m_Channel;
-    wlk.m_Data.m_TimePosted = msg.m_TimePosted;
-    wlk.m_Data.m_Message = Blob(msg.m_Message);
-	msg.m_Nonce.Export(wlk.m_Data.m_Nonce);
+    d.m_Channel = msg.m_Channel;
+    d.m_TimePosted = msg.m_TimePosted;
+    d.m_Message = Blob(msg.m_Message);
+	msg.m_Nonce.Export(d.m_Nonce);
 
-    Bbs::CalcMsgKey(wlk.m_Data);
+    Bbs::CalcMsgKey(d);
 
-    if (db.BbsFind(wlk.m_Data.m_Key))
+    if (m_This.m_Bbs.m_Store.Find(d.m_Key))
         return; // already have it
 
     m_This.m_Bbs.MaybeCleanup();
 
-    uint64_t id = db.BbsIns(wlk.m_Data);
-    m_This.m_Bbs.m_W.Delete(wlk.m_Data.m_Key);
+    uint64_t id = m_This.m_Bbs.m_Store.Insert(d)->get_ID();
+    m_This.m_Bbs.m_W.Delete(d.m_Key);
 
 	std::setmax(m_This.m_Bbs.m_HighestPosted_s, msg.m_TimePosted);
-	m_This.m_Bbs.m_Totals.m_Count++;
-	m_This.m_Bbs.m_Totals.m_Size += wlk.m_Data.m_Message.n;
 
     // 1. Send to other BBS-es
 
     proto::BbsHaveMsg msgOut;
-    msgOut.m_Key = wlk.m_Data.m_Key;
+    msgOut.m_Key = d.m_Key;
 
     for (PeerList::iterator it = m_This.m_lstPeers.begin(); m_This.m_lstPeers.end() != it; ++it)
     {
@@ -3937,7 +5862,7 @@ void Node::Peer::OnMsg(proto::BbsMsg&& msg)
         if (s.m_pPeer->IsChocking())
             continue;
 
-        s.m_pPeer->SendBbsMsg(wlk.m_Data);
+        s.m_pPeer->SendBbsMsg(d);
 		s.m_Cursor = id;
 
 		s.m_pPeer->IsChocking(); // in case it's chocking - for faster recovery recheck it ASAP
@@ -3949,8 +5874,7 @@ void Node::Peer::OnMsg(proto::BbsHaveMsg&& msg)
     if (!m_This.m_Cfg.m_Bbs.IsEnabled())
 		ThrowUnexpected();
 
-    NodeDB& db = m_This.m_Processor.get_DB();
-	if (db.BbsFind(msg.m_Key)) {
+	if (m_This.m_Bbs.m_Store.Find(msg.m_Key)) {
 		// stupid compiler insists on parentheses here!
 		return; // already have it
 	}
@@ -3970,14 +5894,13 @@ void Node::Peer::OnMsg(proto::BbsGetMsg&& msg)
 	if (!m_This.m_Cfg.m_Bbs.IsEnabled())
 		ThrowUnexpected();
 
-	NodeDB& db = m_This.m_Processor.get_DB();
-    NodeDB::WalkerBbs wlk;
-
-    wlk.m_Data.m_Key = msg.m_Key;
-    if (!db.BbsFind(wlk))
+	const BbsStore::Element* p = m_This.m_Bbs.m_Store.Find(msg.m_Key);
+    if (!p)
         return; // don't have it
 
-    SendBbsMsg(wlk.m_Data);
+    BbsStore::Data d;
+    p->Export(d);
+    SendBbsMsg(d);
 }
 
 void Node::Peer::SendBbsMsg(const NodeDB::WalkerBbs::Data& d)
@@ -4012,7 +5935,7 @@ void Node::Peer::OnMsg(proto::BbsSubscribe&& msg)
         m_This.m_Bbs.m_Subscribed.insert(pS->m_Bbs);
         m_Subscriptions.insert(pS->m_Peer);
 
-		pS->m_Cursor = m_This.m_Processor.get_DB().BbsFindCursor(msg.m_TimeFrom) - 1;
+		pS->m_Cursor = m_This.m_Bbs.m_Store.FindCursor(msg.m_TimeFrom) - 1;
 
 		BroadcastBbs(*pS);
     }
@@ -4025,20 +5948,18 @@ void Node::Peer::BroadcastBbs(Bbs::Subscription& s)
 	if (IsChocking())
 		return;
 
-	NodeDB& db = m_This.m_Processor.get_DB();
-	NodeDB::WalkerBbs wlk;
-
-	wlk.m_Data.m_Channel = s.m_Peer.m_Channel;
-	wlk.m_ID = s.m_Cursor;
+	BbsStore& st = m_This.m_Bbs.m_Store;
+	BbsStore::Data d;
 
-	for (db.EnumBbsCSeq(wlk); wlk.MoveNext(); )
+	for (BbsStore::Element* p = st.get_Next(s.m_Peer.m_Channel, s.m_Cursor); p; p = st.get_Next(s.m_Peer.m_Channel, s.m_Cursor))
 	{
-		SendBbsMsg(wlk.m_Data);
+		p->Export(d);
+		SendBbsMsg(d);
+
+		s.m_Cursor = p->get_ID();
 		if (IsChocking())
 			break;
 	}
-
-	s.m_Cursor = wlk.m_ID;
 }
 
 void Node::Peer::OnMsg(proto::BbsResetSync&& msg)
@@ -4046,7 +5967,7 @@ void Node::Peer::OnMsg(proto::BbsResetSync&& msg)
 	if (!m_This.m_Cfg.m_Bbs.IsEnabled())
 		ThrowUnexpected();
 
-	m_CursorBbs = m_This.m_Processor.get_DB().BbsFindCursor(msg.m_TimeFrom) - 1;
+	m_CursorBbs = m_This.m_Bbs.m_Store.FindCursor(msg.m_TimeFrom) - 1;
 	BroadcastBbs();
 }
 
@@ -4241,8 +6162,112 @@ void Node::Peer::OnMsg(proto::GetAssetsListAt&& msg)
     Send(msgOut);
 }
 
+void Node::EnumContractVars(NodeDB& db, proto::ContractVarsEnum& msgIn, proto::ContractVars& msgOut, const IsResponseFull& fnFull)
+{
+    NodeDB::WalkerContractData wlk;
+    db.ContractDataEnum(wlk, msgIn.m_KeyMin, msgIn.m_KeyMax);
+
+    Serializer ser;
+
+    while (true)
+    {
+        if (!wlk.MoveNext())
+            break;
+
+        if (msgIn.m_bSkipMin && (wlk.m_Key == msgIn.m_KeyMin))
+            continue; // skip
+
+        ser
+            & wlk.m_Key.n
+            & wlk.m_Val.n;
+
+        ser.WriteRaw(wlk.m_Key.p, wlk.m_Key.n);
+        ser.WriteRaw(wlk.m_Val.p, wlk.m_Val.n);
+
+        if (fnFull(ser.buffer().second))
+        {
+            msgOut.m_bMore = true;
+            break;
+        }
+    }
+
+    ser.swap_buf(msgOut.m_Result);
+}
+
+void Node::EnumContractLogs(NodeDB& db, proto::ContractLogsEnum& msgIn, proto::ContractLogs& msgOut, const IsResponseFull& fnFull)
+{
+    NodeDB::ContractLog::Walker wlk;
+    if (msgIn.m_KeyMin.empty() && msgIn.m_KeyMax.empty())
+        db.ContractLogEnum(wlk, msgIn.m_PosMin, msgIn.m_PosMax);
+    else
+        db.ContractLogEnum(wlk, msgIn.m_KeyMin, msgIn.m_KeyMax, msgIn.m_PosMin, msgIn.m_PosMax);
+
+    Serializer ser;
+
+    while (true)
+    {
+        if (!wlk.MoveNext())
+            break;
+
+        HeightPos dp;
+        dp.m_Height = wlk.m_Entry.m_Pos.m_Height - msgIn.m_PosMin.m_Height;
+        if (dp.m_Height)
+        {
+            msgIn.m_PosMin.m_Height = wlk.m_Entry.m_Pos.m_Height;
+            msgIn.m_PosMin.m_Pos = 0;
+        }
+
+        dp.m_Pos = wlk.m_Entry.m_Pos.m_Pos - msgIn.m_PosMin.m_Pos;
+        msgIn.m_PosMin.m_Pos = wlk.m_Entry.m_Pos.m_Pos;
+
+        ser
+            & dp
+            & wlk.m_Entry.m_Key.n
+            & wlk.m_Entry.m_Val.n;
+
+        ser.WriteRaw(wlk.m_Entry.m_Key.p, wlk.m_Entry.m_Key.n);
+        ser.WriteRaw(wlk.m_Entry.m_Val.p, wlk.m_Entry.m_Val.n);
+
+        if (fnFull(ser.buffer().second))
+        {
+            msgOut.m_bMore = true;
+            break;
+        }
+    }
+
+    ser.swap_buf(msgOut.m_Result);
+}
+
+template <typename TIn, typename TOut, void (*TFunc)(NodeDB&, TIn&, TOut&, const std::function<bool(size_t)>&)>
+struct Node::ReadPathQuery
+    :public ReadPath::Query
+{
+    TIn m_In;
+    TOut m_Out;
+
+    void Exec(NodeDB& db) override
+    {
+        TFunc(db, m_In, m_Out, [this](size_t n) { return n > m_nSizeMax; });
+    }
+
+    void SendResult(Peer& p) override
+    {
+        if (m_Out.m_bMore)
+            p.OnChocking();
+        p.Send(m_Out);
+    }
+};
+
 void Node::Peer::OnMsg(proto::ContractVarsEnum&& msg)
 {
+    if (!m_Dependent.m_pQuery && m_This.m_ReadPath.IsEnabled())
+    {
+        auto pQ = std::make_shared<ReadPathQuery<proto::ContractVarsEnum, proto::ContractVars, &Node::EnumContractVars> >();
+        pQ->m_In = std::move(msg);
+        m_This.m_ReadPath.Post(*this, std::move(pQ));
+        return;
+    }
+
     struct Wrk
         :public NodeProcessor::IWorker
     {
@@ -4257,34 +6282,7 @@ void Node::Peer::OnMsg(proto::ContractVarsEnum&& msg)
 
         void Do() override
         {
-            NodeDB::WalkerContractData wlk;
-            m_This.m_This.m_Processor.get_DB().ContractDataEnum(wlk, m_In.m_KeyMin, m_In.m_KeyMax);
-
-            Serializer ser;
-
-            while (true)
-            {
-                if (!wlk.MoveNext())
-                    break;
-
-                if (m_In.m_bSkipMin && (wlk.m_Key == m_In.m_KeyMin))
-                    continue; // skip
-
-                ser
-                    & wlk.m_Key.n
-                    & wlk.m_Val.n;
-
-                ser.WriteRaw(wlk.m_Key.p, wlk.m_Key.n);
-                ser.WriteRaw(wlk.m_Val.p, wlk.m_Val.n);
-
-                if (m_This.IsChocking(ser.buffer().second))
-                {
-                    m_Out.m_bMore = true;
-                    break;
-                }
-            }
-
-            ser.swap_buf(m_Out.m_Result);
+            EnumContractVars(m_This.m_This.m_Processor.get_DB(), m_In, m_Out, [this](size_t n) { return m_This.IsChocking(n); });
         }
     };
 
@@ -4297,6 +6295,14 @@ void Node::Peer::OnMsg(proto::ContractVarsEnum&& msg)
 
 void Node::Peer::OnMsg(proto::ContractLogsEnum&& msg)
 {
+    if (!m_Dependent.m_pQuery && m_This.m_ReadPath.IsEnabled())
+    {
+        auto pQ = std::make_shared<ReadPathQuery<proto::ContractLogsEnum, proto::ContractLogs, &Node::EnumContractLogs> >();
+        pQ->m_In = std::move(msg);
+        m_This.m_ReadPath.Post(*this, std::move(pQ));
+        return;
+    }
+
     struct Wrk
         :public NodeProcessor::IWorker
     {
@@ -4311,56 +6317,191 @@ void Node::Peer::OnMsg(proto::ContractLogsEnum&& msg)
 
         void Do() override
         {
-            auto& db = m_This.m_This.m_Processor.get_DB();
+            EnumContractLogs(m_This.m_This.m_Processor.get_DB(), m_In, m_Out, [this](size_t n) { return m_This.IsChocking(n); });
+        }
+    };
+
+    Wrk wrk(*this, msg);
+
+    m_This.m_Processor.ExecInDependentContext(wrk, m_Dependent.m_pQuery.get(), m_This.m_TxDependent);
+
+    Send(wrk.m_Out);
+}
+
+/////////////////////////////
+// ReadPath
+struct Node::ReadPath::Task
+    :public Executor::TaskAsync
+{
+    ReadPath* m_pThis;
+    Query::Ptr m_pQuery;
+
+    void Exec(Executor::Context& ctx) override
+    {
+        NodeDB& db = static_cast<MyContext&>(ctx).m_DB;
 
-            NodeDB::ContractLog::Walker wlk;
-            if (m_In.m_KeyMin.empty() && m_In.m_KeyMax.empty())
-                db.ContractLogEnum(wlk, m_In.m_PosMin, m_In.m_PosMax);
+        try {
+            if (db.IsOpen())
+                m_pQuery->Exec(db);
             else
-                db.ContractLogEnum(wlk, m_In.m_KeyMin, m_In.m_KeyMax, m_In.m_PosMin, m_In.m_PosMax);
+                m_pQuery->m_bFailed = true;
+        } catch (const std::exception& e) {
+            BEAM_LOG_WARNING() << "Read query failed: " << e.what();
+            m_pQuery->m_bFailed = true;
+        }
 
-            Serializer ser;
+        {
+            std::unique_lock<std::mutex> scope(m_pThis->m_Mutex);
+            m_pThis->m_vDone.push_back(std::move(m_pQuery));
+        }
 
-            while (true)
-            {
-                if (!wlk.MoveNext())
-                    break;
+        m_pThis->m_pEvtDone->post();
+    }
+};
 
-                HeightPos dp;
-                dp.m_Height = wlk.m_Entry.m_Pos.m_Height - m_In.m_PosMin.m_Height;
-                if (dp.m_Height)
-                {
-                    m_In.m_PosMin.m_Height = wlk.m_Entry.m_Pos.m_Height;
-                    m_In.m_PosMin.m_Pos = 0;
-                }
+bool Node::ReadPath::IsEnabled() const
+{
+    return get_ParentObj().m_Cfg.m_ReadThreads > 0;
+}
+
+void Node::ReadPath::RunThread(uint32_t iThread)
+{
+    MyContext ctx;
+    ctx.m_iThread = iThread;
 
-                dp.m_Pos = wlk.m_Entry.m_Pos.m_Pos - m_In.m_PosMin.m_Pos;
-                m_In.m_PosMin.m_Pos = wlk.m_Entry.m_Pos.m_Pos;
+    try {
+        ctx.m_DB.OpenReadOnly(get_ParentObj().m_Cfg.m_sPathLocal.c_str());
+    } catch (const std::exception& e) {
+        BEAM_LOG_WARNING() << "Read DB connection failed: " << e.what(); // the queries will fall back to the main thread
+        ctx.m_DB.Close();
+    }
 
-                ser
-                    & dp
-                    & wlk.m_Entry.m_Key.n
-                    & wlk.m_Entry.m_Val.n;
+    RunThreadCtx(ctx);
+}
 
-                ser.WriteRaw(wlk.m_Entry.m_Key.p, wlk.m_Entry.m_Key.n);
-                ser.WriteRaw(wlk.m_Entry.m_Val.p, wlk.m_Entry.m_Val.n);
+void Node::ReadPath::Post(Peer& p, Query::Ptr&& pQ)
+{
+    if (!m_pEvtDone)
+        m_pEvtDone = io::AsyncEvent::create(io::Reactor::get_Current(), [this]() { OnDone(); });
 
-                if (m_This.IsChocking(ser.buffer().second))
-                {
-                    m_Out.m_bMore = true;
-                    break;
-                }
-            }
+    size_t nUnsent = p.get_Unsent();
+    const size_t& nMax = get_ParentObj().m_Cfg.m_BandwidthCtl.m_Chocking;
+    pQ->m_nSizeMax = (nUnsent < nMax) ? (nMax - nUnsent) : 0;
+    pQ->m_pPeer = &p;
+    pQ->m_Tag = p.m_TagOut;
 
-            ser.swap_buf(m_Out.m_Result);
+    p.m_vReadQueries.push_back(pQ);
+
+    // untagged results must be sent in order, hence the input is suspended. Tagged may complete in any order
+    pQ->m_bSuspend = !pQ->m_Tag || (p.m_vReadQueries.size() >= s_MaxTaggedPerPeer);
+    if (pQ->m_bSuspend)
+        p.SuspendInput();
+
+    auto pTask = std::make_unique<Task>();
+    pTask->m_pThis = this;
+    pTask->m_pQuery = std::move(pQ);
+    Push(std::move(pTask));
+}
+
+void Node::ReadPath::OnDone()
+{
+    std::vector<Query::Ptr> v;
+    {
+        std::unique_lock<std::mutex> scope(m_Mutex);
+        v.swap(m_vDone);
+    }
+
+    for (const auto& pQ : v)
+    {
+        Peer* pPeer = pQ->m_pPeer;
+        if (!pPeer)
+            continue; // peer is gone
+
+        auto& vQ = pPeer->m_vReadQueries;
+        auto it = std::find(vQ.begin(), vQ.end(), pQ);
+        assert(vQ.end() != it);
+        vQ.erase(it);
+        pQ->m_pPeer = nullptr;
+
+        pPeer->SendResult(*pQ);
+    }
+}
+
+void Node::WalCheckpointer::Start(const std::string& sPath, uint32_t nInterval_ms)
+{
+    assert(!m_Thread.joinable());
+    m_Stop = false;
+    m_Thread = std::thread(&WalCheckpointer::RunThread, this, sPath, nInterval_ms);
+}
+
+void Node::WalCheckpointer::Stop()
+{
+    if (!m_Thread.joinable())
+        return;
+
+    {
+        std::unique_lock<std::mutex> scope(m_Mutex);
+        m_Stop = true;
+    }
+
+    m_Cv.notify_one();
+    m_Thread.join();
+}
+
+void Node::WalCheckpointer::RunThread(std::string sPath, uint32_t nInterval_ms)
+{
+    NodeDB db;
+
+    try {
+        db.OpenCheckpointer(sPath.c_str());
+    } catch (const std::exception& e) {
+        BEAM_LOG_ERROR() << "WAL checkpointer connection failed: " << e.what();
+        return;
+    }
+
+    std::unique_lock<std::mutex> scope(m_Mutex);
+
+    while (true)
+    {
+        m_Cv.wait_for(scope, std::chrono::milliseconds(nInterval_ms), [this]() { return m_Stop; });
+        if (m_Stop)
+            break;
+
+        scope.unlock();
+
+        try {
+            if (!db.WalCheckpoint())
+                BEAM_LOG_VERBOSE() << "WAL checkpoint incomplete";
+        } catch (const std::exception& e) {
+            BEAM_LOG_WARNING() << "WAL checkpoint failed: " << e.what();
         }
-    };
 
-    Wrk wrk(*this, msg);
+        scope.lock();
+    }
+}
 
-    m_This.m_Processor.ExecInDependentContext(wrk, m_Dependent.m_pQuery.get(), m_This.m_TxDependent);
+void Node::Peer::SendResult(ReadPath::Query& q)
+{
+    try {
+        if (q.m_bFailed)
+            q.Exec(m_This.m_Processor.get_DB()); // fallback
 
-    Send(wrk.m_Out);
+        TagScope scope(m_TagOut, q.m_Tag);
+        q.SendResult(*this);
+    } catch (const std::exception& e) {
+        OnExc(e);
+        return; // may be deleted
+    }
+
+    if (q.m_bSuspend)
+        ResumeInput(); // may be deleted
+}
+
+bool Node::Peer::OnMsg2(proto::Tagged&& msg)
+{
+    // responses to the tagged request are tagged the same
+    TagScope scope(m_TagOut, msg.m_ID);
+    return proto::NodeConnection::OnMsg2(std::move(msg));
 }
 
 void Node::Peer::OnMsg(proto::GetContractVar&& msg)
@@ -4471,6 +6612,7 @@ void Node::Miner::Initialize(IExternalPOW* externalPOW)
 void Node::Miner::RunMinerThread(const io::Reactor::Ptr& pReactor, const Rules& r)
 {
     Rules::Scope scopeRules(r);
+    ApplyPlacement(get_ParentObj().m_Cfg.m_Placement.m_Mining, "mining");
     pReactor->run();
 }
 
@@ -4590,6 +6732,7 @@ void Node::Miner::HardAbortSafe()
 {
     m_pTaskToFinalize.reset();
     m_FeesTrg = 0;
+    m_Full.m_Height = 0;
 
     std::scoped_lock<std::mutex> scope(m_Mutex);
 
@@ -4636,6 +6779,16 @@ void Node::Miner::SoftRestart()
     SetTimer(nTimeout_ms, false);
 }
 
+bool Node::Miner::IsFullFor(const TxPool::Profit& x) const
+{
+    if (!m_Full.m_Height || (m_Full.m_Height != get_ParentObj().m_Processor.m_Cursor.m_ID.m_Height + 1))
+        return false;
+
+    TxPool::Profit pf;
+    pf.m_Stats = m_Full.m_ProfitFloor;
+    return !(x < pf); // the block is filled in the order of profitability
+}
+
 void Node::Miner::SetTimer(uint32_t timeout_ms, bool bHard)
 {
     if (!IsEnabled())
@@ -4661,6 +6814,10 @@ bool Node::Miner::Restart()
 {
     m_LastRestart_ms = GetTimeNnz_ms();
 
+    // With the fake PoW the empty block would be 'mined' instantly, no point in it
+    bool bEmpty = m_bEmptyFirst && !Rules::get().FakePoW;
+    m_bEmptyFirst = false;
+
     if (!IsEnabled())
         return false; //  n/a
 
@@ -4689,7 +6846,12 @@ bool Node::Miner::Restart()
     bc.m_pParent = get_ParentObj().m_TxDependent.m_pBest;
 
     if (m_pFinalizer)
+    {
         bc.m_Mode = NodeProcessor::BlockContext::Mode::Assemble;
+        bEmpty = false; // the owner finalizes the block, the round-trip takes longer anyway
+    }
+
+    bc.m_bEmptyBody = bEmpty;
 
     bool bRes = get_ParentObj().m_Processor.GenerateNewBlock(bc);
 
@@ -4699,6 +6861,9 @@ bool Node::Miner::Restart()
         return false;
     }
 
+    m_Full.m_Height = bc.m_bFull ? bc.m_Hdr.m_Height : 0;
+    m_Full.m_ProfitFloor = bc.m_ProfitFloor;
+
     if (!IsShouldMine(bc))
         return false;
 
@@ -4721,8 +6886,13 @@ bool Node::Miner::Restart()
         m_pTaskToFinalize = std::move(pTask);
     }
     else
+    {
         StartMining(std::move(pTask));
 
+        if (bEmpty)
+            SetTimer(0, true); // the hashers are busy, now assemble the full block
+    }
+
     return true;
 }
 
@@ -4905,8 +7075,8 @@ struct Node::Beacon::OutCtx
     struct UvRequest
         :public uv_udp_send_t
     {
-        IMPLEMENT_GET_PARENT_OBJ(OutCtx, m_Request)
-    } m_Request;
+        OutCtx* m_pCtx;
+    };
 
     uv_buf_t m_BufDescr;
 
@@ -4917,9 +7087,16 @@ struct Node::Beacon::OutCtx
         PeerID m_NodeID;
         uint16_t m_Port; // in network byte order
     };
+
+    // nodes that don't recognize the tag receive it truncated, as a plain Message
+    struct MessageCluster
+        :public Message
+    {
+        Merkle::Hash m_ClusterTag;
+    };
 #pragma pack (pop)
 
-    Message m_Message; // the message broadcasted
+    MessageCluster m_Message; // the message broadcasted
 
     void Release()
     {
@@ -4960,7 +7137,7 @@ void Node::Beacon::Start()
     uv_udp_init(&io::Reactor::get_Current().get_UvLoop(), m_pUdp);
     m_pUdp->data = this;
 
-    m_BufRcv.resize(sizeof(OutCtx::Message));
+    m_BufRcv.resize(sizeof(OutCtx::MessageCluster));
 
     io::Address addr;
     addr.port(get_Port());
@@ -4994,7 +7171,14 @@ void Node::Beacon::OnTimer()
         m_pOut->m_Message.m_Port = htons(get_ParentObj().m_Cfg.m_Listen.port());
 
         m_pOut->m_BufDescr.base = (char*) &m_pOut->m_Message;
-        m_pOut->m_BufDescr.len = sizeof(m_pOut->m_Message);
+
+        if (get_ParentObj().m_Cfg.m_Cluster.m_Secret != Zero)
+        {
+            get_ClusterTag(m_pOut->m_Message.m_ClusterTag, m_pOut->m_Message.m_NodeID);
+            m_pOut->m_BufDescr.len = sizeof(OutCtx::MessageCluster);
+        }
+        else
+            m_pOut->m_BufDescr.len = sizeof(OutCtx::Message);
     }
     else
         if (m_pOut->m_Refs > 1)
@@ -5003,15 +7187,32 @@ void Node::Beacon::OnTimer()
     io::Address addr;
     addr.port(get_Port());
     addr.ip(INADDR_BROADCAST);
+    SendTo(addr);
+
+    for (const auto& addrTrg : get_ParentObj().m_Cfg.m_Cluster.m_vBeaconTargets)
+    {
+        addr = addrTrg;
+        if (!addr.port())
+            addr.port(get_Port());
+        SendTo(addr);
+    }
+}
 
+void Node::Beacon::SendTo(const io::Address& addr)
+{
     sockaddr_in sa;
     addr.fill_sockaddr_in(sa);
 
+    auto pReq = new OutCtx::UvRequest;
+    pReq->m_pCtx = m_pOut;
     m_pOut->m_Refs++;
 
-    int nErr = uv_udp_send(&m_pOut->m_Request, m_pUdp, &m_pOut->m_BufDescr, 1, (sockaddr*) &sa, OutCtx::OnDone);
+    int nErr = uv_udp_send(pReq, m_pUdp, &m_pOut->m_BufDescr, 1, (sockaddr*) &sa, OutCtx::OnDone);
     if (nErr)
+    {
+        delete pReq;
         m_pOut->Release();
+    }
 }
 
 void Node::Beacon::OutCtx::OnDone(uv_udp_send_t* req, int /* status */)
@@ -5019,16 +7220,33 @@ void Node::Beacon::OutCtx::OnDone(uv_udp_send_t* req, int /* status */)
     UvRequest* pVal = (UvRequest*)req;
     assert(pVal);
 
-    pVal->get_ParentObj().Release();
+    OutCtx* pCtx = pVal->m_pCtx;
+    delete pVal;
+    pCtx->Release();
+}
+
+void Node::Beacon::get_ClusterTag(Merkle::Hash& hv, const PeerID& id) const
+{
+    // bound to the node ID, which is verified on connection. Reveals nothing about the secret
+    ECC::Hash::Processor()
+        << "beacon.cluster"
+        << get_ParentObj().m_Cfg.m_Cluster.m_Secret
+        << id
+        >> hv;
+}
+
+bool Node::Beacon::IsClusterMember(const PeerID& id) const
+{
+    return m_mapCluster.end() != m_mapCluster.find(id);
 }
 
 void Node::Beacon::OnRcv(uv_udp_t* handle, ssize_t nread, const uv_buf_t* buf, const struct sockaddr* pSa, unsigned flags)
 {
-    OutCtx::Message msg;
-    if (sizeof(msg) != nread)
+    OutCtx::MessageCluster msg;
+    if ((sizeof(OutCtx::Message) != nread) && (sizeof(OutCtx::MessageCluster) != nread))
         return;
 
-    memcpy(&msg, buf->base, sizeof(msg)); // copy it to prevent (potential) datatype misallignment and etc.
+    memcpy(&msg, buf->base, nread); // copy it to prevent (potential) datatype misallignment and etc.
 
     if (msg.m_CfgChecksum != Rules::get().get_LastFork().m_Hash)
         return;
@@ -5042,6 +7260,22 @@ void Node::Beacon::OnRcv(uv_udp_t* handle, ssize_t nread, const uv_buf_t* buf, c
     addr.port(ntohs(msg.m_Port));
 
     pThis->get_ParentObj().m_PeerMan.OnPeer(msg.m_NodeID, addr, true);
+
+    if ((sizeof(OutCtx::MessageCluster) == nread) && (pThis->get_ParentObj().m_Cfg.m_Cluster.m_Secret != Zero))
+    {
+        Merkle::Hash hv;
+        pThis->get_ClusterTag(hv, msg.m_NodeID);
+        if (hv == msg.m_ClusterTag)
+        {
+            auto it = pThis->m_mapCluster.find(msg.m_NodeID);
+            if (pThis->m_mapCluster.end() == it)
+            {
+                BEAM_LOG_INFO() << "Cluster member " << msg.m_NodeID << " at " << addr;
+                it = pThis->m_mapCluster.emplace(msg.m_NodeID, 0).first;
+            }
+            it->second = GetTimeNnz_ms();
+        }
+    }
 }
 
 void Node::Beacon::AllocBuf(uv_handle_t* handle, size_t suggested_size, uv_buf_t* buf)
@@ -5050,7 +7284,7 @@ void Node::Beacon::AllocBuf(uv_handle_t* handle, size_t suggested_size, uv_buf_t
     assert(pThis);
 
     buf->base = (char*) &pThis->m_BufRcv.at(0);
-    buf->len = sizeof(OutCtx::Message);
+    buf->len = sizeof(OutCtx::MessageCluster);
 }
 
 void Node::Beacon::OnClosed(uv_handle_t* p)
@@ -5063,6 +7297,11 @@ void Node::PeerMan::Initialize()
 {
     const Config& cfg = get_ParentObj().m_Cfg;
 
+    {
+        TimePoint tp;
+        m_Start_ms = tp.get();
+    }
+
     for (uint32_t i = 0; i < cfg.m_Connect.size(); i++)
     {
         PeerID id0(Zero);
@@ -5096,6 +7335,8 @@ void Node::PeerMan::Initialize()
 
             pPi->m_LastSeen = wlk.m_Data.m_LastSeen;
             pPi->m_LastConnectAttempt = pPi->m_LastSeen;
+            pPi->m_Rtt_ms = wlk.m_Data.m_Rtt_ms;
+            pPi->m_LastGood = wlk.m_Data.m_LastGood;
         }
     }
 }
@@ -5117,6 +7358,8 @@ void Node::PeerMan::OnFlush()
         d.m_Rating = pi.m_RawRating.m_Value;
         d.m_Address = pi.m_Addr.m_Value.u64();
         d.m_LastSeen = pi.m_LastSeen;
+        d.m_Rtt_ms = pi.m_Rtt_ms;
+        d.m_LastGood = pi.m_LastGood;
 
         db.PeerIns(d);
     }
@@ -5125,6 +7368,28 @@ void Node::PeerMan::OnFlush()
 void Node::PeerMan::ActivateMorePeers(uint32_t nTime_ms)
 {
     const Config& cfg = get_ParentObj().m_Cfg; // alias
+
+    if (cfg.m_WarmStart.m_Count && (nTime_ms - m_Start_ms < cfg.m_WarmStart.m_Duration_ms))
+        ActivateWarmPeers(nTime_ms);
+
+    auto& mapCluster = get_ParentObj().m_Beacon.m_mapCluster;
+    uint32_t nClusterTimeout_ms = cfg.m_BeaconPeriod_ms * Beacon::s_ClusterTimeoutPeriods;
+    for (auto it = mapCluster.begin(); mapCluster.end() != it; )
+    {
+        auto itThis = it++;
+        if (nTime_ms - itThis->second > nClusterTimeout_ms)
+        {
+            BEAM_LOG_INFO() << "Cluster member lost " << itThis->first;
+            mapCluster.erase(itThis);
+            continue;
+        }
+
+        bool bCreate = false;
+        PeerInfo* pPi = Find(itThis->first, bCreate);
+        if (pPi)
+            ActivatePeerSafe(*pPi, nTime_ms); // keep connected, regardless to the rating
+    }
+
     if (!cfg.m_PeersPersistent)
         return;
 
@@ -5137,6 +7402,36 @@ void Node::PeerMan::ActivateMorePeers(uint32_t nTime_ms)
     }
 }
 
+void Node::PeerMan::ActivateWarmPeers(uint32_t nTime_ms)
+{
+    const Config::WarmStart& cfg = get_ParentObj().m_Cfg.m_WarmStart; // alias
+    Timestamp ts = getTimestamp();
+
+    std::vector<PeerInfo*> v;
+
+    const RawRatingSet& rs = get_Ratings();
+    for (RawRatingSet::const_iterator it = rs.begin(); rs.end() != it; ++it)
+    {
+        PeerInfo& pi = Cast::NotConst(it->get_ParentObj());
+        if (!pi.m_RawRating.m_Value)
+            break; // banned, the rest too
+
+        if (pi.m_LastGood && (ts - pi.m_LastGood <= cfg.m_MaxAge_s))
+            v.push_back(&pi);
+    }
+
+    // unknown latency goes last, the stable sort keeps them by the rating
+    std::stable_sort(v.begin(), v.end(), [](const PeerInfo* p0, const PeerInfo* p1) {
+        return (p0->m_Rtt_ms - 1U) < (p1->m_Rtt_ms - 1U);
+    });
+
+    if (v.size() > cfg.m_Count)
+        v.resize(cfg.m_Count);
+
+    for (size_t i = 0; i < v.size(); i++)
+        ActivatePeerSafe(*v[i], nTime_ms);
+}
+
 void Node::PeerMan::ActivatePeer(PeerInfo& pi)
 {
     PeerInfoPlus& pip = Cast::Up<PeerInfoPlus>(pi);
@@ -5177,6 +7472,9 @@ void Node::PeerMan::PeerInfoPlus::Attach(Peer& p)
 	m_Live.m_p = &p;
 	p.m_pInfo = this;
 
+	if (!p.m_Rtt_ms)
+		p.m_Rtt_ms = m_Rtt_ms; // from the previous sessions
+
 	PeerManager::TimePoint tp;
 	p.m_This.m_PeerMan.m_LiveSet.insert(m_Live);
 }
@@ -5191,6 +7489,18 @@ void Node::PeerMan::PeerInfoPlus::DetachStrict()
 	m_Live.m_p = nullptr;
 }
 
+bool Node::ExportSnapshot(const char* szPath)
+{
+	try {
+		m_Processor.ExportSnapshot(szPath);
+	} catch (const std::exception& e) {
+		BEAM_LOG_ERROR() << "Snapshot export failed: " << e.what();
+		return false;
+	}
+
+	return true;
+}
+
 bool Node::GenerateRecoveryInfo(const char* szPath)
 {
 	if (!m_Processor.BuildCwp())
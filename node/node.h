@@ -15,7 +15,9 @@
 #pragma once
 
 #include "processor.h"
+#include "bbs_store.h"
 #include "utility/io/timer.h"
+#include "utility/metrics.h"
 #include "core/proto.h"
 #include "core/block_crypt.h"
 #include "core/shielded.h"
@@ -52,11 +54,26 @@ struct Node
 	struct Config
 	{
 		io::Address m_Listen;
+		bool m_ListenReusePort = false; // SO_REUSEPORT, the port may be shared with other listeners (e.g. a standby node during a rolling restart)
 		uint16_t m_BeaconPort = 0; // set to 0 if should use the same port for listen
 		uint32_t m_BeaconPeriod_ms = 500;
+
+		// nodes sharing the secret recognize each other by their beacons, stay connected, and get the new tips first
+		struct Cluster {
+			ECC::Hash::Value m_Secret = Zero; // Zero - disabled
+			std::vector<io::Address> m_vBeaconTargets; // unicast beacons, for the members beyond the broadcast domain. Port 0 - the beacon port
+		} m_Cluster;
+
 		std::vector<io::Address> m_Connect;
 		bool m_PeersPersistent = false; // keep connection to those peers, regardless to their rating
 
+		// after the start the peers that recently delivered data are connected right away (in addition to the regular selection), lowest latency first
+		struct WarmStart {
+			uint32_t m_Count = 4; // 0 - disable
+			uint32_t m_MaxAge_s = 60 * 60 * 24;
+			uint32_t m_Duration_ms = 1000 * 60 * 2;
+		} m_WarmStart;
+
 		std::string m_sPathLocal;
 		NodeProcessor::Horizon m_Horizon;
 
@@ -72,8 +89,26 @@ struct Node
 		} m_Timeout;
 
 		uint32_t m_MaxConcurrentBlocksRequest = 18;
+		bool m_CompactBodies = true; // request new single blocks in compact form (short IDs), reconstructed from the tx pool
+		uint32_t m_TxSketchCells = 240; // tx pool sketch sent on login, so that the peer announces only the txs we lack. 0 - disable
+
+		// Hedged body requests: a request that takes longer than the given quantile of the recent body download times
+		// is duplicated to a faster idle peer, whichever responds first is used
+		struct Hedge {
+			uint32_t m_Quantile = 950; // per-mille. 0 - disable
+			uint32_t m_MinDelay_ms = 1000 * 3;
+			uint32_t m_MinSamples = 16; // not before the statistics is collected
+		} m_Hedge;
+
+		struct FastSync {
+			uint32_t m_MaxRanges = 8; // height ranges downloaded concurrently, each from a different peer. 1 = sequential
+			uint32_t m_RangeSize = 1000;
+		} m_FastSync;
+
 		uint32_t m_MaxPoolTransactions = 100 * 1000;
+		uint64_t m_MaxPoolSize = 512ULL * 1024 * 1024; // estimated memory of the fluff pool, 0 = unlimited
 		uint32_t m_MaxDeferredTransactions = 100 * 1000;
+		bool m_PersistTxPool = false; // save the tx pool on shutdown, re-submit it (with full validation) on startup
 		uint32_t m_MiningThreads = 0; // by default disabled
 
 		bool m_LogEvents = false; // may be insecure. Off by default.
@@ -83,11 +118,75 @@ struct Node
 
 		bool m_PreferOnlineMining = true;
 
+		struct TxVerify
+		{
+			// context-free verification of txs relayed by other nodes is done by the verification threads, off the reactor thread
+			uint32_t m_MaxInFlight = 64; // 0 = verify synchronously
+			uint32_t m_MaxPerPeer = 8; // backpressure, so that a single peer can't monopolize the verifiers
+			uint32_t m_Budget_ms = 5; // processing of the verified txs per loop iteration, at least 1 tx
+
+		} m_TxVerify;
+
+		struct TxTrickle
+		{
+			// Fluffed txs are announced to each peer after an independent randomized (exponential) delay, all the accumulated ones at once,
+			// instead of each tx to all the peers on arrival. Less per-tx overhead, and the arrival times reveal less about the tx origin.
+			uint32_t m_Mean_ms = 0; // for outbound peers. 0 = disable (announce immediately)
+			uint32_t m_InboundFactor = 2; // inbound peers wait longer, they are more likely to be spies
+
+		} m_TxTrickle;
+
 		// Number of verification threads for CPU-hungry cryptography. Currently used for block validation only.
 		// 0: single threaded
 		// negative: number of cores minus number of mining threads.
 		int m_VerificationThreads = 0;
 
+		// Optional CPU placement per thread role, so that the roles don't disturb each other on many-core machines.
+		// The intended priority order is reactor > verification > mining. Within the verification threads
+		// block validation already precedes the relayed txs (higher task priority).
+		struct Placement
+		{
+			ThreadPlacement m_Reactor; // the thread that runs the node, applied on Initialize
+			ThreadPlacement m_Verification;
+			ThreadPlacement m_Mining;
+
+		} m_Placement;
+
+		struct Memory
+		{
+			// Soft limit on the resident memory of the process, checked periodically. Above it the node sheds what it can do without:
+			// half of the validated tx cache and of the tx pool (least profitable first), the cached proofs and the DB page cache.
+			uint64_t m_SoftLimit = 0; // 0 = no limit
+			uint32_t m_Check_ms = 5000;
+			uint32_t m_ReportPeriod_s = 0; // log the memory report periodically. 0 = never
+
+		} m_Memory;
+
+		// Max number of consecutive blocks whose proofs are batch-verified together during sync. 0: unlimited
+		uint32_t m_VerificationBatchBlocks = 1000;
+
+		// Threads for read-only peer queries (contract vars/logs enumeration), each with its own DB connection.
+		// They see the last committed DB state. 0 = served by the main thread
+		uint32_t m_ReadThreads = 0;
+
+		// WAL journaling with checkpoints made by a dedicated thread.
+		// Commits become appends to the WAL, the data file is written and synced on checkpoints only.
+		struct Wal
+		{
+			bool m_Enabled = false;
+			uint32_t m_CheckpointInterval_ms = 5000;
+
+		} m_Wal;
+
+		// Online DB compaction: free pages are released incrementally on a timer, instead of the full (blocking) vacuum.
+		// Requires the DB in the incremental vacuum mode (new DBs are, existing need a single vacuum to convert).
+		struct Compaction
+		{
+			uint32_t m_Period_ms = 0; // 0 = disabled
+			uint32_t m_Budget_ms = 20; // max time per tick
+
+		} m_Compaction;
+
 		struct RollbackLimit
 		{
 			Height m_Max = 60; // artificial restriction on how much the node will rollback automatically
@@ -103,6 +202,8 @@ struct Node
 
 			NodeDB::BbsTotals m_Limit;
 
+			bool m_Persist = true; // the messages are kept in memory, saved to the DB on stop and loaded on start
+
 			Bbs()
 			{
 				// set the following to 0 to disable BBS replication.
@@ -110,7 +211,8 @@ struct Node
 				// Means, for the default 12-hour lifetime it's about 1.5 mln, hence the following (20 mln) is more than enough
 				m_Limit.m_Count = 20000000;
 				// max bbs msg size is proto::Bbs::s_MaxMsgSize == 1Mb. However mostly they're much smaller.
-				m_Limit.m_Size = uint64_t(5) * 1024U * 1024U * 1024U; // 5Gb
+				// The messages are held in memory, hence the size limit is moderate
+				m_Limit.m_Size = uint64_t(1024U) * 1024U * 1024U; // 1Gb
 			}
 
 			bool IsEnabled() const { return m_Limit.m_Count > 0; }
@@ -125,6 +227,32 @@ struct Node
 			size_t m_MaxBodyPackSize = 1024 * 1024 * 5;
 			uint32_t m_MaxBodyPackCount = 3000;
 
+			// Bulk data (block bodies) served to the peers is rate-limited per peer class, by a token bucket.
+			// The urgent messages (new tips, block propagation, txs) are never limited. The bulk responses are deferred while the peer has an unsent backlog, so that the urgent ones never wait behind much of it.
+			struct PeerClass
+			{
+				enum Enum {
+					Full,
+					Light, // wallets, explorers, etc.
+					Owner, // own wallet or miner
+					count
+				};
+			};
+
+			struct Bucket
+			{
+				uint32_t m_Rate; // bytes/sec, 0 = unlimited
+				uint32_t m_Burst;
+			};
+
+			Bucket m_pBulk[PeerClass::count] = {
+				{ 1024*1024 * 16, 1024*1024 * 32 },
+				{ 1024*1024 * 2, 1024*1024 * 8 },
+				{ 0, 0 },
+			};
+
+			size_t m_BulkBacklog = 1024 * 256;
+
 		} m_BandwidthCtl;
 
 		struct TestMode {
@@ -144,6 +272,11 @@ struct Node
 			uint32_t m_OutputsMin = 5; // must be aggregated.
 			uint32_t m_OutputsMax = 40; // may be aggregated
 
+			// Batch aggregation: pending stem txs are aggregated all at once (in parallel), periodically or once enough of them are pending,
+			// instead of each on arrival. The aggregation timeout (m_AggregationTime_ms) still applies to each tx.
+			uint32_t m_BatchPeriod_ms = 0; // 0 = disabled
+			uint32_t m_BatchSize = 32;
+
 			// dummy creation strategy
 			uint32_t m_DummyLifetimeLo = 720;
 			uint32_t m_DummyLifetimeHi = 1440 * 7; // set to 0 to disable
@@ -217,11 +350,32 @@ struct Node
 	bool m_PostStartSynced = false;
 
 	bool GenerateRecoveryInfo(const char*);
+	bool ExportSnapshot(const char*);
 	void PrintTxos();
 	void PrintRollbackStats();
 
 	void RefreshCongestions(); // call explicitly if manual rollback or forbidden state is modified
 
+	// Memory per subsystem. Estimated from the subsystem sizes rather than tracked per allocation, cheap to collect
+	struct MemReport
+	{
+		uint64_t m_Process; // resident, 0 if not available
+		uint64_t m_TxPool; // fluff pool
+		uint64_t m_TxStem;
+		uint64_t m_TxDependent;
+		uint64_t m_ValidatedCache;
+		uint64_t m_PeerBuffers; // unsent outgoing data of all the peers
+		uint64_t m_Mapped; // UTXO and contracts image, file-backed
+		uint64_t m_Db; // sqlite heap of the main connection
+		uint64_t m_Bbs;
+		uint32_t m_Peers;
+		uint32_t m_Shed; // times the soft limit was exceeded
+
+		void Print(std::ostream&) const;
+	};
+
+	void get_MemReport(MemReport&);
+
 	bool DecodeAndCheckHdrs(std::vector<Block::SystemState::Full>&, const proto::HdrPack&);
 	static bool DecodeAndCheckHdrsImpl(std::vector<Block::SystemState::Full>&, const proto::HdrPack&, ExecutorMT&);
 
@@ -236,6 +390,8 @@ struct Node
 
 private:
 
+	static void ApplyPlacement(const ThreadPlacement&, const char* szRole);
+
 	struct Processor
 		:public NodeProcessor
 	{
@@ -269,6 +425,12 @@ private:
 		Block::ChainWorkProof m_Cwp; // cached
 		bool BuildCwp();
 
+		// Serialized ProofChainWork cropped to the requested lower bound, for the current tip.
+		// Reconnecting clients typically request the same bounds, the cropping (which verifies the proof) and serialization are done once.
+		std::map<Difficulty::Raw, ByteBuffer> m_CwpCropped;
+		static const uint32_t s_CwpCroppedMax = 64;
+		const ByteBuffer& get_CwpCropped(const Difficulty::Raw& lowerBound);
+
 		void GenerateProofStateStrict(Merkle::HardProof&, Height);
 		void GenerateProofShielded(Merkle::Proof&, const uintBigFor<TxoID>::Type& mmrIdx);
 
@@ -282,6 +444,16 @@ private:
 		void TryGoUpAsync();
 		void OnGoUpTimer();
 
+		// Coalesces the refresh requests of the same loop iteration (new tips, completed tasks, cursor changes) into a single EnumCongestions
+		bool m_bCongestionsPending = false;
+		io::Timer::Ptr m_pCongestionsTimer;
+		void RefreshCongestionsAsync();
+		void OnCongestionsTimer();
+
+		io::Timer::Ptr m_pCompactionTimer;
+		void StartCompaction();
+		void OnCompactionTimer();
+
 		std::deque<PeerID> m_lstInsanePeers;
 		io::AsyncEvent::Ptr m_pAsyncPeerInsane;
 		void FlushInsanePeers();
@@ -304,6 +476,10 @@ private:
 		NodeDB::StateID m_sidTrg;
 		Height m_h0; // those 2 are fast-sync params at the moment of task assignment
 		Height m_hTxoLo;
+		bool m_bRange; // fast-sync range, accounted separately
+		bool m_bCompact; // requested as a compact body
+		bool m_bHedged; // was duplicated to another peer (at most once)
+		bool m_bHedge; // this is the duplicate, not limited by the concurrent requests limits
 		Peer* m_pOwner;
 
 		bool operator < (const Task& t) const { return (m_Key < t.m_Key); }
@@ -314,6 +490,7 @@ private:
 
 	uint32_t m_nTasksPackHdr = 0;
 	uint32_t m_nTasksPackBody = 0;
+	uint32_t m_nTasksPackRange = 0;
 
 	TaskList m_lstTasksUnassigned;
 	TaskSet m_setTasks;
@@ -324,6 +501,9 @@ private:
 	void TryAssignTask(Task&);
 	bool TryAssignTask(Task&, Peer&);
 	void DeleteUnassignedTask(Task&);
+	Task* FindTaskInFlight(const Task::Key&);
+	uint32_t get_HedgeDelay_ms(const Peer&);
+	bool TryHedgeTask(Task&);
 
 	void InitKeys();
 	void InitIDs();
@@ -381,31 +561,186 @@ private:
 		virtual bool ValidateTxContext(const Transaction&, const HeightRange&, const AmountBig::Number&, Amount& feeReserve) override;
 		virtual void OnTimedOut(Element&) override;
 
+		io::Timer::Ptr m_pBatchTimer;
+		bool m_bBatchPending = false;
+		void OnBatchElement(Element&);
+		void OnBatchTimer();
+		void AggregateBatch();
+
 		IMPLEMENT_GET_PARENT_OBJ(Node, m_Dandelion)
 	} m_Dandelion;
 
 	struct TxDeferred
 		:public io::IdleEvt
 	{
+		// context-free verification, performed asynchronously by the executor
+		struct Verification
+		{
+			typedef std::shared_ptr<Verification> Ptr;
+
+			Transaction::Ptr m_pTx;
+			PeerID m_Sender;
+			Height m_hMin;
+			Transaction::Context m_Ctx;
+			std::string m_sErr;
+			bool m_bValid = false;
+			bool m_bDone = false; // accessed from the reactor thread only
+		};
+
+		struct VerifyTask;
+
 		struct Element
 		{
 			Transaction::Ptr m_pTx;
 			std::unique_ptr<Merkle::Hash> m_pCtx;
 			PeerID m_Sender;
 			bool m_Fluff;
+			uint64_t m_Priority; // owner txs first, then by the fee relative to the minimal one
+			Verification::Ptr m_pVerify; // set once the verification is started
 		};
 
-		std::list<Element> m_lst;
+		std::list<Element> m_lst; // by priority, then arrival. The arrival order of each sender is preserved
+
+		static const uint32_t s_Window = 256; // how deep in the list to look for txs to verify/process
+
+		uint32_t m_nInFlight = 0;
+		std::map<PeerID, uint32_t> m_mapInFlight; // per sender
+
+		std::mutex m_Mutex;
+		std::vector<Verification::Ptr> m_vDone; // completed by the executor, not handled yet. Protected by m_Mutex
+		io::AsyncEvent::Ptr m_pEvtDone;
+
+		const Verification* m_pCurrent = nullptr; // while the tx is being processed
+
+		void TryVerify();
+		void OnVerified();
+		std::list<Element>::iterator FindReady();
+
+		static uint64_t get_Priority(const Transaction&, Height, bool bOwn);
+		void Insert(Element&&);
 
 		virtual void OnSchedule() override;
 
 		IMPLEMENT_GET_PARENT_OBJ(Node, m_TxDeferred)
 	} m_TxDeferred;
 
-	void OnTransactionDeferred(Transaction::Ptr&&, std::unique_ptr<Merkle::Hash>&&, const PeerID*, bool bFluff);
+	struct TxTrickle
+	{
+		static const uint32_t s_Slice_ms = 50; // the peers are visited in time slices, not per tx
+
+		io::Timer::Ptr m_pTimer;
+		bool m_bArmed = false;
+		uint64_t m_Rnd = 0;
+
+		void OnNewTx();
+		void OnTimer();
+		void Arm();
+		uint32_t get_Delay_ms(const Peer&);
+
+		IMPLEMENT_GET_PARENT_OBJ(Node, m_TxTrickle)
+	} m_TxTrickle;
+
+	struct HdrVerifier
+	{
+		// PoW of the received hdr packs is verified in parallel, w/o blocking the reactor thread. The peer input is suspended meanwhile
+		struct Pack
+		{
+			typedef std::shared_ptr<Pack> Ptr;
+
+			Peer* m_pPeer = nullptr; // reset if the peer is deleted. Accessed from the reactor thread only
+			std::vector<Block::SystemState::Full> m_vStates;
+			Block::SystemState::ID m_idLast;
+			std::atomic<uint32_t> m_nPending; // portions in progress
+			std::atomic<bool> m_bValid;
+		};
+
+		struct Task;
+
+		static const uint32_t s_MinPortion = 16;
+
+		std::mutex m_Mutex;
+		std::vector<Pack::Ptr> m_vDone; // protected by m_Mutex
+		io::AsyncEvent::Ptr m_pEvtDone;
+
+		void Post(Peer&, Pack::Ptr&&);
+		void OnDone();
+
+		IMPLEMENT_GET_PARENT_OBJ(Node, m_HdrVerifier)
+	} m_HdrVerifier;
+
+	struct ReadPath
+		:public ExecutorMT_R
+	{
+		struct Query
+		{
+			typedef std::shared_ptr<Query> Ptr;
+
+			Peer* m_pPeer = nullptr; // reset if the peer is deleted. Accessed from the reactor thread only
+			size_t m_nSizeMax = 0; // response size limit, w.r.t. peer bandwidth
+			bool m_bFailed = false;
+			uint32_t m_Tag = 0; // of the request, the result is tagged the same
+			bool m_bSuspend = false; // the peer input is suspended until the result is sent
+
+			virtual ~Query() = default;
+			virtual void Exec(NodeDB&) = 0; // worker thread
+			virtual void SendResult(Peer&) = 0; // reactor thread
+		};
+
+		struct MyContext
+			:public Executor::Context
+		{
+			NodeDB m_DB;
+		};
+
+		struct Task;
+
+		std::mutex m_Mutex;
+		std::vector<Query::Ptr> m_vDone; // protected by m_Mutex
+		io::AsyncEvent::Ptr m_pEvtDone;
+
+		static const uint32_t s_MaxTaggedPerPeer = 8; // tagged queries don't suspend the input, up to this limit
+
+		bool IsEnabled() const;
+		void Post(Peer&, Query::Ptr&&); // the peer input is suspended until the result is sent, unless the request is tagged
+		void OnDone();
+
+		virtual void RunThread(uint32_t) override;
+		~ReadPath() { Stop(); }
+
+		IMPLEMENT_GET_PARENT_OBJ(Node, m_ReadPath)
+	} m_ReadPath;
+
+	struct WalCheckpointer
+	{
+		std::thread m_Thread;
+		std::mutex m_Mutex;
+		std::condition_variable m_Cv;
+		bool m_Stop = false; // protected by m_Mutex
+
+		void Start(const std::string& sPath, uint32_t nInterval_ms);
+		void Stop();
+		void RunThread(std::string sPath, uint32_t nInterval_ms);
+
+		~WalCheckpointer() { Stop(); }
+	} m_WalCheckpointer;
+
+	typedef std::function<bool(size_t)> IsResponseFull;
+	static void EnumContractVars(NodeDB&, proto::ContractVarsEnum&, proto::ContractVars&, const IsResponseFull&);
+	static void EnumContractLogs(NodeDB&, proto::ContractLogsEnum&, proto::ContractLogs&, const IsResponseFull&);
+
+	template <typename TIn, typename TOut, void (*TFunc)(NodeDB&, TIn&, TOut&, const IsResponseFull&)>
+	struct ReadPathQuery;
+
+	void OnTransactionDeferred(Transaction::Ptr&&, std::unique_ptr<Merkle::Hash>&&, const PeerID*, bool bFluff, bool bOwn = false);
+
+	std::string get_TxPoolPath() const;
+	void SaveTxPool();
+	void LoadTxPool();
 	uint8_t OnTransactionStem(Transaction::Ptr&&, std::ostream* pExtraInfo);
 	uint8_t OnTransactionFluff(Transaction::Ptr&&, std::ostream* pExtraInfo, const PeerID*, const TxPool::Stats*);
 	void OnTransactionFluff(TxPool::Fluff::Element&, const PeerID*);
+	void BroadcastFluff(TxPool::Fluff::Element&, const PeerID*);
+	bool IsTxPoolOverLimit() const;
 	uint8_t OnTransactionDependent(Transaction::Ptr&& pTx, const Merkle::Hash& hvCtx, const PeerID* pSender, bool bFluff, std::ostream* pExtraInfo);
 	void OnTransactionAggregated(Transaction::Ptr&&, const TxPool::Stats&);
 	void PerformAggregation(Dandelion::Element&);
@@ -462,11 +797,43 @@ private:
 		Subscription::BbsSet m_Subscribed;
 		Timestamp m_HighestPosted_s = 0;
 
-		NodeDB::BbsTotals m_Totals;
+		BbsStore m_Store;
 
 		IMPLEMENT_GET_PARENT_OBJ(Node, m_Bbs)
 	} m_Bbs;
 
+	struct Metrics
+		:public metrics::ISource
+	{
+		// peer trafic per message code, [0] - in, [1] - out
+		struct Msg
+		{
+			uint64_t m_pCount[2];
+			uint64_t m_pBytes[2];
+		};
+		Msg m_pMsgs[0x100];
+
+		Metrics() { ZeroObject(m_pMsgs); }
+
+		void WriteMetrics(metrics::Writer&) override;
+		static const char* get_MsgName(uint32_t iCode);
+
+		IMPLEMENT_GET_PARENT_OBJ(Node, m_Metrics)
+	} m_Metrics;
+
+	struct MemCtl
+	{
+		io::Timer::Ptr m_pTimer;
+		uint32_t m_Shed = 0;
+		uint32_t m_SinceReport_ms = 0;
+
+		void Initialize();
+		void OnTimer();
+		void Shed();
+
+		IMPLEMENT_GET_PARENT_OBJ(Node, m_MemCtl)
+	} m_MemCtl;
+
 	struct PeerMan
 		:public PeerManager
 	{
@@ -476,6 +843,9 @@ private:
 		void Initialize();
 		void OnFlush();
 
+		uint32_t m_Start_ms = 0;
+		void ActivateWarmPeers(uint32_t nTicks_ms);
+
 		struct PeerInfoPlus
 			:public PeerInfo
 		{
@@ -523,6 +893,8 @@ private:
 			static const uint16_t Owner			= 0x004;
 			static const uint16_t Probe			= 0x008;
 			static const uint16_t SerifSent		= 0x010;
+			static const uint16_t TxSketchWait	= 0x020; // the tx pool backlog is not announced until the peer's sketch arrives
+			static const uint16_t TxSketchSent	= 0x040;
 			static const uint16_t Finalizing	= 0x080;
 			static const uint16_t HasTreasury	= 0x100;
 			static const uint16_t Chocking		= 0x200;
@@ -545,8 +917,22 @@ private:
 
 		uint64_t m_CursorBbs;
 		TxPool::Fluff::Element::Send* m_pCursorTx;
+		uint32_t m_TrickleDue_ms = 0; // next tx announcement, if trickle is enabled
 
 		const NodeProcessor::Account* m_pAccount = nullptr;
+		uint32_t m_nEventsSent = static_cast<uint32_t>(-1); // the account events counter at the last EventsNew, -1 if none sent yet
+
+		std::vector<ReadPath::Query::Ptr> m_vReadQueries; // in progress
+		HdrVerifier::Pack::Ptr m_pHdrPack; // being verified, the input is suspended
+
+		struct CompactBody
+		{
+			Block::SystemState::ID m_ID;
+			Block::Body m_Body; // reconstructed so far, the missing elements are NULL
+			Merkle::Hash m_hvBody;
+			proto::GetBodyElements m_Missing;
+		};
+		std::unique_ptr<CompactBody> m_pCompactBody; // waiting for the missing elements of the first task
 
 		TaskList m_lstTasks;
 		std::set<Task::Key> m_setRejected; // data that shouldn't be requested from this peer. Reset after reconnection or on receiving NewTip
@@ -555,9 +941,28 @@ private:
 
 		io::Timer::Ptr m_pTimerRequest;
 		io::Timer::Ptr m_pTimerPeers;
+		uint32_t m_HedgeTimeout_ms = 0; // the request timer is armed for the hedge, this much remains then till the timeout
+
+		uint32_t m_Rtt_ms = 0; // smoothed request latency, excluding the estimated transfer time
+
+		struct Bulk
+		{
+			int64_t m_Tokens = 0; // can go negative, the response size is known only after it's sent
+			uint32_t m_Refill_ms = 0;
+			bool m_bInit = false;
+			uint64_t m_BytesOut = 0; // all the outgoing traffic
+
+			std::unique_ptr<proto::GetBodyPack> m_pPending; // deferred, the input is suspended
+			uint32_t m_PendingTag = 0;
+			io::Timer::Ptr m_pTimer;
+
+			static const uint32_t s_Poll_ms = 50; // recheck interval while the backlog is drained
+		} m_Bulk;
 
 		Peer(Node& n) :m_This(n) {}
 
+		uint32_t get_BlockTasks() const;
+
 		void TakeTasks();
 		void ReleaseTasks();
 		void ReleaseTask(Task&);
@@ -569,17 +974,32 @@ private:
 		void SendBbsMsg(const NodeDB::WalkerBbs::Data&);
 		void DeleteSelf(bool bIsError, uint8_t nByeReason);
 		void BroadcastTxs();
+		bool HasTxBacklog() const;
+		struct TxAnnouncer;
+		void MaybeSendTxSketch();
 		void BroadcastBbs();
 		void BroadcastBbs(Bbs::Subscription&);
 		void MaybeSendSerif();
 		void MaybeSendDependent();
+		void MaybeSendEventsNew();
 		void OnChocking();
 		void SetTxCursor(TxPool::Fluff::Element::Send*);
 		bool GetBlock(proto::BodyBuffers&, const NodeDB::StateID&, const proto::GetBodyPack&, bool bActive);
+		bool GetBlockRef(proto::BodyBuffersRef&, const NodeDB::StateID&, const proto::GetBodyPack&);
+		bool SendBodyPackRef(NodeDB::StateID, Height hMax, const proto::GetBodyPack&);
+		bool LoadBody(Block::Body&, proto::BodyBuffers&, const Block::SystemState::ID&);
+		void ReconstructFromPool(Block::Body&, const proto::BodyCompact&);
+		void FinishCompactBody(CompactBody&);
 
 		bool IsChocking(size_t nExtra = 0);
+		Config::BandwidthCtl::PeerClass::Enum get_Class() const;
+		bool ShouldDeferBulk(uint32_t& nWait_ms);
+		void ServeBulk(const proto::GetBodyPack&);
+		void ServeBodyPack(const proto::GetBodyPack&);
+		void OnBulkTimer();
 		bool ShouldAssignTasks();
 		bool ShouldFinalizeMining();
+		bool IsClusterMember() const;
 		Task& get_FirstTask();
 		bool ShouldAcceptBodyPack();
 		void OnFirstTaskDone();
@@ -587,6 +1007,8 @@ private:
 		void ModifyRatingWrtData(size_t nSize);
 		void SendHdrs(NodeDB::StateID&, uint32_t nCount);
 		void SendTx(Transaction::Ptr& ptx, bool bFluff, const Merkle::Hash* pCtx = nullptr);
+		void SendResult(ReadPath::Query&);
+		void OnHdrPackVerified(HdrVerifier::Pack&);
 
 		struct ISelector {
 			virtual bool IsValid(Peer&)= 0;
@@ -606,6 +1028,7 @@ private:
 		virtual void OnDisconnect(const DisconnectReason&) override;
 		virtual void GenerateSChannelNonce(ECC::Scalar::Native&) override; // Must be overridden to support SChannel
 		void OnTrafic(uint8_t msgCode, uint32_t msgSize, bool bOut) override;
+		void OnMsgTiming(uint8_t msgCode, uint64_t dt_us) override;
 		// login
 		virtual void SetupLogin(proto::Login&) override;
 		virtual void OnLogin(proto::Login&&, uint32_t nFlagsPrev) override;
@@ -624,14 +1047,27 @@ private:
 		virtual void OnMsg(proto::GetBodyPack&&) override;
 		virtual void OnMsg(proto::Body&&) override;
 		virtual void OnMsg(proto::BodyPack&&) override;
+		virtual void OnMsg(proto::GetBodyCompact&&) override;
+		virtual void OnMsg(proto::BodyCompact&&) override;
+		virtual void OnMsg(proto::GetBodyElements&&) override;
+		virtual void OnMsg(proto::BodyElements&&) override;
 		virtual void OnMsg(proto::NewTransaction&&) override;
 		virtual void OnMsg(proto::HaveTransaction&&) override;
+		virtual void OnMsg(proto::HaveTransactions&&) override;
+		using proto::NodeConnection::OnMsg2;
+		virtual bool OnMsg2(proto::Tagged&&) override;
 		virtual void OnMsg(proto::GetTransaction&&) override;
+		virtual void OnMsg(proto::TxSketch&&) override;
 		virtual void OnMsg(proto::GetCommonState&&) override;
 		virtual void OnMsg(proto::GetProofState&&) override;
 		virtual void OnMsg(proto::GetProofKernel&&) override;
 		virtual void OnMsg(proto::GetProofKernel2&&) override;
 		virtual void OnMsg(proto::GetProofUtxo&&) override;
+		virtual void OnMsg(proto::GetProofKernel2Batch&&) override;
+		virtual void OnMsg(proto::GetProofUtxoBatch&&) override;
+		virtual void OnMsg(proto::GetProofUtxoMulti&&) override;
+		void get_ProofKernel2(proto::ProofKernel2&, const Merkle::Hash&, bool bFetch);
+		void get_ProofUtxo(proto::ProofUtxo&, const ECC::Point&, Height hMaturityMin);
 		virtual void OnMsg(proto::GetProofShieldedOutp&&) override;
 		virtual void OnMsg(proto::GetProofShieldedInp&&) override;
 		virtual void OnMsg(proto::GetProofAsset&&) override;
@@ -693,6 +1129,7 @@ private:
 
 		io::Timer::Ptr m_pTimer;
 		void OnTimer();
+		void SendTo(const io::Address&);
 
 		Beacon();
 		~Beacon();
@@ -700,6 +1137,11 @@ private:
 		void Start();
 		uint16_t get_Port();
 
+		static const uint32_t s_ClusterTimeoutPeriods = 20; // member is forgotten if no beacons during this many periods
+		std::map<PeerID, uint32_t> m_mapCluster; // member -> last beacon time
+		bool IsClusterMember(const PeerID&) const;
+		void get_ClusterTag(Merkle::Hash&, const PeerID&) const;
+
 		static void OnClosed(uv_handle_t*);
 		static void OnRcv(uv_udp_t* handle, ssize_t nread, const uv_buf_t* buf, const struct sockaddr* addr, unsigned flags);
 		static void AllocBuf(uv_handle_t* handle, size_t suggested_size, uv_buf_t* buf);
@@ -768,8 +1210,19 @@ private:
 
 		io::Timer::Ptr m_pTimer;
 		bool m_bTimerPending = false;
+		bool m_bEmptyFirst = false; // after a new tip: mine an empty block at once, then switch to the full one
 		uint32_t m_LastRestart_ms;
 		Amount m_FeesTrg = 0;
+
+		// the current block is full. Txs less profitable than its floor won't change it
+		struct Full
+		{
+			Height m_Height = 0; // 0 if n/a
+			TxPool::Stats m_ProfitFloor;
+		} m_Full;
+
+		bool IsFullFor(const TxPool::Profit&) const;
+
 		void OnTimer();
 		void SetTimer(uint32_t timeout_ms, bool bHard);
 
@@ -23,8 +23,10 @@
 #include "../utility/logger.h"
 #include "../utility/logger_checkpoints.h"
 #include "../utility/blobmap.h"
+#include "../utility/metrics.h"
 #include <condition_variable>
 #include <cctype>
+#include <chrono>
 
 namespace beam {
 
@@ -61,6 +63,12 @@ void NodeProcessor::Horizon::SetStdFastSync()
 	m_Local.Lo = r * 180; // 180-day period
 }
 
+void NodeProcessor::Horizon::SetStdPruning(Height hKeep)
+{
+	SetStdFastSync();
+	m_Local.Lo = hKeep; // raised by Normalize() if it's below the sync horizon
+}
+
 void NodeProcessor::Horizon::Normalize()
 {
 	std::setmax(m_Branching, Height(1));
@@ -90,10 +98,31 @@ void NodeProcessor::Initialize(const char* szPath)
 
 void NodeProcessor::Initialize(const char* szPath, const StartParams& sp, ILongAction* pExternalHandler)
 {
-	m_DB.Open(szPath);
+	bool bCheckParallel = sp.m_CheckIntegrity && (sp.m_CheckIntegrityThreads > 1);
+	if (bCheckParallel)
+	{
+		BEAM_LOG_INFO() << "DB integrity check, " << sp.m_CheckIntegrityThreads << " threads...";
+		NodeDB::CheckIntegrityParallel(szPath, sp.m_CheckIntegrityThreads);
+	}
+
+	m_DB.Open(szPath, sp.m_SharedDB);
+	if (sp.m_SharedDB && sp.m_WalManualCheckpoint)
+		m_DB.SetWalManualCheckpoint();
 	m_DbTx.Start(m_DB);
+
+	if (sp.m_ExternalBodies)
+		m_DB.EnableBodyStore();
+
+	m_DB.CacheSetMemMaxSize(NodeDB::CacheCategory::KernelProof, sp.m_MemCacheKernelProofs);
+
+	if (sp.m_DbMmapSize)
+		m_DB.SetMmapSize(sp.m_DbMmapSize);
+
+	m_Mmr.m_States.SetPinFrom(sp.m_MmrPinFrom);
+	m_Mmr.m_Shielded.SetPinFrom(sp.m_MmrPinFrom);
+	m_Mmr.m_Assets.SetPinFrom(sp.m_MmrPinFrom);
 	m_pExternalHandler = pExternalHandler;
-	if (sp.m_CheckIntegrity)
+	if (sp.m_CheckIntegrity && !bCheckParallel)
 	{
 		BEAM_LOG_INFO() << "DB integrity check...";
 		m_DB.CheckIntegrity();
@@ -146,6 +175,29 @@ void NodeProcessor::Initialize(const char* szPath, const StartParams& sp, ILongA
 	m_Mmr.m_States.m_Count = m_Cursor.m_Sid.m_Height - Rules::HeightGenesis;
 	InitCursor(false);
 
+	// everything that may be modified during this session: new blocks and rollbacks
+	Height hDirty = Rules::HeightGenesis;
+	if (m_Cursor.m_ID.m_Height > Rules::get().MaxRollback + Rules::HeightGenesis)
+		hDirty = m_Cursor.m_ID.m_Height - Rules::get().MaxRollback;
+
+	Height hDirtyPrev = m_DB.ParamIntGetDef(NodeDB::ParamID::DirtyFrom);
+	if (hDirtyPrev)
+	{
+		BEAM_LOG_WARNING() << "The previous session wasn't shut down properly";
+		if (sp.m_CheckAfterCrash)
+		{
+			BEAM_LOG_INFO() << "DB recent data check from " << hDirtyPrev << "...";
+			m_DB.CheckIntegrityRecent(hDirtyPrev);
+		}
+		else
+			std::setmin(hDirty, hDirtyPrev); // not checked yet
+	}
+
+	m_DB.ParamIntSet(NodeDB::ParamID::DirtyFrom, hDirty);
+
+	if (sp.m_VerifyHeaders && !VerifyHeaders())
+		OnCorrupted();
+
 	ZeroObject(m_SyncData);
 
 	blob.p = &m_SyncData;
@@ -154,6 +206,9 @@ void NodeProcessor::Initialize(const char* szPath, const StartParams& sp, ILongA
 
 	LogSyncData();
 
+	m_bBulkLoad = sp.m_BulkLoad;
+	UpdateBulkLoad();
+
 	if (Rules::get().TreasuryChecksum == Zero)
 		m_Extra.m_TxosTreasury = 1; // artificial gap
 	else
@@ -162,10 +217,18 @@ void NodeProcessor::Initialize(const char* szPath, const StartParams& sp, ILongA
 	m_Mmr.m_Assets.m_Count = m_DB.ParamIntGetDef(NodeDB::ParamID::AssetsCount);
 	m_Extra.m_ShieldedOutputs = m_DB.ShieldedOutpGet(std::numeric_limits<int64_t>::max());
 	m_Mmr.m_Shielded.m_Count = m_DB.ParamIntGetDef(NodeDB::ParamID::ShieldedInputs);
+
+	m_ValCache.m_Persist = sp.m_PersistValCache;
+	m_ValCache.Load(m_DB);
+	m_ValCache.OnShLo(m_Extra.m_ShieldedOutputs);
 	m_Mmr.m_Shielded.m_Count += m_Extra.m_ShieldedOutputs;
 
-	InitializeMapped(szPath);
+	m_Mapped.set_Hints(sp.m_MappingHints);
+	InitializeMapped(szPath, sp.m_CompactMapping);
+	if (sp.m_MappingReport)
+		LogMappingReport();
 	m_Extra.m_Txos = get_TxosBefore(m_Cursor.m_ID.m_Height + 1);
+	BuildKrnFilter(m_Cursor.m_ID.m_Height);
 
 	bool bRebuildNonStd = false;
 	if ((StartParams::RichInfo::Off | StartParams::RichInfo::On) & sp.m_RichInfoFlags)
@@ -205,6 +268,13 @@ void NodeProcessor::Initialize(const char* szPath, const StartParams& sp, ILongA
 		BEAM_LOG_INFO() << "Old data was just removed from the DB. Some space can be freed by vacuum";
 	}
 
+	if (sp.m_IncrementalVacuum && !m_DB.IsIncrementalVacuum())
+	{
+		m_DB.SetIncrementalVacuum();
+		if (!sp.m_Vacuum)
+			BEAM_LOG_WARNING() << "The DB is not in the incremental vacuum mode, online compaction is disabled. A single vacuum is required to convert it";
+	}
+
 	if (sp.m_Vacuum)
 		Vacuum();
 
@@ -290,24 +360,67 @@ bool NodeProcessor::ManualSelection::IsAllowed(const Merkle::Hash& hv) const
 	return false;
 }
 
-void NodeProcessor::InitializeMapped(const char* sz)
+void NodeProcessor::InitializeMapped(const char* sz, bool bCompact)
 {
+	bool bCompacted = false;
+
 	if (InitMapping(sz, false))
 	{
 		BEAM_LOG_INFO() << "Mapping image found";
 		if (TestDefinition())
-			return; // ok
+		{
+			if (!bCompact || !m_Mapped.IsFragmented())
+				return; // ok
+
+			// much faster than the rebuild from the DB, the outputs aren't read and interpreted
+			BEAM_LOG_INFO() << "Compacting mapped image...";
+
+			std::string sPath;
+			get_MappingPath(sPath, sz);
+			m_Mapped.CompactUtxos(sPath.c_str());
 
-		BEAM_LOG_WARNING() << "Definition mismatch, discarding mapped image";
-		m_Mapped.Close();
-		InitMapping(sz, true);
+			bCompacted = true;
+		}
+		else
+		{
+			BEAM_LOG_WARNING() << "Definition mismatch, discarding mapped image";
+			m_Mapped.Close();
+			InitMapping(sz, true);
+		}
 	}
 
-	InitializeUtxos();
+	if (!bCompacted)
+		InitializeUtxos();
 
 	NodeDB::WalkerContractData wlk;
 	for (m_DB.ContractDataEnum(wlk); wlk.MoveNext(); )
 		m_Mapped.m_Contract.Toggle(wlk.m_Key, wlk.m_Val, true);
+
+	if (bCompacted)
+	{
+		TestDefinitionStrict();
+		BEAM_LOG_INFO() << "Mapped image compacted";
+	}
+}
+
+void NodeProcessor::LogMappingReport()
+{
+	Mapped::Report r;
+	m_Mapped.get_Report(r);
+
+	BEAM_LOG_INFO() << "Mapped image size=" << r.m_SizeFile << ", free=" << r.m_SizeFree << " (" << (r.m_SizeFile ? (r.m_SizeFree * 100 / r.m_SizeFile) : 0) << "%)";
+
+	for (const auto& b : r.m_vBanks)
+		BEAM_LOG_INFO() << "\t" << b.m_szName << ": used=" << (b.m_Total - b.m_Free) << ", free=" << b.m_Free << ", bytes=" << (b.m_Total * b.m_ElementSize);
+
+	struct Tree {
+		static void Log(const char* sz, const Mapped::Report::Tree& t) {
+			BEAM_LOG_INFO() << "\t" << sz << " tree: leafs=" << t.m_Leafs << ", avg depth=" << (t.m_Leafs ? (static_cast<double>(t.m_DepthTotal) / t.m_Leafs) : 0.);
+		}
+	};
+
+	Tree::Log("Utxo", r.m_Utxo);
+	Tree::Log("Contract", r.m_Contract);
 }
 
 void NodeProcessor::TestDefinitionStrict()
@@ -383,6 +496,75 @@ bool NodeProcessor::InitMapping(const char* sz, bool bForceReset)
 	return m_Mapped.Open(sPath.c_str(), us);
 }
 
+const char* NodeProcessor::PerfStats::Stage::get_Name(Enum e)
+{
+	switch (e)
+	{
+#define THE_MACRO(name) case name: return #name;
+		NodePerfStages(THE_MACRO)
+#undef THE_MACRO
+	default: // suppress warning
+		break;
+	}
+
+	return "";
+}
+
+NodeProcessor::PerfStats::Counter::Counter()
+{
+	m_Count = 0;
+	m_Total_us = 0;
+	m_Max_us = 0;
+
+	for (uint32_t i = 0; i < s_Buckets; i++)
+		m_pHist[i] = 0;
+}
+
+void NodeProcessor::PerfStats::Counter::Add(uint64_t dt_us)
+{
+	m_Count.fetch_add(1, std::memory_order_relaxed);
+	m_Total_us.fetch_add(dt_us, std::memory_order_relaxed);
+
+	uint64_t nMax = m_Max_us.load(std::memory_order_relaxed);
+	while ((nMax < dt_us) && !m_Max_us.compare_exchange_weak(nMax, dt_us, std::memory_order_relaxed))
+		;
+
+	uint32_t iBucket = 0;
+	for (uint64_t x = dt_us >> 1; x && (iBucket + 1 < s_Buckets); x >>= 1)
+		iBucket++;
+
+	m_pHist[iBucket].fetch_add(1, std::memory_order_relaxed);
+}
+
+uint64_t NodeProcessor::PerfStats::Counter::get_Quantile_us(uint32_t nPerMille) const
+{
+	uint64_t pHist[s_Buckets];
+	uint64_t nTotal = 0;
+	for (uint32_t i = 0; i < s_Buckets; i++)
+		nTotal += (pHist[i] = m_pHist[i].load(std::memory_order_relaxed));
+
+	if (!nTotal)
+		return 0;
+
+	uint64_t nThreshold = (nTotal * nPerMille + 999) / 1000;
+	uint64_t n = 0;
+
+	for (uint32_t i = 0; i < s_Buckets; i++)
+	{
+		n += pHist[i];
+		if (n >= nThreshold)
+			return static_cast<uint64_t>(2) << i;
+	}
+
+	return m_Max_us.load(std::memory_order_relaxed);
+}
+
+uint64_t NodeProcessor::PerfStats::get_Time_us()
+{
+	using namespace std::chrono;
+	return duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
 void NodeProcessor::LogSyncData()
 {
 	if (!IsFastSync())
@@ -401,6 +583,22 @@ void NodeProcessor::SaveSyncData()
 	}
 	else
 		m_DB.ParamSet(NodeDB::ParamID::SyncData, nullptr, nullptr);
+
+	UpdateBulkLoad();
+}
+
+void NodeProcessor::UpdateBulkLoad()
+{
+	if (m_bBulkLoad && IsFastSync())
+		m_DB.BulkLoadBegin();
+	else
+	{
+		// also if it was left on by the previous run
+		if (m_DB.IsBulkLoad())
+			BEAM_LOG_INFO() << "Rebuilding DB indexes...";
+
+		m_DB.BulkLoadEnd();
+	}
 }
 
 NodeProcessor::Mmr::Mmr(NodeDB& db)
@@ -420,6 +618,8 @@ NodeProcessor::~NodeProcessor()
 	if (m_DbTx.IsInProgress())
 	{
 		try {
+			m_DB.ParamDelSafe(NodeDB::ParamID::DirtyFrom);
+			m_ValCache.Save(m_DB);
 			CommitMappingAndDB();
 		} catch (const CorruptionException& e) {
 			BEAM_LOG_ERROR() << "DB Commit failed: %s" << e.m_sErr;
@@ -444,12 +644,21 @@ void NodeProcessor::CommitMappingAndDB()
 		}
 
 		m_DB.ParamSet(NodeDB::ParamID::MappingStamp, nullptr, &blob);
+
+		PerfStats::Scope scope(m_PerfStats.m_p[PerfStats::Stage::FlushMapping]);
+		m_Mapped.FlushPrepare(us);
 	}
 
-	m_DbTx.Commit();
+	{
+		PerfStats::Scope scope(m_PerfStats.m_p[PerfStats::Stage::CommitDB]);
+		m_DbTx.Commit();
+	}
 
 	if (bFlushMapping)
+	{
+		PerfStats::Scope scope(m_PerfStats.m_p[PerfStats::Stage::FlushMapping]);
 		m_Mapped.FlushStrict(us);
+	}
 }
 
 void NodeProcessor::Vacuum()
@@ -464,6 +673,92 @@ void NodeProcessor::Vacuum()
 	m_DbTx.Start(m_DB);
 }
 
+bool NodeProcessor::CompactStep(uint32_t nBudget_ms)
+{
+	if (!m_DB.IsIncrementalVacuum())
+		return false;
+
+	const uint32_t nPagesPerStep = 256;
+	uint32_t t0_ms = GetTime_ms();
+	uint64_t nFreed = 0;
+
+	while (true)
+	{
+		uint32_t n = m_DB.VacuumStep(nPagesPerStep);
+		nFreed += n;
+
+		if ((n < nPagesPerStep) || (GetTime_ms() - t0_ms >= nBudget_ms))
+			break;
+	}
+
+	m_Compaction.m_PagesRemaining = m_DB.get_FreePages();
+	if (!nFreed)
+		return false;
+
+	uint64_t nBytes = nFreed * m_DB.get_PageSize();
+	m_Compaction.m_PagesFreed += nFreed;
+	m_Compaction.m_BytesFreed += nBytes;
+
+	BEAM_LOG_VERBOSE() << "DB compaction: reclaimed " << (nBytes >> 10) << " KB, total " << (m_Compaction.m_BytesFreed >> 10) << " KB, free pages remaining " << m_Compaction.m_PagesRemaining;
+
+	return true;
+}
+
+void NodeProcessor::ExportSnapshot(const char* szPath)
+{
+	if (m_DbTx.IsInProgress())
+		CommitMappingAndDB();
+
+	BEAM_LOG_INFO() << "Exporting snapshot at " << m_Cursor.m_ID << "...";
+
+	try {
+		m_DB.ExportSnapshot(szPath);
+	} catch (...) {
+		m_DbTx.Start(m_DB);
+		throw;
+	}
+
+	BEAM_LOG_INFO() << "Snapshot exported";
+	m_DbTx.Start(m_DB);
+}
+
+bool NodeProcessor::VerifyHeaders()
+{
+	// The rest of the state is verified vs the tip Definition (TestDefinitionStrict).
+	// Here it's ensured the tip itself belongs to a valid headers chain: PoW, links and chainwork.
+	if (m_Cursor.m_Sid.m_Height < Rules::HeightGenesis)
+		return true;
+
+	LongAction la("Verifying headers...", m_Cursor.m_Sid.m_Height, m_pExternalHandler);
+
+	Block::SystemState::Full s;
+	Merkle::Hash hvPrev = Rules::get().Prehistoric;
+	Difficulty::Raw cwPrev = Zero;
+
+	for (Height h = Rules::HeightGenesis; h <= m_Cursor.m_Sid.m_Height; h++)
+	{
+		m_DB.get_State(FindActiveAtStrict(h), s);
+
+		if ((s.m_Height != h) || (s.m_Prev != hvPrev) || !s.IsValid())
+		{
+			BEAM_LOG_ERROR() << "Header invalid at " << h;
+			return false;
+		}
+
+		cwPrev += s.m_PoW.m_Difficulty;
+		if (cwPrev != s.m_ChainWork)
+		{
+			BEAM_LOG_ERROR() << "Header chainwork mismatch at " << h;
+			return false;
+		}
+
+		s.get_Hash(hvPrev);
+		la.OnProgress(h);
+	}
+
+	return true;
+}
+
 void NodeProcessor::CommitDB()
 {
 	if (m_DbTx.IsInProgress())
@@ -801,6 +1096,12 @@ void NodeProcessor::EnumCongestions()
 			sid.m_Height = x.m_Height - (x.m_Rows.size() - 1);
 			sid.m_Row = x.m_Rows.at(x.m_Rows.size() - 1);
 
+			if (IsFastSync() && (m_SyncRanges.m_Count > 1) && (sid.m_Height <= m_SyncData.m_Target.m_Height))
+			{
+				RequestSyncRanges(x, sid);
+				continue;
+			}
+
 			m_DB.get_StateID(sid, id);
 			RequestDataInternal(id, sid.m_Row, true, sidTrg);
 		}
@@ -819,6 +1120,60 @@ void NodeProcessor::EnumCongestions()
 	}
 }
 
+void NodeProcessor::RequestSyncRanges(CongestionCache::TipCongestion& x, const NodeDB::StateID& sidLo)
+{
+	// The downloaded blocks are saved immediately, hence the DB itself is the checkpoint. After restart (or peer drop) only the missing parts are requested.
+	// Within a range the blocks are received in order, so that its functional part is a prefix.
+	const Height hSize = std::max(m_SyncRanges.m_Size, 1U);
+	const Height hTop = m_SyncData.m_Target.m_Height;
+
+	auto fnIsFunctional = [&](Height h) {
+		return !!(NodeDB::StateFlags::Functional & m_DB.GetStateFlags(x.m_Rows.at(x.m_Height - h)));
+	};
+
+	Height hLo = sidLo.m_Height;
+	for (uint32_t nRanges = 0; (nRanges < m_SyncRanges.m_Count) && (hLo <= hTop); )
+	{
+		Height hHi = hLo - (hLo - Rules::HeightGenesis) % hSize + hSize - 1;
+		std::setmin(hHi, hTop);
+
+		Height hNext = hHi + 1;
+
+		if (!fnIsFunctional(hHi))
+		{
+			if (fnIsFunctional(hLo))
+			{
+				// find the 1st missing block
+				for (Height h1 = hHi; hLo + 1 < h1; )
+				{
+					Height hMid = hLo + (h1 - hLo) / 2;
+					if (fnIsFunctional(hMid))
+						hLo = hMid;
+					else
+						h1 = hMid;
+				}
+				hLo++;
+			}
+
+			NodeDB::StateID sid;
+			sid.m_Height = hLo;
+			sid.m_Row = x.m_Rows.at(x.m_Height - hLo);
+
+			NodeDB::StateID sidTrg;
+			sidTrg.m_Height = hHi;
+			sidTrg.m_Row = x.m_Rows.at(x.m_Height - hHi);
+
+			Block::SystemState::ID id;
+			m_DB.get_StateID(sid, id);
+			RequestDataInternal(id, sid.m_Row, true, sidTrg);
+
+			nRanges++;
+		}
+
+		hLo = hNext;
+	}
+}
+
 const uint64_t* NodeProcessor::get_CachedRows(const NodeDB::StateID& sid, Height nCountExtra)
 {
 	EnumCongestionsInternal();
@@ -894,6 +1249,7 @@ void NodeProcessor::UnreachableLog::Log(const Block::SystemState::ID& id)
 struct NodeProcessor::MultiSigmaContext
 {
 	static const uint32_t s_Chunk = 0x400;
+	static const uint32_t s_RunMax = s_Chunk * 0x80; // max adjacent chunks evaluated at once, bounds memory
 
 	struct Node
 	{
@@ -932,9 +1288,10 @@ private:
 
 	void DeleteRaw(Node&);
 	std::vector<ECC::Point::Native> m_vRes;
+	std::vector<ECC::Scalar::Native> m_vKs; // merged scalars of the current run
 
 	virtual Sigma::CmList& get_List() = 0;
-	virtual void PrepareList(NodeProcessor&, const Node&) = 0;
+	virtual void PrepareList(NodeProcessor&, TxoID id0, uint32_t nCount) = 0; // the list should start at id0
 };
 
 void NodeProcessor::MultiSigmaContext::ClearLocked()
@@ -999,7 +1356,7 @@ struct NodeProcessor::MultiSigmaContext::MyTask
 	:public Executor::TaskSync
 {
 	MultiSigmaContext* m_pThis;
-	const Node* m_pNode;
+	uint32_t m_Count;
 
 	virtual void Exec(Executor::Context& ctx) override
 	{
@@ -1007,10 +1364,10 @@ struct NodeProcessor::MultiSigmaContext::MyTask
 		val = Zero;
 
 		uint32_t i0, nCount;
-		ctx.get_Portion(i0, nCount, m_pNode->m_Max - m_pNode->m_Min);
-		i0 += m_pNode->m_Min;
+		ctx.get_Portion(i0, nCount, m_Count);
 
-		m_pThis->get_List().Calculate(val, i0, nCount, m_pNode->m_pS);
+		if (nCount)
+			m_pThis->get_List().CalculateSeq(val, i0, nCount, &m_pThis->m_vKs.front());
 	}
 };
 
@@ -1019,25 +1376,49 @@ void NodeProcessor::MultiSigmaContext::Calculate(ECC::Point::Native& res, NodePr
 	Executor& ex = np.get_Executor();
 	uint32_t nThreads = ex.get_Threads();
 
+	m_vRes.resize(nThreads);
+
 	while (!m_Set.empty())
 	{
-		Node& n = m_Set.begin()->get_ParentObj();
-		assert(n.m_Min < n.m_Max);
-		assert(n.m_Max <= s_Chunk);
+		// Overlapping windows of different proofs are already merged into the same chunks.
+		// In addition merge adjacent chunks into a single run, and evaluate it by a single multi-exponentiation split among the threads.
+		// Much larger portions per thread than a single chunk, so that the bucket method is used, and less syncs.
+		const Node& n0 = m_Set.begin()->get_ParentObj();
+		TxoID id0 = n0.m_ID.m_Value + n0.m_Min;
+
+		m_vKs.clear();
+
+		while (true)
+		{
+			Node& n = m_Set.begin()->get_ParentObj();
+			assert(n.m_Min < n.m_Max);
+			assert(n.m_Max <= s_Chunk);
 
-		m_vRes.resize(nThreads);
-		PrepareList(np, n);
+			m_vKs.insert(m_vKs.end(), n.m_pS + n.m_Min, n.m_pS + n.m_Max);
+
+			bool bContinue = (s_Chunk == n.m_Max) && (m_vKs.size() < s_RunMax);
+			TxoID idNext = n.m_ID.m_Value + s_Chunk;
+
+			DeleteRaw(n);
+
+			if (!bContinue || m_Set.empty())
+				break;
+
+			const Node& nNext = m_Set.begin()->get_ParentObj();
+			if ((nNext.m_ID.m_Value != idNext) || nNext.m_Min)
+				break;
+		}
 
 		MyTask t;
 		t.m_pThis = this;
-		t.m_pNode = &n;
+		t.m_Count = static_cast<uint32_t>(m_vKs.size());
+
+		PrepareList(np, id0, t.m_Count);
 
 		ex.ExecAll(t);
 
 		for (uint32_t i = 0; i < nThreads; i++)
 			res += m_vRes[i];
-
-		DeleteRaw(n);
 	}
 }
 
@@ -1066,10 +1447,10 @@ private:
 		return m_Lst;
 	}
 
-	virtual void PrepareList(NodeProcessor& np, const Node& n) override
+	virtual void PrepareList(NodeProcessor& np, TxoID id0, uint32_t nCount) override
 	{
-		m_Lst.m_vec.resize(s_Chunk); // will allocate if empty
-		np.get_DB().ShieldedRead(n.m_ID.m_Value + n.m_Min, &m_Lst.m_vec.front() + n.m_Min, n.m_Max - n.m_Min);
+		m_Lst.m_vec.resize(nCount);
+		np.get_DB().ShieldedRead(id0, &m_Lst.m_vec.front(), nCount);
 	}
 
 	struct Walker
@@ -1244,12 +1625,12 @@ private:
 		return m_Lst;
 	}
 
-	virtual void PrepareList(NodeProcessor& np, const Node& n) override
+	virtual void PrepareList(NodeProcessor& np, TxoID id0, uint32_t nCount) override
 	{
-		static_assert(sizeof(n.m_ID.m_Value) >= sizeof(m_Lst.m_Begin));
+		static_assert(sizeof(id0) >= sizeof(m_Lst.m_Begin));
 
 		// TODO: maybe cache it in DB
-		m_Lst.m_Begin = static_cast<Asset::ID>(n.m_ID.m_Value);
+		m_Lst.m_Begin = static_cast<Asset::ID>(id0);
 	}
 };
 
@@ -1334,6 +1715,7 @@ struct NodeProcessor::MultiblockContext
 	size_t m_SizePending = 0;
 	bool m_bFail = false;
 	bool m_bBatchDirty = false;
+	bool m_bBatchFail = false;
 	std::string m_sErr;
 
 	struct MyTask
@@ -1366,6 +1748,7 @@ struct NodeProcessor::MultiblockContext
 			typedef std::shared_ptr<SharedBlock> Ptr;
 
 			Block::Body m_Body;
+			TxVectors::Flat m_Flat; // of m_Body
 			size_t m_Size;
 			TxBase::Context m_Ctx;
 
@@ -1383,6 +1766,74 @@ struct NodeProcessor::MultiblockContext
 		uint32_t m_iVerifier;
 	};
 
+	// Block bodies are read from the DB and deserialized ahead of the one being interpreted,
+	// so that the main thread doesn't stall on them between the blocks.
+	static const uint32_t s_PrefetchDepth = 8;
+
+	struct Prefetched
+	{
+		typedef std::shared_ptr<Prefetched> Ptr;
+
+		uint64_t m_Row;
+		ByteBuffer m_bbP;
+		ByteBuffer m_bbE;
+		MyTask::SharedBlock::Ptr m_pShared;
+		bool m_bDone = false;
+		bool m_bValid = false;
+	};
+
+	struct PrefetchTask
+		:public Executor::TaskAsync
+	{
+		Prefetched::Ptr m_pPf;
+		MultiblockContext* m_pMbc;
+
+		virtual void Exec(Executor::Context&) override;
+		virtual ~PrefetchTask() {}
+	};
+
+	std::deque<Prefetched::Ptr> m_lstPrefetch;
+	std::condition_variable m_cvPrefetch;
+
+	void Prefetch(uint64_t row)
+	{
+		auto pPf = std::make_shared<Prefetched>();
+		pPf->m_Row = row;
+		m_This.m_DB.GetStateBlock(row, &pPf->m_bbP, &pPf->m_bbE, nullptr); // DB access is single-threaded
+		pPf->m_pShared = std::make_shared<MyTask::SharedBlock>(*this);
+
+		m_lstPrefetch.push_back(pPf);
+
+		auto pTask = std::make_unique<PrefetchTask>();
+		pTask->m_pPf = std::move(pPf);
+		pTask->m_pMbc = this;
+		pTask->m_Priority = Executor::Priority::High;
+		m_This.get_Executor().Push(std::move(pTask));
+	}
+
+	bool get_Prefetched(uint64_t row, ByteBuffer& bbP, ByteBuffer& bbE, MyTask::SharedBlock::Ptr& pShared)
+	{
+		if (m_lstPrefetch.empty() || (m_lstPrefetch.front()->m_Row != row))
+			return false;
+
+		Prefetched::Ptr pPf = std::move(m_lstPrefetch.front());
+		m_lstPrefetch.pop_front();
+
+		{
+			std::unique_lock<std::mutex> scope(m_Mutex);
+			while (!pPf->m_bDone)
+				m_cvPrefetch.wait(scope);
+		}
+
+		if (!pPf->m_bValid)
+			return false;
+
+		bbP.swap(pPf->m_bbP);
+		bbE.swap(pPf->m_bbE);
+		pShared = std::move(pPf->m_pShared);
+		return true;
+	}
+
 	bool Flush()
 	{
 		FlushInternal();
@@ -1437,6 +1888,7 @@ struct NodeProcessor::MultiblockContext
 			{
 				m_sErr = "Sigma nnz";
 				m_bFail = true;
+				m_bBatchFail = true;
 				return;
 			}
 		}
@@ -1498,11 +1950,14 @@ struct NodeProcessor::MultiblockContext
 		if (m_bFail)
 			return;
 
+		uint32_t nWindow = m_This.m_BatchVerify.get_Window(pShared->m_Ctx.m_Height.m_Min);
+
 		bool bMustFlush =
 			!m_InProgress.IsEmpty() &&
 			(
 				(m_pidLast != pid) || // PeerID changed
-				(m_InProgress.m_Max == m_This.m_SyncData.m_TxoLo) // range complete up to TxLo
+				(m_InProgress.m_Max == m_This.m_SyncData.m_TxoLo) || // range complete up to TxLo
+				(nWindow && (m_InProgress.m_Max - m_InProgress.m_Min + 1 >= nWindow)) // batch window is full
 			);
 
 		if (bMustFlush && !Flush())
@@ -1540,11 +1995,12 @@ struct NodeProcessor::MultiblockContext
 		pShared->m_Ctx.m_Params.m_nVerifiers = ex.get_Threads();
 
 		m_Msc.Prepare(pShared->m_Body, m_This, pShared->m_Ctx.m_Height.m_Min);
+		pShared->m_Flat.Build(pShared->m_Body);
 
-		PushTasks(pShared, pShared->m_Ctx.m_Params);
+		PushTasks(pShared, pShared->m_Ctx.m_Params, Executor::Priority::High);
 	}
 
-	void PushTasks(const MyTask::Shared::Ptr& pShared, TxBase::Context::Params& pars)
+	void PushTasks(const MyTask::Shared::Ptr& pShared, TxBase::Context::Params& pars, uint8_t nPriority = Executor::Priority::Low)
 	{
 		Executor& ex = m_This.get_Executor();
 		m_bBatchDirty = true;
@@ -1557,6 +2013,8 @@ struct NodeProcessor::MultiblockContext
 			auto pTask = std::make_unique<MyTask>();
 			pTask->m_pShared = pShared;
 			pTask->m_iVerifier = i;
+			pTask->m_Priority = nPriority;
+			pTask->m_iThread = i; // spread evenly, idle threads would steal anyway
 			ex.Push(std::move(pTask));
 		}
 	}
@@ -1596,6 +2054,33 @@ struct NodeProcessor::MultiblockContext
 	}
 };
 
+void NodeProcessor::MultiblockContext::PrefetchTask::Exec(Executor::Context&)
+{
+	Prefetched& pf = *m_pPf;
+	Block::Body& block = pf.m_pShared->m_Body;
+
+	bool bValid = true;
+	try {
+		ObjectArena::Scope scopeArena(pf.m_bbP.size() + pf.m_bbE.size()); // the whole body in few chunks, freed with it
+
+		Deserializer der;
+		der.reset(pf.m_bbP);
+		der & Cast::Down<Block::BodyBase>(block);
+		der & Cast::Down<TxVectors::Perishable>(block);
+
+		der.reset(pf.m_bbE);
+		der & Cast::Down<TxVectors::Eternal>(block);
+	}
+	catch (const std::exception&) {
+		bValid = false;
+	}
+
+	std::unique_lock<std::mutex> scope(m_pMbc->m_Mutex);
+	pf.m_bValid = bValid;
+	pf.m_bDone = true;
+	m_pMbc->m_cvPrefetch.notify_all();
+}
+
 void NodeProcessor::MultiblockContext::MyTask::Exec(Executor::Context&)
 {
 	MultiAssetContext::BatchCtx bcAssets(m_pShared->m_Mbc.m_Mac);
@@ -1606,6 +2091,8 @@ void NodeProcessor::MultiblockContext::MyTask::Exec(Executor::Context&)
 
 void NodeProcessor::MultiblockContext::MyTask::SharedBlock::Exec(uint32_t iVerifier)
 {
+	PerfStats::Scope scopePerf(m_Mbc.m_This.m_PerfStats.m_p[PerfStats::Stage::Verify]);
+
 	TxBase::Context ctx;
 	ctx.m_Params = m_Ctx.m_Params;
 	ctx.m_Height = m_Ctx.m_Height;
@@ -1621,7 +2108,7 @@ void NodeProcessor::MultiblockContext::MyTask::SharedBlock::Exec(uint32_t iVerif
 	std::string sErr;
 
 	try {
-		ctx.ValidateAndSummarizeStrict(bSparse ? txbDummy : m_Body, m_Body.get_Reader());
+		ctx.ValidateAndSummarizeStrict(bSparse ? txbDummy : m_Body, m_Flat);
 
 		if (!m_Mbc.m_Msc.IsValid(m_Body, m_Ctx.m_Height.m_Min, *ECC::InnerProduct::BatchContext::s_pInstance, iVerifier, m_Ctx.m_Params.m_nVerifiers, m_Mbc.m_This.m_ValCache))
 		{
@@ -1722,6 +2209,14 @@ void NodeProcessor::TryGoUp()
 	}
 }
 
+uint32_t NodeProcessor::BatchVerify::get_Window(Height h) const
+{
+	if (m_Window && (h <= m_hWindowEnd))
+		return m_MaxBlocks ? std::min(m_Window, m_MaxBlocks) : m_Window;
+
+	return m_MaxBlocks;
+}
+
 void NodeProcessor::TryGoTo(NodeDB::StateID& sidTrg)
 {
 	// Calculate the path
@@ -1748,11 +2243,16 @@ void NodeProcessor::TryGoTo(NodeDB::StateID& sidTrg)
 	NodeDB::StateID sidFwd = m_Cursor.m_Sid;
 
 	size_t iPos = vPath.size();
+	size_t iPrefetch = iPos;
 	while (iPos)
 	{
 		sidFwd.m_Height = m_Cursor.m_Sid.m_Height + 1;
 		sidFwd.m_Row = vPath[--iPos];
 
+		// keep the lookahead filled, the upcoming blocks are deserialized while this one is interpreted
+		while (iPrefetch && (mbc.m_lstPrefetch.size() < MultiblockContext::s_PrefetchDepth))
+			mbc.Prefetch(vPath[--iPrefetch]);
+
 		Block::SystemState::Full s;
 		m_DB.get_State(sidFwd.m_Row, s); // need it for logging anyway
 
@@ -1804,6 +2304,20 @@ void NodeProcessor::TryGoTo(NodeDB::StateID& sidTrg)
 	if (bKeepBlocks)
 		return;
 
+	if (mbc.m_bBatchFail)
+	{
+		Height nBlocks = mbc.m_InProgress.m_Max - mbc.m_InProgress.m_Min + 1;
+		if (nBlocks > 1)
+		{
+			// can't tell which block is invalid. Keep them, and re-verify the range in smaller batches
+			m_BatchVerify.m_Window = static_cast<uint32_t>(nBlocks / 2);
+			m_BatchVerify.m_hWindowEnd = mbc.m_InProgress.m_Max;
+
+			BEAM_LOG_INFO() << "Batch of " << nBlocks << " blocks failed, retrying with window=" << m_BatchVerify.m_Window;
+			return;
+		}
+	}
+
 	if (!(mbc.m_pidLast == Zero))
 	{
 		OnPeerInsane(mbc.m_pidLast);
@@ -2123,6 +2637,22 @@ Height NodeProcessor::RaiseTxoHi(Height hTrg)
 	return hRet;
 }
 
+void NodeProcessor::TxoAdd(NodeDB::TxoAdder& ta, TxoID id, const Blob& v)
+{
+	if (TxoIsNaked(v))
+	{
+		ta.Add(id, v, nullptr);
+		return;
+	}
+
+	// keep the naked part in the Txo table, so that it remains compact. The full value is dropped once the Txo is spent below TxoHi
+	uint8_t pNaked[s_TxoNakedMax];
+	Blob vNaked = v;
+	TxoToNaked(pNaked, vNaked);
+
+	ta.Add(id, vNaked, &v);
+}
+
 void NodeProcessor::TxoToNaked(uint8_t* pBuf, Blob& v)
 {
 	if (v.n < s_TxoNakedMin)
@@ -2219,6 +2749,7 @@ bool NodeProcessor::Evaluator::get_History(Merkle::Hash& hv)
 
 bool NodeProcessor::Evaluator::get_Utxos(Merkle::Hash& hv)
 {
+	Executor::Scope scope(m_Proc.get_Executor()); // large dirty levels are rehashed in parallel
 	m_Proc.m_Mapped.m_Utxo.get_Hash(hv);
 	return true;
 }
@@ -2260,6 +2791,7 @@ bool NodeProcessor::Evaluator::get_Assets(Merkle::Hash& hv)
 
 bool NodeProcessor::Evaluator::get_Contracts(Merkle::Hash& hv)
 {
+	Executor::Scope scope(m_Proc.get_Executor()); // large dirty levels are rehashed in parallel
 	m_Proc.m_Mapped.m_Contract.get_Hash(hv);
 	return true;
 }
@@ -2302,11 +2834,14 @@ uint64_t NodeProcessor::ProcessKrnMmr(Merkle::Mmr& mmr, std::vector<TxKernel::Pt
 {
 	uint64_t iRet = uint64_t (-1);
 
+	std::vector<Merkle::Hash> vIDs;
+	vIDs.reserve(vKrn.size());
+
 	for (size_t i = 0; i < vKrn.size(); i++)
 	{
 		TxKernel::Ptr& p = vKrn[i];
 		const Merkle::Hash& hv = p->m_Internal.m_ID;
-		mmr.Append(hv);
+		vIDs.push_back(hv);
 
 		if (hv == idKrn)
 		{
@@ -2316,6 +2851,9 @@ uint64_t NodeProcessor::ProcessKrnMmr(Merkle::Mmr& mmr, std::vector<TxKernel::Pt
 		}
 	}
 
+	if (!vIDs.empty())
+		mmr.Append(&vIDs.front(), vIDs.size());
+
 	return iRet;
 }
 
@@ -2401,7 +2939,7 @@ Height NodeProcessor::get_ProofKernel(Merkle::Proof& proof, TxKernel::Ptr* ppRes
 
 bool NodeProcessor::get_ProofContractLog(Merkle::Proof& proof, const HeightPos& pos)
 {
-	Merkle::FixedMmr lmmr;
+	std::vector<Merkle::Hash> vHashes;
 	uint64_t iTrg = static_cast<uint64_t>(-1);
 
 	{
@@ -2412,19 +2950,18 @@ bool NodeProcessor::get_ProofContractLog(Merkle::Proof& proof, const HeightPos&
 				continue;
 
 			if (pos.m_Pos == wlk.m_Entry.m_Pos.m_Pos)
-				iTrg = lmmr.m_Count; // found!
+				iTrg = vHashes.size(); // found!
 
-			Merkle::Hash hv;
-			Block::get_HashContractLog(hv, wlk.m_Entry.m_Key, wlk.m_Entry.m_Val, wlk.m_Entry.m_Pos.m_Pos);
-
-			lmmr.Resize(lmmr.m_Count + 1);
-			lmmr.Append(hv);
+			Block::get_HashContractLog(vHashes.emplace_back(), wlk.m_Entry.m_Key, wlk.m_Entry.m_Val, wlk.m_Entry.m_Pos.m_Pos);
 		}
 	}
 
-	if (lmmr.m_Count <= iTrg)
+	if (vHashes.size() <= iTrg)
 		return false;
 
+	Merkle::FixedMmr lmmr(vHashes.size());
+	lmmr.Append(&vHashes.front(), vHashes.size());
+
 	lmmr.get_Proof(proof, iTrg);
 
 	NodeDB::StateID sid;
@@ -2538,11 +3075,7 @@ struct NodeProcessor::BlockInterpretCtx
 			static const Type Recharge = 8;
 		};
 
-		void ContractDataInsert(const Blob& key, const Blob&);
-		void ContractDataUpdate(const Blob& key, const Blob& val, const Blob& valOld);
-		void ContractDataDel(const Blob& key, const Blob& valOld);
-
-		void ContractDataToggleTree(const Blob& key, const Blob&, bool bAdd);
+		void ContractDataModify(BlobMap::Entry&, ByteBuffer& data); // swaps the cached value, the committed one is written back after the kernel
 
 		void ContractDataSaveWithRecovery(BlobMap::Entry&, const Blob&);
 
@@ -2627,6 +3160,36 @@ struct NodeProcessor::BlockInterpretCtx
 	BlobMap::Set m_ContractVars;
 	BlobMap::Entry& get_ContractVar(const Blob& key, NodeDB& db);
 
+	// Vars modified by the current kernel, with their committed values (in the DB and the contracts tree).
+	// Written back once the kernel is handled, repeated writes to the same var (and the undo of the failed invocations) are coalesced
+	BlobMap::Set m_ContractVarsOrig;
+	void FlushContractVars(NodeProcessor&);
+	void ContractDataToggleTree(NodeProcessor&, const Blob& key, const Blob&, bool bAdd);
+
+	// Read/write sets of the contract kernels, at var granularity. Each kernel is assigned the earliest 'wave' after all the kernels it conflicts with.
+	// Range lookups may depend on the absent vars, such a kernel is a barrier.
+	struct ContractAccess
+	{
+		struct Var {
+			uint32_t m_WaveR = 0;
+			uint32_t m_WaveW = 0;
+		};
+
+		std::map<ByteBuffer, Var> m_Vars;
+		std::set<ByteBuffer> m_Read, m_Write; // of the current kernel
+		bool m_Range = false;
+
+		uint32_t m_Kernels = 0;
+		uint32_t m_Waves = 0;
+		uint32_t m_WaveBarrier = 0;
+
+		void OnRead(const Blob&);
+		void OnWrite(const Blob&);
+		void OnKernel();
+	};
+
+	ContractAccess* m_pAccess = nullptr;
+
 	std::vector<ContractInvokeExtraInfo>* m_pvC = nullptr;
 
 	BlockInterpretCtx(Height h, bool bFwd)
@@ -2767,6 +3330,7 @@ bool NodeProcessor::HandleTreasury(const Blob& blob)
 
 	Serializer ser;
 	TxoID id0 = 0;
+	NodeDB::TxoAdder ta(m_DB);
 
 	for (size_t iG = 0; iG < td.m_vGroups.size(); iG++)
 	{
@@ -2776,10 +3340,12 @@ bool NodeProcessor::HandleTreasury(const Blob& blob)
 			ser & *td.m_vGroups[iG].m_Data.m_vOutputs[i];
 
 			SerializeBuffer sb = ser.buffer();
-			m_DB.TxoAdd(id0, Blob(sb.first, static_cast<uint32_t>(sb.second)));
+			TxoAdd(ta, id0, Blob(sb.first, static_cast<uint32_t>(sb.second)));
 		}
 	}
 
+	ta.Flush();
+
 	return true;
 }
 
@@ -2848,6 +3414,7 @@ struct NodeProcessor::MyRecognizer
 		void InsertEvent(const HeightPos& pos, const Blob& b, const Blob& key) override
 		{
 			m_Proc.m_DB.InsertEvent(m_pAccount->m_iAccount, pos, b, key);
+			Cast::NotConst(*m_pAccount).m_nEvents++;
 		}
 
 		bool FindEvents(const Blob& key, Recognizer::IEventHandler& h) override
@@ -2898,6 +3465,8 @@ std::string NodeProcessor::Account::get_Endpoint() const
 
 bool NodeProcessor::HandleBlock(const NodeDB::StateID& sid, const Block::SystemState::Full& s, MultiblockContext& mbc)
 {
+	BEAM_METRICS_SCOPE("NodeProcessor.HandleBlock");
+
 	if (s.m_Height == m_ManualSelection.m_Sid.m_Height)
 	{
 		Merkle::Hash hv;
@@ -2908,25 +3477,36 @@ bool NodeProcessor::HandleBlock(const NodeDB::StateID& sid, const Block::SystemS
 	}
 
 	ByteBuffer bbP, bbE;
-	m_DB.GetStateBlock(sid.m_Row, &bbP, &bbE, nullptr);
+	MultiblockContext::MyTask::SharedBlock::Ptr pShared;
 
-	MultiblockContext::MyTask::SharedBlock::Ptr pShared = std::make_shared<MultiblockContext::MyTask::SharedBlock>(mbc);
-	Block::Body& block = pShared->m_Body;
+	if (!mbc.get_Prefetched(sid.m_Row, bbP, bbE, pShared))
+	{
+		bbP.clear();
+		bbE.clear();
+		m_DB.GetStateBlock(sid.m_Row, &bbP, &bbE, nullptr);
 
-	try {
-		Deserializer der;
-		der.reset(bbP);
-		der & Cast::Down<Block::BodyBase>(block);
-		der & Cast::Down<TxVectors::Perishable>(block);
+		pShared = std::make_shared<MultiblockContext::MyTask::SharedBlock>(mbc);
+		Block::Body& block = pShared->m_Body;
 
-		der.reset(bbE);
-		der & Cast::Down<TxVectors::Eternal>(block);
-	}
-	catch (const std::exception&) {
-		BEAM_LOG_WARNING() << LogSid(m_DB, sid) << " Block deserialization failed";
-		return false;
+		try {
+			ObjectArena::Scope scopeArena(bbP.size() + bbE.size());
+
+			Deserializer der;
+			der.reset(bbP);
+			der & Cast::Down<Block::BodyBase>(block);
+			der & Cast::Down<TxVectors::Perishable>(block);
+
+			der.reset(bbE);
+			der & Cast::Down<TxVectors::Eternal>(block);
+		}
+		catch (const std::exception&) {
+			BEAM_LOG_WARNING() << LogSid(m_DB, sid) << " Block deserialization failed";
+			return false;
+		}
 	}
 
+	Block::Body& block = pShared->m_Body;
+
 	bool bFirstTime = (m_DB.get_StateTxos(sid.m_Row) == MaxHeight);
 	if (bFirstTime)
 	{
@@ -2979,7 +3559,16 @@ bool NodeProcessor::HandleBlock(const NodeDB::StateID& sid, const Block::SystemS
 	if (m_DB.ParamIntGetDef(NodeDB::ParamID::RichContractInfo))
 		bic.m_pvC = &vC;
 
-	bool bOk = HandleValidatedBlock(block, bic);
+	BlockInterpretCtx::ContractAccess ca;
+	bic.m_pAccess = &ca;
+
+	bool bOk;
+	{
+		PerfStats::Scope scopePerf(m_PerfStats.m_p[PerfStats::Stage::HandleBlock]);
+		bOk = HandleValidatedBlock(block, bic);
+	}
+	bic.m_pAccess = nullptr;
+
 	if (!bOk)
 	{
 		assert(bFirstTime);
@@ -3021,6 +3610,7 @@ bool NodeProcessor::HandleBlock(const NodeDB::StateID& sid, const Block::SystemS
 		{
 			if (bPastFastSync)
 			{
+				Executor::Scope scope(get_Executor());
 				get_Utxos().get_Hash(hvDef);
 				if (s.m_Kernels != hvDef)
 				{
@@ -3061,6 +3651,13 @@ bool NodeProcessor::HandleBlock(const NodeDB::StateID& sid, const Block::SystemS
 
 	if (bOk)
 	{
+		if (ca.m_Kernels)
+		{
+			m_PerfStats.m_Contracts.m_Blocks++;
+			m_PerfStats.m_Contracts.m_Kernels += ca.m_Kernels;
+			m_PerfStats.m_Contracts.m_Waves += ca.m_Waves;
+		}
+
 		m_Cursor.m_hvKernels = ev.m_hvKernels;
 		m_Cursor.m_bKernels = true;
 
@@ -3094,31 +3691,43 @@ bool NodeProcessor::HandleBlock(const NodeDB::StateID& sid, const Block::SystemS
 
 		std::vector<NodeDB::StateInput> v;
 		v.reserve(block.m_vInputs.size());
+		std::vector<TxoID> vSpent;
+		vSpent.reserve(block.m_vInputs.size());
 
 		for (size_t i = 0; i < block.m_vInputs.size(); i++)
 		{
 			const Input& x = *block.m_vInputs[i];
-			m_DB.TxoSetSpent(x.m_Internal.m_ID, sid.m_Height);
+			vSpent.push_back(x.m_Internal.m_ID);
 			v.emplace_back().Set(x.m_Internal.m_ID, x.m_Commitment);
 		}
 
 		if (!v.empty())
+		{
+			m_DB.TxoSetSpent(&vSpent.front(), vSpent.size(), sid.m_Height);
 			m_DB.set_StateInputs(sid.m_Row, &v.front(), v.size());
+		}
 
 		// recognize all
 		MyRecognizer rec(*this);
 
-		for (const auto& acc : m_vAccounts)
+		if (!m_vAccounts.empty())
 		{
-			rec.m_Handler.m_pAccount = &acc;
-			rec.m_Recognizer.m_Pos = sid.m_Height;
-			rec.m_Recognizer.RecognizeBlock(block, bic.m_ShieldedOuts);
+			Executor::Scope scope(get_Executor()); // shielded outputs are recognized in parallel
+
+			for (const auto& acc : m_vAccounts)
+			{
+				rec.m_Handler.m_pAccount = &acc;
+				rec.m_Recognizer.m_Pos = sid.m_Height;
+				rec.m_Recognizer.RecognizeBlock(block, bic.m_ShieldedOuts);
+			}
 		}
 
 		Serializer ser;
 		bic.m_Rollback.clear();
 		ser.swap_buf(bic.m_Rollback); // optimization
 
+		NodeDB::TxoAdder ta(m_DB);
+
 		for (size_t i = 0; i < block.m_vOutputs.size(); i++)
 		{
 			const Output& x = *block.m_vOutputs[i];
@@ -3127,9 +3736,11 @@ bool NodeProcessor::HandleBlock(const NodeDB::StateID& sid, const Block::SystemS
 			ser & x;
 
 			SerializeBuffer sb = ser.buffer();
-			m_DB.TxoAdd(id0++, Blob(sb.first, static_cast<uint32_t>(sb.second)));
+			TxoAdd(ta, id0++, Blob(sb.first, static_cast<uint32_t>(sb.second)));
 		}
 
+		ta.Flush();
+
 		m_RecentStates.Push(sid.m_Row, s);
 
 		cf.Do(*this, sid.m_Height);
@@ -3224,6 +3835,72 @@ NodeProcessor::Recognizer::Recognizer(IHandler& h, Extra& extra)
 
 }
 
+struct NodeProcessor::Recognizer::ShieldedOutsBatch
+{
+	struct Entry
+	{
+		const TxKernelShieldedOutput* m_pKrn;
+		ShieldedTxo::Data::Params m_Pars;
+		Key::Index m_nIdx;
+		Height m_Height;
+		bool m_Recognized;
+	};
+
+	std::vector<Entry> m_vEntries;
+	size_t m_iNext = 0;
+
+	void Collect(const std::vector<TxKernel::Ptr>& vKrn, Height h)
+	{
+		struct MyWalker
+			:public KrnWalkerShielded
+		{
+			std::vector<Entry>& m_vEntries;
+			Height m_h;
+			MyWalker(std::vector<Entry>& v, Height h) :m_vEntries(v), m_h(h) {}
+
+			virtual bool OnKrnEx(const TxKernelShieldedOutput& krn) override
+			{
+				Entry& x = m_vEntries.emplace_back();
+				x.m_pKrn = &krn;
+				x.m_Height = m_h;
+				return true;
+			}
+		} wlk(m_vEntries, h);
+
+		wlk.Process(vKrn);
+	}
+
+	void Recognize(Executor& ex, const Account& acc)
+	{
+		// outputs are independent, the account is only read
+		struct MyTask
+			:public Executor::TaskSync
+		{
+			const Account* m_pAcc;
+			Entry* m_pEntries;
+			uint32_t m_Count;
+
+			virtual void Exec(Executor::Context& ctx) override
+			{
+				uint32_t i0, nPortion;
+				ctx.get_Portion(i0, nPortion, m_Count);
+
+				for (uint32_t i = i0; i < i0 + nPortion; i++)
+				{
+					Entry& x = m_pEntries[i];
+					x.m_Recognized = RecognizeShieldedOut(*m_pAcc, *x.m_pKrn, x.m_Height, x.m_Pars, x.m_nIdx);
+				}
+			}
+		} t;
+
+		t.m_pAcc = &acc;
+		t.m_pEntries = &m_vEntries.front();
+		t.m_Count = static_cast<uint32_t>(m_vEntries.size());
+
+		ex.ExecAll(t);
+	}
+};
+
 void NodeProcessor::Recognizer::RecognizeBlock(const TxVectors::Full& block, uint32_t shieldedOuts, bool validateShieldedOuts)
 {
 	assert(m_Handler.m_pAccount);
@@ -3244,7 +3921,20 @@ void NodeProcessor::Recognizer::RecognizeBlock(const TxVectors::Full& block, uin
 		TxoID nOuts = m_Extra.m_ShieldedOutputs;
 		m_Extra.m_ShieldedOutputs -= shieldedOuts;
 
+		ShieldedOutsBatch sob;
+		Executor* pEx = Executor::s_pInstance;
+		if (pEx && (pEx->get_Threads() > 1) && (shieldedOuts > 1))
+		{
+			sob.Collect(block.m_vKernels, m_Pos.m_Height);
+			if (sob.m_vEntries.size() > 1)
+			{
+				sob.Recognize(*pEx, acc);
+				m_pShieldedOuts = &sob;
+			}
+		}
+
 		wlkKrn.Process(block.m_vKernels);
+		m_pShieldedOuts = nullptr;
 		if (validateShieldedOuts)
 		{
 			assert(m_Extra.m_ShieldedOutputs == nOuts);
@@ -3341,32 +4031,59 @@ void NodeProcessor::Recognizer::Recognize(const TxKernelShieldedOutput& v, uint3
 	assert(m_Handler.m_pAccount);
 	const auto& acc = *m_Handler.m_pAccount;
 
-	for (Key::Index nIdx = 0; nIdx < acc.m_vSh.size(); nIdx++)
+	ShieldedTxo::Data::Params parsLocal;
+	const ShieldedTxo::Data::Params* pPars = &parsLocal;
+	Key::Index nIdx = 0;
+
+	if (m_pShieldedOuts)
+	{
+		assert(m_pShieldedOuts->m_iNext < m_pShieldedOuts->m_vEntries.size());
+		const auto& x = m_pShieldedOuts->m_vEntries[m_pShieldedOuts->m_iNext++];
+		assert(x.m_pKrn == &v);
+
+		if (!x.m_Recognized)
+			return;
+
+		pPars = &x.m_Pars;
+		nIdx = x.m_nIdx;
+	}
+	else
 	{
-		const ShieldedTxo& txo = v.m_Txo;
+		if (!RecognizeShieldedOut(acc, v, m_Pos.m_Height, parsLocal, nIdx))
+			return;
+	}
 
-		ShieldedTxo::Data::Params pars;
+	const auto& pars = *pPars;
+
+	proto::Event::Shielded evt;
+	evt.m_TxoID = nID;
+	pars.ToID(evt.m_CoinID);
+	evt.m_CoinID.m_Key.m_nIdx = nIdx;
+	evt.m_Flags = proto::Event::Flags::Add;
+
+	EventKey::Shielded key = pars.m_Ticket.m_SpendPk;
+	key.m_Y |= EventKey::s_FlagShielded;
+
+	AddEvent(evt, key);
+}
+
+bool NodeProcessor::Recognizer::RecognizeShieldedOut(const Account& acc, const TxKernelShieldedOutput& v, Height h, ShieldedTxo::Data::Params& pars, Key::Index& nIdx)
+{
+	const ShieldedTxo& txo = v.m_Txo;
+
+	for (nIdx = 0; nIdx < acc.m_vSh.size(); nIdx++)
+	{
 		if (!pars.m_Ticket.Recover(txo.m_Ticket, acc.m_vSh[nIdx]))
 			continue;
 
 		ECC::Oracle oracle;
 		oracle << v.m_Msg;
 
-		if (!pars.m_Output.Recover(txo, pars.m_Ticket.m_SharedSecret, m_Pos.m_Height, oracle))
-			continue;
-
-		proto::Event::Shielded evt;
-		evt.m_TxoID = nID;
-		pars.ToID(evt.m_CoinID);
-		evt.m_CoinID.m_Key.m_nIdx = nIdx;
-		evt.m_Flags = proto::Event::Flags::Add;
-
-		EventKey::Shielded key = pars.m_Ticket.m_SpendPk;
-		key.m_Y |= EventKey::s_FlagShielded;
-
-		AddEvent(evt, key);
-		break;
+		if (pars.m_Output.Recover(txo, pars.m_Ticket.m_SharedSecret, h, oracle))
+			return true;
 	}
+
+	return false;
 }
 
 void NodeProcessor::Recognizer::Recognize(const Output& x, Key::IPKdf& keyViewer)
@@ -3607,80 +4324,170 @@ void NodeProcessor::RescanAccounts(uint32_t nRecent)
 	assert(nRecent <= m_vAccounts.size());
 
 	MyRecognizer rec(*this);
+	Executor& ex = get_Executor();
+
+	// Txos and kernels are collected in batches that span many heights, recognized in parallel,
+	// and then the events are added in the original order.
+	const uint32_t nBatch = 0x400;
 
 	struct TxoRecover
-		:public ITxoRecover
+		:public ITxoWalker
 	{
+		struct Match
+		{
+			uint32_t m_iAcc;
+			CoinID m_Cid;
+			Output::User m_User;
+		};
+
+		struct Item
+		{
+			ByteBuffer m_Value;
+			Height m_hCreate;
+			Height m_hSpend;
+			ECC::Point m_Commitment;
+			Height m_Maturity;
+			std::vector<Match> m_vMatches;
+		};
+
 		MyRecognizer& m_Rec;
+		Executor& m_Ex;
 		uint32_t m_Total = 0;
 		uint32_t m_Unspent = 0;
 
 		const Account* m_pAcc;
 		uint32_t m_nAcc;
 
-		TxoRecover(MyRecognizer& rec)
+		std::vector<Item> m_vItems;
+		uint32_t m_nItems = 0; // the rest are kept to reuse their buffers
+		uint32_t m_nBatch;
+
+		TxoRecover(MyRecognizer& rec, Executor& ex)
 			:m_Rec(rec)
+			,m_Ex(ex)
 		{
 		}
 
-		bool OnTxo(const NodeDB::WalkerTxo& wlk, Height hCreate, Output& outp) override
+		bool OnTxo(const NodeDB::WalkerTxo& wlk, Height hCreate) override
 		{
-			for (uint32_t iAcc = 0; iAcc < m_nAcc; iAcc++)
-			{
-				m_Rec.m_Handler.m_pAccount = m_pAcc + iAcc;
-				m_pKey = m_Rec.m_Handler.m_pAccount->m_pOwner.get();
+			if (TxoIsNaked(wlk.m_Value))
+				return true;
 
-				if (!ITxoRecover::OnTxo(wlk, hCreate, outp))
-					return false;
-			}
+			if (m_vItems.size() == m_nItems)
+				m_vItems.emplace_back();
+
+			Item& x = m_vItems[m_nItems++];
+			wlk.m_Value.Export(x.m_Value);
+			x.m_hCreate = hCreate;
+			x.m_hSpend = wlk.m_SpendHeight;
+
+			if (m_nItems == m_nBatch)
+				Flush();
 
 			return true;
 		}
 
-		bool OnTxo(const NodeDB::WalkerTxo& wlk, Height hCreate, Output& outp, const CoinID& cid, const Output::User& user) override
+		void Recover(Item& x, Output& outp) const
 		{
-			if (cid.IsDummy())
+			x.m_vMatches.clear();
+
+			Deserializer der;
+			der.reset(x.m_Value.data(), x.m_Value.size());
+			der & outp;
+
+			for (uint32_t iAcc = 0; iAcc < m_nAcc; iAcc++)
 			{
-				m_Rec.m_Handler.m_Proc.OnDummy(cid, hCreate);
-				return true;
+				Match m;
+				if (outp.Recover(x.m_hCreate, *m_pAcc[iAcc].m_pOwner, m.m_Cid, &m.m_User))
+				{
+					m.m_iAcc = iAcc;
+					x.m_vMatches.push_back(std::move(m));
+				}
 			}
 
-			proto::Event::Utxo evt;
-			evt.m_Flags = proto::Event::Flags::Add;
-			evt.m_Cid = cid;
-			evt.m_Commitment = outp.m_Commitment;
-			evt.m_Maturity = outp.get_MinMaturity(hCreate);
-			evt.m_User = user;
+			if (!x.m_vMatches.empty())
+			{
+				x.m_Commitment = outp.m_Commitment;
+				x.m_Maturity = outp.get_MinMaturity(x.m_hCreate);
+			}
+		}
 
-			m_Rec.m_Recognizer.m_Pos.m_Height = hCreate;
-			// don't reset the Pos.Index. Its value is not important, it only should be monotonic
-			const EventKey::Utxo& key = outp.m_Commitment;
-			m_Rec.m_Recognizer.AddEvent(evt, key);
+		void Flush()
+		{
+			struct Task
+				:public Executor::TaskSync
+			{
+				TxoRecover* m_pThis;
 
-			m_Total++;
+				virtual void Exec(Executor::Context& ctx) override
+				{
+					uint32_t i0, nCount;
+					ctx.get_Portion(i0, nCount, m_pThis->m_nItems);
 
-			if (MaxHeight == wlk.m_SpendHeight)
-				m_Unspent++;
-			else
+					Output outp; // reused across txos of this thread
+					for (; nCount--; i0++)
+						m_pThis->Recover(m_pThis->m_vItems[i0], outp);
+				}
+			} t;
+
+			t.m_pThis = this;
+			m_Ex.ExecAll(t);
+
+			for (uint32_t i = 0; i < m_nItems; i++)
+				OnRecovered(m_vItems[i]);
+
+			m_nItems = 0;
+		}
+
+		void OnRecovered(const Item& x)
+		{
+			for (const Match& m : x.m_vMatches)
 			{
-				evt.m_Flags = 0;
-				m_Rec.m_Recognizer.m_Pos.m_Height = wlk.m_SpendHeight;
-				m_Rec.m_Recognizer.AddEvent(evt);
-			}
+				if (m.m_Cid.IsDummy())
+				{
+					m_Rec.m_Handler.m_Proc.OnDummy(m.m_Cid, x.m_hCreate);
+					continue;
+				}
 
-			return true;
+				m_Rec.m_Handler.m_pAccount = m_pAcc + m.m_iAcc;
+
+				proto::Event::Utxo evt;
+				evt.m_Flags = proto::Event::Flags::Add;
+				evt.m_Cid = m.m_Cid;
+				evt.m_Commitment = x.m_Commitment;
+				evt.m_Maturity = x.m_Maturity;
+				evt.m_User = m.m_User;
+
+				m_Rec.m_Recognizer.m_Pos.m_Height = x.m_hCreate;
+				// don't reset the Pos.Index. Its value is not important, it only should be monotonic
+				const EventKey::Utxo& key = x.m_Commitment;
+				m_Rec.m_Recognizer.AddEvent(evt, key);
+
+				m_Total++;
+
+				if (MaxHeight == x.m_hSpend)
+					m_Unspent++;
+				else
+				{
+					evt.m_Flags = 0;
+					m_Rec.m_Recognizer.m_Pos.m_Height = x.m_hSpend;
+					m_Rec.m_Recognizer.AddEvent(evt);
+				}
+			}
 		}
 	};
 
 	{
 		LongAction la("Rescanning owned Txos...", 0, m_pExternalHandler);
 
-		TxoRecover wlk(rec);
+		TxoRecover wlk(rec, ex);
 		wlk.m_pLa = &la;
 		wlk.m_pAcc = &m_vAccounts.front() + m_vAccounts.size() - nRecent;
 		wlk.m_nAcc = nRecent;
+		wlk.m_nBatch = nBatch;
 
 		EnumTxos(wlk);
+		wlk.Flush();
 
 		BEAM_LOG_INFO() << "Recovered " << wlk.m_Unspent << "/" << wlk.m_Total << " unspent/total Txos";
 	}
@@ -3697,37 +4504,92 @@ void NodeProcessor::RescanAccounts(uint32_t nRecent)
 		struct MyKrnWalker
 			:public KrnWalkerRecognize
 		{
-			using KrnWalkerRecognize::KrnWalkerRecognize;
+			struct PerHeight
+			{
+				Height m_Height;
+				std::vector<TxKernel::Ptr> m_vKrns;
+			};
 
+			Executor& m_Ex;
 			const Account* m_pAcc;
 			uint32_t m_nAcc;
 
+			std::vector<PerHeight> m_vPending;
+			uint32_t m_nPendingKrns = 0;
+			uint32_t m_nBatch;
+
+			MyKrnWalker(Recognizer& rec, Executor& ex)
+				:KrnWalkerRecognize(rec)
+				,m_Ex(ex)
+			{
+			}
+
 			bool ProcessHeight(uint64_t rowID, const std::vector<TxKernel::Ptr>& v) override
+			{
+				if (v.empty())
+					return true;
+
+				PerHeight& x = m_vPending.emplace_back();
+				x.m_Height = m_Height;
+				Cast::NotConst(v).swap(x.m_vKrns); // EnumKernels reads the next height into the (now empty) vector
+
+				m_nPendingKrns += static_cast<uint32_t>(x.m_vKrns.size());
+				return (m_nPendingKrns < m_nBatch) || Flush();
+			}
+
+			bool Flush()
 			{
 				TxoID nOuts = m_Rec.m_Extra.m_ShieldedOutputs;
-				m_Rec.m_Pos.m_Height = m_Height;
 
 				for (uint32_t iAcc = 0; iAcc < m_nAcc; iAcc++)
 				{
 					m_Rec.m_Extra.m_ShieldedOutputs = nOuts;
-
 					m_Rec.m_Handler.m_pAccount = m_pAcc + iAcc;
 
-					if (!KrnWalkerRecognize::ProcessHeight(rowID, v))
+					// the shielded outputs of all the pending heights are recognized in advance
+					Recognizer::ShieldedOutsBatch sob;
+					for (const auto& x : m_vPending)
+						sob.Collect(x.m_vKrns, x.m_Height);
+
+					if (!sob.m_vEntries.empty())
+					{
+						sob.Recognize(m_Ex, m_pAcc[iAcc]);
+						m_Rec.m_pShieldedOuts = &sob;
+					}
+
+					bool bContinue = true;
+					for (const auto& x : m_vPending)
+					{
+						m_Height = x.m_Height;
+						m_nKrnIdx = 0;
+						m_Rec.m_Pos.m_Height = x.m_Height;
+
+						if (!Process(x.m_vKrns))
+						{
+							bContinue = false;
+							break;
+						}
+					}
+
+					m_Rec.m_pShieldedOuts = nullptr;
+					if (!bContinue)
 						return false;
 				}
 
+				m_vPending.clear();
+				m_nPendingKrns = 0;
 				return true;
 			}
-
 		};
 
-		MyKrnWalker wlkKrn(rec.m_Recognizer);
+		MyKrnWalker wlkKrn(rec.m_Recognizer, ex);
 		wlkKrn.m_pAcc = &m_vAccounts.front() + m_vAccounts.size() - nRecent;
 		wlkKrn.m_nAcc = nRecent;
+		wlkKrn.m_nBatch = nBatch;
 
 		wlkKrn.m_pLa = &la;
 		EnumKernels(wlkKrn, HeightRange(h0, m_Cursor.m_Sid.m_Height));
+		wlkKrn.Flush();
 
 		assert(m_Extra.m_ShieldedOutputs == nOuts);
 		nOuts; // suppress unused var warning in release
@@ -3745,6 +4607,9 @@ Height NodeProcessor::FindVisibleKernel(const Merkle::Hash& id, const BlockInter
 			return bic.m_Height;
 	}
 
+	if (IsCoveredByKrnFilter(bic.m_Height) && !m_KrnFilter.MayContain(id))
+		return Rules::HeightGenesis - 1; // either absent or beyond the visibility horizon
+
 	Height h = m_DB.FindKernel(id);
 	if (h >= Rules::HeightGenesis)
 	{
@@ -4663,12 +5528,90 @@ void NodeProcessor::ManageKrnID(BlockInterpretCtx& bic, const TxKernel& krn)
 	}
 	else
 	{
-		if (bic.m_Fwd)
-			m_DB.InsertKernel(key, bic.m_Height);
-		else
-			m_DB.DeleteKernel(key, bic.m_Height);
+		if (bic.m_Fwd)
+		{
+			m_DB.InsertKernel(key, bic.m_Height);
+
+			if (MaxHeight != m_KrnFilter.m_hLo)
+			{
+				if (m_KrnFilter.IsFull())
+					BuildKrnFilter(bic.m_Height); // the new kernel is already in the DB
+				else
+					m_KrnFilter.Insert(key);
+			}
+		}
+		else
+			m_DB.DeleteKernel(key, bic.m_Height);
+	}
+
+}
+
+void NodeProcessor::KrnFilter::Reset(uint64_t nExpected)
+{
+	m_nMax = nExpected;
+	m_nCount = 0;
+	m_vBits.assign((nExpected * s_BitsPerElement + 63) / 64 + 1, 0);
+}
+
+void NodeProcessor::KrnFilter::Insert(const Merkle::Hash& id)
+{
+	uint64_t nBits = static_cast<uint64_t>(m_vBits.size()) * 64;
+
+	// the ID is a hash, its words are good enough as independent hashes
+	static_assert(sizeof(Merkle::Hash) >= sizeof(uint64_t) * s_Hashes);
+	for (uint32_t i = 0; i < s_Hashes; i++)
+	{
+		uint64_t x;
+		memcpy(&x, id.m_pData + sizeof(x) * i, sizeof(x));
+		x %= nBits;
+		m_vBits[x >> 6] |= uint64_t(1) << (x & 63);
+	}
+
+	m_nCount++;
+}
+
+bool NodeProcessor::KrnFilter::MayContain(const Merkle::Hash& id) const
+{
+	uint64_t nBits = static_cast<uint64_t>(m_vBits.size()) * 64;
+
+	for (uint32_t i = 0; i < s_Hashes; i++)
+	{
+		uint64_t x;
+		memcpy(&x, id.m_pData + sizeof(x) * i, sizeof(x));
+		x %= nBits;
+		if (!(m_vBits[x >> 6] & (uint64_t(1) << (x & 63))))
+			return false;
 	}
 
+	return true;
+}
+
+void NodeProcessor::BuildKrnFilter(Height h)
+{
+	// only the kernels within the visibility horizon are needed
+	const Rules& r = Rules::get();
+	Height hLo = (h > r.MaxKernelValidityDH) ? (h - r.MaxKernelValidityDH) : 0;
+
+	uint64_t nCount = m_DB.get_KernelsCount(hLo);
+	m_KrnFilter.Reset(nCount * 2 + 0x100000); // leave room for the growth
+
+	NodeDB::WalkerKernel wlk;
+	for (m_DB.EnumKernels(wlk, hLo); wlk.MoveNext(); )
+		m_KrnFilter.Insert(wlk.m_ID);
+
+	m_KrnFilter.m_hLo = hLo;
+
+	BEAM_LOG_INFO() << "Kernel filter: " << nCount << " kernels from height " << hLo << ", " << (m_KrnFilter.m_vBits.size() * sizeof(uint64_t) >> 20) << " MB";
+}
+
+bool NodeProcessor::IsCoveredByKrnFilter(Height h) const
+{
+	// before Fork2 the visibility isn't limited
+	const Rules& r = Rules::get();
+	return
+		r.IsPastFork_<2>(h) &&
+		(h >= r.MaxKernelValidityDH) &&
+		(h - r.MaxKernelValidityDH >= m_KrnFilter.m_hLo);
 }
 
 bool NodeProcessor::HandleBlockElement(const TxKernel& v, BlockInterpretCtx& bic)
@@ -4736,6 +5679,10 @@ bool NodeProcessor::HandleKernel(const TxKernel& v, BlockInterpretCtx& bic)
 	if (bOk)
 	{
 		bOk = HandleKernelTypeAny(v, bic);
+		bic.FlushContractVars(*this); // write-back of the vars modified by this kernel
+
+		if (bic.m_pAccess && bic.m_Fwd)
+			bic.m_pAccess->OnKernel();
 
 		if (!bOk && bic.m_pTxErrorInfo)
 			*bic.m_pTxErrorInfo << " <- Kernel Type " << (uint32_t) v.get_Subtype();
@@ -5012,11 +5959,8 @@ bool NodeProcessor::BlockInterpretCtx::BvmProcessor::Invoke(const bvm2::Contract
 			m_pSigValidate = &hp;
 		}
 
-		while (!IsDone())
-		{
-			DischargeUnits(bvm2::Limits::Cost::Cycle);
-			RunOnce();
-		}
+		if (!RunCharged(m_Charge, bvm2::Limits::Cost::Cycle))
+			DischargeUnits(bvm2::Limits::Cost::Cycle); // would throw
 
 		if (!m_Bic.m_AlreadyValidated)
 			CheckSigs(krn.m_Commitment, krn.m_Signature);
@@ -5460,7 +6404,7 @@ struct NodeProcessor::ProcessorInfoParser
 	std::string Execute()
 	{
 		while (!IsDone())
-			RunOnce();
+			RunMany();
 
 		auto ret = m_os.str();
 		if (2 == ret.size())
@@ -5537,6 +6481,9 @@ void NodeProcessor::get_ContractDescr(const ECC::uintBig& sid, const ECC::uintBi
 
 BlobMap::Entry& NodeProcessor::BlockInterpretCtx::get_ContractVar(const Blob& key, NodeDB& db)
 {
+	if (m_pAccess)
+		m_pAccess->OnRead(key);
+
 	auto* pE = m_ContractVars.Find(key);
 	if (!pE)
 	{
@@ -5561,6 +6508,9 @@ BlobMap::Entry* NodeProcessor::BlockInterpretCtx::BvmProcessor::FindVarEx(const
 	auto* pE = &m_Bic.get_ContractVar(key, m_Proc.m_DB);
 	if (pE->m_Data.empty() || !bExact)
 	{
+		if (m_Bic.m_pAccess)
+			m_Bic.m_pAccess->m_Range = true;
+
 		while (true)
 		{
 			NodeDB::Recordset rs;
@@ -5628,23 +6578,9 @@ void NodeProcessor::BlockInterpretCtx::VmProcessorBase::ContractDataSaveWithReco
 		RecoveryTag::Type nTag = RecoveryTag::Insert;
 
 		if (data.n)
-		{
-			if (e.m_Data.size())
-			{
-				nTag = RecoveryTag::Update;
-				ContractDataUpdate(key, data, e.m_Data);
-			}
-			else
-			{
-				nTag = RecoveryTag::Delete;
-				ContractDataInsert(key, data);
-			}
-		}
+			nTag = e.m_Data.size() ? RecoveryTag::Update : RecoveryTag::Delete;
 		else
-		{
 			assert(e.m_Data.size());
-			ContractDataDel(key, e.m_Data);
-		}
 
 		BlockInterpretCtx::Ser ser(m_Bic);
 		ser& nTag;
@@ -5653,7 +6589,9 @@ void NodeProcessor::BlockInterpretCtx::VmProcessorBase::ContractDataSaveWithReco
 		if (e.m_Data.size())
 			ser & e.m_Data;
 
-		data.Export(e.m_Data);
+		ByteBuffer buf;
+		data.Export(buf);
+		ContractDataModify(e, buf);
 	}
 }
 
@@ -5672,26 +6610,53 @@ void NodeProcessor::BlockInterpretCtx::VmProcessorBase::UpdChargeWithRecovery(ui
 }
 
 
-void NodeProcessor::BlockInterpretCtx::VmProcessorBase::ContractDataInsert(const Blob& key, const Blob& data)
+void NodeProcessor::BlockInterpretCtx::VmProcessorBase::ContractDataModify(BlobMap::Entry& e, ByteBuffer& data)
 {
-	ContractDataToggleTree(key, data, true);
-	if (!m_Bic.m_Temporary)
-		m_Proc.m_DB.ContractDataInsert(key, data);
-}
+	Blob key = e.ToBlob();
+	if (!m_Bic.m_ContractVarsOrig.Find(key))
+		m_Bic.m_ContractVarsOrig.Create(key)->m_Data = e.m_Data; // 1st modification by this kernel
 
-void NodeProcessor::BlockInterpretCtx::VmProcessorBase::ContractDataUpdate(const Blob& key, const Blob& val, const Blob& valOld)
-{
-	ContractDataToggleTree(key, val, true);
-	ContractDataToggleTree(key, valOld, false);
-	if (!m_Bic.m_Temporary)
-		m_Proc.m_DB.ContractDataUpdate(key, val);
+	if (m_Bic.m_pAccess)
+		m_Bic.m_pAccess->OnWrite(key);
+
+	e.m_Data.swap(data);
 }
 
-void NodeProcessor::BlockInterpretCtx::VmProcessorBase::ContractDataDel(const Blob& key, const Blob& valOld)
+void NodeProcessor::BlockInterpretCtx::FlushContractVars(NodeProcessor& np)
 {
-	ContractDataToggleTree(key, valOld, false);
-	if (!m_Bic.m_Temporary)
-		m_Proc.m_DB.ContractDataDel(key);
+	for (auto it = m_ContractVarsOrig.begin(); m_ContractVarsOrig.end() != it; it++)
+	{
+		const BlobMap::Entry& eOrig = *it;
+		Blob key = eOrig.ToBlob();
+
+		const BlobMap::Entry* pE = m_ContractVars.Find(key);
+		assert(pE);
+
+		const ByteBuffer& valOld = eOrig.m_Data;
+		const ByteBuffer& val = pE->m_Data;
+		if (val == valOld)
+			continue;
+
+		if (!val.empty())
+			ContractDataToggleTree(np, key, val, true);
+		if (!valOld.empty())
+			ContractDataToggleTree(np, key, valOld, false);
+
+		if (!m_Temporary)
+		{
+			if (val.empty())
+				np.m_DB.ContractDataDel(key);
+			else
+			{
+				if (valOld.empty())
+					np.m_DB.ContractDataInsert(key, val);
+				else
+					np.m_DB.ContractDataUpdate(key, val);
+			}
+		}
+	}
+
+	m_ContractVarsOrig.Clear();
 }
 
 bool NodeProcessor::Mapped::Contract::IsStored(const Blob& key)
@@ -5735,10 +6700,68 @@ void NodeProcessor::Mapped::Contract::Toggle(const Blob& key, const Blob& data,
 	}
 }
 
-void NodeProcessor::BlockInterpretCtx::VmProcessorBase::ContractDataToggleTree(const Blob& key, const Blob& data, bool bAdd)
+void NodeProcessor::BlockInterpretCtx::ContractAccess::OnRead(const Blob& key)
 {
-	if (!m_Bic.m_SkipDefinition)
-		m_Proc.m_Mapped.m_Contract.Toggle(key, data, bAdd);
+	ByteBuffer buf;
+	key.Export(buf);
+	m_Read.insert(std::move(buf));
+}
+
+void NodeProcessor::BlockInterpretCtx::ContractAccess::OnWrite(const Blob& key)
+{
+	ByteBuffer buf;
+	key.Export(buf);
+	m_Write.insert(std::move(buf));
+}
+
+void NodeProcessor::BlockInterpretCtx::ContractAccess::OnKernel()
+{
+	if (m_Write.empty() && m_Read.empty())
+		return; // not a contract kernel
+
+	uint32_t nWave = m_WaveBarrier;
+	if (m_Range)
+		nWave = m_Waves;
+	else
+	{
+		for (const auto& key : m_Read)
+		{
+			auto it = m_Vars.find(key);
+			if (m_Vars.end() != it)
+				std::setmax(nWave, it->second.m_WaveW);
+		}
+
+		for (const auto& key : m_Write)
+		{
+			auto it = m_Vars.find(key);
+			if (m_Vars.end() != it)
+			{
+				std::setmax(nWave, it->second.m_WaveW);
+				std::setmax(nWave, it->second.m_WaveR);
+			}
+		}
+	}
+
+	nWave++;
+	std::setmax(m_Waves, nWave);
+	if (m_Range)
+		m_WaveBarrier = nWave;
+
+	for (const auto& key : m_Read)
+		std::setmax(m_Vars[key].m_WaveR, nWave);
+	for (const auto& key : m_Write)
+		std::setmax(m_Vars[key].m_WaveW, nWave);
+
+	m_Kernels++;
+	m_Read.clear();
+	m_Write.clear();
+	m_Range = false;
+}
+
+void NodeProcessor::BlockInterpretCtx::ContractDataToggleTree(NodeProcessor& np, const Blob& key, const Blob& data, bool bAdd)
+{
+	if (!m_SkipDefinition)
+		np.m_Mapped.m_Contract.Toggle(key, data, bAdd);
 }
 
 uint32_t NodeProcessor::BlockInterpretCtx::BvmProcessor::OnLog(const Blob& key, const Blob& val)
@@ -5963,28 +6986,16 @@ void NodeProcessor::BlockInterpretCtx::VmProcessorBase::UndoVars()
 				der & key;
 				auto& e = m_Bic.get_ContractVar(key, m_Proc.m_DB);
 
-				if (RecoveryTag::Delete == nTag)
-				{
-					ContractDataDel(key, e.m_Data);
-					e.m_Data.clear();
-				}
-				else
+				ByteBuffer data;
+				if (RecoveryTag::Delete != nTag)
 				{
-					ByteBuffer data;
 					der & data;
 
-					if (RecoveryTag::Insert == nTag)
-						ContractDataInsert(key, data);
-					else
-					{
-						if (RecoveryTag::Update != nTag)
-							OnCorrupted();
-						ContractDataUpdate(key, data, e.m_Data);
-					}
-
-					e.m_Data.swap(data);
+					if ((RecoveryTag::Insert != nTag) && (RecoveryTag::Update != nTag))
+						OnCorrupted();
 				}
 
+				ContractDataModify(e, data);
 			}
 		}
 	}
@@ -6082,7 +7093,7 @@ void NodeProcessor::SetInputMaturity(Input& inp)
 	// We find the original UTXO height, and then decode the UTXO body, and check its additional maturity factors (coinbase, incubation)
 
 	NodeDB::WalkerTxo wlk;
-	m_DB.TxoGetValue(wlk, inp.m_Internal.m_ID);
+	m_DB.TxoGetNaked(wlk, inp.m_Internal.m_ID);
 
 	uint8_t pNaked[s_TxoNakedMax];
 	Blob val = wlk.m_Value;
@@ -6111,10 +7122,12 @@ void NodeProcessor::RollbackTo(Height h)
 
 	TxoID id0 = get_TxosBefore(h + 1);
 
-	// undo inputs
+	// undo inputs. The txos are marked unspent at once for all the blocks
+	std::vector<NodeDB::StateInput> v;
+	std::vector<TxoID> vUnspent;
+
 	for (NodeDB::StateID sid = m_Cursor.m_Sid; sid.m_Height > h; )
 	{
-		std::vector<NodeDB::StateInput> v;
 		m_DB.get_StateInputs(sid.m_Row, v);
 
 		BlockInterpretCtx bic(sid.m_Height, false);
@@ -6133,7 +7146,7 @@ void NodeProcessor::RollbackTo(Height h)
 			if (!HandleBlockElement(inp, bic))
 				OnCorrupted();
 
-			m_DB.TxoSetSpent(id, MaxHeight);
+			vUnspent.push_back(id);
 		}
 
 		m_DB.set_StateInputs(sid.m_Row, nullptr, 0);
@@ -6142,6 +7155,9 @@ void NodeProcessor::RollbackTo(Height h)
 			ZeroObject(sid);
 	}
 
+	if (!vUnspent.empty())
+		m_DB.TxoSetSpent(&vUnspent.front(), vUnspent.size(), MaxHeight);
+
 	// undo outputs
 	struct MyWalker
 		:public ITxoWalker_UnspentNaked
@@ -6741,6 +7757,68 @@ bool NodeProcessor::ValidateInputs(const ECC::Point& comm, Input::Count nCount /
 	return !m_Mapped.m_Utxo.Traverse(t);
 }
 
+size_t NodeProcessor::get_DependentPackageLen(const BlockContext& bc, const std::vector<const TxPool::Dependent::Element*>& vDependent, Height h, size_t nSizeAvail)
+{
+	// The dependent chain goes first, and each its prefix is a package (the element with all its ancestors), i.e. a child pays for its parents.
+	// Select the prefix that maximizes the block revenue, assuming the rest of the block is filled by the pool txs in the profit order.
+	// A low-fee tail is cut if it would displace more profitable pool txs.
+	if (vDependent.empty())
+		return 0;
+
+	struct FluffFill {
+		size_t m_Size;
+		Amount m_Fees;
+	};
+	std::vector<FluffFill> vFill; // cumulative, in profit order
+	{
+		FluffFill x = { 0 };
+		for (auto it = bc.m_TxPool.m_setProfit.begin(); bc.m_TxPool.m_setProfit.end() != it; ++it)
+		{
+			const TxPool::Stats& s = it->m_Stats;
+			if (!s.m_Hr.IsInRange(h))
+				continue;
+
+			x.m_Size += s.m_Size;
+			if (x.m_Size > nSizeAvail)
+				break;
+
+			x.m_Fees += s.m_Fee;
+			if (x.m_Fees < s.m_Fee)
+				break; // overflow
+
+			vFill.push_back(x);
+		}
+	}
+
+	auto fnFill = [&vFill](size_t nSize) -> Amount
+	{
+		auto it = std::upper_bound(vFill.begin(), vFill.end(), nSize, [](size_t n, const FluffFill& x) { return n < x.m_Size; });
+		return (vFill.begin() == it) ? 0 : (it - 1)->m_Fees;
+	};
+
+	size_t nRes = 0;
+	Amount revBest = fnFill(nSizeAvail);
+
+	for (size_t i = 0; i < vDependent.size(); i++)
+	{
+		const TxPool::Dependent::Element& x = *vDependent[i]; // cumulative fee and size of the package
+		if (x.m_Size > nSizeAvail)
+			break;
+
+		Amount rev = x.m_Fee + fnFill(nSizeAvail - x.m_Size);
+		if (rev < x.m_Fee)
+			rev = static_cast<Amount>(-1);
+
+		if (rev >= revBest) // prefer longer chains on ties
+		{
+			revBest = rev;
+			nRes = i + 1;
+		}
+	}
+
+	return nRes;
+}
+
 size_t NodeProcessor::GenerateNewBlockInternal(BlockContext& bc, BlockInterpretCtx& bic)
 {
 	Height h = m_Cursor.m_Sid.m_Height + 1;
@@ -6794,6 +7872,18 @@ size_t NodeProcessor::GenerateNewBlockInternal(BlockContext& bc, BlockInterpretC
 		m_nSizeUtxoComissionUpperLimit = ssc2.m_Counter.m_Value;
 	}
 
+	if (!m_nSizeTxLowerLimit)
+	{
+		// the smallest possible tx: std kernel with no optional fields
+		TxKernelStd krn;
+		ZeroObject(krn.m_Commitment);
+		ZeroObject(krn.m_Signature);
+
+		SerializerSizeCounter ssc2;
+		yas::detail::SaveKrn(ssc2, krn, false);
+		m_nSizeTxLowerLimit = ssc2.m_Counter.m_Value;
+	}
+
 	if (bc.m_Fees)
 		ssc.m_Counter.m_Value += m_nSizeUtxoComissionUpperLimit;
 
@@ -6810,6 +7900,15 @@ size_t NodeProcessor::GenerateNewBlockInternal(BlockContext& bc, BlockInterpretC
 	DependentContextSwitch::Vec vDependent;
 	DependentContextSwitch::Convert(vDependent, bc.m_pParent);
 
+	size_t nSizeAvail = nSizeMax - ssc.m_Counter.m_Value;
+	if (!bc.m_Fees)
+		nSizeAvail = (nSizeAvail > m_nSizeUtxoComissionUpperLimit) ? (nSizeAvail - m_nSizeUtxoComissionUpperLimit) : 0;
+
+	if (bc.m_bEmptyBody)
+		vDependent.clear();
+	else
+		vDependent.resize(get_DependentPackageLen(bc, vDependent, h, nSizeAvail));
+
 	for (size_t i = 0; i < vDependent.size(); i++)
 	{
 		// Theoretically for dependent txs can set m_AlreadyValidated flag. But it's not good to mix validated and non-validated in the same pass (ManageKrnID would be confused).
@@ -6853,8 +7952,15 @@ size_t NodeProcessor::GenerateNewBlockInternal(BlockContext& bc, BlockInterpretC
 		++nTxNum;
 	}
 
-	for (TxPool::Fluff::ProfitSet::iterator it = bc.m_TxPool.m_setProfit.begin(); bc.m_TxPool.m_setProfit.end() != it; )
+	TxPool::Fluff::ProfitSet::iterator itPool = bc.m_bEmptyBody ? bc.m_TxPool.m_setProfit.end() : bc.m_TxPool.m_setProfit.begin();
+	for (TxPool::Fluff::ProfitSet::iterator it = itPool; bc.m_TxPool.m_setProfit.end() != it; )
 	{
+		if (ssc.m_Counter.m_Value + m_nSizeTxLowerLimit > nSizeMax)
+		{
+			bc.m_bFull = true;
+			break; // no point to walk the rest of the pool
+		}
+
 		TxPool::Fluff::Element& x = (it++)->get_ParentObj();
 
 		Amount feesNext = bc.m_Fees + x.m_Profit.m_Stats.m_Fee;
@@ -6889,6 +7995,7 @@ size_t NodeProcessor::GenerateNewBlockInternal(BlockContext& bc, BlockInterpretC
 				TxVectors::Writer(bc.m_Block, bc.m_Block).Dump(tx.get_Reader());
 
 				bc.m_Fees = feesNext;
+				bc.m_ProfitFloor = x.m_Profit.m_Stats;
 				ssc.m_Counter.m_Value = nSizeNext;
 				offset += ECC::Scalar::Native(tx.m_Offset);
 				++nTxNum;
@@ -6964,7 +8071,10 @@ void NodeProcessor::GenerateNewHdr(BlockContext& bc, BlockInterpretCtx& bic)
 	ev.get_Definition(bc.m_Hdr.m_Definition);
 
 	if (Rules::get().IsPastFork_<3>(ev.m_Height))
+	{
+		Executor::Scope scope(get_Executor());
 		get_Utxos().get_Hash(bc.m_Hdr.m_Kernels);
+	}
 	else
 		bc.m_Hdr.m_Kernels = ev.m_hvKernels;
 
@@ -6987,6 +8097,11 @@ NodeProcessor::BlockContext::BlockContext(TxPool::Fluff& txp, Key::Index nSubKey
 {
 	m_Fees = 0;
 	m_Block.ZeroInit();
+
+	m_ProfitFloor.m_Fee = 0;
+	m_ProfitFloor.m_FeeReserve = 0;
+	m_ProfitFloor.m_Size = 0;
+	m_ProfitFloor.m_SizeCorrection = 0;
 }
 
 bool NodeProcessor::GenerateNewBlock(BlockContext& bc)
@@ -7048,14 +8163,22 @@ bool NodeProcessor::GenerateNewBlock(BlockContext& bc)
     BEAM_VERIFY(HandleValidatedTx(bc.m_Block, bic)); // undo changes
 	assert(bic.m_Rollback.empty());
 
+	// precompute the sizes, so that each body is serialized into a single allocation
+	SerializerSizeCounter sscP, sscE;
+	sscP & Cast::Down<Block::BodyBase>(bc.m_Block);
+	sscP & Cast::Down<TxVectors::Perishable>(bc.m_Block);
+	sscE & Cast::Down<TxVectors::Eternal>(bc.m_Block);
+
 	Serializer ser;
 
 	ser.reset();
+	ser.reserve(sscP.m_Counter.m_Value);
 	ser & Cast::Down<Block::BodyBase>(bc.m_Block);
 	ser & Cast::Down<TxVectors::Perishable>(bc.m_Block);
 	ser.swap_buf(bc.m_BodyP);
 
 	ser.reset();
+	ser.reserve(sscE.m_Counter.m_Value);
 	ser & Cast::Down<TxVectors::Eternal>(bc.m_Block);
 	ser.swap_buf(bc.m_BodyE);
 
@@ -7113,6 +8236,8 @@ void NodeProcessor::MyExecutor::ExecAll(TaskSync& t)
 
 bool NodeProcessor::ValidateAndSummarize(TxBase::Context& ctx, const TxBase& txb, TxBase::IReader&& r, std::string& sErr)
 {
+	BEAM_METRICS_SCOPE("NodeProcessor.ValidateAndSummarize");
+
 	struct MyShared
 		:public MultiblockContext::MyTask::Shared
 	{
@@ -7390,10 +8515,9 @@ bool NodeProcessor::ITxoWalker::OnTxo(const NodeDB::WalkerTxo& wlk , Height hCre
 	Deserializer der;
 	der.reset(wlk.m_Value.p, wlk.m_Value.n);
 
-	Output outp;
-	der & outp;
+	der & m_Outp;
 
-	return OnTxo(wlk, hCreate, outp);
+	return OnTxo(wlk, hCreate, m_Outp);
 }
 
 bool NodeProcessor::ITxoWalker::OnTxo(const NodeDB::WalkerTxo&, Height hCreate, Output&)
@@ -7473,7 +8597,7 @@ void NodeProcessor::InitializeUtxos()
 	EnumTxos(wlk);
 }
 
-bool NodeProcessor::GetBlock(const NodeDB::StateID& sid, ByteBuffer* pEthernal, ByteBuffer* pPerishable, Height h0, Height hLo1, Height hHi1, bool bActive)
+bool NodeProcessor::IsBlockServable(const NodeDB::StateID& sid, Height h0, Height& hLo1, Height& hHi1, bool& bFullBlock)
 {
 	// h0 - current peer Height
 	// hLo1 - HorizonLo that peer needs after the sync
@@ -7507,7 +8631,28 @@ bool NodeProcessor::GetBlock(const NodeDB::StateID& sid, ByteBuffer* pEthernal,
 	if (IsFastSync() && (sid.m_Height > m_Cursor.m_ID.m_Height))
 		return false;
 
-	bool bFullBlock = (sid.m_Height >= hHi1) && (sid.m_Height > hLo1);
+	bFullBlock = (sid.m_Height >= hHi1) && (sid.m_Height > hLo1);
+	return true;
+}
+
+bool NodeProcessor::GetBlockRef(const NodeDB::StateID& sid, Blob* pEthernal, Blob* pPerishable, Height h0, Height hLo1, Height hHi1)
+{
+	bool bFullBlock;
+	if (!IsBlockServable(sid, h0, hLo1, hHi1, bFullBlock))
+		return false;
+
+	if (pPerishable && !bFullBlock)
+		return false; // should be re-created
+
+	return m_DB.GetStateBlockRef(sid.m_Row, pPerishable, pEthernal);
+}
+
+bool NodeProcessor::GetBlock(const NodeDB::StateID& sid, ByteBuffer* pEthernal, ByteBuffer* pPerishable, Height h0, Height hLo1, Height hHi1, bool bActive)
+{
+	bool bFullBlock;
+	if (!IsBlockServable(sid, h0, hLo1, hHi1, bFullBlock))
+		return false;
+
 	m_DB.GetStateBlock(sid.m_Row, bFullBlock ? pPerishable : nullptr, pEthernal, nullptr);
 
 	if (!(pPerishable && pPerishable->empty()))
@@ -7874,8 +9019,12 @@ bool NodeProcessor::ValidatedCache::Find(const Entry::Key::Type& val)
 
 	KeySet::iterator it = m_Keys.find(key);
 	if (m_Keys.end() == it)
+	{
+		m_Misses++;
 		return false;
+	}
 
+	m_Hits++;
 	MoveToFront(it->get_ParentObj());
 	return true;
 }
@@ -7906,6 +9055,68 @@ void NodeProcessor::ValidatedCache::MoveInto(ValidatedCache& dst)
 	}
 }
 
+#pragma pack (push, 1)
+struct ValidatedCacheRecord
+{
+	ECC::Hash::Value m_Key;
+	uintBigFor<TxoID>::Type m_ShLo;
+};
+#pragma pack (pop)
+
+void NodeProcessor::ValidatedCache::Save(NodeDB& db) const
+{
+	if (!m_Persist || m_Mru.empty())
+	{
+		db.ParamDelSafe(NodeDB::ParamID::ValidatedCache);
+		return;
+	}
+
+	// from the least recently used, so that Load() restores the same MRU order
+	std::vector<ValidatedCacheRecord> v;
+	v.reserve(m_Mru.size());
+
+	for (MruList::const_reverse_iterator it = m_Mru.rbegin(); m_Mru.rend() != it; ++it)
+	{
+		const Entry& x = it->get_ParentObj();
+
+		ValidatedCacheRecord& r = v.emplace_back();
+		r.m_Key = x.m_Key.m_Value;
+		r.m_ShLo = x.m_ShLo.m_End;
+	}
+
+	Blob blob(&v.front(), static_cast<uint32_t>(sizeof(ValidatedCacheRecord) * v.size()));
+	db.ParamSet(NodeDB::ParamID::ValidatedCache, nullptr, &blob);
+
+	BEAM_LOG_INFO() << "Validated cache saved, " << v.size() << " entries";
+}
+
+void NodeProcessor::ValidatedCache::Load(NodeDB& db)
+{
+	ByteBuffer buf;
+	if (!db.ParamGet(NodeDB::ParamID::ValidatedCache, nullptr, nullptr, &buf))
+		return;
+
+	// the snapshot is consumed once. If the node crashes - it won't reuse the stale one
+	db.ParamDelSafe(NodeDB::ParamID::ValidatedCache);
+
+	if (!m_Persist || buf.empty() || (buf.size() % sizeof(ValidatedCacheRecord)))
+		return;
+
+	size_t n = buf.size() / sizeof(ValidatedCacheRecord);
+	const ValidatedCacheRecord* p = reinterpret_cast<const ValidatedCacheRecord*>(&buf.front());
+
+	for (size_t i = 0; i < n; i++)
+	{
+		Entry::ShLo::Type nShLo;
+		p[i].m_ShLo.Export(nShLo);
+
+		if (!Find(p[i].m_Key))
+			Insert(p[i].m_Key, nShLo);
+	}
+
+	BEAM_LOG_INFO() << "Validated cache loaded, " << n << " entries";
+}
+
 /////////////////////////////
 // Mapped
 struct NodeProcessor::Mapped::Type {
@@ -7928,7 +9139,7 @@ bool NodeProcessor::Mapped::Open(const char* sz, const Stamp& s)
 		0xFB, 0x6A, 0x15, 0x54,
 		0x41, 0x7C, 0x4C, 0x3D,
 		0x81, 0xD5, 0x9C, 0xD9,
-		0x17, 0xCE, 0xA4, 0x92
+		0x17, 0xCE, 0xA4, 0x93
 	};
 
 	MappedFile::Defs d;
@@ -7940,6 +9151,13 @@ bool NodeProcessor::Mapped::Open(const char* sz, const Stamp& s)
 	m_Mapping.Open(sz, d);
 
 	Hdr& h = get_Hdr();
+	if (h.m_Dirty && (h.m_StampNext == s))
+	{
+		// the process was terminated after the DB commit, before the final flush. The image is complete
+		h.m_Dirty = 0;
+		h.m_Stamp = s;
+	}
+
 	if (!h.m_Dirty && (h.m_Stamp == s))
 	{
 		m_Utxo.m_RootOffset = h.m_RootUtxo;
@@ -7951,6 +9169,125 @@ bool NodeProcessor::Mapped::Open(const char* sz, const Stamp& s)
 	return false;
 }
 
+uint32_t NodeProcessor::Mapped::get_ElementSize(uint32_t iBank)
+{
+	switch (iBank)
+	{
+	case Type::UtxoLeaf: return sizeof(UtxoTree::MyLeaf);
+	case Type::HashJoint: return sizeof(RadixHashTree::MyJoint);
+	case Type::UtxoQueue: return sizeof(UtxoTree::MyLeaf::IDQueue);
+	case Type::UtxoNode: return sizeof(UtxoTree::MyLeaf::IDNode);
+	case Type::HashLeaf: return sizeof(RadixHashOnlyTree::MyLeaf);
+	default: // suppress warning
+		break;
+	}
+
+	assert(false);
+	return 0;
+}
+
+bool NodeProcessor::Mapped::IsFragmented()
+{
+	const MappedFile::Offset nSizeMin = 64 << 20; // not worth it below
+
+	MappedFile::Offset nSize = m_Mapping.get_Size();
+	if (nSize < nSizeMin)
+		return false;
+
+	MappedFile::Offset nFree = 0;
+	for (uint32_t iBank = 0; iBank < Type::count; iBank++)
+	{
+		uint64_t nTotal, nFreeElements;
+		m_Mapping.get_BankStat(iBank, nTotal, nFreeElements);
+		nFree += nFreeElements * get_ElementSize(iBank);
+	}
+
+	return (nFree * 2 > nSize);
+}
+
+void NodeProcessor::Mapped::CompactUtxos(const char* sz)
+{
+	uint64_t pUsed[Type::count];
+	for (uint32_t iBank = 0; iBank < Type::count; iBank++)
+	{
+		uint64_t nTotal, nFree;
+		m_Mapping.get_BankStat(iBank, nTotal, nFree);
+		pUsed[iBank] = nTotal - nFree;
+	}
+
+	Serializer ser;
+	m_Utxo.save(ser);
+
+	Stamp s;
+	s = 1U;
+	s.Negate(); // invalid, the image is reset
+
+	Close();
+	Open(sz, s);
+
+	// reserve everything in advance, the mapping must not move during the tree modification
+	for (uint32_t iBank = 0; iBank < Type::count; iBank++)
+		m_Mapping.EnsureReserve(iBank, get_ElementSize(iBank), pUsed[iBank] + (pUsed[iBank] >> 6) + 0x10);
+
+	Deserializer der;
+	der.reset(ser.buffer().first, ser.buffer().second);
+	m_Utxo.load(der);
+}
+
+void NodeProcessor::Mapped::get_Report(Report& r)
+{
+	static const char* s_pNames[Type::count] = {
+		"UtxoLeaf",
+		"HashJoint",
+		"UtxoQueue",
+		"UtxoNode",
+		"HashLeaf",
+	};
+
+	r.m_SizeFile = m_Mapping.get_Size();
+	r.m_SizeFree = 0;
+	r.m_vBanks.resize(Type::count);
+
+	for (uint32_t iBank = 0; iBank < Type::count; iBank++)
+	{
+		Report::Bank& b = r.m_vBanks[iBank];
+		b.m_szName = s_pNames[iBank];
+		b.m_ElementSize = get_ElementSize(iBank);
+		m_Mapping.get_BankStat(iBank, b.m_Total, b.m_Free);
+
+		r.m_SizeFree += b.m_Free * b.m_ElementSize;
+	}
+
+	struct Traveler
+		:public RadixTree::ITraveler
+	{
+		Report::Tree* m_pRes;
+
+		virtual bool OnLeaf(const RadixTree::Leaf&) override
+		{
+			m_pRes->m_Leafs++;
+			m_pRes->m_DepthTotal += m_pCu->get_Depth();
+			return true;
+		}
+	};
+
+	{
+		UtxoTree::Cursor cu;
+		Traveler t;
+		t.m_pCu = &cu;
+		t.m_pRes = &r.m_Utxo;
+		m_Utxo.Traverse(t);
+	}
+
+	{
+		RadixHashOnlyTree::Cursor cu;
+		Traveler t;
+		t.m_pCu = &cu;
+		t.m_pRes = &r.m_Contract;
+		m_Contract.Traverse(t);
+	}
+}
+
 void NodeProcessor::Mapped::Close()
 {
 	m_Utxo.m_RootOffset = 0; // prevent cleanup
@@ -7963,6 +9300,18 @@ NodeProcessor::Mapped::Hdr& NodeProcessor::Mapped::get_Hdr()
 	return *static_cast<Hdr*>(m_Mapping.get_FixedHdr());
 }
 
+void NodeProcessor::Mapped::FlushPrepare(const Stamp& s)
+{
+	Hdr& h = get_Hdr();
+	assert(h.m_Dirty);
+
+	h.m_RootUtxo = m_Utxo.m_RootOffset;
+	h.m_RootContract = m_Contract.m_RootOffset;
+	h.m_StampNext = s;
+
+	m_Mapping.Flush(); // the image must be durable before the DB refers to its stamp
+}
+
 void NodeProcessor::Mapped::FlushStrict(const Stamp& s)
 {
 	Hdr& h = get_Hdr();
@@ -7996,7 +9345,12 @@ void NodeProcessor::Mapped::Utxo::EnsureReserve()
 
 void NodeProcessor::Mapped::OnDirty()
 {
-	get_Hdr().m_Dirty = 1;
+	Hdr& h = get_Hdr();
+	if (!h.m_Dirty)
+	{
+		h.m_Dirty = 1;
+		h.m_StampNext = Zero; // no longer matches the image
+	}
 }
 
 intptr_t NodeProcessor::Mapped::Utxo::get_Base() const
@@ -44,6 +44,7 @@ class NodeProcessor
 		MappedFile m_Mapping;
 
 		struct Type;
+		static uint32_t get_ElementSize(uint32_t iBank);
 
 	protected:
 
@@ -109,15 +110,47 @@ class NodeProcessor
 
 		bool Open(const char* sz, const Stamp&);
 		bool IsOpen() const { return m_Mapping.get_Base() != nullptr; }
+		uint64_t get_Size() const { return m_Mapping.get_Size(); }
+		void set_Hints(uint8_t n) { m_Mapping.set_Hints(n); }
 
 		void Close();
-		void FlushStrict(const Stamp&);
+		bool IsFragmented();
+		void CompactUtxos(const char* sz); // rebuilds the image from the current UTXO tree. The contracts tree is reset
+
+		struct Report
+		{
+			struct Bank
+			{
+				const char* m_szName;
+				uint32_t m_ElementSize;
+				uint64_t m_Total; // elements
+				uint64_t m_Free;
+			};
+
+			std::vector<Bank> m_vBanks;
+			uint64_t m_SizeFile;
+			uint64_t m_SizeFree; // bytes in the free lists of all the banks
+
+			struct Tree
+			{
+				uint64_t m_Leafs = 0;
+				uint64_t m_DepthTotal = 0; // sum of the leaf depths
+			};
+
+			Tree m_Utxo;
+			Tree m_Contract;
+		};
+
+		void get_Report(Report&); // traverses both trees, may take a while
+		void FlushPrepare(const Stamp&); // before the DB commit
+		void FlushStrict(const Stamp&); // after the DB commit
 
 #pragma pack(push, 1)
 		struct Hdr
 		{
 			MappedFile::Offset m_Dirty; // boolean, just aligned
 			Stamp m_Stamp;
+			Stamp m_StampNext; // the image matches it despite being dirty, if the DB commit was done but the final flush wasn't
 			MappedFile::Offset m_RootUtxo;
 			MappedFile::Offset m_RootContract;
 		};
@@ -130,6 +163,7 @@ class NodeProcessor
 	Mapped m_Mapped;
 
 	size_t m_nSizeUtxoComissionUpperLimit = 0;
+	size_t m_nSizeTxLowerLimit = 0; // any tx has at least 1 kernel
 
 	struct MultiblockContext;
 	struct MultiSigmaContext;
@@ -146,6 +180,7 @@ class NodeProcessor
 	void InitializeUtxos();
 	bool TestDefinition();
 	void TestDefinitionStrict();
+	bool VerifyHeaders();
 	void CommitMappingAndDB();
 	void RequestDataInternal(const Block::SystemState::ID&, uint64_t row, bool bBlock, const NodeDB::StateID& sidTrg);
 
@@ -194,6 +229,7 @@ class NodeProcessor
 	static const uint32_t s_TxoNakedMax = s_TxoNakedMin + 0x10; // In case the output has the Incubation period - extra size is needed (actually less than this).
 
 	static void TxoToNaked(uint8_t* pBuf, Blob&);
+	void TxoAdd(NodeDB::TxoAdder&, TxoID, const Blob&);
 	static bool TxoIsNaked(const Blob&);
 
 	void SetInputMaturity(Input&);
@@ -208,7 +244,8 @@ class NodeProcessor
 
 	void InitCursor(bool bMovingUp);
 	bool InitMapping(const char*, bool bForceReset);
-	void InitializeMapped(const char*);
+	void InitializeMapped(const char*, bool bCompact);
+	void LogMappingReport();
 
 	typedef std::pair<int64_t, std::pair<int64_t, Difficulty::Raw> > THW; // Time-Height-Work. Time and Height are signed
 	Difficulty get_NextDifficulty();
@@ -235,6 +272,7 @@ class NodeProcessor
 	} m_CongestionCache;
 
 	CongestionCache::TipCongestion* EnumCongestionsInternal();
+	void RequestSyncRanges(CongestionCache::TipCongestion&, const NodeDB::StateID& sidLo);
 
 	struct RecentStates
 	{
@@ -270,9 +308,24 @@ public:
 
 	struct StartParams {
 		bool m_CheckIntegrity = false;
+		uint32_t m_CheckIntegrityThreads = 0; // with m_CheckIntegrity: split the check across threads
+		bool m_CheckAfterCrash = false; // check the recently modified data, if the previous session wasn't shut down properly
 		bool m_Vacuum = false;
+		bool m_IncrementalVacuum = false; // prepare the DB for the online compaction. An existing DB is converted by m_Vacuum
 		bool m_ResetSelfID = false;
 		bool m_EraseSelfID = false;
+		bool m_PersistValCache = false; // save validated tx cache on shutdown, reload on start
+		bool m_VerifyHeaders = false; // verify the whole active headers chain. Used after the snapshot import
+		bool m_SharedDB = false; // allow concurrent read-only DB connections
+		bool m_WalManualCheckpoint = false; // with m_SharedDB: WAL checkpoints are made externally (by a dedicated connection)
+		bool m_BulkLoad = false; // DB bulk-load mode during fast-sync. Fewer indexes and no syncs, the DB may be corrupted on power failure
+		uint64_t m_DbMmapSize = 0; // sqlite memory-mapped I/O size
+		uint8_t m_MmrPinFrom = Merkle::Position::HMax; // MMR levels starting from this one are kept in memory
+		uint64_t m_MemCacheKernelProofs = 0; // in-memory cache budget for kernel proofs served to peers
+		bool m_ExternalBodies = false; // store new block bodies and rollback data outside the DB. Can't be turned off once enabled
+		uint8_t m_MappingHints = 0; // MappedFileRaw::Hint flags for the UTXO image
+		bool m_CompactMapping = false; // rebuild the UTXO image on start if most of it is free space (needs memory for the whole UTXO set)
+		bool m_MappingReport = false; // log the UTXO image footprint on start
 
 		struct RichInfo {
 			static const uint8_t Off = 1;
@@ -292,6 +345,19 @@ public:
 	NodeProcessor();
 	virtual ~NodeProcessor();
 
+	void ExportSnapshot(const char* szPath);
+
+	struct Compaction
+	{
+		uint64_t m_PagesFreed = 0; // total during this session
+		uint64_t m_BytesFreed = 0;
+		uint64_t m_PagesRemaining = 0; // free pages left in the DB file after the last step
+	} m_Compaction;
+
+	// Online compaction, releases the DB free pages (if the DB is in the incremental vacuum mode) within the given time budget.
+	// Returns true if something was released. Changes are committed with the next DB commit.
+	bool CompactStep(uint32_t nBudget_ms);
+
 	void ManualRollbackTo(Height);
 	void ManualSelect(const Block::SystemState::ID&);
 
@@ -310,6 +376,7 @@ public:
 
 		void SetInfinite();
 		void SetStdFastSync(); // Hi is minimum, Lo is 180 days
+		void SetStdPruning(Height hKeep); // same as above, but Lo is the given retention
 
 		void Normalize(); // make sure parameters are consistent w.r.t. each other and MaxRollback
 
@@ -317,6 +384,28 @@ public:
 
 	} m_Horizon;
 
+	struct BatchVerify
+	{
+		// max num of consecutive blocks whose proofs are verified in a single batch. 0 = unlimited.
+		uint32_t m_MaxBlocks = 1000;
+
+		// after a batch failure the range is re-verified with a reduced window, to isolate the offending block(s)
+		uint32_t m_Window = 0;
+		Height m_hWindowEnd = 0;
+
+		uint32_t get_Window(Height) const;
+
+	} m_BatchVerify;
+
+	struct SyncRanges
+	{
+		// during fast-sync the blocks are requested in independent height ranges, to be downloaded concurrently from different peers.
+		// Aligned to multiples of m_Size, so that the range boundaries don't move as the sync progresses.
+		uint32_t m_Count = 1; // 1 = sequential download
+		uint32_t m_Size = 1000;
+
+	} m_SyncRanges;
+
 #pragma pack (push, 1)
 	struct StateExtra
 	{
@@ -402,11 +491,76 @@ public:
 
 	} m_UnreachableLog;
 
+	struct PerfStats
+	{
+#define NodePerfStages(macro) \
+	macro(HdrDownload) \
+	macro(BodyDownload) \
+	macro(Verify) \
+	macro(HandleBlock) \
+	macro(CommitDB) \
+	macro(FlushMapping) \
+	macro(PeerMsg)
+
+		struct Stage
+		{
+			enum Enum {
+#define THE_MACRO(name) name,
+				NodePerfStages(THE_MACRO)
+#undef THE_MACRO
+				count
+			};
+
+			static const char* get_Name(Enum);
+		};
+
+		// may be updated from any thread
+		struct Counter
+		{
+			static const uint32_t s_Buckets = 32; // bucket i: [2^i, 2^(i+1)) microseconds
+
+			std::atomic<uint64_t> m_Count;
+			std::atomic<uint64_t> m_Total_us;
+			std::atomic<uint64_t> m_Max_us;
+			std::atomic<uint64_t> m_pHist[s_Buckets];
+
+			Counter();
+			void Add(uint64_t dt_us);
+			uint64_t get_Quantile_us(uint32_t nPerMille) const; // upper bound of the histogram bucket, 0 if empty
+		};
+
+		Counter m_p[Stage::count];
+
+		// Contract invocations in the interpreted blocks, and the length of their dependency chains (by the var read/write sets).
+		// Kernels/Waves is the speedup achievable by executing the independent invocations concurrently
+		struct Contracts
+		{
+			std::atomic<uint64_t> m_Blocks{ 0 };
+			std::atomic<uint64_t> m_Kernels{ 0 };
+			std::atomic<uint64_t> m_Waves{ 0 };
+		} m_Contracts;
+
+		static uint64_t get_Time_us(); // monotonic
+
+		struct Scope
+		{
+			Counter& m_Counter;
+			uint64_t m_t0_us;
+
+			Scope(Counter& c) :m_Counter(c), m_t0_us(get_Time_us()) {}
+			~Scope() { m_Counter.Add(get_Time_us() - m_t0_us); }
+		};
+
+	} m_PerfStats;
+
 	bool IsFastSync() const { return m_SyncData.m_Target.m_Row != 0; }
 
 	void SaveSyncData();
 	void LogSyncData();
 
+	bool m_bBulkLoad = false;
+	void UpdateBulkLoad(); // bulk-load mode is on iff fast-sync is in progress
+
 	struct ContractInvokeExtraInfoBase
 	{
 		FundsChangeMap m_FundsIO; // including nested
@@ -479,6 +633,7 @@ public:
 	NodeDB& get_DB() { return m_DB; }
 	UtxoTree& get_Utxos() { return m_Mapped.m_Utxo; }
 	RadixHashOnlyTree& get_Contracts() { return m_Mapped.m_Contract; }
+	uint64_t get_MappedSize() const { return m_Mapped.get_Size(); }
 
 	struct Evaluator
 		:public Block::SystemState::Evaluator
@@ -596,6 +751,7 @@ public:
 	{
 		Key::IPKdf::Ptr m_pOwner;
 		std::vector<ShieldedTxo::Viewer> m_vSh;
+		uint32_t m_nEvents = 0; // inserted since the start, the subscribed peers are notified when it changes
 
 		void InitFromOwner();
 		std::string get_Endpoint() const;
@@ -645,16 +801,26 @@ public:
 
 		Mode m_Mode = Mode::SinglePass;
 
+		// coinbase only, the tx pool is skipped. Quick to generate, mined while the full block is being assembled
+		bool m_bEmptyBody = false;
+
+		// out: set if the block is full, the profit of the least profitable included pool tx
+		bool m_bFull = false;
+		TxPool::Stats m_ProfitFloor;
+
 		BlockContext(TxPool::Fluff& txp, Key::Index, Key::IKdf& coin, Key::IPKdf& tag);
 	};
 
 	bool GenerateNewBlock(BlockContext&);
 
 	bool GetBlock(const NodeDB::StateID&, ByteBuffer* pEthernal, ByteBuffer* pPerishable, Height h0, Height hLo1, Height hHi1, bool bActive);
+	// same, w/o copying. Only for full blocks in the body store, the result is valid until the next DB commit
+	bool GetBlockRef(const NodeDB::StateID&, Blob* pEthernal, Blob* pPerishable, Height h0, Height hLo1, Height hHi1);
 
 	struct ITxoWalker
 	{
 		LongAction* m_pLa = nullptr;
+		Output m_Outp; // reused across txos, saves the allocation of proofs per element
 		// override at least one of those
 		virtual bool OnTxo(const NodeDB::WalkerTxo&, Height hCreate);
 		virtual bool OnTxo(const NodeDB::WalkerTxo&, Height hCreate, Output&);
@@ -784,6 +950,12 @@ public:
 
 		void RecognizeBlock(const TxVectors::Full& block, uint32_t shieldedOuts, bool validateShieldedOuts = true);
 
+		// shielded outputs of the block, recognized in advance (in parallel if there's an Executor in scope)
+		struct ShieldedOutsBatch;
+		ShieldedOutsBatch* m_pShieldedOuts = nullptr;
+
+		static bool RecognizeShieldedOut(const Account&, const TxKernelShieldedOutput&, Height, ShieldedTxo::Data::Params&, Key::Index&);
+
 		void Recognize(const Input&);
 		void Recognize(const Output&, Key::IPKdf&);
 
@@ -832,6 +1004,28 @@ public:
 		return m_Mmr.m_Shielded.m_Count - m_Extra.m_ShieldedOutputs;
 	}
 
+	// Bloom filter over the kernel IDs of the DB, at heights m_hLo and above. Negative answer means the kernel is either absent
+	// or below m_hLo. Deleted kernels are not removed (they only add to false positives)
+	struct KrnFilter
+	{
+		static const uint32_t s_Hashes = 4;
+		static const uint32_t s_BitsPerElement = 16;
+
+		std::vector<uint64_t> m_vBits;
+		uint64_t m_nCount = 0;
+		uint64_t m_nMax = 0;
+		Height m_hLo = MaxHeight; // not built
+
+		void Reset(uint64_t nExpected);
+		void Insert(const Merkle::Hash&);
+		bool MayContain(const Merkle::Hash&) const;
+		bool IsFull() const { return m_nCount >= m_nMax; }
+
+	} m_KrnFilter;
+
+	void BuildKrnFilter(Height h);
+	bool IsCoveredByKrnFilter(Height) const;
+
 	struct ValidatedCache
 	{
 		struct Entry
@@ -881,10 +1075,17 @@ public:
 		void OnShLo(const Entry::ShLo::Type& nShLo);
 
 		bool Find(const Entry::Key::Type&); // modifies MRU if found
+		std::atomic<uint64_t> m_Hits{ 0 };
+		std::atomic<uint64_t> m_Misses{ 0 };
 		void Insert(const Entry::Key::Type&, const Entry::ShLo::Type& nShLo);
 
 		void MoveInto(ValidatedCache& dst);
 
+		void Save(NodeDB&) const;
+		void Load(NodeDB&);
+
+		bool m_Persist = false;
+
 	protected:
 		void InsertRaw(Entry&);
 		void RemoveRaw(Entry&);
@@ -923,8 +1124,10 @@ public:
 
 private:
 	size_t GenerateNewBlockInternal(BlockContext&, BlockInterpretCtx&);
+	size_t get_DependentPackageLen(const BlockContext&, const std::vector<const TxPool::Dependent::Element*>&, Height, size_t nSizeAvail);
 	void GenerateNewHdr(BlockContext&, BlockInterpretCtx&);
 	DataStatus::Enum OnStateInternal(const Block::SystemState::Full&, Block::SystemState::ID&, bool bAlreadyChecked);
+	bool IsBlockServable(const NodeDB::StateID&, Height h0, Height& hLo1, Height& hHi1, bool& bFullBlock);
 };
 
 struct LogSid
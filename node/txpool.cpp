@@ -64,12 +64,71 @@ TxPool::Fluff::Element* TxPool::Fluff::AddValidTx(Transaction::Ptr&& pValue, con
 
 	p->m_State = s;
 
+	const auto& vKrn = p->m_pValue->m_vKernels;
+	p->m_nKernels = static_cast<uint32_t>(vKrn.size());
+	if (p->m_nKernels)
+	{
+		p->m_pKernels.reset(new Element::Kernel[p->m_nKernels]);
+		for (uint32_t i = 0; i < p->m_nKernels; i++)
+		{
+			Element::Kernel& k = p->m_pKernels[i];
+			k.m_Key = vKrn[i]->m_Internal.m_ID;
+			k.m_pThis = p;
+			m_setKernels.insert(k);
+		}
+	}
+
+	// the in-memory representation is larger than the serialized, but proportional to it
+	p->m_MemSize = stats.m_Size + static_cast<uint32_t>(sizeof(Element) + sizeof(Element::Kernel) * p->m_nKernels);
+	m_Totals.m_Size += p->m_MemSize;
+
 	Features f0 = { false };
 	SetState(*p, f0, Features::get(s));
 
 	return p;
 }
 
+bool TxPool::Fluff::TryReplace(const Transaction& tx, const Stats& stats)
+{
+	TxPool::Profit prNew;
+	prNew.m_Stats = stats;
+
+	std::vector<Element*> vConflicts;
+
+	for (const auto& pKrn : tx.m_vKernels)
+	{
+		const Merkle::Hash& hv = pKrn->m_Internal.m_ID;
+		for (auto it = m_setKernels.lower_bound(hv, Element::Kernel::Comparator()); (m_setKernels.end() != it) && (it->m_Key == hv); ++it)
+		{
+			Element& x = *it->m_pThis;
+			if ((State::Outdated != x.m_State) && !(prNew < x.m_Profit))
+				return false;
+
+			if (vConflicts.end() == std::find(vConflicts.begin(), vConflicts.end(), &x))
+				vConflicts.push_back(&x);
+		}
+	}
+
+	for (Element* p : vConflicts)
+	{
+		Delete(*p);
+		m_Totals.m_Replaced++;
+	}
+
+	return true;
+}
+
+TxPool::Fluff::Element* TxPool::Fluff::get_EvictCandidate()
+{
+	if (!m_lstOutdated.empty())
+		return &m_lstOutdated.front().get_ParentObj();
+
+	if (!m_setProfit.empty())
+		return &m_setProfit.rbegin()->get_ParentObj();
+
+	return nullptr;
+}
+
 TxPool::Fluff::Features TxPool::Fluff::Features::get(State s)
 {
 	Features ret = { false };
@@ -167,9 +226,22 @@ void TxPool::Fluff::Delete(Element& x)
 	Features f = { false };
 	SetState(x, f0, f);
 
+	for (uint32_t i = 0; i < x.m_nKernels; i++)
+		m_setKernels.erase(KernelSet::s_iterator_to(x.m_pKernels[i]));
+
+	assert(m_Totals.m_Size >= x.m_MemSize);
+	m_Totals.m_Size -= x.m_MemSize;
+
 	delete &x;
 }
 
+void TxPool::Fluff::Evict(Element& x)
+{
+	m_Totals.m_Evicted++;
+	m_Totals.m_EvictedSize += x.m_MemSize;
+	Delete(x);
+}
+
 void TxPool::Fluff::Release(Element::Send& x)
 {
 	assert(x.m_Refs);
@@ -237,6 +309,137 @@ bool TxPool::Stem::TryMerge(Element& trg, Element& src)
 	return true;
 }
 
+struct TxPool::Stem::BatchGroup
+{
+	std::vector<Element*> m_vElems;
+	HeightRange m_Hr;
+	Transaction m_Tx; // combined
+
+	void Combine()
+	{
+		if (m_vElems.size() < 2)
+			return;
+
+		std::vector<TxVectors::Reader> vReaders;
+		std::vector<TxBase::IReader*> vPtrs;
+		vReaders.reserve(m_vElems.size());
+
+		ECC::Scalar::Native offset(Zero);
+
+		for (const Element* p : m_vElems)
+		{
+			vReaders.push_back(p->m_pValue->get_Reader());
+			vPtrs.push_back(&vReaders.back());
+			offset += ECC::Scalar::Native(p->m_pValue->m_Offset);
+		}
+
+		TxVectors::Writer wtx(m_Tx, m_Tx);
+		volatile bool bStop = false;
+		wtx.Combine(&vPtrs.front(), static_cast<int>(vPtrs.size()), bStop);
+
+		m_Tx.m_Offset = offset;
+	}
+};
+
+void TxPool::Stem::AggregateBatch(Executor& ex, uint32_t nOutputsMax, std::vector<Element*>& vRes)
+{
+	std::vector<BatchGroup> vGroups;
+	uint32_t nOuts = 0;
+
+	for (auto it = m_setProfit.begin(); m_setProfit.end() != it; ++it)
+	{
+		Element& x = it->get_ParentObj();
+		uint32_t n = static_cast<uint32_t>(x.m_pValue->m_vOutputs.size());
+
+		HeightRange hr = x.m_Profit.m_Stats.m_Hr;
+		bool bNew = vGroups.empty() || (nOuts + n > nOutputsMax);
+		if (!bNew)
+		{
+			hr.Intersect(vGroups.back().m_Hr);
+			bNew = hr.IsEmpty();
+		}
+
+		if (bNew)
+		{
+			vGroups.emplace_back();
+			hr = x.m_Profit.m_Stats.m_Hr;
+			nOuts = 0;
+		}
+
+		BatchGroup& g = vGroups.back();
+		g.m_vElems.push_back(&x);
+		g.m_Hr = hr;
+		nOuts += n;
+	}
+
+	struct Task
+		:public Executor::TaskSync
+	{
+		std::vector<BatchGroup>* m_pGroups;
+
+		virtual void Exec(Executor::Context& ctx) override
+		{
+			uint32_t i0, nCount;
+			ctx.get_Portion(i0, nCount, static_cast<uint32_t>(m_pGroups->size()));
+
+			for (; nCount--; i0++)
+				(*m_pGroups)[i0].Combine();
+		}
+	} t;
+
+	t.m_pGroups = &vGroups;
+	ex.ExecAll(t);
+
+	for (BatchGroup& g : vGroups)
+	{
+		Element& trg = *g.m_vElems.front();
+		vRes.push_back(&trg);
+
+		if (g.m_vElems.size() < 2)
+			continue;
+
+		Amount fees = 0;
+		uint32_t nSizeCorrection = 0;
+		for (const Element* p : g.m_vElems)
+		{
+			fees += p->m_Profit.m_Stats.m_Fee;
+			nSizeCorrection += p->m_Profit.m_Stats.m_SizeCorrection;
+		}
+
+		Amount feeReserve = 0;
+		if (ValidateTxContext(g.m_Tx, g.m_Hr, fees, feeReserve))
+		{
+			trg.m_Profit.m_Stats.m_Fee = fees;
+			trg.m_Profit.m_Stats.m_FeeReserve = feeReserve;
+			trg.m_Profit.m_Stats.m_Hr = g.m_Hr;
+			trg.m_Profit.m_Stats.SetSize(g.m_Tx);
+			trg.m_Profit.m_Stats.m_SizeCorrection = nSizeCorrection;
+
+			trg.m_pValue->m_vInputs.swap(g.m_Tx.m_vInputs);
+			trg.m_pValue->m_vOutputs.swap(g.m_Tx.m_vOutputs);
+			trg.m_pValue->m_vKernels.swap(g.m_Tx.m_vKernels);
+			trg.m_pValue->m_Offset = g.m_Tx.m_Offset;
+
+			for (size_t i = 1; i < g.m_vElems.size(); i++)
+				Delete(*g.m_vElems[i]);
+		}
+		else
+		{
+			// conflicting txs within the group
+			for (size_t i = 1; i < g.m_vElems.size(); i++)
+			{
+				Element& src = *g.m_vElems[i];
+				if (!TryMerge(trg, src))
+					vRes.push_back(&src); // remains on its own
+			}
+		}
+
+		// profit changed
+		DeleteAggr(trg);
+		InsertAggr(trg);
+	}
+}
+
 void TxPool::Stem::Delete(Element& x)
 {
 	uint32_t n_ms;
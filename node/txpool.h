@@ -17,6 +17,7 @@
 #include "../utility/containers.h"
 #include "../core/block_crypt.h"
 #include "../utility/io/timer.h"
+#include "../utility/executor.h"
 
 namespace beam {
 
@@ -81,25 +82,53 @@ struct TxPool
 				uint32_t m_Refs = 0;
 			};
 			Send* m_pSend = nullptr;
+
+			struct Kernel
+				:public intrusive::set_base_hook<Merkle::Hash>
+			{
+				Element* m_pThis;
+			};
+			std::unique_ptr<Kernel[]> m_pKernels; // index of the top-level kernels, to detect conflicts
+			uint32_t m_nKernels;
+
+			uint32_t m_MemSize; // estimated
 		};
 
 		typedef boost::intrusive::multiset<Element::Tx> TxSet;
 		typedef boost::intrusive::multiset<Element::Profit> ProfitSet;
 		typedef boost::intrusive::list<Element::Hist> HistList;
 		typedef boost::intrusive::list<Element::Send> SendQueue;
+		typedef boost::intrusive::multiset<Element::Kernel> KernelSet;
 
 		TxSet m_setTxs;
 		ProfitSet m_setProfit;
 		SendQueue m_SendQueue;
 		HistList m_lstOutdated;
 		HistList m_lstWaitFluff;
+		KernelSet m_setKernels; // all the elements, regardless to the state
+
+		struct Totals
+		{
+			uint64_t m_Size = 0; // estimated memory of all the elements
+			uint64_t m_Evicted = 0; // due to the pool limits
+			uint64_t m_EvictedSize = 0;
+			uint64_t m_Replaced = 0; // by a more profitable tx with a conflicting kernel
+		} m_Totals;
 
 		Element* AddValidTx(Transaction::Ptr&&, const Stats&, const Transaction::KeyType&, State, Height hLst = 0);
 		void SetState(Element&, State);
 		void Delete(Element&);
+		void Evict(Element&);
 		void Release(Element::Send&);
 		void Clear();
 
+		// Elements that share a kernel with the given tx are deleted if it's more profitable (outdated are deleted anyway).
+		// Returns false (and deletes nothing) if any of the conflicting elements is at least as profitable.
+		bool TryReplace(const Transaction&, const Stats&);
+
+		// The evicted element is the outdated (oldest first) or the least profitable, nullptr if only pre-fluffed remain
+		Element* get_EvictCandidate();
+
 		~Fluff() { Clear(); }
 
 	private:
@@ -159,6 +188,11 @@ struct TxPool
 
 		bool TryMerge(Element& trg, Element& src);
 
+		// Batch aggregation of all the pending elements. They're grouped in profit order (up to nOutputsMax outputs per group, with overlapping height ranges),
+		// the groups are combined in parallel, and each combined tx is validated once. A group that fails the validation falls back to the pairwise merge.
+		// Returns the resulting elements (one per group).
+		void AggregateBatch(Executor&, uint32_t nOutputsMax, std::vector<Element*>& vRes);
+
 		Element* get_NextTimeout(uint32_t& nTimeout_ms);
 		void SetTimer(uint32_t nTimeout_ms, Element&);
 		void KillTimer();
@@ -174,6 +208,8 @@ struct TxPool
 	private:
 		void DeleteRaw(Element&);
 		void SetTimerRaw(uint32_t nTimeout_ms);
+
+		struct BatchGroup;
 	};
 
 	struct Dependent
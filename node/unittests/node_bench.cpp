@@ -0,0 +1,601 @@
+// Copyright 2018 The Beam Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Block import throughput benchmark.
+// Generates a synthetic chain with the given tx mix per block, then imports it into a fresh NodeProcessor (headers, bodies,
+// then the interpretation), and prints the throughput and the time split by the processing stage (NodeProcessor::PerfStats).
+// The output is CSV: metric,value
+//
+// node_bench [--blocks N] [--plain K] [--shielded K] [--assets K] [--threads N]
+
+#include <chrono>
+#include <map>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../processor.h"
+#include "../../core/treasury.h"
+#include "../../core/shielded.h"
+
+namespace beam
+{
+	struct BenchCfg
+	{
+		uint32_t m_Blocks = 200;
+		uint32_t m_Plain = 50; // per block, 1 input, 2 confidential outputs
+		uint32_t m_Shielded = 0; // shielded outputs
+		uint32_t m_Assets = 0; // asset emissions (an asset is created first)
+		uint32_t m_Threads = 0; // verification threads, 0 - single-threaded
+	} g_Cfg;
+
+	const char* g_szGen = "node_bench_gen.db";
+	const char* g_szImp = "node_bench.db";
+
+	ByteBuffer g_Treasury;
+
+	struct BlockPlus
+	{
+		Block::SystemState::Full m_Hdr;
+		ByteBuffer m_BodyP;
+		ByteBuffer m_BodyE;
+	};
+
+	std::vector<BlockPlus> g_vBlocks;
+	uint64_t g_nKernels = 0;
+	uint64_t g_nSize = 0;
+
+	void PrepareTreasury()
+	{
+		Key::IKdf::Ptr pKdf;
+		ECC::HKdf::Create(pKdf, Zero);
+
+		PeerID pid;
+		ECC::Scalar::Native sk;
+		Treasury::get_ID(*pKdf, pid, sk);
+
+		Treasury tres;
+		Treasury::Parameters pars;
+		pars.m_Bursts = 1;
+		Treasury::Entry* pE = tres.CreatePlan(pid, Rules::get().Emission.Value0 / 5, pars);
+
+		pE->m_pResponse.reset(new Treasury::Response);
+		uint64_t nIndex = 1;
+		pE->m_pResponse->Create(pE->m_Request, *pKdf, nIndex);
+
+		Treasury::Data data;
+		data.m_sCustomMsg = "bench treasury";
+		tres.Build(data);
+
+		Serializer ser;
+		ser & data;
+		ser.swap_buf(g_Treasury);
+
+		ECC::Hash::Processor() << Blob(g_Treasury) >> Rules::get().TreasuryChecksum;
+	}
+
+	class Generator
+		:public NodeProcessor
+	{
+		Key::IKdf::Ptr m_pKdf;
+		uint64_t m_nIdx = 0;
+		std::multimap<Height, CoinID> m_mapCoins; // by maturity
+
+		Asset::ID m_AssetID = 0;
+		bool m_AssetPending = false;
+		Asset::Metadata m_AssetMeta;
+
+		static void UpdateOffset(Transaction& tx, const ECC::Scalar::Native& k, bool bOutput)
+		{
+			ECC::Scalar::Native offs = tx.m_Offset;
+			if (bOutput)
+				offs += -k;
+			else
+				offs += k;
+			tx.m_Offset = offs;
+		}
+
+		Amount AddInput(Transaction& tx, Height h)
+		{
+			auto it = m_mapCoins.begin();
+			if ((m_mapCoins.end() == it) || (it->first > h))
+				return 0;
+
+			ECC::Scalar::Native k;
+			Input::Ptr pInp(new Input);
+			CoinID::Worker(it->second).Create(k, pInp->m_Commitment, *m_pKdf);
+
+			tx.m_vInputs.push_back(std::move(pInp));
+			UpdateOffset(tx, k, false);
+
+			Amount val = it->second.m_Value;
+			m_mapCoins.erase(it);
+			return val;
+		}
+
+		void AddOutput(Transaction& tx, Height h, Amount val)
+		{
+			CoinID cid(Zero);
+			cid.m_Value = val;
+			cid.m_Idx = ++m_nIdx;
+			cid.m_Type = Key::Type::Regular;
+
+			ECC::Scalar::Native k;
+			Output::Ptr pOut(new Output);
+			pOut->Create(h + 1, k, *m_pKdf, cid, *m_pKdf);
+
+			tx.m_vOutputs.push_back(std::move(pOut));
+			UpdateOffset(tx, k, true);
+
+			m_mapCoins.insert(std::make_pair(h + 1, cid));
+		}
+
+		void AddKernel(Transaction& tx, Height h, Amount fee)
+		{
+			ECC::Scalar::Native k;
+			m_pKdf->DeriveKey(k, Key::ID(++m_nIdx, Key::Type::Kernel));
+
+			TxKernelStd::Ptr pKrn(new TxKernelStd);
+			pKrn->m_Fee = fee;
+			pKrn->m_Height.m_Min = h + 1;
+			pKrn->Sign(k);
+
+			tx.m_vKernels.push_back(std::move(pKrn));
+			UpdateOffset(tx, k, true);
+		}
+
+		// spends a coin, the rest (after the fee and the specified amount) goes to the change
+		Amount StartTx(Transaction::Ptr& pTx, Height h, Amount fee, Amount valMin)
+		{
+			pTx = std::make_shared<Transaction>();
+			pTx->m_Offset = Zero;
+
+			Amount val = AddInput(*pTx, h);
+			if (val < fee + valMin)
+				return 0; // the coin is lost, whatever
+
+			return val - fee;
+		}
+
+		void FinishTx(Transaction::Ptr&& pTx, Height h)
+		{
+			pTx->Normalize();
+
+			Transaction::Context ctx;
+			ctx.m_Height.m_Min = h + 1;
+			if (!pTx->IsValid(ctx))
+			{
+				fprintf(stderr, "Generated tx is invalid\n");
+				return;
+			}
+
+			Transaction::KeyType key;
+			pTx->get_Key(key);
+
+			TxPool::Stats stats;
+			stats.From(*pTx, ctx, 0, 0);
+
+			m_TxPool.AddValidTx(std::move(pTx), stats, key, TxPool::Fluff::State::Fluffed);
+		}
+
+		bool MakePlain(Height h)
+		{
+			Amount fee = Transaction::FeeSettings::get(h + 1).get_DefaultStd();
+
+			Transaction::Ptr pTx;
+			Amount val = StartTx(pTx, h, fee, 2);
+			if (!val)
+				return false;
+
+			AddKernel(*pTx, h, fee);
+			AddOutput(*pTx, h, val / 2);
+			AddOutput(*pTx, h, val - val / 2);
+
+			FinishTx(std::move(pTx), h);
+			return true;
+		}
+
+		bool MakeShielded(Height h)
+		{
+			auto& fs = Transaction::FeeSettings::get(h + 1);
+			Amount fee = fs.get_DefaultStd() + fs.m_ShieldedOutputTotal;
+
+			Transaction::Ptr pTx;
+			Amount val = StartTx(pTx, h, fee, 2);
+			if (!val)
+				return false;
+
+			Amount valSh = val / 2;
+			AddOutput(*pTx, h, val - valSh);
+
+			TxKernelShieldedOutput::Ptr pKrn(new TxKernelShieldedOutput);
+			pKrn->m_Height.m_Min = h + 1;
+			pKrn->m_Fee = fee;
+
+			ShieldedTxo::Viewer viewer;
+			viewer.FromOwner(*m_pKdf, 0);
+
+			ShieldedTxo::Data::Params sdp;
+			sdp.m_Ticket.Generate(pKrn->m_Txo.m_Ticket, viewer, ECC::Hash::Value(++m_nIdx));
+			sdp.m_Output.m_Value = valSh;
+			ZeroObject(sdp.m_Output.m_User);
+
+			pKrn->UpdateMsg();
+			ECC::Oracle oracle;
+			oracle << pKrn->m_Msg;
+
+			sdp.GenerateOutp(pKrn->m_Txo, h + 1, oracle);
+			pKrn->MsgToID();
+
+			pTx->m_vKernels.push_back(std::move(pKrn));
+			UpdateOffset(*pTx, sdp.m_Output.m_k, true);
+
+			FinishTx(std::move(pTx), h);
+			return true;
+		}
+
+		bool MakeAssetCreate(Height h)
+		{
+			Amount fee = Transaction::FeeSettings::get(h + 1).get_DefaultStd();
+			Amount nLock = Rules::get().get_DepositForCA(h + 1);
+
+			Transaction::Ptr pTx;
+			Amount val = StartTx(pTx, h, fee + nLock, 0);
+			if (!val)
+				return false;
+
+			AddOutput(*pTx, h, val);
+
+			m_AssetMeta.set_String("bench", false);
+
+			ECC::Scalar::Native sk;
+			m_pKdf->DeriveKey(sk, Key::ID(++m_nIdx, Key::Type::Kernel));
+
+			TxKernelAssetCreate::Ptr pKrn(new TxKernelAssetCreate);
+			pKrn->m_Fee = fee;
+			pKrn->m_Height.m_Min = h + 1;
+			pKrn->m_MetaData = m_AssetMeta;
+			pKrn->Sign(sk, *m_pKdf);
+
+			pTx->m_vKernels.push_back(std::move(pKrn));
+			UpdateOffset(*pTx, sk, true);
+
+			FinishTx(std::move(pTx), h);
+			return true;
+		}
+
+		bool MakeAssetEmit(Height h)
+		{
+			Amount fee = Transaction::FeeSettings::get(h + 1).get_DefaultStd();
+
+			Transaction::Ptr pTx;
+			Amount val = StartTx(pTx, h, fee, 0);
+			if (!val)
+				return false;
+
+			AddOutput(*pTx, h, val);
+
+			CoinID cid(Zero);
+			cid.m_Value = 100500;
+			cid.m_AssetID = m_AssetID;
+			cid.m_Idx = ++m_nIdx;
+
+			ECC::Scalar::Native sk, skOut;
+			m_pKdf->DeriveKey(sk, Key::ID(++m_nIdx, Key::Type::Kernel));
+
+			TxKernelAssetEmit::Ptr pKrn(new TxKernelAssetEmit);
+			pKrn->m_AssetID = m_AssetID;
+			pKrn->m_Fee = fee;
+			pKrn->m_Value = cid.m_Value;
+			pKrn->m_Height.m_Min = h + 1;
+			pKrn->Sign(sk, *m_pKdf, m_AssetMeta);
+
+			Output::Ptr pOut(new Output);
+			pOut->Create(h + 1, skOut, *m_pKdf, cid, *m_pKdf);
+
+			pTx->m_vOutputs.push_back(std::move(pOut));
+			UpdateOffset(*pTx, skOut, true);
+
+			pTx->m_vKernels.push_back(std::move(pKrn));
+			UpdateOffset(*pTx, sk, true);
+
+			FinishTx(std::move(pTx), h);
+			return true;
+		}
+
+		void MakeTxs(Height h)
+		{
+			for (uint32_t i = 0; i < g_Cfg.m_Plain; i++)
+				if (!MakePlain(h))
+					break;
+
+			if (!Rules::get().IsPastFork_<2>(h + 1))
+				return;
+
+			for (uint32_t i = 0; i < g_Cfg.m_Shielded; i++)
+				if (!MakeShielded(h))
+					break;
+
+			if (g_Cfg.m_Assets)
+			{
+				if (m_AssetID)
+				{
+					for (uint32_t i = 0; i < g_Cfg.m_Assets; i++)
+						if (!MakeAssetEmit(h))
+							break;
+				}
+				else
+				{
+					if (!m_AssetPending)
+						m_AssetPending = MakeAssetCreate(h);
+				}
+			}
+		}
+
+	public:
+		TxPool::Fluff m_TxPool;
+
+		Generator()
+		{
+			ECC::Hash::Value hv;
+			ECC::GenRandom(hv);
+			ECC::HKdf::Create(m_pKdf, hv);
+		}
+
+		bool GenerateOne()
+		{
+			Height h = m_Cursor.m_ID.m_Height;
+			MakeTxs(h);
+
+			BlockContext bc(m_TxPool, 0, *m_pKdf, *m_pKdf);
+			if (!GenerateNewBlock(bc))
+				return false;
+
+			if (bc.m_bFull)
+				fprintf(stderr, "Block %u is full, the tx mix is truncated\n", (uint32_t) (h + 1));
+
+			m_TxPool.Clear(); // the leftovers may be already double-spent
+
+			Block::SystemState::ID id;
+			bc.m_Hdr.get_ID(id);
+
+			OnState(bc.m_Hdr, PeerID());
+			OnBlock(id, bc.m_BodyP, bc.m_BodyE, PeerID());
+			TryGoUp();
+
+			if (m_Cursor.m_ID.m_Height != h + 1)
+				return false;
+
+			m_mapCoins.insert(std::make_pair(h + 1 + Rules::get().Maturity.Coinbase, CoinID(Rules::get_Emission(h + 1), h + 1, Key::Type::Coinbase)));
+			if (bc.m_Fees)
+				m_mapCoins.insert(std::make_pair(h + 1, CoinID(bc.m_Fees, h + 1, Key::Type::Comission)));
+
+			if (m_AssetPending)
+			{
+				Asset::Full ai;
+				ai.m_ID = 1; // the only asset in this chain
+				if (get_DB().AssetGetSafe(ai))
+				{
+					m_AssetID = ai.m_ID;
+					m_AssetPending = false;
+				}
+			}
+
+			g_nKernels += bc.m_Block.m_vKernels.size();
+			g_nSize += bc.m_BodyP.size() + bc.m_BodyE.size();
+
+			auto& b = g_vBlocks.emplace_back();
+			b.m_Hdr = bc.m_Hdr;
+			b.m_BodyP = std::move(bc.m_BodyP);
+			b.m_BodyE = std::move(bc.m_BodyE);
+
+			return true;
+		}
+	};
+
+	class Importer
+		:public NodeProcessor
+	{
+		struct MyExecutorMT
+			:public ExecutorMT_R
+		{
+			void RunThread(uint32_t iThread) override
+			{
+				MyExecutor::MyContext ctx;
+				ctx.m_iThread = iThread;
+				ECC::InnerProduct::BatchContext::Scope scope(ctx.m_BatchCtx);
+
+				RunThreadCtx(ctx);
+			}
+
+			~MyExecutorMT() { Stop(); }
+		};
+
+		std::unique_ptr<MyExecutorMT> m_pExecutorMT;
+
+	public:
+		Importer()
+		{
+			if (g_Cfg.m_Threads)
+			{
+				m_pExecutorMT = std::make_unique<MyExecutorMT>();
+				m_pExecutorMT->set_Threads(g_Cfg.m_Threads);
+			}
+		}
+
+		Executor& get_Executor() override
+		{
+			if (m_pExecutorMT)
+				return *m_pExecutorMT;
+			return NodeProcessor::get_Executor();
+		}
+	};
+
+	double get_Elapsed_ms(std::chrono::steady_clock::time_point t0)
+	{
+		return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+	}
+
+	void PrintMetric(const char* szName, double val)
+	{
+		printf("%s,%.3f\n", szName, val);
+	}
+
+	int RunBench()
+	{
+		DeleteFile(g_szGen);
+		DeleteFile(g_szImp);
+
+		printf("metric,value\n");
+
+		{
+			Generator gen;
+			gen.Initialize(g_szGen);
+			gen.OnTreasury(g_Treasury);
+
+			auto t0 = std::chrono::steady_clock::now();
+
+			for (uint32_t i = 0; i < g_Cfg.m_Blocks; i++)
+			{
+				if (!gen.GenerateOne())
+				{
+					fprintf(stderr, "Block generation failed at %u\n", i);
+					return 1;
+				}
+			}
+
+			PrintMetric("gen_ms", get_Elapsed_ms(t0));
+		}
+
+		DeleteFile(g_szGen);
+
+		PrintMetric("blocks", (double) g_vBlocks.size());
+		PrintMetric("kernels", (double) g_nKernels);
+		PrintMetric("body_bytes", (double) g_nSize);
+
+		Importer imp;
+		imp.Initialize(g_szImp);
+		imp.OnTreasury(g_Treasury);
+
+		auto tStart = std::chrono::steady_clock::now();
+		auto t0 = tStart;
+
+		for (const auto& b : g_vBlocks)
+			imp.OnState(b.m_Hdr, PeerID());
+
+		double dtHdrs_ms = get_Elapsed_ms(t0);
+		t0 = std::chrono::steady_clock::now();
+
+		for (const auto& b : g_vBlocks)
+		{
+			Block::SystemState::ID id;
+			b.m_Hdr.get_ID(id);
+			imp.OnBlock(id, b.m_BodyP, b.m_BodyE, PeerID());
+		}
+
+		double dtBodies_ms = get_Elapsed_ms(t0);
+		t0 = std::chrono::steady_clock::now();
+
+		imp.TryGoUp();
+
+		double dtApply_ms = get_Elapsed_ms(t0);
+		double dtTotal_s = get_Elapsed_ms(tStart) * 1e-3;
+
+		if (imp.m_Cursor.m_ID.m_Height != g_vBlocks.size())
+		{
+			fprintf(stderr, "Import stopped at %u\n", (uint32_t) imp.m_Cursor.m_ID.m_Height);
+			return 1;
+		}
+
+		PrintMetric("import.headers_ms", dtHdrs_ms);
+		PrintMetric("import.bodies_ms", dtBodies_ms);
+		PrintMetric("import.apply_ms", dtApply_ms);
+		PrintMetric("import.blocks_per_s", double(g_vBlocks.size()) / dtTotal_s);
+		PrintMetric("import.kernels_per_s", double(g_nKernels) / dtTotal_s);
+		PrintMetric("import.MB_per_s", double(g_nSize) / dtTotal_s / double(1 << 20));
+
+		// the processing stages, as accounted by the processor itself
+		for (uint32_t i = 0; i < NodeProcessor::PerfStats::Stage::count; i++)
+		{
+			const auto& c = imp.m_PerfStats.m_p[i];
+			if (!c.m_Count)
+				continue;
+
+			std::string sPrefix = "stage.";
+			sPrefix += NodeProcessor::PerfStats::Stage::get_Name(static_cast<NodeProcessor::PerfStats::Stage::Enum>(i));
+
+			PrintMetric((sPrefix + ".count").c_str(), (double) c.m_Count);
+			PrintMetric((sPrefix + ".total_ms").c_str(), (double) c.m_Total_us * 1e-3);
+			PrintMetric((sPrefix + ".p99_us").c_str(), (double) c.get_Quantile_us(990));
+			PrintMetric((sPrefix + ".max_us").c_str(), (double) c.m_Max_us);
+		}
+
+		return 0;
+	}
+
+} // namespace beam
+
+int main(int argc, char* argv[])
+{
+	using namespace beam;
+
+	for (int i = 1; i + 1 < argc; i += 2)
+	{
+		const char* szArg = argv[i];
+		uint32_t nVal = static_cast<uint32_t>(atoi(argv[i + 1]));
+
+		if (!strcmp(szArg, "--blocks"))
+			g_Cfg.m_Blocks = nVal;
+		else if (!strcmp(szArg, "--plain"))
+			g_Cfg.m_Plain = nVal;
+		else if (!strcmp(szArg, "--shielded"))
+			g_Cfg.m_Shielded = nVal;
+		else if (!strcmp(szArg, "--assets"))
+			g_Cfg.m_Assets = nVal;
+		else if (!strcmp(szArg, "--threads"))
+			g_Cfg.m_Threads = nVal;
+		else
+		{
+			fprintf(stderr, "Unknown option %s\n", szArg);
+			return 2;
+		}
+	}
+
+	// all the forks from the start, cheap PoW, short coinbase maturity, cheap assets
+	Rules& r = Rules::get();
+	r.FakePoW = true;
+	r.CA.Enabled = true;
+	r.CA.DepositForList2 = r.CA.DepositForList5 = Rules::Coin;
+	r.Maturity.Coinbase = 1;
+	for (uint32_t i = 1; i < _countof(r.pForks); i++)
+		r.pForks[i].m_Height = Rules::HeightGenesis + 1;
+	r.UpdateChecksum();
+
+	PrepareTreasury();
+
+	int ret = 0;
+	try
+	{
+		ret = RunBench();
+	}
+	catch (const std::exception& ex)
+	{
+		fprintf(stderr, "Error: %s\n", ex.what());
+		ret = 1;
+	}
+
+	DeleteFile(g_szGen);
+	DeleteFile(g_szImp);
+
+	return ret;
+}
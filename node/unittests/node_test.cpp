@@ -18,12 +18,12 @@
 #include "../db.h"
 #include "../processor.h"
 #include "../../core/fly_client.h"
-#include "../../core/serialization_adapters.h"
+#include "../../core/serialization_adapters.h"
 #include "../../core/treasury.h"
 #include "../../core/block_rw.h"
 #include "../../utility/test_helpers.h"
-#include "../../utility/serialize.h"
-#include "../../utility/blobmap.h"
+#include "../../utility/serialize.h"
+#include "../../utility/blobmap.h"
 #include "../../core/unittest/mini_blockchain.h"
 #include "../../bvm/bvm2.h"
 #include "../../bvm/ManagerStd.h"
@@ -167,29 +167,29 @@ namespace beam
 		Key::IKdf::Ptr pKdf;
 		ECC::SetRandom(pKdf);
 
-		PeerID pid;
-		ECC::Scalar::Native sk;
-		Treasury::get_ID(*pKdf, pid, sk);
-
-		Treasury tres;
-		Treasury::Parameters pars;
-		pars.m_Bursts = 1;
-		Treasury::Entry* pE = tres.CreatePlan(pid, Rules::get().Emission.Value0 / 5, pars);
-
-		pE->m_pResponse.reset(new Treasury::Response);
-		uint64_t nIndex = 1;
-		verify_test(pE->m_pResponse->Create(pE->m_Request, *pKdf, nIndex));
-
-		Treasury::Data data;
-		data.m_sCustomMsg = "test treasury";
-		tres.Build(data);
-
-		beam::Serializer ser;
-		ser & data;
-
-		ser.swap_buf(g_Treasury);
-
-		ECC::Hash::Processor() << Blob(g_Treasury) >> Rules::get().TreasuryChecksum;
+		PeerID pid;
+		ECC::Scalar::Native sk;
+		Treasury::get_ID(*pKdf, pid, sk);
+
+		Treasury tres;
+		Treasury::Parameters pars;
+		pars.m_Bursts = 1;
+		Treasury::Entry* pE = tres.CreatePlan(pid, Rules::get().Emission.Value0 / 5, pars);
+
+		pE->m_pResponse.reset(new Treasury::Response);
+		uint64_t nIndex = 1;
+		verify_test(pE->m_pResponse->Create(pE->m_Request, *pKdf, nIndex));
+
+		Treasury::Data data;
+		data.m_sCustomMsg = "test treasury";
+		tres.Build(data);
+
+		beam::Serializer ser;
+		ser & data;
+
+		ser.swap_buf(g_Treasury);
+
+		ECC::Hash::Processor() << Blob(g_Treasury) >> Rules::get().TreasuryChecksum;
 	}
 
 	uint32_t CountTips(NodeDB& db, bool bFunctional, NodeDB::StateID* pLast = NULL)
@@ -214,27 +214,27 @@ namespace beam
 
 	struct StoragePts
 	{
-		ECC::Point::Storage m_pArr[18];
-
-		void Init()
-		{
-			for (size_t i = 0; i < _countof(m_pArr); i++)
-			{
-				m_pArr[i].m_X = i;
-			}
-		}
-
-		bool IsValid(size_t i0, size_t i1, uint32_t n0) const
-		{
-			for (; i0 < i1; i0++)
-			{
-				if (m_pArr[i0].m_X != ECC::uintBig(n0++))
-					return false;
-			}
-
-			return true;
-		}
-	};
+		ECC::Point::Storage m_pArr[18];
+
+		void Init()
+		{
+			for (size_t i = 0; i < _countof(m_pArr); i++)
+			{
+				m_pArr[i].m_X = i;
+			}
+		}
+
+		bool IsValid(size_t i0, size_t i1, uint32_t n0) const
+		{
+			for (; i0 < i1; i0++)
+			{
+				if (m_pArr[i0].m_X != ECC::uintBig(n0++))
+					return false;
+			}
+
+			return true;
+		}
+	};
 
 	void TestNodeDB(const char* sz)
 	{
@@ -395,16 +395,16 @@ namespace beam
 			sid.m_Row = pRows[sid.m_Height - Rules::HeightGenesis];
 			db.MoveFwd(sid);
 			
-			Merkle::Hash hv;
-			if (sid.m_Height < Rules::HeightGenesis + 50) // skip it for big heights, coz it's quadratic
-			{
+			Merkle::Hash hv;
+			if (sid.m_Height < Rules::HeightGenesis + 50) // skip it for big heights, coz it's quadratic
+			{
 				for (Height h = Rules::HeightGenesis; h < sid.m_Height; h++)
 				{
 					Merkle::ProofBuilderStd bld;
 					smmr.get_Proof(bld, smmr.H2I(h));
 
-					vStates[h - Rules::HeightGenesis].get_Hash(hv);
-					Merkle::Interpret(hv, bld.m_Proof);
+					vStates[h - Rules::HeightGenesis].get_Hash(hv);
+					Merkle::Interpret(hv, bld.m_Proof);
 					verify_test(hvRoot == hv);
 				}
 			}
@@ -412,7 +412,7 @@ namespace beam
 			const Block::SystemState::Full& sTop = vStates[sid.m_Height - Rules::HeightGenesis];
 
 			hv = hvRoot;
-			Merkle::Interpret(hv, hvZero, true);
+			Merkle::Interpret(hv, hvZero, true);
 			verify_test(hv == sTop.m_Definition);
 
 			sTop.get_Hash(hv);
@@ -468,13 +468,19 @@ namespace beam
 			d.m_Address = i * 17;
 			d.m_LastSeen = i + 10;
 			d.m_Rating = i * 100 + 50;
+			d.m_Rtt_ms = i * 3;
+			d.m_LastGood = i + 5;
 
 			db.PeerIns(d);
 		}
 
 		NodeDB::WalkerPeer wlkp;
 		for (db.EnumPeers(wlkp); wlkp.MoveNext(); )
-			;
+		{
+			uint32_t i = static_cast<uint32_t>(wlkp.m_Data.m_Address / 17);
+			verify_test(wlkp.m_Data.m_Rtt_ms == i * 3);
+			verify_test(wlkp.m_Data.m_LastGood == i + 5);
+		}
 
 		db.PeersDel();
 
@@ -522,194 +528,194 @@ namespace beam
 
 		verify_test(db.GetDummyHeight(kid) == MaxHeight);
 
-		db.InsertDummy(176, kid);
-
-		kid.m_Idx = 346;
-		db.InsertDummy(568, kid);
+		db.InsertDummy(176, kid);
+
+		kid.m_Idx = 346;
+		db.InsertDummy(568, kid);
 
-		kid.m_Idx = 345;
+		kid.m_Idx = 345;
 		verify_test(db.GetDummyHeight(kid) == 176);
-
-		Height h1 = db.GetLowestDummy(kid);
-		verify_test(h1 == 176);
-		verify_test(kid.m_Idx == 345U);
-
-		db.SetDummyHeight(kid, 1055);
-
-		h1 = db.GetLowestDummy(kid);
-		verify_test(h1 == 568);
-		verify_test(kid.m_Idx == 346U);
-		
-		db.DeleteDummy(kid);
-
-		h1 = db.GetLowestDummy(kid);
-		verify_test(h1 == 1055);
-		verify_test(kid.m_Idx == 345U);
-
-		db.DeleteDummy(kid);
-
-		verify_test(MaxHeight == db.GetLowestDummy(kid));
-
-		// Kernels
-		db.InsertKernel(bBodyP, 5);
-		db.InsertKernel(bBodyP, 5); // duplicate
-		db.InsertKernel(bBodyP, 7);
-		db.InsertKernel(bBodyP, 2);
-
-		verify_test(db.FindKernel(bBodyP) == 7);
-		verify_test(db.FindKernel(bBodyE) == 0);
-
-		db.DeleteKernel(bBodyP, 7);
-		verify_test(db.FindKernel(bBodyP) == 5);
-		db.DeleteKernel(bBodyP, 5);
-		verify_test(db.FindKernel(bBodyP) == 5);
-		db.DeleteKernel(bBodyP, 2);
-		verify_test(db.FindKernel(bBodyP) == 5);
-		db.DeleteKernel(bBodyP, 5);
-		verify_test(db.FindKernel(bBodyP) == 0);
-
-		// Shielded
-		TxoID nShielded = 16 * 1024 * 3 + 5;
-		db.ShieldedResize(nShielded, 0);
-
-		StoragePts pts;
-		pts.Init();
-
-		db.ShieldedWrite(16 * 1024 * 2 - 2, pts.m_pArr, _countof(pts.m_pArr));
-
-		ZeroObject(pts.m_pArr);
-
-		db.ShieldedRead(16 * 1024 * 3 + 5 - _countof(pts.m_pArr), pts.m_pArr, _countof(pts.m_pArr));
-		verify_test(memis0(pts.m_pArr, sizeof(pts.m_pArr)));
-
-		db.ShieldedRead(16 * 1024 * 2 -2, pts.m_pArr, _countof(pts.m_pArr));
-		verify_test(pts.IsValid(0, _countof(pts.m_pArr), 0));
-
-		db.ShieldedResize(1, nShielded);
-		db.ShieldedResize(0, 1);
-
-		ECC::uintBig k1 = 223U;
-		Blob val(nullptr, 0);
-
-		verify_test(db.UniqueInsertSafe(k1, &val));
-		db.UniqueDeleteStrict(k1);
-		verify_test(db.UniqueInsertSafe(k1, nullptr));
-		verify_test(!db.UniqueInsertSafe(k1, nullptr));
-
-
-		// Assets
-		Asset::Full ai1, ai2;
-		ZeroObject(ai1);
-
-		for (uint32_t i = 1; i <= 5; i++)
-		{
-			ai1.m_ID = 0;
-			db.AssetAdd(ai1);
-			verify_test(ai1.m_ID == i);
-		}
-
-		verify_test(db.AssetDelete(5) == 4); // should shrink
-		verify_test(db.AssetDelete(3) == 4); // should retain the same size
-
-		ai2.m_ID = 3;
-		verify_test(!db.AssetGetSafe(ai2));
-		ai2.m_ID = 2;
-		verify_test(db.AssetGetSafe(ai2));
-		verify_test(ai2.m_Owner == ai1.m_Owner);
-
-		ai1.m_Owner.Inc();
-		ai1.m_Owner.Negate();
-		ai1.m_ID = 0;
-		db.AssetAdd(ai1);
-		verify_test(ai1.m_ID == 3);
-
-		AmountBig::Type assetVal1, assetVal2 = 1U;
-		ai2.m_ID = 3;
-		verify_test(db.AssetGetSafe(ai2));
-		verify_test(ai2.m_Value == Zero);
-
-		assetVal2 = 334U;
-		db.AssetSetValue(3, assetVal2, 18);
-
-		verify_test(db.AssetGetSafe(ai2));
-		verify_test(ai2.m_Value == assetVal2);
-		verify_test(ai2.m_LockHeight == 18);
-
-		ai1.m_ID = db.AssetFindByOwner(ai1.m_Owner);
-		verify_test(ai1.m_ID == 3);
-		ai1.m_Value = Zero;
-		verify_test(db.AssetGetSafe(ai1));
-		verify_test(ai1.m_Value == assetVal2);
-
-		verify_test(db.AssetDelete(2) == 4);
-		verify_test(db.AssetDelete(3) == 4);
-		verify_test(db.AssetDelete(4) == 1);
-		verify_test(db.AssetDelete(1) == 0);
-
-		// StreamMmr, test cache
-		struct MyMmr
-			:public NodeDB::StreamMmr
-		{
-			using StreamMmr::StreamMmr;
-			uint32_t m_Total = 0;
-			uint32_t m_Miss = 0;
-
-			virtual void LoadElement(Merkle::Hash& hv, const Merkle::Position& pos) const override
-			{
-				Cast::NotConst(this)->m_Total++;
-				if (!CacheFind(hv, pos))
-				{
-					Cast::NotConst(this)->m_Miss++;
-					StreamMmr::LoadElement(hv, pos);
-				}
-			}
-		};
-
-		MyMmr myMmr(db, NodeDB::StreamType::ShieldedMmr, true);
-
-		for (uint32_t i = 0; i < 40; i++)
-		{
-			Merkle::Hash hv = i;
-			myMmr.Append(hv);
-			myMmr.get_Hash(hv);
-		}
-
-		// in a 'friendly' scenario, where we only add and calculate root - cache must be 100% effective
-		verify_test(!myMmr.m_Miss);
-
+
+		Height h1 = db.GetLowestDummy(kid);
+		verify_test(h1 == 176);
+		verify_test(kid.m_Idx == 345U);
+
+		db.SetDummyHeight(kid, 1055);
+
+		h1 = db.GetLowestDummy(kid);
+		verify_test(h1 == 568);
+		verify_test(kid.m_Idx == 346U);
+		
+		db.DeleteDummy(kid);
+
+		h1 = db.GetLowestDummy(kid);
+		verify_test(h1 == 1055);
+		verify_test(kid.m_Idx == 345U);
+
+		db.DeleteDummy(kid);
+
+		verify_test(MaxHeight == db.GetLowestDummy(kid));
+
+		// Kernels
+		db.InsertKernel(bBodyP, 5);
+		db.InsertKernel(bBodyP, 5); // duplicate
+		db.InsertKernel(bBodyP, 7);
+		db.InsertKernel(bBodyP, 2);
+
+		verify_test(db.FindKernel(bBodyP) == 7);
+		verify_test(db.FindKernel(bBodyE) == 0);
+
+		db.DeleteKernel(bBodyP, 7);
+		verify_test(db.FindKernel(bBodyP) == 5);
+		db.DeleteKernel(bBodyP, 5);
+		verify_test(db.FindKernel(bBodyP) == 5);
+		db.DeleteKernel(bBodyP, 2);
+		verify_test(db.FindKernel(bBodyP) == 5);
+		db.DeleteKernel(bBodyP, 5);
+		verify_test(db.FindKernel(bBodyP) == 0);
+
+		// Shielded
+		TxoID nShielded = 16 * 1024 * 3 + 5;
+		db.ShieldedResize(nShielded, 0);
+
+		StoragePts pts;
+		pts.Init();
+
+		db.ShieldedWrite(16 * 1024 * 2 - 2, pts.m_pArr, _countof(pts.m_pArr));
+
+		ZeroObject(pts.m_pArr);
+
+		db.ShieldedRead(16 * 1024 * 3 + 5 - _countof(pts.m_pArr), pts.m_pArr, _countof(pts.m_pArr));
+		verify_test(memis0(pts.m_pArr, sizeof(pts.m_pArr)));
+
+		db.ShieldedRead(16 * 1024 * 2 -2, pts.m_pArr, _countof(pts.m_pArr));
+		verify_test(pts.IsValid(0, _countof(pts.m_pArr), 0));
+
+		db.ShieldedResize(1, nShielded);
+		db.ShieldedResize(0, 1);
+
+		ECC::uintBig k1 = 223U;
+		Blob val(nullptr, 0);
+
+		verify_test(db.UniqueInsertSafe(k1, &val));
+		db.UniqueDeleteStrict(k1);
+		verify_test(db.UniqueInsertSafe(k1, nullptr));
+		verify_test(!db.UniqueInsertSafe(k1, nullptr));
+
+
+		// Assets
+		Asset::Full ai1, ai2;
+		ZeroObject(ai1);
+
+		for (uint32_t i = 1; i <= 5; i++)
+		{
+			ai1.m_ID = 0;
+			db.AssetAdd(ai1);
+			verify_test(ai1.m_ID == i);
+		}
+
+		verify_test(db.AssetDelete(5) == 4); // should shrink
+		verify_test(db.AssetDelete(3) == 4); // should retain the same size
+
+		ai2.m_ID = 3;
+		verify_test(!db.AssetGetSafe(ai2));
+		ai2.m_ID = 2;
+		verify_test(db.AssetGetSafe(ai2));
+		verify_test(ai2.m_Owner == ai1.m_Owner);
+
+		ai1.m_Owner.Inc();
+		ai1.m_Owner.Negate();
+		ai1.m_ID = 0;
+		db.AssetAdd(ai1);
+		verify_test(ai1.m_ID == 3);
+
+		AmountBig::Type assetVal1, assetVal2 = 1U;
+		ai2.m_ID = 3;
+		verify_test(db.AssetGetSafe(ai2));
+		verify_test(ai2.m_Value == Zero);
+
+		assetVal2 = 334U;
+		db.AssetSetValue(3, assetVal2, 18);
+
+		verify_test(db.AssetGetSafe(ai2));
+		verify_test(ai2.m_Value == assetVal2);
+		verify_test(ai2.m_LockHeight == 18);
+
+		ai1.m_ID = db.AssetFindByOwner(ai1.m_Owner);
+		verify_test(ai1.m_ID == 3);
+		ai1.m_Value = Zero;
+		verify_test(db.AssetGetSafe(ai1));
+		verify_test(ai1.m_Value == assetVal2);
+
+		verify_test(db.AssetDelete(2) == 4);
+		verify_test(db.AssetDelete(3) == 4);
+		verify_test(db.AssetDelete(4) == 1);
+		verify_test(db.AssetDelete(1) == 0);
+
+		// StreamMmr, test cache
+		struct MyMmr
+			:public NodeDB::StreamMmr
+		{
+			using StreamMmr::StreamMmr;
+			uint32_t m_Total = 0;
+			uint32_t m_Miss = 0;
+
+			virtual void LoadElement(Merkle::Hash& hv, const Merkle::Position& pos) const override
+			{
+				Cast::NotConst(this)->m_Total++;
+				if (!CacheFind(hv, pos))
+				{
+					Cast::NotConst(this)->m_Miss++;
+					StreamMmr::LoadElement(hv, pos);
+				}
+			}
+		};
+
+		MyMmr myMmr(db, NodeDB::StreamType::ShieldedMmr, true);
+
+		for (uint32_t i = 0; i < 40; i++)
+		{
+			Merkle::Hash hv = i;
+			myMmr.Append(hv);
+			myMmr.get_Hash(hv);
+		}
+
+		// in a 'friendly' scenario, where we only add and calculate root - cache must be 100% effective
+		verify_test(!myMmr.m_Miss);
+
 		tr.Commit();
 
-		// Contract data
-		NodeDB::Recordset rs;
-		Blob blob1;
-		ECC::Hash::Value hvKey = 234U, hvVal = 1232U, hvKey2;
-		verify_test(!db.ContractDataFind(hvKey, blob1, rs));
-
-		blob1 = hvKey;
-		verify_test(!db.ContractDataFindNext(blob1, rs));
-
-		db.ContractDataInsert(hvKey, hvVal);
-		verify_test(!db.ContractDataFindNext(blob1, rs));
-
-		hvVal.Inc();
-		db.ContractDataUpdate(hvKey, hvVal);
-
-		verify_test(db.ContractDataFind(hvKey, blob1, rs));
-		verify_test(Blob(hvVal) == blob1);
-
-		blob1 = hvKey2;
-		hvKey2 = hvKey;
-		hvKey2.Inc();
-		verify_test(!db.ContractDataFindNext(blob1, rs));
-
-		hvKey2 = hvKey;
-		hvKey2.Negate();
-		hvKey2 += ECC::Hash::Value(2U);
-		hvKey2.Negate();
-		verify_test(db.ContractDataFindNext(blob1, rs));
-		verify_test(Blob(hvKey) == blob1);
-
-		db.ContractDataDel(hvKey);
+		// Contract data
+		NodeDB::Recordset rs;
+		Blob blob1;
+		ECC::Hash::Value hvKey = 234U, hvVal = 1232U, hvKey2;
+		verify_test(!db.ContractDataFind(hvKey, blob1, rs));
+
+		blob1 = hvKey;
+		verify_test(!db.ContractDataFindNext(blob1, rs));
+
+		db.ContractDataInsert(hvKey, hvVal);
+		verify_test(!db.ContractDataFindNext(blob1, rs));
+
+		hvVal.Inc();
+		db.ContractDataUpdate(hvKey, hvVal);
+
+		verify_test(db.ContractDataFind(hvKey, blob1, rs));
+		verify_test(Blob(hvVal) == blob1);
+
+		blob1 = hvKey2;
+		hvKey2 = hvKey;
+		hvKey2.Inc();
+		verify_test(!db.ContractDataFindNext(blob1, rs));
+
+		hvKey2 = hvKey;
+		hvKey2.Negate();
+		hvKey2 += ECC::Hash::Value(2U);
+		hvKey2.Negate();
+		verify_test(db.ContractDataFindNext(blob1, rs));
+		verify_test(Blob(hvKey) == blob1);
+
+		db.ContractDataDel(hvKey);
 		verify_test(!db.ContractDataFind(hvKey, blob1, rs));
 
 		// contract logs
@@ -751,6 +757,61 @@ namespace beam
 		verify_test(wlkCdl.MoveNext());
 		verify_test(!wlkCdl.MoveNext());
 
+		// Txos, split full value
+		{
+			uint8_t pFull[0x40] = { 0x4 };
+			uint8_t pNaked[0x21] = { 0 };
+
+			Blob blobFull(pFull, sizeof(pFull));
+			db.TxoAdd(100, Blob(pNaked, sizeof(pNaked)), &blobFull);
+			db.TxoAdd(101, Blob(pNaked, sizeof(pNaked)), nullptr);
+
+			NodeDB::WalkerTxo wlk;
+			db.TxoGetValue(wlk, 100);
+			verify_test(wlk.m_Value.n == sizeof(pFull));
+			db.TxoGetNaked(wlk, 100);
+			verify_test(wlk.m_Value.n == sizeof(pNaked));
+
+			uint32_t nCount = 0;
+			for (db.EnumTxos(wlk, 100); wlk.MoveNext(); nCount++)
+				verify_test(wlk.m_Value.n == ((100 == wlk.m_ID) ? sizeof(pFull) : sizeof(pNaked)));
+			verify_test(2 == nCount);
+
+			db.TxoSetValue(100, Blob(pNaked, sizeof(pNaked))); // drops the full value
+			db.TxoGetValue(wlk, 100);
+			verify_test(wlk.m_Value.n == sizeof(pNaked));
+
+			db.TxoDelFrom(100);
+			db.EnumTxos(wlk, 100);
+			verify_test(!wlk.MoveNext());
+
+			// batched
+			const uint32_t nTxos = NodeDB::InsertBatch::s_Rows * 2 + 5;
+			std::vector<TxoID> vIDs;
+			{
+				NodeDB::TxoAdder ta(db);
+				for (uint32_t i = 0; i < nTxos; i++)
+				{
+					ta.Add(100 + i, Blob(pNaked, sizeof(pNaked)), (i & 1) ? &blobFull : nullptr);
+					vIDs.push_back(100 + i);
+				}
+				ta.Flush();
+			}
+
+			db.TxoSetSpent(&vIDs.front(), vIDs.size(), 7);
+
+			nCount = 0;
+			for (db.EnumTxos(wlk, 100); wlk.MoveNext(); nCount++)
+			{
+				verify_test(wlk.m_ID == 100 + nCount);
+				verify_test(wlk.m_SpendHeight == 7);
+				verify_test(wlk.m_Value.n == ((1 & nCount) ? sizeof(pFull) : sizeof(pNaked)));
+			}
+			verify_test(nTxos == nCount);
+
+			db.TxoDelFrom(100);
+		}
+
 		// Cache
 		{
 			ECC::Hash::Value key1 = 1U;
@@ -793,6 +854,30 @@ namespace beam
 
 			db.get_CacheState(cs);
 			verify_test(cs.m_SizeCurrent == 0);
+
+			// in-memory tier, budget for 2 elements
+			const NodeDB::CacheCategory::Enum eCat = NodeDB::CacheCategory::KernelProof;
+			db.CacheSetMemMaxSize(eCat, (sizeof(NodeDB::MemCache::Entry) + key1.nBytes * 2) * 2);
+
+			db.CacheInsert(key1, key1, eCat);
+			db.CacheInsert(key2, key2, eCat);
+			verify_test(db.get_MemCacheStats(eCat).m_Count == 2);
+			verify_test(db.CacheFind(key1, buf, eCat));
+			verify_test(Blob(buf) == Blob(key1));
+
+			db.CacheInsert(key3, key3, eCat); // should throw out key2
+			verify_test(!db.CacheFind(key2, buf, eCat));
+			verify_test(db.CacheFind(key3, buf, eCat));
+			verify_test(!db.CacheFind(key3, buf)); // other category
+
+			const NodeDB::MemCache::Stats& s = db.get_MemCacheStats(eCat);
+			verify_test((s.m_Hits == 2) && (s.m_Misses == 1) && (s.m_SizeCurrent <= s.m_SizeMax));
+
+			db.get_CacheState(cs);
+			verify_test(cs.m_SizeCurrent == 0); // not saved in the DB
+
+			db.CacheSetMemMaxSize(eCat, 0);
+			verify_test(!db.get_MemCacheStats(eCat).m_Count);
 		}
 
 		{
@@ -839,6 +924,137 @@ namespace beam
 			NodeDB db;
 			db.Open(g_sz); // test to open already-existing DB
 		}
+
+		{
+			// bulk-load mode persists until explicitly ended
+			NodeDB db;
+			db.Open(g_sz);
+
+			NodeDB::Transaction t(db);
+			db.BulkLoadBegin();
+			verify_test(db.IsBulkLoad());
+			t.Commit();
+		}
+
+		{
+			NodeDB db;
+			db.Open(g_sz);
+			verify_test(db.IsBulkLoad());
+
+			NodeDB::Transaction t(db);
+			db.BulkLoadEnd();
+			verify_test(!db.IsBulkLoad());
+			t.Commit();
+		}
+
+		{
+			// WAL mode, checkpoints are made by a dedicated connection
+			NodeDB db;
+			db.Open(g_sz, true);
+			db.SetWalManualCheckpoint();
+
+			NodeDB::Transaction t(db);
+			db.ParamIntSet(NodeDB::ParamID::LastRecoveryHeight, 15);
+			t.Commit();
+
+			NodeDB dbCp;
+			dbCp.OpenCheckpointer(g_sz);
+			verify_test(dbCp.WalCheckpoint());
+
+			NodeDB dbR;
+			dbR.OpenReadOnly(g_sz);
+			verify_test(dbR.ParamIntGetDef(NodeDB::ParamID::LastRecoveryHeight) == 15);
+		}
+
+		{
+			// online compaction
+			NodeDB db;
+			db.Open(g_sz);
+			verify_test(db.IsIncrementalVacuum()); // created in this mode
+
+			std::vector<uint8_t> vBig(0x10000, 0x5a);
+			const uint32_t nTxos = 64;
+
+			NodeDB::Transaction t(db);
+			for (uint32_t i = 0; i < nTxos; i++)
+				db.TxoAdd(1000 + i, Blob(&vBig.front(), static_cast<uint32_t>(vBig.size())), nullptr);
+			t.Commit();
+
+			t.Start(db);
+			db.TxoDelFrom(1000);
+			t.Commit();
+
+			uint64_t nFree = db.get_FreePages();
+			verify_test(nFree);
+
+			uint64_t nFreed = 0;
+			t.Start(db);
+			while (true)
+			{
+				uint32_t n = db.VacuumStep(16);
+				if (!n)
+					break;
+				verify_test(n <= 16);
+				nFreed += n;
+			}
+			t.Commit();
+
+			verify_test(nFreed == nFree);
+			verify_test(!db.get_FreePages());
+		}
+	}
+
+	void TestFluffPool()
+	{
+		TxPool::Fluff txp;
+
+		auto fnMakeTx = [](uint32_t iKrn, Transaction::Ptr& pTx, Transaction::KeyType& key)
+		{
+			pTx = std::make_shared<Transaction>();
+			TxKernelStd::Ptr pKrn = std::make_unique<TxKernelStd>();
+			pKrn->m_Internal.m_ID = iKrn;
+			pTx->m_vKernels.push_back(std::move(pKrn));
+			pTx->m_Offset = ECC::Scalar(ECC::Scalar::Native(iKrn));
+			pTx->get_Key(key);
+		};
+
+		TxPool::Stats stats;
+		ZeroObject(stats);
+		stats.m_Size = 1000;
+
+		Transaction::Ptr pTx;
+		Transaction::KeyType key;
+
+		stats.m_Fee = 100;
+		fnMakeTx(1, pTx, key);
+		verify_test(txp.TryReplace(*pTx, stats));
+		txp.AddValidTx(std::move(pTx), stats, key, TxPool::Fluff::State::Fluffed);
+
+		uint64_t nSize = txp.m_Totals.m_Size;
+		verify_test(nSize > stats.m_Size);
+
+		// same kernel, not more profitable
+		fnMakeTx(1, pTx, key);
+		verify_test(!txp.TryReplace(*pTx, stats));
+
+		// more profitable replaces
+		stats.m_Fee = 200;
+		verify_test(txp.TryReplace(*pTx, stats));
+		verify_test(txp.m_setTxs.empty() && !txp.m_Totals.m_Size);
+		verify_test(txp.m_Totals.m_Replaced == 1);
+		txp.AddValidTx(std::move(pTx), stats, key, TxPool::Fluff::State::Fluffed);
+
+		stats.m_Fee = 50;
+		fnMakeTx(2, pTx, key);
+		verify_test(txp.TryReplace(*pTx, stats));
+		txp.AddValidTx(std::move(pTx), stats, key, TxPool::Fluff::State::Fluffed);
+
+		// the least profitable is evicted first
+		TxPool::Fluff::Element* pDel = txp.get_EvictCandidate();
+		verify_test(pDel && (pDel->m_Profit.m_Stats.m_Fee == 50));
+		txp.Evict(*pDel);
+		verify_test(txp.m_Totals.m_Evicted == 1);
+		verify_test(txp.m_Totals.m_Size == nSize);
 	}
 
 	struct MiniWallet
@@ -1068,6 +1284,112 @@ namespace beam
 		ByteBuffer m_BodyE;
 	};
 
+	void TestInvSketch()
+	{
+		proto::InvSketch sk0, sk1;
+		sk0.Init(100);
+		sk1.Init(100);
+		verify_test(sk0.IsValid() && !(sk0.m_vCount.size() % proto::InvSketch::s_Hashes));
+
+		// large common part, small difference
+		for (uint64_t i = 0; i < 5000; i++)
+		{
+			uint64_t id = i * 0x123456789ULL + 7;
+			sk0.Add(id);
+			sk1.Add(id);
+		}
+
+		for (uint64_t i = 1; i <= 20; i++)
+			sk0.Add(i << 40);
+		for (uint64_t i = 1; i <= 15; i++)
+			sk1.Add((i << 40) + 1);
+
+		proto::InvSketch sk = sk0;
+		sk.Subtract(sk1);
+
+		std::vector<uint64_t> vPos, vNeg;
+		verify_test(sk.Decode(vPos, vNeg));
+		verify_test((vPos.size() == 20) && (vNeg.size() == 15));
+
+		std::sort(vPos.begin(), vPos.end());
+		for (uint64_t i = 1; i <= 20; i++)
+			verify_test(vPos[i - 1] == (i << 40));
+
+		// difference too large
+		for (uint64_t i = 1; i <= 500; i++)
+			sk0.Add((i << 32) + 3);
+
+		sk = sk0;
+		sk.Subtract(sk1);
+		vPos.clear();
+		vNeg.clear();
+		verify_test(!sk.Decode(vPos, vNeg));
+	}
+
+	void TestBbsStore()
+	{
+		BbsStore st;
+
+		BbsStore::Data d;
+		d.m_Message.p = "hello";
+		d.m_Message.n = 5;
+		d.m_Nonce = 0;
+
+		// out-of-order posted times
+		for (uint32_t i = 0; i < 300; i++)
+		{
+			d.m_Key = i;
+			d.m_Channel = i % 7;
+			d.m_TimePosted = 1000 + (i * 37) % 500;
+			st.Insert(d);
+		}
+
+		verify_test((st.m_Totals.m_Count == 300) && (st.m_Totals.m_Size == 1500));
+
+		d.m_Key = 17U;
+		const BbsStore::Element* pElem = st.Find(d.m_Key);
+		verify_test(pElem && (pElem->get_ID() == 18));
+		d.m_Key = 300U;
+		verify_test(!st.Find(d.m_Key));
+
+		for (BbsChannel ch = 0; ch < 7; ch++)
+		{
+			uint32_t n = 0;
+			for (BbsStore::Element* p = st.get_Next(ch, 0); p; p = st.get_Next(ch, p->get_ID()), n++)
+				verify_test(p->m_ByChannel.m_Key.m_Channel == ch);
+			verify_test(n == (300 + 6 - ch) / 7);
+		}
+
+		for (Timestamp t = 990; t < 1510; t += 7)
+		{
+			uint64_t id = st.m_LastID + 1;
+			for (BbsStore::Element* p = st.get_Next(0); p; p = st.get_Next(p->get_ID()))
+				if (p->m_TimePosted >= t)
+				{
+					id = p->get_ID();
+					break;
+				}
+
+			verify_test(st.FindCursor(t) == id);
+		}
+
+		verify_test(st.get_MaxTime() == 1499);
+
+		st.DeleteOlder(1250);
+
+		uint32_t n = 0;
+		for (BbsStore::Element* p = st.get_Next(0); p; p = st.get_Next(p->get_ID()), n++)
+			verify_test(p->m_TimePosted >= 1250);
+		verify_test(n == st.m_Totals.m_Count);
+		verify_test(n == 153);
+
+		st.Delete(*st.get_Oldest());
+		verify_test(st.m_Totals.m_Count == 152);
+
+		st.DeleteOlder(2000);
+		verify_test(!st.m_Totals.m_Count && !st.m_Totals.m_Size && st.m_mapBuckets.empty());
+	}
+
 	void TestNodeProcessor1(std::vector<BlockPlus::Ptr>& blockChain)
 	{
 		MyNodeProcessor1 np;
@@ -1249,6 +1571,68 @@ namespace beam
 			np.Initialize(g_sz, sp);
 		}
 
+		{
+			NodeProcessor np;
+			np.m_Horizon = horz;
+
+			NodeProcessor::StartParams sp;
+			sp.m_CheckIntegrity = true;
+			sp.m_CheckIntegrityThreads = 4;
+			sp.m_CheckAfterCrash = true;
+			np.Initialize(g_sz, sp);
+
+			np.get_DB().CheckIntegrityRecent(Rules::HeightGenesis);
+		}
+
+		{
+			// snapshot bootstrap
+			DeleteFile(g_sz2);
+			DeleteFile(g_sz3);
+
+			Block::SystemState::ID id;
+			{
+				NodeProcessor np;
+				np.m_Horizon = horz;
+				np.Initialize(g_sz);
+				np.ExportSnapshot(g_sz3);
+				id = np.m_Cursor.m_ID;
+			}
+
+			NodeDB::ImportSnapshot(g_sz3, g_sz2);
+
+			NodeProcessor np;
+			np.m_Horizon = horz;
+
+			NodeProcessor::StartParams sp;
+			sp.m_CheckIntegrity = true;
+			sp.m_VerifyHeaders = true;
+			np.Initialize(g_sz2, sp);
+
+			verify_test(np.m_Cursor.m_ID == id);
+		}
+
+		DeleteFile(g_sz2);
+		DeleteFile(g_sz3);
+
+		{
+			// multi-block rollback, as deep as allowed
+			NodeProcessor np;
+			np.m_Horizon = horz;
+			np.Initialize(g_sz);
+
+			Height h0 = np.m_Cursor.m_ID.m_Height;
+			Height h1 = np.get_LowestManualReturnHeight();
+			verify_test(h1 < h0);
+
+			uint64_t t0_us = metrics::Histogram::get_Time_us();
+			np.ManualRollbackTo(h1);
+			uint64_t dt_us = metrics::Histogram::get_Time_us() - t0_us;
+
+			printf("Rollback of %u blocks: %u us\n", (unsigned int) (h0 - np.m_Cursor.m_ID.m_Height), (unsigned int) dt_us);
+
+			verify_test(np.m_Cursor.m_ID.m_Height < h0);
+			verify_test(np.m_Cursor.m_ID.m_Height >= h1);
+		}
 	}
 
 	void TestNodeProcessor3(std::vector<BlockPlus::Ptr>& blockChain)
@@ -1299,27 +1683,27 @@ namespace beam
 
 			if (!bTampered)
 			{
-				Deserializer der;
-				der.reset(bbP);
-
-				Block::BodyBase bbb;
-				TxVectors::Perishable txvp;
-				der & bbb;
-				der & txvp;
-
-				verify_test(txvp.m_vInputs.empty()); // may contain only treasury, but we don't spend it in the test
-
-				if (!txvp.m_vOutputs.empty())
-				{
-					txvp.m_vOutputs.pop_back();
-
-					Serializer ser;
-					ser & bbb;
-					ser & txvp;
-					ser.swap_buf(bbP);
-
-					bTampered = true;
-				}
+				Deserializer der;
+				der.reset(bbP);
+
+				Block::BodyBase bbb;
+				TxVectors::Perishable txvp;
+				der & bbb;
+				der & txvp;
+
+				verify_test(txvp.m_vInputs.empty()); // may contain only treasury, but we don't spend it in the test
+
+				if (!txvp.m_vOutputs.empty())
+				{
+					txvp.m_vOutputs.pop_back();
+
+					Serializer ser;
+					ser & bbb;
+					ser & txvp;
+					ser.swap_buf(bbP);
+
+					bTampered = true;
+				}
 			}
 
 			Block::SystemState::ID id;
@@ -1346,22 +1730,22 @@ namespace beam
 
 			if (!bTampered)
 			{
-				Deserializer der;
-				der.reset(bbP);
-
-				Block::BodyBase bbb;
-				TxVectors::Perishable txvp;
-				der & bbb;
-				der & txvp;
-
-				bbb.m_Offset.m_Value.Inc();
-
-				Serializer ser;
-				ser & bbb;
-				ser & txvp;
-				ser.swap_buf(bbP);
-
-				bTampered = true;
+				Deserializer der;
+				der.reset(bbP);
+
+				Block::BodyBase bbb;
+				TxVectors::Perishable txvp;
+				der & bbb;
+				der & txvp;
+
+				bbb.m_Offset.m_Value.Inc();
+
+				Serializer ser;
+				ser & bbb;
+				ser & txvp;
+				ser.swap_buf(bbP);
+
+				bTampered = true;
 			}
 
 			Block::SystemState::ID id;
@@ -1387,32 +1771,32 @@ namespace beam
 
 			if (!bTampered)
 			{
-				Deserializer der;
-				der.reset(bbP);
-
-				Block::BodyBase bbb;
-				TxVectors::Perishable txvp;
-				der & bbb;
-				der & txvp;
-
-				for (size_t j = 0; j < txvp.m_vOutputs.size(); j++)
-				{
-					Output& outp = *txvp.m_vOutputs[j];
-					if (outp.m_pConfidential)
-					{
-						outp.m_pConfidential->m_P_Tag.m_pCondensed[0].m_Value.Inc();
-						bTampered = true;
-						break;
-					}
-				}
-
-				if (bTampered)
-				{
-					Serializer ser;
-					ser & bbb;
-					ser & txvp;
-					ser.swap_buf(bbP);
-				}
+				Deserializer der;
+				der.reset(bbP);
+
+				Block::BodyBase bbb;
+				TxVectors::Perishable txvp;
+				der & bbb;
+				der & txvp;
+
+				for (size_t j = 0; j < txvp.m_vOutputs.size(); j++)
+				{
+					Output& outp = *txvp.m_vOutputs[j];
+					if (outp.m_pConfidential)
+					{
+						outp.m_pConfidential->m_P_Tag.m_pCondensed[0].m_Value.Inc();
+						bTampered = true;
+						break;
+					}
+				}
+
+				if (bTampered)
+				{
+					Serializer ser;
+					ser & bbb;
+					ser & txvp;
+					ser.swap_buf(bbP);
+				}
 			}
 
 			Block::SystemState::ID id;
@@ -1447,33 +1831,33 @@ namespace beam
 
 			if (!bTampered)
 			{
-				Deserializer der;
-				der.reset(bbP);
-
-				Block::BodyBase bbb;
-				TxVectors::Perishable txvp;
-				der & bbb;
-				der & txvp;
-
-				for (size_t j = 0; j < txvp.m_vOutputs.size(); j++)
-				{
-					Output& outp = *txvp.m_vOutputs[j];
-					if (outp.m_pConfidential || outp.m_pPublic)
-					{
-						outp.m_pConfidential.reset();
-						outp.m_pPublic.reset();
-						bTampered = true;
-						break;
-					}
-				}
-
-				if (bTampered)
-				{
-					Serializer ser;
-					ser & bbb;
-					ser & txvp;
-					ser.swap_buf(bbP);
-				}
+				Deserializer der;
+				der.reset(bbP);
+
+				Block::BodyBase bbb;
+				TxVectors::Perishable txvp;
+				der & bbb;
+				der & txvp;
+
+				for (size_t j = 0; j < txvp.m_vOutputs.size(); j++)
+				{
+					Output& outp = *txvp.m_vOutputs[j];
+					if (outp.m_pConfidential || outp.m_pPublic)
+					{
+						outp.m_pConfidential.reset();
+						outp.m_pPublic.reset();
+						bTampered = true;
+						break;
+					}
+				}
+
+				if (bTampered)
+				{
+					Serializer ser;
+					ser & bbb;
+					ser & txvp;
+					ser.swap_buf(bbP);
+				}
 			}
 
 			Block::SystemState::ID id;
@@ -1509,33 +1893,33 @@ namespace beam
 
 			if (!hTampered)
 			{
-				Deserializer der;
-				der.reset(bbP);
-
-				Block::BodyBase bbb;
-				TxVectors::Perishable txvp;
-				der & bbb;
-				der & txvp;
-
-				for (size_t j = 0; j < txvp.m_vOutputs.size(); j++)
-				{
-					Output& outp = *txvp.m_vOutputs[j];
-					if (outp.m_pConfidential || outp.m_pPublic)
-					{
-						outp.m_pConfidential.reset();
-						outp.m_pPublic.reset();
-						hTampered = h;
-						break;
-					}
-				}
-
-				if (hTampered)
-				{
-					Serializer ser;
-					ser & bbb;
-					ser & txvp;
-					ser.swap_buf(bbP);
-				}
+				Deserializer der;
+				der.reset(bbP);
+
+				Block::BodyBase bbb;
+				TxVectors::Perishable txvp;
+				der & bbb;
+				der & txvp;
+
+				for (size_t j = 0; j < txvp.m_vOutputs.size(); j++)
+				{
+					Output& outp = *txvp.m_vOutputs[j];
+					if (outp.m_pConfidential || outp.m_pPublic)
+					{
+						outp.m_pConfidential.reset();
+						outp.m_pPublic.reset();
+						hTampered = h;
+						break;
+					}
+				}
+
+				if (hTampered)
+				{
+					Serializer ser;
+					ser & bbb;
+					ser & txvp;
+					ser.swap_buf(bbP);
+				}
 			}
 
 			Block::SystemState::ID id;
@@ -1705,8 +2089,8 @@ namespace beam
 			Key::IPKdf::Ptr m_pOwner2;
 			uint32_t m_nUnrecognized = 0;
 
-			virtual bool OnUtxo(Height h, const Output& outp) override
-			{
+			virtual bool OnUtxo(Height h, const Output& outp) override
+			{
 				CoinID cid;
 				bool b1 = outp.Recover(h, *m_pOwner1, cid);
 				bool b2 = outp.Recover(h, *m_pOwner2, cid);
@@ -1716,9 +2100,9 @@ namespace beam
 					m_nUnrecognized++;
 					verify_test(m_nUnrecognized <= 1);
 				}
-
-				return true;
-			}
+
+				return true;
+			}
 		} parser;
 		parser.m_pOwner1 = node.m_Keys.m_pOwner;
 		parser.m_pOwner2 = node2.m_Keys.m_pOwner;
@@ -1786,6 +2170,8 @@ namespace beam
 
 			std::set<ECC::Point> m_UtxosBeingSpent;
 			std::list<ECC::Point> m_queProofsExpected;
+			std::list<std::vector<ECC::Point> > m_queProofsBatchExpected;
+			std::list<std::vector<ECC::Point> > m_queProofsMultiExpected;
 			std::list<uint32_t> m_queProofsStateExpected;
 			std::list<uint32_t> m_queProofsKrnExpected;
 			uint32_t m_nChainWorkProofsPending = 0;
@@ -1875,6 +2261,8 @@ namespace beam
 			{
 				return
 					m_queProofsExpected.empty() &&
+					m_queProofsBatchExpected.empty() &&
+					m_queProofsMultiExpected.empty() &&
 					m_queProofsKrnExpected.empty() &&
 					m_queProofsStateExpected.empty() &&
 					m_queProofLogsExpected.empty() &&
@@ -1939,13 +2327,13 @@ namespace beam
 				if (!sdp.m_Output.m_Value)
 					return false;
 
-				auto& fs = Transaction::FeeSettings::get(h + 1);
+				auto& fs = Transaction::FeeSettings::get(h + 1);
 				Amount fee = fs.get_DefaultStd() + fs.m_ShieldedOutputTotal;
 
 				sdp.m_Output.m_Value -= fee;
 
 				m_Shielded.m_Cfg = Rules::get().Shielded.m_ProofMax;
-
+
 				assert(msgTx.m_Transaction);
 
 				{
@@ -1969,18 +2357,18 @@ namespace beam
 						// skip the voucher signature
 					}
 
-					pKrn->UpdateMsg();
-					ECC::Oracle oracle;
-					oracle << pKrn->m_Msg;
+					pKrn->UpdateMsg();
+					ECC::Oracle oracle;
+					oracle << pKrn->m_Msg;
 
 					// substitute the voucher
 					pKrn->m_Txo.m_Ticket = voucher.m_Ticket;
-					sdp.m_Ticket.m_SharedSecret = voucher.m_SharedSecret;
+					sdp.m_Ticket.m_SharedSecret = voucher.m_SharedSecret;
 
 					ZeroObject(sdp.m_Output.m_User);
-					sdp.m_Output.m_User.m_Sender = 165U;
-					sdp.m_Output.m_User.m_pMessage[0] = 243U;
-					sdp.m_Output.m_User.m_pMessage[1] = 2435U;
+					sdp.m_Output.m_User.m_Sender = 165U;
+					sdp.m_Output.m_User.m_pMessage[0] = 243U;
+					sdp.m_Output.m_User.m_pMessage[1] = 2435U;
 					sdp.GenerateOutp(pKrn->m_Txo, h + 1, oracle);
 
 					pKrn->MsgToID();
@@ -2025,50 +2413,50 @@ namespace beam
 				msgTx.m_Transaction = std::make_shared<Transaction>();
 				msgTx.m_Transaction->m_Offset = Zero;
 
-				Height h = m_vStates.back().m_Height;
-
-				TxKernelShieldedInput::Ptr pKrn(new TxKernelShieldedInput);
-				pKrn->m_Height.m_Min = h + 1;
-				pKrn->m_WindowEnd = nWnd1;
-				pKrn->m_SpendProof.m_Cfg = m_Shielded.m_Cfg;
+				Height h = m_vStates.back().m_Height;
+
+				TxKernelShieldedInput::Ptr pKrn(new TxKernelShieldedInput);
+				pKrn->m_Height.m_Min = h + 1;
+				pKrn->m_WindowEnd = nWnd1;
+				pKrn->m_SpendProof.m_Cfg = m_Shielded.m_Cfg;
 
 				Lelantus::CmListVec lst;
 
 				assert(nWnd1 <= m_Shielded.m_Wnd0 + m_Shielded.m_N);
 				if (nWnd1 == m_Shielded.m_Wnd0 + m_Shielded.m_N)
-					lst.m_vec.swap(msg.m_Items);
-				else
-				{
-					// zero-pad from left
-					lst.m_vec.resize(m_Shielded.m_N);
-					for (size_t i = 0; i < m_Shielded.m_N - msg.m_Items.size(); i++)
-					{
-						ECC::Point::Storage& v = lst.m_vec[i];
-						v.m_X = Zero;
-						v.m_Y = Zero;
-					}
-					std::copy(msg.m_Items.begin(), msg.m_Items.end(), lst.m_vec.end() - msg.m_Items.size());
-				}
-
-				Lelantus::Prover p(lst, pKrn->m_SpendProof);
+					lst.m_vec.swap(msg.m_Items);
+				else
+				{
+					// zero-pad from left
+					lst.m_vec.resize(m_Shielded.m_N);
+					for (size_t i = 0; i < m_Shielded.m_N - msg.m_Items.size(); i++)
+					{
+						ECC::Point::Storage& v = lst.m_vec[i];
+						v.m_X = Zero;
+						v.m_Y = Zero;
+					}
+					std::copy(msg.m_Items.begin(), msg.m_Items.end(), lst.m_vec.end() - msg.m_Items.size());
+				}
+
+				Lelantus::Prover p(lst, pKrn->m_SpendProof);
 				p.m_Witness.m_L = static_cast<uint32_t>(m_Shielded.m_N - m_Shielded.m_Confirmed) - 1;
 				p.m_Witness.m_R = m_Shielded.m_Params.m_Ticket.m_pK[0] + m_Shielded.m_Params.m_Output.m_k; // total blinding factor of the shielded element
 				p.m_Witness.m_SpendSk = m_Shielded.m_skSpendKey;
 				p.m_Witness.m_V = m_Shielded.m_Params.m_Output.m_Value;
 
-				pKrn->UpdateMsg();
-
-				ECC::SetRandom(p.m_Witness.m_R_Output);
+				pKrn->UpdateMsg();
+
+				ECC::SetRandom(p.m_Witness.m_R_Output);
 
 				pKrn->m_NotSerialized.m_hvShieldedState = msg.m_State1;
 				pKrn->Sign(p, 0);
 
 				verify_test(m_Shielded.m_Params.m_Ticket.m_SpendPk == pKrn->m_SpendProof.m_SpendPk);
 
-				auto& fs = Transaction::FeeSettings::get(h + 1);
+				auto& fs = Transaction::FeeSettings::get(h + 1);
 				Amount fee = fs.get_DefaultStd() + fs.m_ShieldedInputTotal;
 
-				msgTx.m_Transaction->m_vKernels.push_back(std::move(pKrn));
+				msgTx.m_Transaction->m_vKernels.push_back(std::move(pKrn));
 				m_Wallet.UpdateOffset(*msgTx.m_Transaction, p.m_Witness.m_R_Output, false);
 
 				m_Wallet.MakeTxOutput(*msgTx.m_Transaction, h, 0, m_Shielded.m_Params.m_Output.m_Value, fee);
@@ -2077,12 +2465,12 @@ namespace beam
 				ctx.m_Height.m_Min = h + 1;
 				verify_test(msgTx.m_Transaction->IsValid(ctx));
 
-				for (size_t i = 0; i < msgTx.m_Transaction->m_vKernels.size(); i++)
-				{
-					const TxKernel& krn = *msgTx.m_Transaction->m_vKernels[i];
-					if (krn.get_Subtype() == TxKernel::Subtype::Std)
-						m_Shielded.m_SpendKernelID = krn.m_Internal.m_ID;
-				}
+				for (size_t i = 0; i < msgTx.m_Transaction->m_vKernels.size(); i++)
+				{
+					const TxKernel& krn = *msgTx.m_Transaction->m_vKernels[i];
+					if (krn.get_Subtype() == TxKernel::Subtype::Std)
+						m_Shielded.m_SpendKernelID = krn.m_Internal.m_ID;
+				}
 
 				msgTx.m_Fluff = true;
 				OnBeingSpent(msgTx);
@@ -2294,6 +2682,8 @@ namespace beam
 					Send(msgOut2);
 				}
 
+				proto::GetProofUtxoBatch msgBatch;
+
 				for (auto it = m_Wallet.m_MyUtxos.begin(); m_Wallet.m_MyUtxos.end() != it; it++)
 				{
 					const MiniWallet::MyUtxo& utxo = it->second;
@@ -2307,9 +2697,23 @@ namespace beam
 					{
 						Send(msgOut2);
 						m_queProofsExpected.push_back(msgOut2.m_Utxo);
+
+						if (msgBatch.m_Utxos.size() < proto::g_ProofBatchMaxSize)
+							msgBatch.m_Utxos.push_back(msgOut2.m_Utxo);
 					}
 				}
 
+				if (!msgBatch.m_Utxos.empty())
+				{
+					proto::GetProofUtxoMulti msgMulti;
+					msgMulti.m_Utxos = msgBatch.m_Utxos;
+					Send(msgMulti);
+					m_queProofsMultiExpected.push_back(std::move(msgMulti.m_Utxos));
+
+					Send(msgBatch);
+					m_queProofsBatchExpected.push_back(std::move(msgBatch.m_Utxos));
+				}
+
 				for (uint32_t i = 0; i < m_Wallet.m_MyKernels.size(); i++)
 				{
 					const MiniWallet::MyKernel mk = m_Wallet.m_MyKernels[i];
@@ -2331,6 +2735,7 @@ namespace beam
 					m_queProofsKrnExpected.push_back(i);
 				}
 
+				for (uint32_t i = 0; i < 2; i++) // the 2nd one should be served from the cache
 				{
 					proto::GetProofChainWork msgOut2;
 					Send(msgOut2);
@@ -2479,64 +2884,64 @@ namespace beam
 				{
 				}
 
-				void OnDone(const std::exception* pExc) override
-				{
-					m_Done = true;
-					m_Err = !!pExc;
-
+				void OnDone(const std::exception* pExc) override
+				{
+					m_Done = true;
+					m_Err = !!pExc;
+
 					m_This.m_Contract.m_Done++;
-
-					if (m_This.m_pMan)
-					{
-						if (!m_Err)
+
+					if (m_This.m_pMan)
+					{
+						if (!m_Err)
 							printf("manager shader: %s\n", m_Out.str().c_str());
-
-						//m_This.m_pMan.reset();
-					}
-				}
-
-				struct DelayedStart
-					:public io::IdleEvt
-				{
-					void OnSchedule() override
-					{
-						cancel();
-						get_ParentObj().StartRun(1);
-					}
-
-					IMPLEMENT_GET_PARENT_OBJ(MyManager, m_DelayedStart)
-
-				} m_DelayedStart;
-
-				std::map<uint32_t, ECC::Hash::Value> m_Slots;
-
-				bool SlotLoad(ECC::Hash::Value& hv, uint32_t iSlot) override
-				{
-					auto it = m_Slots.find(iSlot);
-					if (m_Slots.end() == it)
-						return false;
-
-					hv = it->second;
-					return true;
-				}
-
-				void SlotSave(const ECC::Hash::Value& hv, uint32_t iSlot) override
-				{
-					m_Slots[iSlot] = hv;
-				}
-
-				void SlotErase(uint32_t iSlot) override
-				{
-					auto it = m_Slots.find(iSlot);
-					if (m_Slots.end() != it)
-						m_Slots.erase(it);
-				}
-
-				void SelectContext(bool /* bDependent */, uint32_t /* nChargeNeeded */) override
-				{
-					m_Context.m_Height = m_This.m_vStates.empty() ? 0 : m_This.m_vStates.back().m_Height;
-				}
-
+
+						//m_This.m_pMan.reset();
+					}
+				}
+
+				struct DelayedStart
+					:public io::IdleEvt
+				{
+					void OnSchedule() override
+					{
+						cancel();
+						get_ParentObj().StartRun(1);
+					}
+
+					IMPLEMENT_GET_PARENT_OBJ(MyManager, m_DelayedStart)
+
+				} m_DelayedStart;
+
+				std::map<uint32_t, ECC::Hash::Value> m_Slots;
+
+				bool SlotLoad(ECC::Hash::Value& hv, uint32_t iSlot) override
+				{
+					auto it = m_Slots.find(iSlot);
+					if (m_Slots.end() == it)
+						return false;
+
+					hv = it->second;
+					return true;
+				}
+
+				void SlotSave(const ECC::Hash::Value& hv, uint32_t iSlot) override
+				{
+					m_Slots[iSlot] = hv;
+				}
+
+				void SlotErase(uint32_t iSlot) override
+				{
+					auto it = m_Slots.find(iSlot);
+					if (m_Slots.end() != it)
+						m_Slots.erase(it);
+				}
+
+				void SelectContext(bool /* bDependent */, uint32_t /* nChargeNeeded */) override
+				{
+					m_Context.m_Height = m_This.m_vStates.empty() ? 0 : m_This.m_vStates.back().m_Height;
+				}
+
 			};
 
 			std::unique_ptr<MyManager> m_pMan;
@@ -2547,68 +2952,68 @@ namespace beam
 				MyClient& m_This;
 				MyNetwork(MyClient& me) :m_This(me) {}
 
-				virtual void Connect() override {}
-				virtual void Disconnect() override {}
-				virtual void BbsSubscribe(BbsChannel, Timestamp, proto::FlyClient::IBbsReceiver*) override {}
+				virtual void Connect() override {}
+				virtual void Disconnect() override {}
+				virtual void BbsSubscribe(BbsChannel, Timestamp, proto::FlyClient::IBbsReceiver*) override {}
 
 				proto::FlyClient::Request::Ptr m_pReq;
 
-				virtual void PostRequestInternal(proto::FlyClient::Request& r) override
-				{
-					switch (r.get_Type())
-					{
-					case proto::FlyClient::Request::Type::ContractVars:
-						m_This.Send(Cast::Up<proto::FlyClient::RequestContractVars>(r).m_Msg);
-						break;
-
-					case proto::FlyClient::Request::Type::ContractLogs:
-						m_This.Send(Cast::Up<proto::FlyClient::RequestContractLogs>(r).m_Msg);
-						break;
-
-					case proto::FlyClient::Request::Type::ContractVar:
-						m_This.Send(Cast::Up<proto::FlyClient::RequestContractVar>(r).m_Msg);
-						break;
-
-					default:
-						return;
-					}
-
-					m_pReq = &r;
-				}
-
-				void OnComplete2()
-				{
-					auto pReq = std::move(m_pReq);
-					pReq->m_pTrg->OnComplete(*pReq);
-				}
-
+				virtual void PostRequestInternal(proto::FlyClient::Request& r) override
+				{
+					switch (r.get_Type())
+					{
+					case proto::FlyClient::Request::Type::ContractVars:
+						m_This.Send(Cast::Up<proto::FlyClient::RequestContractVars>(r).m_Msg);
+						break;
+
+					case proto::FlyClient::Request::Type::ContractLogs:
+						m_This.Send(Cast::Up<proto::FlyClient::RequestContractLogs>(r).m_Msg);
+						break;
+
+					case proto::FlyClient::Request::Type::ContractVar:
+						m_This.Send(Cast::Up<proto::FlyClient::RequestContractVar>(r).m_Msg);
+						break;
+
+					default:
+						return;
+					}
+
+					m_pReq = &r;
+				}
+
+				void OnComplete2()
+				{
+					auto pReq = std::move(m_pReq);
+					pReq->m_pTrg->OnComplete(*pReq);
+				}
+
 				void OnMsg(proto::ContractVars&& msg)
 				{
-					if (m_pReq && m_pReq->m_pTrg)
-					{
-						auto& x = Cast::Up<proto::FlyClient::RequestContractVars>(*m_pReq);
-						x.m_Res = std::move(msg);
-						OnComplete2();
+					if (m_pReq && m_pReq->m_pTrg)
+					{
+						auto& x = Cast::Up<proto::FlyClient::RequestContractVars>(*m_pReq);
+						x.m_Res = std::move(msg);
+						OnComplete2();
 					}
 				}
 
 				void OnMsg(proto::ContractLogs&& msg)
 				{
-					if (m_pReq && m_pReq->m_pTrg)
-					{
-						auto& x = Cast::Up<proto::FlyClient::RequestContractLogs>(*m_pReq);
-						x.m_Res = std::move(msg);
-						OnComplete2();
+					if (m_pReq && m_pReq->m_pTrg)
+					{
+						auto& x = Cast::Up<proto::FlyClient::RequestContractLogs>(*m_pReq);
+						x.m_Res = std::move(msg);
+						OnComplete2();
 					}
 				}
 
 				void OnMsg(proto::ContractVar&& msg)
 				{
-					if (m_pReq && m_pReq->m_pTrg)
-					{
-						auto& x = Cast::Up<proto::FlyClient::RequestContractVar>(*m_pReq);
-						x.m_Res = std::move(msg);
-						OnComplete2();
+					if (m_pReq && m_pReq->m_pTrg)
+					{
+						auto& x = Cast::Up<proto::FlyClient::RequestContractVar>(*m_pReq);
+						x.m_Res = std::move(msg);
+						OnComplete2();
 					}
 				}
 			};
@@ -2976,6 +3381,75 @@ namespace beam
 					fail_test("unexpected proof");
 			}
 
+			virtual void OnMsg(proto::ProofUtxoBatch&& msg) override
+			{
+				if (!m_queProofsBatchExpected.empty())
+				{
+					const std::vector<ECC::Point>& vComm = m_queProofsBatchExpected.front();
+					verify_test(msg.m_Results.size() == vComm.size());
+
+					for (uint32_t i = 0; i < msg.m_Results.size(); i++)
+					{
+						const auto& vProofs = msg.m_Results[i].m_Proofs;
+						verify_test(!vProofs.empty());
+
+						for (uint32_t j = 0; j < vProofs.size(); j++)
+							verify_test(m_vStates.back().IsValidProofUtxo(vComm[i], vProofs[j]));
+					}
+
+					m_queProofsBatchExpected.pop_front();
+				}
+				else
+					fail_test("unexpected proof");
+			}
+
+			virtual void OnMsg(proto::ProofUtxoMulti&& msg) override
+			{
+				if (!m_queProofsMultiExpected.empty())
+				{
+					const std::vector<ECC::Point>& vComm = m_queProofsMultiExpected.front();
+					verify_test(msg.m_States.size() == vComm.size());
+
+					const Block::SystemState::Full& s = m_vStates.back();
+					bool bSupported = Rules::get().IsPastFork_<3>(s.m_Height);
+
+					std::vector<UtxoTree::LeafInfo> vLeafs;
+					for (uint32_t i = 0; i < msg.m_States.size(); i++)
+					{
+						verify_test(msg.m_States[i].empty() != bSupported);
+
+						for (const auto& st : msg.m_States[i])
+						{
+							UtxoTree::Key::Data d;
+							d.m_Commitment = vComm[i];
+							d.m_Maturity = st.m_Maturity;
+
+							auto& x = vLeafs.emplace_back();
+							x.first = d;
+							x.second = st.m_Count;
+						}
+					}
+
+					if (bSupported)
+					{
+						Merkle::Hash hv;
+						verify_test(UtxoTree::get_MultiProofRoot(hv, msg.m_Proof, vLeafs));
+						verify_test(s.IsValidProofUtxoRoot(hv, msg.m_ProofRoot));
+
+						if (vLeafs.size() > 1)
+						{
+							// must not verify without one of the elements
+							vLeafs.pop_back();
+							verify_test(!UtxoTree::get_MultiProofRoot(hv, msg.m_Proof, vLeafs) || !s.IsValidProofUtxoRoot(hv, msg.m_ProofRoot));
+						}
+					}
+
+					m_queProofsMultiExpected.pop_front();
+				}
+				else
+					fail_test("unexpected proof");
+			}
+
 			virtual void OnMsg(proto::ProofKernel2&& msg) override
 			{
 				if (!m_queProofsKrnExpected.empty())
@@ -3016,26 +3490,26 @@ namespace beam
 			{
 				if (!m_queProofsKrnExpected.empty())
 				{
-					const MiniWallet::MyKernel& mk = m_Wallet.m_MyKernels[m_queProofsKrnExpected.front()];
+					const MiniWallet::MyKernel& mk = m_Wallet.m_MyKernels[m_queProofsKrnExpected.front()];
 					m_queProofsKrnExpected.pop_front();
 
 					if (!msg.m_Proof.empty())
 					{
-						TxKernelStd krn;
-						mk.Export(krn);
-						verify_test(m_vStates.back().IsValidProofKernel(krn, msg.m_Proof));
-
-						if (!m_Shielded.m_SpendConfirmed && (krn.m_Internal.m_ID == m_Shielded.m_SpendKernelID))
-						{
-							m_Shielded.m_SpendConfirmed = true;
-
-							proto::GetProofShieldedInp msgOut;
-							msgOut.m_SpendPk = m_Shielded.m_Params.m_Ticket.m_SpendPk;
-							Send(msgOut);
-
+						TxKernelStd krn;
+						mk.Export(krn);
+						verify_test(m_vStates.back().IsValidProofKernel(krn, msg.m_Proof));
+
+						if (!m_Shielded.m_SpendConfirmed && (krn.m_Internal.m_ID == m_Shielded.m_SpendKernelID))
+						{
+							m_Shielded.m_SpendConfirmed = true;
+
+							proto::GetProofShieldedInp msgOut;
+							msgOut.m_SpendPk = m_Shielded.m_Params.m_Ticket.m_SpendPk;
+							Send(msgOut);
+
 							printf("Waiting for shielded input proof...\n");
-
-						}
+
+						}
 					}
 				}
 				else
@@ -3065,17 +3539,17 @@ namespace beam
 					MyClient& m_This;
 					MyParser(MyClient& x) :m_This(x) {}
 
-					virtual void OnEventBase(proto::Event::Base& evt) override
-					{
-						// log non-UTXO events
-						std::ostringstream os;
-						os << "Evt H=" << m_Height << ", ";
-						evt.Dump(os);
-						printf("%s\n", os.str().c_str());
-					}
-
-					virtual void OnEventType(proto::Event::Utxo& evt) override
-					{
+					virtual void OnEventBase(proto::Event::Base& evt) override
+					{
+						// log non-UTXO events
+						std::ostringstream os;
+						os << "Evt H=" << m_Height << ", ";
+						evt.Dump(os);
+						printf("%s\n", os.str().c_str());
+					}
+
+					virtual void OnEventType(proto::Event::Utxo& evt) override
+					{
 						ECC::Scalar::Native sk;
 						ECC::Point comm;
 						CoinID::Worker(evt.m_Cid).Create(sk, comm, *m_This.m_Wallet.m_pKdf);
@@ -3083,24 +3557,24 @@ namespace beam
 
 						if (evt.m_Cid.m_AssetID)
 						{
-							verify_test(evt.m_Cid.m_AssetID == m_This.m_Assets.m_ID);
-							if (!m_This.m_Assets.m_Recognized)
-							{
-								m_This.m_Assets.m_Recognized = true;
-								printf("Asset UTXO recognized\n");
-							}
+							verify_test(evt.m_Cid.m_AssetID == m_This.m_Assets.m_ID);
+							if (!m_This.m_Assets.m_Recognized)
+							{
+								m_This.m_Assets.m_Recognized = true;
+								printf("Asset UTXO recognized\n");
+							}
 						}
 						else
 						{
 							if (proto::Event::Flags::Add & evt.m_Flags)
 								m_This.m_Wallet.AddMyUtxo(evt.m_Cid, evt.m_Maturity);
 						}
-					}
-
-					virtual void OnEventType(proto::Event::Shielded& evt) override
-					{
-						OnEventBase(evt);
-
+					}
+
+					virtual void OnEventType(proto::Event::Shielded& evt) override
+					{
+						OnEventBase(evt);
+
 						// Restore all the relevent data
 						verify_test(evt.m_TxoID == 0);
 
@@ -3136,29 +3610,29 @@ namespace beam
 							m_This.m_Shielded.m_EvtAdd = true;
 						else
 							m_This.m_Shielded.m_EvtSpend = true;
-					}
-
-					virtual void OnEventType(proto::Event::AssetCtl& evt) override
-					{
-						OnEventBase(evt);
-
-						if (m_This.m_Assets.m_ID) {
-							// creation event may come before the client got proof for its asset
-							verify_test(evt.m_Info.m_ID == m_This.m_Assets.m_ID);
-						}
-						verify_test(evt.m_Info.m_Metadata.m_Value == m_This.m_Assets.m_Metadata.m_Value);
-						verify_test(evt.m_Info.m_Owner == m_This.m_Assets.m_Owner);
-
-						if (proto::Event::Flags::Add & evt.m_Flags)
-						{
-							verify_test(!m_This.m_Assets.m_EvtCreated);
-							m_This.m_Assets.m_EvtCreated = true;
-						}
-
-						if (evt.m_EmissionChange)
-							m_This.m_Assets.m_EvtEmitted = true;
-					}
-
+					}
+
+					virtual void OnEventType(proto::Event::AssetCtl& evt) override
+					{
+						OnEventBase(evt);
+
+						if (m_This.m_Assets.m_ID) {
+							// creation event may come before the client got proof for its asset
+							verify_test(evt.m_Info.m_ID == m_This.m_Assets.m_ID);
+						}
+						verify_test(evt.m_Info.m_Metadata.m_Value == m_This.m_Assets.m_Metadata.m_Value);
+						verify_test(evt.m_Info.m_Owner == m_This.m_Assets.m_Owner);
+
+						if (proto::Event::Flags::Add & evt.m_Flags)
+						{
+							verify_test(!m_This.m_Assets.m_EvtCreated);
+							m_This.m_Assets.m_EvtCreated = true;
+						}
+
+						if (evt.m_EmissionChange)
+							m_This.m_Assets.m_EvtEmitted = true;
+					}
+
 				} p(*this);
 
 				uint32_t nCount = p.Proceed(msg.m_Events);
@@ -3218,8 +3692,8 @@ namespace beam
 		{
 			MyClient* m_pOtherClient;
 
-			virtual void OnConnectedSecure() override
-			{
+			virtual void OnConnectedSecure() override
+			{
 				SendLogin();
 			}
 
@@ -3287,26 +3761,26 @@ namespace beam
 
 		cl.TestAllDone(true);
 
-		struct TxoRecover
-			:public NodeProcessor::ITxoRecover
-		{
-			uint32_t m_Recovered = 0;
-
+		struct TxoRecover
+			:public NodeProcessor::ITxoRecover
+		{
+			uint32_t m_Recovered = 0;
+
 			virtual bool OnTxo(const NodeDB::WalkerTxo&, Height hCreate, Output&, const CoinID&, const Output::User&) override
 			{
 				m_Recovered++;
 				return true;
 			}
-		};
-
-		TxoRecover wlk;
-		wlk.m_pKey = node.m_Keys.m_pOwner.get();
-		node2.get_Processor().EnumTxos(wlk);
+		};
+
+		TxoRecover wlk;
+		wlk.m_pKey = node.m_Keys.m_pOwner.get();
+		node2.get_Processor().EnumTxos(wlk);
 		verify_test(wlk.m_Recovered);
 
 		wlk.m_Recovered = 0;
-		wlk.m_pKey = node.get_Processor().m_vAccounts[1].m_pOwner.get();
-		node2.get_Processor().EnumTxos(wlk);
+		wlk.m_pKey = node.get_Processor().m_vAccounts[1].m_pOwner.get();
+		node2.get_Processor().EnumTxos(wlk);
 		verify_test(wlk.m_Recovered);
 
 		// Test recovery info. Check if shielded in/outs and assets can re recognized
@@ -3324,35 +3798,35 @@ namespace beam
 			typedef std::set<ECC::Point> PkSet;
 			PkSet m_SpendKeys;
 
-			virtual bool OnUtxoRecognized(Height, const Output&, CoinID& cid, const Output::User&) override
-			{
-				m_Utxos++;
-				if (cid.m_AssetID)
-					m_UtxosCA++;
-				return true;
-			}
-
-			virtual bool OnShieldedOutRecognized(const ShieldedTxo::DescriptionOutp& dout, const ShieldedTxo::DataParams& pars, Key::Index) override
-			{
-				verify_test(m_SpendKeys.end() == m_SpendKeys.find(pars.m_Ticket.m_SpendPk));
-				m_SpendKeys.insert(pars.m_Ticket.m_SpendPk);
-				m_ShieldedOuts++;
-				return true;
-			}
-
-			virtual bool OnShieldedIn(const ShieldedTxo::DescriptionInp& din) override
-			{
-				if (m_SpendKeys.end() != m_SpendKeys.find(din.m_SpendPk))
-					m_ShieldedIns++;
-				return true;
-			}
-
-			virtual bool OnAssetRecognized(Asset::Full&) override
-			{
-				m_Assets++;
-				return true;
-			}
-
+			virtual bool OnUtxoRecognized(Height, const Output&, CoinID& cid, const Output::User&) override
+			{
+				m_Utxos++;
+				if (cid.m_AssetID)
+					m_UtxosCA++;
+				return true;
+			}
+
+			virtual bool OnShieldedOutRecognized(const ShieldedTxo::DescriptionOutp& dout, const ShieldedTxo::DataParams& pars, Key::Index) override
+			{
+				verify_test(m_SpendKeys.end() == m_SpendKeys.find(pars.m_Ticket.m_SpendPk));
+				m_SpendKeys.insert(pars.m_Ticket.m_SpendPk);
+				m_ShieldedOuts++;
+				return true;
+			}
+
+			virtual bool OnShieldedIn(const ShieldedTxo::DescriptionInp& din) override
+			{
+				if (m_SpendKeys.end() != m_SpendKeys.find(din.m_SpendPk))
+					m_ShieldedIns++;
+				return true;
+			}
+
+			virtual bool OnAssetRecognized(Asset::Full&) override
+			{
+				m_Assets++;
+				return true;
+			}
+
 		};
 
 		MyParser p;
@@ -3361,6 +3835,18 @@ namespace beam
 
 		verify_test((p.m_SpendKeys.size() == 1) && p.m_Utxos && p.m_UtxosCA && p.m_Assets && p.m_ShieldedOuts && p.m_ShieldedIns);
 
+		{
+			// same with the parallel utxo recognition
+			ExecutorMT_R exec;
+			Executor::Scope scope(exec);
+
+			MyParser p2;
+			p2.Init(cl.m_Wallet.m_pKdf);
+			p2.Proceed(beam::g_sz3);
+
+			verify_test((p2.m_Utxos == p.m_Utxos) && (p2.m_UtxosCA == p.m_UtxosCA));
+		}
+
 		auto logger = beam::Logger::create(BEAM_LOG_LEVEL_DEBUG, BEAM_LOG_LEVEL_DEBUG);
 		node.PrintTxos();
 
@@ -3710,10 +4196,10 @@ namespace beam
 		{
 			Waiter m_W;
 
-			void OnComplete(proto::FlyClient::Request&) override
-			{
-				m_W.StopSafe(true);
-			}
+			void OnComplete(proto::FlyClient::Request&) override
+			{
+				m_W.StopSafe(true);
+			}
 		};
 
 		MyHandler h;
@@ -3752,12 +4238,12 @@ namespace beam
 				}
 			}
 
-			void get_Kdf(Key::IKdf::Ptr& pOut) override {
-				pOut = m_pKdf;
-			}
-			void get_OwnerKdf(Key::IPKdf::Ptr& pOut) override {
-				pOut = m_pKdf;
-			}
+			void get_Kdf(Key::IKdf::Ptr& pOut) override {
+				pOut = m_pKdf;
+			}
+			void get_OwnerKdf(Key::IPKdf::Ptr& pOut) override {
+				pOut = m_pKdf;
+			}
 
 
 		};
@@ -3805,73 +4291,73 @@ namespace beam
 			std::list<CoinID> m_lstCoins;
 			std::vector<Merkle::Hash> m_vKrnIds;
 
-			void OnDone(const std::exception* pExc) override
-			{
-				m_Done = true;
-				m_Err = !!pExc;
-
-				if (m_pW)
-					m_pW->StopSafe(!m_Err);
-			}
-
-			void RunSync0(uint32_t iMethod)
-			{
-				m_Done = false;
-				m_Err = false;
-
-				StartRun(iMethod);
-			}
-
-			void RunSync1()
-			{
-				if (m_Done)
-					return;
-
-				{
-					Waiter wt;
-					m_pW = &wt;
-					wt.Wait();
-					m_pW = nullptr;
-				}
-
-				if (!m_Done)
-					// propagate it
-					io::Reactor::get_Current().stop();
-			}
-
-			void RunSync(uint32_t iMethod)
-			{
-				RunSync0(iMethod);
-				RunSync1();
-			}
-
-			Transaction::Ptr BuildTx()
-			{
+			void OnDone(const std::exception* pExc) override
+			{
+				m_Done = true;
+				m_Err = !!pExc;
+
+				if (m_pW)
+					m_pW->StopSafe(!m_Err);
+			}
+
+			void RunSync0(uint32_t iMethod)
+			{
+				m_Done = false;
+				m_Err = false;
+
+				StartRun(iMethod);
+			}
+
+			void RunSync1()
+			{
+				if (m_Done)
+					return;
+
+				{
+					Waiter wt;
+					m_pW = &wt;
+					wt.Wait();
+					m_pW = nullptr;
+				}
+
+				if (!m_Done)
+					// propagate it
+					io::Reactor::get_Current().stop();
+			}
+
+			void RunSync(uint32_t iMethod)
+			{
+				RunSync0(iMethod);
+				RunSync1();
+			}
+
+			Transaction::Ptr BuildTx()
+			{
 				Height hTx = m_Context.m_Height + 1;
 
 				auto pTx = std::make_shared<Transaction>();
 				pTx->m_Offset = Zero;
 
-				bvm2::FundsMap fm;
-
-				for (uint32_t i = 0; i < m_InvokeData.m_vec.size(); i++)
-				{
-					const auto& cdata = m_InvokeData.m_vec[i];
-
-					Amount fee;
-					if (cdata.IsAdvanced())
-						fee = cdata.m_Adv.m_Fee; // can't change!
-					else
-						fee = cdata.get_FeeMin(hTx);
-
-					cdata.Generate(*pTx, *m_pKdf, hTx, fee);
-
-					auto& krn = *pTx->m_vKernels.back();
-					m_vKrnIds.push_back(krn.m_Internal.m_ID);
-
-					fm += cdata.m_Spend;
-					fm[0] += fee;
-				}
+				bvm2::FundsMap fm;
+
+				for (uint32_t i = 0; i < m_InvokeData.m_vec.size(); i++)
+				{
+					const auto& cdata = m_InvokeData.m_vec[i];
+
+					Amount fee;
+					if (cdata.IsAdvanced())
+						fee = cdata.m_Adv.m_Fee; // can't change!
+					else
+						fee = cdata.get_FeeMin(hTx);
+
+					cdata.Generate(*pTx, *m_pKdf, hTx, fee);
+
+					auto& krn = *pTx->m_vKernels.back();
+					m_vKrnIds.push_back(krn.m_Internal.m_ID);
+
+					fm += cdata.m_Spend;
+					fm[0] += fee;
+				}
 
 				ECC::Scalar::Native kOff(pTx->m_Offset);
 
@@ -3918,7 +4404,7 @@ namespace beam
 				pTx->m_Offset = kOff;
 				pTx->Normalize();
 				return pTx;
-			}
+			}
 
 			void BuildAndSend(proto::FlyClient::INetwork& net)
 			{
@@ -4063,6 +4549,10 @@ void TestAll()
 		beam::TestNodeDB();
 		beam::DeleteFile(beam::g_sz);
 
+		beam::TestFluffPool();
+		beam::TestInvSketch();
+		beam::TestBbsStore();
+
 		{
 			printf("NodeProcessor test1...\n");
 			fflush(stdout);
@@ -0,0 +1,102 @@
+// Copyright 2018 The Beam Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Prints a binary log (.blog) as text, optionally filtered by level and thread
+
+#include "../../utility/logger.h"
+#include "../../utility/helpers.h"
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+using namespace beam;
+
+namespace {
+
+bool DecodeFile(const char* szPath, int minLevel, uint32_t thread)
+{
+    std::ifstream fs(szPath, std::ios::binary);
+    if (!fs)
+    {
+        std::cerr << "cannot open " << szPath << std::endl;
+        return false;
+    }
+
+    std::vector<uint8_t> buf((std::istreambuf_iterator<char>(fs)), std::istreambuf_iterator<char>());
+
+    if ((buf.size() < LogBinary::MagicSize) || memcmp(buf.data(), LogBinary::Magic, LogBinary::MagicSize))
+    {
+        std::cerr << szPath << " is not a binary log" << std::endl;
+        return false;
+    }
+
+    LogBinary::Reader r{ buf.data() + LogBinary::MagicSize, buf.data() + buf.size() };
+    std::string text;
+
+    while (r.p != r.end)
+    {
+        uint64_t size;
+        if (!r.get_varint(size) || (size > uint64_t(r.end - r.p)))
+        {
+            std::cerr << "truncated record at " << (r.p - buf.data()) << std::endl;
+            return false;
+        }
+
+        LogBinary::Reader rec{ r.p, r.p + size };
+        r.p += size;
+
+        uint64_t timestamp, thr, line = 0;
+        std::string_view func, file;
+        if (!rec.get_varint(timestamp) || !rec.get_varint(thr) || (rec.p == rec.end))
+            return false;
+
+        uint8_t level = *rec.p++;
+        if (LogBinary::Level::Location & level)
+        {
+            if (!rec.get_varint(line) || !rec.get_string(func) || !rec.get_string(file))
+                return false;
+        }
+        level &= LogBinary::Level::Mask;
+
+        if ((level < minLevel) || (thread && (thr != thread)))
+            continue;
+
+        text.clear();
+        if (!LogBinary::decode_fields((const char*) rec.p, rec.end - rec.p, text))
+            text += " <malformed fields>";
+
+        std::cout << loglevel_tag(level) << ' ' << format_timestamp("%Y-%m-%d.%T", timestamp) << " [" << thr << "] ";
+        if (line)
+            std::cout << '(' << func << ", " << file << ':' << line << ") ";
+        std::cout << text << '\n';
+    }
+
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2)
+    {
+        std::cout << "usage: log_decoder <file.blog> [min_level (1 - verbose .. 6 - critical)] [thread]" << std::endl;
+        return 1;
+    }
+
+    int minLevel = (argc > 2) ? atoi(argv[2]) : BEAM_LOG_LEVEL_VERBOSE;
+    uint32_t thread = (argc > 3) ? (uint32_t) atoi(argv[3]) : 0;
+
+    return DecodeFile(argv[1], minLevel, thread) ? 0 : 1;
+}
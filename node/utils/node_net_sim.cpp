@@ -18,7 +18,10 @@
 #include "../../core/fly_client.h"
 #include "../../core/treasury.h"
 #include "../../core/serialization_adapters.h"
+#include "../../utility/helpers.h"
 #include <boost/core/ignore_unused.hpp>
+#include <chrono>
+#include <ctime>
 
 #ifndef LOG_VERBOSE_ENABLED
 #define LOG_VERBOSE_ENABLED 0
@@ -56,11 +59,14 @@ bool ReadSeed(Key::IKdf::Ptr& pKdf, const char* szSeed)
     return true;
 }
 
+uint16_t g_LocalNodePort = 16725;
+
 struct Context
 {
     Key::IKdf::Ptr m_pKdf;
 
     NodeProcessor* m_pProc; // shortcut, to get the shielded pool data instantly, instead of via queries
+    Node* m_pNode; // the node under test (load mode)
 
     template <typename TID, typename TBase>
     struct Txo
@@ -426,7 +432,10 @@ struct Context
         macro(uint32_t, BulletsMin, 50, "min avail bullets") \
         macro(uint32_t, BulletsMax, 100, "num of bullets to create at once") \
         macro(uint32_t, ShieldedOutsTrg, 45, "target num of pending shielded outputs") \
-        macro(uint32_t, ShieldedInsTrg, 65, "target num of pending shielded inputs")
+        macro(uint32_t, ShieldedInsTrg, 65, "target num of pending shielded inputs") \
+        macro(uint32_t, LoadWallets, 0, "load mode: num of simulated wallets, each with its own connection. 0 - shielded stress mode") \
+        macro(uint32_t, LoadRate, 10, "load mode: target num of txs per second, total") \
+        macro(uint32_t, LoadReport_s, 5, "load mode: report interval")
 
 #define THE_MACRO(type, name, def, comment) type m_##name = def;
         CfgFieldsAll(THE_MACRO)
@@ -512,6 +521,12 @@ struct Context
         Height h = m_FlyClient.get_Height();
         std::cout << "H=" << h << std::endl;
 
+        if (m_Cfg.m_LoadWallets)
+        {
+            m_Load.OnEventsHandled();
+            return;
+        }
+
         if (!Rules::get().IsPastFork_<2>(h))
             return;
 
@@ -920,9 +935,335 @@ struct Context
 
     }
 
-};
+    // Load mode: plain txs (a bullet is spent to a single output) are sent at the target rate via the simulated wallets,
+    // each with its own connection to the node under test, while the observer (logged-in as a tx-spreading peer) watches the
+    // announcements. The splitting of the bullets is handled as in the stress mode.
+    // Reported: tx admission latency (sent -> node status), propagation delay (sent -> announced to the observer), node CPU and memory.
+    // The node runs in this process, its CPU is estimated as the process CPU time minus the time spent on building txs.
+    struct Load
+    {
+        typedef std::chrono::steady_clock Clock;
 
-uint16_t g_LocalNodePort = 16725;
+        static uint64_t get_Elapsed_us(Clock::time_point t0)
+        {
+            return std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - t0).count();
+        }
+
+        struct TxInfo
+        {
+            Clock::time_point m_tSent;
+            bool m_Admitted = false;
+            bool m_Announced = false;
+        };
+
+        typedef std::map<Transaction::KeyType, TxInfo> TxMap;
+        TxMap m_mapTxs; // in-flight, until admitted and announced
+
+        static const uint32_t s_Timeout_s = 60; // not announced during this time - considered lost
+
+        struct Latency
+        {
+            std::vector<uint64_t> m_v; // us
+
+            void Report(const char* szName)
+            {
+                std::cout << "\t" << szName << ": ";
+                if (m_v.empty())
+                {
+                    std::cout << "n/a" << std::endl;
+                    return;
+                }
+
+                std::sort(m_v.begin(), m_v.end());
+                std::cout << "p50=" << m_v[m_v.size() / 2] << "us, p99=" << m_v[m_v.size() * 99 / 100] << "us, max=" << m_v.back() << "us" << std::endl;
+                m_v.clear();
+            }
+        };
+
+        struct Stats
+        {
+            uint32_t m_Sent = 0;
+            uint32_t m_Rejected = 0;
+            uint32_t m_Lost = 0;
+            uint32_t m_NoBullets = 0; // ticks when the rate could not be sustained
+            Latency m_Admission;
+            Latency m_Propagation;
+            uint64_t m_Build_us = 0; // spent on the tx building
+        } m_Stats;
+
+        struct MyRequestTx
+            :public proto::FlyClient::RequestTransaction
+        {
+            typedef boost::intrusive_ptr<MyRequestTx> Ptr;
+            Transaction::KeyType m_Key;
+        };
+
+        struct Wallet
+            :public proto::FlyClient
+            ,public proto::FlyClient::Request::IHandler
+        {
+            Load& m_This;
+            Block::SystemState::HistoryMap m_Hist;
+            proto::FlyClient::NetworkStd m_Network;
+
+            Wallet(Load& x)
+                :m_This(x)
+                ,m_Network(*this)
+            {
+            }
+
+            virtual Block::SystemState::IHistory& get_History() override
+            {
+                return m_Hist;
+            }
+
+            virtual void OnComplete(proto::FlyClient::Request& r_) override
+            {
+                MyRequestTx& r = Cast::Up<MyRequestTx>(r_);
+                m_This.OnAdmitted(r.m_Key, proto::TxStatus::Ok == r.m_Res.m_Value);
+            }
+        };
+
+        std::vector<std::unique_ptr<Wallet> > m_vWallets;
+        uint32_t m_iWallet = 0;
+
+        struct Observer
+            :public proto::NodeConnection
+        {
+            Load& m_This;
+            Observer(Load& x) :m_This(x) {}
+
+            virtual void OnConnectedSecure() override
+            {
+                SendLogin();
+            }
+
+            virtual void SetupLogin(proto::Login& msg) override
+            {
+                msg.m_Flags |= proto::LoginFlags::SpreadingTransactions;
+            }
+
+            virtual void OnDisconnect(const DisconnectReason&) override
+            {
+                std::cout << "Observer disconnected" << std::endl;
+            }
+
+            virtual void OnMsg(proto::HaveTransaction&& msg) override
+            {
+                m_This.OnAnnounced(msg.m_ID);
+            }
+
+            virtual void OnMsg(proto::HaveTransactions&& msg) override
+            {
+                for (const auto& key : msg.m_IDs)
+                    m_This.OnAnnounced(key);
+            }
+
+        } m_Observer;
+
+        io::Timer::Ptr m_pTimerSend;
+        io::Timer::Ptr m_pTimerReport;
+
+        static const uint32_t s_Tick_ms = 100;
+        double m_Credit = 0; // txs to send
+
+        Clock::time_point m_tReport;
+        std::clock_t m_CpuReport;
+
+        Load() :m_Observer(*this) {}
+
+        void Start()
+        {
+            Context& ctx = get_ParentObj();
+            io::Address addr(INADDR_LOOPBACK, g_LocalNodePort);
+
+            for (uint32_t i = 0; i < ctx.m_Cfg.m_LoadWallets; i++)
+            {
+                m_vWallets.push_back(std::make_unique<Wallet>(*this));
+                Wallet& w = *m_vWallets.back();
+                w.m_Network.m_Cfg.m_vNodes.push_back(addr);
+                w.m_Network.Connect();
+            }
+
+            m_Observer.Connect(addr);
+
+            m_tReport = Clock::now();
+            m_CpuReport = std::clock();
+
+            m_pTimerSend = io::Timer::create(io::Reactor::get_Current());
+            m_pTimerSend->start(s_Tick_ms, true, [this]() { OnTick(); });
+
+            m_pTimerReport = io::Timer::create(io::Reactor::get_Current());
+            m_pTimerReport->start(std::max(ctx.m_Cfg.m_LoadReport_s, 1U) * 1000, true, [this]() { Report(); });
+        }
+
+        void OnEventsHandled()
+        {
+            Context& ctx = get_ParentObj();
+            Height h = ctx.m_FlyClient.get_Height();
+
+            ctx.m_Cfg.set_FeesHeight(h + 1);
+            ctx.m_TxosMW.HandleTxs(ctx.m_setSplit, h);
+
+            uint32_t nFreeBullets = 0;
+            for (TxoMW::HeightMap::iterator it = ctx.m_TxosMW.m_mapConfirmed.begin(); ctx.FindNextAvailBullet(it, h); )
+                nFreeBullets++;
+
+            std::cout << "\tBullets remaining: " << nFreeBullets << std::endl;
+
+            if (ctx.m_setSplit.empty() && (nFreeBullets < ctx.m_Cfg.m_BulletsMin))
+            {
+                ctx.AddSplitTx();
+                std::cout << "\tMaking more bullets..." << std::endl;
+            }
+        }
+
+        void OnTick()
+        {
+            Context& ctx = get_ParentObj();
+            Height h = ctx.m_FlyClient.get_Height();
+            if (!h)
+                return;
+
+            m_Credit += ctx.m_Cfg.m_LoadRate * (s_Tick_ms / 1000.);
+
+            TxoMW::HeightMap::iterator itBullet = ctx.m_TxosMW.m_mapConfirmed.begin();
+
+            for (; m_Credit >= 1.; m_Credit -= 1.)
+            {
+                TxoMW* pTxo = ctx.FindNextAvailBullet(itBullet, h);
+                if (!pTxo)
+                {
+                    m_Stats.m_NoBullets++;
+                    m_Credit = 0;
+                    break;
+                }
+
+                SendTx(*pTxo, h);
+            }
+
+            // expire the lost ones
+            for (TxMap::iterator it = m_mapTxs.begin(); m_mapTxs.end() != it; )
+            {
+                TxMap::iterator itThis = it++;
+                if (get_Elapsed_us(itThis->second.m_tSent) >= s_Timeout_s * 1000000ULL)
+                {
+                    m_Stats.m_Lost++;
+                    m_mapTxs.erase(itThis);
+                }
+            }
+        }
+
+        void SendTx(TxoMW& txo, Height h)
+        {
+            Context& ctx = get_ParentObj();
+            Clock::time_point t0 = Clock::now();
+
+            Transaction::Ptr pTx = std::make_shared<Transaction>();
+            HeightRange hr(h, h + 10);
+
+            Amount fee = ctx.m_Cfg.m_pFees->m_Kernel + ctx.m_Cfg.m_pFees->m_Output;
+
+            ECC::Scalar sk_;
+            ECC::GenRandom(sk_.m_Value);
+            ECC::Scalar::Native kOffs = sk_;
+
+            TxKernelStd::Ptr pKrn = std::make_unique<TxKernelStd>();
+            pKrn->m_Height = hr;
+            pKrn->m_Fee = fee;
+
+            pKrn->Sign(kOffs);
+            pTx->m_vKernels.push_back(std::move(pKrn));
+            kOffs = -kOffs;
+
+            ctx.AddInp(*pTx, kOffs, txo, hr.m_Max);
+            ctx.AddOutp(*pTx, kOffs, txo.m_ID.m_Value.m_Value - fee, 0, hr.m_Min);
+
+            pTx->m_Offset = kOffs;
+            pTx->Normalize();
+
+            MyRequestTx::Ptr pReq(new MyRequestTx);
+            pTx->get_Key(pReq->m_Key);
+            pReq->m_Msg.m_Transaction = std::move(pTx);
+
+            m_Stats.m_Build_us += get_Elapsed_us(t0);
+
+            m_mapTxs[pReq->m_Key].m_tSent = Clock::now();
+            m_Stats.m_Sent++;
+
+            Wallet& w = *m_vWallets[m_iWallet++ % m_vWallets.size()];
+            w.m_Network.PostRequest(*pReq, w);
+        }
+
+        void OnAdmitted(const Transaction::KeyType& key, bool bOk)
+        {
+            TxMap::iterator it = m_mapTxs.find(key);
+            if (m_mapTxs.end() == it)
+                return;
+
+            TxInfo& x = it->second;
+            if (!bOk)
+            {
+                m_Stats.m_Rejected++;
+                m_mapTxs.erase(it);
+                return;
+            }
+
+            m_Stats.m_Admission.m_v.push_back(get_Elapsed_us(x.m_tSent));
+            x.m_Admitted = true;
+            if (x.m_Announced)
+                m_mapTxs.erase(it);
+        }
+
+        void OnAnnounced(const Transaction::KeyType& key)
+        {
+            TxMap::iterator it = m_mapTxs.find(key);
+            if ((m_mapTxs.end() == it) || it->second.m_Announced)
+                return; // not ours, or the lost one
+
+            TxInfo& x = it->second;
+            m_Stats.m_Propagation.m_v.push_back(get_Elapsed_us(x.m_tSent));
+            x.m_Announced = true;
+            if (x.m_Admitted)
+                m_mapTxs.erase(it);
+        }
+
+        void Report()
+        {
+            Context& ctx = get_ParentObj();
+
+            uint64_t dt_us = get_Elapsed_us(m_tReport);
+            std::clock_t cpu = std::clock();
+
+            uint64_t dtCpu_us = static_cast<uint64_t>(double(cpu - m_CpuReport) * 1e6 / CLOCKS_PER_SEC);
+            dtCpu_us = (dtCpu_us > m_Stats.m_Build_us) ? (dtCpu_us - m_Stats.m_Build_us) : 0;
+
+            std::cout << "Load: sent=" << m_Stats.m_Sent
+                << ", rate=" << (dt_us ? (m_Stats.m_Sent * 1000000ULL / dt_us) : 0) << "/s"
+                << ", rejected=" << m_Stats.m_Rejected
+                << ", lost=" << m_Stats.m_Lost
+                << ", in-flight=" << m_mapTxs.size()
+                << ", starved ticks=" << m_Stats.m_NoBullets
+                << std::endl;
+
+            m_Stats.m_Admission.Report("Admission");
+            m_Stats.m_Propagation.Report("Propagation");
+
+            std::cout << "\tNode: cpu=" << (dt_us ? (dtCpu_us * 100 / dt_us) : 0) << "%"
+                << ", rss=" << (get_process_rss() >> 20) << "MB"
+                << ", pool=" << ctx.m_pNode->m_TxPool.m_setProfit.size()
+                << std::endl;
+
+            m_tReport = Clock::now();
+            m_CpuReport = cpu;
+            m_Stats = Stats();
+        }
+
+        IMPLEMENT_GET_PARENT_OBJ(Context, m_Load)
+
+    } m_Load;
+
+};
 
 } // namespace beam
 
@@ -965,6 +1306,7 @@ int main_Guarded(int argc, char* argv[])
 
     Context ctx;
     ctx.m_pProc = &node.get_Processor();
+    ctx.m_pNode = &node;
 
     Key::IKdf::Ptr pKdf;
 
@@ -1090,6 +1432,9 @@ int main_Guarded(int argc, char* argv[])
     ctx.m_Network.m_Cfg.m_vNodes.push_back(io::Address(INADDR_LOOPBACK, g_LocalNodePort));
     ctx.m_Network.Connect();
 
+    if (ctx.m_Cfg.m_LoadWallets)
+        ctx.m_Load.Start();
+
     io::Reactor::get_Current().run();
 
     return 0;
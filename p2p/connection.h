@@ -28,10 +28,7 @@ public:
         BaseConnection(d, std::move(stream)),
         _msgReader(protocol, peerId, defaultMsgSize)
     {
-        _stream->enable_read(
-            [this](io::ErrorCode what, void* data, size_t size) -> bool
-            { return _msgReader.new_data_from_stream(what, data, size); }
-        );
+        enable_read();
     }
 
     uint64_t id() const override { return _msgReader.id(); }
@@ -49,8 +46,27 @@ public:
     /// Disables all messages
     void disable_all_msg_types() { _msgReader.disable_all_msg_types(); }
 
+    /// Stops reading and dispatching incoming messages after the current one, until resumed
+    void suspend_read() {
+        _msgReader.suspend();
+        _stream->disable_read();
+    }
+
+    /// Dispatches the kept messages and resumes reading. Returns false if the connection was aborted (*this* may be deleted)
+    bool resume_read() {
+        enable_read();
+        return _msgReader.resume();
+    }
+
 private:
     MsgReader _msgReader;
+
+    void enable_read() {
+        _stream->enable_read(
+            [this](io::ErrorCode what, void* data, size_t size) -> bool
+            { return _msgReader.new_data_from_stream(what, data, size); }
+        );
+    }
 };
 
 } //namespace
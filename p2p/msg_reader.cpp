@@ -29,8 +29,8 @@ MsgReader::MsgReader(ProtocolBase& protocol, uint64_t streamId, size_t defaultSi
 	*_pAlive = true;
 
     assert(_defaultSize >= MsgHeader::SIZE);
-    _msgBuffer.resize(_defaultSize);
-    _cursor = _msgBuffer.data();
+    alloc_buffer(_defaultSize, 0);
+    _cursor = _msgBuffer;
 
     // by default, all message types are allowed
     enable_all_msg_types();
@@ -45,7 +45,101 @@ MsgReader::~MsgReader()
 void MsgReader::reset() {
     _bytesLeft = MsgHeader::SIZE;
     _state = reading_header;
-    _cursor = _msgBuffer.data();
+    _cursor = _msgBuffer;
+    _streamParser.reset();
+}
+
+void MsgReader::next_message() {
+    if (_msgCapacity > 2 * _defaultSize) {
+        // preventing from excessive memory consumption per individual stream. The large block goes back to the pool
+        _msgCapacity = 0;
+        alloc_buffer(_defaultSize, 0);
+    }
+    _bytesLeft = MsgHeader::SIZE;
+    _state = reading_header;
+
+    _cursor = _msgBuffer;
+}
+
+bool MsgReader::stream_data(const uint8_t* data, size_t size) {
+    assert(size <= _bytesLeft);
+    uint8_t* buf = _msgBuffer + MsgHeader::SIZE; // header is kept in front
+    const size_t chunkMax = _msgCapacity - MsgHeader::SIZE;
+
+    while (size) {
+        size_t n = std::min(size, chunkMax);
+        memcpy(buf, data, n);
+        _protocol.Decrypt(buf, (uint32_t) n);
+
+        size_t nBody = std::min(n, _streamBodyLeft);
+        if (nBody) {
+            _protocol.MacWrite(buf, (uint32_t) nBody);
+            if (!_streamParser->on_data(buf, nBody)) {
+                return false;
+            }
+            _streamBodyLeft -= nBody;
+        }
+
+        if (n > nBody) {
+            // MAC follows the body
+            size_t macLeft = _bytesLeft - nBody;
+            memcpy(_streamMac + _streamMacSize - macLeft, buf + nBody, n - nBody);
+        }
+
+        _bytesLeft -= n;
+        data += n;
+        size -= n;
+    }
+
+    return true;
+}
+
+bool MsgReader::stream_complete() {
+    std::unique_ptr<IStreamParser> parser = std::move(_streamParser);
+    bool macOk = _protocol.MacVerify(_streamMac);
+
+    next_message();
+
+    if (!macOk) {
+        _protocol.on_corrupt_msg(_streamId);
+        return false;
+    }
+
+    std::shared_ptr<bool> pAlive(_pAlive);
+    if (!parser->on_complete(_streamId)) {
+        // at this moment, the *this* may be deleted
+        if (*pAlive) {
+            reset();
+        }
+        return false;
+    }
+
+    return *pAlive;
+}
+
+void MsgReader::alloc_buffer(size_t size, size_t nKeep) {
+    if (size <= _msgCapacity) return;
+
+    auto p = io::alloc_pooled(size);
+    if (nKeep) {
+        assert(nKeep <= _msgCapacity);
+        memcpy(p.first, _msgBuffer, nKeep);
+    }
+
+    _msgBuffer = p.first;
+    _msgGuard = std::move(p.second);
+    _msgCapacity = io::pooled_capacity(size);
+}
+
+bool MsgReader::resume() {
+    _suspended = false;
+    if (_pending.empty()) {
+        return true;
+    }
+
+    std::vector<uint8_t> v;
+    v.swap(_pending);
+    return new_data_from_stream(io::EC_OK, v.data(), v.size());
 }
 
 void MsgReader::change_id(uint64_t newStreamId) {
@@ -78,21 +172,57 @@ bool MsgReader::new_data_from_stream(io::ErrorCode connectionStatus, const void*
         return true;
     }
 
+    if (_suspended) {
+        const uint8_t* p = (const uint8_t*)data;
+        _pending.insert(_pending.end(), p, p + size);
+        return true;
+    }
+
 	std::shared_ptr<bool> pAlive(_pAlive);
 	volatile const bool& bAlive = *pAlive;
 
     const uint8_t* p = (const uint8_t*)data;
     size_t sz = size;
 
-	while (sz >= _bytesLeft)
+	while (true)
 	{
+		if (_state == streaming_message)
+		{
+			// the message body bypasses the buffer
+			size_t n = std::min(sz, _bytesLeft);
+			if (!stream_data(p, n))
+			{
+				_protocol.on_corrupt_msg(_streamId);
+				return false;
+			}
+
+			sz -= n;
+			p += n;
+
+			if (_bytesLeft)
+				break; // wait for more
+
+			if (!stream_complete())
+				return false;
+
+			if (_suspended) {
+				_pending.assign(p, p + sz);
+				return true;
+			}
+
+			continue;
+		}
+
+		if (sz < _bytesLeft)
+			break;
+
 		memcpy(_cursor, p, _bytesLeft);
 		_protocol.Decrypt(_cursor, (uint32_t) _bytesLeft); // decrypt as much as we expect, no more (because cipher may change)
 
 		sz -= _bytesLeft;
 		p += _bytesLeft;
 
-		MsgHeader header(_msgBuffer.data());
+		MsgHeader header(_msgBuffer);
 
 		if (_state == reading_header)
 		{
@@ -114,9 +244,29 @@ bool MsgReader::new_data_from_stream(io::ErrorCode connectionStatus, const void*
 				return false;
 
 			// header deserialized successfully
+			uint32_t macSize = _protocol.get_MacSize();
+			if ((header.size >= STREAMING_THRESHOLD) && (header.size >= macSize))
+			{
+				_streamParser = _protocol.create_stream_parser(header.type, header.size - macSize);
+				if (_streamParser)
+				{
+					assert(macSize <= sizeof(_streamMac));
+					_protocol.MacStart(_msgBuffer, MsgHeader::SIZE);
+
+					_bytesLeft = header.size;
+					_streamBodyLeft = header.size - macSize;
+					_streamMacSize = macSize;
+					alloc_buffer(MsgHeader::SIZE + STREAMING_CHUNK, MsgHeader::SIZE);
+
+					_state = streaming_message;
+					continue;
+				}
+			}
+
 			_bytesLeft = header.size;
-			_msgBuffer.resize(MsgHeader::SIZE + _bytesLeft);
-			_cursor = _msgBuffer.data() + MsgHeader::SIZE;
+			_msgSize = MsgHeader::SIZE + _bytesLeft;
+			alloc_buffer(_msgSize, MsgHeader::SIZE);
+			_cursor = _msgBuffer + MsgHeader::SIZE;
 
 			_state = reading_message;
 
@@ -124,13 +274,13 @@ bool MsgReader::new_data_from_stream(io::ErrorCode connectionStatus, const void*
 		else
 		{
 			// whole message has been read
-			if (!_protocol.VerifyMsg(_msgBuffer.data(), static_cast<uint32_t>(_msgBuffer.size())))
+			if (!_protocol.VerifyMsg(_msgBuffer, static_cast<uint32_t>(_msgSize)))
 			{
 				_protocol.on_corrupt_msg(_streamId);
 				return false;
 			}
 
-            if (!_protocol.on_new_message(_streamId, header.type, _msgBuffer.data() + MsgHeader::SIZE, header.size - _protocol.get_MacSize())) {
+            if (!_protocol.on_new_message(_streamId, header.type, _msgBuffer + MsgHeader::SIZE, header.size - _protocol.get_MacSize())) {
                 // at this moment, the *this* may be deleted
                 if (bAlive) {
                     reset();
@@ -141,18 +291,12 @@ bool MsgReader::new_data_from_stream(io::ErrorCode connectionStatus, const void*
 			if (!bAlive)
 				return false;
 
-			if (_msgBuffer.size() > 2 * _defaultSize) {
-				{
-					std::vector<uint8_t> newBuffer;
-					_msgBuffer.swap(newBuffer);
-				}
-				// preventing from excessive memory consumption per individual stream
-				_msgBuffer.resize(_defaultSize);
-			}
-			_bytesLeft = MsgHeader::SIZE;
-			_state = reading_header;
+			next_message();
 
-			_cursor = _msgBuffer.data();
+			if (_suspended) {
+				_pending.assign(p, p + sz);
+				return true;
+			}
 		}
 	}
 
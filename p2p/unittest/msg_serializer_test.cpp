@@ -183,8 +183,105 @@ void msg_serializer_test_2() {
     assert(msg == handler.receivedObj);
 }
 
+struct StreamHandler : MsgHandler {
+    struct Parser : IStreamParser {
+        StreamHandler& owner;
+        std::vector<uint8_t> data;
+        size_t portions = 0;
+
+        explicit Parser(StreamHandler& o) : owner(o) {}
+
+        bool on_data(const uint8_t* p, size_t size) override {
+            data.insert(data.end(), p, p + size);
+            portions++;
+            return true;
+        }
+
+        bool on_complete(uint64_t fromStream) override {
+            Deserializer des;
+            des.reset(data);
+            if (!des.deserialize(owner.streamedInts) || des.bytes_left()) {
+                return false;
+            }
+            owner.streamedPortions = portions;
+            cout << "stream_complete(" << fromStream << "," << owner.streamedInts.size() << "," << portions << ")" << endl;
+            return true;
+        }
+    };
+
+    static IStreamParser* create_parser(void* handler, uint32_t) {
+        return new Parser(*static_cast<StreamHandler*>(handler));
+    }
+
+    IntList streamedInts;
+    size_t streamedPortions = 0;
+};
+
+void msg_reader_streaming_test() {
+    MsgType type = 77;
+
+    StreamHandler handler;
+    Protocol protocol(0xAA, 0xBB, 0xCC, 256, handler, 4096);
+    protocol.add_message_handler<MsgHandler, IntList, &MsgHandler::on_ints>(type, &handler, 0, 1<<24);
+    protocol.set_stream_parser(type, &StreamHandler::create_parser);
+
+    MsgReader reader(protocol, 1, 100);
+
+    IntList small(10, 1), large;
+    for (int i=0; i<200000; ++i) large.push_back(i);
+
+    // small, large and small again, sliced arbitrarily
+    std::vector<uint8_t> wire;
+    for (const IntList* pList : { &small, &large, &small }) {
+        std::vector<io::SharedBuffer> fragments;
+        protocol.serialize(fragments, type, *pList);
+        for (const auto& f : fragments) {
+            wire.insert(wire.end(), f.data, f.data + f.size);
+        }
+    }
+
+    for (size_t pos = 0; pos < wire.size(); ) {
+        size_t n = std::min<size_t>(wire.size() - pos, 7777);
+        assert(reader.new_data_from_stream(io::EC_OK, wire.data() + pos, n));
+        pos += n;
+    }
+
+    // the large one must be streamed, the small ones dispatched as usual
+    assert(handler.streamedInts == large);
+    assert(handler.streamedPortions > 1);
+    assert(handler.receivedInts == small);
+}
+
+void buffer_pool_test() {
+    assert(io::pooled_capacity(1) == 256);
+    assert(io::pooled_capacity(257) == 512);
+    assert(io::pooled_capacity(4096) == 4096);
+
+    io::BufferPoolStats s0 = io::get_buffer_pool_stats();
+
+    {
+        auto p = io::alloc_pooled(1000);
+        memset(p.first, 0x5a, io::pooled_capacity(1000));
+    }
+    {
+        // same class, must be reused
+        auto p = io::alloc_pooled(700);
+        assert(p.first);
+    }
+    {
+        auto p = io::alloc_pooled(10 * 1024 * 1024); // too large
+        assert(p.first);
+    }
+
+    io::BufferPoolStats s1 = io::get_buffer_pool_stats();
+    assert(s1.hits >= s0.hits + 1);
+    assert(s1.unpooled == s0.unpooled + 1);
+}
+
 int main() {
+    buffer_pool_test();
     fragment_writer_test();
     msg_serializer_test_1();
     msg_serializer_test_2();
+    msg_reader_streaming_test();
 }
@@ -41,6 +41,13 @@ public:
         std::string apiKeysFile;
         std::string certFile;
         std::string privKeyFile;
+        unsigned shareInterval = 0; // vardiff target, seconds per share per connection. 0 - disabled, every share must meet the network difficulty
+    };
+
+    struct DeviceStats {
+        std::string name;
+        double solutionsPerSec = 0;
+        bool throttled = false; // the device runs noticeably slower than its best, most likely thermal or power limited
     };
 
     // creates stratum server
@@ -68,6 +75,9 @@ public:
     virtual void stop_current() = 0;
 
     virtual void stop() = 0;
+
+    // per-device statistics, only local GPU solvers report them
+    virtual void get_device_stats(std::vector<DeviceStats>& stats) const { stats.clear(); }
 };
 
 } //namespace
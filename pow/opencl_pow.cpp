@@ -31,6 +31,7 @@ namespace
         string jobID;
         beam::Merkle::Hash input;
         beam::Block::PoW pow;
+        beam::Height height = 0;
         beam::IExternalPOW::BlockFound callback;
     };
 
@@ -43,7 +44,7 @@ namespace
             : _solutionCallback(move(solutionCallback))
             , _stopped(false)
         {
-            ECC::GenRandom(&_nonce, 8);
+            ECC::GenRandom(&_nonceBase, 8);
         }
         virtual ~WorkProvider()
         {
@@ -55,6 +56,7 @@ namespace
             unique_lock<mutex> guard(_mutex);
             _input.assign(job.input.m_pData, job.input.m_pData + job.input.nBytes);
             _workID = stoll(job.jobID);
+            _height = job.height;
             _difficulty = job.pow.m_Difficulty.m_Packed;
         }
 
@@ -71,14 +73,31 @@ namespace
         }
 
         void getWork(int64_t* workOut, uint64_t* nonceOut, uint8_t* dataOut, uint32_t* difficulty) override
+        {
+            getDeviceWork(0, workOut, nonceOut, dataOut, difficulty);
+        }
+
+        // Every device walks its own nonce range (the device index goes to the top byte),
+        // so devices never contend on a shared counter nor repeat each other's work
+        void getDeviceWork(uint32_t device, int64_t* workOut, uint64_t* nonceOut, uint8_t* dataOut, uint32_t* difficulty) override
         {
             unique_lock<mutex> guard(_mutex);
+            if (_nonces.size() <= device)
+            {
+                _nonces.resize(device + 1, 0);
+            }
             *workOut = _workID;
-            *nonceOut = _nonce.fetch_add(1);
+            *nonceOut = _nonceBase + ((uint64_t(device) << 56) | _nonces[device]++);
             *difficulty = _difficulty;
             copy_n(&_input[0], _input.size(), dataOut);
         }
 
+        beam::Height getHeight(int64_t workID) const
+        {
+            unique_lock<mutex> guard(_mutex);
+            return (workID == _workID) ? _height : 0;
+        }
+
         void handleSolution(int64_t &workId, uint64_t &nonce, vector<uint32_t> &indices, uint32_t difficulty) override
         {
             Job job;
@@ -88,6 +107,7 @@ namespace
             job.pow.m_Nonce = t;
             job.pow.m_Difficulty = beam::Difficulty(difficulty);
             job.jobID = to_string(workId);
+            job.height = getHeight(workId);
             _solutionCallback(move(job));
         }
 
@@ -95,9 +115,11 @@ namespace
         SolutionCallback _solutionCallback;
         bool _stopped;
         vector<uint8_t> _input;
-        atomic<uint64_t> _nonce;
+        uint64_t _nonceBase;
+        vector<uint64_t> _nonces;
         uint32_t _difficulty;
         int64_t _workID = 0;
+        beam::Height _height = 0;
         mutable mutex _mutex;
     };
 }
@@ -144,20 +166,38 @@ namespace beam {
                 _currentJob.jobID = jobID;
                 _currentJob.input = input;
                 _currentJob.pow = pow;
+                _currentJob.height = height;
                 _currentJob.callback = callback;
                 _changed = true;
                 _workProvider.feedJob(_currentJob);
             }
+            // running devices pick the new job up with their next iteration, paused ones restart now
+            _ClHost.workChanged();
             _cond.notify_one();
         }
 
-        void get_last_found_block(string& jobID, Block::PoW& pow) override
+        void get_last_found_block(string& jobID, Height& jobHeight, Block::PoW& pow) override
         {
             lock_guard<mutex> lk(_mutex);
             jobID = _lastFoundBlockID;
+            jobHeight = _lastFoundBlockHeight;
             pow = _lastFoundBlock;
         }
 
+        void get_device_stats(vector<DeviceStats>& stats) const override
+        {
+            vector<beamMiner::clDeviceStats> clStats;
+            _ClHost.getStats(clStats);
+
+            stats.resize(clStats.size());
+            for (size_t i = 0; i < clStats.size(); ++i)
+            {
+                stats[i].name = clStats[i].name;
+                stats[i].solutionsPerSec = clStats[i].solPerSec;
+                stats[i].throttled = clStats[i].throttled;
+            }
+        }
+
         void stop() override 
         {
             {
@@ -210,6 +250,7 @@ namespace beam {
                         unique_lock<mutex> lock(_mutex);
                         _lastFoundBlock = job.pow;
                         _lastFoundBlockID = job.jobID;
+                        _lastFoundBlockHeight = job.height;
                     }
                     callback();
                 }
@@ -256,6 +297,7 @@ namespace beam {
 
         Job _currentJob;
         string _lastFoundBlockID;
+        Height _lastFoundBlockHeight = 0;
         Block::PoW _lastFoundBlock;
         atomic<bool> _changed;
         bool _stop;
@@ -18,6 +18,8 @@
 #include <boost/filesystem.hpp>
 #include <boost/algorithm/string/trim.hpp>
 #include <fstream>
+#include <cmath>
+#include <algorithm>
 
 #ifndef LOG_VERBOSE_ENABLED
 #define LOG_VERBOSE_ENABLED 1
@@ -38,8 +40,15 @@ namespace stratum {
 
 static const uint64_t SERVER_RESTART_TIMER = 1;
 static const uint64_t ACL_REFRESH_TIMER = 2;
+static const uint64_t SHARE_STATS_TIMER = 3;
 static const unsigned SERVER_RESTART_INTERVAL = 1000;
 static const unsigned ACL_REFRESH_INTERVAL = 5000;
+static const unsigned SHARE_STATS_INTERVAL = 300000;
+
+static const unsigned INITIAL_SHARE_SHIFT = 10; // vardiff starts at 1/1024 of the network difficulty
+static const unsigned MAX_SHARE_SHIFT = 32;
+static const int MAX_RETARGET_STEP = 4;
+static const size_t MAX_STATS_LOGINS = 1024;
 
 static const char STS[] = "stratum server ";
 
@@ -58,9 +67,30 @@ Server::Server(const IExternalPOW::Options& o, io::Reactor& reactor, io::Address
     if (!o.apiKeysFile.empty()) {
         _timers.set_timer(ACL_REFRESH_TIMER, 0, BIND_THIS_MEMFN(refresh_acl));
     }
+    if (o.shareInterval) {
+        _timers.set_timer(SHARE_STATS_TIMER, SHARE_STATS_INTERVAL, BIND_THIS_MEMFN(log_share_stats));
+    }
     if (_prefixDigits > 0) {
         ECC::GenRandom(&_prefixSeed, 8);
     }
+    metrics::Registry::get().Add(*this);
+}
+
+Server::~Server() {
+    metrics::Registry::get().Remove(*this);
+    stop_checks();
+}
+
+void Server::WriteMetrics(metrics::Writer& w) {
+    w.Type("beam_stratum_connections", "gauge", "Connected miners");
+    w.Value("beam_stratum_connections", uint64_t(_connections.size()));
+
+    w.Type("beam_stratum_shares_total", "counter", "Solutions submitted by the miners, by result");
+    w.Value("beam_stratum_shares_total", _totals.accepted, "result=\"accepted\"");
+    w.Value("beam_stratum_shares_total", _totals.rejected, "result=\"rejected\"");
+
+    w.Type("beam_stratum_blocks_total", "counter", "Blocks found by the miners");
+    w.Value("beam_stratum_blocks_total", _totals.blocks);
 }
 
 void Server::start_server() {
@@ -93,6 +123,69 @@ void Server::refresh_acl() {
     _timers.set_timer(ACL_REFRESH_TIMER, ACL_REFRESH_INTERVAL, BIND_THIS_MEMFN(refresh_acl));
 }
 
+void Server::log_share_stats() {
+    for (const auto& x : _shareStats) {
+        // don't expose the api keys
+        std::string login = x.first.substr(0, 4) + "...";
+        BEAM_LOG_INFO() << STS << "shares of " << login
+            << ": accepted=" << x.second.accepted
+            << ", rejected=" << x.second.rejected
+            << ", blocks=" << x.second.blocks
+            << ", idle=" << (local_timestamp_msec() - x.second.lastShare_ms) / 1000 << " sec";
+    }
+    _timers.set_timer(SHARE_STATS_TIMER, SHARE_STATS_INTERVAL, BIND_THIS_MEMFN(log_share_stats));
+}
+
+Difficulty Server::get_share_difficulty(const Connection& conn, Difficulty network) const {
+    unsigned shift = conn.get_vardiff().shift;
+    if (!shift) {
+        return network;
+    }
+
+    uint32_t order, mantissa;
+    network.Unpack(order, mantissa);
+
+    Difficulty d;
+    d.Pack(order - std::min<uint32_t>(order, shift), mantissa);
+    return d;
+}
+
+void Server::retarget(Connection& conn, uint64_t now_ms) {
+    auto& vd = conn.get_vardiff();
+    uint64_t target_ms = static_cast<uint64_t>(_options.shareInterval) * 1000;
+    uint64_t dt_ms = now_ms - vd.since_ms;
+    if (dt_ms < target_ms) {
+        return; // too early to judge
+    }
+
+    int step = 1; // no shares at all, make it easier
+    if (vd.shares) {
+        // how many times the shares are slower than the target rate
+        double ratio = static_cast<double>(dt_ms) / static_cast<double>(vd.shares * target_ms);
+        step = static_cast<int>(std::lround(std::log2(ratio)));
+        step = std::clamp(step, -MAX_RETARGET_STEP, MAX_RETARGET_STEP);
+    }
+
+    int shift = std::clamp(static_cast<int>(vd.shift) + step, 0, static_cast<int>(MAX_SHARE_SHIFT));
+    vd.shift = static_cast<unsigned>(shift);
+    vd.shares = 0;
+    vd.since_ms = now_ms;
+}
+
+const io::SerializedMsg& Server::get_job_msg(Difficulty d) {
+    auto& msg = _recentJob.msgs[d.m_Packed];
+    if (msg.empty()) {
+        Block::PoW pow = _recentJob.pow;
+        pow.m_Difficulty = d;
+
+        Job jobMsg(_recentJob.id, _recentJob.input, pow, _recentJob.height);
+        append_json_msg(_fw, jobMsg);
+        msg.swap(_currentMsg);
+        _currentMsg.clear();
+    }
+    return msg;
+}
+
 void Server::on_stream_accepted(io::TcpStream::Ptr&& newStream, io::ErrorCode errorCode) {
     if (errorCode == 0) {
         auto peer = newStream->peer_address();
@@ -128,7 +221,12 @@ bool Server::on_login(uint64_t from, const Login& login) {
     auto& conn = _connections[from];
     bool loginSuccess = false;
     if (_acl.check(login.api_key)) {
-        conn->set_logged_in();
+        conn->set_logged_in(login.api_key);
+        if (_options.shareInterval) {
+            auto& vd = conn->get_vardiff();
+            vd.shift = INITIAL_SHARE_SHIFT;
+            vd.since_ms = local_timestamp_msec();
+        }
         loginSuccess = true;
     } else {
         BEAM_LOG_INFO() << STS << "peer login failed, key=" << login.api_key;
@@ -144,7 +242,11 @@ bool Server::on_login(uint64_t from, const Login& login) {
     if (!sent || !loginSuccess)
         return false;
 
-    return _connections[from]->send_msg(_recentJob.msg, true);
+    if (_recentJob.id.empty())
+        return true; // no active job, the miner will get the next one
+
+    const io::SerializedMsg& msg = get_job_msg(get_share_difficulty(*conn, _recentJob.pow.m_Difficulty));
+    return conn->send_job(msg, _recentJob.version);
 }
 
 bool Server::on_solution(uint64_t from, const Solution& sol) {
@@ -165,25 +267,212 @@ bool Server::on_solution(uint64_t from, const Solution& sol) {
 	    }
 	}
 
-	_recentResult.id = sol.id;
-    sol.fill_pow(_recentResult.pow);
+	auto check = std::make_shared<SolutionCheck>();
+	check->id = sol.id;
+	sol.fill_pow(check->pow);
+
+	bool urgent = true;
+	for (auto it = _jobs.rbegin(); it != _jobs.rend(); ++it) {
+		if (it->id == sol.id) {
+			check->input = it->input;
+			check->height = it->height;
+			check->network = it->difficulty;
+			check->pow.m_Difficulty = get_share_difficulty(*_connections[from], it->difficulty);
+			check->verify = true;
+			urgent = (it == _jobs.rbegin()); // solutions to the current job go first, they may extend the chain
+			break;
+		}
+	}
+
+	push_check(from, std::move(check), urgent);
+	return true;
+}
+
+void Server::start_checks() {
+    _checksDoneEvent = io::AsyncEvent::create(_reactor, BIND_THIS_MEMFN(on_checks_done));
+
+    uint32_t nThreads = std::min(std::max(MyThread::hardware_concurrency() / 2, 1U), 4U);
+    _checkThreads.resize(nThreads);
+    for (auto& t : _checkThreads) {
+        t = MyThread(&Server::check_thread, this, Rules::get());
+    }
+}
+
+void Server::stop_checks() {
+    {
+        std::unique_lock<std::mutex> scope(_checksMutex);
+        _stopChecks = true;
+        _checksCond.notify_all();
+    }
+
+    for (auto& t : _checkThreads) {
+        if (t.joinable()) {
+            t.join();
+        }
+    }
+    _checkThreads.clear();
+}
+
+void Server::push_check(uint64_t from, SolutionCheck::Ptr&& check, bool urgent) {
+    if (!_checksDoneEvent) {
+        start_checks(); // on the 1st solution, no need for threads if there are no miners
+    }
+
+    auto& queue = _pendingChecks[from];
+    queue.push_back(check);
+
+    std::unique_lock<std::mutex> scope(_checksMutex);
+    if (!check->verify) {
+        check->done = true; // nothing to verify here, but still must be reported in order
+        _checksDoneEvent->post();
+    } else {
+        if (urgent) {
+            _checksQueue.push_front(std::move(check));
+        } else {
+            _checksQueue.push_back(std::move(check));
+        }
+        _checksCond.notify_one();
+    }
+}
+
+void Server::check_thread(const Rules& r) {
+    Rules::Scope scopeRules(r);
+
+    while (true) {
+        SolutionCheck::Ptr check;
+        {
+            std::unique_lock<std::mutex> scope(_checksMutex);
+            _checksCond.wait(scope, [this] { return _stopChecks || !_checksQueue.empty(); });
+            if (_stopChecks) {
+                return;
+            }
+            check = std::move(_checksQueue.front());
+            _checksQueue.pop_front();
+        }
+
+        bool valid = check->pow.IsValid(check->input.m_pData, check->input.nBytes, check->height);
+        bool block = valid;
+        if (valid && (check->pow.m_Difficulty.m_Packed != check->network.m_Packed)) {
+            // vardiff share, see if it's good enough for the network too
+            ECC::Hash::Value hv;
+            ECC::Hash::Processor() << Blob(check->pow.m_Indices.data(), static_cast<uint32_t>(check->pow.m_Indices.size())) >> hv;
+            block = check->network.IsTargetReached(hv);
+        }
+
+        std::unique_lock<std::mutex> scope(_checksMutex);
+        check->valid = valid;
+        check->block = block;
+        check->done = true;
+        _checksDoneEvent->post();
+    }
+}
+
+void Server::on_checks_done() {
+    std::vector<std::pair<uint64_t, SolutionCheck::Ptr>> ready;
+    {
+        std::unique_lock<std::mutex> scope(_checksMutex);
+        for (auto it = _pendingChecks.begin(); it != _pendingChecks.end(); ) {
+            auto& queue = it->second;
+            while (!queue.empty() && queue.front()->done) {
+                ready.emplace_back(it->first, std::move(queue.front()));
+                queue.pop_front();
+            }
+
+            if (queue.empty()) {
+                it = _pendingChecks.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    for (const auto& x : ready) {
+        complete_solution(x.first, *x.second);
+    }
+
+    for (auto c : _deadConnections) {
+        _connections.erase(c);
+    }
+    _deadConnections.clear();
+}
+
+void Server::complete_solution(uint64_t from, const SolutionCheck& check) {
+    auto itConn = _connections.find(from);
+    ShareStats* stats = nullptr;
+    if (itConn != _connections.end()) {
+        const std::string& login = itConn->second->get_login();
+        auto itStats = _shareStats.find(login);
+        if (itStats != _shareStats.end()) {
+            stats = &itStats->second;
+        } else if (_shareStats.size() < MAX_STATS_LOGINS) { // logins are arbitrary if there's no acl
+            stats = &_shareStats[login];
+        }
+    }
 
-    BEAM_LOG_INFO() << STS << "solution to " << sol.id << " from " << io::Address::from_u64(from);
-	IExternalPOW::BlockFoundResult result = _recentResult.onBlockFound();
     stratum::ResultCode stratumCode = stratum::solution_rejected;
-    if (result == IExternalPOW::solution_accepted) {
+    std::string blockhash;
+
+    if (check.verify && !check.valid) {
+        BEAM_LOG_INFO() << STS << "invalid solution to " << check.id << " from " << io::Address::from_u64(from);
+        if (stats) stats->rejected++;
+        _totals.rejected++;
+    } else if (check.verify && !check.block) {
+        // vardiff share, nothing to tell the node
         stratumCode = stratum::solution_accepted;
-    } else if (result == IExternalPOW::solution_expired) {
-        stratumCode = stratum::solution_expired;
+        if (stats) {
+            stats->accepted++;
+            stats->lastShare_ms = local_timestamp_msec();
+        }
+        _totals.accepted++;
+        itConn->second->get_vardiff().shares++;
+    } else {
+        // the block counts even if the miner has gone meanwhile
+        _recentResult.id = check.id;
+        _recentResult.pow.m_Nonce = check.pow.m_Nonce;
+        _recentResult.pow.m_Indices = check.pow.m_Indices;
+
+        BEAM_LOG_INFO() << STS << "solution to " << check.id << " from " << io::Address::from_u64(from);
+        IExternalPOW::BlockFoundResult result = _recentResult.onBlockFound();
+        if (result == IExternalPOW::solution_accepted) {
+            stratumCode = stratum::solution_accepted;
+            blockhash = result._blockhash;
+        } else if (result == IExternalPOW::solution_expired) {
+            stratumCode = stratum::solution_expired;
+        }
+
+        if (stats) {
+            if (stratumCode == stratum::solution_rejected) {
+                stats->rejected++;
+            } else {
+                stats->accepted++;
+                stats->lastShare_ms = local_timestamp_msec();
+                if (stratumCode == stratum::solution_accepted) stats->blocks++;
+            }
+        }
+        if (stratumCode == stratum::solution_rejected) {
+            _totals.rejected++;
+        } else {
+            _totals.accepted++;
+            if (stratumCode == stratum::solution_accepted) _totals.blocks++;
+        }
+        if (check.verify && (itConn != _connections.end())) {
+            itConn->second->get_vardiff().shares++;
+        }
     }
-    Result res(sol.id, stratumCode);
-    if (result == IExternalPOW::solution_accepted) {
-        res.blockhash = result._blockhash;
+
+    if (itConn == _connections.end()) {
+        return;
     }
+
+    Result res(check.id, stratumCode);
+    res.blockhash = blockhash;
     append_json_msg(_fw, res);
-    bool sent = _connections[from]->send_msg(_currentMsg, true);
+    bool sent = itConn->second->send_msg(_currentMsg, true);
     _currentMsg.clear();
-    return sent;
+
+    if (!sent) {
+        _deadConnections.push_back(from);
+    }
 }
 
 void Server::on_bad_peer(uint64_t from) {
@@ -200,22 +489,36 @@ void Server::new_job(
     const CancelCallback& /* cancelCallback */
 ) {
     _recentJob.id = id;
+    _recentJob.version++;
+    _recentJob.input = input;
+    _recentJob.pow = pow;
+    _recentJob.height = height;
+    _recentJob.msgs.clear();
+
+    _jobs.push_back(JobInfo{ id, input, height, pow.m_Difficulty });
+    if (_jobs.size() > MAX_RECENT_JOBS) {
+        _jobs.pop_front();
+    }
+
     _recentResult.onBlockFound = callback;
     _recentResult.height = height;	
 
-    BEAM_LOG_INFO() << STS << "new job " << id << " will be sent to " << _connections.size() << " connected peers";
-
-    Job jobMsg(id, input, pow, height);
-    append_json_msg(_fw, jobMsg);
-	_recentJob.msg.swap(_currentMsg);
-    _currentMsg.clear();
+    uint64_t now_ms = _options.shareInterval ? local_timestamp_msec() : 0;
 
+    // broadcast first, log afterwards: every delay here means stale shares
     for (auto& p : _connections) {
-        if (!p.second->send_msg(_recentJob.msg, true)) {
+        if (_options.shareInterval) {
+            retarget(*p.second, now_ms);
+        }
+
+        const io::SerializedMsg& msg = get_job_msg(get_share_difficulty(*p.second, pow.m_Difficulty));
+        if (!p.second->send_job(msg, _recentJob.version)) {
             _deadConnections.push_back(p.first);
         }
     }
 
+    BEAM_LOG_INFO() << STS << "new job " << id << " sent to " << _connections.size() - _deadConnections.size() << " connected peers";
+
     for (auto c : _deadConnections) {
         _connections.erase(c);
     }
@@ -289,7 +592,8 @@ Server::Connection::Connection(
     _nonceprefix(std::move(nonceprefix)),
     _stream(std::move(newStream)),
     _lineReader(BIND_THIS_MEMFN(on_raw_message)),
-    _loggedIn(false)
+    _loggedIn(false),
+    _jobVersion(0)
 {
     _stream->enable_keepalive(2);
     _stream->enable_read(BIND_THIS_MEMFN(on_stream_data));
@@ -317,6 +621,13 @@ bool Server::Connection::send_msg(const io::SerializedMsg& msg, bool onlyIfLogge
     return sent;
 }
 
+bool Server::Connection::send_job(const io::SerializedMsg& msg, uint64_t version) {
+    if (!_loggedIn || (_jobVersion == version)) return true;
+    if (!send_msg(msg, true)) return false;
+    _jobVersion = version;
+    return true;
+}
+
 bool Server::Connection::on_message(const stratum::Login& login) {
     return _owner.on_login(_id, login);
 }
@@ -18,8 +18,12 @@
 #include "p2p/line_protocol.h"
 #include "utility/io/tcpserver.h"
 #include "utility/io/coarsetimer.h"
+#include "utility/io/asyncevent.h"
+#include "utility/thread.h"
+#include "utility/metrics.h"
 #include <set>
 #include <map>
+#include <deque>
 
 namespace beam { namespace stratum {
 
@@ -31,11 +35,14 @@ struct ConnectionToServer {
     virtual void on_bad_peer(uint64_t from) = 0;
 };
 
-class Server : public IExternalPOW, public ConnectionToServer {
+class Server : public IExternalPOW, public ConnectionToServer, private metrics::ISource {
 public:
     Server(const IExternalPOW::Options& o, io::Reactor& reactor, io::Address listenTo, unsigned noncePrefixDigits);
+    ~Server() override;
 
 private:
+    void WriteMetrics(metrics::Writer&) override;
+
     class AccessControl {
     public:
         explicit AccessControl(const std::string& keysFileName);
@@ -54,12 +61,26 @@ private:
     public:
         Connection(ConnectionToServer& owner, uint64_t id, std::string nonceprefix, io::TcpStream::Ptr&& newStream);
 
-        void set_logged_in() { _loggedIn = true; }
+        void set_logged_in(const std::string& login) { _loggedIn = true; _login = login; }
 
         const std::string& get_nonceprefix() { return _nonceprefix; }
 
+        const std::string& get_login() const { return _login; }
+
+        struct VarDiff {
+            unsigned shift = 0; // share difficulty is the network difficulty divided by 2^shift
+            uint32_t shares = 0; // since the last retarget
+            uint64_t since_ms = 0;
+        };
+
+        VarDiff& get_vardiff() { return _vardiff; }
+        const VarDiff& get_vardiff() const { return _vardiff; }
+
         bool send_msg(const io::SerializedMsg& msg, bool onlyIfLoggedIn, bool shutdown=false);
 
+        // sends the job unless this connection already has this version of it
+        bool send_job(const io::SerializedMsg& msg, uint64_t version);
+
     private:
         bool on_message(const Login& login) override;
 
@@ -79,12 +100,23 @@ private:
         io::TcpStream::Ptr _stream;
         LineReader _lineReader;
         bool _loggedIn;
+        uint64_t _jobVersion;
+        std::string _login;
+        VarDiff _vardiff;
     };
 
     void start_server();
 
     void refresh_acl();
 
+    void log_share_stats();
+
+    void retarget(Connection& conn, uint64_t now_ms);
+
+    Difficulty get_share_difficulty(const Connection& conn, Difficulty network) const;
+
+    const io::SerializedMsg& get_job_msg(Difficulty d);
+
     void on_stream_accepted(io::TcpStream::Ptr&& newStream, io::ErrorCode errorCode);
 
     std::string gen_nonceprefix(uint64_t connId);
@@ -105,6 +137,29 @@ private:
     void stop_current() override;
     void stop() override;
 
+    // Solutions are verified on the worker threads, so that share floods don't stall the reactor.
+    // The results are reported back to each miner in its submission order.
+    struct SolutionCheck {
+        using Ptr = std::shared_ptr<SolutionCheck>;
+
+        std::string id;
+        Block::PoW pow;
+        Merkle::Hash input;
+        Height height = 0;
+        Difficulty network; // the solution is a block if it meets it
+        bool verify = false; // false if the job is unknown here, the node decides then
+        bool valid = false; // meets the share difficulty
+        bool block = false;
+        bool done = false; // protected by _checksMutex
+    };
+
+    void start_checks();
+    void stop_checks();
+    void push_check(uint64_t from, SolutionCheck::Ptr&& check, bool urgent);
+    void check_thread(const Rules& r);
+    void on_checks_done();
+    void complete_solution(uint64_t from, const SolutionCheck& check);
+
     Options _options;
     io::Reactor& _reactor;
     io::Address _bindAddress;
@@ -115,10 +170,33 @@ private:
     AccessControl _acl;
 
 	struct RecentJob {
-		io::SerializedMsg msg;
+		// serialized once per share difficulty, the same fragments are written to all the connections
+		std::map<uint32_t, io::SerializedMsg> msgs;
 		std::string id;
+		uint64_t version = 0; // incremented on each new job, 0 means no job yet
+		Merkle::Hash input;
+		Block::PoW pow;
+		Height height = 0;
 	} _recentJob;
 
+	struct ShareStats {
+		uint64_t accepted = 0;
+		uint64_t rejected = 0;
+		uint64_t blocks = 0;
+		uint64_t lastShare_ms = 0;
+	};
+	std::map<std::string, ShareStats> _shareStats; // per login
+	ShareStats _totals; // all the logins
+
+	struct JobInfo {
+		std::string id;
+		Merkle::Hash input;
+		Height height;
+		Difficulty difficulty;
+	};
+	std::deque<JobInfo> _jobs; // recent jobs, the node accepts solutions to them too
+	static const size_t MAX_RECENT_JOBS = 64;
+
 	struct RecentResult {
 		std::string id;
 		Height height;
@@ -130,6 +208,14 @@ private:
     std::vector<uint64_t> _deadConnections;
     unsigned _prefixDigits; // nonceprefix hex digits, 0..6
     uint64_t _prefixSeed;
+
+    std::map<uint64_t, std::deque<SolutionCheck::Ptr>> _pendingChecks; // per connection, in submission order
+    io::AsyncEvent::Ptr _checksDoneEvent;
+    std::mutex _checksMutex;
+    std::condition_variable _checksCond;
+    std::deque<SolutionCheck::Ptr> _checksQueue;
+    std::vector<MyThread> _checkThreads;
+    bool _stopChecks = false;
 };
 
 }} //namespaces
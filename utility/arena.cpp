@@ -0,0 +1,129 @@
+// Copyright 2018-2020 The Beam Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "arena.h"
+#include <atomic>
+#include <cstdint>
+#include <new>
+#include <cassert>
+
+namespace beam
+{
+    namespace
+    {
+        // precedes every object, so that Free() knows where it came from. nullptr for heap-allocated
+        struct alignas(std::max_align_t) Header
+        {
+            ObjectArena::Chunk* m_pChunk;
+        };
+
+        thread_local ObjectArena::Scope* s_pScope = nullptr;
+
+        size_t RoundUp(size_t n)
+        {
+            const size_t nAlign = alignof(std::max_align_t);
+            return (n + nAlign - 1) & ~(nAlign - 1);
+        }
+    }
+
+    struct alignas(std::max_align_t) ObjectArena::Chunk
+    {
+        std::atomic<size_t> m_Refs; // live objects, +1 while it's the current chunk of the scope
+        size_t m_Size;
+        size_t m_Pos = 0;
+
+        static Chunk* Create(size_t nSize)
+        {
+            Chunk* pRet = new (::operator new(sizeof(Chunk) + nSize)) Chunk;
+            pRet->m_Refs = 1;
+            pRet->m_Size = nSize;
+            return pRet;
+        }
+
+        uint8_t* get_Data() { return reinterpret_cast<uint8_t*>(this + 1); }
+
+        void Release() noexcept
+        {
+            if (1 == m_Refs.fetch_sub(1, std::memory_order_acq_rel))
+            {
+                this->~Chunk();
+                ::operator delete(this);
+            }
+        }
+    };
+
+    void* ObjectArena::Alloc(size_t n)
+    {
+        if (s_pScope)
+        {
+            void* pRet = s_pScope->Alloc(n);
+            if (pRet)
+                return pRet;
+        }
+
+        Header* pHdr = static_cast<Header*>(::operator new(sizeof(Header) + n));
+        pHdr->m_pChunk = nullptr;
+        return pHdr + 1;
+    }
+
+    void ObjectArena::Free(void* p) noexcept
+    {
+        if (!p)
+            return;
+
+        Header* pHdr = static_cast<Header*>(p) - 1;
+        if (pHdr->m_pChunk)
+            pHdr->m_pChunk->Release();
+        else
+            ::operator delete(pHdr);
+    }
+
+    ObjectArena::Scope::Scope(size_t nChunkSize)
+        :m_pPrev(s_pScope)
+        ,m_nChunkSize(RoundUp((nChunkSize < s_ChunkMin) ? s_ChunkMin : (nChunkSize > s_ChunkMax) ? s_ChunkMax : nChunkSize))
+    {
+        s_pScope = this;
+    }
+
+    ObjectArena::Scope::~Scope()
+    {
+        assert(s_pScope == this);
+        s_pScope = m_pPrev;
+
+        if (m_pChunk)
+            m_pChunk->Release();
+    }
+
+    void* ObjectArena::Scope::Alloc(size_t n)
+    {
+        size_t nTotal = sizeof(Header) + RoundUp(n);
+        if (nTotal > (m_nChunkSize >> 2))
+            return nullptr; // too large, not worth wasting the chunk tail
+
+        if (!m_pChunk || (m_pChunk->m_Pos + nTotal > m_pChunk->m_Size))
+        {
+            if (m_pChunk)
+                m_pChunk->Release();
+            m_pChunk = Chunk::Create(m_nChunkSize);
+        }
+
+        Header* pHdr = reinterpret_cast<Header*>(m_pChunk->get_Data() + m_pChunk->m_Pos);
+        m_pChunk->m_Pos += nTotal;
+        m_pChunk->m_Refs.fetch_add(1, std::memory_order_relaxed);
+
+        pHdr->m_pChunk = m_pChunk;
+        return pHdr + 1;
+    }
+
+} //namespace
@@ -0,0 +1,58 @@
+// Copyright 2018-2020 The Beam Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+#include <cstddef>
+
+namespace beam
+{
+    // Region allocator for object graphs that are created together and die together (deserialized blocks, transactions).
+    //
+    // Classes opt in with BEAM_ARENA_ALLOCATED. While a Scope is active on the thread, their instances are carved
+    // sequentially from the scope's chunks, otherwise they go to the heap. A chunk is released once the scope has moved on
+    // and all the objects in it are destroyed, hence objects may outlive the scope, and may be destroyed on any thread.
+    struct ObjectArena
+    {
+        static void* Alloc(size_t);
+        static void Free(void*) noexcept;
+
+        struct Chunk;
+
+        class Scope
+        {
+            Scope* m_pPrev;
+            Chunk* m_pChunk = nullptr;
+            size_t m_nChunkSize;
+
+            friend struct ObjectArena;
+            void* Alloc(size_t);
+
+        public:
+            static const size_t s_ChunkMin = 0x1000;
+            static const size_t s_ChunkMax = 0x100000;
+
+            // nChunkSize is a hint, clamped to [s_ChunkMin, s_ChunkMax]. Typically the size of the serialized data
+            explicit Scope(size_t nChunkSize = s_ChunkMin);
+            ~Scope();
+
+            Scope(const Scope&) = delete;
+            Scope& operator = (const Scope&) = delete;
+        };
+    };
+
+} //namespace
+
+#define BEAM_ARENA_ALLOCATED \
+    static void* operator new(size_t n) { return beam::ObjectArena::Alloc(n); } \
+    static void operator delete(void* p) noexcept { beam::ObjectArena::Free(p); }
@@ -73,6 +73,7 @@ namespace beam
         const char* STRATUM_PORT = "stratum_port";
         const char* STRATUM_SECRETS_PATH = "stratum_secrets_path";
         const char* STRATUM_USE_TLS = "stratum_use_tls";
+        const char* STRATUM_SHARE_INTERVAL = "stratum_share_interval";
         const char* WEBSOCKET_PORT = "websocket_port";
         const char* WEBSOCKET_SECRETS_PATH = "websocket_secrets_path";
         const char* WEBSOCKET_USE_TLS = "websocket_use_tls";
@@ -84,9 +85,33 @@ namespace beam
         const char* MINING_THREADS = "mining_threads";
         const char* POW_SOLVE_TIME = "pow_solve_time";
         const char* VERIFICATION_THREADS = "verification_threads";
+        const char* VERIFICATION_BATCH_BLOCKS = "verification_batch_blocks";
+        const char* FAST_SYNC_RANGES = "fast_sync_ranges";
+        const char* READ_THREADS = "read_threads";
+        const char* CPUS_REACTOR = "cpus_reactor";
+        const char* CPUS_VERIFICATION = "cpus_verification";
+        const char* CPUS_MINING = "cpus_mining";
+        const char* NICE_REACTOR = "nice_reactor";
+        const char* NICE_VERIFICATION = "nice_verification";
+        const char* NICE_MINING = "nice_mining";
+        const char* MEM_SOFT_LIMIT = "mem_soft_limit";
+        const char* MEM_REPORT_PERIOD = "mem_report_period";
+        const char* METRICS_PORT = "metrics_port";
+        const char* PROFILE_SCOPES = "profile_scopes";
+        const char* MEMPOOL_MAX_SIZE = "mempool_max_size";
+        const char* TX_SKETCH_CELLS = "tx_sketch_cells";
+        const char* TX_TRICKLE = "tx_trickle_ms";
+        const char* MEMPOOL_PERSIST = "mempool_persist";
+        const char* LISTEN_REUSE_PORT = "listen_reuse_port";
+        const char* DB_WAL = "db_wal";
+        const char* DB_WAL_CHECKPOINT_INTERVAL = "db_wal_checkpoint_interval";
+        const char* DB_COMPACTION_PERIOD = "db_compaction_period";
+        const char* DB_COMPACTION_BUDGET = "db_compaction_budget";
         const char* NONCEPREFIX_DIGITS = "nonceprefix_digits";
         const char* NODE_PEER = "peer";
         const char* NODE_PEERS_PERSISTENT = "peers_persistent";
+        const char* CLUSTER_SECRET = "cluster_secret";
+        const char* CLUSTER_BEACON_TARGETS = "cluster_beacon_targets";
         const char* PASS = "pass";
         const char* SET_SWAP_SETTINGS = "set_swap_settings";
         const char* ACTIVE_CONNECTION = "active_connection";
@@ -120,7 +145,20 @@ namespace beam
         const char* CONTRACT_RICH_INFO = "contract_rich_info";
         const char* CONTRACT_RICH_PARSER = "contract_rich_parser";
         const char* CHECKDB = "check_db";
+        const char* CHECKDB_THREADS = "check_db_threads";
+        const char* CHECKDB_AFTER_CRASH = "check_db_after_crash";
         const char* VACUUM = "vacuum";
+        const char* PERSIST_VALIDATED_CACHE = "persist_validated_cache";
+        const char* BULK_LOAD_SYNC = "bulk_load_sync";
+        const char* EXTERNAL_BODIES = "external_bodies";
+        const char* MAPPING_RANDOM_ACCESS = "mapping_random_access";
+        const char* MAPPING_HUGE_PAGES = "mapping_huge_pages";
+        const char* MAPPING_PREFAULT = "mapping_prefault";
+        const char* MAPPING_COMPACT = "mapping_compact";
+        const char* MAPPING_REPORT = "mapping_report";
+        const char* MEM_CACHE_KERNEL_PROOFS = "mem_cache_kernel_proofs";
+        const char* DB_MMAP_SIZE = "db_mmap_size";
+        const char* MMR_PIN_FROM_LEVEL = "mmr_pin_from_level";
         const char* CRASH = "crash";
         const char* INIT = "init";
         const char* RESTORE = "restore";
@@ -173,6 +211,8 @@ namespace beam
         const char* LOG_DEBUG = "debug";
         const char* LOG_VERBOSE = "verbose";
         const char* LOG_CLEANUP_DAYS = "log_cleanup_days";
+        const char* LOG_ASYNC = "log_async";
+        const char* LOG_BINARY = "log_binary";
         const char* LOG_UTXOS = "log_utxos";
         const char* VERSION = "version";
         const char* VERSION_FULL = "version,v";
@@ -188,7 +228,10 @@ namespace beam
         const char* IMPORT_EXPORT_PATH = "file_location";
         const char* IP_WHITELIST = "ip_whitelist";
         const char* FAST_SYNC = "fast_sync";
+        const char* PRUNE_DAYS = "prune_days";
         const char* GENERATE_RECOVERY_PATH = "generate_recovery";
+        const char* SNAPSHOT_EXPORT = "snapshot_export";
+        const char* SNAPSHOT_IMPORT = "snapshot_import";
         const char* RECOVERY_AUTO_PATH = "recovery_auto_path";
         const char* RECOVERY_AUTO_PERIOD = "recovery_auto_period";
         const char* SWAP_INIT = "swap_init";
@@ -256,6 +299,7 @@ namespace beam
         const char* API_ENABLE_IPFS = "enable_ipfs";
         const char* API_IPFS_STORAGE = "ipfs_storage";
         const char* API_TCP_MAX_LINE = "tcp_max_line";
+        const char* API_EXTRA_WALLETS = "extra_wallets";
 
         // treasury
         const char* TR_OPCODE = "tr_op";
@@ -379,209 +423,126 @@ namespace beam
 
     pair<po::options_description, po::options_description> createOptionsDescription(int flags, const std::string& configFile)
     {
-        po::options_description general_options("General options");
-        general_options.add_options()
-            (cli::HELP_FULL, "list all available options and commands")
-            (cli::VERSION_FULL, "print project version")
-            (cli::LOG_LEVEL, po::value<string>(), "set log level [error|warning|info(default)|debug|verbose]")
-            (cli::FILE_LOG_LEVEL, po::value<string>(), "set file log level [error|warning|info(default)|debug|verbose]")
-            (cli::LOG_CLEANUP_DAYS, po::value<uint32_t>()->default_value(5), "old logfiles cleanup period(days)")
-            (cli::GIT_COMMIT_HASH, "print git commit hash value")
-            (cli::CONFIG_FILE_PATH, po::value<string>()->default_value(configFile), "path to the config file");
-
-        po::options_description node_options("Node options");
-        node_options.add_options()
-            (cli::PORT_FULL, po::value<uint16_t>()->default_value(10000), "port to start the server on")
-            (cli::STORAGE, po::value<string>()->default_value("node.db"), "node storage path")
-            (cli::MINING_THREADS, po::value<uint32_t>()->default_value(0), "number of mining threads(there is no mining if 0). It works if FakePoW is enabled")
-            (cli::POW_SOLVE_TIME, po::value<uint32_t>()->default_value(15 * 1000), "pow solve time. It works if FakePoW is enabled")
-
-            (cli::VERIFICATION_THREADS, po::value<int>()->default_value(-1), "number of threads for cryptographic verifications (0 = single thread, -1 = auto)")
-            (cli::NONCEPREFIX_DIGITS, po::value<unsigned>()->default_value(0), "number of hex digits for nonce prefix for stratum client (0..6)")
-            (cli::NODE_PEER, po::value<vector<string>>()->multitoken(), "nodes to connect to")
-            (cli::NODE_PEERS_PERSISTENT, po::value<bool>()->default_value(false), "Keep persistent connection to the specified peers, regardless to ratings")
-            (cli::STRATUM_PORT, po::value<uint16_t>()->default_value(0), "port to start stratum server on")
-            (cli::STRATUM_SECRETS_PATH, po::value<string>()->default_value("."), "path to stratum server api keys file, and tls certificate and private key")
-            (cli::STRATUM_USE_TLS, po::value<bool>()->default_value(true), "enable TLS on startum server")
-            (cli::WEBSOCKET_PORT, po::value<uint16_t>()->default_value(0), "port to start websocket server on, it allows to communicate with node from web browser")
-            (cli::WEBSOCKET_SECRETS_PATH, po::value<string>()->default_value("."), "path to websocket server api keys file, and tls certificate and private key")
-            (cli::WEBSOCKET_USE_TLS, po::value<bool>()->default_value(true), "enable TLS on websocket server")
-            (cli::WEBSOCKET_KEY, po::value<string>()->default_value("wskey.pem"), "name of the private key file for websocket server")
-            (cli::WEBSOCKET_CERT, po::value<string>()->default_value("wscert.pem"), "name of the certificate file for websocket server")
-            (cli::WEBSOCKET_DH, po::value<string>()->default_value("wsdhparams.pem"), "name of the DH params file for websocket server")
-            (cli::RESET_ID, po::value<bool>()->default_value(false), "Reset self ID (used for network authentication). Must do if the node is cloned")
-            (cli::ERASE_ID, po::value<bool>()->default_value(false), "Reset self ID (used for network authentication) and stop before re-creating the new one.")
-            (cli::PRINT_TXO, po::value<bool>()->default_value(false), "Print TXO movements (create/spend) recognized by the owner key.")
-            (cli::PRINT_ROLLBACK_STATS, po::value<bool>()->default_value(false), "Analyze and print recent reverted branches, check if there were double-spends.")
-            (cli::MANUAL_ROLLBACK, po::value<Height>(), "Explicit rollback to height. The current consequent state will be forbidden (no automatic going up the same path)")
-            (cli::MANUAL_SELECT, po::value<std::string>(), "Explicit correct block selection at the specified height. Auto-rollback below this height if current branch is different")
-            (cli::CHECKDB, po::value<bool>()->default_value(false), "DB integrity check")
-            (cli::VACUUM, po::value<bool>()->default_value(false), "DB vacuum (compact)")
-            (cli::BBS_ENABLE, po::value<bool>()->default_value(true), "Enable SBBS messaging")
-            (cli::CRASH, po::value<int>()->default_value(0), "Induce crash (test proper handling)")
-            (cli::OWNER_KEY, po::value<string>(), "Owner viewer key")
-            (cli::KEY_OWNER, po::value<string>(), "Owner viewer key (deprecated)")
-            (cli::MINER_KEY, po::value<string>(), "Standalone miner key")
-            (cli::KEY_MINE, po::value<string>(), "Standalone miner key (deprecated)")
-            (cli::MINER_JOB_LATENCY, po::value<uint32_t>(), "Minimal latency in milliseconds for miner job update upon transaction pool change")
-            (cli::MINE_ONLINE, po::value<bool>(), "Perfer online mining when owner wallet is conntected")
-            (cli::PASS, po::value<string>(), "password for keys")
-            (cli::MULTI_OWNER_KEYS, po::value<vector<string> >(), "Extra Owner keys")
-            (cli::MULTI_PASSES, po::value<vector<string> >(), "Extra Owner key passwords")
-            (cli::OWNER_KEY_REMOVE_EP, po::value<vector<string> >(), "Remove extra Owner key")
-            (cli::OWNER_KEY_REMOVE_ALL, po::value<bool>()->default_value(false), "Remove all extra owner keys")
-            (cli::LOG_UTXOS, po::value<bool>()->default_value(false), "Log recovered UTXOs (make sure the log file is not exposed)")
-            (cli::FAST_SYNC, po::value<bool>(), "Fast sync on/off (override horizons)")
-            (cli::GENERATE_RECOVERY_PATH, po::value<string>(), "Recovery file to generate immediately after start")
-            (cli::RECOVERY_AUTO_PATH, po::value<string>(), "path and file prefix for recovery auto-generation")
-            (cli::RECOVERY_AUTO_PERIOD, po::value<uint32_t>()->default_value(30), "period (in blocks) for recovery auto-generation")
-            (cli::CONTRACT_RICH_INFO, po::value<bool>(), "Set to save rich contract invocation info")
-            (cli::CONTRACT_RICH_PARSER, po::value<std::string>(), "Optional shader to parse contract invocation info")
-            ;
-
-        po::options_description node_treasury_options("Node treasury options");
-        node_treasury_options.add_options()
-            (cli::TREASURY_BLOCK, po::value<string>()->default_value("treasury.mw"), "Block pack to import treasury from");
-
-        po::options_description wallet_options("Wallet");
-        wallet_options.add_options()
-            (cli::COMMAND, po::value<string>(), "execute a specific command")
-            (cli::PASS, po::value<string>(), "wallet password")
-            (cli::SEED_PHRASE, po::value<string>(), "seed phrase to generate the secret key from according to BIP-39.")
-            (cli::AMOUNT_FULL, po::value<string>(), "amount to send (in Beams, 1 Beam = 100,000,000 groth)")
-            (cli::FEE_FULL, po::value<Positive<Amount>>(), "transaction fee (in Groth, 100,000,000 groth = 1 Beam)")
-            (cli::RECEIVER_ADDR_FULL, po::value<string>(), "receiver address or token")
-            (cli::NODE_ADDR_FULL, po::value<string>(), "beam node address")
-            (cli::WALLET_STORAGE, po::value<string>()->default_value("wallet.db"), "path to the wallet database file")
-            (cli::CONFIRMATIONS_COUNT, po::value<Nonnegative<uint32_t>>()->default_value(Nonnegative<uint32_t>(0)), "count of confirmations before you can't spend coin")
-            (cli::TX_HISTORY, "print transaction history (should be used with info command)")
-            (cli::UTXO_LIST, "print the list of UTXOs (should be used with info command)")
-            (cli::LISTEN, "start listen after new_addr command")
-            (cli::TX_ID, po::value<string>()->default_value(""), "transaction id")
-            (cli::NEW_ADDRESS_COMMENT, po::value<string>()->default_value(""), "comment for the newly created token or address")
-            (cli::EXPIRATION_TIME, po::value<string>()->default_value(cli::EXPIRATION_TIME_AUTO), "expiration time for own address [auto|never|now]")
-            (cli::GENERATE_PHRASE, "generate seed phrase which will be used to create a secret according to BIP-39")
-            (cli::KEY_SUBKEY, po::value<Positive<uint32_t>>(), "miner key index (use with export_miner_key)")
-            (cli::WALLET_ADDR, po::value<string>()->default_value("*"), "wallet address")
-            (cli::PAYMENT_PROOF_DATA, po::value<string>(), "payment proof data to verify")
-            (cli::HID_INSTALL_FILE, po::value<string>(), "App image file to install on HID device. If not specified - integrated image will be used")
-            (cli::UTXO, po::value<vector<string>>()->multitoken(), "set IDs of specific UTXO to send")
-            (cli::IMPORT_EXPORT_PATH, po::value<string>()->default_value("export.dat"), "path to import or export wallet data (should be used with import_data|export_data)")
-            (cli::IGNORE_DICTIONARY, "ignore dictionary for a specific seed phrase validation")
-            (cli::NODE_POLL_PERIOD, po::value<Nonnegative<uint32_t>>()->default_value(Nonnegative<uint32_t>(0)), "node poll period in milliseconds. Set to 0 to keep connection forever. Poll period would be no shorter than the expected rate of blocks if it is less then it will be rounded up to block rate value.")
-            (cli::PROXY_USE, po::value<bool>()->default_value(false), "use socks5 proxy server for node connection")
-            (cli::PROXY_ADDRESS, po::value<string>()->default_value("127.0.0.1:9150"), "proxy server address")
-            (cli::SHADER_ARGS, po::value<string>()->default_value(""), "Arguments to pass to the shader")
-            (cli::SHADER_PRIVILEGE, po::value<uint32_t>()->default_value(0), "shader privilege level")
-            (cli::SHADER_DEBUG, po::value<bool>()->default_value(false), "shader debug")
-            (cli::SHADER_BYTECODE_APP, po::value<string>()->default_value(""), "Path to the app shader file")
-            (cli::SHADER_BYTECODE_CONTRACT, po::value<string>()->default_value(""), "Path to the shader file for the contract (if the contract is being-created)")
-            (cli::SHADER_WIDGET_NAME, po::value<string>(), "Name of the widget")
-            (cli::MAX_PRIVACY_ADDRESS, po::bool_switch()->default_value(false), "generate max privacy transaction address")
-            (cli::OFFLINE_COUNT, po::value<Positive<uint32_t>>(), "generate offline transaction address with given number of payments")
-            (cli::PUBLIC_OFFLINE, po::bool_switch()->default_value(false), "generate an offline public address for donates (less secure, but more convenient)")
-            (cli::SEND_OFFLINE, po::bool_switch()->default_value(false), "send an offline payment (offline transaction)")
-            (cli::MINE_ONLINE, po::value<bool>(), "Support online mining when connected to owned miner node")
-            (cli::BLOCK_HEIGHT, po::value<Nonnegative<Height>>(), "block height")
-            (cli::REQUEST_BODIES, po::value<bool>()->default_value(false), "request and parse block bodies on the wallet side");
-
-        po::options_description wallet_treasury_options("Wallet treasury options");
-        wallet_treasury_options.add_options()
-            (cli::TR_OPCODE, po::value<uint32_t>()->default_value(0), "treasury operation: 0=print ID, 1=plan, 2=response, 3=import, 4=generate, 5=print")
-            (cli::TR_WID, po::value<std::string>(), "treasury WalletID")
-            (cli::TR_PERC, po::value<double>(), "treasury percent of the total emission, designated to this WalletID")
-            (cli::TR_PERC_TOTAL, po::value<double>(), "Total treasury percent of the total emission")
-            (cli::TR_M, po::value<uint32_t>()->default_value(0), "naggle index")
-            (cli::TR_N, po::value<uint32_t>()->default_value(1), "naggle count")
-            (cli::TR_COMMENT, po::value<std::string>(), "treasury custom message");
-
-        po::options_description uioptions("UI options");
-        uioptions.add_options()
-            (cli::WALLET_ADDR, po::value<vector<string>>()->multitoken())
-            (cli::APPDATA_PATH, po::value<string>());
-
-        po::options_description uidebug("UI debug options");
-        uidebug.add_options()
-            (cli::APPS_REMOTE_DEBUG_PORT, po::value<uint32_t>()->default_value(0), "contracts applications remote debug port");
-
-        po::options_description swap_options("Atomic swap");
-        swap_options.add_options()
-            (cli::ALTCOIN_SETTINGS_RESET, po::value<std::string>(), "reset altcoin's settings [core|electrum]")
-            (cli::ACTIVE_CONNECTION, po::value<string>(), "set active connection [core|electrum|none]")
-            (cli::ELECTRUM_SEED, po::value<string>(), "bitcoin electrum seed(use space as separator)")
-            (cli::GENERATE_ELECTRUM_SEED, "generate new electrum seed")
-            (cli::SELECT_SERVER_AUTOMATICALLY, po::value<bool>(), "select electrum server automatically")
-            (cli::ELECTRUM_ADDR, po::value<string>(), "set electrum wallet address")
-            (cli::ADDRESSES_TO_RECEIVE, po::value<Positive<uint32_t>>(), "number of electrum receiving addresses")
-            (cli::ADDRESSES_FOR_CHANGE, po::value<Positive<uint32_t>>(), "number of electrum change addresses")
-            (cli::SWAP_WALLET_ADDR, po::value<string>(), "rpc address of the swap wallet")
-            (cli::SWAP_WALLET_USER, po::value<string>(), "rpc user name for the swap wallet")
-            (cli::SWAP_WALLET_PASS, po::value<string>(), "rpc password for the swap wallet")
-            (cli::SWAP_COIN, po::value<string>(), "swap coin currency (BTC/LTC/QTUM/DASH/DOGE/ETH)")
-            (cli::SWAP_AMOUNT, po::value<Positive<Amount>>(), "swap amount in the smallest unit of the coin (e.g. satoshi for BTC)")
-            (cli::SWAP_FEERATE, po::value<Positive<Amount>>(), "specific feerate you are willing to pay (the smallest unit of the coin per KB)")
-            (cli::SWAP_BEAM_SIDE, "should be always set by the swap party who owns BEAM")
-            (cli::SWAP_TX_HISTORY, "print swap transaction history in info command")
-            (cli::SWAP_TOKEN, po::value<string>(), "transaction token for atomic swap")
-            (cli::ETHEREUM_SEED, po::value<string>(), "ethereum seed(use space as separator)")
-            (cli::INFURA_PROJECT_ID, po::value<string>(), "infura project ID")
-            (cli::ACCOUNT_INDEX, po::value<Nonnegative<uint32_t>>(), "ethereum account index")
-            (cli::SHOULD_CONNECT, po::value<bool>(), "connect to ethereum [true|false]")
-            (cli::ETH_GAS_PRICE, po::value<Positive<Amount>>(), "gas price in the gwei")
-            (cli::ETH_SWAP_AMOUNT, po::value<string>(), "swap amount in the ethereums or tokens");
-
-        po::options_description wallet_assets_options("Confidential assets");
-        wallet_assets_options.add_options()
-            (cli::ASSET_ID,         po::value<Positive<uint32_t>>(), "asset ID")
-            (cli::ASSET_METADATA,   po::value<string>(), "asset metadata")
-            (cli::WITH_ASSETS,      po::bool_switch()->default_value(false), "enable confidential assets transactions");
-
-#ifdef BEAM_ASSET_SWAP_SUPPORT
-        po::options_description assets_swap_options("Assets swap");
-        assets_swap_options.add_options()
-            (cli::ASSETS_SWAP_LIST, "view available assets swap list")
-            (cli::ASSETS_SWAP_CREATE, "create asset swap offer")
-            (cli::ASSETS_SWAP_CANCEL, "cancel asset swap offer, arg - offer id")
-            (cli::ASSETS_SWAP_ACCEPT, "accept asset swap offer, arg - offer id")
-            (cli::ASSETS_SWAP_SEND_ASSET_ID, po::value<Nonnegative<uint32_t>>(), "send asset ID")
-            (cli::ASSETS_SWAP_RECEIVE_ASSET_ID, po::value<Nonnegative<uint32_t>>(), "receive asset ID")
-            (cli::ASSETS_SWAP_SEND_AMOUNT, po::value<Positive<double>>(), "amount to send")
-            (cli::ASSETS_SWAP_RECEIVE_AMOUNT, po::value<Positive<double>>(), "amount to receive")
-            (cli::ASSETS_SWAP_EXPIRATION, po::value<uint32_t>()->default_value(30), "expiration time in minutes")
-            (cli::ASSETS_SWAP_OFFER_ID, po::value<string>()->default_value(""), "offer id");
-
-#endif  // BEAM_ASSET_SWAP_SUPPORT
-
-        #ifdef BEAM_LASER_SUPPORT
-        po::options_description laser_options("Laser beam");
-        laser_options.add_options()
-            (cli::LASER_LIST, "print all opened lightning channel")
-            (cli::LASER_WAIT, "wait for open incoming lightning channel")
-            (cli::LASER_OPEN, "open lightning channel")
-            (cli::LASER_SERVE, po::value<string>()->implicit_value(""), "listen to lightning channels")
-            (cli::LASER_TRANSFER, po::value<Positive<double>>(), "send to lightning channel")
-            (cli::LASER_CLOSE_GRACEFUL, po::value<string>()->implicit_value(""), "close lightning channel (use before the lock time is up, only if the other side is online)")
-            (cli::LASER_DROP, po::value<string>()->implicit_value(""), "drop opened lightning channel (use after lock time is up or if the other side is offline)")
-            (cli::LASER_DELETE, po::value<string>()->implicit_value(""), "delete closed laser channel from the wallet database")
-
-            (cli::LASER_AMOUNT_MY, po::value<NonnegativeFloatingPoint<double>>(), "amount to lock in channel on the owned side (in Beams, 1 Beam = 100,000,000 groth)")
-            (cli::LASER_AMOUNT_TARGET, po::value<NonnegativeFloatingPoint<double>>(), "amount to lock in channel on the target side (in Beams, 1 Beam = 100,000,000 groth)")
-            (cli::LASER_TARGET_ADDR, po::value<string>(), "address of laser receiver")
-            (cli::LASER_FEE, po::value<Nonnegative<Amount>>(), "transaction fee (in GROTH, 100,000,000 groth = 1 BEAM)")
-            (cli::LASER_CHANNEL_ID, po::value<string>(), "laser channel ID");
-        #endif
-
         po::options_description options{ "OPTIONS" };
         po::options_description visible_options{ "OPTIONS" };
 
+        // Only the groups of the requested flags are built, each binary needs a fraction of them
+
         if (flags & GENERAL_OPTIONS)
         {
+            po::options_description general_options("General options");
+            general_options.add_options()
+                (cli::HELP_FULL, "list all available options and commands")
+                (cli::VERSION_FULL, "print project version")
+                (cli::LOG_LEVEL, po::value<string>(), "set log level [error|warning|info(default)|debug|verbose]")
+                (cli::FILE_LOG_LEVEL, po::value<string>(), "set file log level [error|warning|info(default)|debug|verbose]")
+                (cli::LOG_CLEANUP_DAYS, po::value<uint32_t>()->default_value(5), "old logfiles cleanup period(days)")
+                (cli::GIT_COMMIT_HASH, "print git commit hash value")
+                (cli::CONFIG_FILE_PATH, po::value<string>()->default_value(configFile), "path to the config file");
+
             options.add(general_options);
             visible_options.add(general_options);
         }
 
         if (flags & NODE_OPTIONS)
         {
+            po::options_description node_options("Node options");
+            node_options.add_options()
+                (cli::PORT_FULL, po::value<uint16_t>()->default_value(10000), "port to start the server on")
+                (cli::STORAGE, po::value<string>()->default_value("node.db"), "node storage path")
+                (cli::MINING_THREADS, po::value<uint32_t>()->default_value(0), "number of mining threads(there is no mining if 0). It works if FakePoW is enabled")
+                (cli::POW_SOLVE_TIME, po::value<uint32_t>()->default_value(15 * 1000), "pow solve time. It works if FakePoW is enabled")
+                (cli::LOG_ASYNC, po::value<bool>()->default_value(false), "write the log on a background thread, logging calls only enqueue the messages")
+                (cli::LOG_BINARY, po::value<bool>()->default_value(false), "write the file log in the structured binary format (.blog), use log_decoder to read it")
+
+                (cli::VERIFICATION_THREADS, po::value<int>()->default_value(-1), "number of threads for cryptographic verifications (0 = single thread, -1 = auto)")
+                (cli::VERIFICATION_BATCH_BLOCKS, po::value<uint32_t>()->default_value(1000), "max number of consecutive blocks batch-verified together during sync (0 = unlimited)")
+                (cli::READ_THREADS, po::value<uint32_t>()->default_value(0), "number of threads serving read-only peer queries (contract vars/logs) concurrently with block processing (0 = main thread)")
+                (cli::CPUS_REACTOR, po::value<string>(), "cores for the main (reactor) thread, such as 0-1,4. Any by default")
+                (cli::CPUS_VERIFICATION, po::value<string>(), "cores for the verification threads. Any by default")
+                (cli::CPUS_MINING, po::value<string>(), "cores for the mining threads. Any by default")
+                (cli::NICE_REACTOR, po::value<int>()->default_value(0), "nice value of the main (reactor) thread (negative needs privileges). 0 = unchanged")
+                (cli::NICE_VERIFICATION, po::value<int>()->default_value(0), "nice value of the verification threads. 0 = unchanged")
+                (cli::NICE_MINING, po::value<int>()->default_value(0), "nice value of the mining threads. 0 = unchanged")
+                (cli::MEM_SOFT_LIMIT, po::value<uint32_t>()->default_value(0), "soft limit of the node memory (MB). Above it the caches and the transaction pool are shrunk. 0 = no limit")
+                (cli::MEM_REPORT_PERIOD, po::value<uint32_t>()->default_value(0), "period of the memory usage report in the log, per subsystem (seconds). 0 = never")
+                (cli::MEMPOOL_MAX_SIZE, po::value<uint32_t>()->default_value(512), "max memory of the transaction pool (MB), the least profitable transactions are evicted. 0 = unlimited")
+                (cli::TX_SKETCH_CELLS, po::value<uint32_t>()->default_value(240), "tx pool sketch size sent to peers on connect, to receive only the missing transactions. 0 = disable")
+                (cli::TX_TRICKLE, po::value<uint32_t>()->default_value(250), "mean randomized delay (ms) of the batched transaction announcements to each outbound peer, twice for inbound. 0 = announce immediately")
+                (cli::MEMPOOL_PERSIST, po::value<bool>()->default_value(false), "save the transaction pool on shutdown, and re-validate it on startup")
+                (cli::LISTEN_REUSE_PORT, po::value<bool>()->default_value(false), "listen with SO_REUSEPORT, the port may be shared with other listeners")
+                (cli::DB_WAL, po::value<bool>()->default_value(false), "use WAL journaling for the node DB, with checkpoints on a dedicated thread")
+                (cli::DB_WAL_CHECKPOINT_INTERVAL, po::value<uint32_t>()->default_value(5000), "interval between WAL checkpoints, in milliseconds")
+                (cli::DB_COMPACTION_PERIOD, po::value<uint32_t>()->default_value(0), "online DB compaction period, in milliseconds. 0 to disable. An existing DB needs a single vacuum to enable it")
+                (cli::DB_COMPACTION_BUDGET, po::value<uint32_t>()->default_value(20), "max time spent on the online DB compaction per period, in milliseconds")
+                (cli::FAST_SYNC_RANGES, po::value<uint32_t>()->default_value(8), "max number of block ranges downloaded concurrently from different peers during fast-sync (1 = sequential)")
+                (cli::NONCEPREFIX_DIGITS, po::value<unsigned>()->default_value(0), "number of hex digits for nonce prefix for stratum client (0..6)")
+                (cli::NODE_PEER, po::value<vector<string>>()->multitoken(), "nodes to connect to")
+                (cli::NODE_PEERS_PERSISTENT, po::value<bool>()->default_value(false), "Keep persistent connection to the specified peers, regardless to ratings")
+                (cli::CLUSTER_SECRET, po::value<string>(), "nodes with the same secret discover each other by beacons, stay connected and get new blocks first")
+                (cli::CLUSTER_BEACON_TARGETS, po::value<vector<string>>()->multitoken(), "additional unicast beacon destinations, for cluster members outside of the local broadcast domain")
+                (cli::STRATUM_PORT, po::value<uint16_t>()->default_value(0), "port to start stratum server on")
+                (cli::METRICS_PORT, po::value<uint16_t>()->default_value(0), "port to serve the metrics on (GET /metrics, Prometheus text format). 0 = disabled")
+                (cli::PROFILE_SCOPES, po::value<bool>()->default_value(false), "measure the time spent on the hot paths (block handling, validation, DB commits, contracts, peer messages). Exported via the metrics, and dumped to the log on SIGUSR1")
+                (cli::STRATUM_SECRETS_PATH, po::value<string>()->default_value("."), "path to stratum server api keys file, and tls certificate and private key")
+                (cli::STRATUM_USE_TLS, po::value<bool>()->default_value(true), "enable TLS on startum server")
+                (cli::STRATUM_SHARE_INTERVAL, po::value<unsigned>()->default_value(0), "stratum vardiff: target seconds between shares of each miner, 0 - disabled (every share must meet the network difficulty)")
+                (cli::WEBSOCKET_PORT, po::value<uint16_t>()->default_value(0), "port to start websocket server on, it allows to communicate with node from web browser")
+                (cli::WEBSOCKET_SECRETS_PATH, po::value<string>()->default_value("."), "path to websocket server api keys file, and tls certificate and private key")
+                (cli::WEBSOCKET_USE_TLS, po::value<bool>()->default_value(true), "enable TLS on websocket server")
+                (cli::WEBSOCKET_KEY, po::value<string>()->default_value("wskey.pem"), "name of the private key file for websocket server")
+                (cli::WEBSOCKET_CERT, po::value<string>()->default_value("wscert.pem"), "name of the certificate file for websocket server")
+                (cli::WEBSOCKET_DH, po::value<string>()->default_value("wsdhparams.pem"), "name of the DH params file for websocket server")
+                (cli::RESET_ID, po::value<bool>()->default_value(false), "Reset self ID (used for network authentication). Must do if the node is cloned")
+                (cli::ERASE_ID, po::value<bool>()->default_value(false), "Reset self ID (used for network authentication) and stop before re-creating the new one.")
+                (cli::PRINT_TXO, po::value<bool>()->default_value(false), "Print TXO movements (create/spend) recognized by the owner key.")
+                (cli::PRINT_ROLLBACK_STATS, po::value<bool>()->default_value(false), "Analyze and print recent reverted branches, check if there were double-spends.")
+                (cli::MANUAL_ROLLBACK, po::value<Height>(), "Explicit rollback to height. The current consequent state will be forbidden (no automatic going up the same path)")
+                (cli::MANUAL_SELECT, po::value<std::string>(), "Explicit correct block selection at the specified height. Auto-rollback below this height if current branch is different")
+                (cli::CHECKDB, po::value<bool>()->default_value(false), "DB integrity check")
+                (cli::CHECKDB_THREADS, po::value<uint32_t>()->default_value(0), "split the DB integrity check across threads (quick_check + tables/indexes traversal), 0 or 1 for the full single-threaded check")
+                (cli::CHECKDB_AFTER_CRASH, po::value<bool>()->default_value(false), "check the recently modified DB data, if the node wasn't shut down properly")
+                (cli::VACUUM, po::value<bool>()->default_value(false), "DB vacuum (compact)")
+                (cli::PERSIST_VALIDATED_CACHE, po::value<bool>()->default_value(false), "Save the cache of validated transactions on shutdown, and reload it on start")
+                (cli::DB_MMAP_SIZE, po::value<uint32_t>()->default_value(0), "DB memory-mapped I/O size (MB), 0 to disable")
+                (cli::MMR_PIN_FROM_LEVEL, po::value<uint32_t>()->default_value(0), "keep the MMR nodes (states, shielded, assets) from this level and up in memory, 0 to disable. Each level down doubles the memory")
+                (cli::MEM_CACHE_KERNEL_PROOFS, po::value<uint32_t>()->default_value(0), "in-memory cache size (MB) for kernel proofs served to wallets, 0 to disable")
+                (cli::EXTERNAL_BODIES, po::value<bool>()->default_value(false), "store new block bodies in append-only files next to the DB, instead of the DB itself (can't be reverted)")
+                (cli::MAPPING_RANDOM_ACCESS, po::value<bool>()->default_value(false), "hint the random access pattern for the UTXO image mapping (disables read-ahead)")
+                (cli::MAPPING_HUGE_PAGES, po::value<bool>()->default_value(false), "use transparent huge pages for the UTXO image mapping, if supported by the OS and the file system")
+                (cli::MAPPING_PREFAULT, po::value<bool>()->default_value(false), "load the whole UTXO image into memory on start")
+                (cli::MAPPING_COMPACT, po::value<bool>()->default_value(false), "compact the UTXO image on start if most of it is free space (temporarily needs memory for the whole UTXO set)")
+                (cli::MAPPING_REPORT, po::value<bool>()->default_value(false), "log the UTXO image footprint on start: per-type element counts, free space, average tree depth")
+                (cli::BULK_LOAD_SYNC, po::value<bool>()->default_value(false), "DB bulk-load mode during fast-sync: deferred indexes, no disk syncs (the DB may be corrupted on power failure)")
+                (cli::BBS_ENABLE, po::value<bool>()->default_value(true), "Enable SBBS messaging")
+                (cli::CRASH, po::value<int>()->default_value(0), "Induce crash (test proper handling)")
+                (cli::OWNER_KEY, po::value<string>(), "Owner viewer key")
+                (cli::KEY_OWNER, po::value<string>(), "Owner viewer key (deprecated)")
+                (cli::MINER_KEY, po::value<string>(), "Standalone miner key")
+                (cli::KEY_MINE, po::value<string>(), "Standalone miner key (deprecated)")
+                (cli::MINER_JOB_LATENCY, po::value<uint32_t>(), "Minimal latency in milliseconds for miner job update upon transaction pool change")
+                (cli::MINE_ONLINE, po::value<bool>(), "Perfer online mining when owner wallet is conntected")
+                (cli::PASS, po::value<string>(), "password for keys")
+                (cli::MULTI_OWNER_KEYS, po::value<vector<string> >(), "Extra Owner keys")
+                (cli::MULTI_PASSES, po::value<vector<string> >(), "Extra Owner key passwords")
+                (cli::OWNER_KEY_REMOVE_EP, po::value<vector<string> >(), "Remove extra Owner key")
+                (cli::OWNER_KEY_REMOVE_ALL, po::value<bool>()->default_value(false), "Remove all extra owner keys")
+                (cli::LOG_UTXOS, po::value<bool>()->default_value(false), "Log recovered UTXOs (make sure the log file is not exposed)")
+                (cli::FAST_SYNC, po::value<bool>(), "Fast sync on/off (override horizons)")
+                (cli::PRUNE_DAYS, po::value<uint32_t>(), "Pruning node: keep spent outputs of the last N days only (headers and kernels are always kept). Implies fast sync, overrides its horizons")
+                (cli::GENERATE_RECOVERY_PATH, po::value<string>(), "Recovery file to generate immediately after start")
+                (cli::SNAPSHOT_EXPORT, po::value<string>(), "Node state snapshot file to generate immediately after start")
+                (cli::SNAPSHOT_IMPORT, po::value<string>(), "Node state snapshot file to bootstrap from, if the node DB doesn't exist yet")
+                (cli::RECOVERY_AUTO_PATH, po::value<string>(), "path and file prefix for recovery auto-generation")
+                (cli::RECOVERY_AUTO_PERIOD, po::value<uint32_t>()->default_value(30), "period (in blocks) for recovery auto-generation")
+                (cli::CONTRACT_RICH_INFO, po::value<bool>(), "Set to save rich contract invocation info")
+                (cli::CONTRACT_RICH_PARSER, po::value<std::string>(), "Optional shader to parse contract invocation info")
+                ;
+
+            po::options_description node_treasury_options("Node treasury options");
+            node_treasury_options.add_options()
+                (cli::TREASURY_BLOCK, po::value<string>()->default_value("treasury.mw"), "Block pack to import treasury from");
+
             options.add(node_options);
             options.add(node_treasury_options);
             visible_options.add(node_options);
@@ -589,28 +550,139 @@ namespace beam
 
         if (flags & WALLET_OPTIONS)
         {
+            po::options_description wallet_options("Wallet");
+            wallet_options.add_options()
+                (cli::COMMAND, po::value<string>(), "execute a specific command")
+                (cli::PASS, po::value<string>(), "wallet password")
+                (cli::SEED_PHRASE, po::value<string>(), "seed phrase to generate the secret key from according to BIP-39.")
+                (cli::AMOUNT_FULL, po::value<string>(), "amount to send (in Beams, 1 Beam = 100,000,000 groth)")
+                (cli::FEE_FULL, po::value<Positive<Amount>>(), "transaction fee (in Groth, 100,000,000 groth = 1 Beam)")
+                (cli::RECEIVER_ADDR_FULL, po::value<string>(), "receiver address or token")
+                (cli::NODE_ADDR_FULL, po::value<string>(), "beam node address")
+                (cli::WALLET_STORAGE, po::value<string>()->default_value("wallet.db"), "path to the wallet database file")
+                (cli::CONFIRMATIONS_COUNT, po::value<Nonnegative<uint32_t>>()->default_value(Nonnegative<uint32_t>(0)), "count of confirmations before you can't spend coin")
+                (cli::TX_HISTORY, "print transaction history (should be used with info command)")
+                (cli::UTXO_LIST, "print the list of UTXOs (should be used with info command)")
+                (cli::LISTEN, "start listen after new_addr command")
+                (cli::TX_ID, po::value<string>()->default_value(""), "transaction id")
+                (cli::NEW_ADDRESS_COMMENT, po::value<string>()->default_value(""), "comment for the newly created token or address")
+                (cli::EXPIRATION_TIME, po::value<string>()->default_value(cli::EXPIRATION_TIME_AUTO), "expiration time for own address [auto|never|now]")
+                (cli::GENERATE_PHRASE, "generate seed phrase which will be used to create a secret according to BIP-39")
+                (cli::KEY_SUBKEY, po::value<Positive<uint32_t>>(), "miner key index (use with export_miner_key)")
+                (cli::WALLET_ADDR, po::value<string>()->default_value("*"), "wallet address")
+                (cli::PAYMENT_PROOF_DATA, po::value<string>(), "payment proof data to verify")
+                (cli::HID_INSTALL_FILE, po::value<string>(), "App image file to install on HID device. If not specified - integrated image will be used")
+                (cli::UTXO, po::value<vector<string>>()->multitoken(), "set IDs of specific UTXO to send")
+                (cli::IMPORT_EXPORT_PATH, po::value<string>()->default_value("export.dat"), "path to import or export wallet data (should be used with import_data|export_data)")
+                (cli::IGNORE_DICTIONARY, "ignore dictionary for a specific seed phrase validation")
+                (cli::NODE_POLL_PERIOD, po::value<Nonnegative<uint32_t>>()->default_value(Nonnegative<uint32_t>(0)), "node poll period in milliseconds. Set to 0 to keep connection forever. Poll period would be no shorter than the expected rate of blocks if it is less then it will be rounded up to block rate value.")
+                (cli::PROXY_USE, po::value<bool>()->default_value(false), "use socks5 proxy server for node connection")
+                (cli::PROXY_ADDRESS, po::value<string>()->default_value("127.0.0.1:9150"), "proxy server address")
+                (cli::SHADER_ARGS, po::value<string>()->default_value(""), "Arguments to pass to the shader")
+                (cli::SHADER_PRIVILEGE, po::value<uint32_t>()->default_value(0), "shader privilege level")
+                (cli::SHADER_DEBUG, po::value<bool>()->default_value(false), "shader debug")
+                (cli::SHADER_BYTECODE_APP, po::value<string>()->default_value(""), "Path to the app shader file")
+                (cli::SHADER_BYTECODE_CONTRACT, po::value<string>()->default_value(""), "Path to the shader file for the contract (if the contract is being-created)")
+                (cli::SHADER_WIDGET_NAME, po::value<string>(), "Name of the widget")
+                (cli::MAX_PRIVACY_ADDRESS, po::bool_switch()->default_value(false), "generate max privacy transaction address")
+                (cli::OFFLINE_COUNT, po::value<Positive<uint32_t>>(), "generate offline transaction address with given number of payments")
+                (cli::PUBLIC_OFFLINE, po::bool_switch()->default_value(false), "generate an offline public address for donates (less secure, but more convenient)")
+                (cli::SEND_OFFLINE, po::bool_switch()->default_value(false), "send an offline payment (offline transaction)")
+                (cli::MINE_ONLINE, po::value<bool>(), "Support online mining when connected to owned miner node")
+                (cli::BLOCK_HEIGHT, po::value<Nonnegative<Height>>(), "block height")
+                (cli::REQUEST_BODIES, po::value<bool>()->default_value(false), "request and parse block bodies on the wallet side");
+
+            po::options_description wallet_treasury_options("Wallet treasury options");
+            wallet_treasury_options.add_options()
+                (cli::TR_OPCODE, po::value<uint32_t>()->default_value(0), "treasury operation: 0=print ID, 1=plan, 2=response, 3=import, 4=generate, 5=print")
+                (cli::TR_WID, po::value<std::string>(), "treasury WalletID")
+                (cli::TR_PERC, po::value<double>(), "treasury percent of the total emission, designated to this WalletID")
+                (cli::TR_PERC_TOTAL, po::value<double>(), "Total treasury percent of the total emission")
+                (cli::TR_M, po::value<uint32_t>()->default_value(0), "naggle index")
+                (cli::TR_N, po::value<uint32_t>()->default_value(1), "naggle count")
+                (cli::TR_COMMENT, po::value<std::string>(), "treasury custom message");
+
+            po::options_description swap_options("Atomic swap");
+            swap_options.add_options()
+                (cli::ALTCOIN_SETTINGS_RESET, po::value<std::string>(), "reset altcoin's settings [core|electrum]")
+                (cli::ACTIVE_CONNECTION, po::value<string>(), "set active connection [core|electrum|none]")
+                (cli::ELECTRUM_SEED, po::value<string>(), "bitcoin electrum seed(use space as separator)")
+                (cli::GENERATE_ELECTRUM_SEED, "generate new electrum seed")
+                (cli::SELECT_SERVER_AUTOMATICALLY, po::value<bool>(), "select electrum server automatically")
+                (cli::ELECTRUM_ADDR, po::value<string>(), "set electrum wallet address")
+                (cli::ADDRESSES_TO_RECEIVE, po::value<Positive<uint32_t>>(), "number of electrum receiving addresses")
+                (cli::ADDRESSES_FOR_CHANGE, po::value<Positive<uint32_t>>(), "number of electrum change addresses")
+                (cli::SWAP_WALLET_ADDR, po::value<string>(), "rpc address of the swap wallet")
+                (cli::SWAP_WALLET_USER, po::value<string>(), "rpc user name for the swap wallet")
+                (cli::SWAP_WALLET_PASS, po::value<string>(), "rpc password for the swap wallet")
+                (cli::SWAP_COIN, po::value<string>(), "swap coin currency (BTC/LTC/QTUM/DASH/DOGE/ETH)")
+                (cli::SWAP_AMOUNT, po::value<Positive<Amount>>(), "swap amount in the smallest unit of the coin (e.g. satoshi for BTC)")
+                (cli::SWAP_FEERATE, po::value<Positive<Amount>>(), "specific feerate you are willing to pay (the smallest unit of the coin per KB)")
+                (cli::SWAP_BEAM_SIDE, "should be always set by the swap party who owns BEAM")
+                (cli::SWAP_TX_HISTORY, "print swap transaction history in info command")
+                (cli::SWAP_TOKEN, po::value<string>(), "transaction token for atomic swap")
+                (cli::ETHEREUM_SEED, po::value<string>(), "ethereum seed(use space as separator)")
+                (cli::INFURA_PROJECT_ID, po::value<string>(), "infura project ID")
+                (cli::ACCOUNT_INDEX, po::value<Nonnegative<uint32_t>>(), "ethereum account index")
+                (cli::SHOULD_CONNECT, po::value<bool>(), "connect to ethereum [true|false]")
+                (cli::ETH_GAS_PRICE, po::value<Positive<Amount>>(), "gas price in the gwei")
+                (cli::ETH_SWAP_AMOUNT, po::value<string>(), "swap amount in the ethereums or tokens");
+
             options.add(wallet_options);
             options.add(wallet_treasury_options);
             options.add(swap_options);
 
-            if(Rules::get().CA.Enabled)
-            {
-                options.add(wallet_assets_options);
-            }
-
             visible_options.add(wallet_options);
             visible_options.add(swap_options);
 
             if(Rules::get().CA.Enabled)
             {
+                po::options_description wallet_assets_options("Confidential assets");
+                wallet_assets_options.add_options()
+                    (cli::ASSET_ID,         po::value<Positive<uint32_t>>(), "asset ID")
+                    (cli::ASSET_METADATA,   po::value<string>(), "asset metadata")
+                    (cli::WITH_ASSETS,      po::bool_switch()->default_value(false), "enable confidential assets transactions");
+
+                options.add(wallet_assets_options);
                 visible_options.add(wallet_assets_options);
+
 #ifdef BEAM_ASSET_SWAP_SUPPORT
+                po::options_description assets_swap_options("Assets swap");
+                assets_swap_options.add_options()
+                    (cli::ASSETS_SWAP_LIST, "view available assets swap list")
+                    (cli::ASSETS_SWAP_CREATE, "create asset swap offer")
+                    (cli::ASSETS_SWAP_CANCEL, "cancel asset swap offer, arg - offer id")
+                    (cli::ASSETS_SWAP_ACCEPT, "accept asset swap offer, arg - offer id")
+                    (cli::ASSETS_SWAP_SEND_ASSET_ID, po::value<Nonnegative<uint32_t>>(), "send asset ID")
+                    (cli::ASSETS_SWAP_RECEIVE_ASSET_ID, po::value<Nonnegative<uint32_t>>(), "receive asset ID")
+                    (cli::ASSETS_SWAP_SEND_AMOUNT, po::value<Positive<double>>(), "amount to send")
+                    (cli::ASSETS_SWAP_RECEIVE_AMOUNT, po::value<Positive<double>>(), "amount to receive")
+                    (cli::ASSETS_SWAP_EXPIRATION, po::value<uint32_t>()->default_value(30), "expiration time in minutes")
+                    (cli::ASSETS_SWAP_OFFER_ID, po::value<string>()->default_value(""), "offer id");
+
                 options.add(assets_swap_options);
                 visible_options.add(assets_swap_options);
 #endif  // BEAM_ASSET_SWAP_SUPPORT
             }
 
             #ifdef BEAM_LASER_SUPPORT
+            po::options_description laser_options("Laser beam");
+            laser_options.add_options()
+                (cli::LASER_LIST, "print all opened lightning channel")
+                (cli::LASER_WAIT, "wait for open incoming lightning channel")
+                (cli::LASER_OPEN, "open lightning channel")
+                (cli::LASER_SERVE, po::value<string>()->implicit_value(""), "listen to lightning channels")
+                (cli::LASER_TRANSFER, po::value<Positive<double>>(), "send to lightning channel")
+                (cli::LASER_CLOSE_GRACEFUL, po::value<string>()->implicit_value(""), "close lightning channel (use before the lock time is up, only if the other side is online)")
+                (cli::LASER_DROP, po::value<string>()->implicit_value(""), "drop opened lightning channel (use after lock time is up or if the other side is offline)")
+                (cli::LASER_DELETE, po::value<string>()->implicit_value(""), "delete closed laser channel from the wallet database")
+
+                (cli::LASER_AMOUNT_MY, po::value<NonnegativeFloatingPoint<double>>(), "amount to lock in channel on the owned side (in Beams, 1 Beam = 100,000,000 groth)")
+                (cli::LASER_AMOUNT_TARGET, po::value<NonnegativeFloatingPoint<double>>(), "amount to lock in channel on the target side (in Beams, 1 Beam = 100,000,000 groth)")
+                (cli::LASER_TARGET_ADDR, po::value<string>(), "address of laser receiver")
+                (cli::LASER_FEE, po::value<Nonnegative<Amount>>(), "transaction fee (in GROTH, 100,000,000 groth = 1 BEAM)")
+                (cli::LASER_CHANNEL_ID, po::value<string>(), "laser channel ID");
+
             options.add(laser_options);
             visible_options.add(laser_options);
             #endif
@@ -618,6 +690,15 @@ namespace beam
 
         if (flags & UI_OPTIONS)
         {
+            po::options_description uioptions("UI options");
+            uioptions.add_options()
+                (cli::WALLET_ADDR, po::value<vector<string>>()->multitoken())
+                (cli::APPDATA_PATH, po::value<string>());
+
+            po::options_description uidebug("UI debug options");
+            uidebug.add_options()
+                (cli::APPS_REMOTE_DEBUG_PORT, po::value<uint32_t>()->default_value(0), "contracts applications remote debug port");
+
             options.add(uioptions);
             visible_options.add(uioptions);
             options.add(uidebug);
@@ -762,9 +843,21 @@ namespace beam
         return rules_options;
     }
 
+    namespace
+    {
+        const char* const s_szCfgCommon = "beam-common.cfg";
+    }
+
     boost::optional<std::string> ReadCfgFromFile(po::variables_map& vm, const po::options_description& desc)
     {
-        return ReadCfgFromFile(vm, desc, vm[cli::CONFIG_FILE_PATH].as<std::string>().c_str());
+        const auto& sFile = vm[cli::CONFIG_FILE_PATH].as<std::string>();
+
+        // it's always read after the common config, no need to parse the same file twice
+        const auto fullPath = boost::filesystem::system_complete(sFile).string();
+        if (fullPath == boost::filesystem::system_complete(s_szCfgCommon).string())
+            return boost::filesystem::exists(fullPath) ? boost::optional<std::string>(fullPath) : boost::none;
+
+        return ReadCfgFromFile(vm, desc, sFile.c_str());
     }
 
     boost::optional<std::string> ReadCfgFromFile(po::variables_map& vm, const po::options_description& desc, const char* szFile)
@@ -781,7 +874,7 @@ namespace beam
 
     boost::optional<std::string> ReadCfgFromFileCommon(po::variables_map& vm, const po::options_description& desc)
     {
-        return ReadCfgFromFile(vm, desc, "beam-common.cfg");
+        return ReadCfgFromFile(vm, desc, s_szCfgCommon);
     }
 
     po::variables_map getOptions(int argc, char* argv[], const po::options_description& options, bool walletOptions)
@@ -35,6 +35,7 @@ namespace beam
         extern const char* STRATUM_PORT;
         extern const char* STRATUM_SECRETS_PATH;
         extern const char* STRATUM_USE_TLS;
+        extern const char* STRATUM_SHARE_INTERVAL;
         extern const char* WEBSOCKET_PORT;
         extern const char* WEBSOCKET_SECRETS_PATH;
         extern const char* WEBSOCKET_USE_TLS;
@@ -46,9 +47,33 @@ namespace beam
         extern const char* MINING_THREADS;
         extern const char* POW_SOLVE_TIME;
         extern const char* VERIFICATION_THREADS;
+        extern const char* VERIFICATION_BATCH_BLOCKS;
+        extern const char* FAST_SYNC_RANGES;
+        extern const char* READ_THREADS;
+        extern const char* CPUS_REACTOR;
+        extern const char* CPUS_VERIFICATION;
+        extern const char* CPUS_MINING;
+        extern const char* NICE_REACTOR;
+        extern const char* NICE_VERIFICATION;
+        extern const char* NICE_MINING;
+        extern const char* MEM_SOFT_LIMIT;
+        extern const char* MEM_REPORT_PERIOD;
+        extern const char* METRICS_PORT;
+        extern const char* PROFILE_SCOPES;
+        extern const char* MEMPOOL_MAX_SIZE;
+        extern const char* TX_SKETCH_CELLS;
+        extern const char* TX_TRICKLE;
+        extern const char* MEMPOOL_PERSIST;
+        extern const char* LISTEN_REUSE_PORT;
+        extern const char* DB_WAL;
+        extern const char* DB_WAL_CHECKPOINT_INTERVAL;
+        extern const char* DB_COMPACTION_PERIOD;
+        extern const char* DB_COMPACTION_BUDGET;
         extern const char* NONCEPREFIX_DIGITS;
         extern const char* NODE_PEER;
         extern const char* NODE_PEERS_PERSISTENT;
+        extern const char* CLUSTER_SECRET;
+        extern const char* CLUSTER_BEACON_TARGETS;
         extern const char* PASS;
         extern const char* SET_SWAP_SETTINGS;
         extern const char* ACTIVE_CONNECTION;
@@ -84,7 +109,20 @@ namespace beam
         extern const char* CONTRACT_RICH_INFO;
         extern const char* CONTRACT_RICH_PARSER;
         extern const char* CHECKDB;
+        extern const char* CHECKDB_THREADS;
+        extern const char* CHECKDB_AFTER_CRASH;
         extern const char* VACUUM;
+        extern const char* PERSIST_VALIDATED_CACHE;
+        extern const char* BULK_LOAD_SYNC;
+        extern const char* EXTERNAL_BODIES;
+        extern const char* MAPPING_RANDOM_ACCESS;
+        extern const char* MAPPING_HUGE_PAGES;
+        extern const char* MAPPING_PREFAULT;
+        extern const char* MAPPING_COMPACT;
+        extern const char* MAPPING_REPORT;
+        extern const char* MEM_CACHE_KERNEL_PROOFS;
+        extern const char* DB_MMAP_SIZE;
+        extern const char* MMR_PIN_FROM_LEVEL;
         extern const char* CRASH;
         extern const char* INIT;
         extern const char* RESTORE;
@@ -137,6 +175,8 @@ namespace beam
         extern const char* LOG_DEBUG;
         extern const char* LOG_VERBOSE;
         extern const char* LOG_CLEANUP_DAYS;
+        extern const char* LOG_ASYNC;
+        extern const char* LOG_BINARY;
         extern const char* LOG_UTXOS;
         extern const char* VERSION;
         extern const char* VERSION_FULL;
@@ -154,7 +194,10 @@ namespace beam
         extern const char* IMPORT_EXPORT_PATH;
         extern const char* IP_WHITELIST;
         extern const char* FAST_SYNC;
+        extern const char* PRUNE_DAYS;
         extern const char* GENERATE_RECOVERY_PATH;
+        extern const char* SNAPSHOT_EXPORT;
+        extern const char* SNAPSHOT_IMPORT;
         extern const char* RECOVERY_AUTO_PATH;
         extern const char* RECOVERY_AUTO_PERIOD;
         extern const char* SWAP_INIT;
@@ -219,6 +262,7 @@ namespace beam
         extern const char* API_ACL_PATH;
         extern const char* API_VERSION;
         extern const char* API_TCP_MAX_LINE;
+        extern const char* API_EXTRA_WALLETS;
 
         // treasury
         extern const char* TR_OPCODE;
@@ -177,10 +177,15 @@ namespace beam
 
 		m_Run = true;
 		m_pCtl = nullptr;
+		m_CtlGeneration = 0;
 		m_InProgress = 0;
-		m_FlushTarget = static_cast<uint32_t>(-1);
+		m_FlushTarget1 = 0;
+		m_Queued = 0;
+		m_Sleeping = 0;
+		m_iNextQueue = 0;
 
 		uint32_t nThreads = get_Threads();
+		m_pQueues.reset(new Queue[nThreads]);
 		m_vThreads.resize(nThreads);
 
 		for (uint32_t i = 0; i < nThreads; i++)
@@ -189,15 +194,65 @@ namespace beam
 
 	void ExecutorMT::Push(TaskAsync::Ptr&& pTask)
 	{
-		assert(pTask);
+		assert(pTask && (pTask->m_Priority < Priority::count));
 		InitSafe();
 
-		std::unique_lock<std::mutex> scope(m_Mutex);
+		uint32_t nThreads = static_cast<uint32_t>(m_vThreads.size());
+		uint32_t iQueue = (pTask->m_iThread < nThreads) ? pTask->m_iThread : (m_iNextQueue++ % nThreads);
 
-		m_queTasks.push_back(*pTask.release());
 		m_InProgress++;
 
-		m_NewTask.notify_one();
+		{
+			Queue& q = m_pQueues[iQueue];
+			std::unique_lock<std::mutex> scope(q.m_Mutex);
+			q.m_pLst[pTask->m_Priority].push_back(*pTask.release());
+			m_Queued++;
+		}
+
+		if (m_Sleeping)
+		{
+			std::unique_lock<std::mutex> scope(m_Mutex);
+			m_NewTask.notify_one();
+		}
+	}
+
+	ExecutorMT::TaskAsync* ExecutorMT::PopTask(uint32_t iThread)
+	{
+		if (!m_Queued)
+			return nullptr;
+
+		uint32_t nThreads = static_cast<uint32_t>(m_vThreads.size());
+
+		for (uint32_t iPriority = Priority::count; iPriority--; )
+		{
+			// own queue from the front, others are stolen from the back
+			for (uint32_t i = 0; i < nThreads; i++)
+			{
+				Queue& q = m_pQueues[(iThread + i) % nThreads];
+				std::unique_lock<std::mutex> scope(q.m_Mutex);
+
+				auto& lst = q.m_pLst[iPriority];
+				if (lst.empty())
+					continue;
+
+				TaskAsync* pTask;
+				if (i)
+				{
+					pTask = &lst.back();
+					lst.pop_back();
+				}
+				else
+				{
+					pTask = &lst.front();
+					lst.pop_front();
+				}
+
+				m_Queued--;
+				return pTask;
+			}
+		}
+
+		return nullptr;
 	}
 
 	uint32_t ExecutorMT::Flush(uint32_t nMaxTasks)
@@ -212,12 +267,12 @@ namespace beam
 
 	void ExecutorMT::FlushLocked(std::unique_lock<std::mutex>& scope, uint32_t nMaxTasks)
 	{
-		m_FlushTarget = nMaxTasks;
+		m_FlushTarget1 = nMaxTasks + 1;
 
 		while (m_InProgress > nMaxTasks)
 			m_Flushed.wait(scope);
 
-		m_FlushTarget = static_cast<uint32_t>(-1);
+		m_FlushTarget1 = 0;
 	}
 
 	void ExecutorMT::ExecAll(TaskSync& t)
@@ -252,12 +307,24 @@ namespace beam
 			if (m_vThreads[i].joinable())
 				m_vThreads[i].join();
 
+		DeleteQueued();
+
 		m_vThreads.clear();
+		m_pQueues.reset();
+	}
 
-		while (!m_queTasks.empty())
+	void ExecutorMT::DeleteQueued()
+	{
+		for (uint32_t i = 0; i < m_vThreads.size(); i++)
 		{
-			TaskAsync::Ptr pGuard(&m_queTasks.front());
-			m_queTasks.pop_front();
+			for (auto& lst : m_pQueues[i].m_pLst)
+			{
+				while (!lst.empty())
+				{
+					TaskAsync::Ptr pGuard(&lst.front());
+					lst.pop_front();
+				}
+			}
 		}
 	}
 
@@ -267,60 +334,74 @@ namespace beam
 
 		while (true)
 		{
-			TaskAsync::Ptr pGuard;
-			TaskSync* pTask;
+			TaskAsync::Ptr pGuard(PopTask(ctx.m_iThread));
+			if (pGuard)
+			{
+				// standard task
+				pGuard->Exec(ctx);
+				pGuard.reset();
+
+				uint32_t nInProgress = --m_InProgress;
+				uint32_t nTarget1 = m_FlushTarget1;
+				if (nTarget1 && (nInProgress < nTarget1))
+				{
+					std::unique_lock<std::mutex> scope(m_Mutex);
+					m_Flushed.notify_all();
+				}
+
+				continue;
+			}
+
+			TaskSync* pCtl = nullptr;
 
 			{
 				std::unique_lock<std::mutex> scope(m_Mutex);
+				m_Sleeping++;
+
 				while (true)
 				{
 					if (!m_Run)
+					{
+						m_Sleeping--;
 						return;
+					}
 
-					if (!m_queTasks.empty())
-					{
-						pGuard.reset(&m_queTasks.front());
-						pTask = pGuard.get();
-						m_queTasks.pop_front();
+					if (m_Queued)
 						break;
-					}
 
 					if (m_pCtl)
 					{
-						pTask = m_pCtl;
+						pCtl = m_pCtl;
 						break;
 					}
 
 					m_NewTask.wait(scope);
 				}
+
+				m_Sleeping--;
 			}
 
-			assert(pTask && m_InProgress);
-			pTask->Exec(ctx);
+			if (!pCtl)
+				continue;
+
+			assert(m_InProgress);
+			pCtl->Exec(ctx);
 
 			std::unique_lock<std::mutex> scope(m_Mutex);
 
 			assert(m_InProgress);
-			m_InProgress--;
-
-			if (pGuard)
+			if (--m_InProgress)
 			{
-				// standard task
-				if (m_InProgress == m_FlushTarget)
-					m_Flushed.notify_one();
+				// make sure we give other threads opportuinty to execute the control task
+				for (uint32_t nGen = m_CtlGeneration; nGen == m_CtlGeneration; )
+					m_Flushed.wait(scope);
 			}
 			else
 			{
-				// control task
-				if (m_InProgress)
-					m_Flushed.wait(scope); // make sure we give other threads opportuinty to execute the control task
-				else
-				{
-					m_pCtl = nullptr;
-					m_Flushed.notify_all();
-				}
+				m_pCtl = nullptr;
+				m_CtlGeneration++;
+				m_Flushed.notify_all();
 			}
-
 		}
 	}
 
@@ -0,0 +1,357 @@
+// Copyright 2018-2020 The Beam Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "compress.h"
+#include <string.h>
+#include <vector>
+#include <algorithm>
+
+namespace beam
+{
+    namespace lz
+    {
+        namespace
+        {
+            const uint32_t HASH_LOG = 14;
+            const size_t MIN_MATCH = 4;
+            const size_t MAX_OFFSET = 0xffff;
+            const size_t LAST_LITERALS = 5; // as in the LZ4 format
+            const size_t MATCH_LIMIT = 12; // no match may start in the last 12 bytes
+
+            uint32_t read32(const uint8_t* p) {
+                uint32_t x;
+                memcpy(&x, p, sizeof(x));
+                return x;
+            }
+
+            uint32_t hash(uint32_t x) {
+                return (x * 2654435761u) >> (32 - HASH_LOG);
+            }
+
+            uint8_t* write_len(uint8_t* p, size_t n) {
+                for (; n >= 0xff; n -= 0xff)
+                    *p++ = 0xff;
+                *p++ = static_cast<uint8_t>(n);
+                return p;
+            }
+
+            uint8_t* write_literals(uint8_t* p, uint8_t& token, const uint8_t* src, size_t n) {
+                if (n >= 0xf) {
+                    token = 0xf0;
+                    p = write_len(p, n - 0xf);
+                } else {
+                    token = static_cast<uint8_t>(n << 4);
+                }
+
+                if (n)
+                    memcpy(p, src, n);
+                return p + n;
+            }
+
+            bool read_len(const uint8_t*& p, const uint8_t* end, size_t& n, size_t nMax) {
+                while (true) {
+                    if (p == end)
+                        return false;
+                    uint8_t x = *p++;
+                    n += x;
+                    if (n > nMax)
+                        return false;
+                    if (x != 0xff)
+                        return true;
+                }
+            }
+        }
+
+        size_t get_max_compressed_size(size_t size) {
+            return size + size / 0xff + 16;
+        }
+
+        size_t compress(uint8_t* dst, const uint8_t* src, size_t size) {
+            uint8_t* p = dst;
+            size_t anchor = 0;
+
+            if (size > MATCH_LIMIT) {
+                std::vector<uint32_t> table(size_t(1) << HASH_LOG);
+
+                const size_t limit = size - MATCH_LIMIT;
+                const size_t matchEnd = size - LAST_LITERALS;
+                size_t pos = 0;
+                uint32_t misses = 0;
+
+                while (pos < limit) {
+                    uint32_t x = read32(src + pos);
+                    uint32_t& slot = table[hash(x)];
+                    size_t ref = slot;
+                    slot = static_cast<uint32_t>(pos);
+
+                    if ((ref >= pos) || (pos - ref > MAX_OFFSET) || (read32(src + ref) != x)) {
+                        // skip faster over the incompressible data
+                        pos += 1 + (misses++ >> 6);
+                        continue;
+                    }
+
+                    misses = 0;
+
+                    size_t len = MIN_MATCH;
+                    while ((pos + len < matchEnd) && (src[ref + len] == src[pos + len]))
+                        len++;
+
+                    while ((pos > anchor) && ref && (src[pos - 1] == src[ref - 1])) {
+                        pos--;
+                        ref--;
+                        len++;
+                    }
+
+                    uint8_t* pToken = p++;
+                    p = write_literals(p, *pToken, src + anchor, pos - anchor);
+
+                    size_t offset = pos - ref;
+                    *p++ = static_cast<uint8_t>(offset);
+                    *p++ = static_cast<uint8_t>(offset >> 8);
+
+                    size_t n = len - MIN_MATCH;
+                    if (n >= 0xf) {
+                        *pToken |= 0xf;
+                        p = write_len(p, n - 0xf);
+                    } else {
+                        *pToken |= static_cast<uint8_t>(n);
+                    }
+
+                    pos += len;
+                    anchor = pos;
+
+                    if (pos < limit)
+                        table[hash(read32(src + pos - 2))] = static_cast<uint32_t>(pos - 2);
+                }
+            }
+
+            uint8_t* pToken = p++;
+            p = write_literals(p, *pToken, src + anchor, size - anchor);
+
+            return p - dst;
+        }
+
+        bool decompress(uint8_t* dst, size_t dstSize, const uint8_t* src, size_t srcSize) {
+            uint8_t* d = dst;
+            uint8_t* const dEnd = dst + dstSize;
+            const uint8_t* s = src;
+            const uint8_t* const sEnd = src + srcSize;
+
+            while (true) {
+                if (s == sEnd)
+                    return false;
+                uint8_t token = *s++;
+
+                size_t n = token >> 4;
+                if ((0xf == n) && !read_len(s, sEnd, n, dstSize))
+                    return false;
+
+                if ((n > static_cast<size_t>(sEnd - s)) || (n > static_cast<size_t>(dEnd - d)))
+                    return false;
+
+                if (n) {
+                    memcpy(d, s, n);
+                    d += n;
+                    s += n;
+                }
+
+                if (s == sEnd)
+                    return d == dEnd; // the last sequence has no match
+
+                if (sEnd - s < 2)
+                    return false;
+
+                size_t offset = s[0] | (size_t(s[1]) << 8);
+                s += 2;
+
+                if (!offset || (offset > static_cast<size_t>(d - dst)))
+                    return false;
+
+                n = token & 0xf;
+                if ((0xf == n) && !read_len(s, sEnd, n, dstSize))
+                    return false;
+                n += MIN_MATCH;
+
+                if (n > static_cast<size_t>(dEnd - d))
+                    return false;
+
+                const uint8_t* r = d - offset;
+                if (offset >= n) {
+                    memcpy(d, r, n);
+                    d += n;
+                } else {
+                    // overlapping, repeats the pattern
+                    for (; n; n--)
+                        *d++ = *r++;
+                }
+            }
+        }
+    }
+
+    namespace gzip
+    {
+        namespace
+        {
+            const uint32_t HASH_LOG = 15;
+            const size_t MIN_MATCH = 4; // deflate allows 3, but we hash 4 bytes
+            const size_t MAX_MATCH = 258;
+            const size_t MAX_OFFSET = 32768;
+
+            const uint16_t s_pLenBase[] = { 3,4,5,6,7,8,9,10,11,13,15,17,19,23,27,31,35,43,51,59,67,83,99,115,131,163,195,227,258 };
+            const uint8_t s_pLenExtra[] = { 0,0,0,0,0,0,0,0,1,1,1,1,2,2,2,2,3,3,3,3,4,4,4,4,5,5,5,5,0 };
+            const uint16_t s_pDistBase[] = { 1,2,3,4,5,7,9,13,17,25,33,49,65,97,129,193,257,385,513,769,1025,1537,2049,3073,4097,6145,8193,12289,16385,24577 };
+            const uint8_t s_pDistExtra[] = { 0,0,0,0,1,1,2,2,3,3,4,4,5,5,6,6,7,7,8,8,9,9,10,10,11,11,12,12,13,13 };
+
+            struct BitWriter
+            {
+                uint8_t* m_p;
+                uint64_t m_Acc = 0;
+                uint32_t m_Bits = 0;
+
+                void Put(uint32_t val, uint32_t nBits) {
+                    m_Acc |= uint64_t(val) << m_Bits;
+                    m_Bits += nBits;
+                    for (; m_Bits >= 8; m_Bits -= 8) {
+                        *m_p++ = static_cast<uint8_t>(m_Acc);
+                        m_Acc >>= 8;
+                    }
+                }
+
+                // Huffman codes are packed starting from the MSB
+                void PutCode(uint32_t code, uint32_t nBits) {
+                    uint32_t rev = 0;
+                    for (uint32_t i = 0; i < nBits; i++, code >>= 1)
+                        rev = (rev << 1) | (code & 1);
+                    Put(rev, nBits);
+                }
+
+                void Flush() {
+                    if (m_Bits) {
+                        *m_p++ = static_cast<uint8_t>(m_Acc);
+                        m_Acc = 0;
+                        m_Bits = 0;
+                    }
+                }
+
+                void PutLitLen(uint32_t sym) {
+                    if (sym < 144)
+                        PutCode(0x30 + sym, 8);
+                    else if (sym < 256)
+                        PutCode(0x190 + sym - 144, 9);
+                    else if (sym < 280)
+                        PutCode(sym - 256, 7);
+                    else
+                        PutCode(0xc0 + sym - 280, 8);
+                }
+
+                void PutMatch(size_t len, size_t offset) {
+                    uint32_t i = sizeof(s_pLenBase) / sizeof(s_pLenBase[0]) - 1;
+                    while (s_pLenBase[i] > len)
+                        i--;
+                    PutLitLen(257 + i);
+                    Put(static_cast<uint32_t>(len - s_pLenBase[i]), s_pLenExtra[i]);
+
+                    i = sizeof(s_pDistBase) / sizeof(s_pDistBase[0]) - 1;
+                    while (s_pDistBase[i] > offset)
+                        i--;
+                    PutCode(i, 5);
+                    Put(static_cast<uint32_t>(offset - s_pDistBase[i]), s_pDistExtra[i]);
+                }
+            };
+
+            void put32(uint8_t* p, uint32_t x) {
+                for (uint32_t i = 0; i < 4; i++, x >>= 8)
+                    p[i] = static_cast<uint8_t>(x);
+            }
+
+            struct CrcTable
+            {
+                uint32_t m_p[0x100];
+
+                CrcTable() {
+                    for (uint32_t i = 0; i < 0x100; i++) {
+                        uint32_t x = i;
+                        for (uint32_t j = 0; j < 8; j++)
+                            x = (x & 1) ? (0xedb88320 ^ (x >> 1)) : (x >> 1);
+                        m_p[i] = x;
+                    }
+                }
+            };
+        }
+
+        uint32_t crc32(const uint8_t* p, size_t size, uint32_t crc) {
+            static const CrcTable s_Tbl;
+
+            crc = ~crc;
+            for (size_t i = 0; i < size; i++)
+                crc = s_Tbl.m_p[(crc ^ p[i]) & 0xff] ^ (crc >> 8);
+            return ~crc;
+        }
+
+        size_t get_max_compressed_size(size_t size) {
+            // literals take up to 9 bits
+            return size + size / 8 + 32;
+        }
+
+        size_t compress(uint8_t* dst, const uint8_t* src, size_t size) {
+            static const uint8_t s_pHdr[] = { 0x1f, 0x8b, 8, 0, 0, 0, 0, 0, 0, 0xff }; // deflate, no flags, no mtime, unknown OS
+            memcpy(dst, s_pHdr, sizeof(s_pHdr));
+
+            BitWriter bw;
+            bw.m_p = dst + sizeof(s_pHdr);
+            bw.Put(1, 1); // final block
+            bw.Put(1, 2); // fixed Huffman codes
+
+            size_t pos = 0;
+
+            if (size > MIN_MATCH) {
+                std::vector<uint32_t> table(size_t(1) << HASH_LOG);
+
+                const size_t limit = size - MIN_MATCH;
+
+                while (pos < limit) {
+                    uint32_t x = lz::read32(src + pos);
+                    uint32_t& slot = table[(x * 2654435761u) >> (32 - HASH_LOG)];
+                    size_t ref = slot;
+                    slot = static_cast<uint32_t>(pos);
+
+                    if ((ref >= pos) || (pos - ref > MAX_OFFSET) || (lz::read32(src + ref) != x)) {
+                        bw.PutLitLen(src[pos++]);
+                        continue;
+                    }
+
+                    size_t len = MIN_MATCH;
+                    size_t lenMax = std::min(MAX_MATCH, size - pos);
+                    while ((len < lenMax) && (src[ref + len] == src[pos + len]))
+                        len++;
+
+                    bw.PutMatch(len, pos - ref);
+                    pos += len;
+                }
+            }
+
+            for (; pos < size; pos++)
+                bw.PutLitLen(src[pos]);
+
+            bw.PutLitLen(256); // end of block
+            bw.Flush();
+
+            put32(bw.m_p, crc32(src, size));
+            put32(bw.m_p + 4, static_cast<uint32_t>(size));
+
+            return bw.m_p + 8 - dst;
+        }
+    }
+
+} //namespace
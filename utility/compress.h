@@ -0,0 +1,47 @@
+// Copyright 2018-2020 The Beam Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+namespace beam
+{
+    // Fast LZ77 compression (LZ4 block format), aimed at the network payloads
+    namespace lz
+    {
+        // Buffer size sufficient for the compressed data in the worst case
+        size_t get_max_compressed_size(size_t size);
+
+        // Returns the compressed size. dst must hold at least get_max_compressed_size(size) bytes
+        size_t compress(uint8_t* dst, const uint8_t* src, size_t size);
+
+        // The original size must be known in advance. Returns false on malformed data, never reads or writes out of bounds
+        bool decompress(uint8_t* dst, size_t dstSize, const uint8_t* src, size_t srcSize);
+    }
+
+    // gzip encoder (a single deflate block with the fixed Huffman codes), for the HTTP Content-Encoding.
+    // Worse ratio than zlib, but no dependency. Decoding is up to the clients
+    namespace gzip
+    {
+        // Buffer size sufficient for the compressed data in the worst case
+        size_t get_max_compressed_size(size_t size);
+
+        // Returns the compressed size. dst must hold at least get_max_compressed_size(size) bytes
+        size_t compress(uint8_t* dst, const uint8_t* src, size_t size);
+
+        uint32_t crc32(const uint8_t* p, size_t size, uint32_t crc = 0);
+    }
+
+} //namespace
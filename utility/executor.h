@@ -17,6 +17,7 @@
 #include "common.h"
 #include <condition_variable>
 #include <thread>
+#include <atomic>
 #include <boost/intrusive/list.hpp>
 #include "thread.h"
 
@@ -55,12 +56,21 @@ namespace beam
 			virtual void Exec(Context&) = 0;
 		};
 
+		struct Priority {
+			static const uint8_t Low = 0; // background, such as mempool txs
+			static const uint8_t High = 1; // blocks
+			static const uint8_t count = 2;
+		};
+
 		struct TaskAsync
 			:public boost::intrusive::list_base_hook<>
 			, public TaskSync
 		{
 			typedef std::unique_ptr<TaskAsync> Ptr;
 			virtual ~TaskAsync() {}
+
+			uint8_t m_Priority = Priority::Low;
+			uint32_t m_iThread = static_cast<uint32_t>(-1); // preferred thread, by default no affinity
 		};
 
 		virtual uint32_t get_Threads() = 0;
@@ -71,6 +81,7 @@ namespace beam
 	};
 
 	// standard multi-threaded executor. All threads are created with default stack and priority
+	// Each thread has its own task queue (per priority). Idle threads steal tasks from others, higher priority first.
 	struct ExecutorMT
 		:public Executor
 	{
@@ -94,14 +105,24 @@ namespace beam
 		void RunThreadCtx(Context&);
 
 	private:
-		std::mutex m_Mutex;
+		std::mutex m_Mutex; // protects the control task and thread wakeups
+
+		struct Queue
+		{
+			std::mutex m_Mutex;
+			boost::intrusive::list<TaskAsync> m_pLst[Priority::count];
+		};
 
-		boost::intrusive::list<TaskAsync> m_queTasks;
+		std::unique_ptr<Queue[]> m_pQueues; // per thread
+		std::atomic<uint32_t> m_iNextQueue;
+		std::atomic<uint32_t> m_Queued; // pushed, not taken yet
+		std::atomic<uint32_t> m_Sleeping;
 
-		uint32_t m_InProgress;
-		uint32_t m_FlushTarget;
+		std::atomic<uint32_t> m_InProgress;
+		std::atomic<uint32_t> m_FlushTarget1; // flush target + 1, 0 if none
 		bool m_Run;
 		TaskSync* m_pCtl;
+		uint32_t m_CtlGeneration;
 		std::condition_variable m_NewTask;
 		std::condition_variable m_Flushed;
 
@@ -110,5 +131,7 @@ namespace beam
 		void InitSafe();
 		void FlushLocked(std::unique_lock<std::mutex>&, uint32_t nMaxTasks);
 		void RunThreadInternal(uint32_t);
+		TaskAsync* PopTask(uint32_t iThread);
+		void DeleteQueued();
 	};
 }
@@ -29,11 +29,18 @@
     #include <sys/types.h>
     #include <sys/syscall.h>
     #include <sys/signal.h>
+    #include <sys/resource.h>
+    #include <sched.h>
+    #include <malloc.h>
     #include <errno.h>
 #elif defined _WIN32
     #define WIN32_LEAN_AND_MEAN
     #include <windows.h>
+    #include <psapi.h>
 #else
+    #ifdef __APPLE__
+        #include <mach/mach.h>
+    #endif
     #include <signal.h>
     #include <pthread.h>
     #include <errno.h>
@@ -81,6 +88,117 @@ uint64_t get_thread_id() {
 #endif
 }
 
+uint64_t get_process_rss() {
+#if defined __linux__
+    FILE* f = fopen("/proc/self/statm", "r");
+    if (!f)
+        return 0;
+
+    unsigned long long nSize = 0, nResident = 0;
+    int n = fscanf(f, "%llu %llu", &nSize, &nResident);
+    fclose(f);
+
+    return (2 == n) ? uint64_t(nResident) * sysconf(_SC_PAGESIZE) : 0;
+
+#elif defined _WIN32
+    PROCESS_MEMORY_COUNTERS pmc;
+    return K32GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc)) ? pmc.WorkingSetSize : 0;
+
+#elif defined __APPLE__
+    mach_task_basic_info info;
+    mach_msg_type_number_t n = MACH_TASK_BASIC_INFO_COUNT;
+    return (KERN_SUCCESS == task_info(mach_task_self(), MACH_TASK_BASIC_INFO, (task_info_t) &info, &n)) ? info.resident_size : 0;
+
+#else
+    return 0;
+#endif
+}
+
+void trim_heap() {
+#ifdef __GLIBC__
+    malloc_trim(0);
+#endif // __GLIBC__
+}
+
+bool ThreadPlacement::apply() const {
+    bool ok = true;
+
+#if defined __linux__
+    if (!cpus.empty()) {
+        cpu_set_t cs;
+        CPU_ZERO(&cs);
+        for (uint32_t i : cpus) {
+            if (i < CPU_SETSIZE)
+                CPU_SET(i, &cs);
+        }
+        ok &= !sched_setaffinity(0, sizeof(cs), &cs); // 0 - the calling thread
+    }
+
+    // on linux the nice value is per-thread
+    if (nice)
+        ok &= !setpriority(PRIO_PROCESS, (id_t) syscall(__NR_gettid), nice);
+
+#elif defined _WIN32
+    if (!cpus.empty()) {
+        DWORD_PTR mask = 0;
+        for (uint32_t i : cpus) {
+            if (i < sizeof(mask) * 8)
+                mask |= DWORD_PTR(1) << i;
+        }
+        ok &= (0 != SetThreadAffinityMask(GetCurrentThread(), mask));
+    }
+
+    if (nice) {
+        int prio =
+            (nice <= -10) ? THREAD_PRIORITY_HIGHEST :
+            (nice < 0) ? THREAD_PRIORITY_ABOVE_NORMAL :
+            (nice < 10) ? THREAD_PRIORITY_BELOW_NORMAL :
+            THREAD_PRIORITY_LOWEST;
+        ok &= !!SetThreadPriority(GetCurrentThread(), prio);
+    }
+
+#else
+    // no thread affinity or per-thread nice here
+    ok = cpus.empty() && !nice;
+#endif
+
+    return ok;
+}
+
+bool ThreadPlacement::parse_cpus(const std::string& s, std::vector<uint32_t>& res) {
+    res.clear();
+
+    for (size_t pos = 0; pos < s.size(); ) {
+        size_t end = s.find(',', pos);
+        if (std::string::npos == end)
+            end = s.size();
+
+        std::string item = s.substr(pos, end - pos);
+        pos = end + 1;
+
+        char* p = nullptr;
+        unsigned long lo = strtoul(item.c_str(), &p, 10);
+        if (p == item.c_str())
+            return false;
+
+        unsigned long hi = lo;
+        if ('-' == *p) {
+            const char* p1 = p + 1;
+            hi = strtoul(p1, &p, 10);
+            if ((p == p1) || (hi < lo))
+                return false;
+        }
+
+        if (*p || (hi >= 0x10000))
+            return false;
+
+        for (unsigned long i = lo; i <= hi; i++)
+            res.push_back(uint32_t(i));
+    }
+
+    return true;
+}
+
 #ifndef _WIN32
 
 namespace {
@@ -78,6 +78,24 @@ private:
 /// returns current thread id depending on platform
 uint64_t get_thread_id();
 
+/// CPU placement and scheduling priority of a thread. Best effort: the settings unsupported by the platform are ignored
+struct ThreadPlacement {
+    std::vector<uint32_t> cpus; // cores the thread may run on, empty - any
+    int nice = 0; // posix-style nice value (-20 .. 19, lower is more urgent), 0 - leave as is. Negative values usually need privileges
+
+    /// applies to the calling thread, returns false if any of the requested settings failed
+    bool apply() const;
+
+    /// parses a core list, such as "0-3,8,10-11". Returns false if malformed
+    static bool parse_cpus(const std::string&, std::vector<uint32_t>&);
+};
+
+/// resident memory of the process, in bytes. 0 if not available
+uint64_t get_process_rss();
+
+/// returns the freed heap memory to the OS, where the allocator supports it
+void trim_heap();
+
 /// blocks all signals in calling thread
 void block_signals_in_this_thread();
 
@@ -27,6 +27,7 @@
 #endif
 
 #include <assert.h>
+#include <atomic>
 
 namespace beam { namespace io {
 
@@ -144,6 +145,148 @@ std::pair<uint8_t*, SharedMem> alloc_heap(size_t size) {
     return p;
 }
 
+namespace {
+
+struct BufferPool {
+    static const uint32_t s_MinBits = 8; // 256 bytes
+    static const uint32_t s_MaxBits = 20; // 1MB
+    static const uint32_t s_Classes = s_MaxBits - s_MinBits + 1;
+    static const size_t s_MaxCachedPerClass = 4 * 1024 * 1024; // bytes kept in each freelist
+
+    struct Block {
+        Block* next;
+        uint32_t cls;
+        // followed by data
+        uint8_t* data() { return reinterpret_cast<uint8_t*>(this + 1); }
+    };
+
+    static_assert(sizeof(Block) % sizeof(void*) == 0, "data alignment");
+
+    struct Freelist {
+        Block* head = nullptr;
+        size_t count = 0;
+    };
+
+    Freelist lists[s_Classes];
+
+    // trivially destructible, valid during the thread exit. 0 - not created yet, 1 - alive, 2 - destroyed
+    static thread_local uint8_t s_state;
+
+    static std::atomic<uint64_t> s_hits;
+    static std::atomic<uint64_t> s_misses;
+    static std::atomic<uint64_t> s_unpooled;
+    static std::atomic<uint64_t> s_dropped;
+
+    BufferPool() { s_state = 1; }
+
+    ~BufferPool() {
+        s_state = 2;
+        for (auto& fl : lists) {
+            while (fl.head) {
+                Block* b = fl.head;
+                fl.head = b->next;
+                free(b);
+            }
+        }
+    }
+
+    static BufferPool& get() {
+        thread_local BufferPool pool;
+        return pool;
+    }
+
+    static uint32_t get_class(size_t size) {
+        uint32_t cls = 0;
+        while ((size_t(1) << (s_MinBits + cls)) < size) cls++;
+        return cls;
+    }
+
+    static size_t get_size(uint32_t cls) {
+        return size_t(1) << (s_MinBits + cls);
+    }
+
+    static Block* alloc(uint32_t cls) {
+        assert(cls < s_Classes);
+        BufferPool& pool = get();
+        Freelist& fl = pool.lists[cls];
+        if (fl.head) {
+            Block* b = fl.head;
+            fl.head = b->next;
+            fl.count--;
+            s_hits.fetch_add(1, std::memory_order_relaxed);
+            return b;
+        }
+
+        Block* b = (Block*)malloc(sizeof(Block) + get_size(cls));
+        if (!b) throw std::runtime_error("BufferPool: out of memory");
+        b->cls = cls;
+        s_misses.fetch_add(1, std::memory_order_relaxed);
+        return b;
+    }
+
+    static void release(Block* b) {
+        if (s_state != 2) {
+            Freelist& fl = get().lists[b->cls];
+            if (fl.count * get_size(b->cls) < s_MaxCachedPerClass) {
+                b->next = fl.head;
+                fl.head = b;
+                fl.count++;
+                return;
+            }
+        }
+
+        s_dropped.fetch_add(1, std::memory_order_relaxed);
+        free(b);
+    }
+};
+
+thread_local uint8_t BufferPool::s_state = 0;
+std::atomic<uint64_t> BufferPool::s_hits(0);
+std::atomic<uint64_t> BufferPool::s_misses(0);
+std::atomic<uint64_t> BufferPool::s_unpooled(0);
+std::atomic<uint64_t> BufferPool::s_dropped(0);
+
+struct PooledMemory : AllocatedMemory {
+    BufferPool::Block* block;
+    explicit PooledMemory(BufferPool::Block* b) : block(b) {}
+    ~PooledMemory() { BufferPool::release(block); }
+};
+
+} // namespace
+
+std::pair<uint8_t*, SharedMem> alloc_pooled(size_t size) {
+    if (size > BufferPool::get_size(BufferPool::s_Classes - 1)) {
+        BufferPool::s_unpooled.fetch_add(1, std::memory_order_relaxed);
+        return alloc_heap(size);
+    }
+
+    BufferPool::Block* b = BufferPool::alloc(BufferPool::get_class(size));
+
+    std::pair<uint8_t*, SharedMem> p;
+    try {
+        p.second = std::make_shared<PooledMemory>(b); // single allocation for the object and the control block
+    } catch (...) {
+        BufferPool::release(b);
+        throw;
+    }
+    p.first = b->data();
+    return p;
+}
+
+size_t pooled_capacity(size_t size) {
+    if (size > BufferPool::get_size(BufferPool::s_Classes - 1)) return size;
+    return BufferPool::get_size(BufferPool::get_class(size));
+}
+
+BufferPoolStats get_buffer_pool_stats() {
+    BufferPoolStats s;
+    s.hits = BufferPool::s_hits.load(std::memory_order_relaxed);
+    s.misses = BufferPool::s_misses.load(std::memory_order_relaxed);
+    s.unpooled = BufferPool::s_unpooled.load(std::memory_order_relaxed);
+    s.dropped = BufferPool::s_dropped.load(std::memory_order_relaxed);
+    return s;
+}
+
 SharedBuffer map_file_read_only(const char* fileName) {
 #ifdef WIN32
     ReadOnlyMappedFileWin32* mem = new ReadOnlyMappedFileWin32(fileName);
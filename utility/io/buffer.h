@@ -93,6 +93,23 @@ using SharedMem = std::shared_ptr<struct AllocatedMemory>;
 /// Allocs shared memory from heap, throws on error
 std::pair<uint8_t*, SharedMem> alloc_heap(size_t size);
 
+/// Allocs shared memory from the size-classed pool (power-of-2 classes, thread-local freelists). The block is returned to the pool
+/// of the thread that releases it. Sizes above the largest class go to the heap. Throws on error
+std::pair<uint8_t*, SharedMem> alloc_pooled(size_t size);
+
+/// Capacity of the block that alloc_pooled() would actually allocate for the given size
+size_t pooled_capacity(size_t size);
+
+struct BufferPoolStats {
+    uint64_t hits=0; // served from a freelist
+    uint64_t misses=0; // allocated from heap, then pooled
+    uint64_t unpooled=0; // too large for the pool
+    uint64_t dropped=0; // released when the freelist was full
+};
+
+/// Totals over all threads
+BufferPoolStats get_buffer_pool_stats();
+
 struct SharedBuffer : IOVec {
     SharedMem guard;
 
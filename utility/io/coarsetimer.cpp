@@ -14,6 +14,8 @@
 
 #include "coarsetimer.h"
 #include "utility/helpers.h"
+#include <algorithm>
+#include <iterator>
 #include <assert.h>
 
 #ifndef LOG_VERBOSE_ENABLED
@@ -32,11 +34,30 @@ CoarseTimer::Ptr CoarseTimer::create(Reactor& reactor, unsigned resolutionMsec,
     return CoarseTimer::Ptr(new CoarseTimer(resolutionMsec, cb, Timer::create(reactor)));
 }
 
+static inline uint64_t mono_clock() {
+    return uv_hrtime() / 1000000; //nsec->msec, monotonic clock
+}
+
+// uv timers inaccurate intervals
+static constexpr unsigned TIMER_ACCURACY = 10;
+
+CoarseTimer::Clock CoarseTimer::tick_to_clock(Tick t) const {
+    // on_timer() handles the ticks that start within TIMER_ACCURACY
+    Clock clock = t * _resolution;
+    return (clock > TIMER_ACCURACY) ? (clock - TIMER_ACCURACY) : 0;
+}
+
 CoarseTimer::CoarseTimer(unsigned resolutionMsec, const Callback& cb, Timer::Ptr&& timer) :
     _resolution(resolutionMsec),
     _callback(cb),
+    _tick(mono_clock() / resolutionMsec),
     _timer(std::move(timer))
 {
+    for (auto& level : _wheel) {
+        for (auto& slot : level) slot.init();
+    }
+    std::fill(std::begin(_levelCount), std::end(_levelCount), 0);
+
     auto result = _timer->start(unsigned(-1), false, BIND_THIS_MEMFN(on_timer));
     if (!result) IO_EXCEPTION(result.error());
 }
@@ -45,97 +66,215 @@ CoarseTimer::~CoarseTimer() {
     assert(!_insideCallback && "attempt to delete coarse timer from inside its callback, unsupported feature");
 }
 
-static inline uint64_t mono_clock() {
-    return uv_hrtime() / 1000000; //nsec->msec, monotonic clock
+void CoarseTimer::Link::unlink() {
+    prev->next = next;
+    next->prev = prev;
+    init();
+}
+
+void CoarseTimer::Link::insert_before(Link& x) {
+    prev = x.prev;
+    next = &x;
+    x.prev->next = this;
+    x.prev = this;
 }
 
 Result CoarseTimer::set_timer(unsigned intervalMsec, ID id) {
-    if (_validIds.count(id)) {
+    if (_entries.count(id)) {
         BEAM_LOG_DEBUG() << "coarse timer: existing id " << std::hex << id << std::dec;
         return make_unexpected(EC_EINVAL);
     }
-    if (intervalMsec > 0 && intervalMsec < unsigned(-1) - _resolution) {
-        // if 0 then callback will fire on next event loop cycle, otherwise adjust to coarse resolution
-        intervalMsec -= ((intervalMsec + _resolution) % _resolution);
-    }
+
     Clock now = mono_clock();
-    Clock clock = now + intervalMsec;
-    _queue.insert({ clock, id });
-    _validIds.insert({ id, clock });
+    if (_entries.empty() && !_insideCallback) {
+        // the wheel may have been idle for long, no need to catch up
+        _tick = now / _resolution;
+    }
+
+    // rounded down to coarse resolution. If it's already due - the callback will fire on next event loop cycle
+    Entry& e = _entries[id];
+    e.id = id;
+    e.expires = (now + intervalMsec) / _resolution;
+    place(e);
+
+    Clock clock = tick_to_clock(std::max(e.expires, _tick));
     if (!_insideCallback && _timerSetTo > clock) {
-        BEAM_LOG_VERBOSE() << TRACE(intervalMsec);
-        _timerSetTo = clock;
-        return _timer->restart(intervalMsec, false);
+        unsigned delay = (clock > now) ? unsigned(clock - now) : 0;
+        BEAM_LOG_VERBOSE() << TRACE(delay);
+        _timerSetTo = now + delay;
+        return _timer->restart(delay, false);
     }
     return Ok();
 }
 
 void CoarseTimer::cancel(ID id) {
-    _validIds.erase(id);
-    if (_validIds.empty()) cancel_all();
+    auto it = _entries.find(id);
+    if (it == _entries.end()) return;
+
+    unlink(it->second);
+    _entries.erase(it);
+    if (_entries.empty()) cancel_all();
 }
 
 void CoarseTimer::cancel_all() {
-    _validIds.clear();
-    _queue.clear();
+    // also detaches them from the list being fired, if called from inside the callback
+    for (auto& x : _entries) {
+        x.second.unlink();
+    }
+    _entries.clear();
+    std::fill(std::begin(_levelCount), std::end(_levelCount), 0);
+
     if (_timerSetTo != NEVER) {
         _timer->cancel();
         _timerSetTo = NEVER;
     }
 }
 
-// uv timers inaccurate intervals
-static constexpr unsigned TIMER_ACCURACY = 10;
+void CoarseTimer::place(Entry& e) {
+    // overdue ones go to the current slot
+    Tick expires = std::max(e.expires, _tick);
+    Tick delta = expires - _tick;
 
-void CoarseTimer::on_timer() {
-    BEAM_LOG_VERBOSE() << TRACE(_queue.size());
+    unsigned level = 0;
+    while ((level + 1 < WHEEL_LEVELS) && (delta >> (WHEEL_BITS * (level + 1)))) {
+        level++;
+    }
 
-    if (_queue.empty()) return;
-    Clock now = mono_clock();
+    if (level + 1 == WHEEL_LEVELS) {
+        // beyond the wheel span: park in the farthest slot, will be re-placed on cascade
+        const Tick maxDelta = (Tick(1) << (WHEEL_BITS * WHEEL_LEVELS)) - 1;
+        if (delta > maxDelta) expires = _tick + maxDelta;
+    }
 
-    _insideCallback = true;
+    unsigned slot = unsigned(expires >> (WHEEL_BITS * level)) & (WHEEL_SIZE - 1);
+    e.level = level;
+    e.insert_before(_wheel[level][slot]);
+    _levelCount[level]++;
+}
+
+void CoarseTimer::unlink(Entry& e) {
+    assert(_levelCount[e.level]);
+    _levelCount[e.level]--;
+    e.unlink();
+}
+
+unsigned CoarseTimer::cascade(unsigned level) {
+    unsigned idx = unsigned(_tick >> (WHEEL_BITS * level)) & (WHEEL_SIZE - 1);
 
-    Clock clock = 0;
+    Link& slot = _wheel[level][idx];
+    while (!slot.empty()) {
+        Entry& e = static_cast<Entry&>(*slot.next);
+        unlink(e);
+        place(e);
+    }
 
-    while (!_queue.empty()) {
-        auto it = _queue.begin();
+    return idx;
+}
 
-        clock = it->first;
+void CoarseTimer::run(Tick now) {
+    while (_tick <= now) {
+        if (_entries.empty()) {
+            _tick = now + 1;
+            break;
+        }
 
-        BEAM_LOG_VERBOSE() << TRACE(now) << TRACE(clock) << TRACE(_timerSetTo);
+        unsigned idx = unsigned(_tick) & (WHEEL_SIZE - 1);
+        if (!idx) {
+            // lower levels wrapped, bring the upper level entries down
+            for (unsigned level = 1; (level < WHEEL_LEVELS) && !cascade(level); level++)
+                ;
+        } else if (!_levelCount[0]) {
+            // nothing can fire before the next cascade
+            _tick = std::min(now + 1, (_tick | (WHEEL_SIZE - 1)) + 1);
+            continue;
+        }
 
-        if (clock > now + TIMER_ACCURACY) break;
-        ID id = it->second;
+        // detach the slot. Timers set from inside callbacks go to the next ticks, cancelled ones are unlinked from here
+        Link pending;
+        pending.init();
 
-        BEAM_LOG_VERBOSE() << TRACE(id);
+        Link& slot = _wheel[0][idx];
+        if (!slot.empty()) {
+            pending.insert_before(*slot.next);
+            slot.unlink();
+        }
 
-        // this helps calling set_timer(), cancel(), cancel_all() from inside callbacks
-        _queue.erase(it);
+        _tick++;
 
-        auto v = _validIds.find(id);
-        if (v != _validIds.end()) {
-            if (v->second == clock) {
-                _validIds.erase(v);
-                _callback(id);
+        while (!pending.empty()) {
+            Entry& e = static_cast<Entry&>(*pending.next);
+            ID id = e.id;
+            BEAM_LOG_VERBOSE() << TRACE(id);
+
+            unlink(e);
+            _entries.erase(id);
+            _callback(id);
+        }
+    }
+}
+
+CoarseTimer::Tick CoarseTimer::next_tick() const {
+    Tick res = NEVER;
+
+    if (_levelCount[0]) {
+        // all level 0 entries are within the next WHEEL_SIZE ticks
+        for (Tick t = _tick; ; t++) {
+            if (!_wheel[0][t & (WHEEL_SIZE - 1)].empty()) {
+                res = t;
+                break;
             }
         }
     }
 
-    _insideCallback = false;
+    // upper level entries may expire earlier, if they were placed before the level 0 ones
+    for (unsigned level = 1; level < WHEEL_LEVELS; level++) {
+        if (!_levelCount[level]) continue;
+
+        // the level is cascaded at the ticks which are multiples of its slot span
+        unsigned shift = WHEEL_BITS * level;
+        Tick k0 = (_tick + (Tick(1) << shift) - 1) >> shift;
+        for (Tick k = k0; k < k0 + WHEEL_SIZE; k++) {
+            if (!_wheel[level][k & (WHEEL_SIZE - 1)].empty()) {
+                res = std::min(res, k << shift);
+                break;
+            }
+        }
+    }
+
+    return res;
+}
 
-    if (_queue.empty()) {
+Result CoarseTimer::rearm() {
+    Tick t = next_tick();
+    if (NEVER == t) {
         cancel_all();
-    } else {
-        now = mono_clock();
-        unsigned intervalMsec = 0;
-        if (clock > now) intervalMsec = unsigned(clock - now);
-        BEAM_LOG_VERBOSE() << TRACE(intervalMsec);
-        Result res =_timer->restart(intervalMsec, false);
-        if (!res) {
-            BEAM_LOG_ERROR() << "cannot restart timer, code=" << res.error();
-        } else {
-            _timerSetTo = now + intervalMsec;
-        }
+        return Ok();
+    }
+
+    Clock clock = tick_to_clock(t);
+    Clock now = mono_clock();
+    unsigned intervalMsec = (clock > now) ? unsigned(std::min<Clock>(clock - now, unsigned(-1) - 1)) : 0;
+    BEAM_LOG_VERBOSE() << TRACE(intervalMsec);
+
+    Result res = _timer->restart(intervalMsec, false);
+    if (res) _timerSetTo = now + intervalMsec;
+    return res;
+}
+
+void CoarseTimer::on_timer() {
+    BEAM_LOG_VERBOSE() << TRACE(_entries.size());
+
+    // one-shot, not armed anymore
+    _timerSetTo = NEVER;
+    if (_entries.empty()) return;
+
+    _insideCallback = true;
+    run((mono_clock() + TIMER_ACCURACY) / _resolution);
+    _insideCallback = false;
+
+    Result res = rearm();
+    if (!res) {
+        BEAM_LOG_ERROR() << "cannot restart timer, code=" << res.error();
     }
 }
 
@@ -16,11 +16,14 @@
 #include "timer.h"
 #include <map>
 #include <vector>
+#include <unordered_map>
 #include <limits>
 
 namespace beam { namespace io {
 
-/// Coarse timer helper, for connect/reconnect timers
+/// Coarse timer helper, for connect/reconnect timers.
+/// Timers are kept in a hashed hierarchical timing wheel (4 levels of 64 slots, slot = resolution), so that
+/// set_timer() and cancel() are O(1) regardless of the number of pending timers
 class CoarseTimer {
 public:
     using ID = uint64_t;
@@ -51,6 +54,51 @@ private:
     using Clock = uint64_t;
     static constexpr Clock NEVER = std::numeric_limits<Clock>::max();
 
+    /// abs. time in resolution units
+    using Tick = uint64_t;
+
+    static constexpr unsigned WHEEL_BITS = 6;
+    static constexpr unsigned WHEEL_SIZE = 1U << WHEEL_BITS;
+    static constexpr unsigned WHEEL_LEVELS = 4;
+
+    /// Slot list node
+    struct Link {
+        Link* prev;
+        Link* next;
+
+        void init() { prev = next = this; }
+        bool empty() const { return next == this; }
+        void unlink();
+        void insert_before(Link& x);
+    };
+
+    struct Entry : Link {
+        ID id;
+        Tick expires;
+        unsigned level;
+    };
+
+    /// Puts entry into the slot wrt its expiration and the current tick
+    void place(Entry& e);
+
+    /// Re-places the entries of the upper level slot, returns its index
+    unsigned cascade(unsigned level);
+
+    /// Removes the entry from its slot
+    void unlink(Entry& e);
+
+    /// Fires all the timers due at now
+    void run(Tick now);
+
+    /// Earliest tick at which the wheel needs attention, NEVER if empty
+    Tick next_tick() const;
+
+    /// Time at which on_timer() will handle the tick
+    Clock tick_to_clock(Tick t) const;
+
+    /// Re-arms the timer wrt the wheel contents
+    Result rearm();
+
     /// Flag that prevents from updating timer too often
     bool _insideCallback=false;
 
@@ -60,11 +108,17 @@ private:
     /// External callback
     Callback _callback;
 
-    /// Timers queue
-    std::multimap<Clock, ID> _queue;
+    /// Next tick to process
+    Tick _tick;
+
+    /// Timing wheel, each slot is a circular list with sentinel
+    Link _wheel[WHEEL_LEVELS][WHEEL_SIZE];
+
+    /// Number of entries per level
+    size_t _levelCount[WHEEL_LEVELS];
 
-    /// Valid Ids
-    std::map<ID, Clock> _validIds;
+    /// Pending timers, by id
+    std::unordered_map<ID, Entry> _entries;
 
     /// Next time to wake
     Clock _timerSetTo=NEVER;
@@ -90,7 +144,7 @@ public:
 private:
     void on_timer(CoarseTimer::ID id);
 
-    std::map<CoarseTimer::ID, Timer::Callback> _timerCallbacks;
+    std::unordered_map<CoarseTimer::ID, Timer::Callback> _timerCallbacks;
     io::CoarseTimer::Ptr _timer;
 };
 
@@ -71,10 +71,11 @@ void FragmentWriter::call() {
 
 void FragmentWriter::new_fragment() {
     call();
-    auto p = io::alloc_heap(_fragmentSize);
+    // pooled, the whole block capacity is used (size classes are powers of 2)
+    auto p = io::alloc_pooled(_fragmentSize);
     _fragment = std::move(p.second);
     _msgBase = _cursor = (char*)p.first;
-    _remaining = _fragmentSize;
+    _remaining = io::pooled_capacity(_fragmentSize);
 }
 
 }} //namespaces
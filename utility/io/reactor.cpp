@@ -23,6 +23,7 @@
 
 #ifndef WIN32
 #include <csignal>
+#include <sys/socket.h>
 #endif // WIN32
 
 #ifndef LOG_VERBOSE_ENABLED
@@ -354,6 +355,7 @@ Reactor::Reactor() :
 {
     memset(&_loop,0,sizeof(uv_loop_t));
     memset(&_stopEvent, 0, sizeof(uv_async_t));
+    memset(&_flushCheck, 0, sizeof(uv_check_t));
 
     _creatingInternalObjects=true;
 
@@ -385,6 +387,17 @@ Reactor::Reactor() :
     }
 
     _stopEvent.data = this;
+
+    errorCode = (ErrorCode)uv_check_init(&_loop, &_flushCheck);
+    if (errorCode != 0) {
+        uv_close((uv_handle_t*)&_stopEvent, 0);
+        uv_run(&_loop, UV_RUN_NOWAIT);
+        uv_loop_close(&_loop);
+        BEAM_LOG_ERROR() << "cannot initialize flush check, error=" << errorCode;
+        IO_EXCEPTION(errorCode);
+    }
+    _flushCheck.data = this;
+
     _pendingWrites  = std::make_unique<PendingWrites>(*this);
     _tcpConnectors  = std::make_unique<TcpConnectors>(*this);
     _proxyConnector = std::make_unique<ProxyConnector>(*this);
@@ -412,6 +425,10 @@ Reactor::~Reactor() {
     if (_stopEvent.data)
         uv_close((uv_handle_t*)&_stopEvent, 0);
 
+    _flushPending.clear();
+    if (_flushCheck.data)
+        uv_close((uv_handle_t*)&_flushCheck, 0);
+
     // run one cycle to release all closing handles
     uv_run(&_loop, UV_RUN_NOWAIT);
     if (uv_loop_close(&_loop) == UV_EBUSY) {
@@ -532,16 +549,38 @@ void Reactor::cancel_timer(Object* o) {
     }
 }
 
-ErrorCode Reactor::init_tcpserver(Object* o, Address bindAddress, uv_connection_cb cb) {
+ErrorCode Reactor::init_tcpserver(Object* o, Address bindAddress, uv_connection_cb cb, bool reusePort) {
     assert(o);
     assert(cb);
 
     uv_handle_t* h = _handlePool.alloc();
-    ErrorCode errorCode = (ErrorCode)uv_tcp_init(&_loop, (uv_tcp_t*)h);
+
+    // with reusePort the socket must exist before bind, to set the option
+    ErrorCode errorCode = reusePort ?
+        (ErrorCode)uv_tcp_init_ex(&_loop, (uv_tcp_t*)h, AF_INET) :
+        (ErrorCode)uv_tcp_init(&_loop, (uv_tcp_t*)h);
+
     if (init_object(errorCode, o, h) != EC_OK) {
         return errorCode;
     }
 
+    if (reusePort) {
+#if defined(SO_REUSEPORT) && !defined(WIN32)
+        uv_os_fd_t fd;
+        errorCode = (ErrorCode)uv_fileno(h, &fd);
+        if (errorCode != 0) {
+            return errorCode;
+        }
+
+        int val = 1;
+        if (setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &val, sizeof(val))) {
+            return (ErrorCode)uv_translate_sys_error(errno);
+        }
+#else
+        return EC_ENOTSUP;
+#endif
+    }
+
     sockaddr_in addr;
     bindAddress.fill_sockaddr_in(addr);
 
@@ -617,6 +656,37 @@ ErrorCode Reactor::async_write(Reactor::Object* o, BufferChain& unsent, const Re
     return _pendingWrites->async_write(o, unsent, cb);
 }
 
+void Reactor::schedule_flush(TcpStream* stream) {
+    assert(stream);
+    if (_flushPending.empty()) {
+        // the check handle is active only while there's something to flush, otherwise it'd keep the loop alive
+        uv_check_start(&_flushCheck, on_flush_check);
+    }
+    _flushPending.insert(stream);
+}
+
+void Reactor::cancel_flush(TcpStream* stream) {
+    _flushPending.erase(stream);
+    if (_flushPending.empty()) {
+        uv_check_stop(&_flushCheck);
+    }
+}
+
+void Reactor::on_flush_check(uv_check_t* handle) {
+    Reactor* self = reinterpret_cast<Reactor*>(handle->data);
+    if (!self) return;
+
+    // one by one: a stream may be destroyed (and removed from the set) in the error callback of another one
+    while (!self->_flushPending.empty()) {
+        auto it = self->_flushPending.begin();
+        TcpStream* stream = *it;
+        self->_flushPending.erase(it);
+        stream->flush_deferred();
+    }
+
+    uv_check_stop(handle);
+}
+
 Result Reactor::tcp_connect(
     Address address,
     uint64_t tag,
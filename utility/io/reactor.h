@@ -173,7 +173,7 @@ private:
     ErrorCode start_timer(Object* o, unsigned intervalMsec, bool isPeriodic, uv_timer_cb cb);
     void cancel_timer(Object* o);
 
-    ErrorCode init_tcpserver(Object* o, Address bindAddress, uv_connection_cb cb);
+    ErrorCode init_tcpserver(Object* o, Address bindAddress, uv_connection_cb cb, bool reusePort = false);
     ErrorCode init_tcpstream(Object* o);
     ErrorCode accept_tcpstream(Object* acceptor, Object* newConnection);
     TcpStream* stream_connected(TcpStream* stream, uv_handle_t* h);
@@ -194,6 +194,13 @@ private:
 
     uv_loop_t _loop;
     uv_async_t _stopEvent;
+
+    // write coalescing: streams flushed once per loop iteration, after the I/O callbacks
+    uv_check_t _flushCheck;
+    std::unordered_set<TcpStream*> _flushPending;
+    void schedule_flush(TcpStream* stream);
+    void cancel_flush(TcpStream* stream);
+    static void on_flush_check(uv_check_t* handle);
     MemPool<uv_handle_t, sizeof(Handles)> _handlePool;
     bool _creatingInternalObjects=false;
 
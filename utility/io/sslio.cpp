@@ -93,13 +93,17 @@ struct SSLInitializer {
 
 SSLInitializer g_sslInitializer;
 
+constexpr long SESSION_TIMEOUT_SEC = 2 * 3600;
+constexpr size_t MAX_CLIENT_SESSIONS = 256;
+
 SSL_CTX* init_ctx(bool isServer) {
     if (!g_sslInitializer.ok) {
         BEAM_LOG_ERROR() << "SSL init failed";
         IO_EXCEPTION(EC_SSL_ERROR);
     }
 
-    static const char* cipher_settings = "ALL:!ADH:!LOW:!EXP:!MD5:@STRENGTH";
+    // forward secret AEAD suites first (the listed order is kept, hence no @STRENGTH), the rest as a fallback
+    static const char* cipher_settings = "ECDHE+AESGCM:ECDHE+CHACHA20:ECDHE:ALL:!ADH:!LOW:!EXP:!MD5";
 
     SSL_CTX* ctx = SSL_CTX_new(isServer ? SSLv23_server_method() : SSLv23_client_method());
     if (!ctx) {
@@ -111,10 +115,31 @@ SSL_CTX* init_ctx(bool isServer) {
         IO_EXCEPTION(EC_SSL_ERROR);
     }
 
+#if OPENSSL_VERSION_NUMBER >= 0x10101000L
+    // modern curves preferred for ECDHE
+    if (SSL_CTX_set1_groups_list(ctx, "X25519:P-256:P-384") != 1) {
+        BEAM_LOG_ERROR() << "SSL_CTX_set1_groups_list failed";
+        IO_EXCEPTION(EC_SSL_ERROR);
+    }
+#elif OPENSSL_VERSION_NUMBER >= 0x10002000L
+    SSL_CTX_set_ecdh_auto(ctx, 1);
+#endif
+
     SSL_CTX_set_info_callback(ctx, ssl_info);
 
     SSL_CTX_set_options(ctx, SSL_OP_ALL | SSL_OP_NO_SSLv2 | SSL_OP_NO_SSLv3);
 
+    if (isServer) {
+        SSL_CTX_set_options(ctx, SSL_OP_CIPHER_SERVER_PREFERENCE);
+
+        // session cache and tickets (both on by default) let the reconnecting clients skip the full handshake.
+        // The id context is required for resumption when client certificates are verified
+        static const unsigned char sessionIdContext[] = "beam";
+        SSL_CTX_set_session_id_context(ctx, sessionIdContext, sizeof(sessionIdContext) - 1);
+        SSL_CTX_set_session_cache_mode(ctx, SSL_SESS_CACHE_SERVER);
+        SSL_CTX_set_timeout(ctx, SESSION_TIMEOUT_SEC);
+    }
+
     return ctx;
 }
 
@@ -222,10 +247,61 @@ SSLContext::Ptr SSLContext::create_client_context(const char* certFileName, cons
     return Ptr(new SSLContext(ctx, false));
 }
 
+SSLContext::SSLContext(SSL_CTX* ctx, bool isServer) :
+    _ctx(ctx), _isServer(isServer)
+{
+    SSL_CTX_set_app_data(_ctx, this);
+
+    if (!_isServer) {
+        // sessions are kept by host in _sessions, not in the OpenSSL internal cache which is keyed by session id
+        SSL_CTX_set_session_cache_mode(_ctx, SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL_STORE);
+        SSL_CTX_sess_set_new_cb(_ctx, on_new_session);
+    }
+}
+
 SSLContext::~SSLContext() {
+    for (auto& x : _sessions) {
+        SSL_SESSION_free(x.second);
+    }
     SSL_CTX_free(_ctx);
 }
 
+int SSLContext::on_new_session(SSL* ssl, SSL_SESSION* session) {
+    // may be called after the handshake (TLS 1.3 tickets)
+    const char* host = SSL_get_servername(ssl, TLSEXT_NAMETYPE_host_name);
+    auto* self = static_cast<SSLContext*>(SSL_CTX_get_app_data(SSL_get_SSL_CTX(ssl)));
+    if (!host || !self) return 0;
+
+    std::lock_guard<std::mutex> lock(self->_sessionsMutex);
+
+    auto it = self->_sessions.find(host);
+    if (it != self->_sessions.end()) {
+        SSL_SESSION_free(it->second);
+        it->second = session;
+    } else {
+        if (self->_sessions.size() >= MAX_CLIENT_SESSIONS) {
+            // unlikely, the number of hosts we connect to is small
+            for (auto& x : self->_sessions) {
+                SSL_SESSION_free(x.second);
+            }
+            self->_sessions.clear();
+        }
+        self->_sessions.emplace(host, session);
+    }
+
+    return 1; // the reference is kept
+}
+
+void SSLContext::resume_session(SSL* ssl, const char* host) {
+    assert(!_isServer && host);
+
+    std::lock_guard<std::mutex> lock(_sessionsMutex);
+    auto it = _sessions.find(host);
+    if (it != _sessions.end()) {
+        SSL_set_session(ssl, it->second); // adds its own reference
+    }
+}
+
 SSLIO::SSLIO(
     const SSLContext::Ptr& ctx,
     const OnDecryptedData& onDecryptedData, const OnEncryptedData& onEncryptedData,
@@ -266,7 +342,14 @@ SSLIO::SSLIO(
 }
 
 SSLIO::~SSLIO() {
-    if (_ssl) SSL_free(_ssl);
+    if (_ssl) {
+        // connections are usually dropped w/o close_notify, OpenSSL would then invalidate the session (shared with the
+        // context's cache). Fatal errors invalidate it anyway
+        if (SSL_is_init_finished(_ssl)) {
+            SSL_set_shutdown(_ssl, SSL_SENT_SHUTDOWN | SSL_RECEIVED_SHUTDOWN);
+        }
+        SSL_free(_ssl);
+    }
 }
 
 void SSLIO::enqueue(const io::SharedBuffer& buf) {
@@ -319,11 +402,21 @@ Result SSLIO::send_pending_data(bool flush) {
 Result SSLIO::do_handshake() {
     if (!SSL_is_init_finished(_ssl)) {
         SSL_do_handshake(_ssl);
+        if (SSL_is_init_finished(_ssl)) {
+            BEAM_LOG_VERBOSE() << TRACE(_ssl) << " handshake done, " << SSL_get_version(_ssl) << " " << SSL_get_cipher_name(_ssl) << (SSL_session_reused(_ssl) ? ", resumed" : "");
+        }
         return send_pending_data(true);
     }
     return Ok();
 }
 
+void SSLIO::set_host_name(const char* host) {
+    SSL_set_tlsext_host_name(_ssl, host);
+    if (!_ctx->is_server()) {
+        _ctx->resume_session(_ssl, host);
+    }
+}
+
 Result SSLIO::on_encrypted_data_from_stream(const void *data, size_t size) {
     //BEAM_LOG_DEBUG() << TRACE(size); // << std::string((const char*)data, size);
 
@@ -16,6 +16,9 @@
 #include "errorhandling.h"
 #include "buffer.h"
 #include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
 #include <openssl/err.h>
 #include <openssl/dh.h>
 #include <openssl/ssl.h>
@@ -37,13 +40,24 @@ public:
 
     bool is_server() { return _isServer; }
 
+    /// Client side: resumes the last session established with the same host, if any.
+    /// Sessions are remembered per SNI host name, connections w/o it do full handshakes
+    void resume_session(SSL* ssl, const char* host);
+
     ~SSLContext();
 
 private:
-    SSLContext(SSL_CTX* ctx, bool isServer) : _ctx(ctx), _isServer(isServer) {}
+    SSLContext(SSL_CTX* ctx, bool isServer);
+
+    /// OpenSSL new session callback, client side
+    static int on_new_session(SSL* ssl, SSL_SESSION* session);
 
     SSL_CTX* _ctx;
     bool _isServer;
+
+    /// Client sessions by host name
+    std::mutex _sessionsMutex;
+    std::unordered_map<std::string, SSL_SESSION*> _sessions;
 };
 
 class SSLIO {
@@ -73,6 +87,9 @@ public:
     /// Encrypted data received from stream. Returns whether to proceed
     Result on_encrypted_data_from_stream(const void* data, size_t size);
 
+    /// Sets SNI host name, client side also tries to resume the previous session with this host
+    void set_host_name(const char* host);
+
     void enqueue(const SharedBuffer& buf);
 
     Result flush();
@@ -34,7 +34,7 @@ TcpServer::Ptr SslServer::create(
 }
 
 SslServer::SslServer(Callback&& callback, Reactor& reactor, Address bindAddress, SSLContext::Ptr&& ctx) :
-    TcpServer(std::move(callback), reactor, bindAddress),
+    TcpServer(std::move(callback), reactor, bindAddress, false),
     _ctx(std::move(ctx))
 {}
 
@@ -41,7 +41,7 @@ void SslStream::shutdown() {
 
 void SslStream::set_host_name(const char* host)
 {
-    SSL_set_tlsext_host_name(_ssl.native_handle(), host);
+    _ssl.set_host_name(host);
 }
 
 bool SslStream::on_read(ErrorCode ec, void *data, size_t size) {
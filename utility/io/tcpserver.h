@@ -25,13 +25,14 @@ public:
     /// Either newStream is accepted or status != 0
     using Callback = std::function<void(TcpStream::Ptr&& newStream, ErrorCode status)>;
 
-    /// Creates the server and starts listening
-    static Ptr create(Reactor& reactor, Address bindAddress, Callback&& callback);
+    /// Creates the server and starts listening.
+    /// reusePort: SO_REUSEPORT, several servers (in different reactors or processes) may listen on the same address, the kernel balances incoming connections
+    static Ptr create(Reactor& reactor, Address bindAddress, Callback&& callback, bool reusePort = false);
 
     virtual ~TcpServer() = default;
 
 protected:
-    TcpServer(Callback&& callback, Reactor& reactor, Address bindAddress);
+    TcpServer(Callback&& callback, Reactor& reactor, Address bindAddress, bool reusePort);
 
     virtual void on_accept(ErrorCode errorCode);
 
@@ -23,10 +23,12 @@
 namespace beam { namespace io {
 
 TcpStream::TcpStream() :
+    _coalesceMax(config().get_int("io.write_coalesce_max", 64*1024, 0, 1024*1024*16)),
     _onDataWritten(BIND_THIS_MEMFN(on_data_written))
 {}
 
 TcpStream::~TcpStream() {
+    if (_flushScheduled && _reactor) _reactor->cancel_flush(this);
     disable_read();
     if (_handle) _handle->data = 0;
 }
@@ -114,7 +116,7 @@ Result TcpStream::write(const BufferChain& fragments, bool flush) {
 void TcpStream::shutdown() {
     if (is_connected()) {
         disable_read();
-        do_write(true);
+        flush_now();
         _reactor->shutdown_tcpstream(this);
         assert(!_callback);
         assert(!is_connected());
@@ -128,19 +130,59 @@ void TcpStream::enable_keepalive(unsigned initialDelaySecs) {
 }
 
 Result TcpStream::do_write(bool flush) {
+    if (!flush) return Ok();
+
     size_t nBytes = _writeBuffer.size();
-    if (flush && nBytes > 0) {
+    if (nBytes < _coalesceMax) {
+        // defer, gather with the other messages written in this loop iteration. Account it as unsent right away, the bandwidth control relies on it
+        if (nBytes > _deferredBytes) {
+            _state.unsent += nBytes - _deferredBytes;
+            _deferredBytes = nBytes;
+        }
+
+        if (!_flushScheduled && nBytes) {
+            _flushScheduled = true;
+            _reactor->schedule_flush(this);
+        }
+        return Ok();
+    }
+
+    return flush_now();
+}
+
+Result TcpStream::flush_now() {
+    if (_flushScheduled) {
+        _flushScheduled = false;
+        _reactor->cancel_flush(this);
+    }
+
+    size_t nBytes = _writeBuffer.size();
+    if (nBytes > 0) {
         ErrorCode ec = _reactor->async_write(this, _writeBuffer, _onDataWritten);
         if (ec != EC_OK) {
             BEAM_LOG_DEBUG() << __FUNCTION__ << " " << error_str(ec);
+            _state.unsent -= _deferredBytes;
+            _deferredBytes = 0;
             return make_unexpected(ec);
         }
-        _state.unsent += nBytes;
+        _state.unsent += nBytes - _deferredBytes;
+        _deferredBytes = 0;
     }
-    if (flush) assert(_writeBuffer.empty());
+    assert(_writeBuffer.empty());
     return Ok();
 }
 
+void TcpStream::flush_deferred() {
+    _flushScheduled = false; // already removed by the reactor
+    if (!is_connected()) return;
+
+    Result res = flush_now();
+    if (!res && _callback) {
+        // same as the failed write completion. *this* may be deleted
+        _callback(res.error(), 0, 0);
+    }
+}
+
 void TcpStream::on_data_written(ErrorCode errorCode, size_t n) {
     if (errorCode != EC_OK) {
         if (_callback) _callback(errorCode, 0, 0);
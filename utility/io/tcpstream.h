@@ -97,14 +97,23 @@ private:
     void alloc_read_buffer();
     void free_read_buffer();
 
-    // sends async write request if flush == true
+    // sends async write request if flush == true. Small writes may be deferred till the end of the loop iteration, to be sent together
     Result do_write(bool flush);
 
+    // sends async write request right away
+    Result flush_now();
+
+    // called by the reactor for the deferred write
+    void flush_deferred();
+
     // callback from write request
     void on_data_written(ErrorCode errorCode, size_t n);
 
     uv_buf_t _readBuffer={0, 0};
     BufferChain _writeBuffer;
+    size_t _coalesceMax; // write-queue high-water mark for the deferred write, 0 = don't defer
+    size_t _deferredBytes = 0; // part of _writeBuffer already accounted in _state.unsent
+    bool _flushScheduled = false;
     Callback _callback;
     State _state;
     Reactor::OnDataWritten _onDataWritten;
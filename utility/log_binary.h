@@ -0,0 +1,164 @@
+// Copyright 2018 The Beam Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+#include <string>
+#include <string_view>
+#include <sstream>
+#include <stdint.h>
+#include <string.h>
+
+// Structured binary log format.
+//
+// File:    Magic, then records
+// Record:  varint payload size, payload
+// Payload: varint timestamp (msec), varint thread, level byte (Level::Location bit: varint line, string func, string file follow),
+//          then the fields up to the end of the payload
+// Field:   tag byte, followed by: UInt - varint, SInt - zigzag varint, Double - 8 bytes LE, String - varint size and bytes
+
+namespace beam::LogBinary {
+
+static const char Magic[] = "BEAMLOG\x01";
+static const size_t MagicSize = sizeof(Magic) - 1;
+
+struct Tag {
+    static const uint8_t UInt = 1;
+    static const uint8_t SInt = 2;
+    static const uint8_t Double = 3;
+    static const uint8_t String = 4;
+    static const uint8_t False = 5;
+    static const uint8_t True = 6;
+};
+
+struct Level {
+    static const uint8_t Mask = 0x7f;
+    static const uint8_t Location = 0x80;
+};
+
+inline void put_varint(std::string& s, uint64_t x) {
+    for (; x >= 0x80; x >>= 7) {
+        s.push_back(char(uint8_t(x) | 0x80));
+    }
+    s.push_back(char(x));
+}
+
+inline void put_uint(std::string& s, uint64_t x) {
+    s.push_back(char(Tag::UInt));
+    put_varint(s, x);
+}
+
+inline void put_sint(std::string& s, int64_t x) {
+    s.push_back(char(Tag::SInt));
+    put_varint(s, (uint64_t(x) << 1) ^ uint64_t(x >> 63));
+}
+
+inline void put_double(std::string& s, double x) {
+    uint64_t n;
+    memcpy(&n, &x, sizeof(n));
+    s.push_back(char(Tag::Double));
+    for (int i = 0; i < 8; i++, n >>= 8) {
+        s.push_back(char(uint8_t(n)));
+    }
+}
+
+inline void put_string_raw(std::string& s, std::string_view x) {
+    put_varint(s, x.size());
+    s.append(x.data(), x.size());
+}
+
+inline void put_string(std::string& s, std::string_view x) {
+    s.push_back(char(Tag::String));
+    put_string_raw(s, x);
+}
+
+inline void put_bool(std::string& s, bool x) {
+    s.push_back(char(x ? Tag::True : Tag::False));
+}
+
+struct Reader {
+    const uint8_t* p;
+    const uint8_t* end;
+
+    bool get_varint(uint64_t& x) {
+        x = 0;
+        for (unsigned shift = 0; shift < 64; shift += 7) {
+            if (p == end) return false;
+            uint8_t b = *p++;
+            x |= uint64_t(b & 0x7f) << shift;
+            if (!(b & 0x80)) return true;
+        }
+        return false;
+    }
+
+    bool get_string(std::string_view& x) {
+        uint64_t n;
+        if (!get_varint(n) || (n > uint64_t(end - p))) return false;
+        x = std::string_view((const char*) p, size_t(n));
+        p += n;
+        return true;
+    }
+};
+
+/// Appends the fields as text, the same way the text log would have printed them. Returns false on malformed data
+inline bool decode_fields(const char* buf, size_t size, std::string& out) {
+    Reader r{ (const uint8_t*) buf, (const uint8_t*) buf + size };
+    while (r.p != r.end) {
+        uint8_t tag = *r.p++;
+        uint64_t n;
+        switch (tag) {
+        case Tag::UInt:
+            if (!r.get_varint(n)) return false;
+            out += std::to_string(n);
+            break;
+
+        case Tag::SInt:
+            if (!r.get_varint(n)) return false;
+            out += std::to_string(int64_t(n >> 1) ^ -int64_t(n & 1));
+            break;
+
+        case Tag::Double: {
+            if (r.end - r.p < 8) return false;
+            n = 0;
+            for (int i = 8; i--; ) {
+                n = (n << 8) | r.p[i];
+            }
+            r.p += 8;
+            double x;
+            memcpy(&x, &n, sizeof(x));
+            std::ostringstream os;
+            os << x;
+            out += os.str();
+            break;
+        }
+
+        case Tag::String: {
+            std::string_view x;
+            if (!r.get_string(x)) return false;
+            out.append(x.data(), x.size());
+            break;
+        }
+
+        case Tag::False:
+        case Tag::True:
+            out.push_back((Tag::True == tag) ? '1' : '0');
+            break;
+
+        default:
+            return false;
+        }
+    }
+    return true;
+}
+
+} //namespace
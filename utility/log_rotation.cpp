@@ -65,7 +65,7 @@ static void clean_old_logfiles_2(const std::string& directory, const std::string
             auto p = it->path();
             if (!fs::is_regular_file(p) ||
                 !boost::starts_with(p.filename().string(), prefix) ||
-                !(p.extension().string() == ".log")
+                !(p.extension().string() == ".log" || p.extension().string() == ".blog")
             ) continue;
             auto dayAgo = unsigned( (now - fs::last_write_time(p)) / SECS_IN_DAY );
             days[dayAgo].push_back(p);
@@ -41,6 +41,11 @@ namespace fs = std::filesystem;
 #include <fstream>
 #include <mutex>
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <thread>
+#include <vector>
 
 namespace beam {
 
@@ -49,6 +54,8 @@ using namespace std;
 Logger* Logger::g_logger = 0;
 
 class LoggerImpl : public Logger {
+    friend class AsyncLogger;
+
 protected:
     mutex _mutex;
     static const size_t MAX_HEADER_SIZE = 256;
@@ -72,12 +79,6 @@ protected:
         if (minLevel <= 0) throw runtime_error("logger: minimal level out of range");
     }
 
-    virtual ~LoggerImpl() {
-        if (this == g_logger) {
-            g_logger = 0;
-        }
-    }
-
     void set_header_formatter(LogMessageHeaderFormatter formatter) override {
         if (formatter) _headerFormatter = formatter;
     }
@@ -92,15 +93,19 @@ protected:
         }
     }
 
-    void write_message(const LogMessageHeader& header, const char* buf, size_t size) override {
+    size_t format_header(char* headerFormatted, const LogMessageHeader& header) {
         char timestampFormatted[MAX_TIMESTAMP_SIZE];
-        char headerFormatted[MAX_HEADER_SIZE];
         if (!_timeFormat.empty()) {
             format_timestamp(timestampFormatted, MAX_TIMESTAMP_SIZE, _timeFormat.c_str(), header.timestamp, _printMilliseconds);
         } else {
             timestampFormatted[0] = 0;
         }
-        size_t headerSize = _headerFormatter(headerFormatted, MAX_HEADER_SIZE, timestampFormatted, header);
+        return _headerFormatter(headerFormatted, MAX_HEADER_SIZE, timestampFormatted, header);
+    }
+
+    void write_message(const LogMessageHeader& header, const char* buf, size_t size) override {
+        char headerFormatted[MAX_HEADER_SIZE];
+        size_t headerSize = format_header(headerFormatted, header);
         write_impl(header.level, headerFormatted, headerSize, buf, size);
     }
 
@@ -110,6 +115,12 @@ protected:
     }
 
 public:
+    virtual ~LoggerImpl() {
+        if (this == g_logger) {
+            g_logger = 0;
+        }
+    }
+
     bool level_accepted(int level) override {
         return level >= _minLevel;
     }
@@ -136,14 +147,48 @@ public:
 
 class FileLogger : public LoggerImpl {
 public:
-    FileLogger(int flushLevel, int minLevel, const string& fileNamePrefix, const string& dstPath) :
+    FileLogger(int flushLevel, int minLevel, const string& fileNamePrefix, const string& dstPath, bool binary) :
         LoggerImpl(0, minLevel, flushLevel),
         _fileNamePrefix(fileNamePrefix),
-        _dstPath(dstPath)
+        _dstPath(dstPath),
+        _binary(binary)
     {
         open_new_file();
     }
 
+    bool is_binary() override {
+        return _binary;
+    }
+
+    void write_message(const LogMessageHeader& header, const char* buf, size_t size) override {
+        if (_binary) {
+            write_record(header, buf, size);
+        } else {
+            LoggerImpl::write_message(header, buf, size);
+        }
+    }
+
+    void write_record(const LogMessageHeader& header, const char* fields, size_t size) {
+        static thread_local std::string payload, record;
+        payload.clear();
+        record.clear();
+
+        LogBinary::put_varint(payload, header.timestamp);
+        LogBinary::put_varint(payload, header.thread);
+        if (header.line) {
+            payload.push_back(char(header.level | LogBinary::Level::Location));
+            LogBinary::put_varint(payload, (uint32_t) header.line);
+            LogBinary::put_string_raw(payload, header.func);
+            LogBinary::put_string_raw(payload, header.file);
+        } else {
+            payload.push_back(char(header.level));
+        }
+        payload.append(fields, size);
+
+        LogBinary::put_varint(record, payload.size());
+        write_impl(header.level, record.data(), record.size(), payload.data(), payload.size());
+    }
+
     void rotate() override {
         try {
             open_new_file();
@@ -170,7 +215,7 @@ private:
 
         string fileName(_fileNamePrefix);
         fileName += format_timestamp("%y_%m_%d_%H_%M_%S", local_timestamp_msec(), false);
-        fileName += ".log";
+        fileName += _binary ? ".blog" : ".log";
 
         if (!_dstPath.empty())
         {
@@ -208,10 +253,15 @@ private:
 #endif
 
         if (!_sink) throw runtime_error(string("cannot open file ") + fileName);
+
+        if (_binary && !ftell(_sink)) {
+            fwrite(LogBinary::Magic, 1, LogBinary::MagicSize, _sink);
+        }
     }
 
     std::string _fileNamePrefix;
     std::string _dstPath;
+    bool _binary;
 
 #ifdef WIN32
     std::wstring _fullPath;
@@ -225,21 +275,38 @@ class CombinedLogger : public LoggerImpl {
     ConsoleLogger _consoleSink;
 
 public:
-    CombinedLogger(int flushLevel, int consoleLevel, int fileLevel, const std::string& fileNamePrefix, const string& dstPath) :
+    CombinedLogger(int flushLevel, int consoleLevel, int fileLevel, const std::string& fileNamePrefix, const string& dstPath, bool binary) :
         LoggerImpl(0, min(fileLevel, consoleLevel), flushLevel),
-        _fileSink(flushLevel, fileLevel, fileNamePrefix, dstPath),
+        _fileSink(flushLevel, fileLevel, fileNamePrefix, dstPath, binary),
         _consoleSink(flushLevel, consoleLevel)
     {}
 
+    bool is_binary() override {
+        return _fileSink.is_binary();
+    }
+
     void write_message(const LogMessageHeader& header, const char* buf, size_t size) override {
-        char timestampFormatted[MAX_TIMESTAMP_SIZE];
-        char headerFormatted[MAX_HEADER_SIZE];
-        if (!_timeFormat.empty()) {
-            format_timestamp(timestampFormatted, MAX_TIMESTAMP_SIZE, _timeFormat.c_str(), header.timestamp, _printMilliseconds);
-        } else {
-            timestampFormatted[0] = 0;
+        if (_fileSink.is_binary()) {
+            if (_fileSink.level_accepted(header.level)) {
+                _fileSink.write_record(header, buf, size);
+            }
+            if (!_consoleSink.level_accepted(header.level)) {
+                return;
+            }
+
+            // the console stays human-readable
+            std::string text;
+            LogBinary::decode_fields(buf, size, text);
+            text.push_back('\n');
+
+            char headerFormatted[MAX_HEADER_SIZE];
+            size_t headerSize = format_header(headerFormatted, header);
+            _consoleSink.write_impl(header.level, headerFormatted, headerSize, text.data(), text.size());
+            return;
         }
-        size_t headerSize = _headerFormatter(headerFormatted, MAX_HEADER_SIZE, timestampFormatted, header);
+
+        char headerFormatted[MAX_HEADER_SIZE];
+        size_t headerSize = format_header(headerFormatted, header);
         if (_consoleSink.level_accepted(header.level)) {
             _consoleSink.write_impl(header.level, headerFormatted, headerSize, buf, size);
         }
@@ -257,18 +324,205 @@ public:
     }
 };
 
+// Moves header formatting and sink I/O off the logging threads.
+// Every thread appends its messages to its own single-producer/single-consumer ring, without locks,
+// the flush thread drains all the rings in timestamp order and writes them to the wrapped logger.
+class AsyncLogger : public Logger {
+    static const uint32_t QUEUE_SIZE = 1024; // per thread, power of 2
+    static constexpr std::chrono::milliseconds FLUSH_PERIOD = std::chrono::milliseconds(100);
+
+    struct Queue {
+        struct Entry {
+            LogMessageHeader header{ 0, nullptr, 0, nullptr };
+            std::string text; // capacity is reused as the ring wraps
+        };
+
+        Entry entries[QUEUE_SIZE];
+        std::atomic<uint32_t> head{ 0 }; // advanced by the producer
+        std::atomic<uint32_t> tail{ 0 }; // advanced by the flush thread
+    };
+
+    typedef std::shared_ptr<Queue> QueuePtr;
+
+    std::unique_ptr<LoggerImpl> _impl;
+    int _flushLevel;
+    uint64_t _generation;
+
+    mutex _mutex; // protects the queue list and the wake-up flags
+    condition_variable _cond;
+    std::vector<QueuePtr> _queues;
+    bool _wake = false;
+    bool _stop = false;
+
+    mutex _writeMutex; // held by the flush thread while writing
+    std::thread _thread;
+
+    static std::atomic<uint64_t> s_generation;
+
+    struct ThreadQueue {
+        QueuePtr queue;
+        uint64_t generation = 0;
+    };
+
+    Queue& get_queue() {
+        static thread_local ThreadQueue tq;
+        if (tq.generation != _generation) {
+            // first message of this thread to this logger instance
+            tq.queue = std::make_shared<Queue>();
+            tq.generation = _generation;
+
+            lock_guard<mutex> lock(_mutex);
+            _queues.push_back(tq.queue);
+        }
+        return *tq.queue;
+    }
+
+    void wake() {
+        {
+            lock_guard<mutex> lock(_mutex);
+            _wake = true;
+        }
+        _cond.notify_one();
+    }
+
+    void thread_func() {
+        std::vector<QueuePtr> queues;
+        std::vector<uint32_t> heads;
+        std::vector<const Queue::Entry*> batch;
+
+        for (bool stop = false; !stop; ) {
+            {
+                unique_lock<mutex> lock(_mutex);
+                _cond.wait_for(lock, FLUSH_PERIOD, [this] { return _wake || _stop; });
+                _wake = false;
+                stop = _stop;
+
+                // queues of the finished threads are dropped once drained
+                _queues.erase(std::remove_if(_queues.begin(), _queues.end(), [](const QueuePtr& q) {
+                    return (q.use_count() == 1) && (q->head.load(memory_order_acquire) == q->tail.load(memory_order_relaxed));
+                }), _queues.end());
+
+                queues = _queues;
+            }
+
+            heads.resize(queues.size());
+            batch.clear();
+
+            for (size_t i = 0; i < queues.size(); i++) {
+                Queue& q = *queues[i];
+                heads[i] = q.head.load(memory_order_acquire);
+                for (uint32_t n = q.tail.load(memory_order_relaxed); n != heads[i]; n++) {
+                    batch.push_back(q.entries + (n & (QUEUE_SIZE - 1)));
+                }
+            }
+
+            std::stable_sort(batch.begin(), batch.end(), [](const Queue::Entry* a, const Queue::Entry* b) {
+                return a->header.timestamp < b->header.timestamp;
+            });
+
+            {
+                lock_guard<mutex> lock(_writeMutex);
+                for (const Queue::Entry* e : batch) {
+                    _impl->write_message(e->header, e->text.data(), e->text.size());
+                }
+            }
+
+            for (size_t i = 0; i < queues.size(); i++) {
+                queues[i]->tail.store(heads[i], memory_order_release);
+            }
+            queues.clear();
+        }
+    }
+
+public:
+    AsyncLogger(LoggerImpl* impl, int flushLevel) :
+        _impl(impl),
+        _flushLevel(flushLevel),
+        _generation(++s_generation)
+    {
+        _thread = std::thread(&AsyncLogger::thread_func, this);
+    }
+
+    ~AsyncLogger() {
+        if (this == g_logger) {
+            g_logger = 0;
+        }
+        {
+            lock_guard<mutex> lock(_mutex);
+            _stop = true; // the last pass drains everything
+        }
+        _cond.notify_one();
+        _thread.join();
+    }
+
+    void set_header_formatter(LogMessageHeaderFormatter formatter) override {
+        lock_guard<mutex> lock(_writeMutex);
+        _impl->set_header_formatter(formatter);
+    }
+
+    void set_time_format(const char* format, bool printMilliseconds) override {
+        lock_guard<mutex> lock(_writeMutex);
+        _impl->set_time_format(format, printMilliseconds);
+    }
+
+    const FileNameType& get_current_file_name() override {
+        return _impl->get_current_file_name();
+    }
+
+    void rotate() override {
+        lock_guard<mutex> lock(_writeMutex);
+        _impl->rotate();
+    }
+
+protected:
+    bool level_accepted(int level) override {
+        return _impl->level_accepted(level);
+    }
+
+    bool is_binary() override {
+        return _impl->is_binary();
+    }
+
+    void write_message(const LogMessageHeader& header, const char* buf, size_t size) override {
+        Queue& q = get_queue();
+
+        uint32_t head = q.head.load(memory_order_relaxed);
+        if (head - q.tail.load(memory_order_acquire) >= QUEUE_SIZE) {
+            // the flush thread is behind, wait for it rather than drop or reorder messages
+            wake();
+            while (head - q.tail.load(memory_order_acquire) >= QUEUE_SIZE) {
+                std::this_thread::yield();
+            }
+        }
+
+        Queue::Entry& e = q.entries[head & (QUEUE_SIZE - 1)];
+        e.header = header;
+        e.text.assign(buf, size);
+        q.head.store(head + 1, memory_order_release);
+
+        if (header.level >= _flushLevel) {
+            wake();
+        }
+    }
+};
+
+std::atomic<uint64_t> AsyncLogger::s_generation{ 0 };
+constexpr std::chrono::milliseconds AsyncLogger::FLUSH_PERIOD;
+
 std::shared_ptr<Logger> Logger::create(
     int flushLevel,
     int consoleLevel,
     int fileLevel,
     const std::string& fileNamePrefix,
-    const std::string& dstPath
+    const std::string& dstPath,
+    bool async,
+    bool binary
 ) {
     if (g_logger) {
         throw runtime_error("logger already initialized");
     }
 
-    std::shared_ptr<Logger> logger;
+    std::unique_ptr<LoggerImpl> logger;
 
     int what = 0;
 
@@ -277,10 +531,10 @@ std::shared_ptr<Logger> Logger::create(
 
     switch (what) {
         case 3:
-            logger.reset(new CombinedLogger(flushLevel, consoleLevel, fileLevel, fileNamePrefix, dstPath));
+            logger.reset(new CombinedLogger(flushLevel, consoleLevel, fileLevel, fileNamePrefix, dstPath, binary));
             break;
         case 2:
-            logger.reset(new FileLogger(flushLevel, fileLevel, fileNamePrefix, dstPath));
+            logger.reset(new FileLogger(flushLevel, fileLevel, fileNamePrefix, dstPath, binary));
             break;
         case 1:
             logger.reset(new ConsoleLogger(flushLevel, consoleLevel));
@@ -289,8 +543,15 @@ std::shared_ptr<Logger> Logger::create(
             throw runtime_error("no logger sink configured");
     }
 
-    g_logger = logger.get();
-    return logger;
+    std::shared_ptr<Logger> res;
+    if (async) {
+        res = std::make_shared<AsyncLogger>(logger.release(), flushLevel);
+    } else {
+        res = std::move(logger);
+    }
+
+    g_logger = res.get();
+    return res;
 }
 
 namespace {
@@ -301,6 +562,7 @@ struct LogThreadContext {
     using Formatter = boost::iostreams::filtering_ostream;
 
     std::string msgBuffer;
+    std::string binBuffer; // typed fields of the binary log
     std::unique_ptr<Formatter> formatter;
     bool in_use = false;
 
@@ -319,6 +581,12 @@ LogThreadContext* get_context() {
     return &ctx;
 }
 
+uint32_t get_thread_number() {
+    static std::atomic<uint32_t> s_threads{ 0 };
+    static thread_local uint32_t n = ++s_threads;
+    return n;
+}
+
 } //namespace
 
 LogMessageHeader::LogMessageHeader(int _level, const char* _file, int _line, const char* _func) :
@@ -326,7 +594,8 @@ LogMessageHeader::LogMessageHeader(int _level, const char* _file, int _line, con
     func(_func),
     file(_file),
     line(_line),
-    level(_level)
+    level(_level),
+    thread(get_thread_number())
 {
     if (!func) func = "";
     if (!file) {
@@ -365,10 +634,26 @@ void LogMessage::init_formatter() {
     }
 
     _formatter = ctx->formatter.get();
+
+    if (Logger::g_logger && Logger::g_logger->is_binary()) {
+        _binary = &ctx->binBuffer;
+    }
+}
+
+void LogMessage::write_text_field() {
+    _formatter->flush();
+    std::string& buffer = get_context()->msgBuffer;
+    LogBinary::put_string(*_binary, buffer);
+    buffer.clear();
 }
 
 LogMessage::~LogMessage() {
-    if (Logger::g_logger && _formatter) {
+    if (Logger::g_logger && _binary) {
+        Logger::g_logger->write_message(header, _binary->data(), _binary->size());
+        _binary->clear();
+        get_context()->in_use = false;
+    }
+    else if (Logger::g_logger && _formatter) {
         *_formatter << '\n';
         _formatter->flush();
         std::string& buffer = get_context()->msgBuffer;
@@ -16,9 +16,11 @@
 #include <iostream>
 #include <memory>
 #include <type_traits>
+#include <string>
 #include <string.h>
 #include <stdio.h>
 #include <assert.h>
+#include "log_binary.h"
 
 #ifndef LOG_VERBOSE_ENABLED
     #define LOG_VERBOSE_ENABLED 0
@@ -51,12 +53,20 @@
 
 #define BEAM_LOG_SINK_DISABLED  0
 
+// Messages below this level are compiled out
+#ifndef BEAM_LOG_MIN_LEVEL
+    #define BEAM_LOG_MIN_LEVEL BEAM_LOG_LEVEL_VERBOSE
+#endif
+
 // This stub will be optimized out;
 struct LogMessageStub {
     LogMessageStub() {}
     template <typename T> LogMessageStub& operator<<(const T&) { return *this; }
 };
 
+// Compiled out message, its arguments are not evaluated
+#define BEAM_LOG_STRIPPED() while (false) LogMessageStub()
+
 #if SHOW_CODE_LOCATION
     #define BEAM_LOG_MESSAGE(LEVEL) if (beam::Logger::will_log(LEVEL)) beam::LogMessage(LEVEL, __FILE__, __LINE__, __FUNCTION__)
 #else
@@ -64,21 +74,37 @@ struct LogMessageStub {
 #endif
 
 #define BEAM_LOG_CRITICAL() BEAM_LOG_MESSAGE(BEAM_LOG_LEVEL_CRITICAL)
-#define BEAM_LOG_ERROR() BEAM_LOG_MESSAGE(BEAM_LOG_LEVEL_ERROR)
-#define BEAM_LOG_WARNING() BEAM_LOG_MESSAGE(BEAM_LOG_LEVEL_WARNING)
-#define BEAM_LOG_INFO() BEAM_LOG_MESSAGE(BEAM_LOG_LEVEL_INFO)
+
+#if BEAM_LOG_MIN_LEVEL <= BEAM_LOG_LEVEL_ERROR
+    #define BEAM_LOG_ERROR() BEAM_LOG_MESSAGE(BEAM_LOG_LEVEL_ERROR)
+#else
+    #define BEAM_LOG_ERROR() BEAM_LOG_STRIPPED()
+#endif
+
+#if BEAM_LOG_MIN_LEVEL <= BEAM_LOG_LEVEL_WARNING
+    #define BEAM_LOG_WARNING() BEAM_LOG_MESSAGE(BEAM_LOG_LEVEL_WARNING)
+#else
+    #define BEAM_LOG_WARNING() BEAM_LOG_STRIPPED()
+#endif
+
+#if BEAM_LOG_MIN_LEVEL <= BEAM_LOG_LEVEL_INFO
+    #define BEAM_LOG_INFO() BEAM_LOG_MESSAGE(BEAM_LOG_LEVEL_INFO)
+#else
+    #define BEAM_LOG_INFO() BEAM_LOG_STRIPPED()
+#endif
+
 #define BEAM_LOG_UNHANDLED_EXCEPTION() BEAM_LOG_ERROR() << "["<< __FILE__ << "] [" << __LINE__ << "] [" << __FUNCTION__ << "] unhandled exception. "
 
-#if LOG_DEBUG_ENABLED
+#if LOG_DEBUG_ENABLED && (BEAM_LOG_MIN_LEVEL <= BEAM_LOG_LEVEL_DEBUG)
     #define BEAM_LOG_DEBUG() BEAM_LOG_MESSAGE(BEAM_LOG_LEVEL_DEBUG)
 #else
-    #define BEAM_LOG_DEBUG() LogMessageStub()
+    #define BEAM_LOG_DEBUG() BEAM_LOG_STRIPPED()
 #endif
 
-#if LOG_VERBOSE_ENABLED
+#if LOG_VERBOSE_ENABLED && (BEAM_LOG_MIN_LEVEL <= BEAM_LOG_LEVEL_VERBOSE)
     #define BEAM_LOG_VERBOSE() BEAM_LOG_MESSAGE(BEAM_LOG_LEVEL_VERBOSE)
 #else
-    #define BEAM_LOG_VERBOSE() LogMessageStub()
+    #define BEAM_LOG_VERBOSE() BEAM_LOG_STRIPPED()
 #endif
 
 #define TRACE(var) " " #var "=" << var
@@ -105,6 +131,7 @@ struct LogMessageHeader {
     const char* file;
     int line;
     int level;
+    uint32_t thread; // sequential number of the logging thread
 
     LogMessageHeader(int _level, const char* _file, int _line, const char* _func);
 };
@@ -144,7 +171,13 @@ public:
         const std::string& fileNamePrefix = std::string(),
 
         // path to log file
-        const std::string& dstPath = std::string()
+        const std::string& dstPath = std::string(),
+
+        // format headers and write the sinks on a background thread, log calls only enqueue the message
+        bool async = false,
+
+        // write the file log in the structured binary format (see log_binary.h), the console stays text
+        bool binary = false
     );
 
     virtual ~Logger() {}
@@ -181,6 +214,9 @@ protected:
 
     virtual bool level_accepted(int level) = 0;
 
+    /// Messages are encoded as typed fields rather than text
+    virtual bool is_binary() { return false; }
+
     /// Called from LogMessage dtor on message completed
     virtual void write_message(const LogMessageHeader& header, const char* buf, size_t size) = 0;
 
@@ -209,6 +245,9 @@ public:
         else if constexpr (std::is_same<T, FlushCheckpoint>::value) {
             flush_last_checkpoint(this);
         }
+        else if (_binary) {
+            write_field(x);
+        }
         else {
             *_formatter << x;
         }
@@ -219,7 +258,41 @@ public:
 private:
     void init_formatter();
 
+    template <class T> void write_field(const T& x) {
+        if constexpr (std::is_same<T, bool>::value) {
+            LogBinary::put_bool(*_binary, x);
+        }
+        else if constexpr (std::is_same<T, char>::value) {
+            LogBinary::put_string(*_binary, std::string_view(&x, 1));
+        }
+        else if constexpr (std::is_same<T, signed char>::value || std::is_same<T, unsigned char>::value) {
+            // printed as characters by the text log
+            *_formatter << x;
+            write_text_field();
+        }
+        else if constexpr (std::is_integral<T>::value && std::is_signed<T>::value) {
+            LogBinary::put_sint(*_binary, x);
+        }
+        else if constexpr (std::is_integral<T>::value) {
+            LogBinary::put_uint(*_binary, x);
+        }
+        else if constexpr (std::is_floating_point<T>::value) {
+            LogBinary::put_double(*_binary, x);
+        }
+        else if constexpr (std::is_convertible<const T&, std::string_view>::value) {
+            LogBinary::put_string(*_binary, x);
+        }
+        else {
+            // anything else is stored as its text
+            *_formatter << x;
+            write_text_field();
+        }
+    }
+
+    void write_text_field();
+
     std::ostream* _formatter=nullptr;
+    std::string* _binary=nullptr;
 };
 
 
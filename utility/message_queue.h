@@ -14,64 +14,136 @@
 
 #pragma once
 #include "io/asyncevent.h"
-#include <mutex>
-#include <deque>
+#include <atomic>
 #include <assert.h>
 
 namespace beam {
 
 /// Inter-thread message queue, backend for RX and TX sides (see below)
-/// Current impl (may be changed if performance bottleneck detected):
+/// Current impl:
 /// 1) unlimited size - should be controlled by channel sides explicitly;
-/// 2) std::deque and std::mutex inside
+/// 2) lock-free multi-producer single-consumer linked list (D. Vyukov's intrusive MPSC), one node per message;
+/// 3) wakeups are batched: the receiver is signalled only if it has no wakeup pending, so a burst of sends
+///    costs a single event loop wakeup
 /// Message type (class T) requirement: default constructible + callable *or* movable (see send() functions)
 template <class T> class MessageQueue {
 public:
+    MessageQueue() : _head(&_stub), _tail(&_stub) {}
+
+    ~MessageQueue() {
+        T message;
+        while (receive(message)) {}
+    }
+
+    MessageQueue(const MessageQueue&) = delete;
+    MessageQueue& operator=(const MessageQueue&) = delete;
+
     /// Called from sender thread via TX object
     bool send(const T& message) {
-        std::lock_guard<std::mutex> lock(_mutex);
-        if (_rxClosed) return false;
-        _queue.push_back(message);
+        if (_rxClosed.load(std::memory_order_acquire)) return false;
+        push(new Node(message));
         return true;
     }
 
     /// Called from sender thread via TX object
     bool send(T&& message) {
-        std::lock_guard<std::mutex> lock(_mutex);
-        if (_rxClosed) return false;
-        _queue.push_back(std::move(message));
+        if (_rxClosed.load(std::memory_order_acquire)) return false;
+        push(new Node(std::move(message)));
         return true;
     }
 
+    /// Called from sender thread after send(). Returns true if the receiver must be woken up
+    bool need_wakeup() {
+        return !_wakeupPending.exchange(true);
+    }
+
+    /// Called from receiver thread when woken up, before receiving the messages
+    void on_wakeup() {
+        _wakeupPending.store(false);
+    }
+
     /// May be called by both TX and RX
     size_t current_size() {
-        std::lock_guard<std::mutex> lock(_mutex);
-        return _queue.size();
+        return _size.load(std::memory_order_relaxed);
     }
 
     /// Called from receiver thread via RX object
     bool receive(T& message) {
-        std::lock_guard<std::mutex> lock(_mutex);
-        if (_queue.empty()) return false;
-        message = std::move(_queue.front());
-        _queue.pop_front();
+        Node* node = pop();
+        if (!node) return false;
+        message = std::move(node->value);
+        delete node;
+        _size.fetch_sub(1, std::memory_order_relaxed);
         return true;
     }
 
     /// Called by RX to indicate that the channel is being closed
     void close_rx() {
-        std::lock_guard<std::mutex> lock(_mutex);
-        _rxClosed = true;
+        _rxClosed.store(true, std::memory_order_release);
     }
 
 private:
-    std::mutex _mutex;
-    // TODO consider spinlock
+    struct Node {
+        std::atomic<Node*> next{ nullptr };
+        T value;
+
+        Node() = default;
+        explicit Node(const T& v) : value(v) {}
+        explicit Node(T&& v) : value(std::move(v)) {}
+    };
+
+    void push(Node* node) {
+        _size.fetch_add(1, std::memory_order_relaxed);
+        link(node);
+    }
 
-    std::deque<T> _queue;
+    void link(Node* node) {
+        node->next.store(nullptr, std::memory_order_relaxed);
+        Node* prev = _head.exchange(node, std::memory_order_acq_rel);
+        // until this store the list is temporarily broken, the receiver sees it as empty past prev
+        prev->next.store(node, std::memory_order_release);
+    }
+
+    /// Receiver only. Returns nullptr if empty, or if the next message is being pushed right now
+    /// (its sender will signal the receiver once done)
+    Node* pop() {
+        Node* tail = _tail;
+        Node* next = tail->next.load(std::memory_order_acquire);
+
+        if (tail == &_stub) {
+            if (!next) return nullptr;
+            _tail = next;
+            tail = next;
+            next = next->next.load(std::memory_order_acquire);
+        }
 
-    bool _rxClosed=false;
-    // TODO consider atomic flag
+        if (next) {
+            _tail = next;
+            return tail;
+        }
+
+        if (tail != _head.load(std::memory_order_acquire)) return nullptr;
+
+        // the last node can be taken only when the stub is behind it
+        link(&_stub);
+
+        next = tail->next.load(std::memory_order_acquire);
+        if (next) {
+            _tail = next;
+            return tail;
+        }
+        return nullptr;
+    }
+
+    /// Producers side
+    std::atomic<Node*> _head;
+    std::atomic<bool> _wakeupPending{ false };
+    std::atomic<bool> _rxClosed{ false };
+    std::atomic<size_t> _size{ 0 };
+
+    /// Receiver side
+    Node* _tail;
+    Node _stub;
 };
 
 /// Transmitter side of inter-thread channel
@@ -79,15 +151,15 @@ template <class T> class TX {
 public:
 
     bool send(const T& message) {
-        return _queue->send(message) && _asyncEvent();
+        return _queue->send(message) && wakeup();
     }
 
     bool send(T&& message) {
-        return _queue->send(std::move(message)) && _asyncEvent();
+        return _queue->send(std::move(message)) && wakeup();
     }
 
     size_t queue_size() {
-        return _queue.current_size();
+        return _queue->current_size();
     }
 
 private:
@@ -98,6 +170,13 @@ private:
         _queue(queue), _asyncEvent(asyncEvent)
     {}
 
+    bool wakeup() {
+        if (!_queue->need_wakeup()) return true;
+        if (_asyncEvent()) return true;
+        _queue->on_wakeup(); // the receiver is gone, let the next send fail the same way
+        return false;
+    }
+
     /// Queue
     std::shared_ptr<MessageQueue<T>> _queue;
 
@@ -132,7 +211,7 @@ public:
     }
 
     size_t queue_size() {
-        return _queue.current_size();
+        return _queue->current_size();
     }
 
     void close() {
@@ -141,6 +220,9 @@ public:
 
 private:
     void on_receive() {
+        // senders from now on signal again, whatever is already queued is drained below
+        _queue->on_wakeup();
+
         T _msg;
         while (_queue->receive(_msg)) {
             _callback(std::move(_msg));
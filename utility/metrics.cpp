@@ -0,0 +1,303 @@
+// Copyright 2018 The Beam Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "metrics.h"
+#include <chrono>
+#include <stdio.h>
+
+namespace beam::metrics
+{
+    Histogram::Histogram()
+        :m_Count(0)
+        ,m_Total_us(0)
+    {
+        for (uint32_t i = 0; i < s_Buckets; i++)
+            m_pHist[i] = 0;
+    }
+
+    uint32_t Histogram::get_Bucket(uint64_t dt_us)
+    {
+        uint32_t iBucket = 0;
+        for (; (dt_us >>= 1) && (iBucket + 1 < s_Buckets); iBucket++)
+            ;
+        return iBucket;
+    }
+
+    void Histogram::Add(uint64_t dt_us)
+    {
+        m_Count++;
+        m_Total_us += dt_us;
+        m_pHist[get_Bucket(dt_us)]++;
+    }
+
+    uint64_t Histogram::get_Time_us()
+    {
+        return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    /////////////////////////////
+    // Writer
+    void Writer::Type(const char* szName, const char* szType, const char* szHelp)
+    {
+        m_s += "# HELP ";
+        m_s += szName;
+        m_s += ' ';
+        m_s += szHelp;
+        m_s += "\n# TYPE ";
+        m_s += szName;
+        m_s += ' ';
+        m_s += szType;
+        m_s += '\n';
+    }
+
+    void Writer::Name(const char* szName, const char* szSuffix, const char* szLabels, const char* szLabelsExtra)
+    {
+        m_s += szName;
+        if (szSuffix)
+            m_s += szSuffix;
+
+        if (szLabels || szLabelsExtra)
+        {
+            m_s += '{';
+            if (szLabels)
+            {
+                m_s += szLabels;
+                if (szLabelsExtra)
+                    m_s += ',';
+            }
+            if (szLabelsExtra)
+                m_s += szLabelsExtra;
+            m_s += '}';
+        }
+
+        m_s += ' ';
+    }
+
+    void Writer::Value(const char* szName, uint64_t x, const char* szLabels)
+    {
+        Name(szName, nullptr, szLabels, nullptr);
+        m_s += std::to_string(x);
+        m_s += '\n';
+    }
+
+    void Writer::Value(const char* szName, double x, const char* szLabels)
+    {
+        char sz[0x40];
+        snprintf(sz, sizeof(sz), "%.9g", x);
+
+        Name(szName, nullptr, szLabels, nullptr);
+        m_s += sz;
+        m_s += '\n';
+    }
+
+    void Writer::Hist(const char* szName, const std::atomic<uint64_t>* pHist, uint32_t nBuckets, uint64_t nCount, uint64_t nTotal_us, const char* szLabels)
+    {
+        // trailing empty buckets are omitted, +Inf covers them
+        uint32_t nUsed = nBuckets;
+        while (nUsed && !pHist[nUsed - 1])
+            nUsed--;
+
+        uint64_t nCumulative = 0;
+        char sz[0x40];
+
+        for (uint32_t i = 0; i < nUsed; i++)
+        {
+            nCumulative += pHist[i];
+
+            snprintf(sz, sizeof(sz), "le=\"%.9g\"", static_cast<double>(uint64_t(2) << i) * 1e-6);
+            Name(szName, "_bucket", szLabels, sz);
+            m_s += std::to_string(nCumulative);
+            m_s += '\n';
+        }
+
+        // the count is read separately from the buckets, concurrent updates may be in between
+        if (nCount < nCumulative)
+            nCount = nCumulative;
+
+        Name(szName, "_bucket", szLabels, "le=\"+Inf\"");
+        m_s += std::to_string(nCount);
+        m_s += '\n';
+
+        snprintf(sz, sizeof(sz), "%.9g", static_cast<double>(nTotal_us) * 1e-6);
+        Name(szName, "_sum", szLabels, nullptr);
+        m_s += sz;
+        m_s += '\n';
+
+        Name(szName, "_count", szLabels, nullptr);
+        m_s += std::to_string(nCount);
+        m_s += '\n';
+    }
+
+    void Writer::Hist(const char* szName, const Histogram& h, const char* szLabels)
+    {
+        Hist(szName, h.m_pHist, Histogram::s_Buckets, h.m_Count, h.m_Total_us, szLabels);
+    }
+
+    /////////////////////////////
+    // Registry
+    Registry& Registry::get()
+    {
+        static Registry s_Registry;
+        return s_Registry;
+    }
+
+    void Registry::Add(ISource& x)
+    {
+        std::unique_lock<std::mutex> scope(m_Mutex);
+        m_Sources.insert(&x);
+    }
+
+    void Registry::Remove(ISource& x)
+    {
+        std::unique_lock<std::mutex> scope(m_Mutex);
+        m_Sources.erase(&x);
+    }
+
+    void Registry::Collect(std::string& s)
+    {
+        Writer w(s);
+
+        std::unique_lock<std::mutex> scope(m_Mutex);
+        for (ISource* pSrc : m_Sources)
+            pSrc->WriteMetrics(w);
+    }
+
+    /////////////////////////////
+    // LabeledHistograms
+    LabeledHistograms::LabeledHistograms(const char* szName, const char* szHelp, const char* szLabel)
+        :m_szName(szName)
+        ,m_szHelp(szHelp)
+        ,m_szLabel(szLabel)
+    {
+    }
+
+    Histogram& LabeledHistograms::get(const std::string& sLabelValue)
+    {
+        std::unique_lock<std::mutex> scope(m_Mutex);
+
+        auto& pVal = m_Map[sLabelValue];
+        if (!pVal)
+            pVal = std::make_unique<Histogram>();
+
+        return *pVal;
+    }
+
+    void LabeledHistograms::WriteMetrics(Writer& w)
+    {
+        std::unique_lock<std::mutex> scope(m_Mutex);
+        if (m_Map.empty())
+            return;
+
+        w.Type(m_szName, "histogram", m_szHelp);
+
+        std::string sLabels;
+        for (const auto& x : m_Map)
+        {
+            sLabels = m_szLabel;
+            sLabels += "=\"";
+            sLabels += x.first; // the label values are identifiers, no escaping
+            sLabels += '"';
+
+            w.Hist(m_szName, *x.second, sLabels.c_str());
+        }
+    }
+
+    /////////////////////////////
+    // HotScopes
+    std::atomic<bool> HotScopes::s_Enabled(false);
+
+    HotScopes::Entry::Entry(const char* szName)
+        :m_szName(szName)
+        ,m_pNext(nullptr)
+    {
+        HotScopes::get().Add(*this);
+    }
+
+    HotScopes& HotScopes::get()
+    {
+        static HotScopes s_HotScopes;
+        return s_HotScopes;
+    }
+
+    void HotScopes::Add(Entry& e)
+    {
+        std::unique_lock<std::mutex> scope(m_Mutex);
+        e.m_pNext = m_pFirst;
+        m_pFirst = &e;
+    }
+
+    void HotScopes::WriteMetrics(Writer& w)
+    {
+        const char* szName = "beam_scope_seconds";
+        bool bFirst = true;
+
+        std::string sLabels;
+
+        std::unique_lock<std::mutex> scope(m_Mutex);
+        for (const Entry* p = m_pFirst; p; p = p->m_pNext)
+        {
+            if (!p->m_Hist.m_Count)
+                continue;
+
+            if (bFirst)
+            {
+                w.Type(szName, "histogram", "Time spent in the named hot-path scopes");
+                bFirst = false;
+            }
+
+            sLabels = "scope=\"";
+            sLabels += p->m_szName;
+            sLabels += '"';
+
+            w.Hist(szName, p->m_Hist, sLabels.c_str());
+        }
+    }
+
+    void HotScopes::Dump(std::string& s)
+    {
+        char sz[0x100];
+
+        std::unique_lock<std::mutex> scope(m_Mutex);
+        for (const Entry* p = m_pFirst; p; p = p->m_pNext)
+        {
+            const Histogram& h = p->m_Hist;
+
+            uint64_t nCount = h.m_Count;
+            if (!nCount)
+                continue;
+
+            uint64_t nTotal_us = h.m_Total_us;
+
+            // upper bound of the bucket that contains the 99th percentile
+            uint64_t nThreshold = nCount - nCount / 100, nCumulative = 0;
+            uint32_t iBucket = 0;
+            for (; iBucket + 1 < Histogram::s_Buckets; iBucket++)
+            {
+                nCumulative += h.m_pHist[iBucket];
+                if (nCumulative >= nThreshold)
+                    break;
+            }
+
+            snprintf(sz, sizeof(sz), "%s: count=%llu, total_ms=%.3f, avg_us=%.1f, p99_us<%llu\n",
+                p->m_szName,
+                static_cast<unsigned long long>(nCount),
+                static_cast<double>(nTotal_us) * 1e-3,
+                static_cast<double>(nTotal_us) / nCount,
+                static_cast<unsigned long long>(uint64_t(2) << iBucket));
+
+            s += sz;
+        }
+    }
+
+} // namespace beam::metrics
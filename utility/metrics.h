@@ -0,0 +1,182 @@
+// Copyright 2018 The Beam Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <stdint.h>
+
+namespace beam::metrics
+{
+    // Latency histogram, bucket i counts [2^i, 2^(i+1)) microseconds. May be updated from any thread
+    struct Histogram
+    {
+        static const uint32_t s_Buckets = 32;
+
+        std::atomic<uint64_t> m_Count;
+        std::atomic<uint64_t> m_Total_us;
+        std::atomic<uint64_t> m_pHist[s_Buckets];
+
+        Histogram();
+        void Add(uint64_t dt_us);
+
+        static uint32_t get_Bucket(uint64_t dt_us);
+        static uint64_t get_Time_us(); // monotonic
+    };
+
+    // Prometheus text exposition format.
+    // Labels are given without the braces, i.e. `method="tx_send"`, nullptr if none.
+    class Writer
+    {
+        std::string& m_s;
+
+        void Name(const char* szName, const char* szSuffix, const char* szLabels, const char* szLabelsExtra);
+
+    public:
+        explicit Writer(std::string& s) :m_s(s) {}
+
+        // must precede the samples of the metric family
+        void Type(const char* szName, const char* szType, const char* szHelp);
+
+        void Value(const char* szName, uint64_t, const char* szLabels = nullptr);
+        void Value(const char* szName, double, const char* szLabels = nullptr);
+
+        // cumulative buckets, exported in seconds (the Prometheus convention)
+        void Hist(const char* szName, const std::atomic<uint64_t>* pHist, uint32_t nBuckets, uint64_t nCount, uint64_t nTotal_us, const char* szLabels = nullptr);
+        void Hist(const char* szName, const Histogram&, const char* szLabels = nullptr);
+    };
+
+    struct ISource
+    {
+        // invoked on the thread that serves the metrics (normally the reactor thread of the source owner)
+        virtual void WriteMetrics(Writer&) = 0;
+    };
+
+    // The process-wide list of the metric sources, collected on each scrape. A source must be removed before it's destroyed
+    class Registry
+    {
+        std::mutex m_Mutex;
+        std::set<ISource*> m_Sources;
+
+    public:
+        static Registry& get();
+
+        void Add(ISource&);
+        void Remove(ISource&);
+
+        void Collect(std::string&);
+    };
+
+    // Registers the source for its lifetime
+    class Scope
+    {
+        ISource& m_Source;
+    public:
+        explicit Scope(ISource& x) :m_Source(x) { Registry::get().Add(x); }
+        ~Scope() { Registry::get().Remove(m_Source); }
+
+        Scope(const Scope&) = delete;
+        Scope& operator = (const Scope&) = delete;
+    };
+
+    // Histograms of a single family, by the value of a single label (i.e. the request latency per method).
+    // Created on first use, never deleted, hence the label values should come from a bounded set
+    class LabeledHistograms
+        :public ISource
+    {
+        const char* m_szName;
+        const char* m_szHelp;
+        const char* m_szLabel;
+
+        std::mutex m_Mutex;
+        std::map<std::string, std::unique_ptr<Histogram> > m_Map;
+
+    public:
+        LabeledHistograms(const char* szName, const char* szHelp, const char* szLabel);
+
+        Histogram& get(const std::string& sLabelValue);
+
+        void WriteMetrics(Writer&) override;
+    };
+
+    // Named scopes on the hot paths, see BEAM_METRICS_SCOPE.
+    // Disabled by default, then a scope costs a single relaxed load. Once enabled, the time spent in each scope
+    // is aggregated into its histogram, exported as beam_scope_seconds{scope="..."}, and can be dumped as text.
+    // Nested scopes are counted in both.
+    class HotScopes
+        :public ISource
+    {
+    public:
+        static std::atomic<bool> s_Enabled;
+
+        // must have static storage duration, registers itself on construction
+        struct Entry
+        {
+            const char* m_szName;
+            Histogram m_Hist;
+            Entry* m_pNext;
+
+            explicit Entry(const char* szName);
+        };
+
+        static HotScopes& get();
+
+        void WriteMetrics(Writer&) override;
+        void Dump(std::string&); // name, count, total, average and the approximate 99th percentile, for the log
+
+    private:
+        std::mutex m_Mutex;
+        Entry* m_pFirst = nullptr;
+
+        void Add(Entry&);
+    };
+
+    class HotScope
+    {
+        HotScopes::Entry* m_pEntry = nullptr;
+        uint64_t m_t0_us;
+
+    public:
+        explicit HotScope(HotScopes::Entry& e)
+        {
+            if (HotScopes::s_Enabled.load(std::memory_order_relaxed))
+            {
+                m_pEntry = &e;
+                m_t0_us = Histogram::get_Time_us();
+            }
+        }
+
+        ~HotScope()
+        {
+            if (m_pEntry)
+                m_pEntry->m_Hist.Add(Histogram::get_Time_us() - m_t0_us);
+        }
+
+        HotScope(const HotScope&) = delete;
+        HotScope& operator = (const HotScope&) = delete;
+    };
+
+} // namespace beam::metrics
+
+#define BEAM_METRICS_CONCAT_(a, b) a##b
+#define BEAM_METRICS_CONCAT(a, b) BEAM_METRICS_CONCAT_(a, b)
+
+// Measures the rest of the enclosing block. The name must be a string literal, at most one scope per line
+#define BEAM_METRICS_SCOPE(szName) \
+    static beam::metrics::HotScopes::Entry BEAM_METRICS_CONCAT(s_HotScopeEntry_, __LINE__)(szName); \
+    beam::metrics::HotScope BEAM_METRICS_CONCAT(hotScope_, __LINE__)(BEAM_METRICS_CONCAT(s_HotScopeEntry_, __LINE__))
@@ -101,6 +101,9 @@ public:
 
     void swap_buf(std::vector<uint8_t>& v) { _os.m_vec.swap(v); }
 
+    /// Preallocates the buffer (e.g. with the size from SerializerSizeCounter), so that serialization doesn't reallocate
+    void reserve(size_t n) { _os.m_vec.reserve(n); }
+
     void WriteRaw(const void* p, size_t n)
     {
         _oa.write(p, n);
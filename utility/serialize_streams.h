@@ -24,9 +24,9 @@ namespace beam { namespace detail {
 struct SerializeOstream {
     size_t write(const void *ptr, const size_t size) {
         if (size > 0) {
-            size_t n = m_vec.size();
-            m_vec.resize(n + size);
-            memcpy(&m_vec.at(n), ptr, size);
+            // append in place, avoids zero-filling the grown tail before overwriting it
+            const uint8_t* p = static_cast<const uint8_t*>(ptr);
+            m_vec.insert(m_vec.end(), p, p + size);
         }
         return size;
     }
@@ -0,0 +1,129 @@
+// Copyright 2018-2020 The Beam Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "utility/arena.h"
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <cstdint>
+#include <assert.h>
+
+using namespace beam;
+using namespace std;
+
+static int error_count = 0;
+
+#define CHECK(s) \
+do {\
+    assert(s);\
+    if (!(s)) {\
+        ++error_count;\
+    }\
+} while(false)\
+
+namespace {
+
+int g_Alive = 0;
+
+struct Obj
+{
+    BEAM_ARENA_ALLOCATED
+
+    uint64_t m_pData[5];
+    Obj() { g_Alive++; }
+    ~Obj() { g_Alive--; }
+};
+
+struct Big
+{
+    BEAM_ARENA_ALLOCATED
+
+    uint8_t m_pData[0x2000];
+};
+
+bool IsAligned(const void* p)
+{
+    return !(reinterpret_cast<uintptr_t>(p) % alignof(std::max_align_t));
+}
+
+void test_heap()
+{
+    auto p = std::make_unique<Obj>();
+    CHECK(IsAligned(p.get()));
+    CHECK(g_Alive == 1);
+    p.reset();
+    CHECK(g_Alive == 0);
+}
+
+void test_scope()
+{
+    std::vector<std::unique_ptr<Obj> > v;
+    {
+        ObjectArena::Scope scope;
+        for (int i = 0; i < 1000; i++)
+            v.push_back(std::make_unique<Obj>());
+
+        // consecutive objects are packed in the chunk
+        CHECK(reinterpret_cast<uint8_t*>(v[1].get()) > reinterpret_cast<uint8_t*>(v[0].get()));
+        CHECK(reinterpret_cast<uint8_t*>(v[1].get()) - reinterpret_cast<uint8_t*>(v[0].get()) < 0x100);
+
+        auto pBig = std::make_unique<Big>(); // too large for the chunk, goes to the heap
+        CHECK(IsAligned(pBig.get()));
+    }
+
+    // objects outlive the scope
+    for (const auto& p : v)
+    {
+        CHECK(IsAligned(p.get()));
+        p->m_pData[0] = 1;
+    }
+    CHECK(g_Alive == 1000);
+
+    // destroyed on another thread, in arbitrary order
+    std::thread t([&v]()
+    {
+        for (size_t i = 0; i < v.size(); i += 2)
+            v[i].reset();
+        v.clear();
+    });
+    t.join();
+
+    CHECK(g_Alive == 0);
+}
+
+void test_nested()
+{
+    ObjectArena::Scope s1;
+    auto p1 = std::make_unique<Obj>();
+    {
+        ObjectArena::Scope s2(0x10000);
+        auto p2 = std::make_unique<Obj>();
+        CHECK(p2.get() != p1.get());
+    }
+    auto p3 = std::make_unique<Obj>();
+    CHECK(reinterpret_cast<uint8_t*>(p3.get()) > reinterpret_cast<uint8_t*>(p1.get())); // back to s1 chunk
+}
+
+} // namespace
+
+int main()
+{
+    test_heap();
+    test_scope();
+    test_nested();
+    CHECK(g_Alive == 0);
+
+    return error_count ? -1 : 0;
+}
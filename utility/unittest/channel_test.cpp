@@ -14,6 +14,7 @@
 
 #include "utility/message_queue.h"
 #include <future>
+#include <thread>
 #include <iostream>
 #include <assert.h>
 
@@ -88,7 +89,37 @@ void simplex_channel_test() {
     assert(remote.received == sent);
 }
 
+void multiple_senders_test() {
+    RXThread remote;
+    remote.run();
+
+    // per-sender order must be kept, n encodes the sender
+    const int nSenders = 4;
+    const int nMessages = 20000;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < nSenders; ++t) {
+        threads.emplace_back([&remote, t]() {
+            TX<Message> tx = remote.rx.get_tx();
+            for (int i = 1; i <= nMessages; ++i) {
+                tx.send(Message { i * nSenders + t, make_unique<string>(testStr) } );
+            }
+        });
+    }
+    for (auto& t : threads) t.join();
+
+    remote.rx.get_tx().send(Message { 0, make_unique<string>(testStr) } );
+    remote.wait();
+
+    assert(remote.received.size() == size_t(nSenders * nMessages));
+    std::vector<int> last(nSenders, 0);
+    for (int n : remote.received) {
+        assert(n > last[n % nSenders]);
+        last[n % nSenders] = n;
+    }
+}
+
 int main() {
     simplex_channel_test();
+    multiple_senders_test();
 }
 
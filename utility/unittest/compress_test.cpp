@@ -0,0 +1,237 @@
+// Copyright 2018-2020 The Beam Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "utility/compress.h"
+#include <iostream>
+#include <vector>
+#include <string>
+#include <random>
+#include <assert.h>
+
+using namespace beam;
+using namespace std;
+
+static int error_count = 0;
+
+#define CHECK(s) \
+do {\
+    assert(s);\
+    if (!(s)) {\
+        ++error_count;\
+    }\
+} while(false)\
+
+
+void roundtrip(const vector<uint8_t>& src, size_t* pCompressedSize = nullptr) {
+    vector<uint8_t> buf(lz::get_max_compressed_size(src.size()));
+    size_t n = lz::compress(buf.data(), src.data(), src.size());
+    CHECK(n <= buf.size());
+
+    vector<uint8_t> res(src.size());
+    CHECK(lz::decompress(res.data(), res.size(), buf.data(), n));
+    CHECK(res == src);
+
+    if (!src.empty()) {
+        // wrong size must be detected
+        CHECK(!lz::decompress(res.data(), res.size() - 1, buf.data(), n));
+    }
+
+    if (pCompressedSize) {
+        *pCompressedSize = n;
+    }
+}
+
+void test_roundtrip() {
+    std::mt19937 rnd(17);
+
+    roundtrip({});
+    roundtrip({ 1 });
+    roundtrip(vector<uint8_t>(13, 7));
+
+    // random, incompressible
+    vector<uint8_t> v(100000);
+    for (auto& x : v) x = static_cast<uint8_t>(rnd());
+    size_t n = 0;
+    roundtrip(v, &n);
+    CHECK(n <= lz::get_max_compressed_size(v.size()));
+
+    // repetitive, with short and long matches, overlapping ones
+    for (size_t i = 0; i < v.size(); i++) {
+        v[i] = static_cast<uint8_t>((i % 64) ? (i % 300) : rnd());
+    }
+    roundtrip(v, &n);
+    CHECK(n < v.size() / 2);
+
+    v.assign(300000, 0x55);
+    roundtrip(v, &n);
+    CHECK(n < 2000);
+}
+
+void test_malformed() {
+    std::mt19937 rnd(3);
+
+    vector<uint8_t> src(5000);
+    for (size_t i = 0; i < src.size(); i++) src[i] = static_cast<uint8_t>(i % 50);
+
+    vector<uint8_t> buf(lz::get_max_compressed_size(src.size()));
+    size_t n = lz::compress(buf.data(), src.data(), src.size());
+
+    vector<uint8_t> res(src.size());
+    for (int i = 0; i < 1000; i++) {
+        vector<uint8_t> bad(buf.begin(), buf.begin() + n);
+        bad[rnd() % n] = static_cast<uint8_t>(rnd());
+        bad.resize(n - rnd() % 3);
+        lz::decompress(res.data(), res.size(), bad.data(), bad.size()); // must not crash
+    }
+}
+
+// minimal inflate, only what our encoder emits (a single block with the fixed codes)
+bool gunzip(vector<uint8_t>& out, const vector<uint8_t>& src) {
+    if ((src.size() < 18) || (src[0] != 0x1f) || (src[1] != 0x8b) || (src[2] != 8))
+        return false;
+
+    size_t nBit = 10 * 8;
+    const size_t nBitEnd = (src.size() - 8) * 8;
+
+    auto fnBits = [&](uint32_t n, uint32_t& res) {
+        res = 0;
+        for (uint32_t i = 0; i < n; i++, nBit++) {
+            if (nBit >= nBitEnd)
+                return false;
+            res |= ((src[nBit >> 3] >> (nBit & 7)) & 1) << i;
+        }
+        return true;
+    };
+
+    auto fnCode = [&](uint32_t n, uint32_t& res) {
+        res = 0;
+        for (uint32_t i = 0; i < n; i++, nBit++) {
+            if (nBit >= nBitEnd)
+                return false;
+            res = (res << 1) | ((src[nBit >> 3] >> (nBit & 7)) & 1);
+        }
+        return true;
+    };
+
+    static const uint16_t s_pLenBase[] = { 3,4,5,6,7,8,9,10,11,13,15,17,19,23,27,31,35,43,51,59,67,83,99,115,131,163,195,227,258 };
+    static const uint8_t s_pLenExtra[] = { 0,0,0,0,0,0,0,0,1,1,1,1,2,2,2,2,3,3,3,3,4,4,4,4,5,5,5,5,0 };
+    static const uint16_t s_pDistBase[] = { 1,2,3,4,5,7,9,13,17,25,33,49,65,97,129,193,257,385,513,769,1025,1537,2049,3073,4097,6145,8193,12289,16385,24577 };
+    static const uint8_t s_pDistExtra[] = { 0,0,0,0,1,1,2,2,3,3,4,4,5,5,6,6,7,7,8,8,9,9,10,10,11,11,12,12,13,13 };
+
+    uint32_t x;
+    if (!fnBits(3, x) || (x != 3)) // final, fixed
+        return false;
+
+    out.clear();
+    while (true) {
+        uint32_t sym;
+        if (!fnCode(7, x))
+            return false;
+        if (x <= 0x17)
+            sym = 256 + x;
+        else {
+            uint32_t b;
+            if (!fnCode(1, b))
+                return false;
+            x = (x << 1) | b;
+            if ((x >= 0x30) && (x <= 0xbf))
+                sym = x - 0x30;
+            else if ((x >= 0xc0) && (x <= 0xc7))
+                sym = 280 + x - 0xc0;
+            else {
+                if (!fnCode(1, b))
+                    return false;
+                sym = 144 + ((x << 1) | b) - 0x190;
+            }
+        }
+
+        if (sym < 256) {
+            out.push_back(static_cast<uint8_t>(sym));
+            continue;
+        }
+        if (sym == 256)
+            break;
+
+        sym -= 257;
+        if (sym >= sizeof(s_pLenBase) / sizeof(s_pLenBase[0]) || !fnBits(s_pLenExtra[sym], x))
+            return false;
+        size_t len = s_pLenBase[sym] + x;
+
+        if (!fnCode(5, sym) || (sym >= sizeof(s_pDistBase) / sizeof(s_pDistBase[0])) || !fnBits(s_pDistExtra[sym], x))
+            return false;
+        size_t dist = s_pDistBase[sym] + x;
+
+        if (dist > out.size())
+            return false;
+        for (; len; len--)
+            out.push_back(out[out.size() - dist]);
+    }
+
+    const uint8_t* pTail = &src[src.size() - 8];
+    uint32_t crc = pTail[0] | (pTail[1] << 8) | (pTail[2] << 16) | (uint32_t(pTail[3]) << 24);
+    uint32_t n = pTail[4] | (pTail[5] << 8) | (pTail[6] << 16) | (uint32_t(pTail[7]) << 24);
+
+    return (n == out.size()) && (crc == gzip::crc32(out.data(), out.size()));
+}
+
+void gzip_roundtrip(const vector<uint8_t>& src, size_t* pCompressedSize = nullptr) {
+    vector<uint8_t> buf(gzip::get_max_compressed_size(src.size()));
+    size_t n = gzip::compress(buf.data(), src.data(), src.size());
+    CHECK(n <= buf.size());
+    buf.resize(n);
+
+    vector<uint8_t> res;
+    CHECK(gunzip(res, buf));
+    CHECK(res == src);
+
+    if (pCompressedSize) {
+        *pCompressedSize = n;
+    }
+}
+
+void test_gzip() {
+    static const char s_sz[] = "123456789";
+    CHECK(gzip::crc32(reinterpret_cast<const uint8_t*>(s_sz), sizeof(s_sz) - 1) == 0xcbf43926);
+
+    std::mt19937 rnd(5);
+
+    gzip_roundtrip({});
+    gzip_roundtrip({ 1 });
+    gzip_roundtrip(vector<uint8_t>(13, 7));
+
+    vector<uint8_t> v(100000);
+    for (auto& x : v) x = static_cast<uint8_t>(rnd());
+    size_t n = 0;
+    gzip_roundtrip(v, &n);
+
+    // json-like
+    string s;
+    for (uint32_t i = 0; i < 2000; i++) {
+        s += "{\"height\":" + to_string(i * 7) + ",\"hash\":\"" + to_string(rnd()) + "\",\"fee\":0},";
+    }
+    v.assign(s.begin(), s.end());
+    gzip_roundtrip(v, &n);
+    CHECK(n < v.size() / 2);
+
+    v.assign(300000, 0x55);
+    gzip_roundtrip(v, &n);
+    CHECK(n < 5000);
+}
+
+int main() {
+    test_roundtrip();
+    test_malformed();
+    test_gzip();
+    return error_count;
+}
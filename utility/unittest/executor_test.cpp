@@ -0,0 +1,114 @@
+// Copyright 2018 The Beam Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "utility/executor.h"
+#include <atomic>
+#include <iostream>
+
+using namespace beam;
+
+namespace
+{
+	int g_TestsFailed = 0;
+
+	void TestFailed(const char* szExpr, uint32_t nLine)
+	{
+		printf("Test failed! Line=%u, Expression: %s\n", nLine, szExpr);
+		g_TestsFailed++;
+		fflush(stdout);
+	}
+
+#define verify_test(x) \
+	do { \
+		if (!(x)) \
+			TestFailed(#x, __LINE__); \
+	} while (false)
+
+	struct MyExecutor
+		:public ExecutorMT
+	{
+		~MyExecutor() { Stop(); }
+
+		virtual void StartThread(MyThread& t, uint32_t iThread) override
+		{
+			t = MyThread(&MyExecutor::RunThread, this, iThread);
+		}
+
+		void RunThread(uint32_t iThread)
+		{
+			Context ctx;
+			ctx.m_iThread = iThread;
+			RunThreadCtx(ctx);
+		}
+	};
+
+	std::atomic<uint64_t> g_Sum(0);
+
+	struct MyTask
+		:public Executor::TaskAsync
+	{
+		uint32_t m_Val;
+		virtual void Exec(Executor::Context&) override { g_Sum += m_Val; }
+	};
+
+	struct MyCtlTask
+		:public Executor::TaskSync
+	{
+		std::atomic<uint32_t> m_Mask = 0;
+		virtual void Exec(Executor::Context& ctx) override { m_Mask |= 1U << ctx.m_iThread; }
+	};
+
+	void TestExecutor()
+	{
+		const uint32_t nThreads = 4;
+
+		MyExecutor ex;
+		ex.set_Threads(nThreads);
+
+		uint64_t nExpected = 0;
+
+		for (uint32_t iRound = 0; iRound < 500; iRound++)
+		{
+			for (uint32_t i = 0; i < 64; i++)
+			{
+				auto pTask = std::make_unique<MyTask>();
+				pTask->m_Val = i;
+				pTask->m_Priority = (i & 1) ? Executor::Priority::High : Executor::Priority::Low;
+				if (i % 3)
+					pTask->m_iThread = i; // also out-of-range affinity, must be tolerated
+
+				nExpected += i;
+				ex.Push(std::move(pTask));
+			}
+
+			if (iRound & 1)
+				verify_test(ex.Flush(16) <= 16);
+
+			// control task must wait for all the pending tasks, and run exactly once on each thread
+			MyCtlTask t;
+			ex.ExecAll(t);
+
+			verify_test(t.m_Mask == (1U << nThreads) - 1);
+			verify_test(g_Sum == nExpected);
+		}
+
+		verify_test(!ex.Flush(0));
+	}
+}
+
+int main()
+{
+	TestExecutor();
+	return g_TestsFailed ? -1 : 0;
+}
@@ -15,9 +15,22 @@
 #include "utility/logger_checkpoints.h"
 #include "utility/helpers.h"
 #include <thread>
+#include <vector>
+#include <fstream>
+#include <iterator>
 
 using namespace beam;
 
+int g_TestsFailed = 0;
+
+#define verify_test(x) \
+    do { \
+        if (!(x)) { \
+            printf("Test failed! Line=%u, Expression: %s\n", __LINE__, #x); \
+            g_TestsFailed++; \
+        } \
+    } while (false)
+
 struct XXX {
     int z = 333;
 };
@@ -79,12 +92,88 @@ void test_ndc_2(bool exc)
     }
 }
 
+void test_async_logger() {
+    auto logger = Logger::create(BEAM_LOG_LEVEL_WARNING, BEAM_LOG_LEVEL_DEBUG, BEAM_LOG_SINK_DISABLED, "", "", true);
+    logger->set_header_formatter(custom_header_formatter);
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++) {
+        threads.emplace_back([t]() {
+            // more than a ring holds, the producer must wait for the flush thread
+            for (int i = 0; i < 3000; i++) {
+                BEAM_LOG_INFO() << "thread " << t << " message " << i;
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    BEAM_LOG_WARNING() << "async logger done";
+}
+
+int g_Evaluated = 0;
+
+int evaluate() {
+    return ++g_Evaluated;
+}
+
+void test_stripped() {
+    auto logger = Logger::create();
+    BEAM_LOG_STRIPPED() << evaluate();
+    verify_test(!g_Evaluated);
+    BEAM_LOG_INFO() << evaluate();
+    verify_test(g_Evaluated == 1);
+}
+
+void test_binary_logger() {
+    std::string fileName;
+    {
+        auto logger = Logger::create(BEAM_LOG_LEVEL_WARNING, BEAM_LOG_LEVEL_WARNING, BEAM_LOG_LEVEL_DEBUG, "binary_", "", false, true);
+        fileName = logger->get_current_file_name();
+
+        XXX xxx;
+        BEAM_LOG_INFO() << "int=" << -42 << " uint=" << 42U << " double=" << 3.5 << " bool=" << true << " char=" << 'c' << ' ' << xxx;
+        BEAM_LOG_WARNING() << std::string("second");
+    }
+
+    std::ifstream fs(fileName, std::ios::binary);
+    std::string buf((std::istreambuf_iterator<char>(fs)), std::istreambuf_iterator<char>());
+    verify_test(!buf.compare(0, LogBinary::MagicSize, LogBinary::Magic));
+
+    LogBinary::Reader r{ (const uint8_t*) buf.data() + LogBinary::MagicSize, (const uint8_t*) buf.data() + buf.size() };
+    std::vector<std::string> texts;
+    while (r.p != r.end) {
+        uint64_t size, timestamp, thread;
+        verify_test(r.get_varint(size) && (size <= uint64_t(r.end - r.p)));
+
+        LogBinary::Reader rec{ r.p, r.p + size };
+        r.p += size;
+
+        verify_test(rec.get_varint(timestamp) && rec.get_varint(thread));
+        rec.p++; // level
+
+        verify_test(LogBinary::decode_fields((const char*) rec.p, rec.end - rec.p, texts.emplace_back()));
+    }
+
+    verify_test(texts.size() == 2);
+    verify_test(texts.size() == 2 && texts[0] == "int=-42 uint=42 double=3.5 bool=1 char=c XXX={333}");
+    verify_test(texts.size() == 2 && texts[1] == "second");
+
+    remove(fileName.c_str());
+}
+
 int main() {
     test_logger_1();
+    test_async_logger();
+    test_stripped();
+    test_binary_logger();
     test_ndc_1();
     test_ndc_2(false);
     try {
         test_ndc_2(true);
     }
     catch(...) {}
+
+    return g_TestsFailed ? -1 : 0;
 }
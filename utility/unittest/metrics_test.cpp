@@ -0,0 +1,148 @@
+// Copyright 2018-2020 The Beam Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "utility/metrics.h"
+#include <iostream>
+#include <assert.h>
+
+using namespace beam;
+using namespace std;
+
+static int error_count = 0;
+
+#define CHECK(s) \
+do {\
+    assert(s);\
+    if (!(s)) {\
+        ++error_count;\
+    }\
+} while(false)\
+
+namespace {
+
+bool Contains(const std::string& s, const char* sz)
+{
+    return s.find(sz) != std::string::npos;
+}
+
+void test_buckets()
+{
+    CHECK(metrics::Histogram::get_Bucket(0) == 0);
+    CHECK(metrics::Histogram::get_Bucket(1) == 0);
+    CHECK(metrics::Histogram::get_Bucket(2) == 1);
+    CHECK(metrics::Histogram::get_Bucket(3) == 1);
+    CHECK(metrics::Histogram::get_Bucket(1000) == 9);
+    CHECK(metrics::Histogram::get_Bucket(uint64_t(-1)) == metrics::Histogram::s_Buckets - 1);
+}
+
+void test_writer()
+{
+    std::string s;
+    metrics::Writer w(s);
+
+    w.Type("beam_test_total", "counter", "Test counter");
+    w.Value("beam_test_total", uint64_t(5));
+    w.Value("beam_test_total", uint64_t(7), "kind=\"a\"");
+
+    CHECK(Contains(s, "# HELP beam_test_total Test counter\n# TYPE beam_test_total counter\n"));
+    CHECK(Contains(s, "\nbeam_test_total 5\n"));
+    CHECK(Contains(s, "\nbeam_test_total{kind=\"a\"} 7\n"));
+
+    s.clear();
+
+    metrics::Histogram h;
+    h.Add(1); // bucket 0
+    h.Add(3); // bucket 1
+    h.Add(3);
+
+    w.Hist("beam_test_seconds", h, "m=\"x\"");
+
+    CHECK(Contains(s, "beam_test_seconds_bucket{m=\"x\",le=\"2e-06\"} 1\n"));
+    CHECK(Contains(s, "beam_test_seconds_bucket{m=\"x\",le=\"4e-06\"} 3\n"));
+    CHECK(Contains(s, "beam_test_seconds_bucket{m=\"x\",le=\"+Inf\"} 3\n"));
+    CHECK(Contains(s, "beam_test_seconds_sum{m=\"x\"} 7e-06\n"));
+    CHECK(Contains(s, "beam_test_seconds_count{m=\"x\"} 3\n"));
+    CHECK(!Contains(s, "le=\"8e-06\"")); // trailing empty buckets are omitted
+}
+
+void test_registry()
+{
+    metrics::LabeledHistograms lh("beam_test_latency_seconds", "Test latency", "method");
+
+    std::string s;
+    metrics::Registry::get().Collect(s);
+    CHECK(!Contains(s, "beam_test_latency_seconds"));
+
+    {
+        metrics::Scope scope(lh);
+
+        metrics::Registry::get().Collect(s);
+        CHECK(!Contains(s, "beam_test_latency_seconds")); // nothing recorded yet
+
+        lh.get("tx_send").Add(10);
+        lh.get("tx_send").Add(20);
+        lh.get("get_utxo").Add(10);
+
+        metrics::Registry::get().Collect(s);
+        CHECK(Contains(s, "# TYPE beam_test_latency_seconds histogram\n"));
+        CHECK(Contains(s, "beam_test_latency_seconds_count{method=\"tx_send\"} 2\n"));
+        CHECK(Contains(s, "beam_test_latency_seconds_count{method=\"get_utxo\"} 1\n"));
+    }
+
+    s.clear();
+    metrics::Registry::get().Collect(s);
+    CHECK(s.empty());
+}
+
+void RunHotScope()
+{
+    BEAM_METRICS_SCOPE("Test.Scope");
+}
+
+void test_hot_scopes()
+{
+    RunHotScope(); // disabled by default
+
+    std::string s;
+    metrics::Writer w(s);
+    metrics::HotScopes::get().WriteMetrics(w);
+    CHECK(!Contains(s, "Test.Scope"));
+
+    metrics::HotScopes::s_Enabled = true;
+    RunHotScope();
+    RunHotScope();
+    metrics::HotScopes::s_Enabled = false;
+    RunHotScope();
+
+    s.clear();
+    metrics::HotScopes::get().WriteMetrics(w);
+    CHECK(Contains(s, "# TYPE beam_scope_seconds histogram\n"));
+    CHECK(Contains(s, "beam_scope_seconds_count{scope=\"Test.Scope\"} 2\n"));
+
+    s.clear();
+    metrics::HotScopes::get().Dump(s);
+    CHECK(Contains(s, "Test.Scope: count=2,"));
+}
+
+} // namespace
+
+int main()
+{
+    test_buckets();
+    test_writer();
+    test_registry();
+    test_hot_scopes();
+
+    return error_count ? -1 : 0;
+}
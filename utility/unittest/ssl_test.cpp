@@ -122,6 +122,55 @@ namespace {
         BEAM_LOG_INFO() << TRACE(nErrors);
         return nErrors;
     }
+
+    int test_session_resumption() {
+        BEAM_LOG_INFO() << "Testing SSL session resumption";
+
+        int nErrors = 0;
+        const std::string certPath = PROJECT_SOURCE_DIR "/utility/unittest/beam_server";
+
+        SSLContext::Ptr serverCtx = SSLContext::create_server_ctx((certPath + ".crt").c_str(), (certPath + ".key").c_str(), false, false);
+        SSLContext::Ptr clientCtx = SSLContext::create_client_context(nullptr, nullptr, false);
+
+        for (int i = 0; i < 3; ++i) {
+            std::unique_ptr<SSLIO> server;
+            std::unique_ptr<SSLIO> client;
+            bool received = false;
+
+            auto on_decrypted = [&received](void*, size_t) -> bool {
+                received = true;
+                return true;
+            };
+
+            auto on_encrypted_server = [&client](const io::SharedBuffer& data, bool) -> Result {
+                return client->on_encrypted_data_from_stream(data.data, data.size);
+            };
+
+            auto on_encrypted_client = [&server](const io::SharedBuffer& data, bool) -> Result {
+                return server->on_encrypted_data_from_stream(data.data, data.size);
+            };
+
+            server = std::make_unique<SSLIO>(serverCtx, on_decrypted, on_encrypted_server);
+            client = std::make_unique<SSLIO>(clientCtx, on_decrypted, on_encrypted_client);
+            client->set_host_name("beam.test");
+
+            static const char msg[] = "ping";
+            client->enqueue(SharedBuffer(msg, sizeof(msg)));
+            client->flush();
+            server->enqueue(SharedBuffer(msg, sizeof(msg))); // delivers the session tickets, if not yet
+            server->flush();
+
+            bool resumed = SSL_session_reused(client->native_handle()) != 0;
+            BEAM_LOG_INFO() << TRACE(i) << TRACE(received) << TRACE(resumed);
+
+            // the 1st connection does the full handshake, subsequent ones must resume
+            if (!received || (resumed != (i > 0))) {
+                ++nErrors;
+            }
+        }
+
+        return nErrors;
+    }
 }
 #define CHECK_TRUE(s) {\
     auto r = (s);\
@@ -162,6 +211,8 @@ int main() {
         CHECK_FALSE(test_sslio(true, true, serverCert));
         CHECK_FALSE(test_sslio(true, true, serverCert, selfSignedCert));
         CHECK_TRUE(test_sslio(true, true, serverCert, clientCert));
+
+        CHECK_TRUE(test_session_resumption());
     } catch (const exception& e) {
         BEAM_LOG_ERROR() << e.what();
         retCode = 255;
@@ -78,6 +78,24 @@ void tcpserver_test() {
     }
 }
 
+bool reusePortOk = true;
+
+void tcpserver_reuseport_test() {
+#ifdef __linux__
+    // 2 listeners on the same address, as for several reactors (threads) serving the same port
+    try {
+        Reactor::Ptr r = Reactor::create();
+        auto cb = [](TcpStream::Ptr&&, int) {};
+        TcpServer::Ptr s1 = TcpServer::create(*r, Address(serverIp, serverPort + 1), cb, true);
+        TcpServer::Ptr s2 = TcpServer::create(*r, Address(serverIp, serverPort + 1), cb, true);
+    }
+    catch (const std::exception& e) {
+        BEAM_LOG_ERROR() << e.what();
+        reusePortOk = false;
+    }
+#endif // __linux__
+}
+
 int main() {
     int logLevel = BEAM_LOG_LEVEL_DEBUG;
 #if LOG_VERBOSE_ENABLED
@@ -85,7 +103,8 @@ int main() {
 #endif
     auto logger = Logger::create(logLevel, logLevel);
     tcpserver_test();
-    return wasAccepted ? 0 : 1;
+    tcpserver_reuseport_test();
+    return (wasAccepted && reusePortOk) ? 0 : 1;
 }
 
 
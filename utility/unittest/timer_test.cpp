@@ -14,6 +14,7 @@
 
 #include "utility/io/coarsetimer.h"
 #include <set>
+#include <cstdlib>
 
 #ifndef LOG_VERBOSE_ENABLED
     #define LOG_VERBOSE_ENABLED 1
@@ -99,6 +100,31 @@ void coarsetimer_test() {
     BEAM_LOG_DEBUG() << "Stopping";
 }
 
+void multiple_timers_test() {
+    reactor = Reactor::create();
+    MultipleTimers timers(*reactor, 10);
+
+    // lots of timers across several wheel levels, half of them cancelled
+    const unsigned N = 10000;
+    unsigned fired = 0;
+    for (unsigned i = 0; i < N; ++i) {
+        timers.set_timer(i, (i * 7919) % 900, [&fired] { ++fired; });
+    }
+    for (unsigned i = 0; i < N; i += 2) {
+        timers.cancel(i);
+    }
+
+    timers.set_timer(N, 1000, [] { reactor->stop(); });
+
+    reactor->run();
+
+    BEAM_LOG_DEBUG() << "fired " << fired;
+    if (fired != N / 2) {
+        BEAM_LOG_ERROR() << "expected " << N / 2;
+        exit(1);
+    }
+}
+
 int main() {
     int logLevel = BEAM_LOG_LEVEL_DEBUG;
 #if LOG_VERBOSE_ENABLED
@@ -107,5 +133,6 @@ int main() {
     auto logger = Logger::create(logLevel, logLevel);
     timer_test();
     coarsetimer_test();
+    multiple_timers_test();
 }
 
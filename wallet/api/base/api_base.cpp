@@ -14,11 +14,92 @@
 #include "api_errors_imp.h"
 #include "api_base.h"
 #include "utility/logger.h"
+#include "utility/metrics.h"
+#include "utility/thread.h"
+#include <condition_variable>
+#include <deque>
 
 namespace beam::wallet
 {
     namespace
     {
+#ifndef __EMSCRIPTEN__
+        // Shared by all the api instances of the process
+        class ResponseWorker
+        {
+        public:
+            using Task = std::function<void ()>;
+
+            static ResponseWorker& get()
+            {
+                static ResponseWorker s_Worker;
+                return s_Worker;
+            }
+
+            void Push(Task&& task)
+            {
+                std::unique_lock<std::mutex> scope(m_Mutex);
+                m_Tasks.push_back(std::move(task));
+                m_NewTask.notify_one();
+            }
+
+        private:
+            ResponseWorker()
+            {
+                uint32_t nThreads = std::min(std::max(MyThread::hardware_concurrency() / 2, 1U), 4U);
+                m_vThreads.resize(nThreads);
+                for (auto& t : m_vThreads)
+                {
+                    t = MyThread(&ResponseWorker::Thread, this, Rules::get());
+                }
+            }
+
+            ~ResponseWorker()
+            {
+                {
+                    std::unique_lock<std::mutex> scope(m_Mutex);
+                    m_Run = false;
+                    m_NewTask.notify_all();
+                }
+
+                for (auto& t : m_vThreads)
+                {
+                    if (t.joinable())
+                    {
+                        t.join();
+                    }
+                }
+            }
+
+            void Thread(const Rules& r)
+            {
+                Rules::Scope scopeRules(r);
+
+                while (true)
+                {
+                    Task task;
+                    {
+                        std::unique_lock<std::mutex> scope(m_Mutex);
+                        m_NewTask.wait(scope, [this] { return !m_Run || !m_Tasks.empty(); });
+                        if (!m_Run)
+                            return;
+
+                        task = std::move(m_Tasks.front());
+                        m_Tasks.pop_front();
+                    }
+
+                    task();
+                }
+            }
+
+            std::vector<MyThread> m_vThreads;
+            std::mutex m_Mutex;
+            std::condition_variable m_NewTask;
+            std::deque<Task> m_Tasks;
+            bool m_Run = true;
+        };
+#endif // __EMSCRIPTEN__
+
         std::string CompactifyAddress(const std::string& str, size_t s)
         {
             const static std::string_view ellipsis = "...";
@@ -112,21 +193,119 @@ namespace beam::wallet
     void ApiBase::sendError(const JsonRpcId& id, ApiError code, const std::string& data)
     {
         const auto error = formError(id, code, data);
-        _handler.sendAPIResponse(error);
+        sendResponse(error);
     }
 
-    boost::optional<IWalletApi::ApiCallInfo> ApiBase::parseCallInfo(const char* data, size_t size)
+    void ApiBase::sendResponse(const json& msg)
+    {
+        if (_pBatch)
+            _pBatch->push_back(msg);
+        else
+            _handler.sendAPIResponse(msg);
+    }
+
+    void ApiBase::offloadResponse(const JsonRpcId& id, ResultFiller&& fill)
+    {
+        auto build = [id, fill = std::move(fill)]() -> json
+        {
+            json msg = json
+            {
+                {JsonRpcHeader, JsonRpcVersion},
+                {"id", id},
+                {"result", json::array()}
+            };
+
+            try
+            {
+                fill(msg["result"]);
+            }
+            catch (const std::exception& e)
+            {
+                msg = formError(id, ApiError::InternalErrorJsonRpc, e.what());
+            }
+            return msg;
+        };
+
+#ifndef __EMSCRIPTEN__
+        if (!_pBatch)
+        {
+            if (!_offloadedEvt)
+            {
+                _offloaded = std::make_shared<OffloadedResponses>();
+                _offloadedEvt = io::AsyncEvent::create(io::Reactor::get_Current(), [this]() { onOffloadedReady(); });
+                _offloaded->m_Trigger = _offloadedEvt;
+            }
+
+            ResponseWorker::get().Push([build = std::move(build), pOut = _offloaded]()
+            {
+                json msg = build();
+
+                std::unique_lock<std::mutex> scope(pOut->m_Mutex);
+                pOut->m_vReady.push_back(std::move(msg));
+                pOut->m_Trigger();
+            });
+
+            _callOffloaded = true;
+            return;
+        }
+#endif // __EMSCRIPTEN__
+
+        sendResponse(build());
+    }
+
+    void ApiBase::onOffloadedReady()
+    {
+        std::vector<json> vReady;
+        {
+            std::unique_lock<std::mutex> scope(_offloaded->m_Mutex);
+            vReady.swap(_offloaded->m_vReady);
+        }
+
+        for (const auto& msg : vReady)
+        {
+            _handler.sendAPIResponse(msg);
+        }
+    }
+
+    void ApiBase::sendParseError(const json& msg)
+    {
+        if (_pBatch)
+            _pBatch->push_back(msg);
+        else
+            _handler.onParseError(msg);
+    }
+
+    boost::optional<json> ApiBase::parseMessage(const char* data, size_t size)
     {
         JsonRpcId rpcid;
-        return callGuarded<ApiCallInfo>(rpcid, [this, &rpcid, data, size] () {
+        return callGuarded<json>(rpcid, [data, size] () {
             if (size == 0)
             {
                 throw jsonrpc_exception(ApiError::InvalidJsonRpc, "Empty JSON request");
             }
 
+            return json::parse(data, data + size);
+        });
+    }
+
+    boost::optional<IWalletApi::ApiCallInfo> ApiBase::parseCallInfo(const char* data, size_t size)
+    {
+        auto message = parseMessage(data, size);
+        if (message == boost::none)
+        {
+            return boost::none;
+        }
+
+        return parseCallInfo(std::move(*message));
+    }
+
+    boost::optional<IWalletApi::ApiCallInfo> ApiBase::parseCallInfo(json&& message)
+    {
+        JsonRpcId rpcid;
+        return callGuarded<ApiCallInfo>(rpcid, [this, &rpcid, &message] () {
             ApiCallInfo info;
 
-            info.message = json::parse(data, data + size); // do not make const pls, it would throw if no field present
+            info.message = std::move(message); // do not make const pls, it would throw if no field present
             if(!info.message["id"].is_number_integer() && !info.message["id"].is_string())
             {
                 throw jsonrpc_exception(ApiError::InvalidJsonRpc, "ID can be integer or string only.");
@@ -174,21 +353,81 @@ namespace beam::wallet
 
     ApiSyncMode ApiBase::executeAPIRequest(const char* data, size_t size)
     {
-        auto pinfo = parseCallInfo(data, size);
+        auto message = parseMessage(data, size);
+        if (message == boost::none)
+        {
+            BEAM_LOG_WARNING() << "executeAPIRequest, failed to parse " << std::string_view(data, size);
+            return ApiSyncMode::DoneSync;
+        }
+
+        if (!message->is_array())
+        {
+            return executeCall(std::move(*message));
+        }
+
+        // JSON-RPC 2.0 batch. The calls are executed in order, the responses available synchronously are sent back as a single array.
+        // Async responses are sent as usual, when ready
+        if (message->empty())
+        {
+            sendParseError(formError(JsonRpcId(), ApiError::InvalidJsonRpc, "Empty batch"));
+            return ApiSyncMode::DoneSync;
+        }
+
+        json batch = json::array();
+        ApiSyncMode res = ApiSyncMode::DoneSync;
+
+        assert(!_pBatch);
+        _pBatch = &batch;
+
+        for (auto& call : *message)
+        {
+            if (ApiSyncMode::RunningAsync == executeCall(std::move(call)))
+            {
+                res = ApiSyncMode::RunningAsync;
+            }
+        }
+
+        _pBatch = nullptr;
+
+        if (!batch.empty())
+        {
+            _handler.sendAPIResponse(batch);
+        }
+
+        return res;
+    }
+
+    namespace
+    {
+        metrics::LabeledHistograms& getRequestMetrics()
+        {
+            // the method is validated by parseCallInfo, the label values are bounded by the API
+            static metrics::LabeledHistograms s_Hist("beam_api_request_seconds", "API request latency, synchronous part", "method");
+            static metrics::Scope s_Scope(s_Hist);
+            return s_Hist;
+        }
+    }
+
+    ApiSyncMode ApiBase::executeCall(json&& message)
+    {
+        auto pinfo = parseCallInfo(std::move(message));
         if (pinfo == boost::none)
         {
-            BEAM_LOG_WARNING() << "executeAPIRequest, parseCallInfo returned none for " << std::string_view(data, size);
+            BEAM_LOG_WARNING() << "executeAPIRequest, parseCallInfo returned none";
             return ApiSyncMode::DoneSync;
         }
 
+        if (Logger::will_log(BEAM_LOG_LEVEL_VERBOSE))
         {
             json messageCopy = pinfo->message;
             FilterRequest(messageCopy);
 
-            const auto message = messageCopy.dump(1, '\t');
-            BEAM_LOG_VERBOSE() << "executeAPIRequest:\n" << message;
+            const auto messageText = messageCopy.dump(1, '\t');
+            BEAM_LOG_VERBOSE() << "executeAPIRequest:\n" << messageText;
         }
 
+        const auto t0_us = metrics::Histogram::get_Time_us();
+
         const auto result = callGuarded<ApiSyncMode>(pinfo->rpcid, [this, &pinfo] () -> ApiSyncMode {
             const auto& minfo = _methods[pinfo->method];
 
@@ -206,10 +445,13 @@ namespace beam::wallet
                 }
             }
 
+            _callOffloaded = false;
             minfo.execFunc(pinfo->rpcid, pinfo->params);
-            return minfo.isAsync ? ApiSyncMode::RunningAsync : ApiSyncMode::DoneSync;
+            return (minfo.isAsync || _callOffloaded) ? ApiSyncMode::RunningAsync : ApiSyncMode::DoneSync;
         });
 
+        getRequestMetrics().get(pinfo->method).Add(metrics::Histogram::get_Time_us() - t0_us);
+
         return result ? *result : ApiSyncMode::DoneSync;
     }
 
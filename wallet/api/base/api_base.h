@@ -16,8 +16,10 @@
 #include "api_errors_imp.h"
 #include "wallet/core/common.h"
 #include "utility/common.h"
+#include "utility/io/asyncevent.h"
 #include "../i_wallet_api.h"
 #include "parse_utils.h"
+#include <mutex>
 
 namespace beam::wallet
 {
@@ -36,7 +38,7 @@ namespace beam::wallet
             getResponse(id, response, msg); \
             BEAM_LOG_VERBOSE() << "Api call result for id " << id; \
             BEAM_LOG_VERBOSE() << "\tresponse: " << std::string_view(msg.dump()).substr(0, 200); \
-            _handler.sendAPIResponse(msg); \
+            sendResponse(msg); \
         }
 
     #define BEAM_API_HANDLE_FUNC(api, name, ...) \
@@ -158,12 +160,28 @@ namespace beam::wallet
             _methods[name] = std::move(method);
         }
 
+        // Big list responses: the "result" array is filled on the response worker thread,
+        // the reactor thread only sends the ready json. The call turns async then.
+        // The filler must not touch the wallet, db & the api object.
+        // Inside a batch the response is built synchronously.
+        static constexpr size_t kOffloadMinItems = 256;
+        using ResultFiller = std::function<void (json& result)>;
+        void offloadResponse(const JsonRpcId& id, ResultFiller&& fill);
+
+        // responses to the calls go through here, to be collected if the call is a part of a batch
+        void sendResponse(const json& msg);
+        void sendParseError(const json& msg);
+
         IWalletApi::WeakPtr _weakSelf;
         IWalletApiHandler& _handler;
 
     private:
         static json formError(const JsonRpcId& id, ApiError code, const std::string& data = "");
+        boost::optional<json> parseMessage(const char* data, size_t size);
         boost::optional<ApiCallInfo> parseCallInfo(const char* data, size_t size);
+        boost::optional<ApiCallInfo> parseCallInfo(json&& message);
+        ApiSyncMode executeCall(json&& message);
+        void onOffloadedReady();
 
         template<typename TRes>
         boost::optional<TRes> callGuarded(const JsonRpcId& rpcid, std::function<TRes (void)> func)
@@ -175,12 +193,12 @@ namespace beam::wallet
             catch (const nlohmann::detail::type_error& e)
             {
                 auto error = formError(rpcid, ApiError::InvalidParamsJsonRpc, e.what());
-                _handler.onParseError(error);
+                sendParseError(error);
             }
             catch (const nlohmann::detail::exception& e)
             {
                 auto error = formError(rpcid, ApiError::InvalidJsonRpc, e.what());
-                _handler.onParseError(error);
+                sendParseError(error);
             }
             catch (const jsonrpc_exception& e)
             {
@@ -189,26 +207,26 @@ namespace beam::wallet
                 {
                 case ApiError::InvalidJsonRpc:
                 case ApiError::InvalidParamsJsonRpc:
-                    _handler.onParseError(error);
+                    sendParseError(error);
                     break;
                 default:
-                    _handler.sendAPIResponse(error);
+                    sendResponse(error);
                 }
             }
             catch (const std::runtime_error& e)
             {
                 auto error = formError(rpcid, ApiError::InternalErrorJsonRpc, e.what());
-                _handler.sendAPIResponse(error);
+                sendResponse(error);
             }
             catch (const std::exception& e)
             {
                 auto error = formError(rpcid, ApiError::InternalErrorJsonRpc, e.what());
-                _handler.sendAPIResponse(error);
+                sendResponse(error);
             }
             catch (...)
             {
                 auto error = formError(rpcid, ApiError::InternalErrorJsonRpc, "API call failed, please take a look at logs");
-                _handler.sendAPIResponse(error);
+                sendResponse(error);
             }
 
             return boost::none;
@@ -219,6 +237,19 @@ namespace beam::wallet
         std::string _appId;
         std::string _appName;
         std::unordered_map <std::string, Method> _methods;
+        json* _pBatch = nullptr; // collects the synchronous responses of a batch call
+        bool _callOffloaded = false;
+
+        struct OffloadedResponses
+        {
+            std::mutex m_Mutex;
+            std::vector<json> m_vReady;
+            io::AsyncEvent::Trigger m_Trigger;
+        };
+
+        // shared with the worker, the api may be gone before the response is built
+        std::shared_ptr<OffloadedResponses> _offloaded;
+        io::AsyncEvent::Ptr _offloadedEvt;
     };
 
     // boost::optional<json> is not defined intentionally, use const json& instead
@@ -33,6 +33,7 @@
 #include "utility/log_rotation.h"
 #include "http/http_connection.h"
 #include "http/http_msg_creator.h"
+#include "http/metrics_server.h"
 #include "p2p/line_protocol.h"
 #include "wallet/core/wallet_db.h"
 #include "wallet/core/wallet_network.h"
@@ -658,6 +659,8 @@ int main(int argc, char* argv[])
         uint32_t logCleanupPeriod;
         bool enableLelantus = false;
         bool enableBodyRequests = false;
+        std::string extraWallets;
+        uint16_t metricsPort;
     } options;
     ConnectionOptions connectionOptions;
 
@@ -683,6 +686,8 @@ int main(int argc, char* argv[])
             (cli::LOG_CLEANUP_DAYS, po::value<uint32_t>()->default_value(5), "old logfiles cleanup period(days)")
             (cli::API_TCP_MAX_LINE, po::value<size_t>(&connectionOptions.maxLineSize)->default_value(65536), "max line size in TCP mode")
             (cli::REQUEST_BODIES,   po::value<bool>(&options.enableBodyRequests)->default_value(false), "request and parse block bodies on the wallet side")
+            (cli::API_EXTRA_WALLETS, po::value<std::string>(&options.extraWallets)->default_value(""), "comma-separated list of additional wallet files to serve from this process, N-th wallet listens on port + N")
+            (cli::METRICS_PORT,     po::value(&options.metricsPort)->default_value(0), "port to serve the metrics on (GET /metrics, Prometheus text format). 0 = disabled")
         ;
 
         po::options_description authDesc("User authorization options");
@@ -761,6 +766,7 @@ int main(int argc, char* argv[])
 
         io::Address node_addr;
         IWalletDB::Ptr walletDB;
+        std::vector<IWalletDB::Ptr> extraWalletDBs;
         ApiACL acl;
         std::vector<uint32_t> whitelist;
 
@@ -850,6 +856,29 @@ int main(int argc, char* argv[])
             walletDB = WalletDB::open(options.walletPath, pass);
             BEAM_LOG_INFO() << "wallet successfully opened...";
 
+            if (!options.extraWallets.empty())
+            {
+                const auto& paths = string_helpers::split(options.extraWallets, ',');
+                if (paths.size() >= std::numeric_limits<uint16_t>::max() - options.port)
+                {
+                    BEAM_LOG_ERROR() << "too many extra wallets for the port " << options.port;
+                    return -1;
+                }
+
+                for (const auto& path : paths)
+                {
+                    if (!WalletDB::isInitialized(path))
+                    {
+                        BEAM_LOG_ERROR() << "Wallet not found, path is: " << path;
+                        return -1;
+                    }
+
+                    // all hosted wallets share the password of the main one
+                    extraWalletDBs.push_back(WalletDB::open(path, pass));
+                    BEAM_LOG_INFO() << "wallet " << path << " successfully opened...";
+                }
+            }
+
             // this should be exactly CLI flag value to print correct error messages
             // Rules::CA.Enabled would be checked as well but later
             wallet::g_AssetsEnabled = vm[cli::WITH_ASSETS].as<bool>();
@@ -862,41 +891,83 @@ int main(int argc, char* argv[])
         io::Reactor::GracefulIntHandler gih(*reactor);
 
         LogRotation logRotation(*reactor, LOG_ROTATION_PERIOD, options.logCleanupPeriod);
-        auto wallet = std::make_shared<Wallet>(walletDB);
-        wallet->EnableBodyRequests(options.enableBodyRequests);
-
-        auto nnet = std::make_shared<NodeNetwork>(*wallet);
-        nnet->m_Cfg.m_PollPeriod_ms = options.pollPeriod_ms.value;
-        
-        if (nnet->m_Cfg.m_PollPeriod_ms)
+        if (options.pollPeriod_ms.value)
         {
-            BEAM_LOG_INFO() << "Node poll period = " << nnet->m_Cfg.m_PollPeriod_ms << " ms";
-            uint32_t timeout_ms = std::max(Rules::get().DA.Target_s * 1000, nnet->m_Cfg.m_PollPeriod_ms);
-            if (timeout_ms != nnet->m_Cfg.m_PollPeriod_ms)
+            BEAM_LOG_INFO() << "Node poll period = " << options.pollPeriod_ms.value << " ms";
+            uint32_t timeout_ms = std::max(Rules::get().DA.Target_s * 1000, options.pollPeriod_ms.value);
+            if (timeout_ms != options.pollPeriod_ms.value)
             {
                 BEAM_LOG_INFO() << "Node poll period has been automatically rounded up to block rate: " << timeout_ms << " ms";
             }
         }
 
         uint32_t responseTime_s = Rules::get().DA.Target_s * wallet::kDefaultTxResponseTime;
-        if (nnet->m_Cfg.m_PollPeriod_ms >= responseTime_s * 1000)
+        if (options.pollPeriod_ms.value >= responseTime_s * 1000)
         {
             BEAM_LOG_WARNING() << "The \"--node_poll_period\" parameter set to more than "
                           << uint32_t(responseTime_s / 3600)
                           << " hours may cause transaction problems.";
         }
 
-        if (vm.count(cli::MINE_ONLINE))
-            nnet->m_Cfg.m_PreferOnlineMining = vm[cli::MINE_ONLINE].as<bool>();
+        // Every hosted wallet keeps its own node connection (the node session is bound to the owner key),
+        // while the reactor, the thread, the logger and the server settings are shared.
+        // So are the block headers: the wallets follow the same node.
+        SharedHistory::Ptr sharedHistory;
+        if (!extraWalletDBs.empty())
+        {
+            sharedHistory = std::make_shared<SharedHistory>();
+        }
+
+        struct HostedWallet
+        {
+            IWalletDB::Ptr walletDB;
+            Wallet::Ptr wallet;
+            std::shared_ptr<NodeNetwork> nnet;
+            std::shared_ptr<WalletNetworkViaBbs> wnet;
+            std::unique_ptr<WalletApiServer> server;
+        };
+
+        auto hostWallet = [&](IWalletDB::Ptr db, io::Address addr)
+        {
+            HostedWallet hw;
+            hw.walletDB = db;
+            hw.walletDB->setSharedHistory(sharedHistory);
+            hw.wallet = std::make_shared<Wallet>(db);
+            hw.wallet->EnableBodyRequests(options.enableBodyRequests);
+
+            hw.nnet = std::make_shared<NodeNetwork>(*hw.wallet);
+            hw.nnet->m_Cfg.m_PollPeriod_ms = options.pollPeriod_ms.value;
 
-        nnet->m_Cfg.m_vNodes.push_back(node_addr);
-        nnet->Connect();
+            if (vm.count(cli::MINE_ONLINE))
+                hw.nnet->m_Cfg.m_PreferOnlineMining = vm[cli::MINE_ONLINE].as<bool>();
 
-        auto wnet = std::make_shared<WalletNetworkViaBbs>(*wallet, nnet, walletDB);
-        wallet->AddMessageEndpoint(wnet);
-        wallet->SetNodeEndpoint(nnet);
+            hw.nnet->m_Cfg.m_vNodes.push_back(node_addr);
+            hw.nnet->Connect();
 
-        WalletApiServer server(options.apiVersion, walletDB, wallet, nnet, *reactor, listenTo, connectionOptions, acl, whitelist);
+            hw.wnet = std::make_shared<WalletNetworkViaBbs>(*hw.wallet, hw.nnet, db);
+            hw.wallet->AddMessageEndpoint(hw.wnet);
+            hw.wallet->SetNodeEndpoint(hw.nnet);
+
+            hw.server = std::make_unique<WalletApiServer>(options.apiVersion, db, hw.wallet, hw.nnet, *reactor, addr, connectionOptions, acl, whitelist);
+
+            if (Rules::get().CA.Enabled && wallet::g_AssetsEnabled)
+            {
+                RegisterAllAssetCreators(*hw.wallet);
+            }
+
+            if (options.enableLelantus)
+            {
+                lelantus::RegisterCreators(*hw.wallet, db);
+            }
+
+            return hw;
+        };
+
+        HostedWallet mainWallet = hostWallet(walletDB, listenTo);
+        auto wallet = mainWallet.wallet;
+        auto nnet = mainWallet.nnet;
+        auto wnet = mainWallet.wnet;
+        WalletApiServer& server = *mainWallet.server;
 
         #ifdef BEAM_ATOMIC_SWAP_SUPPORT
         RegisterSwapTxCreators(wallet, walletDB);
@@ -918,23 +989,36 @@ int main(int argc, char* argv[])
         }
         #endif
 
+#ifdef BEAM_ASSET_SWAP_SUPPORT
         if (Rules::get().CA.Enabled && wallet::g_AssetsEnabled)
         {
-            RegisterAllAssetCreators(*wallet);
-
-#ifdef BEAM_ASSET_SWAP_SUPPORT
             wallet->RegisterTransactionType(TxType::DexSimpleSwap, std::make_shared<DexTransaction::Creator>(walletDB));
             server.initDexFeature(nnet, *wnet, *wallet);
-#endif  // BEAM_ASSET_SWAP_SUPPORT
         }
+#endif  // BEAM_ASSET_SWAP_SUPPORT
 
-        if (options.enableLelantus)
+        std::vector<HostedWallet> extraWallets;
+        extraWallets.reserve(extraWalletDBs.size());
+        for (size_t i = 0; i < extraWalletDBs.size(); ++i)
         {
-            lelantus::RegisterCreators(*wallet, walletDB);
+            auto port = static_cast<uint16_t>(options.port + i + 1);
+            extraWallets.push_back(hostWallet(extraWalletDBs[i], io::Address().port(port)));
+            BEAM_LOG_INFO() << "extra wallet #" << i + 1 << " is served on port " << port;
         }
 
         // All TxCreators must be registered by this point
         wallet->ResumeAllTransactions();
+        for (auto& hw : extraWallets)
+        {
+            hw.wallet->ResumeAllTransactions();
+        }
+
+        std::unique_ptr<MetricsServer> metricsServer;
+        if (options.metricsPort)
+        {
+            metricsServer = std::make_unique<MetricsServer>(*reactor, io::Address().port(options.metricsPort));
+        }
+
         io::Reactor::get_Current().run();
 
         #ifdef BEAM_IPFS_SUPPORT
@@ -49,8 +49,9 @@ namespace beam::wallet
         virtual bool allowedTx(const TxDescription& tx);
         virtual void fillAssetInfo(json& arr, const WalletAsset& info);
         virtual void fillAddresses(json& arr, const std::vector<WalletAddress>& items);
-        virtual void fillCoins(json& arr, const std::vector<ApiCoin>& coins);
-        virtual void fillTransactions(json& arr, const std::vector<Status::Response>& txs);
+        // static, may be called on the response worker thread
+        static void fillCoins(json& arr, const std::vector<ApiCoin>& coins);
+        static void fillTransactions(json& arr, const std::vector<Status::Response>& txs);
 
     private:
         void FillAddressData(const AddressData& data, WalletAddress& address);
@@ -325,6 +325,7 @@ namespace beam::wallet
 
         uint32_t count = 0;
         uint32_t skip = 0;
+        boost::optional<TxID> after; // keyset pagination, the last tx of the previous page
         bool withRates = false;
 
         struct Response
@@ -35,6 +35,29 @@ namespace
 
     const char* kAddrDoesntExistError = "Provided address doesn't exist.";
     const char* kUnknownTxID = "Unknown transaction ID.";
+
+    BlockDetails::Response makeBlockDetails(const Block::SystemState::Full& state)
+    {
+        Merkle::Hash blockHash;
+        state.get_Hash(blockHash);
+
+        const Rules& r = Rules::get();
+        std::string rulesHash = r.pForks[r.FindFork(state.m_Height)].m_Hash.str();
+
+        BlockDetails::Response response;
+        response.height = state.m_Height;
+        response.blockHash = blockHash.str();
+        response.previousBlock = state.m_Prev.str();
+        response.chainwork = state.m_ChainWork.str();
+        response.kernels = state.m_Kernels.str();
+        response.definition = state.m_Definition.str();
+        response.timestamp = state.m_TimeStamp;
+        response.pow = beam::to_hex(&state.m_PoW, sizeof(state.m_PoW));
+        response.difficulty = state.m_PoW.m_Difficulty.ToFloat();
+        response.packedDifficulty = state.m_PoW.m_Difficulty.m_Packed;
+        response.rulesHash = std::move(rulesHash);
+        return response;
+    }
 }
 
 namespace beam::wallet
@@ -636,6 +659,16 @@ namespace beam::wallet
         }
 
         doPagination(data.skip, data.count, response.coins);
+
+        if (response.coins.size() >= kOffloadMinItems)
+        {
+            offloadResponse(id, [coins = std::move(response.coins)](json& result)
+            {
+                fillCoins(result, coins);
+            });
+            return;
+        }
+
         doResponse(id, response);
     }
 
@@ -740,6 +773,30 @@ namespace beam::wallet
                 filter.m_AssetConfirmedHeight = data.filter.height;
             }
             filter.m_KernelProofHeight = data.filter.height;
+            filter.m_TransactionTypes = {
+                TxType::Simple,
+                TxType::PushTransaction,
+                TxType::AssetIssue,
+                TxType::AssetConsume,
+                TxType::AssetInfo,
+                TxType::AssetReg,
+                TxType::AssetUnreg,
+                TxType::Contract,
+#ifdef BEAM_ASSET_SWAP_SUPPORT
+                TxType::DexSimpleSwap,
+#endif  // BEAM_ASSET_SWAP_SUPPORT
+            };
+            filter.m_After = data.after;
+
+            // unless allowedTx() may reject more (app access rights, assets), the page is selected by the DB
+            uint32_t skip = data.skip;
+            if (!isApp() && getCAEnabled())
+            {
+                filter.m_Skip = skip;
+                filter.m_Count = data.count;
+                skip = 0;
+            }
+
             walletDB->visitTx([&](const TxDescription& tx)
             {
                 if (!allowedTx(tx))
@@ -748,7 +805,7 @@ namespace beam::wallet
                 }
 
                 ++offset;
-                if (offset <= data.skip)
+                if (offset <= skip)
                 {
                     return true;
                 }
@@ -763,8 +820,18 @@ namespace beam::wallet
             }, filter);
             assert(data.count == 0 || (uint32_t)res.resultList.size() <= data.count);
         }
-        
-        doResponse(id, res);
+
+        if (res.resultList.size() >= kOffloadMinItems)
+        {
+            offloadResponse(id, [txs = std::move(res.resultList)](json& result)
+            {
+                fillTransactions(result, txs);
+            });
+        }
+        else
+        {
+            doResponse(id, res);
+        }
         sw.stop();
         BEAM_LOG_DEBUG() << "TxList  elapsed time: " << sw.milliseconds() << " ms\n";
     }
@@ -939,6 +1006,14 @@ namespace beam::wallet
     {
         BEAM_LOG_DEBUG() << "BlockDetails(id = " << id << ")";
 
+        // recent headers are known locally (possibly shared with other wallets), no need to ask the node
+        Block::SystemState::Full state;
+        if (getWalletDB()->get_History().get_At(state, data.blockHeight))
+        {
+            doResponse(id, makeBlockDetails(state));
+            return;
+        }
+
         RequestHeaderMsg::Ptr request(new RequestHeaderMsg(id, _weakSelf, *this));
         request->m_Msg.m_Height = data.blockHeight;
 
@@ -963,26 +1038,6 @@ namespace beam::wallet
             return;
         }
 
-        Block::SystemState::Full state = headerRequest.m_vStates.front();
-        Merkle::Hash blockHash;
-        state.get_Hash(blockHash);
-
-        const Rules& r = Rules::get();
-        std::string rulesHash = r.pForks[r.FindFork(state.m_Height)].m_Hash.str();
-
-        BlockDetails::Response response;
-        response.height = state.m_Height;
-        response.blockHash = blockHash.str();
-        response.previousBlock = state.m_Prev.str();
-        response.chainwork = state.m_ChainWork.str();
-        response.kernels = state.m_Kernels.str();
-        response.definition = state.m_Definition.str();
-        response.timestamp = state.m_TimeStamp;
-        response.pow = beam::to_hex(&state.m_PoW, sizeof(state.m_PoW));
-        response.difficulty = state.m_PoW.m_Difficulty.ToFloat();
-        response.packedDifficulty = state.m_PoW.m_Difficulty.m_Packed;
-        response.rulesHash = std::move(rulesHash);
-
-        _wapi.doResponse(headerRequest._id, response);
+        _wapi.doResponse(headerRequest._id, makeBlockDetails(headerRequest.m_vStates.front()));
     }
 }
@@ -831,6 +831,8 @@ namespace beam::wallet
             txList.skip = *skip;
         }
 
+        txList.after = getOptionalParam<ValidTxID>(params, "after");
+
         auto rates = getOptionalParam<bool>(params, "rates");
         txList.withRates = rates && *rates;
 
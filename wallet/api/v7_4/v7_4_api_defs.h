@@ -16,12 +16,14 @@
 #include <string>
 #include <vector>
 #include "wallet/core/wallet_db.h"
+#include "wallet/api/v6_0/v6_api_defs.h"
 
 namespace beam::wallet
 {
 #define V7_4_API_METHODS(macro) \
         macro(SendSbbsMessage,          "send_message",       API_WRITE_ACCESS, API_SYNC, APPS_ALLOWED)    \
-        macro(ReadSbbsMessages,         "read_messages",      API_READ_ACCESS, API_SYNC, APPS_ALLOWED)
+        macro(ReadSbbsMessages,         "read_messages",      API_READ_ACCESS, API_SYNC, APPS_ALLOWED)    \
+        macro(GetChanges,               "get_changes",        API_READ_ACCESS, API_SYNC, APPS_BLOCKED)
 
     struct SendSbbsMessage
     {
@@ -44,4 +46,25 @@ namespace beam::wallet
             std::vector<InstantMessage> messages;
         };
     };
+
+    // Coins, txs & addresses changed since the given revision of the wallet db changes feed
+    struct GetChanges
+    {
+        boost::optional<uint64_t> after; // none: just get the latest revision
+        uint32_t count = 1000; // max changes to read, the rest is reported by 'more'
+
+        struct Response
+        {
+            uint64_t revision = 0; // pass it as 'after' in the next call
+            bool reset = false; // the changes since 'after' are not available, reload everything
+            bool more = false;
+
+            std::vector<ApiCoin> coins;
+            std::vector<std::string> removedCoins;
+            std::vector<Status::Response> txs;
+            std::vector<std::string> removedTxs;
+            std::vector<WalletAddress> addrs;
+            std::vector<std::string> removedAddrs;
+        };
+    };
 }
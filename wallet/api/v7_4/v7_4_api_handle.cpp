@@ -26,4 +26,159 @@ namespace beam::wallet
     {
         doResponse(id, ReadSbbsMessages::Response{ getWalletDB()->readIMs(req.all)});
     }
+
+    void V74Api::onHandleGetChanges(const JsonRpcId& id, GetChanges&& req)
+    {
+        auto walletDB = getWalletDB();
+        GetChanges::Response res;
+
+        uint64_t oldest = 0;
+        walletDB->getChangesRange(oldest, res.revision);
+
+        if (req.after && *req.after > res.revision)
+        {
+            throw jsonrpc_exception(ApiError::InvalidParamsJsonRpc, "Unknown revision " + std::to_string(*req.after));
+        }
+
+        if (!req.after || *req.after + 1 < oldest)
+        {
+            // the first call or the feed has been trimmed beyond the client's revision
+            res.reset = true;
+            doResponse(id, res);
+            return;
+        }
+
+        // several changes of an item collapse into one, its current state is reported
+        typedef std::map<ByteBuffer, bool> Changed; // key -> removed
+        Changed pChanged[4];
+        uint32_t nCount = 0;
+        uint64_t revision = *req.after;
+
+        walletDB->visitChanges(*req.after, [&](const ChangeLogEntry& e)
+        {
+            if (nCount == req.count)
+            {
+                res.more = true;
+                return false;
+            }
+
+            ++nCount;
+            revision = e.m_Revision;
+
+            if (ChangeAction::Reset == e.m_Action)
+            {
+                res.reset = true;
+                return false;
+            }
+
+            pChanged[static_cast<int>(e.m_Type)][e.m_Key] = (ChangeAction::Removed == e.m_Action);
+            return true;
+        });
+
+        if (res.reset)
+        {
+            // the client reloads everything, the revision is the latest one
+            res.more = false;
+            doResponse(id, res);
+            return;
+        }
+
+        res.revision = revision;
+
+        const auto caEnabled = getCAEnabled();
+
+        CoinIDList coinIDs;
+        for (const auto& [key, removed] : pChanged[static_cast<int>(ChangeLogEntry::Type::Coin)])
+        {
+            Coin::ID cid;
+            if (!fromByteBuffer(key, cid))
+                continue;
+
+            if (removed)
+                res.removedCoins.push_back(toString(cid));
+            else
+                coinIDs.push_back(cid);
+        }
+
+        if (!coinIDs.empty())
+        {
+            auto coins = walletDB->getCoinsByID(coinIDs);
+            std::set<std::string> found;
+            for (const auto& c : coins)
+            {
+                found.insert(c.toStringID());
+                if (!c.isAsset() || caEnabled)
+                    ApiCoin::EmplaceCoin(res.coins, c);
+            }
+
+            for (const auto& cid : coinIDs)
+            {
+                auto sID = toString(cid);
+                if (!found.count(sID))
+                    res.removedCoins.push_back(std::move(sID));
+            }
+        }
+
+        for (const auto& [key, removed] : pChanged[static_cast<int>(ChangeLogEntry::Type::ShieldedCoin)])
+        {
+            TxoID txoID = 0;
+            if (!fromByteBuffer(key, txoID))
+                continue;
+
+            boost::optional<ShieldedCoin> coin;
+            if (!removed)
+                coin = walletDB->getShieldedCoin(txoID);
+
+            if (!coin)
+                res.removedCoins.push_back(std::to_string(txoID));
+            else if (!coin->isAsset() || caEnabled)
+                ApiCoin::EmplaceCoin(res.coins, *coin);
+        }
+
+        Block::SystemState::ID stateID = {};
+        walletDB->getSystemStateID(stateID);
+
+        for (const auto& [key, removed] : pChanged[static_cast<int>(ChangeLogEntry::Type::Tx)])
+        {
+            TxID txID;
+            if (key.size() != txID.size())
+                continue;
+            std::copy(key.begin(), key.end(), txID.begin());
+
+            boost::optional<TxDescription> tx;
+            if (!removed)
+                tx = walletDB->getTx(txID);
+
+            if (!tx)
+            {
+                res.removedTxs.push_back(std::to_string(txID));
+                continue;
+            }
+
+            if (!allowedTx(*tx))
+                continue;
+
+            Status::Response& item = res.txs.emplace_back();
+            item.tx = *tx;
+            item.txProofHeight = storage::DeduceTxProofHeight(*walletDB, *tx);
+            item.systemHeight = stateID.m_Height;
+            item.withRates = true;
+        }
+
+        for (const auto& [key, removed] : pChanged[static_cast<int>(ChangeLogEntry::Type::Address)])
+        {
+            std::string token(key.begin(), key.end());
+
+            boost::optional<WalletAddress> addr;
+            if (!removed)
+                addr = walletDB->getAddressByToken(token);
+
+            if (addr)
+                res.addrs.push_back(*addr);
+            else
+                res.removedAddrs.push_back(token);
+        }
+
+        doResponse(id, res);
+    }
 }
@@ -86,4 +86,42 @@ void V74Api::getResponse(const JsonRpcId& id, const ReadSbbsMessages::Response&
             });
     }
 }
+
+std::pair<GetChanges, IWalletApi::MethodInfo> V74Api::onParseGetChanges(const JsonRpcId& id, const nlohmann::json& params)
+{
+    GetChanges message;
+    message.after = getOptionalParam<uint64_t>(params, "after");
+    if (auto count = getOptionalParam<PositiveUint32>(params, "count"))
+    {
+        message.count = *count;
+    }
+    return std::make_pair(std::move(message), MethodInfo());
+}
+
+void V74Api::getResponse(const JsonRpcId& id, const GetChanges::Response& res, json& msg)
+{
+    msg = json
+    {
+        {JsonRpcHeader, JsonRpcVersion},
+        {"id", id},
+        {"result",
+            {
+                {"revision", res.revision},
+                {"reset", res.reset},
+                {"more", res.more},
+                {"utxos", json::array()},
+                {"utxos_removed", res.removedCoins},
+                {"txs", json::array()},
+                {"txs_removed", res.removedTxs},
+                {"addrs", json::array()},
+                {"addrs_removed", res.removedAddrs}
+            }
+        }
+    };
+
+    auto& result = msg["result"];
+    fillCoins(result["utxos"], res.coins);
+    fillTransactions(result["txs"], res.txs);
+    fillAddresses(result["addrs"], res.addrs);
+}
 }
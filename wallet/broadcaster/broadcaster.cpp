@@ -42,7 +42,7 @@ io::Reactor::Ptr reactor;
 
 WalletID channelToWalletID(BbsChannel channel)
 {
-    WalletID dummyWalletID;
+    WalletID dummyWalletID(Zero);
     dummyWalletID.m_Channel = channel;
     return dummyWalletID;
 }
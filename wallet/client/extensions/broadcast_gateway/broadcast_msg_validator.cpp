@@ -42,10 +42,42 @@ namespace beam::wallet
         {
             m_publisherKeys.push_back(key);
         }
+
+        m_verifiedMessages.clear();
+        m_verifiedOrder.clear();
     }
 
     // Later on can be implemented in ProtocolBase::VerifyMsg() and become incapsulated in BroadcatRouter class
     bool BroadcastMsgValidator::isSignatureValid(const BroadcastMsg& msg) const
+    {
+        // the content size is hashed too, so that a different split of the same bytes doesn't match
+        ECC::Hash::Value hv;
+        ECC::Hash::Processor()
+            << static_cast<uint64_t>(msg.m_content.size())
+            << Blob(msg.m_content)
+            << Blob(msg.m_signature)
+            >> hv;
+
+        auto it = m_verifiedMessages.find(hv);
+        if (it != m_verifiedMessages.end())
+        {
+            return it->second;
+        }
+
+        bool isValid = verifySignature(msg);
+
+        if (m_verifiedOrder.size() >= m_maxVerifiedMessages)
+        {
+            m_verifiedMessages.erase(m_verifiedOrder.front());
+            m_verifiedOrder.pop_front();
+        }
+        m_verifiedMessages.emplace(hv, isValid);
+        m_verifiedOrder.push_back(hv);
+
+        return isValid;
+    }
+
+    bool BroadcastMsgValidator::verifySignature(const BroadcastMsg& msg) const
     {
         SignatureHandler signValidator;
 
@@ -18,6 +18,9 @@
 
 #include "core/block_crypt.h"   // PeerID
 
+#include <deque>
+#include <map>
+
 namespace beam::wallet
 {
     /**
@@ -38,7 +41,15 @@ namespace beam::wallet
         static bool stringToPublicKey(const std::string& keyHexString, PublicKey& out);
 
     private:
+        bool verifySignature(const BroadcastMsg& msg) const;
+
         std::vector<PublicKey> m_publisherKeys;       /// publisher keys to validate messages
+
+        /// The same message is relayed by all the connected nodes, and re-broadcast periodically.
+        /// Verification results by the message (content and signature) hash, so that it's verified once.
+        static constexpr size_t m_maxVerifiedMessages = 256;
+        mutable std::map<ECC::Hash::Value, bool> m_verifiedMessages;
+        mutable std::deque<ECC::Hash::Value> m_verifiedOrder;  /// for eviction, oldest first
     };
 
 } // namespace beam::wallet
@@ -141,7 +141,7 @@ void BroadcastRouter::unregisterListener(BroadcastContentType type)
 void BroadcastRouter::sendRawMessage(BroadcastContentType type, const ByteBuffer& msg)
 {
     // Route to BBS channel
-    wallet::WalletID dummyWId;
+    wallet::WalletID dummyWId(Zero); // no peer key, mined as a broadcast
     dummyWId.m_Channel = getBbsChannel(type);
     m_bbsMessageEndpoint.SendRawMessage(dummyWId, msg);
 }
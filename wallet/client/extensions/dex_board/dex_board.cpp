@@ -15,6 +15,7 @@
 #include "wallet/transactions/dex/dex_tx.h"
 #include "wallet/client/extensions/broadcast_gateway/broadcast_msg_creator.h"
 #include "wallet/client/wallet_client.h"
+#include <limits>
 
 namespace beam::wallet {
 
@@ -31,7 +32,7 @@ namespace beam::wallet {
                 DexOrder offer(offerRaw.first, offerRaw.second);
                 if (!offer.isExpired())
                 {
-                    _orders[offer.getID()] = offer;
+                    addOrder(offer);
                     CtlListen(offer, true);
                 }
                 else
@@ -53,7 +54,7 @@ namespace beam::wallet {
         std::vector<DexOrder> result;
         result.reserve(_orders.size());
 
-        for (auto pair: _orders)
+        for (const auto& pair: _orders)
         {
             result.push_back(pair.second);
         }
@@ -61,6 +62,25 @@ namespace beam::wallet {
         return result;
     }
 
+    std::vector<DexOrder> DexBoard::getDexOrderBook(Asset::ID firstAssetId, Asset::ID secondAssetId) const
+    {
+        std::vector<DexOrder> result;
+
+        auto itBook = _books.find(AssetPair(firstAssetId, secondAssetId));
+        if (itBook == _books.end())
+            return result;
+
+        result.reserve(itBook->second.size());
+        for (const auto& entry: itBook->second)
+        {
+            const auto it = _orders.find(entry._id);
+            assert(it != _orders.end());
+            result.push_back(it->second);
+        }
+
+        return result;
+    }
+
     boost::optional<DexOrder> DexBoard::getDexOrder(const DexOrderID& orderId) const
     {
         const auto it = _orders.find(orderId);
@@ -96,7 +116,7 @@ namespace beam::wallet {
         {
             if (!order->isCanceled() && !order->isExpired() && !order->isAccepted())
             {
-                _orders[order->getID()] = *order;
+                addOrder(*order);
                 _wdb.saveDexOffer(order->getID(), toByteBuffer(*order), order->isMine());
                 notifyObservers(ChangeAction::Added, std::vector<DexOrder>{ *order });
                 CtlListen(*order, true);
@@ -109,11 +129,11 @@ namespace beam::wallet {
                 notifyObservers(ChangeAction::Removed, std::vector<DexOrder>{ *order });
                 _wdb.dropDexOffer(order->getID());
                 CtlListen(it->second, false);
-                _orders.erase(it);
+                eraseOrder(it);
             }
             else
             {
-                _orders[order->getID()] = *order;
+                updateOrder(it, *order);
                 notifyObservers(ChangeAction::Updated, std::vector<DexOrder>{ *order });
             }
         }
@@ -206,27 +226,80 @@ namespace beam::wallet {
 
     void DexBoard::onSystemStateChanged(const Block::SystemState::ID& stateID)
     {
-        std::vector<DexOrderID> notActualOffers;
-        for (const auto& it: _orders)
+        // the expired ones are in front, the rest isn't visited
+        const auto now = getTimestamp();
+        while (!_expirations.empty() && _expirations.begin()->first < now)
         {
-            const auto& offer = it.second;
-            if (offer.isExpired())
-            {
-                CtlListen(offer, false);
-                notActualOffers.emplace_back(it.first);
-                notifyObservers(ChangeAction::Removed, std::vector<DexOrder>{ it.second });
-                _wdb.dropDexOffer(it.first);
-            }
+            auto it = _orders.find(_expirations.begin()->second);
+            assert(it != _orders.end());
+
+            const auto offer = it->second;
+            CtlListen(offer, false);
+            notifyObservers(ChangeAction::Removed, std::vector<DexOrder>{ offer });
+            _wdb.dropDexOffer(offer.getID());
+            eraseOrder(it);
+        }
+    }
+
+    void DexBoard::addOrder(const DexOrder& order)
+    {
+        auto res = _orders.emplace(order.getID(), order);
+        if (res.second)
+            indexOrder(order, true);
+        else
+            updateOrder(res.first, order);
+    }
+
+    void DexBoard::updateOrder(OrdersMap::iterator it, const DexOrder& order)
+    {
+        indexOrder(it->second, false);
+        it->second = order;
+        indexOrder(it->second, true);
+    }
+
+    void DexBoard::eraseOrder(OrdersMap::iterator it)
+    {
+        indexOrder(it->second, false);
+        _orders.erase(it);
+    }
+
+    void DexBoard::indexOrder(const DexOrder& order, bool add)
+    {
+        const auto pairKey = AssetPair(order.getFirstAssetId(), order.getSecondAssetId());
+        const auto amountFirst = order.getFirstAmount();
+
+        BookEntry entry;
+        entry._price = amountFirst ?
+            static_cast<double>(order.getSecondAmount()) / static_cast<double>(amountFirst) :
+            std::numeric_limits<double>::max();
+        entry._id = order.getID();
+
+        const auto expiration = std::make_pair(order.getExpiration(), order.getID());
+
+        if (add)
+        {
+            _books[pairKey].insert(entry);
+            _expirations.insert(expiration);
+            return;
         }
 
-        for (auto idForRemove: notActualOffers)
+        auto itBook = _books.find(pairKey);
+        if (itBook != _books.end())
         {
-            _orders.erase(idForRemove);
+            itBook->second.erase(entry);
+            if (itBook->second.empty())
+                _books.erase(itBook);
         }
+
+        _expirations.erase(expiration);
     }
 
     void DexBoard::CtlListen(const DexOrder& order, bool bListen)
     {
+        // only the maker is contacted via the order address. Saves the key derivation per a foreign order
+        if (!order.isMine())
+            return;
+
         if (bListen)
         {
             WalletID wid;
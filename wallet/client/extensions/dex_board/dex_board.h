@@ -17,6 +17,7 @@
 #include "wallet/client/extensions/broadcast_gateway/interface.h"
 #include "wallet/core/wallet.h"
 #include "wallet/client/wallet_model_async.h"
+#include <set>
 
 namespace beam::wallet {
     class WalletClient;
@@ -40,6 +41,8 @@ namespace beam::wallet {
 
         [[nodiscard]] std::vector<DexOrder> getDexOrders() const;
         [[nodiscard]] boost::optional<DexOrder> getDexOrder(const DexOrderID&) const;
+        // orders of the asset pair, by the price (the second amount per first), the best first
+        [[nodiscard]] std::vector<DexOrder> getDexOrderBook(Asset::ID firstAssetId, Asset::ID secondAssetId) const;
 
         void publishOrder(const DexOrder&);
         void cancelDexOrder(const DexOrderID& id);
@@ -61,6 +64,15 @@ namespace beam::wallet {
         bool handleDexOrder(const boost::optional<DexOrder>&);
         void CtlListen(const DexOrder&, bool);
 
+        //
+        // Index
+        //
+        using OrdersMap = std::map<DexOrderID, DexOrder>;
+        void addOrder(const DexOrder&);
+        void updateOrder(OrdersMap::iterator, const DexOrder&);
+        void eraseOrder(OrdersMap::iterator);
+        void indexOrder(const DexOrder&, bool add);
+
         //
         // IBroadcastListener
         //
@@ -93,6 +105,21 @@ namespace beam::wallet {
         IBroadcastMsgGateway& _gatewayBroadcast;
         IRawCommGateway& _gatewayCtlListen;
         IWalletDB& _wdb;
-        std::map<DexOrderID, DexOrder> _orders;
+        OrdersMap _orders;
+
+        struct BookEntry
+        {
+            double _price;
+            DexOrderID _id;
+
+            bool operator < (const BookEntry& x) const
+            {
+                return (_price != x._price) ? (_price < x._price) : (_id < x._id);
+            }
+        };
+
+        using AssetPair = std::pair<Asset::ID, Asset::ID>;
+        std::map<AssetPair, std::set<BookEntry>> _books;
+        std::set<std::pair<Timestamp, DexOrderID>> _expirations;
     };
 }
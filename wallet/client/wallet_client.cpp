@@ -490,6 +490,11 @@ struct WalletModelBridge : public Bridge<IWalletModelAsync>
         call_async(&IWalletModelAsync::enableBodyRequests, value);
     }
 
+    void setNodePollPeriod(uint32_t period_ms) override
+    {
+        call_async(&IWalletModelAsync::setNodePollPeriod, period_ms);
+    }
+
     void sendInstantMessage(const WalletID& peerID, const WalletID& myID, ByteBuffer&& message) override
     {
         call_async(&IWalletModelAsync::sendInstantMessage, peerID, myID, std::move(message));
@@ -655,6 +660,18 @@ namespace beam::wallet
                 LogRotation logRotation(*m_reactor, LOG_ROTATION_PERIOD_SEC, LOG_CLEANUP_PERIOD_SEC);
 #endif // !__EMSCRIPTEN__
 
+#ifdef BEAM_WEB_WALLET_CRYPTO_THREADS
+                // The shielded proofs and the multi-exponentiations are split among the workers.
+                // Each executor thread holds a pool thread for the wallet lifetime, leave one for the wallet and one for the transient tasks
+                ExecutorMT_R exec;
+                uint32_t nPool = MyThread::hardware_concurrency();
+                exec.set_Threads(std::min<uint32_t>(BEAM_WEB_WALLET_CRYPTO_THREADS, (nPool > 2) ? (nPool - 2) : 0));
+
+                std::unique_ptr<Executor::Scope> pScopeExec;
+                if (exec.get_Threads() > 1)
+                    pScopeExec = std::make_unique<Executor::Scope>(exec);
+#endif // BEAM_WEB_WALLET_CRYPTO_THREADS
+
                 wallet::HidKeyKeeper::IEvents* pEvts = this;
                 beam::TemporarySwap ts(wallet::HidKeyKeeper_ToConsole::s_pEvents, pEvts);
 
@@ -2413,6 +2430,24 @@ namespace beam::wallet
         }
     }
 
+    void WalletClient::setNodePollPeriod(uint32_t period_ms)
+    {
+        auto s = m_nodeNetwork.lock();
+        if (!s)
+            return;
+
+        // the headers are kept in the wallet DB, after reconnect only the missing tail is synced
+        bool bWake = s->m_Cfg.m_PollPeriod_ms && !period_ms;
+        s->m_Cfg.m_PollPeriod_ms = period_ms;
+
+        if (bWake)
+        {
+            // don't wait for the poll timer
+            s->Disconnect();
+            s->Connect();
+        }
+    }
+
     void WalletClient::sendInstantMessage(const WalletID& peerID, const WalletID& myID, ByteBuffer&& message)
     {
         auto timestamp = getTimestamp();
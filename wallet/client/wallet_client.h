@@ -361,6 +361,7 @@ namespace beam::wallet
         void markAppNotificationAsRead(const TxID& id) override;
 
         void enableBodyRequests(bool value) override;
+        void setNodePollPeriod(uint32_t period_ms) override;
 
         void sendInstantMessage(const WalletID& peerID, const WalletID& myID, ByteBuffer&& message) override;
         void getChats() override;
@@ -149,6 +149,8 @@ namespace beam::wallet
         virtual void markAppNotificationAsRead(const TxID& id) = 0;
 
         virtual void enableBodyRequests(bool value) = 0;
+        // keep the node connection only while there are requests, reconnect every period. 0 - stay connected (default)
+        virtual void setNodePollPeriod(uint32_t period_ms) = 0;
 
         virtual void sendInstantMessage(const WalletID& peerID, const WalletID& myID, ByteBuffer&& message) = 0;
         virtual void getChats() = 0;
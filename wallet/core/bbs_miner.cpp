@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #include "bbs_miner.h"
+#include <algorithm>
 
 namespace beam::wallet
 {
@@ -36,6 +37,26 @@ void BbsMiner::Stop()
     }
 }
 
+void BbsMiner::Push(Task::Ptr&& pTask)
+{
+    std::unique_lock<std::mutex> scope(m_Mutex);
+
+    TaskQueue::iterator it = m_Pending.end();
+    if (!pTask->m_Broadcast)
+    {
+        // before the first broadcast
+        for (it = m_Pending.begin(); m_Pending.end() != it; ++it)
+            if ((*it)->m_Broadcast)
+                break;
+
+        if (m_Pending.begin() == it && !m_Pending.empty())
+            m_Preempted++;
+    }
+
+    m_Pending.insert(it, std::move(pTask));
+    m_NewTask.notify_all();
+}
+
 void BbsMiner::Thread(uint32_t iThread, const Rules& r)
 {
     Rules::Scope scopeRules(r);
@@ -45,6 +66,7 @@ void BbsMiner::Thread(uint32_t iThread, const Rules& r)
     while (true)
     {
         Task::Ptr pTask;
+        uint32_t nPreempted;
 
         for (std::unique_lock<std::mutex> scope(m_Mutex); ; m_NewTask.wait(scope))
         {
@@ -54,6 +76,7 @@ void BbsMiner::Thread(uint32_t iThread, const Rules& r)
             if (!m_Pending.empty())
             {
                 pTask = m_Pending.front();
+                nPreempted = m_Preempted;
                 break;
             }
         }
@@ -62,19 +85,28 @@ void BbsMiner::Thread(uint32_t iThread, const Rules& r)
         proto::Bbs::NonceType nonce = iThread;
         bool bSuccess = false;
 
+        ECC::Hash::Processor hpTs;
+
         for (uint32_t i = 0; ; i++)
         {
             if (pTask->m_Done || m_Shutdown)
                 break;
 
             if (!(i & 0xff))
+            {
+                if (m_Preempted != nPreempted)
+                    break; // the task stays pending, will be resumed later
+
+                // the timestamp is hashed once per its update, only the nonce is added per attempt
                 ts = getTimestamp();
+                hpTs = pTask->m_hpPartial;
+                hpTs << ts;
+            }
 
             // attempt to mine it
             ECC::Hash::Value hv;
-            ECC::Hash::Processor hp = pTask->m_hpPartial;
+            ECC::Hash::Processor hp = hpTs;
             hp
-                << ts
                 << nonce
                 >> hv;
 
@@ -95,13 +127,15 @@ void BbsMiner::Thread(uint32_t iThread, const Rules& r)
                 bSuccess = false;
             else
             {
-                assert(m_Pending.front() == pTask);
+                // normally at the front, unless it was preempted meanwhile
+                TaskQueue::iterator it = std::find(m_Pending.begin(), m_Pending.end(), pTask);
+                assert(m_Pending.end() != it);
+                m_Pending.erase(it);
 
                 pTask->m_Msg.m_TimePosted = ts;
                 pTask->m_Msg.m_Nonce = nonce;
 
                 pTask->m_Done = true;
-                m_Pending.pop_front();
                 m_Done.push_back(std::move(pTask));
             }
         }
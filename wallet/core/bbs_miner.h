@@ -14,6 +14,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <deque>
 #include <mutex>
 #include <thread>
@@ -41,6 +42,7 @@ struct BbsMiner
         proto::BbsMsg m_Msg;
         ECC::Hash::Processor m_hpPartial;
         volatile bool m_Done;
+        bool m_Broadcast = false; // mined after all the interactive messages
         uint64_t m_StoredMessageID;
 
         typedef std::shared_ptr<Task> Ptr;
@@ -48,14 +50,18 @@ struct BbsMiner
 
     typedef std::deque<Task::Ptr> TaskQueue;
 
+    // All the threads mine the front task (each one its own nonce subset), and move on to the next one as soon as it's found.
+    // The interactive tasks are queued before the broadcasts, and preempt a broadcast being mined.
     TaskQueue m_Pending;
     TaskQueue m_Done;
+    std::atomic<uint32_t> m_Preempted; // incremented when the front task is replaced
 
-    BbsMiner() :m_Shutdown(false) {}
+    BbsMiner() :m_Shutdown(false), m_Preempted(0) {}
     ~BbsMiner() { Stop(); }
 
     void Stop();
     void Thread(uint32_t, const Rules&);
+    void Push(Task::Ptr&&); // locks the mutex
 
 };
 }  // namespace beam::wallet
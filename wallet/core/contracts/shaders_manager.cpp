@@ -225,7 +225,7 @@ namespace beam::wallet {
         beam::Blob shaderBlob(shader);
 
         // this throws
-        beam::bvm2::Processor::Compile(resBuffer, shaderBlob, ManagerStd::Kind::Manager);
+        ManagerStd::CompileAppShader(resBuffer, shaderBlob);
     }
 
     void ShadersManager::pushRequest(Request newReq)
@@ -219,10 +219,17 @@ namespace beam::wallet
         KEY_KEEPER_METHODS(THE_MACRO)
 #undef THE_MACRO
 
+        // Invokes several methods of the same kind (i.e. creates many outputs), the handler is notified once all are done.
+        // The status is Success or the 1st failure. As with a single call, the methods must be alive until then.
+        // The implementation may process them concurrently
+        template <typename TMethod>
+        void InvokeAsyncBatch(std::vector<TMethod>&, const Handler::Ptr&);
+
         virtual ~IPrivateKeyKeeper2() {}
 
     private:
         struct HandlerSync;
+        struct HandlerBatch;
 
         template <typename TMethod>
         Status::Type InvokeSyncInternal(TMethod& m);
@@ -287,6 +294,41 @@ namespace beam::wallet
 
 	};
 
+    struct IPrivateKeyKeeper2::HandlerBatch
+        :public Handler
+    {
+        Handler::Ptr m_pHandler;
+        size_t m_Remaining = 0;
+        Status::Type m_Status = Status::Success;
+
+        void OnDone(Status::Type n) override
+        {
+            if ((Status::Success == m_Status) && (Status::Success != n))
+                m_Status = n;
+
+            assert(m_Remaining);
+            if (!--m_Remaining)
+                m_pHandler->OnDone(m_Status);
+        }
+    };
+
+    template <typename TMethod>
+    void IPrivateKeyKeeper2::InvokeAsyncBatch(std::vector<TMethod>& v, const Handler::Ptr& pHandler)
+    {
+        if (v.empty())
+        {
+            pHandler->OnDone(Status::Success);
+            return;
+        }
+
+        auto pBatch = std::make_shared<HandlerBatch>();
+        pBatch->m_pHandler = pHandler;
+        pBatch->m_Remaining = v.size(); // before the 1st invocation, some may complete immediately
+
+        for (auto& m : v)
+            InvokeAsync(m, pBatch);
+    }
+
 	class ThreadedPrivateKeyKeeper
 		:public PrivateKeyKeeper_WithMarshaller
 	{
@@ -216,6 +216,7 @@ namespace beam::wallet
             if (!--m_OwnedNodesOnline)
             {
                 AbortEvents();
+                m_EventsNotified = false;
             }
         }
 
@@ -488,17 +489,111 @@ namespace beam::wallet
 
         InitWidgetRunner();
 
-        auto func = [this](const auto& tx)
+        std::vector<TxDescription> vTxs;
+        auto func = [this, &vTxs](const auto& tx)
         {
-            ResumeTransaction(tx);
+            if (tx.canResume() && (m_ActiveTransactions.end() == m_ActiveTransactions.find(tx.m_txId)))
+                vTxs.push_back(tx);
             return true;
         };
         TxListFilter filter;
         m_WalletDB->visitTx(func, filter);
 
+        // nearly done first (the kernel is already sent), then by the negotiation progress, then the recent ones
+        auto fnRank = [](TxStatus s)
+        {
+            switch (s)
+            {
+            case TxStatus::Registering:
+            case TxStatus::Confirming:
+                return 0;
+            case TxStatus::InProgress:
+                return 1;
+            default:
+                return 2;
+            }
+        };
+
+        std::stable_sort(vTxs.begin(), vTxs.end(), [&fnRank](const TxDescription& a, const TxDescription& b)
+        {
+            int ra = fnRank(a.m_status), rb = fnRank(b.m_status);
+            if (ra != rb)
+                return ra < rb;
+            return a.m_createTime > b.m_createTime;
+        });
+
+        for (const auto& tx : vTxs)
+        {
+            if (m_PendingResume.emplace(tx.m_txId, tx.m_txType).second)
+                m_PendingResumeOrder.push_back(tx.m_txId);
+        }
+
+        if (!vTxs.empty())
+            BEAM_LOG_INFO() << "Resuming " << vTxs.size() << " transactions";
+
+        ResumePendingBatch(true);
+
         m_VoucherManager.CheckTimer();
     }
 
+    BaseTransaction::Ptr Wallet::ResumePending(const TxID& txID)
+    {
+        auto it = m_PendingResume.find(txID);
+        if (m_PendingResume.end() == it)
+            return nullptr;
+
+        TxType type = it->second;
+        m_PendingResume.erase(it);
+
+        if (m_ActiveTransactions.end() != m_ActiveTransactions.find(txID))
+            return nullptr; // already resumed by other means
+
+        auto t = ConstructTransaction(txID, type);
+        if (t)
+            MakeTransactionActive(t);
+
+        return t;
+    }
+
+    void Wallet::ResumePendingOnDemand(const TxID& txID)
+    {
+        auto t = ResumePending(txID);
+        if (t)
+            UpdateTransaction(t);
+    }
+
+    void Wallet::ResumePendingBatch(bool bInitial)
+    {
+        // the 1st batch is resumed right away, its update waits for the sync, as before. The rest - throttled
+        for (uint32_t nDone = 0; (nDone < s_ResumeBatch) && !m_PendingResumeOrder.empty(); )
+        {
+            TxID txID = m_PendingResumeOrder.front();
+            m_PendingResumeOrder.pop_front();
+
+            auto t = ResumePending(txID);
+            if (!t)
+                continue;
+
+            if (bInitial)
+                UpdateOnSynced(t);
+            else
+                UpdateTransaction(t);
+
+            nDone++;
+        }
+
+        if (m_PendingResumeOrder.empty())
+        {
+            m_pResumeTimer.reset();
+            return;
+        }
+
+        if (!m_pResumeTimer)
+            m_pResumeTimer = io::Timer::create(io::Reactor::get_Current());
+
+        m_pResumeTimer->start(s_ResumeInterval_ms, false, [this]() { ResumePendingBatch(false); });
+    }
+
     bool Wallet::IsWalletInSync() const
     {
         Block::SystemState::ID stateID;
@@ -536,7 +631,8 @@ namespace beam::wallet
 
     size_t Wallet::GetUnsafeActiveTransactionsCount() const
     {
-        return std::count_if(m_ActiveTransactions.begin(), m_ActiveTransactions.end(), [](const auto& p)
+        // the not yet resumed ones are considered unsafe
+        return m_PendingResume.size() + std::count_if(m_ActiveTransactions.begin(), m_ActiveTransactions.end(), [](const auto& p)
             {
                 return p.second && !p.second->IsInSafety();
             });
@@ -701,6 +797,9 @@ namespace beam::wallet
             pVal->m_SubTxID = subTxID;
             pVal->m_Msg.m_ID = kernelID;
 
+            if (CompleteFromCache(*pVal))
+                return;
+
             if (PostReqUnique(*pVal))
                 BEAM_LOG_INFO() << txID << "[" << subTxID << "]" << " Get proof for kernel: " << pVal->m_Msg.m_ID;
         }
@@ -712,6 +811,9 @@ namespace beam::wallet
         pVal->m_Msg.m_ID = kernelID;
         pVal->m_pCallback = std::move(pCallback);
 
+        if (CompleteFromCache(*pVal))
+            return;
+
         if (PostReq(*pVal))
         {
             BEAM_LOG_INFO() << " Get proof for kernel: " << kernelID;
@@ -775,6 +877,9 @@ namespace beam::wallet
             msg.m_Fetch = true;
             msg.m_ID = kernelID;
 
+            if (CompleteFromCache(*pVal))
+                return;
+
             if (PostReqUnique(*pVal))
             {
                 BEAM_LOG_INFO() << txID << "[" << subTxID << "]" << " Get details for kernel: " << msg.m_ID;
@@ -1278,6 +1383,7 @@ namespace beam::wallet
     {
         BEAM_LOG_INFO() << txId << " Canceling tx";
 
+        ResumePendingOnDemand(txId);
         if (auto it = m_ActiveTransactions.find(txId); it != m_ActiveTransactions.end())
         {
             it->second->Cancel();
@@ -1291,6 +1397,7 @@ namespace beam::wallet
     void Wallet::DeleteTransaction(const TxID& txId)
     {
         BEAM_LOG_INFO() << "deleting tx " << txId;
+        ResumePendingOnDemand(txId); // so that it's treated as running
         if (auto it = m_ActiveTransactions.find(txId); it == m_ActiveTransactions.end())
         {
             m_WalletDB->deleteTx(txId);
@@ -1360,7 +1467,10 @@ namespace beam::wallet
     void Wallet::OnRequestComplete(MyRequestKernel& r)
     {
         if (!r.m_Res.m_Proof.empty())
+        {
             m_WalletDB->get_History().AddStates(&r.m_Res.m_Proof.m_State, 1); // why not?
+            m_KernelProofCache.Insert(r.m_Msg.m_ID).m_Proof = r.m_Res.m_Proof;
+        }
 
         if (r.m_pCallback)
         {
@@ -1498,6 +1608,10 @@ namespace beam::wallet
 
         if (r.m_Res.m_Kernel)
         {
+            auto& e = m_KernelProofCache.Insert(r.m_Msg.m_ID);
+            e.m_pKernel = r.m_Res.m_Kernel;
+            e.m_hKernel = r.m_Res.m_Height;
+
             tx->SetParameter(TxParameterID::Kernel, r.m_Res.m_Kernel, r.m_SubTxID);
             tx->SetParameter(TxParameterID::KernelProofHeight, r.m_Res.m_Height, r.m_SubTxID);
         }
@@ -1509,7 +1623,113 @@ namespace beam::wallet
         }
     }
 
-    void Wallet::OnRequestComplete(MyRequestShieldedList& r)
+    Wallet::KernelProofCache::Entry& Wallet::KernelProofCache::Insert(const Merkle::Hash& id)
+    {
+        if (m_Map.size() >= s_MaxSize)
+        {
+            auto it = m_Map.find(id);
+            if (m_Map.end() == it)
+                m_Map.erase(m_Map.begin()); // arbitrary, the evicted one would just be requested again
+        }
+
+        return m_Map[id];
+    }
+
+    bool Wallet::KernelProofCache::Find(MyRequestKernel& r) const
+    {
+        auto it = m_Map.find(r.m_Msg.m_ID);
+        if ((m_Map.end() == it) || it->second.m_Proof.empty())
+            return false;
+
+        r.m_Res.m_Proof = it->second.m_Proof;
+        return true;
+    }
+
+    bool Wallet::KernelProofCache::Find(MyRequestKernel2& r) const
+    {
+        auto it = m_Map.find(r.m_Msg.m_ID);
+        if ((m_Map.end() == it) || !it->second.m_pKernel)
+            return false;
+
+        r.m_Res.m_Kernel = it->second.m_pKernel;
+        r.m_Res.m_Height = it->second.m_hKernel;
+        return true;
+    }
+
+    void Wallet::KernelProofCache::OnRolledBack(Height h)
+    {
+        for (auto it = m_Map.begin(); m_Map.end() != it; )
+        {
+            if (it->second.get_MaxHeight() > h)
+                it = m_Map.erase(it);
+            else
+                ++it;
+        }
+    }
+
+    void Wallet::KernelProofCache::ScheduleComplete()
+    {
+        // Complete on the next loop iteration, as if from the node. The caller may be in the middle of the tx update
+        if (!m_pTimer)
+            m_pTimer = io::Timer::create(io::Reactor::get_Current());
+
+        if (m_vKernel.size() + m_vKernel2.size() == 1)
+            m_pTimer->start(0, false, [this]() { get_ParentObj().OnKernelProofCacheTimer(); });
+    }
+
+    bool Wallet::CompleteFromCache(MyRequestKernel& r)
+    {
+        if (!m_KernelProofCache.Find(r))
+            return false;
+
+        m_KernelProofCache.m_vKernel.push_back(&r);
+        m_KernelProofCache.ScheduleComplete();
+        return true;
+    }
+
+    bool Wallet::CompleteFromCache(MyRequestKernel2& r)
+    {
+        if (!m_KernelProofCache.Find(r))
+            return false;
+
+        m_KernelProofCache.m_vKernel2.push_back(&r);
+        m_KernelProofCache.ScheduleComplete();
+        return true;
+    }
+
+    void Wallet::OnKernelProofCacheTimer()
+    {
+        auto vKernel = std::move(m_KernelProofCache.m_vKernel);
+        auto vKernel2 = std::move(m_KernelProofCache.m_vKernel2);
+        m_KernelProofCache.m_vKernel.clear();
+        m_KernelProofCache.m_vKernel2.clear();
+
+        // the entries might have been dropped by a rollback meanwhile, ask the node then
+        for (const auto& pVal : vKernel)
+        {
+            if (m_KernelProofCache.Find(*pVal))
+                OnRequestComplete(*pVal);
+            else
+            {
+                pVal->m_Res.m_Proof.m_State.m_Height = 0;
+                if (pVal->m_pCallback)
+                    PostReq(*pVal);
+                else
+                    PostReqUnique(*pVal);
+            }
+        }
+
+        for (const auto& pVal : vKernel2)
+        {
+            if (m_KernelProofCache.Find(*pVal))
+                OnRequestComplete(*pVal);
+            else
+            {
+                pVal->m_Res.m_Kernel.reset();
+                PostReqUnique(*pVal);
+            }
+        }
+    }
     {
         r.m_callback(r.m_Msg.m_Id0, r.m_Msg.m_Count, r.m_Res);
     }
@@ -1949,7 +2169,12 @@ namespace beam::wallet
 
         } p(*this);
 
-        uint32_t nCount = p.Proceed(r.m_Res.m_Events);
+        uint32_t nCount;
+        {
+            // there may be thousands of events during the catch-up. DB writes go to the pending transaction anyway, coalesce the notifications too
+            IWalletDB::CoinsBatch cb(*m_WalletDB);
+            nCount = p.Proceed(r.m_Res.m_Events);
+        }
 
         if (nCount < proto::Event::s_Max)
         {
@@ -2098,6 +2323,7 @@ namespace beam::wallet
 
         m_WalletDB->setSystemStateID(id);
         m_WalletDB->get_History().DeleteFrom(sTip.m_Height + 1);
+        m_KernelProofCache.OnRolledBack(sTip.m_Height);
         m_WalletDB->rollbackConfirmedUtxo(sTip.m_Height);
         m_WalletDB->rollbackConfirmedShieldedUtxo(sTip.m_Height);
         m_WalletDB->rollbackAssets(sTip.m_Height);
@@ -2137,6 +2363,14 @@ namespace beam::wallet
         }
     }
 
+    void Wallet::OnEventsNew(Height h)
+    {
+        m_EventsNotified = true;
+        std::setmax(m_hEventsNew, h);
+
+        RequestEvents(); // unless our tip is behind, then it's requested on the new tip
+    }
+
     void Wallet::OnEventsSerif(const Hash::Value& hv, Height h)
     {
         static const char szEvtSerif[] = "EventsSerif";
@@ -2257,7 +2491,8 @@ namespace beam::wallet
         }
 
         RequestBodies();
-        RequestEvents();
+        if (!m_EventsNotified || (m_hEventsNew >= GetEventsHeightNext()))
+            RequestEvents();
         RequestStateSummary();
 
         for (auto& tx : m_NextTipTransactionToUpdate)
@@ -2542,6 +2777,7 @@ namespace beam::wallet
         //
         // Process transaction request
         //
+        ResumePendingOnDemand(msg.m_TxID);
         auto it = m_ActiveTransactions.find(msg.m_TxID);
         if (it != m_ActiveTransactions.end())
         {
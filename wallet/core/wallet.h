@@ -19,6 +19,7 @@
 #include "base_transaction.h"
 #include "core/fly_client.h"
 #include "node/processor.h"
+#include <deque>
 //#include "contracts/shaders_manager.h"
 
 namespace beam::wallet
@@ -214,6 +215,9 @@ namespace beam::wallet
     private:
         void ProcessTransaction(BaseTransaction::Ptr tx);
         void ResumeTransaction(const TxDescription& tx);
+        BaseTransaction::Ptr ResumePending(const TxID& txID);
+        void ResumePendingOnDemand(const TxID& txID);
+        void ResumePendingBatch(bool bInitial);
 
         // INegotiatorGateway
         void OnAsyncStarted() override;
@@ -249,6 +253,7 @@ namespace beam::wallet
         Block::SystemState::IHistory& get_History() override;
         void OnOwnedNode(const PeerID&, bool bUp) override;
         void OnEventsSerif(const ECC::Hash::Value&, Height) override;
+        void OnEventsNew(Height) override;
         void OnNewPeer(const PeerID& id, io::Address address) override;
         void OnDependentStateChanged() override;
 
@@ -531,6 +536,49 @@ namespace beam::wallet
         // List of transactions that are waiting for the next tip (new block) to arrive
         std::unordered_set<BaseTransaction::Ptr> m_NextTipTransactionToUpdate;
 
+        // Kernel proofs already received (and verified by the fly client), by the kernel ID. Transactions ask for them
+        // again on state changes and reconnects, those are answered from here, asynchronously (as if from the node).
+        // Entries that depend on the states above the rollback height are dropped
+        struct KernelProofCache
+        {
+            static const size_t s_MaxSize = 1024;
+
+            struct Entry
+            {
+                TxKernel::LongProof m_Proof; // empty if only the kernel was fetched
+                TxKernel::Ptr m_pKernel; // null if only the proof was requested
+                Height m_hKernel = 0;
+
+                Height get_MaxHeight() const { return std::max(m_Proof.m_State.m_Height, m_hKernel); }
+            };
+
+            std::map<Merkle::Hash, Entry> m_Map;
+
+            std::vector<MyRequestKernel::Ptr> m_vKernel; // to be completed from the cache
+            std::vector<MyRequestKernel2::Ptr> m_vKernel2;
+            io::Timer::Ptr m_pTimer;
+
+            Entry& Insert(const Merkle::Hash&);
+            bool Find(MyRequestKernel&) const;
+            bool Find(MyRequestKernel2&) const;
+            void OnRolledBack(Height);
+            void ScheduleComplete();
+
+            IMPLEMENT_GET_PARENT_OBJ(Wallet, m_KernelProofCache)
+        } m_KernelProofCache;
+
+        bool CompleteFromCache(MyRequestKernel&);
+        bool CompleteFromCache(MyRequestKernel2&);
+        void OnKernelProofCacheTimer();
+
+        // Resumable transactions which are not instantiated yet. On start they're resumed in batches,
+        // the most advanced and recent first, or earlier on demand (i.e. when a peer message arrives)
+        static const uint32_t s_ResumeBatch = 32;
+        static const uint32_t s_ResumeInterval_ms = 100;
+        std::map<TxID, wallet::TxType> m_PendingResume;
+        std::deque<TxID> m_PendingResumeOrder;
+        io::Timer::Ptr m_pResumeTimer;
+
         uint32_t m_HftSubscribed = 0;
 
         // Functor for callback when transaction completed
@@ -545,6 +593,10 @@ namespace beam::wallet
         size_t m_BlocksDone = 0;
         uint32_t m_OwnedNodesOnline;
 
+        // Set once the owned node notifies on new events, the events are not polled on each tip then
+        bool m_EventsNotified = false;
+        Height m_hEventsNew = 0; // the latest tip with the new events
+
         std::vector<IWalletObserver*> m_subscribers;
         ISimpleSwapHandler* m_ssHandler = nullptr;
 
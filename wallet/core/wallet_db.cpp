@@ -108,6 +108,8 @@ namespace fs = std::filesystem;
 #define COIN_CONFIRMATIONS_COUNT "confirmations_count"
 #define EVENTS_NAME "events"
 #define TX_SUMMARY_NAME "tx_summary"
+#define CHANGES_NAME "changes"
+#define TX_ARCHIVE_SCHEMA "archive"
 #define DEX_OFFERS_NAME "dex_offers"
 #define IM_NAME "IM"
 #define LAST_READ_IM_ID "LastReadIMId"
@@ -594,15 +596,15 @@ namespace beam::wallet
         {
             Statement(const WalletDB* db, const char* sql, bool privateDB = false)
                 : _walletDB(nullptr)
+                , _cache(db->m_StatementCache)
                 , _db(privateDB ? db->m_PrivateDB : db->_db)
-                , _stm(nullptr)
+                , _stm(_cache.Acquire(_db, sql))
             {
-                int ret = sqlite3_prepare_v2(_db, sql, -1, &_stm, nullptr);
-                throwIfError(ret, _db);
             }
 
             Statement(WalletDB* db, const char* sql, bool privateDB = false)
                 : _walletDB(db)
+                , _cache(db->m_StatementCache)
                 , _db(privateDB ? db->m_PrivateDB : db->_db)
                 , _stm(nullptr)
             {
@@ -610,8 +612,7 @@ namespace beam::wallet
                 {
                     _walletDB->onPrepareToModify();
                 }
-                int ret = sqlite3_prepare_v2(_db, sql, -1, &_stm, nullptr);
-                throwIfError(ret, _db);
+                _stm = _cache.Acquire(_db, sql);
             }
 
             void Reset()
@@ -954,10 +955,11 @@ namespace beam::wallet
 
             ~Statement()
             {
-                sqlite3_finalize(_stm);
+                _cache.Release(_db, _stm);
             }
         private:
             WalletDB* _walletDB;
+            WalletDB::StatementCache& _cache;
             sqlite3 * _db;
             sqlite3_stmt* _stm;
             std::vector<ByteBuffer> _buffers;
@@ -1020,9 +1022,12 @@ namespace beam::wallet
         constexpr char kNeedToRequestBodies[] = "NeedToRequestBodies";
         constexpr char s_szNextEvt[] = "NextUtxoEvent"; // any event, not just UTXO. The name is for historical reasons
         const uint8_t kDefaultMaxPrivacyLockTimeLimitHours = 72;
+        const Timestamp kCoinReservationTimeout_s = 120; // should be enough to build and tag the tx
         const int BusyTimeoutMs = 5000;
 
-        const int DbVersion   = 39;
+        const int DbVersion   = 41;
+        const int DbVersion40 = 40;
+        const int DbVersion39 = 39;
         const int DbVersion38 = 38;
         const int DbVersion37 = 37;
         const int DbVersion36 = 36;
@@ -1360,6 +1365,27 @@ namespace beam::wallet
             throwIfError(ret, db);
         }
 
+        void CreateTxSummaryListIndexes(sqlite3* db)
+        {
+            // for the list queries: filter + order by time. The PK (TxID) is included, hence they're covering
+            assert(db != nullptr);
+            const char* req =
+                "CREATE INDEX IF NOT EXISTS TxListStatusIndex ON " TX_SUMMARY_NAME "(Status, CreateTime);"
+                "CREATE INDEX IF NOT EXISTS TxListAssetIndex ON " TX_SUMMARY_NAME "(AssetID, CreateTime);"
+                "CREATE INDEX IF NOT EXISTS TxListTypeIndex ON " TX_SUMMARY_NAME "(TransactionType, CreateTime);";
+            const auto ret = sqlite3_exec(db, req, nullptr, nullptr, nullptr);
+            throwIfError(ret, db);
+        }
+
+        void CreateChangesTable(sqlite3* db)
+        {
+            assert(db != nullptr);
+            // AUTOINCREMENT: the revisions are never reused, even after the old ones are trimmed
+            const char* req = "CREATE TABLE IF NOT EXISTS " CHANGES_NAME " (Revision INTEGER PRIMARY KEY AUTOINCREMENT, Type INTEGER NOT NULL, Action INTEGER NOT NULL, Key BLOB NOT NULL);";
+            const auto ret = sqlite3_exec(db, req, nullptr, nullptr, nullptr);
+            throwIfError(ret, db);
+        }
+
         void CreateTxSummaryTable(sqlite3* db)
         {
             assert(db != nullptr);
@@ -1378,6 +1404,8 @@ namespace beam::wallet
                 ;
             const auto ret = sqlite3_exec(db, req, nullptr, nullptr, nullptr);
             throwIfError(ret, db);
+
+            CreateTxSummaryListIndexes(db);
         }
 
         void MigrateAssetsFrom20(sqlite3* db)
@@ -1938,6 +1966,7 @@ namespace beam::wallet
         CreateDexOffersTable(db);
         CreateIMTables(db);
         CreateAppDataTable(db);
+        CreateChangesTable(db);
     }
 
     std::shared_ptr<WalletDB> WalletDB::initBase(const string& path, const SecString& password, bool separateDBForPrivateData)
@@ -2065,6 +2094,10 @@ namespace beam::wallet
         {
             m_pKeyKeeper = std::make_shared<LocalKeyKeeper>(m_pKdfMaster);
             m_pLocalKeyKeeper = &Cast::Up<LocalKeyKeeper>(*m_pKeyKeeper);
+#ifndef __EMSCRIPTEN__
+            // the outputs of big txs are created in parallel, off the wallet thread
+            m_pLocalKeyKeeper->set_WorkerThreads(std::clamp(std::thread::hardware_concurrency() / 2, 1u, 4u));
+#endif // __EMSCRIPTEN__
         }
 
         UpdateLocalSlots();
@@ -2242,6 +2275,12 @@ namespace beam::wallet
             int ret = sqlite3_busy_timeout(walletDB->_db, BusyTimeoutMs);
             throwIfError(ret, walletDB->_db);
         }
+        {
+            // readers (i.e. other processes/tools opening the wallet) don't block the writer, and vice versa
+            int ret = sqlite3_exec(walletDB->_db, "PRAGMA journal_mode=WAL;", nullptr, nullptr, nullptr);
+            throwIfError(ret, walletDB->_db);
+        }
+        walletDB->attachArchive(false); // must be outside of a transaction
         {
             walletDB->InitKeys(pKeyKeeper);
 
@@ -2531,6 +2570,16 @@ namespace beam::wallet
 
                         CreateLaserTables(walletDB->_db);
                     }
+                    // no break
+
+                case DbVersion39:
+                    BEAM_LOG_INFO() << "Converting DB from format 39...";
+                    CreateTxSummaryListIndexes(walletDB->_db);
+                    // no break
+
+                case DbVersion40:
+                    BEAM_LOG_INFO() << "Converting DB from format 40...";
+                    CreateChangesTable(walletDB->_db);
 
                     storage::setVar(*walletDB, Version, DbVersion);
 
@@ -2657,6 +2706,8 @@ namespace beam::wallet
             throwIfError(ret, _db);
         }
 
+        m_CoinIndex.Reset();
+
         if (!IsTableCreated(this, STORAGE_NAME))
         {
             CreateStorageTable(_db);
@@ -2723,6 +2774,7 @@ namespace beam::wallet
                 }
                 m_DbTransaction.reset();
             }
+            m_StatementCache.Clear(); // must be finalized before closing
             BEAM_VERIFY(SQLITE_OK == sqlite3_close(_db));
             if (m_PrivateDB && _db != m_PrivateDB)
             {
@@ -3022,6 +3074,17 @@ namespace beam::wallet
         MyParser p(*this, gateway, prog);
         p.Init(get_OwnerKdf());
 
+#ifndef __EMSCRIPTEN__
+        // recognize utxos in parallel, unless the caller already provides an executor
+        std::unique_ptr<ExecutorMT_R> pExec;
+        std::unique_ptr<Executor::Scope> pScope;
+        if (!Executor::s_pInstance)
+        {
+            pExec = std::make_unique<ExecutorMT_R>();
+            pScope = std::make_unique<Executor::Scope>(*pExec);
+        }
+#endif // __EMSCRIPTEN__
+
         if (p.Proceed(path.c_str()))
         {
             storage::setTreasuryHandled(*this, true);
@@ -3248,23 +3311,25 @@ namespace beam::wallet
         Block::SystemState::ID stateID = {};
         getSystemStateID(stateID);
 
-        {
-            const char* query = "SELECT " STORAGE_FIELDS " FROM " STORAGE_NAME " WHERE maturity>=0 AND maturity<=?1 AND spentHeight<0 ORDER BY amount ASC";
+        if (!m_CoinIndex.m_Valid)
+            buildCoinIndex();
 
-            sqlite::Statement stm(this, query);
-            stm.bind(1, stateID.m_Height);
+        Timestamp tNow = getTimestamp();
 
-            while (stm.step())
+        auto itAsset = m_CoinIndex.m_Map.find(assetId);
+        if (m_CoinIndex.m_Map.end() != itAsset)
+        {
+            // ascending by amount
+            for (const auto& x : itAsset->second)
             {
-                auto& coin = coins.emplace_back();
-                int colIdx = 0;
-                ENUM_ALL_STORAGE_FIELDS(STM_GET_LIST, NOSEP, coin);
+                if ((x.second.m_maturity > stateID.m_Height) || IsCoinReserved(x.first, tNow))
+                    continue;
+
+                auto& coin = coins.emplace_back(x.second);
 
                 storage::DeduceStatus(*this, coin, stateID.m_Height);
                 if (Coin::Status::Available != coin.m_status)
                     coins.pop_back();
-                else if (coin.m_ID.m_AssetID != assetId)
-                    coins.pop_back();
                 else
                 {
                     if (coin.m_ID.m_Value >= amount)
@@ -3292,6 +3357,129 @@ namespace beam::wallet
         return coinsSel;
     }
 
+    bool WalletDB::IsCoinReserved(const Coin::ID& cid, Timestamp tNow) const
+    {
+        auto it = m_CoinReservations.find(cid);
+        return (m_CoinReservations.end() != it) && (it->second.m_Expires > tNow);
+    }
+
+    void WalletDB::reserveCoins(const TxID& txID, const std::vector<Coin::ID>& cids)
+    {
+        Timestamp tNow = getTimestamp();
+
+        for (auto it = m_CoinReservations.begin(); m_CoinReservations.end() != it; )
+        {
+            if (it->second.m_Expires <= tNow)
+                it = m_CoinReservations.erase(it);
+            else
+                ++it;
+        }
+
+        for (const auto& cid : cids)
+        {
+            auto& x = m_CoinReservations[cid];
+            x.m_TxID = txID;
+            x.m_Expires = tNow + kCoinReservationTimeout_s;
+        }
+    }
+
+    void WalletDB::releaseCoins(const TxID& txID)
+    {
+        for (auto it = m_CoinReservations.begin(); m_CoinReservations.end() != it; )
+        {
+            if (it->second.m_TxID == txID)
+                it = m_CoinReservations.erase(it);
+            else
+                ++it;
+        }
+    }
+
+    sqlite3_stmt* WalletDB::StatementCache::Acquire(sqlite3* db, const char* sql)
+    {
+        auto it = m_Map.find(Key(db, sql));
+        if (m_Map.end() != it)
+        {
+            // taken out while in use, nested queries of the same text would prepare their own
+            sqlite3_stmt* stm = it->second;
+            m_Map.erase(it);
+            return stm;
+        }
+
+        sqlite3_stmt* stm = nullptr;
+        int ret = sqlite3_prepare_v2(db, sql, -1, &stm, nullptr);
+        throwIfError(ret, db);
+        return stm;
+    }
+
+    void WalletDB::StatementCache::Release(sqlite3* db, sqlite3_stmt* stm)
+    {
+        if (!stm)
+            return;
+
+        sqlite3_reset(stm);
+        sqlite3_clear_bindings(stm);
+
+        if (m_Map.size() < s_MaxSize)
+        {
+            const char* sql = sqlite3_sql(stm);
+            if (sql && m_Map.emplace(Key(db, sql), stm).second)
+                return;
+        }
+
+        sqlite3_finalize(stm);
+    }
+
+    void WalletDB::StatementCache::Clear()
+    {
+        for (const auto& x : m_Map)
+            sqlite3_finalize(x.second);
+        m_Map.clear();
+    }
+
+    void WalletDB::buildCoinIndex()
+    {
+        m_CoinIndex.Reset();
+
+        const char* query = "SELECT " STORAGE_FIELDS " FROM " STORAGE_NAME " WHERE maturity>=0 AND spentHeight<0";
+        sqlite::Statement stm(this, query);
+
+        while (stm.step())
+        {
+            Coin coin;
+            int colIdx = 0;
+            ENUM_ALL_STORAGE_FIELDS(STM_GET_LIST, NOSEP, coin);
+
+            m_CoinIndex.OnSaved(coin);
+        }
+
+        m_CoinIndex.m_Valid = true;
+    }
+
+    void WalletDB::CoinIndex::Reset()
+    {
+        m_Map.clear();
+        m_Valid = false;
+    }
+
+    void WalletDB::CoinIndex::OnSaved(const Coin& c)
+    {
+        if (IsCandidate(c))
+            m_Map[c.m_ID.m_AssetID][c.m_ID] = c;
+        else
+            OnRemoved(c.m_ID);
+    }
+
+    void WalletDB::CoinIndex::OnRemoved(const Coin::ID& cid)
+    {
+        auto it = m_Map.find(cid.m_AssetID);
+        if (m_Map.end() == it)
+            return;
+
+        it->second.erase(cid);
+        if (it->second.empty())
+            m_Map.erase(it);
+    }
+
     std::vector<Coin> WalletDB::getNormalCoins(Asset::ID assetId) const
     {
         std::vector<Coin> coins;
@@ -3395,6 +3583,9 @@ namespace beam::wallet
         int colIdx = 0;
         ENUM_ALL_STORAGE_FIELDS(STM_BIND_LIST, NOSEP, coin);
         stm.step();
+
+        if (m_CoinIndex.m_Valid)
+            m_CoinIndex.OnSaved(coin);
     }
 
     void WalletDB::insertNewCoin(Coin& coin)
@@ -3418,7 +3609,12 @@ namespace beam::wallet
         ENUM_STORAGE_ID(STM_BIND_LIST, NOSEP, coin);
         stm.step();
 
-        return sqlite3_changes(_db) > 0;
+        if (!sqlite3_changes(_db))
+            return false;
+
+        if (m_CoinIndex.m_Valid)
+            m_CoinIndex.OnSaved(coin);
+        return true;
     }
 
     bool WalletDB::saveCoinRaw(const Coin& coin)
@@ -3506,7 +3702,12 @@ namespace beam::wallet
     void WalletDB::saveCoin(const Coin& coin)
     {
         bool updated = saveCoinRaw(coin);
-        notifyCoinsChanged(updated ? ChangeAction::Updated : ChangeAction::Added, getUpdatedCoins({coin}));
+        auto action = updated ? ChangeAction::Updated : ChangeAction::Added;
+
+        if (m_CoinsBatch.m_Depth)
+            notifyCoinsChanged(action, { coin }); // the status is deduced once the batch ends
+        else
+            notifyCoinsChanged(action, getUpdatedCoins({coin}));
     }
 
     void WalletDB::saveCoins(const vector<Coin>& coins)
@@ -3519,7 +3720,7 @@ namespace beam::wallet
             saveCoinRaw(coin);
         }
 
-        notifyCoinsChanged(ChangeAction::Updated, getUpdatedCoins(coins));
+        notifyCoinsChanged(ChangeAction::Updated, m_CoinsBatch.m_Depth ? coins : getUpdatedCoins(coins));
     }
 
     uint64_t WalletDB::AllocateKidRange(uint64_t nCount)
@@ -3583,12 +3784,16 @@ namespace beam::wallet
         STORAGE_BIND_ID(wrp)
 
         stm.step();
+
+        if (m_CoinIndex.m_Valid)
+            m_CoinIndex.OnRemoved(cid);
     }
 
     void WalletDB::clearCoins()
     {
         sqlite::Statement stm(this, "DELETE FROM " STORAGE_NAME ";");
         stm.step();
+        m_CoinIndex.Reset();
         notifyCoinsChanged(ChangeAction::Reset, {});
     }
 
@@ -3816,8 +4021,15 @@ namespace beam::wallet
                 stm.bind(2, minHeight);
                 stm.step();
             }
- 
-            notifyCoinsChanged(ChangeAction::Updated, getCoinsByRowIDs(changedRows));
+
+            auto vCoins = getCoinsByRowIDs(changedRows);
+            if (m_CoinIndex.m_Valid)
+            {
+                for (const auto& c : vCoins)
+                    m_CoinIndex.OnSaved(c);
+            }
+
+            notifyCoinsChanged(ChangeAction::Updated, vCoins);
         }
     }
 
@@ -4001,7 +4213,11 @@ namespace beam::wallet
         helpers::StopWatch sw;
         sw.start();
 
-        std::string query = "SELECT TxID FROM " TX_SUMMARY_NAME;
+        if (filter.m_Archived && !m_ArchiveAttached)
+            return;
+
+        const std::string sSchema = filter.m_Archived ? TX_ARCHIVE_SCHEMA "." : "";
+        std::string query = "SELECT TxID FROM " + sSchema + TX_SUMMARY_NAME;
         std::vector<std::string> parts;
         std::string whereParams;
 
@@ -4036,16 +4252,62 @@ namespace beam::wallet
                        .append(")");
         }
 
+        if (!filter.m_TransactionTypes.empty())
+        {
+            for (auto t : filter.m_TransactionTypes)
+                parts.push_back(std::to_string((int) t));
+
+            if (!whereParams.empty())
+                whereParams.append(" AND ");
+            whereParams.append("TransactionType IN (")
+                       .append(boost::join(parts, ","))
+                       .append(")");
+            parts.clear();
+        }
+
+        bool bAfter = false;
+        if (filter.m_After)
+        {
+            std::string sReq = "SELECT CreateTime FROM " + sSchema + TX_SUMMARY_NAME " WHERE TxID=?1;";
+            sqlite::Statement stmTime(this, sReq.c_str());
+            stmTime.bind(1, *filter.m_After);
+
+            Timestamp t = 0;
+            if (!stmTime.step())
+                return; // unknown cursor
+
+            stmTime.get(0, t);
+            bAfter = true;
+
+            std::string sTime = std::to_string(t);
+            if (!whereParams.empty())
+                whereParams.append(" AND ");
+            whereParams.append("(CreateTime<").append(sTime)
+                       .append(" OR (CreateTime=").append(sTime).append(" AND TxID<?1))");
+        }
+
         if (!whereParams.empty())
         {
             query.append(" WHERE ");
             query.append(whereParams);
         }
         
-        query.append(" ORDER BY CreateTime DESC");
+        query.append(" ORDER BY CreateTime DESC, TxID DESC");
+
+        if (filter.m_Count || filter.m_Skip)
+        {
+            query.append(" LIMIT ")
+                 .append(filter.m_Count ? std::to_string(filter.m_Count) : "-1")
+                 .append(" OFFSET ")
+                 .append(std::to_string(filter.m_Skip));
+        }
 
         sqlite::Statement stm(this, query.c_str());
-        sqlite::Statement stm2(this, "SELECT * FROM " TX_PARAMS_NAME " WHERE txID=?1;");
+        if (bAfter)
+            stm.bind(1, *filter.m_After);
+
+        std::string sReqParams = "SELECT * FROM " + sSchema + TX_PARAMS_NAME " WHERE txID=?1;";
+        sqlite::Statement stm2(this, sReqParams.c_str());
         TxID txID;
         while (stm.step())
         {
@@ -4141,9 +4403,30 @@ namespace beam::wallet
     boost::optional<TxDescription> WalletDB::getTx(const TxID& txId) const
     {
         // load only simple TX that supported by TxDescription
-        const char* req = "SELECT * FROM " TX_PARAMS_NAME " WHERE txID=?1;";
-        sqlite::Statement stm(this, req);
-        return getTxImpl(txId, stm);
+        return getTxFromParams(txId, loadTxParams(txId));
+    }
+
+    boost::optional<TxDescription> WalletDB::getTxFromParams(const TxID& txId, const TxParamsCache::Entry& entry) const
+    {
+        auto it = entry.m_Params.find(kDefaultSubTxID);
+        if (entry.m_Params.end() == it)
+            return boost::optional<TxDescription>{};
+
+        for (const auto& paramID : m_mandatoryTxParams)
+        {
+            if (!it->second.count(paramID))
+                return boost::optional<TxDescription>{};
+        }
+
+        TxDescription txDescription(txId);
+        for (const auto& [subTxID, params] : entry.m_Params)
+        {
+            for (const auto& [paramID, value] : params)
+                txDescription.SetParameter(paramID, ByteBuffer(value), subTxID);
+        }
+
+        txDescription.fillFromTxParameters(txDescription);
+        return txDescription;
     }
 
     boost::optional<TxDescription> WalletDB::getTxImpl(const TxID& txId, sqlite::Statement& stm) const
@@ -4236,8 +4519,84 @@ namespace beam::wallet
         }
     }
 
+    bool WalletDB::attachArchive(bool bCreate)
+    {
+        if (m_ArchiveAttached)
+            return true;
+
+        const char* szMain = sqlite3_db_filename(_db, "main");
+        if (!szMain || !*szMain)
+            return false; // in-memory db
+
+        std::string sPath = std::string(szMain) + "." TX_ARCHIVE_SCHEMA;
+        if (!bCreate && !isInitialized(sPath))
+            return false;
+
+        {
+            // encrypted with the key of the main db
+            sqlite::Statement stm(this, "ATTACH DATABASE ?1 AS " TX_ARCHIVE_SCHEMA ";");
+            stm.bind(1, sPath);
+            stm.step();
+        }
+
+#define MACRO(id, type) "," #id " INTEGER"
+        const char* req =
+            "CREATE TABLE IF NOT EXISTS " TX_ARCHIVE_SCHEMA "." TX_PARAMS_NAME " (" ENUM_TX_PARAMS_FIELDS(LIST_WITH_TYPES, COMMA, ) ", PRIMARY KEY (txID, subTxID, paramID)) WITHOUT ROWID;"
+            "CREATE TABLE IF NOT EXISTS " TX_ARCHIVE_SCHEMA "." TX_SUMMARY_NAME " (TxID BLOB NOT NULL PRIMARY KEY " ENUM_TX_SUMMARY_FIELDS(MACRO) ") WITHOUT ROWID;"
+            "CREATE INDEX IF NOT EXISTS " TX_ARCHIVE_SCHEMA ".TxListArchiveIndex ON " TX_SUMMARY_NAME " (CreateTime);";
+#undef MACRO
+
+        int ret = sqlite3_exec(_db, req, nullptr, nullptr, nullptr);
+        throwIfError(ret, _db);
+
+        m_ArchiveAttached = true;
+        return true;
+    }
+
+    uint32_t WalletDB::archiveTransactions(Height hBelow)
+    {
+        flushDB(); // ATTACH is not allowed within a transaction
+        if (!attachArchive(true))
+            return 0;
+
+        onPrepareToModify();
+
+#define MACRO(id, type) "," #id
+        const char* szSummaryFields = "TxID" ENUM_TX_SUMMARY_FIELDS(MACRO);
+#undef MACRO
+
+        std::string sWhere = " WHERE Status=" + std::to_string((int) TxStatus::Completed) + " AND KernelProofHeight<" + std::to_string(hBelow);
+        std::string sSelectIDs = "SELECT TxID FROM main." TX_SUMMARY_NAME + sWhere;
+
+        std::string req =
+            "INSERT OR REPLACE INTO " TX_ARCHIVE_SCHEMA "." TX_PARAMS_NAME " (" TX_PARAMS_FIELDS ") SELECT " TX_PARAMS_FIELDS " FROM main." TX_PARAMS_NAME
+            " WHERE txID IN (" + sSelectIDs + ");"
+            "INSERT OR REPLACE INTO " TX_ARCHIVE_SCHEMA "." TX_SUMMARY_NAME " (" + szSummaryFields + ") SELECT " + szSummaryFields + " FROM main." TX_SUMMARY_NAME + sWhere + ";"
+            // same as deleteTx: leave the tx type, to avoid re-launching of the archived tx
+            "DELETE FROM main." TX_PARAMS_NAME " WHERE paramID!=" + std::to_string((int) TxParameterID::TransactionType) + " AND txID IN (" + sSelectIDs + ");";
+
+        int ret = sqlite3_exec(_db, req.c_str(), nullptr, nullptr, nullptr);
+        throwIfError(ret, _db);
+
+        // archived txs leave the active list
+        req = "INSERT INTO main." CHANGES_NAME " (Type, Action, Key) SELECT " + std::to_string((int) ChangeLogEntry::Type::Tx) + "," + std::to_string((int) ChangeAction::Removed) + ",TxID FROM main." TX_SUMMARY_NAME + sWhere + ";"
+            "DELETE FROM main." TX_SUMMARY_NAME + sWhere;
+        ret = sqlite3_exec(_db, req.c_str(), nullptr, nullptr, nullptr);
+        throwIfError(ret, _db);
+
+        uint32_t nCount = static_cast<uint32_t>(sqlite3_changes(_db));
+
+        m_TxParametersCache.Clear();
+        onModified();
+
+        BEAM_LOG_INFO() << "Archived txs: " << nCount;
+        return nCount;
+    }
+
     void WalletDB::restoreCoinsSpentByTx(const TxID& txId)
     {
+        releaseCoins(txId);
+
         std::vector<int> updatedRows;
         {
             const char* req = "SELECT rowid FROM " STORAGE_NAME " WHERE spentTxId=?1;";
@@ -4257,7 +4616,15 @@ namespace beam::wallet
                 stm.bind(1, txId);
                 stm.step();
             }
-            notifyCoinsChanged(ChangeAction::Updated, getCoinsByRowIDs(updatedRows));
+
+            auto vCoins = getCoinsByRowIDs(updatedRows);
+            if (m_CoinIndex.m_Valid)
+            {
+                for (const auto& c : vCoins)
+                    m_CoinIndex.OnSaved(c);
+            }
+
+            notifyCoinsChanged(ChangeAction::Updated, vCoins);
         }
     }
 
@@ -4284,6 +4651,12 @@ namespace beam::wallet
             stm.bind(2, MaxHeight);
             stm.step();
 
+            if (m_CoinIndex.m_Valid)
+            {
+                for (const auto& c : deletedItems)
+                    m_CoinIndex.OnRemoved(c.m_ID);
+            }
+
             notifyCoinsChanged(ChangeAction::Removed, deletedItems);
         }
     }
@@ -5489,29 +5862,13 @@ namespace beam::wallet
 
     bool WalletDB::setTxParameter(const TxID& txID, SubTxID subTxID, TxParameterID paramID, const ByteBuffer& blob, bool shouldNotifyAboutChanges, bool allowModify /* = true */)
     {
-        if (auto txIter = m_TxParametersCache.find(txID); txIter != m_TxParametersCache.end())
-        {
-            if (auto subTxIter = txIter->second.find(subTxID); subTxIter != txIter->second.end())
-            {
-                if (auto pit = subTxIter->second.find(paramID); pit != subTxIter->second.end())
-                {
-                    if (pit->second && blob == *(pit->second))
-                    {
-                        return false;
-                    }
-                }
-            }
-        }
+        const ByteBuffer* pPrev = loadTxParams(txID).Find(subTxID, paramID);
+        if (pPrev && (blob == *pPrev))
+            return false;
 
         bool hasTx = hasTransaction(txID);
         {
-            sqlite::Statement stm(this, "SELECT * FROM " TX_PARAMS_NAME " WHERE txID=?1 AND subTxID=?2 AND paramID=?3;");
-
-            stm.bind(1, txID);
-            stm.bind(2, subTxID);
-            stm.bind(3, paramID);
-
-            if (stm.step())
+            if (pPrev)
             {
                 // already set
                 if (!allowModify)
@@ -5524,6 +5881,8 @@ namespace beam::wallet
                 stm2.bind(4, blob);
                 stm2.step();
 
+                loadTxParams(txID).m_Params[subTxID][paramID] = blob;
+
                 if (shouldNotifyAboutChanges)
                 {
                     auto tx = getTx(txID);
@@ -5533,7 +5892,6 @@ namespace beam::wallet
                     }
                 }
 
-                insertParameterToCache(txID, subTxID, paramID, blob);
                 OnTxSummaryParam(txID, subTxID, paramID, &blob);
                 return true;
             }
@@ -5548,6 +5906,9 @@ namespace beam::wallet
         int colIdx = 0;
         ENUM_TX_PARAMS_FIELDS(STM_BIND_LIST, NOSEP, parameter);
         stm.step();
+
+        loadTxParams(txID).m_Params[subTxID][paramID] = blob;
+
         if (shouldNotifyAboutChanges)
         {
             auto tx = getTx(txID);
@@ -5557,7 +5918,6 @@ namespace beam::wallet
             }
         }
 
-        insertParameterToCache(txID, subTxID, paramID, blob);
         OnTxSummaryParam(txID, subTxID, paramID, &blob);
         return true;
     }
@@ -5651,14 +6011,13 @@ namespace beam::wallet
 
     bool WalletDB::delTxParameter(const TxID& txID, SubTxID subTxID, TxParameterID paramID)
     {
-        if (auto txIter = m_TxParametersCache.find(txID); txIter != m_TxParametersCache.end())
+        if (auto pEntry = m_TxParametersCache.Find(txID))
         {
-            if (auto subTxIter = txIter->second.find(subTxID); subTxIter != txIter->second.end())
+            if (auto it = pEntry->m_Params.find(subTxID); pEntry->m_Params.end() != it)
             {
-                if (auto pit = subTxIter->second.find(paramID); pit != subTxIter->second.end())
-                {
-                    subTxIter->second.erase(pit);
-                }
+                it->second.erase(paramID);
+                if (it->second.empty())
+                    pEntry->m_Params.erase(it);
             }
         }
 
@@ -5677,41 +6036,12 @@ namespace beam::wallet
 
     bool WalletDB::getTxParameter(const TxID& txID, SubTxID subTxID, TxParameterID paramID, ByteBuffer& blob) const
     {
-        if (auto txIter = m_TxParametersCache.find(txID); txIter != m_TxParametersCache.end())
-        {
-            if (auto subTxIter = txIter->second.find(subTxID); subTxIter != txIter->second.end())
-            {
-                if (auto pit = subTxIter->second.find(paramID); pit != subTxIter->second.end())
-                {
-                    if (pit->second)
-                    {
-                        blob = *(pit->second);
-                        return true;
-                    }
-                    return false;
-                }
-            }
-        }
-
-        sqlite::Statement stm(this, "SELECT value FROM " TX_PARAMS_NAME " WHERE txID=?1 AND subTxID=?2 AND paramID=?3;");
-        return getTxParameterImpl(txID, subTxID, paramID, blob, stm);
-    }
-
-    bool WalletDB::getTxParameterImpl(const TxID& txID, SubTxID subTxID, TxParameterID paramID, ByteBuffer& blob, sqlite::Statement& stm) const
-    {
-        stm.Reset();
-        stm.bind(1, txID);
-        stm.bind(2, subTxID);
-        stm.bind(3, paramID);
+        const ByteBuffer* pVal = loadTxParams(txID).Find(subTxID, paramID);
+        if (!pVal)
+            return false;
 
-        if (stm.step())
-        {
-            stm.get(0, blob);
-            insertParameterToCache(txID, subTxID, paramID, blob);
-            return true;
-        }
-        insertParameterToCache(txID, subTxID, paramID, boost::optional<ByteBuffer>());
-        return false;
+        blob = *pVal;
+        return true;
     }
 
     std::vector<TxParameter> WalletDB::getAllTxParameters() const
@@ -5723,11 +6053,6 @@ namespace beam::wallet
             auto& p = res.emplace_back();
             int colIdx = 0;
             ENUM_TX_PARAMS_FIELDS(STM_GET_LIST, NOSEP, p);
-            insertParameterToCache(
-				p.m_txID,
-				static_cast<SubTxID>(p.m_subTxID),
-				static_cast<TxParameterID>(p.m_paramID),
-				p.m_value);
         }
         return res;
     }
@@ -5755,14 +6080,81 @@ namespace beam::wallet
         return get_EffectiveEndpointEx(txID, subTxID, res, TxParameterID::MyEndpoint, TxParameterID::MyAddr);
     }
 
-    void WalletDB::insertParameterToCache(const TxID& txID, SubTxID subTxID, TxParameterID paramID, const boost::optional<ByteBuffer>& blob) const
+    const ByteBuffer* WalletDB::TxParamsCache::Entry::Find(SubTxID subTxID, TxParameterID paramID) const
     {
-        m_TxParametersCache[txID][subTxID][paramID] = blob;
+        auto it = m_Params.find(subTxID);
+        if (m_Params.end() == it)
+            return nullptr;
+
+        auto it2 = it->second.find(paramID);
+        return (it->second.end() == it2) ? nullptr : &it2->second;
+    }
+
+    WalletDB::TxParamsCache::Entry* WalletDB::TxParamsCache::Find(const TxID& txID)
+    {
+        auto it = m_Map.find(txID);
+        if (m_Map.end() == it)
+            return nullptr;
+
+        Entry& entry = it->second;
+        m_Lru.splice(m_Lru.begin(), m_Lru, entry.m_itLru);
+        return &entry;
+    }
+
+    WalletDB::TxParamsCache::Entry& WalletDB::TxParamsCache::Insert(const TxID& txID)
+    {
+        while (m_Map.size() >= s_MaxSize)
+        {
+            m_Map.erase(m_Lru.back());
+            m_Lru.pop_back();
+        }
+
+        Entry& entry = m_Map[txID];
+        m_Lru.push_front(txID);
+        entry.m_itLru = m_Lru.begin();
+        return entry;
+    }
+
+    void WalletDB::TxParamsCache::Erase(const TxID& txID)
+    {
+        auto it = m_Map.find(txID);
+        if (m_Map.end() != it)
+        {
+            m_Lru.erase(it->second.m_itLru);
+            m_Map.erase(it);
+        }
+    }
+
+    void WalletDB::TxParamsCache::Clear()
+    {
+        m_Map.clear();
+        m_Lru.clear();
+    }
+
+    WalletDB::TxParamsCache::Entry& WalletDB::loadTxParams(const TxID& txID) const
+    {
+        if (auto pEntry = m_TxParametersCache.Find(txID))
+            return *pEntry;
+
+        TxParamsCache::Entry& entry = m_TxParametersCache.Insert(txID);
+
+        sqlite::Statement stm(this, "SELECT subTxID, paramID, value FROM " TX_PARAMS_NAME " WHERE txID=?1;");
+        stm.bind(1, txID);
+
+        while (stm.step())
+        {
+            int subTxID = 0, paramID = 0;
+            stm.get(0, subTxID);
+            stm.get(1, paramID);
+            stm.get(2, entry.m_Params[static_cast<SubTxID>(subTxID)][static_cast<TxParameterID>(paramID)]);
+        }
+
+        return entry;
     }
 
     void WalletDB::deleteParametersFromCache(const TxID& txID)
     {
-        m_TxParametersCache.erase(txID);
+        m_TxParametersCache.Erase(txID);
     }
 
     bool WalletDB::hasTransaction(const TxID& txID) const
@@ -5802,6 +6194,9 @@ namespace beam::wallet
             m_DbTransaction->rollback();
             m_DbTransaction.reset();
         }
+
+        m_CoinIndex.Reset(); // may be ahead of the DB now
+        m_TxParametersCache.Clear();
     }
 
     void WalletDB::onModified()
@@ -5832,8 +6227,12 @@ namespace beam::wallet
 #ifdef __EMSCRIPTEN__
             if (get_MasterKdf()) // dont do sync for headless wallet
             {
+                // the web client stores the dirty pages only, batched
                 MAIN_THREAD_ASYNC_EM_ASM(
-                    FS.syncfs(false, function() {});
+                    if (Module.BeamPageStore)
+                        Module.BeamPageStore.schedule();
+                    else
+                        FS.syncfs(false, function() {});
                 );
             }
 #endif
@@ -5848,11 +6247,73 @@ namespace beam::wallet
         }
     }
 
+    void WalletDB::beginCoinsBatch()
+    {
+        m_CoinsBatch.m_Depth++;
+    }
+
+    void WalletDB::endCoinsBatch()
+    {
+        assert(m_CoinsBatch.m_Depth);
+        if (--m_CoinsBatch.m_Depth)
+            return;
+
+        CoinsBatchState cbs;
+        std::swap(cbs, m_CoinsBatch);
+
+        if (cbs.m_Reset)
+        {
+            notifyCoinsChanged(ChangeAction::Reset, {});
+            notifyShieldedCoinsChanged(ChangeAction::Reset, {});
+        }
+
+        const ChangeAction pOrder[] = { ChangeAction::Added, ChangeAction::Updated, ChangeAction::Removed };
+        for (auto action : pOrder)
+        {
+            auto& vCoins = cbs.m_pCoins[(int) action];
+
+            // the same coin may be reported several times, keep the last
+            std::map<Coin::ID, size_t, CoinIndex::Cmp> mapLast;
+            for (size_t i = 0; i < vCoins.size(); i++)
+                mapLast[vCoins[i].m_ID] = i;
+
+            vector<Coin> vRes;
+            vRes.reserve(mapLast.size());
+            for (size_t i = 0; i < vCoins.size(); i++)
+                if (mapLast[vCoins[i].m_ID] == i)
+                    vRes.push_back(std::move(vCoins[i]));
+
+            if (ChangeAction::Removed != action)
+                vRes = getUpdatedCoins(vRes); // status as of now
+
+            notifyCoinsChanged(action, vRes);
+            notifyShieldedCoinsChanged(action, cbs.m_pShielded[(int) action]);
+        }
+    }
+
     void WalletDB::notifyCoinsChanged(ChangeAction action, const vector<Coin>& items)
     {
         if (items.empty() && action != ChangeAction::Reset)
             return;
 
+        if (m_CoinsBatch.m_Depth)
+        {
+            if (ChangeAction::Reset == action)
+            {
+                for (auto& v : m_CoinsBatch.m_pCoins)
+                    v.clear();
+                m_CoinsBatch.m_Reset = true;
+            }
+            else
+            {
+                auto& v = m_CoinsBatch.m_pCoins[(int) action];
+                v.insert(v.end(), items.begin(), items.end());
+            }
+            return;
+        }
+
+        logChanges(ChangeLogEntry::Type::Coin, action, items, [](const Coin& c) { return toByteBuffer(c.m_ID); });
+
         for (const auto sub : m_subscribers)
         {
             sub->onCoinsChanged(action, items);
@@ -5864,6 +6325,8 @@ namespace beam::wallet
         if (items.empty() && action != ChangeAction::Reset)
             return;
 
+        logChanges(ChangeLogEntry::Type::Tx, action, items, [](const TxDescription& tx) { return ByteBuffer(tx.m_txId.begin(), tx.m_txId.end()); });
+
         for (const auto sub : m_subscribers)
         {
             sub->onTransactionChanged(action, items);
@@ -5885,6 +6348,8 @@ namespace beam::wallet
         if (items.empty() && action != ChangeAction::Reset)
             return;
 
+        logChanges(ChangeLogEntry::Type::Address, action, items, [](const WalletAddress& a) { return ByteBuffer(a.m_Token.begin(), a.m_Token.end()); });
+
         for (const auto sub : m_subscribers)
         {
             sub->onAddressChanged(action, items);
@@ -5896,12 +6361,106 @@ namespace beam::wallet
         if (items.empty() && action != ChangeAction::Reset)
             return;
 
+        if (m_CoinsBatch.m_Depth)
+        {
+            if (ChangeAction::Reset == action)
+            {
+                for (auto& v : m_CoinsBatch.m_pShielded)
+                    v.clear();
+                m_CoinsBatch.m_Reset = true;
+            }
+            else
+            {
+                auto& v = m_CoinsBatch.m_pShielded[(int) action];
+                v.insert(v.end(), items.begin(), items.end());
+            }
+            return;
+        }
+
+        logChanges(ChangeLogEntry::Type::ShieldedCoin, action, items, [](const ShieldedCoin& c) { return toByteBuffer(c.m_TxoID); });
+
         for (const auto sub : m_subscribers)
         {
             sub->onShieldedCoinsChanged(action, items);
         }
     }
 
+    template <typename T, typename TGetKey>
+    void WalletDB::logChanges(ChangeLogEntry::Type type, ChangeAction action, const std::vector<T>& items, TGetKey&& getKey)
+    {
+        if (ChangeAction::Reset == action)
+        {
+            logChange(type, action, {});
+            return;
+        }
+
+        for (const auto& item : items)
+        {
+            logChange(type, action, getKey(item));
+        }
+    }
+
+    void WalletDB::logChange(ChangeLogEntry::Type type, ChangeAction action, const ByteBuffer& key)
+    {
+        {
+            const char* req = "INSERT INTO " CHANGES_NAME " (Type, Action, Key) VALUES(?1, ?2, ?3);";
+            sqlite::Statement stm(this, req);
+            stm.bind(1, type);
+            stm.bind(2, action);
+            stm.bind(3, Blob(key));
+            stm.step();
+        }
+
+        if (++m_ChangesSinceTrim < s_ChangesTrimPeriod)
+            return;
+        m_ChangesSinceTrim = 0;
+
+        auto rev = static_cast<uint64_t>(sqlite3_last_insert_rowid(_db));
+        if (rev > s_ChangesMax)
+        {
+            const char* req = "DELETE FROM " CHANGES_NAME " WHERE Revision<=?1;";
+            sqlite::Statement stm(this, req);
+            stm.bind(1, rev - s_ChangesMax);
+            stm.step();
+        }
+    }
+
+    void WalletDB::getChangesRange(uint64_t& oldest, uint64_t& latest) const
+    {
+        oldest = latest = 0;
+        {
+            // the last issued revision survives the trimming
+            sqlite::Statement stm(this, "SELECT seq FROM sqlite_sequence WHERE name='" CHANGES_NAME "';");
+            if (stm.step())
+                stm.get(0, latest);
+        }
+        {
+            sqlite::Statement stm(this, "SELECT MIN(Revision) FROM " CHANGES_NAME ";");
+            if (stm.step() && !stm.IsNull(0))
+                stm.get(0, oldest);
+            else
+                oldest = latest + 1; // nothing is kept
+        }
+    }
+
+    void WalletDB::visitChanges(uint64_t after, std::function<bool(const ChangeLogEntry&)> func) const
+    {
+        sqlite::Statement stm(this, "SELECT Revision, Type, Action, Key FROM " CHANGES_NAME " WHERE Revision>?1 ORDER BY Revision;");
+        stm.bind(1, after);
+
+        ChangeLogEntry entry;
+        while (stm.step())
+        {
+            stm.get(0, entry.m_Revision);
+            stm.get(1, entry.m_Type);
+            stm.get(2, entry.m_Action);
+            stm.get(3, entry.m_Key);
+
+            if (!func(entry))
+                break;
+        }
+    }
+
     Block::SystemState::IHistory& WalletDB::get_History()
     {
         return m_History;
@@ -5912,7 +6471,8 @@ namespace beam::wallet
         Block::SystemState::Full s;
         if (m_History.get_Tip(s))
         {
-            const Height hMaxBacklog = Rules::get().MaxRollback * 2; // can actually be more
+            // with the shared history only a short window is kept, enough to tell the own branch
+            const Height hMaxBacklog = m_pSharedHistory ? 64 : Rules::get().MaxRollback * 2; // can actually be more
 
             if (s.m_Height > hMaxBacklog)
             {
@@ -6036,6 +6596,29 @@ namespace beam::wallet
         }
     }
 
+    void WalletDB::setSharedHistory(SharedHistory::Ptr pShared)
+    {
+        m_pSharedHistory = std::move(pShared);
+        if (!m_pSharedHistory)
+            return;
+
+        // publish what we have, the other wallets may be behind
+        struct Walker :public Block::SystemState::IHistory::IWalker
+        {
+            std::vector<Block::SystemState::Full> m_vStates;
+
+            bool OnState(const Block::SystemState::Full& s) override
+            {
+                m_vStates.push_back(s);
+                return true;
+            }
+        } w;
+
+        m_History.Enum(w, nullptr);
+        std::reverse(w.m_vStates.begin(), w.m_vStates.end());
+        m_pSharedHistory->AddStates(w.m_vStates.data(), w.m_vStates.size());
+    }
+
     bool WalletDB::History::Enum(IWalker& w, const Height* pBelow)
     {
         const char* req = pBelow ?
@@ -6056,24 +6639,43 @@ namespace beam::wallet
                 return false;
         }
 
-        return true;
+        // continue with the shared states below the own window
+        Height hLink = get_SharedLink();
+        if (!hLink)
+            return true;
+
+        return get_ParentObj().m_pSharedHistory->Enum(w, pBelow ? std::min(*pBelow, hLink) : hLink);
     }
 
     bool WalletDB::History::get_At(Block::SystemState::Full& s, Height h)
     {
-        const char* req = "SELECT " TblStates_Hdr " FROM " TblStates " WHERE " TblStates_Height "=?";
+        {
+            const char* req = "SELECT " TblStates_Hdr " FROM " TblStates " WHERE " TblStates_Height "=?";
 
-        sqlite::Statement stm(&get_ParentObj(), req);
-        stm.bind(1, h);
+            sqlite::Statement stm(&get_ParentObj(), req);
+            stm.bind(1, h);
 
-        if (!stm.step())
-            return false;
+            if (stm.step())
+            {
+                stm.get(0, s);
+                return true;
+            }
+        }
 
-        stm.get(0, s);
-        return true;
+        Height hLink = get_SharedLink();
+        return (h < hLink) && get_ParentObj().m_pSharedHistory->get_At(s, h);
     }
 
     void WalletDB::History::AddStates(const Block::SystemState::Full* pS, size_t nCount)
+    {
+        InsertStates(pS, nCount);
+
+        auto& pShared = get_ParentObj().m_pSharedHistory;
+        if (pShared)
+            pShared->AddStates(pS, nCount);
+    }
+
+    void WalletDB::History::InsertStates(const Block::SystemState::Full* pS, size_t nCount)
     {
         const char* req = "INSERT OR REPLACE INTO " TblStates " (" TblStates_Height "," TblStates_Hdr ") VALUES(?,?)";
         sqlite::Statement stm(&get_ParentObj(), req);
@@ -6091,10 +6693,111 @@ namespace beam::wallet
 
     void WalletDB::History::DeleteFrom(Height h)
     {
-        const char* req = "DELETE FROM " TblStates " WHERE " TblStates_Height ">=?";
+        // The own window may be shorter than the rollback. Keep the new tip then, it's known from the shared history
+        Block::SystemState::Full sTip;
+        bool bKeepTip =
+            get_ParentObj().m_pSharedHistory &&
+            (h > Rules::HeightGenesis) &&
+            !HasStatesBelow(h) &&
+            get_At(sTip, h - 1);
+
+        {
+            const char* req = "DELETE FROM " TblStates " WHERE " TblStates_Height ">=?";
+            sqlite::Statement stm(&get_ParentObj(), req);
+            stm.bind(1, h);
+            stm.step();
+        }
+
+        if (bKeepTip)
+            InsertStates(&sTip, 1);
+    }
+
+    bool WalletDB::History::HasStatesBelow(Height h) const
+    {
+        const char* req = "SELECT " TblStates_Height " FROM " TblStates " WHERE " TblStates_Height "<? LIMIT 1";
         sqlite::Statement stm(&get_ParentObj(), req);
         stm.bind(1, h);
-        stm.step();
+        return stm.step();
+    }
+
+    Height WalletDB::History::get_SharedLink() const
+    {
+        // The shared states below the own window belong to our branch if the shared history
+        // passes through our lowest state. Returns the height of that state, or 0
+        auto& pShared = get_ParentObj().m_pSharedHistory;
+        if (!pShared)
+            return 0;
+
+        Block::SystemState::Full sLow, sShared;
+        {
+            const char* req = "SELECT " TblStates_Hdr " FROM " TblStates " ORDER BY " TblStates_Height " ASC LIMIT 1";
+            sqlite::Statement stm(&get_ParentObj(), req);
+            if (!stm.step())
+                return 0;
+
+            stm.get(0, sLow);
+        }
+
+        if (!pShared->get_At(sShared, sLow.m_Height) || (sShared != sLow))
+            return 0;
+
+        return sLow.m_Height;
+    }
+
+    bool SharedHistory::get_At(Block::SystemState::Full& s, Height h) const
+    {
+        std::unique_lock lock(m_Mutex);
+        return m_Map.get_At(s, h);
+    }
+
+    bool SharedHistory::Enum(Block::SystemState::IHistory::IWalker& w, Height hBelow) const
+    {
+        std::unique_lock lock(m_Mutex);
+        return m_Map.Enum(w, &hBelow);
+    }
+
+    void SharedHistory::AddStates(const Block::SystemState::Full* pS, size_t nCount)
+    {
+        std::unique_lock lock(m_Mutex);
+
+        for (size_t i = 0; i < nCount; i++)
+            AddStateInternal(pS[i]);
+
+        m_Map.ShrinkToWindow(Rules::get().MaxRollback * 2);
+    }
+
+    void SharedHistory::AddStateInternal(const Block::SystemState::Full& s)
+    {
+        auto& m = m_Map.m_Map;
+        if (!m.empty())
+        {
+            Height h0 = m.begin()->first;
+            Height h1 = m.rbegin()->first;
+
+            if ((s.m_Height + 1 < h0) || (s.m_Height > h1 + 1))
+                m.clear(); // not adjacent
+            else if (s.m_Height + 1 == h0)
+            {
+                if (!s.IsNext(m.begin()->second))
+                    return; // another branch, ignore
+            }
+            else
+            {
+                if (s.m_Height <= h1)
+                {
+                    if (m[s.m_Height] == s)
+                        return; // already known
+
+                    m_Map.DeleteFrom(s.m_Height); // the rest is from the replaced branch
+                }
+
+                auto it = m.find(s.m_Height - 1);
+                if ((m.end() != it) && !it->second.IsNext(s))
+                    m.clear(); // the branches diverge deeper, drop the old one
+            }
+        }
+
+        m[s.m_Height] = s;
     }
 
     bool WalletDB::get_AppData(const Blob& name, const Blob& key, ByteBuffer& res)
@@ -26,6 +26,8 @@
 #endif
 
 #include <tuple>
+#include <list>
+#include <mutex>
 #include "core/common.h"
 #include "core/ecc_native.h"
 #include "common.h"
@@ -43,6 +45,7 @@
 #include <string>
 
 struct sqlite3;
+struct sqlite3_stmt;
 
 namespace beam::wallet
 {
@@ -254,6 +257,15 @@ namespace beam::wallet
 #define MACRO(id, type) boost::optional<type> m_##id;
         BEAM_TX_LIST_FILTER_MAP(MACRO)
 #undef MACRO
+        std::vector<TxType> m_TransactionTypes; // any of, if not empty
+
+        // The txs are visited in the descending (CreateTime, TxID) order.
+        // m_After: keyset pagination, continue after this tx (the last one of the previous page)
+        boost::optional<TxID> m_After;
+        uint32_t m_Skip = 0;
+        uint32_t m_Count = 0; // 0 = unlimited
+
+        bool m_Archived = false; // visit the archived txs (see IWalletDB::archiveTransactions) instead of the active ones
     };
 
     struct IWalletDB;
@@ -355,6 +367,42 @@ namespace beam::wallet
         Reset
     };
 
+    // An entry of the persistent changes feed, see IWalletDB::visitChanges
+    struct ChangeLogEntry
+    {
+        enum struct Type
+        {
+            Coin,
+            ShieldedCoin,
+            Tx,
+            Address
+        };
+
+        uint64_t m_Revision = 0;
+        Type m_Type = Type::Coin;
+        ChangeAction m_Action = ChangeAction::Updated;
+        ByteBuffer m_Key; // serialized Coin::ID or TxoID, raw TxID or address token. Empty for Reset
+    };
+
+    // Block headers shared by several wallets of one process that follow the same node.
+    // Each wallet keeps only a short window of its own, the deeper states are looked up here.
+    // Always holds a contiguous chain of the most recently reported branch.
+    class SharedHistory
+    {
+    public:
+        using Ptr = std::shared_ptr<SharedHistory>;
+
+        bool get_At(Block::SystemState::Full&, Height) const;
+        bool Enum(Block::SystemState::IHistory::IWalker&, Height hBelow) const;
+        void AddStates(const Block::SystemState::Full*, size_t nCount);
+
+    private:
+        void AddStateInternal(const Block::SystemState::Full&);
+
+        mutable std::mutex m_Mutex;
+        mutable Block::SystemState::HistoryMap m_Map;
+    };
+
     struct InstantMessage
     {
         uint32_t m_id;
@@ -490,6 +538,11 @@ namespace beam::wallet
         // Uses greedy algorithm up to a point and follows by some heuristics
         virtual void selectCoins2(Height, Amount amount, Asset::ID, std::vector<Coin>&, std::vector<ShieldedCoin>&, uint32_t nMaxShielded, bool bCanReturnLess) = 0;
 
+        // Optimistic in-memory reservation of the selected coins, until the tx tags them (spentTxId), or the reservation expires.
+        // Coins reserved by any tx are skipped by the selection, so that the transactions being built concurrently get disjoint inputs
+        virtual void reserveCoins(const TxID&, const std::vector<Coin::ID>&) {}
+        virtual void releaseCoins(const TxID&) {}
+
         // Some getters to get lists of coins by some input parameters
         virtual std::vector<Coin> getCoinsCreatedByTx(const TxID& txId) const = 0;
         virtual std::vector<Coin> getCoinsByTx(const TxID& txId) const = 0;
@@ -545,6 +598,15 @@ namespace beam::wallet
         virtual boost::optional<TxDescription> getTx(const TxID& txId) const = 0;
         virtual void saveTx(const TxDescription& p) = 0;
         virtual void deleteTx(const TxID& txId) = 0;
+        // Moves the completed txs with the kernel proof below the given height to the archive db (a separate file next to the wallet db).
+        // Archived txs are only visible via visitTx with TxListFilter::m_Archived. Returns the number of archived txs
+        virtual uint32_t archiveTransactions(Height hBelow) { return 0; }
+
+        // Changes feed. Every change of coins, txs & addresses gets the next revision (never reused).
+        // Only the recent changes are kept, revisions below 'oldest' are gone: the client must reload everything.
+        virtual void getChangesRange(uint64_t& oldest, uint64_t& latest) const { oldest = latest = 0; }
+        // Visits the changes with the revision above 'after', in order, while func returns true
+        virtual void visitChanges(uint64_t after, std::function<bool(const ChangeLogEntry&)> func) const {}
         virtual bool setTxParameter(const TxID& txID, SubTxID subTxID, TxParameterID paramID,
             const ByteBuffer& blob, bool shouldNotifyAboutChanges, bool allowModify = true) = 0;
         virtual bool delTxParameter(const TxID& txID, SubTxID subTxID, TxParameterID paramID) = 0;
@@ -586,11 +648,23 @@ namespace beam::wallet
         virtual void Subscribe(IWalletDbObserver* observer) = 0;
         virtual void Unsubscribe(IWalletDbObserver* observer) = 0;
 
+        // Coin notifications are coalesced and delivered once the outermost batch ends (i.e. for bulk event processing)
+        virtual void beginCoinsBatch() {}
+        virtual void endCoinsBatch() {}
+
+        struct CoinsBatch
+        {
+            IWalletDB& m_DB;
+            CoinsBatch(IWalletDB& db) :m_DB(db) { m_DB.beginCoinsBatch(); }
+            ~CoinsBatch() { m_DB.endCoinsBatch(); }
+        };
+
         virtual void changePassword(const SecString& password) = 0;
 
         // Block History management, used in FlyClient
         virtual Block::SystemState::IHistory& get_History() = 0;
         virtual void ShrinkHistory() = 0;
+        virtual void setSharedHistory(SharedHistory::Ptr) {}
 
         // ///////////////////////////////
         // Message management
@@ -688,7 +762,11 @@ namespace beam::wallet
 
         uint64_t AllocateKidRange(uint64_t nCount) override;
         void selectCoins2(Height, Amount amount, Asset::ID, std::vector<Coin>&, std::vector<ShieldedCoin>&, uint32_t nMaxShielded, bool bCanReturnLess) override;
+        void beginCoinsBatch() override;
+        void endCoinsBatch() override;
         std::vector<Coin> selectCoinsEx(Amount amount, Asset::ID, bool bCanReturnLess);
+        void reserveCoins(const TxID&, const std::vector<Coin::ID>&) override;
+        void releaseCoins(const TxID&) override;
 
         std::vector<Coin> getNormalCoins(Asset::ID assetId) const override;
         std::vector<Coin> getAllNormalCoins() const override;
@@ -739,6 +817,9 @@ namespace beam::wallet
         boost::optional<TxDescription> getTx(const TxID& txId) const override;
         void saveTx(const TxDescription& p) override;
         void deleteTx(const TxID& txId) override;
+        uint32_t archiveTransactions(Height hBelow) override;
+        void getChangesRange(uint64_t& oldest, uint64_t& latest) const override;
+        void visitChanges(uint64_t after, std::function<bool(const ChangeLogEntry&)> func) const override;
         void restoreCoinsSpentByTx(const TxID& txId) override;
         void deleteCoinsCreatedByTx(const TxID& txId) override;
         void restoreShieldedCoinsSpentByTx(const TxID& txId) override;
@@ -776,6 +857,7 @@ namespace beam::wallet
 
         Block::SystemState::IHistory& get_History() override;
         void ShrinkHistory() override;
+        void setSharedHistory(SharedHistory::Ptr) override;
 
         std::vector<OutgoingWalletMessage> getWalletMessages() const override;
         uint64_t saveWalletMessage(const WalletID&, const Blob&) override;
@@ -849,6 +931,12 @@ namespace beam::wallet
         void notifyShieldedCoinsChanged(ChangeAction action, const std::vector<ShieldedCoin>& items);
         void notifyAssetChanged(ChangeAction action, Asset::ID);
 
+        static const uint64_t s_ChangesMax = 100000; // kept in the feed
+        static const uint32_t s_ChangesTrimPeriod = 1024; // in inserted changes
+        void logChange(ChangeLogEntry::Type, ChangeAction, const ByteBuffer& key);
+        template <typename T, typename TGetKey>
+        void logChanges(ChangeLogEntry::Type, ChangeAction, const std::vector<T>& items, TGetKey&& getKey);
+
         bool updateCoinRaw(const Coin&);
         void insertCoinRaw(const Coin&);
         void insertNewCoin(Coin&);
@@ -861,14 +949,38 @@ namespace beam::wallet
         void saveShieldedCoinRaw(const ShieldedCoin& coin);
 
         Amount selectCoinsStd(Amount nTrg, Amount nSel, Asset::ID, std::vector<Coin>&);
+        void buildCoinIndex();
 
         // ////////////////////////////////////////
         // Cache for optimized access for database fields
-        using ParameterCache = std::map<TxID, std::map<SubTxID, std::map<TxParameterID, boost::optional<ByteBuffer>>>>;
+        // All the parameters of a tx are loaded at once, the recently used txs are kept
+        struct TxParamsCache
+        {
+            static const size_t s_MaxSize = 512;
 
-        void insertParameterToCache(const TxID& txID, SubTxID subTxID, TxParameterID paramID, const boost::optional<ByteBuffer>& blob) const;
+            typedef std::map<TxParameterID, ByteBuffer> Params;
+
+            struct Entry
+            {
+                std::map<SubTxID, Params> m_Params;
+                std::list<TxID>::iterator m_itLru;
+
+                const ByteBuffer* Find(SubTxID, TxParameterID) const;
+            };
+
+            std::map<TxID, Entry> m_Map;
+            std::list<TxID> m_Lru; // most recent first
+
+            Entry* Find(const TxID&);
+            Entry& Insert(const TxID&); // evicts the least recently used
+            void Erase(const TxID&);
+            void Clear();
+        };
+
+        TxParamsCache::Entry& loadTxParams(const TxID& txID) const;
         void deleteParametersFromCache(const TxID& txID);
         bool hasTransaction(const TxID& txID) const;
+        bool attachArchive(bool bCreate);
         void flushDB();
         void rollbackDB();
         void onModified();
@@ -876,16 +988,7 @@ namespace beam::wallet
         void onPrepareToModify();
         void MigrateCoins();
         boost::optional<TxDescription> getTxImpl(const TxID& txId, sqlite::Statement& stm) const;
-        bool getTxParameterImpl(const TxID& txID, SubTxID subTxID, TxParameterID paramID, ByteBuffer& blob, sqlite::Statement& stm) const;
-
-        template<typename T>
-        bool getTxParameterImpl(const TxID& txID, SubTxID subTxID, TxParameterID paramID, T& value, sqlite::Statement& stm) const
-        {
-            ByteBuffer b;
-            if (getTxParameterImpl(txID, subTxID, paramID, b, stm))
-                return fromByteBuffer<T>(b, value);
-            return false;
-        }
+        boost::optional<TxDescription> getTxFromParams(const TxID& txId, const TxParamsCache::Entry&) const;
 
         void OnTxSummaryParam(const TxID& txID, SubTxID subTxID, TxParameterID, const ByteBuffer*);
         template<typename T>
@@ -899,6 +1002,8 @@ namespace beam::wallet
     private:
         friend struct sqlite::Statement;
         bool m_Initialized = false;
+        bool m_ArchiveAttached = false;
+        uint32_t m_ChangesSinceTrim = 0;
         sqlite3* _db;
         sqlite3* m_PrivateDB;
         Key::IKdf::Ptr m_pKdfMaster;
@@ -922,10 +1027,73 @@ namespace beam::wallet
             void AddStates(const Block::SystemState::Full*, size_t nCount) override;
             void DeleteFrom(Height) override;
 
+            void InsertStates(const Block::SystemState::Full*, size_t nCount);
+            bool HasStatesBelow(Height) const;
+            Height get_SharedLink() const;
+
             IMPLEMENT_GET_PARENT_OBJ(WalletDB, m_History)
         } m_History;
+
+        SharedHistory::Ptr m_pSharedHistory;
         
-        mutable ParameterCache m_TxParametersCache;
+        mutable TxParamsCache m_TxParametersCache;
+
+        // Prepared statements reused by sqlite::Statement, by the connection and the query text
+        struct StatementCache
+        {
+            static const size_t s_MaxSize = 256;
+
+            typedef std::pair<sqlite3*, std::string> Key;
+            std::map<Key, sqlite3_stmt*> m_Map;
+
+            ~StatementCache() { Clear(); }
+            sqlite3_stmt* Acquire(sqlite3*, const char* sql);
+            void Release(sqlite3*, sqlite3_stmt*);
+            void Clear();
+        };
+
+        mutable StatementCache m_StatementCache;
+
+        // Selection candidates (confirmed and unspent coins), per asset, in ascending order of amount.
+        // Built on the first selection, kept in sync by the coin writes, dropped on the bulk updates
+        struct CoinIndex
+        {
+            struct Cmp {
+                bool operator()(const Coin::ID& a, const Coin::ID& b) const {
+                    if (a.m_Value != b.m_Value)
+                        return a.m_Value < b.m_Value;
+                    return a.cmp(b) < 0;
+                }
+            };
+
+            typedef std::map<Coin::ID, Coin, Cmp> Coins;
+            std::map<Asset::ID, Coins> m_Map;
+            bool m_Valid = false;
+
+            static bool IsCandidate(const Coin& c) { return (MaxHeight != c.m_maturity) && (MaxHeight == c.m_spentHeight); }
+
+            void Reset();
+            void OnSaved(const Coin&); // inserts or removes, depending on the coin state
+            void OnRemoved(const Coin::ID&);
+        } m_CoinIndex;
+
+        struct CoinReservation
+        {
+            TxID m_TxID;
+            Timestamp m_Expires;
+        };
+
+        std::map<Coin::ID, CoinReservation, CoinIndex::Cmp> m_CoinReservations;
+        bool IsCoinReserved(const Coin::ID&, Timestamp tNow) const;
+
+        // pending notifications while a CoinsBatch is active
+        struct CoinsBatchState
+        {
+            uint32_t m_Depth = 0;
+            bool m_Reset = false;
+            std::vector<Coin> m_pCoins[3]; // Added, Removed, Updated
+            std::vector<ShieldedCoin> m_pShielded[3];
+        } m_CoinsBatch;
 
         struct LocalKeyKeeper;
         LocalKeyKeeper* m_pLocalKeyKeeper = nullptr;
@@ -62,55 +62,150 @@ namespace beam::wallet {
         Addr::Channel key;
         key.m_Value = msg.m_Channel;
 
-        for (ChannelSet::iterator it = m_Channels.lower_bound(key); ; ++it)
-        {
-            if (m_Channels.end() == it)
-                break;
-            if (it->m_Value != msg.m_Channel)
-                break; // as well
+        ChannelSet::iterator it = m_Channels.lower_bound(key);
+        if ((m_Channels.end() == it) || (it->m_Value != msg.m_Channel))
+            return;
 
+        if (!m_pKdfSbbs)
+        {
+            // read-only wallet
+            m_WalletDB->saveIncomingWalletMessage(msg.m_Channel, msg.m_Message);
+            OnIncomingMessage();
+            return;
+        }
 
-            if (!m_pKdfSbbs)
-            {
-                // read-only wallet
-                m_WalletDB->saveIncomingWalletMessage(msg.m_Channel, msg.m_Message);
-                OnIncomingMessage();
-                return;
-            }
+        // the sender point is parsed once. If it's invalid - none of the addresses would decrypt the message
+        proto::Bbs::DecryptCtx dctx;
+        if (!dctx.Init(msg.m_Message.data(), static_cast<uint32_t>(msg.m_Message.size())))
+            return;
 
-            ByteBuffer buf = msg.m_Message; // duplicate, copy
-            uint8_t* pMsg = &buf.front();
-            uint32_t nSize = static_cast<uint32_t>(buf.size());
+        std::vector<Addr*> vAddrs;
+        for (; (m_Channels.end() != it) && (it->m_Value == msg.m_Channel); ++it)
+            vAddrs.push_back(&it->get_ParentObj());
 
-            auto& x = it->get_ParentObj();
+        Executor* pExec = (vAddrs.size() >= s_ParallelDecryptMin) ? get_DecryptExecutor() : nullptr;
+        if (!pExec)
+        {
+            for (Addr* pAddr : vAddrs)
+            {
+                ByteBuffer buf = msg.m_Message; // duplicate, copy
+                uint8_t* pMsg = &buf.front();
+                uint32_t nSize = static_cast<uint32_t>(buf.size());
 
-            if (!proto::Bbs::Decrypt(pMsg, nSize, x.m_sk))
-                continue;
+                if (dctx.Decrypt(pMsg, nSize, pAddr->m_sk, pAddr->m_Pk) &&
+                    OnDecrypted(pAddr->m_Wid.m_Value, pAddr->m_Wid.m_pHandler, pMsg, nSize))
+                    break;
+            }
+            return;
+        }
 
-            if (x.m_Wid.m_pHandler)
-                x.m_Wid.m_pHandler->OnMsg(Blob(pMsg, nSize));
-            else
+        struct Task
+            :public Executor::TaskSync
+        {
+            struct Result
             {
-                SetTxParameter msgWallet;
-                bool bValid = false;
-
-                try {
-                    Deserializer der;
-                    der.reset(pMsg, nSize);
-                    der& msgWallet;
-                    bValid = true;
-                }
-                catch (const std::exception&) {
-                    BEAM_LOG_WARNING() << "BBS deserialization failed";
-                }
+                ByteBuffer m_Buf;
+                uint32_t m_Offset = 0;
+                uint32_t m_Size = 0;
+                bool m_Ok = false;
+            };
+
+            const proto::BbsMsg* m_pMsg;
+            const proto::Bbs::DecryptCtx* m_pCtx;
+            const std::vector<Addr*>* m_pAddrs;
+            std::vector<Result> m_vRes;
+
+            virtual void Exec(Executor::Context& ctx) override
+            {
+                uint32_t i0, nCount;
+                ctx.get_Portion(i0, nCount, static_cast<uint32_t>(m_vRes.size()));
 
-                if (bValid)
+                for (; nCount--; i0++)
                 {
-                    m_Wallet.OnWalletMessage(it->get_ParentObj().m_Wid.m_Value, msgWallet);
-                    break;
+                    const Addr& x = *(*m_pAddrs)[i0];
+                    Result& r = m_vRes[i0];
+
+                    r.m_Buf = m_pMsg->m_Message; // duplicate, copy
+                    uint8_t* pMsg = &r.m_Buf.front();
+                    uint32_t nSize = static_cast<uint32_t>(r.m_Buf.size());
+
+                    r.m_Ok = m_pCtx->Decrypt(pMsg, nSize, x.m_sk, x.m_Pk);
+                    if (r.m_Ok)
+                    {
+                        r.m_Offset = static_cast<uint32_t>(pMsg - &r.m_Buf.front());
+                        r.m_Size = nSize;
+                    }
+                    else
+                        ByteBuffer().swap(r.m_Buf);
                 }
             }
+        } t;
+
+        t.m_pMsg = &msg;
+        t.m_pCtx = &dctx;
+        t.m_pAddrs = &vAddrs;
+        t.m_vRes.resize(vAddrs.size());
+
+        pExec->ExecAll(t);
+
+        // deliver on this thread, in the same order and with the same semantics as the sequential path.
+        // The handlers may unlisten, hence the recipients are copied before any of them is invoked
+        struct Match
+        {
+            WalletID m_Wid;
+            IHandler* m_pHandler;
+            Task::Result* m_pRes;
+        };
+
+        std::vector<Match> vMatches;
+        for (size_t i = 0; i < vAddrs.size(); i++)
+        {
+            Task::Result& r = t.m_vRes[i];
+            if (r.m_Ok)
+                vMatches.push_back({ vAddrs[i]->m_Wid.m_Value, vAddrs[i]->m_Wid.m_pHandler, &r });
         }
+
+        for (const Match& m : vMatches)
+            if (OnDecrypted(m.m_Wid, m.m_pHandler, &m.m_pRes->m_Buf.front() + m.m_pRes->m_Offset, m.m_pRes->m_Size))
+                break;
+    }
+
+    bool BaseMessageEndpoint::OnDecrypted(const WalletID& wid, IHandler* pHandler, uint8_t* pMsg, uint32_t nSize)
+    {
+        if (pHandler)
+        {
+            pHandler->OnMsg(Blob(pMsg, nSize));
+            return false;
+        }
+
+        SetTxParameter msgWallet;
+
+        try {
+            Deserializer der;
+            der.reset(pMsg, nSize);
+            der& msgWallet;
+        }
+        catch (const std::exception&) {
+            BEAM_LOG_WARNING() << "BBS deserialization failed";
+            return false;
+        }
+
+        m_Wallet.OnWalletMessage(wid, msgWallet);
+        return true;
+    }
+
+    Executor* BaseMessageEndpoint::get_DecryptExecutor()
+    {
+        if (Executor::s_pInstance)
+            return Executor::s_pInstance;
+
+#ifdef __EMSCRIPTEN__
+        return nullptr;
+#else // __EMSCRIPTEN__
+        if (!m_pDecryptExecutor)
+            m_pDecryptExecutor = std::make_unique<ExecutorMT_R>();
+        return m_pDecryptExecutor.get();
+#endif // __EMSCRIPTEN__
     }
 
     BaseMessageEndpoint::Addr* BaseMessageEndpoint::CreateAddr(const WalletID& wid, IHandler* pHandler)
@@ -150,6 +245,7 @@ namespace beam::wallet {
         {
             pAddr = CreateAddr(address.m_BbsAddr, nullptr);
             m_WalletDB->get_SbbsPeerID(pAddr->m_sk, pAddr->m_Wid.m_Value.m_Pk, address.m_OwnID);
+            pAddr->m_Pk = pAddr->m_Wid.m_Value.m_Pk;
         }
 
         pAddr->m_Refs |= Addr::s_InternalRef;
@@ -265,6 +361,7 @@ namespace beam::wallet {
         {
             pAddr = CreateAddr(addr, pHandler);
             pAddr->m_sk = sk;
+            pAddr->m_Pk.FromSk(pAddr->m_sk); // also normalizes it
             pAddr->m_ExpirationTime = Timestamp(-1);
         }
 
@@ -370,6 +467,7 @@ namespace beam::wallet {
         pTask->m_Msg.m_Message = msg;
 
         pTask->m_Done = false;
+        pTask->m_Broadcast = (peerID.m_Pk == Zero); // not addressed to a peer
         pTask->m_Msg.m_Channel = peerID.get_Channel();
 
         pTask->m_StoredMessageID = messageID; // store id to be able to remove if send succeeded
@@ -395,10 +493,7 @@ namespace beam::wallet {
                     m_Miner.m_vThreads[i] = MyThread(&BbsMiner::Thread, &m_Miner, i, Rules::get());
             }
 
-            std::unique_lock<std::mutex> scope(m_Miner.m_Mutex);
-
-            m_Miner.m_Pending.push_back(std::move(pTask));
-            m_Miner.m_NewTask.notify_all();
+            m_Miner.Push(std::move(pTask));
         }
         else
         {
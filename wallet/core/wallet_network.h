@@ -60,6 +60,7 @@ namespace beam::wallet
             }
 
             ECC::Scalar::Native m_sk; // private addr
+            PeerID m_Pk; // of m_sk, saves its derivation on each decryption attempt
             Timestamp m_ExpirationTime = 0;
             uint32_t m_Refs = 0;
             static const uint32_t s_InternalRef = 0x10000000;
@@ -83,6 +84,8 @@ namespace beam::wallet
         void ReleaseAddr(Addr&, bool bInternalRef);
         bool IsSingleChannelUser(const Addr::Channel&);
         Addr* CreateAddr(const WalletID&, IHandler* );
+        bool OnDecrypted(const WalletID&, IHandler*, uint8_t* p, uint32_t n); // true if consumed as a wallet message
+        Executor* get_DecryptExecutor();
 
         // IWalletMessageEndpoint
         void Send(const WalletID& peerID, const SetTxParameter& msg) override;
@@ -102,6 +105,10 @@ namespace beam::wallet
         IWalletDB::Ptr m_WalletDB;
         Key::IKdf::Ptr m_pKdfSbbs;
         io::Timer::Ptr m_AddressExpirationTimer;
+
+        // many addresses on the same channel are tried in parallel
+        static const size_t s_ParallelDecryptMin = 4;
+        std::unique_ptr<ExecutorMT_R> m_pDecryptExecutor;
     };
     struct ITimestampHolder
     {
@@ -135,7 +142,7 @@ namespace beam::wallet
         BbsProcessor(proto::FlyClient::INetwork::Ptr nodeEndpoint, ITimestampHolder::Ptr);
         bool m_MineOutgoing = true; // can be turned-off for testing
         virtual ~BbsProcessor();
-        void Send(const WalletID& peerID, const ByteBuffer& msg, uint64_t messageID);
+        void Send(const WalletID& peerID, const ByteBuffer& msg, uint64_t messageID); // peerID with zero key is a broadcast, mined after the rest
 
         void SubscribeChannel(BbsChannel channel);
         void UnsubscribeChannel(BbsChannel channel);
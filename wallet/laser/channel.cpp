@@ -111,10 +111,7 @@ Channel::~Channel()
 
 Height Channel::get_Tip() const
 {
-    Block::SystemState::Full tip;
-    auto& history = m_rHolder.getWalletDB()->get_History();
-    history.get_Tip(tip);
-    return tip.m_Height;
+    return m_rHolder.get_Tip();
 }
 
 proto::FlyClient::INetwork& Channel::get_Net()
@@ -129,11 +129,8 @@ void Connection::MineBbsRequest(FlyClient::RequestBbsMsg& r)
             m_Miner.m_vThreads[i] = MyThread(&BbsMiner::Thread, &m_Miner, i, Rules::get());
     }
 
-    std::unique_lock<std::mutex> scope(m_Miner.m_Mutex);
-
     m_handlers[pTask] = r.m_pTrg;
-    m_Miner.m_Pending.push_back(std::move(pTask));
-    m_Miner.m_NewTask.notify_all();
+    m_Miner.Push(std::move(pTask));
 }
 
 }  // namespace beam::wallet::laser
@@ -27,6 +27,7 @@ public:
     virtual IWalletDB::Ptr getWalletDB() = 0;
     virtual proto::FlyClient::INetwork& get_Net() = 0;
     virtual IRawCommGateway& get_Gateway() = 0;
+    virtual Height get_Tip() = 0;
     virtual void UpdateChannelExterior(Channel&) = 0;
 };
 }  // namespace beam::wallet::laser
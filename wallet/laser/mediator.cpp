@@ -95,11 +95,16 @@ void Mediator::OnNewTip()
     for (const auto& openedWithFailChannel : m_openedWithFailChannels)
         HandleOpenedWithFailChannel(openedWithFailChannel);
     m_openedWithFailChannels.clear();
+
+    m_hTipCached = 0;
 }
 
 void Mediator::OnRolledBack()
 {
     BEAM_LOG_DEBUG() << "LASER OnRolledBack";
+    m_hTipCached = 0;
+    m_hTipCached = get_Tip();
+
     for (auto& it: m_channels)
     {
         auto& channel = it.second;
@@ -132,6 +137,8 @@ void Mediator::OnRolledBack()
                     m_closedChannels.end(),
                     nullptr),
         m_closedChannels.end());
+
+    m_hTipCached = 0;
 }
 
 Block::SystemState::IHistory& Mediator::get_History()
@@ -139,6 +146,16 @@ Block::SystemState::IHistory& Mediator::get_History()
     return m_pWalletDB->get_History();
 }
 
+Height Mediator::get_Tip()
+{
+    if (m_hTipCached)
+        return m_hTipCached;
+
+    Block::SystemState::Full tip;
+    get_History().get_Tip(tip);
+    return tip.m_Height;
+}
+
 void Mediator::OnOwnedNode(const PeerID&, bool bUp)
 {
 
@@ -904,11 +921,15 @@ void Mediator::UpdateChannelExterior(Channel& channel)
 
 bool Mediator::ValidateTip()
 {
+    m_hTipCached = 0;
+
     Block::SystemState::Full tip;
     get_History().get_Tip(tip);
     if (!IsValidTimeStamp(tip.m_TimeStamp, kDefaultLaserTolerance) || !tip.m_Height)
         return false;
 
+    m_hTipCached = tip.m_Height; // until the new tip is processed
+
     Block::SystemState::ID id;
     tip.get_ID(id);
     m_pWalletDB->setSystemStateID(id);
@@ -60,6 +60,7 @@ public:
     IWalletDB::Ptr getWalletDB() final;
     proto::FlyClient::INetwork& get_Net() final;
     IRawCommGateway& get_Gateway() final;
+    Height get_Tip() final;
     
     void SetNetwork(const proto::FlyClient::NetworkStd::Ptr& net, IRawCommGateway&, bool mineOutgoing = true);
     void ListenClosedChannelsWithPossibleRollback();
@@ -133,6 +134,9 @@ private:
     std::vector<Channel::Ptr> m_closedChannels;
     std::vector<Observer*> m_observers;
 
+    // The tip is shared by all the channels while a new tip (or rollback) is processed, instead of reading it from the DB per channel
+    Height m_hTipCached = 0;
+
     Lightning::Channel::Params m_Params;
     mutable std::mutex m_mutex;
     using Lock = std::unique_lock<decltype(m_mutex)>;
@@ -319,6 +319,14 @@ namespace beam::bitcoin
     }
 
     void BitcoinCore016::getTxOut(const std::string& txid, int outputIndex, std::function<void(const IBridge::Error&, const std::string&, Amount, uint32_t)> callback)
+    {
+        m_txOutPoll.Get(std::make_pair(txid, outputIndex), std::move(callback), [this, &txid, outputIndex](auto&& cb)
+        {
+            requestTxOut(txid, outputIndex, std::move(cb));
+        });
+    }
+
+    void BitcoinCore016::requestTxOut(const std::string& txid, int outputIndex, std::function<void(const IBridge::Error&, const std::string&, Amount, uint32_t)> callback)
     {
         BEAM_LOG_DEBUG() << "Send getTxOut command";
 
@@ -354,6 +362,14 @@ namespace beam::bitcoin
     }
 
     void BitcoinCore016::getBlockCount(std::function<void(const IBridge::Error&, uint64_t)> callback)
+    {
+        m_blockCountPoll.Get(0, std::move(callback), [this](auto&& cb)
+        {
+            requestBlockCount(std::move(cb));
+        });
+    }
+
+    void BitcoinCore016::requestBlockCount(std::function<void(const IBridge::Error&, uint64_t)> callback)
     {
         BEAM_LOG_DEBUG() << "Send getBlockCount command";
 
@@ -17,6 +17,7 @@
 #include "bridge.h"
 #include "http/http_client.h"
 #include "settings_provider.h"
+#include "wallet/transactions/swaps/shared_poll.h"
 
 namespace beam::bitcoin
 {
@@ -45,6 +46,8 @@ namespace beam::bitcoin
         void estimateFee(int blockAmount, std::function<void(const Error&, Amount)> callback) override;
 
     protected:
+        void requestTxOut(const std::string& txid, int outputIndex, std::function<void(const Error&, const std::string&, Amount, uint32_t)> callback);
+        void requestBlockCount(std::function<void(const Error&, uint64_t)> callback);
         void sendRequest(const std::string& method, const std::string& params, std::function<void(const Error&, const nlohmann::json&)> callback);
         virtual std::string getCoinName() const;
         virtual std::string getAddressType() const;
@@ -53,5 +56,7 @@ namespace beam::bitcoin
         HttpClient m_httpClient;
         ISettingsProvider& m_settingsProvider;
         std::map<beam::io::Address, bool> m_verifiedAddresses;
+        wallet::SharedPoll<std::pair<std::string, int>, Error, std::string, Amount, uint32_t> m_txOutPoll;
+        wallet::SharedPoll<int, Error, uint64_t> m_blockCountPoll;
     };
 } // namespace beam::bitcoin
\ No newline at end of file
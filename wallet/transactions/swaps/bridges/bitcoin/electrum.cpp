@@ -36,6 +36,9 @@ using namespace libbitcoin::chain;
 namespace
 {
     const std::chrono::seconds kRequestPeriod = std::chrono::seconds(10);
+    const std::chrono::seconds kSameTipCachePeriod = std::chrono::seconds(60);
+    const std::chrono::seconds kIdleConnectionTimeout = std::chrono::seconds(60);
+    const size_t kMaxIdleConnections = 2;
     const size_t kUnlogingScriptSize = 107u; // without prefix
 
     std::string generateScriptHash(const ec_public& publicKey, uint8_t addressVersion)
@@ -242,12 +245,15 @@ namespace beam::bitcoin
     {
         BEAM_LOG_DEBUG() << "sendRawTransaction command";
 
-        sendRequest("blockchain.transaction.broadcast", "\"" + rawTx + "\"", [callback](IBridge::Error error, const json& result, uint64_t)
+        sendRequest("blockchain.transaction.broadcast", "\"" + rawTx + "\"", [this, callback](IBridge::Error error, const json& result, uint64_t)
         {
             std::string txID;
 
             if (error.m_type == IBridge::None)
             {
+                // the coins are spent
+                m_cache.clear();
+
                 try
                 {
                     txID = result.get<std::string>();
@@ -311,6 +317,14 @@ namespace beam::bitcoin
     }
 
     void Electrum::getTxOut(const std::string& txid, int outputIndex, std::function<void(const IBridge::Error&, const std::string&, Amount, uint32_t)> callback)
+    {
+        m_txOutPoll.Get(std::make_pair(txid, outputIndex), std::move(callback), [this, &txid, outputIndex](auto&& cb)
+        {
+            requestTxOut(txid, outputIndex, std::move(cb));
+        });
+    }
+
+    void Electrum::requestTxOut(const std::string& txid, int outputIndex, std::function<void(const IBridge::Error&, const std::string&, Amount, uint32_t)> callback)
     {
         //BEAM_LOG_DEBUG() << "getTxOut command";
         sendRequest("blockchain.transaction.get", "\"" + txid + "\", true", [callback, outputIndex](IBridge::Error error, const json& result, uint64_t)
@@ -361,10 +375,18 @@ namespace beam::bitcoin
     }
 
     void Electrum::getBlockCount(std::function<void(const IBridge::Error&, uint64_t)> callback)
+    {
+        m_blockCountPoll.Get(0, std::move(callback), [this](auto&& cb)
+        {
+            requestBlockCount(std::move(cb));
+        });
+    }
+
+    void Electrum::requestBlockCount(std::function<void(const IBridge::Error&, uint64_t)> callback)
     {
         //BEAM_LOG_DEBUG() << "getBlockCount command";
 
-        sendRequest("blockchain.headers.subscribe", "", [callback](IBridge::Error error, const json& result, uint64_t)
+        sendRequest("blockchain.headers.subscribe", "", [this, callback](IBridge::Error error, const json& result, uint64_t)
         {
             uint64_t blockCount = 0;
 
@@ -375,6 +397,7 @@ namespace beam::bitcoin
                     auto key = (result.find("height") != result.end()) ? "height" : "block_height";
 
                     blockCount = result[key].get<uint64_t>();
+                    m_tipHeight = blockCount;
                 }
                 catch (const std::exception& ex)
                 {
@@ -431,44 +454,31 @@ namespace beam::bitcoin
     {
         //BEAM_LOG_DEBUG() << "getDetailedBalance command";
 
-        size_t index = 0;
-        Amount confirmed = 0;
-        Amount unconfirmed = 0;
-        auto privateKeys = generatePrivateKeyList();
-        auto addressVersion = m_settingsProvider.GetSettings().GetAddressVersion();
+        std::vector<std::string> params;
+        for (const auto& scriptHash : getScriptHashes())
+        {
+            params.push_back("\"" + scriptHash + "\"");
+        }
 
-        sendRequest("blockchain.scripthash.get_balance", "\"" + generateScriptHash(privateKeys[0].to_public(), addressVersion) + "\"",
-            [this, callback, index, confirmed, unconfirmed, privateKeys, addressVersion](IBridge::Error error, const json& result, uint64_t tag) mutable
+        sendBatchRequest("blockchain.scripthash.get_balance", params, [callback](IBridge::Error error, const json& result, uint64_t)
         {
+            Amount confirmed = 0;
+            Amount unconfirmed = 0;
+
             if (error.m_type == IBridge::None)
             {
-                TCPConnect& connection = m_connections[tag];
-
                 try
                 {
-                    confirmed += result["confirmed"].get<Amount>();
-                    unconfirmed += result["unconfirmed"].get<Amount>();
+                    for (const auto& balance : result)
+                    {
+                        confirmed += balance["confirmed"].get<Amount>();
+                        unconfirmed += balance["unconfirmed"].get<Amount>();
+                    }
                 }
                 catch (const std::exception& ex)
                 {
                     error.m_type = IBridge::InvalidResultFormat;
                     error.m_message = ex.what();
-
-                    callback(error, confirmed, unconfirmed, 0);
-
-                    return false;
-                }
-
-                if (++index < privateKeys.size())
-                {
-                    std::string request = R"({"method":"blockchain.scripthash.get_balance","params":[")" + generateScriptHash(privateKeys[index].to_public(), addressVersion) + R"("], "id": "teste"})";
-                    request += "\n";
-
-                    Result res = connection.m_stream->write(request.data(), request.size());
-                    if (!res) {
-                        BEAM_LOG_ERROR() << error_str(res.error());
-                    }
-                    return true;
                 }
             }
             callback(error, confirmed, unconfirmed, 0);
@@ -530,28 +540,38 @@ namespace beam::bitcoin
     void Electrum::listUnspent(std::function<void(const Error&, const std::vector<Utxo>&)> callback)
     {
         BEAM_LOG_DEBUG() << "listunstpent command";
-        size_t index = 0;
-        std::vector<Utxo> coins;
-        auto privateKeys = generatePrivateKeyList();
-        auto addressVersion = m_settingsProvider.GetSettings().GetAddressVersion();
 
-        if (m_cache.empty() || (std::chrono::system_clock::now() - m_lastCache > kRequestPeriod))
+        // the result doesn't change much until the next block, except for our own txs, which reset the cache
+        auto cacheAge = std::chrono::system_clock::now() - m_lastCache;
+        bool isCacheValid = !m_cache.empty() &&
+            (cacheAge <= kRequestPeriod || (m_tipHeight && m_cacheHeight == m_tipHeight && cacheAge <= kSameTipCachePeriod));
+
+        if (!isCacheValid)
         {
-            sendRequest("blockchain.scripthash.listunspent", "\"" + generateScriptHash(privateKeys[0].to_public(), addressVersion) + "\"",
-                [this, callback, index, coins, privateKeys, addressVersion](IBridge::Error error, const json& result, uint64_t tag) mutable
+            std::vector<std::string> params;
+            for (const auto& scriptHash : getScriptHashes())
             {
-                if (error.m_type == IBridge::None || error.m_type == IBridge::EmptyResult)
-                {
-                    TCPConnect& connection = m_connections[tag];
+                params.push_back("\"" + scriptHash + "\"");
+            }
+
+            sendBatchRequest("blockchain.scripthash.listunspent", params, [this, callback](IBridge::Error error, const json& result, uint64_t)
+            {
+                std::vector<Utxo> coins;
 
+                if (error.m_type == IBridge::None)
+                {
                     try
                     {
-                        for (auto utxo : result)
+                        // m_index is the index of the address in generatePrivateKeyList()
+                        for (size_t index = 0; index < result.size(); ++index)
                         {
-                            Utxo coin;
-                            coin.m_index = index;
-                            coin.m_details = utxo;
-                            coins.push_back(coin);
+                            for (const auto& utxo : result[index])
+                            {
+                                Utxo coin;
+                                coin.m_index = index;
+                                coin.m_details = utxo;
+                                coins.push_back(coin);
+                            }
                         }
                     }
                     catch (const std::exception& ex)
@@ -560,26 +580,12 @@ namespace beam::bitcoin
                         error.m_message = ex.what();
 
                         callback(error, coins);
-
                         return false;
                     }
 
-                    if (++index < privateKeys.size())
-                    {
-                        std::string request = R"({"method":"blockchain.scripthash.listunspent","params":[")" + generateScriptHash(privateKeys[index].to_public(), addressVersion) + R"("], "id": "teste"})";
-                        request += "\n";
-
-                        Result res = connection.m_stream->write(request.data(), request.size());
-                        if (!res) {
-                            BEAM_LOG_ERROR() << error_str(res.error());
-                        }
-                        return true;
-                    }
                     m_lastCache = std::chrono::system_clock::now();
+                    m_cacheHeight = m_tipHeight;
                     m_cache = coins;
-                    IBridge::Error emptyError{ ErrorType::None, "" };
-                    callback(emptyError, coins);
-                    return false;
                 }
                 callback(error, coins);
                 return false;
@@ -599,6 +605,34 @@ namespace beam::bitcoin
     void Electrum::sendRequest(const std::string& method, const std::string& params, std::function<bool(const Error&, const json&, uint64_t)> callback)
     {
         std::string request(R"({"method":")" + method + R"(","params":[)" + params + R"(], "id": "test"})");
+        sendRawRequest(std::move(request), std::move(callback));
+    }
+
+    void Electrum::sendBatchRequest(const std::string& method, const std::vector<std::string>& params, Callback callback)
+    {
+        if (params.empty())
+        {
+            callback(Error{ None, "" }, json::array(), 0);
+            return;
+        }
+
+        // the ids are the indices, the replies may come in any order
+        std::string request("[");
+        for (size_t i = 0; i < params.size(); ++i)
+        {
+            if (i)
+            {
+                request += ",";
+            }
+            request += R"({"method":")" + method + R"(","params":[)" + params[i] + R"(], "id": )" + std::to_string(i) + "}";
+        }
+        request += "]";
+
+        sendRawRequest(std::move(request), std::move(callback));
+    }
+
+    void Electrum::sendRawRequest(std::string&& request, Callback callback)
+    {
         request += "\n";
 
         auto settings = m_settingsProvider.GetSettings();
@@ -618,6 +652,12 @@ namespace beam::bitcoin
             }
 
             host = electrumSettings.m_address;
+
+            if (sendToIdleConnection(host, request, callback))
+            {
+                return;
+            }
+
             if (!address.resolve(host.c_str()))
             {
                 tryToChangeAddress();
@@ -634,11 +674,12 @@ namespace beam::bitcoin
 
         uint64_t currentId = m_idCounter++;
         TCPConnect& connection = m_connections[currentId];
-        connection.m_request = request;
-        connection.m_callback = callback;
+        connection.m_request = std::move(request);
+        connection.m_callback = std::move(callback);
+        connection.m_address = host;
 
         auto tag = uint64_t(&connection);
-        auto result = m_reactor.tcp_connect(address, tag, [this, currentId, weak = this->weak_from_this(), settings](uint64_t tag, std::unique_ptr<TcpStream>&& newStream, ErrorCode status)
+        auto result = m_reactor.tcp_connect(address, tag, [this, currentId, weak = this->weak_from_this()](uint64_t tag, std::unique_ptr<TcpStream>&& newStream, ErrorCode status)
         {
             if (weak.expired())
             {
@@ -652,150 +693,25 @@ namespace beam::bitcoin
 
                 connection.m_stream = std::move(newStream);
 
-                connection.m_stream->enable_read([this, weak, currentId, settings](ErrorCode what, void* data, size_t size) -> bool
+                // stays the same for the whole life of the connection, incl. the reuse
+                connection.m_stream->enable_read([this, weak, currentId](ErrorCode what, void* data, size_t size) -> bool
                 {
                     if (weak.expired())
                     {
                         return false;
                     }
 
-                    bool isFinished = true;
-                    Error error{ None, "" };
-                    json result;
-                    {
-                        if (size > 0 && data)
-                        {
-                            std::string strResponse = std::string(static_cast<const char*>(data), size);
-
-                            //BEAM_LOG_INFO() << "strResponse: " << strResponse;
-                            try
-                            {
-                                json reply = json::parse(strResponse);
-
-                                if (!reply["error"].empty())
-                                {
-                                    error.m_type = IBridge::BitcoinError;
-                                    error.m_message = reply["error"]["message"].get<std::string>();
-                                }
-                                else if (reply["result"].empty())
-                                {
-                                    error.m_type = IBridge::EmptyResult;
-                                    error.m_message = "JSON has no \"result\" value";
-                                }
-                                else
-                                {
-                                    result = reply["result"];
-                                    auto id = reply["id"].get<std::string>();
-                                    if (id == "verify")
-                                    {
-                                        auto genesisBlockHash = result["genesis_hash"].get<std::string>();
-                                        TCPConnect& connection = m_connections[currentId];
-                                        auto genesisBlockHashes = settings.GetGenesisBlockHashes();
-                                        auto currentNodeAddress = settings.GetElectrumConnectionOptions().m_address;
-
-                                        connection.m_verifyingRequest = false;
-                                        if (std::find(genesisBlockHashes.begin(), genesisBlockHashes.end(), genesisBlockHash) != genesisBlockHashes.end())
-                                        {
-                                            m_verifiedAddresses.emplace(currentNodeAddress, true);
-                                            Result res = connection.m_stream->write(connection.m_request.data(), connection.m_request.size());
-                                            if (!res)
-                                            {
-                                                BEAM_LOG_ERROR() << error_str(res.error());
-                                            }
-                                            return true;
-                                        }
-                                        else
-                                        {
-                                            m_verifiedAddresses.emplace(currentNodeAddress, false);
-
-                                            tryToChangeAddress();
-
-                                            error.m_message = kInvalidGenesisBlockHashMsg;
-                                            error.m_type = IBridge::InvalidGenesisBlock;
-                                            connection.m_callback(error, result, currentId);
-                                            // TODO roman.strilets maybe need to add this code
-                                            // m_connections.erase(currentId);
-                                            return false;
-                                        }
-                                    }
-                                }
-                            }
-                            catch (const std::exception& ex)
-                            {
-                                error.m_type = IBridge::InvalidResultFormat;
-                                error.m_message = ex.what();
-                            }
-                        }
-                        else
-                        {
-                            error.m_type = IOError;
-                            error.m_message = "Empty response.";
-                        }
-
-                        TCPConnect& connection = m_connections[currentId];
-                        if (error.m_type != ErrorType::None && connection.m_verifyingRequest)
-                        {
-                            error.m_message = kInvalidGenesisBlockHashMsg;
-                            error.m_type = IBridge::InvalidGenesisBlock;
-
-                            tryToChangeAddress();
-                            connection.m_callback(error, result, currentId);
-                            isFinished = true;
-                        }
-                        else
-                        {
-                            isFinished = !connection.m_callback(error, result, currentId);
-                        }
-                    }
-                    if (isFinished)
-                    {
-                        m_connections.erase(currentId);
-                        return false;
-                    }
-                    return true;
+                    return onRead(currentId, data, size);
                 });
 
-                Result res;
-
-                // find address in map
-                auto iter = m_verifiedAddresses.find(settings.GetElectrumConnectionOptions().m_address);
-                if (iter != m_verifiedAddresses.end())
-                {
-                    // node have invalid genesis block hash
-                    if (!iter->second)
-                    {
-                        tryToChangeAddress();
-                        // error
-                        Error error{ InvalidGenesisBlock, kInvalidGenesisBlockHashMsg };
-                        json result;
-                        connection.m_callback(error, result, currentId);
-                        m_connections.erase(currentId);
-                        return;
-                    }
-                    res = connection.m_stream->write(connection.m_request.data(), connection.m_request.size());
-                }
-                else
-                {
-                    // Node have not validated yet
-                    std::string verifyRequest = R"({"method":"server.features","params":[], "id": "verify"})";
-                    verifyRequest += "\n";
-                    connection.m_verifyingRequest = true;
-                    res = connection.m_stream->write(verifyRequest.data(), verifyRequest.size());
-                }
-
-                if (!res) {
-                    BEAM_LOG_ERROR() << error_str(res.error());
-                }
+                startRequest(currentId);
             }
             else
             {
                 tryToChangeAddress();
 
                 // error
-                Error error{ IOError, "stream is empty" };
-                json result;
-                connection.m_callback(error, result, currentId);
-                m_connections.erase(currentId);
+                failRequest(currentId, Error{ IOError, "stream is empty" });
             }
         }, 2000, 
            io::TlsConfig(true, false, host)
@@ -809,7 +725,321 @@ namespace beam::bitcoin
 
         Error error{ IOError, std::string("error in Electrum::sendRequest: code = ") + io::error_descr(result.error()) };
         json tmp;
-        callback(error, tmp, 0);
+        auto cb = std::move(connection.m_callback);
+        m_connections.erase(currentId);
+        cb(error, tmp, 0);
+    }
+
+    bool Electrum::sendToIdleConnection(const std::string& address, std::string& request, Callback& callback)
+    {
+        auto now = std::chrono::steady_clock::now();
+
+        for (auto it = m_connections.begin(); m_connections.end() != it; )
+        {
+            TCPConnect& connection = it->second;
+            if (connection.m_callback || !connection.m_stream)
+            {
+                // busy, or not connected yet
+                ++it;
+                continue;
+            }
+
+            if (connection.m_address != address || now - connection.m_idleSince > kIdleConnectionTimeout || !connection.m_stream->is_connected())
+            {
+                it = m_connections.erase(it);
+                continue;
+            }
+
+            connection.m_request = std::move(request);
+            connection.m_callback = std::move(callback);
+            startRequest(it->first);
+            return true;
+        }
+
+        return false;
+    }
+
+    void Electrum::startRequest(uint64_t id)
+    {
+        TCPConnect& connection = m_connections[id];
+        Result res;
+
+        // find address in map
+        auto iter = m_verifiedAddresses.find(connection.m_address);
+        if (iter != m_verifiedAddresses.end())
+        {
+            // node have invalid genesis block hash
+            if (!iter->second)
+            {
+                tryToChangeAddress();
+                // error
+                failRequest(id, Error{ InvalidGenesisBlock, kInvalidGenesisBlockHashMsg });
+                return;
+            }
+            res = connection.m_stream->write(connection.m_request.data(), connection.m_request.size());
+        }
+        else
+        {
+            // Node have not validated yet
+            std::string verifyRequest = R"({"method":"server.features","params":[], "id": "verify"})";
+            verifyRequest += "\n";
+            connection.m_verifyingRequest = true;
+            res = connection.m_stream->write(verifyRequest.data(), verifyRequest.size());
+        }
+
+        if (!res) {
+            BEAM_LOG_ERROR() << error_str(res.error());
+        }
+    }
+
+    bool Electrum::onRead(uint64_t id, const void* data, size_t size)
+    {
+        auto it = m_connections.find(id);
+        if (m_connections.end() == it)
+        {
+            return false;
+        }
+
+        TCPConnect& connection = it->second;
+        if (!size || !data)
+        {
+            // disconnected
+            if (!connection.m_callback)
+            {
+                m_connections.erase(it);
+                return false;
+            }
+
+            Error error{ IOError, "Empty response." };
+            if (connection.m_verifyingRequest)
+            {
+                error = Error{ IBridge::InvalidGenesisBlock, kInvalidGenesisBlockHashMsg };
+                tryToChangeAddress();
+            }
+
+            failRequest(id, error);
+            return false;
+        }
+
+        connection.m_readBuffer.append(static_cast<const char*>(data), size);
+
+        while (true)
+        {
+            // the connection may be gone after the callback
+            it = m_connections.find(id);
+            if (m_connections.end() == it)
+            {
+                return false;
+            }
+
+            std::string& buffer = it->second.m_readBuffer;
+            auto pos = buffer.find('\n');
+            if (std::string::npos == pos)
+            {
+                return true;
+            }
+
+            std::string strResponse = buffer.substr(0, pos);
+            buffer.erase(0, pos + 1);
+
+            if (!onReply(id, strResponse))
+            {
+                return false;
+            }
+        }
+    }
+
+    bool Electrum::onReply(uint64_t id, const std::string& strResponse)
+    {
+        TCPConnect& connection = m_connections[id];
+
+        //BEAM_LOG_INFO() << "strResponse: " << strResponse;
+        Error error{ None, "" };
+        json result;
+        try
+        {
+            json reply = json::parse(strResponse);
+
+            if (reply.is_object() && reply.find("id") == reply.end())
+            {
+                // notification, the connections subscribed by getBlockCount() get the new headers
+                if (reply["method"] == "blockchain.headers.subscribe" && !reply["params"].empty())
+                {
+                    auto header = reply["params"][0];
+                    auto key = (header.find("height") != header.end()) ? "height" : "block_height";
+                    m_tipHeight = header[key].get<uint64_t>();
+                }
+                return true;
+            }
+
+            if (!connection.m_callback)
+            {
+                // stray reply on an idle connection
+                return true;
+            }
+
+            if (reply.is_array())
+            {
+                // batch
+                std::vector<json> results(reply.size());
+                for (auto& item : reply)
+                {
+                    if (!item["error"].empty())
+                    {
+                        error.m_type = IBridge::BitcoinError;
+                        error.m_message = item["error"]["message"].get<std::string>();
+                        break;
+                    }
+
+                    auto index = item["id"].get<size_t>();
+                    if (index >= results.size())
+                    {
+                        throw std::runtime_error("invalid batch reply id");
+                    }
+                    results[index] = item["result"];
+                }
+
+                if (error.m_type == ErrorType::None)
+                {
+                    result = results;
+                }
+            }
+            else if (!reply["error"].empty())
+            {
+                error.m_type = IBridge::BitcoinError;
+                error.m_message = reply["error"]["message"].get<std::string>();
+            }
+            else if (reply["result"].empty())
+            {
+                error.m_type = IBridge::EmptyResult;
+                error.m_message = "JSON has no \"result\" value";
+            }
+            else
+            {
+                result = reply["result"];
+                auto replyId = reply["id"].get<std::string>();
+                if (replyId == "verify")
+                {
+                    auto genesisBlockHash = result["genesis_hash"].get<std::string>();
+                    auto genesisBlockHashes = m_settingsProvider.GetSettings().GetGenesisBlockHashes();
+
+                    connection.m_verifyingRequest = false;
+                    if (std::find(genesisBlockHashes.begin(), genesisBlockHashes.end(), genesisBlockHash) != genesisBlockHashes.end())
+                    {
+                        m_verifiedAddresses.emplace(connection.m_address, true);
+                        Result res = connection.m_stream->write(connection.m_request.data(), connection.m_request.size());
+                        if (!res)
+                        {
+                            BEAM_LOG_ERROR() << error_str(res.error());
+                        }
+                        return true;
+                    }
+
+                    m_verifiedAddresses.emplace(connection.m_address, false);
+
+                    tryToChangeAddress();
+
+                    failRequest(id, Error{ IBridge::InvalidGenesisBlock, kInvalidGenesisBlockHashMsg });
+                    return false;
+                }
+            }
+        }
+        catch (const std::exception& ex)
+        {
+            error.m_type = IBridge::InvalidResultFormat;
+            error.m_message = ex.what();
+        }
+
+        if (!connection.m_callback)
+        {
+            // malformed data on an idle connection
+            m_connections.erase(id);
+            return false;
+        }
+
+        if (error.m_type != ErrorType::None && connection.m_verifyingRequest)
+        {
+            tryToChangeAddress();
+            failRequest(id, Error{ IBridge::InvalidGenesisBlock, kInvalidGenesisBlockHashMsg });
+            return false;
+        }
+
+        // released before the callback, so that the next request can reuse it. Reusable unless the stream is out of sync
+        auto callback = std::move(connection.m_callback);
+        finishRequest(id, error.m_type != IBridge::InvalidResultFormat);
+
+        callback(error, result, id);
+
+        return m_connections.find(id) != m_connections.end();
+    }
+
+    void Electrum::failRequest(uint64_t id, const Error& error)
+    {
+        auto it = m_connections.find(id);
+        if (m_connections.end() == it)
+        {
+            return;
+        }
+
+        auto callback = std::move(it->second.m_callback);
+        m_connections.erase(it);
+
+        if (callback)
+        {
+            json result;
+            callback(error, result, id);
+        }
+    }
+
+    void Electrum::finishRequest(uint64_t id, bool keepConnection)
+    {
+        auto it = m_connections.find(id);
+        if (m_connections.end() == it)
+        {
+            return;
+        }
+
+        TCPConnect& connection = it->second;
+        connection.m_callback = Callback();
+        connection.m_request.clear();
+        connection.m_idleSince = std::chrono::steady_clock::now();
+
+        if (keepConnection && connection.m_stream)
+        {
+            size_t idleCount = std::count_if(m_connections.begin(), m_connections.end(), [](const auto& x)
+            {
+                return !x.second.m_callback && x.second.m_stream;
+            });
+
+            if (idleCount <= kMaxIdleConnections)
+            {
+                return;
+            }
+        }
+
+        m_connections.erase(it);
+    }
+
+    const std::vector<std::string>& Electrum::getScriptHashes()
+    {
+        auto settings = m_settingsProvider.GetSettings();
+        auto electrumSettings = settings.GetElectrumConnectionOptions();
+        auto addressVersion = settings.GetAddressVersion();
+
+        // the keys derivation from the seed phrase is expensive, and the hashes are needed on each scan
+        if (m_scriptHashes.empty() || m_scriptHashesSettings != electrumSettings || m_scriptHashesVersion != addressVersion)
+        {
+            m_scriptHashes.clear();
+            for (const auto& privateKey : generatePrivateKeyList())
+            {
+                m_scriptHashes.push_back(generateScriptHash(privateKey.to_public(), addressVersion));
+            }
+
+            m_scriptHashesSettings = electrumSettings;
+            m_scriptHashesVersion = addressVersion;
+        }
+
+        return m_scriptHashes;
     }
 
     std::vector<libbitcoin::wallet::ec_private> Electrum::generatePrivateKeyList() const
@@ -989,4 +1219,4 @@ namespace beam::bitcoin
 
         return signTx;
     }
-} // namespace beam::bitcoin
\ No newline at end of file
+} // namespace beam::bitcoin
\ No newline at end of file
@@ -16,6 +16,7 @@
 
 #include "bridge.h"
 #include "settings_provider.h"
+#include "wallet/transactions/swaps/shared_poll.h"
 
 #include "nlohmann/json.hpp"
 
@@ -34,11 +35,18 @@ namespace beam::bitcoin
     class Electrum : public IBridge, public std::enable_shared_from_this<Electrum>
     {
     private:
+        // the return value is ignored, the connection is released before the callback
+        using Callback = std::function<bool(const Error&, const nlohmann::json&, uint64_t)>;
+
+        // The connections are kept open after the request, and reused by the next ones (for the same node)
         struct TCPConnect
         {
             std::string m_request;
-            std::function<bool(const Error&, const nlohmann::json&, uint64_t)> m_callback;
+            Callback m_callback; // empty if idle
             std::unique_ptr<beam::io::TcpStream> m_stream;
+            std::string m_address;
+            std::string m_readBuffer; // the replies are newline-delimited, and may come in pieces
+            std::chrono::steady_clock::time_point m_idleSince;
             bool m_verifyingRequest = false;
         };
 
@@ -81,9 +89,16 @@ namespace beam::bitcoin
         void estimateFee(int blockAmount, std::function<void(const Error&, Amount)> callback) override;
 
     protected:
+        void requestTxOut(const std::string& txid, int outputIndex, std::function<void(const Error&, const std::string&, Amount, uint32_t)> callback);
+        void requestBlockCount(std::function<void(const Error&, uint64_t)> callback);
         void listUnspent(std::function<void(const Error&, const std::vector<Utxo>&)> callback);
 
         void sendRequest(const std::string& method, const std::string& params, std::function<bool(const Error&, const nlohmann::json&, uint64_t)> callback);
+        // JSON-RPC batch, the same method for each params. The result is the array of the results in the params order
+        void sendBatchRequest(const std::string& method, const std::vector<std::string>& params, Callback callback);
+
+        // script hashes of generatePrivateKeyList(), cached
+        const std::vector<std::string>& getScriptHashes();
 
         // return the list of all private keys (receiving and changing)
         std::vector<libbitcoin::wallet::ec_private> generatePrivateKeyList() const;
@@ -102,6 +117,14 @@ namespace beam::bitcoin
         virtual std::pair<libbitcoin::wallet::hd_private, libbitcoin::wallet::hd_private> generateMasterPrivateKeys(const std::vector<std::string>& words) const;
 
     private:
+        void sendRawRequest(std::string&& request, Callback callback);
+        bool sendToIdleConnection(const std::string& address, std::string& request, Callback& callback);
+        void startRequest(uint64_t id);
+        bool onRead(uint64_t id, const void* data, size_t size);
+        bool onReply(uint64_t id, const std::string& strResponse);
+        void failRequest(uint64_t id, const Error& error);
+        void finishRequest(uint64_t id, bool keepConnection);
+
         libbitcoin::chain::transaction signRawTx
         (const libbitcoin::chain::transaction& tx, const std::vector<Utxo>& coins);
 
@@ -115,7 +138,14 @@ namespace beam::bitcoin
         std::vector<LockUtxo> m_lockedUtxo;
         std::vector<Utxo> m_cache;
         std::chrono::system_clock::time_point m_lastCache;
+        uint64_t m_cacheHeight = 0;
+        uint64_t m_tipHeight = 0; // incl. the header notifications on the idle connections
+        ElectrumSettings m_scriptHashesSettings;
+        uint8_t m_scriptHashesVersion = 0;
+        std::vector<std::string> m_scriptHashes;
         io::AsyncEvent::Ptr m_asyncEvent;
         std::map<std::string, bool> m_verifiedAddresses;
+        wallet::SharedPoll<std::pair<std::string, int>, Error, std::string, Amount, uint32_t> m_txOutPoll;
+        wallet::SharedPoll<int, Error, uint64_t> m_blockCountPoll;
     };
 } // namespace beam::bitcoin
\ No newline at end of file
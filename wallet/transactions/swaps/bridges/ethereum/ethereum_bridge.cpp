@@ -30,6 +30,9 @@ using json = nlohmann::json;
 
 namespace
 {
+const unsigned kReceiptsBatchDelayMsec = 100;
+const size_t kMaxMinedReceipts = 1000;
+
 bool needSsl(const std::string& address)
 {
     // TODO roman.strilets need insensitive
@@ -44,6 +47,7 @@ EthereumBridge::EthereumBridge(io::Reactor& reactor, ISettingsProvider& settings
     , m_settingsProvider(settingsProvider)
     , m_txConfirmationTimer(io::Timer::create(reactor))
     , m_approveTxConfirmationTimer(io::Timer::create(reactor))
+    , m_receiptsTimer(io::Timer::create(reactor))
 {
 }
 
@@ -109,6 +113,14 @@ void EthereumBridge::getTokenBalance(
 }
 
 void EthereumBridge::getBlockNumber(std::function<void(const Error&, uint64_t)> callback)
+{
+    m_blockNumberPoll.Get(0, std::move(callback), [this](auto&& cb)
+    {
+        requestBlockNumber(std::move(cb));
+    });
+}
+
+void EthereumBridge::requestBlockNumber(std::function<void(const Error&, uint64_t)> callback)
 {
     BEAM_LOG_DEBUG() << "EthereumBridge::getBlockNumber";
     sendRequest("eth_blockNumber", "", [callback](Error error, const json& result)
@@ -539,31 +551,138 @@ void EthereumBridge::onGotApproveTxConfirmation(const Error& error, uint64_t txB
 void EthereumBridge::getTransactionReceipt(const std::string& txHash, std::function<void(const Error&, const nlohmann::json&)> callback)
 {
     BEAM_LOG_DEBUG() << "EthereumBridge::getTransactionReceipt";
-    std::string params = (boost::format(R"("%1%")") % AddHexPrefix(txHash)).str();
 
-    sendRequest("eth_getTransactionReceipt", params, [callback](Error error, const json& result)
-    {
-        BEAM_LOG_DEBUG() << "EthereumBridge::getTransactionReceipt in";
-        json txInfo;
+    // collected for a while, the swaps ask on the same tip
+    auto& callbacks = m_pendingReceipts[AddHexPrefix(txHash)];
+    callbacks.push_back(std::move(callback));
 
-        if (error.m_type == IBridge::None)
+    if (m_pendingReceipts.size() == 1 && callbacks.size() == 1)
+    {
+        m_receiptsTimer->start(kReceiptsBatchDelayMsec, false, [this, weak = this->weak_from_this()]()
         {
-            try
+            if (!weak.expired())
             {
-                txInfo = result["result"];
+                flushReceiptRequests();
             }
-            catch (const std::exception& ex)
+        });
+    }
+}
+
+void EthereumBridge::flushReceiptRequests()
+{
+    auto pending = std::move(m_pendingReceipts);
+    m_pendingReceipts.clear();
+
+    std::vector<std::string> txHashes;
+    std::string content;
+    for (auto it = pending.begin(); pending.end() != it; )
+    {
+        auto itMined = m_minedReceipts.find(it->first);
+        if (m_minedReceipts.end() != itMined)
+        {
+            Error error{ ErrorType::None, "" };
+            for (const auto& callback : it->second)
             {
-                error.m_type = IBridge::InvalidResultFormat;
-                error.m_message = ex.what();
+                callback(error, itMined->second);
             }
+            it = pending.erase(it);
+            continue;
         }
 
-        callback(error, txInfo);
+        content += content.empty() ? "[" : ",";
+        content += (boost::format(R"({"jsonrpc":"2.0","method":"eth_getTransactionReceipt","params":["%1%"], "id":%2%})") % it->first % txHashes.size()).str();
+        txHashes.push_back(it->first);
+        ++it;
+    }
+
+    if (txHashes.empty())
+    {
+        return;
+    }
+
+    content += "]";
+
+    sendRawRequest(content, [this, weak = this->weak_from_this(), pending = std::move(pending), txHashes](const Error& error, const json& reply)
+    {
+        if (weak.expired())
+        {
+            return;
+        }
+
+        for (size_t i = 0; i < txHashes.size(); ++i)
+        {
+            Error itemError(error);
+            json txInfo;
+
+            if (itemError.m_type == IBridge::None)
+            {
+                try
+                {
+                    if (!reply.is_array())
+                    {
+                        throw std::runtime_error("Unexpected batch reply");
+                    }
+
+                    auto itItem = std::find_if(reply.begin(), reply.end(), [i](const json& item)
+                    {
+                        auto itId = item.find("id");
+                        return item.end() != itId && itId->is_number() && itId->get<size_t>() == i;
+                    });
+
+                    if (reply.end() == itItem)
+                    {
+                        itemError.m_type = IBridge::InvalidResultFormat;
+                        itemError.m_message = "No reply for " + txHashes[i];
+                    }
+                    else if (itItem->find("error") != itItem->end() && !(*itItem)["error"].is_null())
+                    {
+                        itemError.m_type = IBridge::EthError;
+                        itemError.m_message = (*itItem)["error"]["message"].get<std::string>();
+                    }
+                    else if (itItem->find("result") == itItem->end() || (*itItem)["result"].empty())
+                    {
+                        // not mined yet
+                        itemError.m_type = IBridge::EmptyResult;
+                        itemError.m_message = "JSON has no \"result\" value";
+                    }
+                    else
+                    {
+                        txInfo = (*itItem)["result"];
+                        if (txInfo.find("blockNumber") != txInfo.end() && !txInfo["blockNumber"].is_null())
+                        {
+                            if (m_minedReceipts.size() >= kMaxMinedReceipts)
+                            {
+                                m_minedReceipts.clear();
+                            }
+                            m_minedReceipts[txHashes[i]] = txInfo;
+                        }
+                    }
+                }
+                catch (const std::exception& ex)
+                {
+                    itemError.m_type = IBridge::InvalidResultFormat;
+                    itemError.m_message = ex.what();
+                }
+            }
+
+            auto it = pending.find(txHashes[i]);
+            for (const auto& callback : it->second)
+            {
+                callback(itemError, txInfo);
+            }
+        }
     });
 }
 
 void EthereumBridge::getTxBlockNumber(const std::string& txHash, std::function<void(const Error&, uint64_t)> callback)
+{
+    m_txBlockNumberPoll.Get(txHash, std::move(callback), [this, &txHash](auto&& cb)
+    {
+        requestTxBlockNumber(txHash, std::move(cb));
+    });
+}
+
+void EthereumBridge::requestTxBlockNumber(const std::string& txHash, std::function<void(const Error&, uint64_t)> callback)
 {
     BEAM_LOG_DEBUG() << "EthereumBridge::getTxBlockNumber";
     getTransactionReceipt(txHash, [callback](const Error& error, const nlohmann::json& result)
@@ -689,6 +808,41 @@ void EthereumBridge::sendRequest(
     std::function<void(const Error&, const nlohmann::json&)> callback)
 {
     const std::string content = (boost::format(R"({"jsonrpc":"2.0","method":"%1%","params":[%2%], "id":1})") % method % params).str();
+
+    sendRawRequest(content, [callback](Error error, const json& reply)
+    {
+        json result;
+        if (error.m_type == ErrorType::None)
+        {
+            try
+            {
+                if (!reply["error"].empty())
+                {
+                    error.m_type = ErrorType::EthError;
+                    error.m_message = reply["error"]["message"].get<std::string>();
+                }
+                else if (reply["result"].empty())
+                {
+                    error.m_type = ErrorType::EmptyResult;
+                    error.m_message = "JSON has no \"result\" value";
+                }
+                else
+                {
+                    result = reply;
+                }
+            }
+            catch (const std::exception& ex)
+            {
+                error.m_type = IBridge::InvalidResultFormat;
+                error.m_message = ex.what();
+            }
+        }
+        callback(error, result);
+    });
+}
+
+void EthereumBridge::sendRawRequest(const std::string& content, std::function<void(const Error&, const nlohmann::json&)> callback)
+{
     auto settings = m_settingsProvider.GetSettings();
     std::string url = settings.GetEthNodeAddress();
 
@@ -739,21 +893,7 @@ void EthereumBridge::sendRequest(
 
                 try
                 {
-                    json reply = json::parse(strResponse);
-                    if (!reply["error"].empty())
-                    {
-                        error.m_type = ErrorType::EthError;
-                        error.m_message = reply["error"]["message"].get<std::string>();
-                    }
-                    else if (reply["result"].empty())
-                    {
-                        error.m_type = ErrorType::EmptyResult;
-                        error.m_message = "JSON has no \"result\" value";
-                    }
-                    else
-                    {
-                        result = reply;
-                    }
+                    result = json::parse(strResponse);
                 }
                 catch (const std::exception& ex)
                 {
@@ -18,6 +18,7 @@
 #include "http/http_client.h"
 #include "settings_provider.h"
 #include "ethereum_base_transaction.h"
+#include "wallet/transactions/swaps/shared_poll.h"
 
 #include <memory>
 
@@ -62,7 +63,11 @@ protected:
         const std::string& method, 
         const std::string& params, 
         std::function<void(const Error&, const nlohmann::json&)> callback);
+    // parses the reply, but doesn't check it
+    void sendRawRequest(const std::string& content, std::function<void(const Error&, const nlohmann::json&)> callback);
     libbitcoin::ec_secret generatePrivateKey() const;
+    void requestBlockNumber(std::function<void(const Error&, uint64_t)> callback);
+    void requestTxBlockNumber(const std::string& txHash, std::function<void(const Error&, uint64_t)> callback);
 
 private:
 
@@ -79,6 +84,7 @@ private:
     void onResetAllowance(const ethereum::IBridge::Error& error, const std::string& txHash, uint64_t txNonce);
     void requestApproveTxConfirmation();
     void onGotApproveTxConfirmation(const Error& error, uint64_t txBlockNumber);
+    void flushReceiptRequests();
 
     struct EthPendingTransaction
     {
@@ -89,6 +95,8 @@ private:
 
     HttpClient m_httpClient;
     ISettingsProvider& m_settingsProvider;
+    wallet::SharedPoll<int, Error, uint64_t> m_blockNumberPoll;
+    wallet::SharedPoll<std::string, Error, uint64_t> m_txBlockNumberPoll;
 
     io::Timer::Ptr m_txConfirmationTimer;
     std::queue<std::shared_ptr<EthPendingTransaction>> m_pendingTxs;
@@ -119,5 +127,10 @@ private:
 
     io::Timer::Ptr m_approveTxConfirmationTimer;
     std::queue<std::shared_ptr<EthPendingApprove>> m_pendingApprovals;
+
+    // eth_getTransactionReceipt of all the swaps, sent as a batch. The receipts of the mined txs don't change, and are cached
+    io::Timer::Ptr m_receiptsTimer;
+    std::map<std::string, std::vector<std::function<void(const Error&, const nlohmann::json&)>>> m_pendingReceipts;
+    std::map<std::string, nlohmann::json> m_minedReceipts;
 };
 } // namespace beam::ethereum
\ No newline at end of file
@@ -0,0 +1,143 @@
+// Copyright 2018-2024 The Beam Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include "utility/io/asyncevent.h"
+
+#include <chrono>
+#include <functional>
+#include <map>
+#include <memory>
+#include <tuple>
+#include <vector>
+
+namespace beam::wallet
+{
+    // Polling of the external chain (the tip, the tx confirmations), shared by all the swaps of the bridge.
+    // Each swap asks on every Beam tip, so with many live swaps the same requests come in bursts.
+    // Per key, the request is sent once: the calls made while it's in progress wait for it, and the result is reused
+    // by the calls within the period. The errors (incl. "not found" for the bridges that report it as such) aren't reused.
+    template <typename TKey, typename TError, typename... TResult>
+    class SharedPoll
+    {
+    public:
+        using Callback = std::function<void(const TError&, const TResult&...)>;
+        using Fetch = std::function<void(Callback&&)>; // sends the actual request
+
+        explicit SharedPoll(std::chrono::milliseconds period = std::chrono::seconds(5))
+            : m_pState(std::make_shared<State>())
+        {
+            m_pState->m_Period = period;
+        }
+
+        void Get(const TKey& key, Callback&& callback, const Fetch& fetch)
+        {
+            State& s = *m_pState;
+            Entry& e = s.m_Entries[key];
+
+            if (e.m_Valid && (std::chrono::steady_clock::now() - e.m_Time <= s.m_Period))
+            {
+                // async, same as the request
+                s.m_Ready.push_back([cb = std::move(callback), res = e.m_Result]()
+                {
+                    std::apply([&cb](const TResult&... args) { cb(TError{}, args...); }, res);
+                });
+                s.Post();
+                return;
+            }
+
+            e.m_Waiting.push_back(std::move(callback));
+            if (e.m_Waiting.size() > 1)
+                return; // in progress
+
+            fetch([key, pWeak = std::weak_ptr<State>(m_pState)](const TError& error, const TResult&... args)
+            {
+                auto pState = pWeak.lock();
+                if (pState)
+                    pState->OnResult(key, error, args...);
+            });
+        }
+
+    private:
+        struct Entry
+        {
+            std::tuple<TResult...> m_Result;
+            std::chrono::steady_clock::time_point m_Time;
+            bool m_Valid = false;
+            std::vector<Callback> m_Waiting;
+        };
+
+        struct State
+        {
+            std::chrono::milliseconds m_Period;
+            std::map<TKey, Entry> m_Entries;
+            std::vector<std::function<void()> > m_Ready;
+            io::AsyncEvent::Ptr m_pEvent;
+
+            void Post()
+            {
+                if (!m_pEvent)
+                {
+                    m_pEvent = io::AsyncEvent::create(io::Reactor::get_Current(), [this]()
+                    {
+                        std::vector<std::function<void()> > v;
+                        v.swap(m_Ready);
+                        for (auto& f : v)
+                            f();
+                    });
+                }
+                m_pEvent->post();
+            }
+
+            void OnResult(const TKey& key, const TError& error, const TResult&... args)
+            {
+                auto it = m_Entries.find(key);
+                if (m_Entries.end() == it)
+                    return;
+
+                Entry& e = it->second;
+                std::vector<Callback> v;
+                v.swap(e.m_Waiting);
+
+                e.m_Valid = !error.m_type; // None is 0 in all the bridges
+                if (e.m_Valid)
+                {
+                    e.m_Result = std::make_tuple(args...);
+                    e.m_Time = std::chrono::steady_clock::now();
+                }
+
+                DeleteStale();
+
+                for (auto& cb : v)
+                    cb(error, args...);
+            }
+
+            void DeleteStale()
+            {
+                auto now = std::chrono::steady_clock::now();
+                for (auto it = m_Entries.begin(); m_Entries.end() != it; )
+                {
+                    const Entry& e = it->second;
+                    if (e.m_Waiting.empty() && (!e.m_Valid || (now - e.m_Time > m_Period)))
+                        it = m_Entries.erase(it);
+                    else
+                        ++it;
+                }
+            }
+        };
+
+        std::shared_ptr<State> m_pState;
+    };
+}
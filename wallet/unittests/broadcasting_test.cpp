@@ -360,6 +360,21 @@ namespace
                 // are the reasons to fail
             }
         }
+
+        // Duplicates get the same (cached) result
+        for (size_t i = 0; i < messages.size(); ++i)
+        {
+            auto [keyLoaded, msgSigned] = keyDistributionTable[i];
+            WALLET_CHECK(validator.isSignatureValid(messages[i]) == (keyLoaded && msgSigned));
+        }
+
+        // Same bytes, split differently between the content and the signature, aren't a duplicate
+        {
+            BroadcastMsg msg = messages[0];
+            msg.m_signature.insert(msg.m_signature.begin(), msg.m_content.back());
+            msg.m_content.pop_back();
+            WALLET_CHECK(!validator.isSignatureValid(msg));
+        }
         cout << "Test end" << endl;
     }
 
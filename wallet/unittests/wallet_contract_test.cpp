@@ -86,6 +86,16 @@ namespace
             if (!res.empty())
                 fs.read(&res.front(), res.size());
 
+            if (Kind::Manager == kind)
+            {
+                // the 2nd time it's taken from the cache
+                ByteBuffer pRes[2];
+                for (uint32_t i = 0; i < _countof(pRes); i++)
+                    CompileAppShader(pRes[i], res);
+
+                WALLET_CHECK(pRes[0] == pRes[1]);
+            }
+
             bvm2::Processor::Compile(res, res, kind);
         }
     };
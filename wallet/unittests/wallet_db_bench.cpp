@@ -0,0 +1,283 @@
+// Copyright 2018-2024 The Beam Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Wallet DB benchmark.
+// Generates a large synthetic wallet (coins, txs, addresses), then times the startup and the typical queries.
+// With --open the generation is skipped and the existing DB is used instead, e.g. a copy of a real wallet in an older format,
+// then the startup time includes its migration. The DB is kept, so that it can be reused.
+// The output is CSV: operation,ms
+//
+// wallet_db_bench [--coins N] [--txs N] [--addresses N] [--path file] [--pass password] [--open]
+
+#include "wallet/core/wallet_db.h"
+#include "utility/logger.h"
+#include <boost/filesystem.hpp>
+#include <chrono>
+#include <iostream>
+
+using namespace std;
+using namespace beam;
+using namespace beam::wallet;
+
+namespace
+{
+    struct Cfg
+    {
+        uint32_t m_Coins = 1000000;
+        uint32_t m_Txs = 500000;
+        uint32_t m_Addresses = 100000;
+        std::string m_sPath = "wallet_bench.db";
+        std::string m_sPass = "pass123";
+        bool m_Open = false;
+    } g_Cfg;
+
+    const Height g_hTip = 1000000;
+
+    struct Stopwatch
+    {
+        std::chrono::steady_clock::time_point m_t0 = std::chrono::steady_clock::now();
+
+        double get_ms() const
+        {
+            return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - m_t0).count();
+        }
+    };
+
+    void Report(const char* szName, double ms)
+    {
+        cout << szName << "," << ms << endl;
+    }
+
+    template <typename TFunc>
+    void Measure(const char* szName, uint32_t nRuns, TFunc&& func)
+    {
+        Stopwatch sw;
+        for (uint32_t i = 0; i < nRuns; i++)
+            func();
+
+        Report(szName, sw.get_ms() / nRuns);
+    }
+
+    uint64_t get_Rand(uint64_t nMax)
+    {
+        uint64_t val;
+        ECC::GenRandom(&val, sizeof(val));
+        return val % nMax;
+    }
+
+    void GenerateCoins(IWalletDB& db)
+    {
+        const uint32_t nBatch = 10000;
+        std::vector<Coin> vec;
+        vec.reserve(nBatch);
+
+        for (uint32_t i = 0; i < g_Cfg.m_Coins; )
+        {
+            vec.clear();
+            for (uint32_t n = std::min(nBatch, g_Cfg.m_Coins - i); n--; i++)
+            {
+                Coin c(1 + get_Rand(Rules::Coin * 100));
+                c.m_confirmHeight = 1 + get_Rand(g_hTip - 1);
+                c.m_maturity = c.m_confirmHeight;
+
+                // most of the coins in a long-living wallet are spent
+                if (get_Rand(10))
+                    c.m_spentHeight = c.m_confirmHeight + get_Rand(g_hTip - c.m_confirmHeight);
+
+                vec.push_back(c);
+            }
+
+            db.storeCoins(vec);
+        }
+    }
+
+    void GenerateTxs(IWalletDB& db)
+    {
+        Timestamp ts = getTimestamp() - g_Cfg.m_Txs * 60;
+
+        for (uint32_t i = 0; i < g_Cfg.m_Txs; i++)
+        {
+            TxID txID;
+            ECC::GenRandom(txID.data(), txID.size());
+
+            TxDescription tx(txID);
+            tx.m_amount = 1 + get_Rand(Rules::Coin * 100);
+            tx.m_fee = 100000;
+            tx.m_peerAddr.m_Pk = get_Rand(g_Cfg.m_Addresses + 1);
+            tx.m_myAddr.m_Pk = get_Rand(g_Cfg.m_Addresses + 1);
+            tx.m_createTime = ts + i * 60;
+            tx.m_minHeight = g_hTip - g_Cfg.m_Txs + i;
+            tx.m_sender = !get_Rand(2);
+            tx.m_status = get_Rand(20) ? TxStatus::Completed : TxStatus::Failed;
+
+            db.saveTx(tx);
+        }
+    }
+
+    void GenerateAddresses(IWalletDB& db)
+    {
+        for (uint32_t i = 0; i < g_Cfg.m_Addresses; i++)
+        {
+            WalletAddress a = {};
+            a.m_label = "address " + std::to_string(i);
+            a.m_createTime = getTimestamp();
+            a.m_duration = WalletAddress::AddressExpirationNever;
+            a.m_OwnID = i + 1;
+            db.get_SbbsWalletID(a.m_BbsAddr, a.m_OwnID);
+            a.m_Token = std::to_string(a.m_BbsAddr);
+            db.saveAddress(a);
+        }
+    }
+
+    void Generate()
+    {
+        if (boost::filesystem::exists(g_Cfg.m_sPath))
+            boost::filesystem::remove(g_Cfg.m_sPath);
+
+        ECC::NoLeak<ECC::uintBig> seed;
+        seed.V = 10283UL;
+
+        auto pDB = WalletDB::init(g_Cfg.m_sPath, SecString(g_Cfg.m_sPass), seed);
+
+        Block::SystemState::ID id = { };
+        id.m_Height = g_hTip;
+        pDB->setSystemStateID(id);
+
+        Stopwatch sw;
+        GenerateCoins(*pDB);
+        Report("gen.coins", sw.get_ms());
+
+        sw = Stopwatch();
+        GenerateTxs(*pDB);
+        Report("gen.txs", sw.get_ms());
+
+        sw = Stopwatch();
+        GenerateAddresses(*pDB);
+        Report("gen.addresses", sw.get_ms());
+
+        sw = Stopwatch();
+        pDB.reset(); // commit
+        Report("gen.close", sw.get_ms());
+    }
+
+    void RunBench()
+    {
+        Stopwatch sw;
+        auto pDB = WalletDB::open(g_Cfg.m_sPath, SecString(g_Cfg.m_sPass));
+        Report("startup", sw.get_ms()); // incl. the migration, if needed
+
+        Height h = pDB->getCurrentHeight();
+
+        Amount valTotal = 0;
+        uint32_t nCoins = 0;
+        Measure("visitCoins", 1, [&]() {
+            valTotal = 0;
+            nCoins = 0;
+            pDB->visitCoins([&](const Coin& c) {
+                nCoins++;
+                if (Coin::Status::Available == c.m_status)
+                    valTotal += c.m_ID.m_Value;
+                return true;
+            });
+        });
+
+        cout << "# coins: " << nCoins << ", available: " << valTotal << endl;
+
+        std::vector<Coin> vCoins;
+        std::vector<ShieldedCoin> vShielded;
+
+        auto fnSelect = [&](Amount val) {
+            vCoins.clear();
+            vShielded.clear();
+            pDB->selectCoins2(h, val, Asset::s_BeamID, vCoins, vShielded, 0, true);
+        };
+
+        Measure("selectCoins2.small", 10, [&]() { fnSelect(Rules::Coin); });
+        Measure("selectCoins2.1pcnt", 10, [&]() { fnSelect(valTotal / 100); });
+        Measure("selectCoins2.half", 3, [&]() { fnSelect(valTotal / 2); });
+
+        Measure("getTxCount", 10, [&]() { pDB->getTxCount(TxType::Simple); });
+        Measure("getTxHistory.page", 10, [&]() { pDB->getTxHistory(TxType::Simple, 0, 100); });
+        Measure("getTxHistory.all", 1, [&]() { pDB->getTxHistory(TxType::Simple); });
+
+        Measure("visitTx.failed", 1, [&]() {
+            TxListFilter f;
+            f.m_Status = TxStatus::Failed;
+            pDB->visitTx([](const TxDescription&) { return true; }, f);
+        });
+
+        Measure("getAddresses", 3, [&]() { pDB->getAddresses(true); });
+
+        sw = Stopwatch();
+        pDB.reset();
+        Report("close", sw.get_ms());
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    for (int i = 1; i < argc; i++)
+    {
+        std::string sArg = argv[i];
+        if ("--open" == sArg)
+        {
+            g_Cfg.m_Open = true;
+            continue;
+        }
+
+        if (i + 1 >= argc)
+        {
+            cerr << "Missing value for " << sArg << endl;
+            return 2;
+        }
+
+        const char* szVal = argv[++i];
+
+        if ("--coins" == sArg)
+            g_Cfg.m_Coins = atoi(szVal);
+        else if ("--txs" == sArg)
+            g_Cfg.m_Txs = atoi(szVal);
+        else if ("--addresses" == sArg)
+            g_Cfg.m_Addresses = atoi(szVal);
+        else if ("--path" == sArg)
+            g_Cfg.m_sPath = szVal;
+        else if ("--pass" == sArg)
+            g_Cfg.m_sPass = szVal;
+        else
+        {
+            cerr << "Unknown option " << sArg << endl;
+            return 2;
+        }
+    }
+
+    auto logger = Logger::create(BEAM_LOG_LEVEL_WARNING, BEAM_LOG_LEVEL_WARNING);
+
+    io::Reactor::Ptr pReactor(io::Reactor::create());
+    io::Reactor::Scope scope(*pReactor);
+
+    try
+    {
+        if (!g_Cfg.m_Open)
+            Generate();
+
+        RunBench();
+    }
+    catch (const std::exception& ex)
+    {
+        cerr << "Error: " << ex.what() << endl;
+        return 1;
+    }
+
+    return 0;
+}
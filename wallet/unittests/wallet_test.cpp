@@ -4199,6 +4199,64 @@ void TestKeyKeeper(IPrivateKeyKeeper2::Ptr externalKeyKeeper = {}, size_t index
     WALLET_CHECK(tx.IsValid(ctx));
 }
 
+void TestKeyKeeperBatch()
+{
+    cout << "\nKey keeper batch on worker threads\n";
+
+    io::Reactor::Ptr mainReactor{ io::Reactor::create() };
+    io::Reactor::Scope scope(*mainReactor);
+
+    Key::IKdf::Ptr pKdf;
+    HKdf::Create(pKdf, 7654U);
+
+    auto pKk = std::make_shared<LocalPrivateKeyKeeperStd>(pKdf);
+    pKk->set_WorkerThreads(3);
+
+    const Height hScheme = Rules::get().pForks[1].m_Height;
+
+    std::vector<IPrivateKeyKeeper2::Method::CreateOutput> vMethods(8);
+    for (size_t i = 0; i < vMethods.size(); i++)
+    {
+        auto& m = vMethods[i];
+        m.m_Cid = CoinID(100 + i, 20 + i, Key::Type::Regular);
+        m.m_hScheme = hScheme;
+    }
+
+    struct MyHandler
+        :public IPrivateKeyKeeper2::Handler
+    {
+        IPrivateKeyKeeper2::Status::Type m_Status = IPrivateKeyKeeper2::Status::InProgress;
+        uint32_t m_Calls = 0;
+
+        void OnDone(IPrivateKeyKeeper2::Status::Type n) override
+        {
+            m_Status = n;
+            m_Calls++;
+            io::Reactor::get_Current().stop();
+        }
+    };
+
+    auto pHandler = std::make_shared<MyHandler>();
+    pKk->InvokeAsyncBatch(vMethods, pHandler);
+    mainReactor->run();
+
+    WALLET_CHECK(pHandler->m_Calls == 1);
+    WALLET_CHECK(IPrivateKeyKeeper2::Status::Success == pHandler->m_Status);
+
+    for (const auto& m : vMethods)
+    {
+        WALLET_CHECK(m.m_pResult);
+
+        Point::Native comm;
+        WALLET_CHECK(m.m_pResult->IsValid(hScheme, comm));
+
+        IPrivateKeyKeeper2::Method::get_Commitment mc;
+        mc.m_Cid = m.m_Cid;
+        WALLET_CHECK(IPrivateKeyKeeper2::Status::Success == pKk->InvokeSync(mc));
+        WALLET_CHECK(mc.m_Result == m.m_pResult->m_Commitment);
+    }
+}
+
 void TestArgumentParsing()
 {
     struct MyProcessor : bvm2::ProcessorManager
@@ -4995,6 +5053,7 @@ int main()
     //GenerateTreasury(100, 100, 100000000);
     TestTxList();
     TestKeyKeeper();
+    TestKeyKeeperBatch();
 
     TestVouchers();
 
@@ -0,0 +1,329 @@
+// Copyright 2018-2024 The Beam Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Page-level persistence of the wallet directory in IndexedDB (included with --pre-js).
+// The files live in MEMFS. Writes are tracked per page, and only the dirty pages are stored, batched in a single
+// IndexedDB transaction. Unlike IDBFS.syncfs, which stores the whole image of every modified file.
+// The FS calls (incl. those proxied from the wallet thread) run on the main thread one by one, hence each flush is
+// a consistent snapshot, which includes the SQLite journal, if any. Same as a crash at that point.
+// On the first mount the files are migrated from IDBFS.
+Module['BeamPageStore'] = {
+    dbName: 'beam_wallet_pages',
+    pageSize: 64 * 1024,
+    flushDelay_ms: 500,
+
+    db: null,
+    dir: null,
+    dirty: null, // path -> set of the dirty page indices, null if deleted
+    timer: null,
+    busy: false,
+    pending: false,
+    callbacks: [],
+
+    mount: function(dir, cb) {
+        var self = this;
+        var req = indexedDB.open(self.dbName, 1);
+
+        req.onupgradeneeded = function() {
+            var db = req.result;
+            db.createObjectStore('files'); // path -> { size }
+            db.createObjectStore('pages'); // [path, index] -> Uint8Array
+            db.createObjectStore('meta');
+        };
+
+        req.onerror = function() {
+            cb(req.error);
+        };
+
+        req.onsuccess = function() {
+            self.db = req.result;
+            self.dir = dir;
+            self.dirty = new Map();
+
+            var tx = self.db.transaction('meta', 'readonly');
+            var reqMeta = tx.objectStore('meta').get('migrated');
+            reqMeta.onsuccess = function() {
+                if (reqMeta.result)
+                {
+                    FS.mkdir(dir);
+                    FS.mount(MEMFS, {}, dir);
+                    self.load(cb);
+                }
+                else
+                    self.migrate(cb);
+            };
+            reqMeta.onerror = function() {
+                cb(reqMeta.error);
+            };
+        };
+    },
+
+    migrate: function(cb) {
+        var self = this;
+        FS.mkdir(self.dir);
+        FS.mount(IDBFS, {}, self.dir);
+        FS.syncfs(true, function(error) {
+            if (error)
+                return cb(error);
+
+            self.markTree(self.dir);
+            self.hook();
+            self.flush(function(error) {
+                if (error)
+                    return cb(error);
+
+                var tx = self.db.transaction('meta', 'readwrite');
+                tx.objectStore('meta').put(true, 'migrated');
+                tx.oncomplete = function() {
+                    console.log('wallet storage migrated');
+                    cb(null);
+                };
+                tx.onerror = function() {
+                    cb(tx.error);
+                };
+            });
+        });
+    },
+
+    load: function(cb) {
+        var self = this;
+        var files = new Map();
+        var tx = self.db.transaction(['files', 'pages'], 'readonly');
+
+        var reqFiles = tx.objectStore('files').openCursor();
+        reqFiles.onsuccess = function() {
+            var cursor = reqFiles.result;
+            if (cursor)
+            {
+                files.set(cursor.key, new Uint8Array(cursor.value.size));
+                cursor.continue();
+                return;
+            }
+
+            // the pages are ordered by path, then by index
+            var reqPages = tx.objectStore('pages').openCursor();
+            reqPages.onsuccess = function() {
+                var cursor = reqPages.result;
+                if (cursor)
+                {
+                    var data = files.get(cursor.key[0]);
+                    var pos = cursor.key[1] * self.pageSize;
+                    if (data && (pos + cursor.value.length <= data.length))
+                        data.set(cursor.value, pos);
+                    cursor.continue();
+                }
+            };
+        };
+
+        tx.oncomplete = function() {
+            files.forEach(function(data, path) {
+                FS.mkdirTree(PATH.dirname(path));
+                FS.writeFile(path, data, { canOwn: true });
+            });
+
+            self.hook();
+            cb(null);
+        };
+        tx.onerror = function() {
+            cb(tx.error);
+        };
+    },
+
+    isTracked: function(path) {
+        return (typeof path === 'string') && (path.indexOf(this.dir + '/') === 0);
+    },
+
+    markPages: function(path, pos, length) {
+        if (!this.isTracked(path) || (length <= 0))
+            return;
+
+        var pages = this.dirty.get(path);
+        if (!pages)
+        {
+            pages = new Set();
+            this.dirty.set(path, pages);
+        }
+
+        for (var i = Math.floor(pos / this.pageSize); i * this.pageSize < pos + length; i++)
+            pages.add(i);
+    },
+
+    markFile: function(path) {
+        var node = FS.lookupPath(path).node;
+        this.markPages(path, 0, Math.max(node.usedBytes, 1)); // an empty file still needs its record
+    },
+
+    markTree: function(path) {
+        var self = this;
+        FS.readdir(path).forEach(function(name) {
+            if ((name === '.') || (name === '..'))
+                return;
+
+            var child = path + '/' + name;
+            if (FS.isDir(FS.stat(child).mode))
+                self.markTree(child);
+            else
+                self.markFile(child);
+        });
+    },
+
+    markDeleted: function(path) {
+        if (this.isTracked(path))
+            this.dirty.set(path, null);
+    },
+
+    hook: function() {
+        var self = this;
+
+        var write = FS.write;
+        FS.write = function(stream, buffer, offset, length, position, canOwn) {
+            var pos = (typeof position !== 'undefined') ? position : stream.position;
+            var res = write.apply(FS, arguments);
+            self.markPages(stream.path, pos, res);
+            self.schedule();
+            return res;
+        };
+
+        var truncate = FS.truncate;
+        FS.truncate = function(path, len) { // ftruncate goes here too
+            truncate.apply(FS, arguments);
+            var node = (typeof path === 'string') ? FS.lookupPath(path, { follow: true }).node : path;
+            self.markPages(FS.getPath(node), len, 1); // the size, and the partial last page
+            self.schedule();
+        };
+
+        var unlink = FS.unlink;
+        FS.unlink = function(path) {
+            unlink.apply(FS, arguments);
+            self.markDeleted(path);
+            self.schedule();
+        };
+
+        var rename = FS.rename;
+        FS.rename = function(oldPath, newPath) {
+            rename.apply(FS, arguments);
+            self.markDeleted(oldPath);
+            if (self.isTracked(newPath))
+                self.markFile(newPath);
+            self.schedule();
+        };
+    },
+
+    // Coalesces the flush requests, i.e. the commits of the wallet DB
+    schedule: function() {
+        var self = this;
+        if (!self.timer)
+        {
+            self.timer = setTimeout(function() {
+                self.timer = null;
+                self.flush(null);
+            }, self.flushDelay_ms);
+        }
+    },
+
+    flush: function(cb) {
+        var self = this;
+        if (!self.db)
+        {
+            // not mounted (i.e. a headless wallet), nothing to persist
+            if (cb)
+                cb(null);
+            return;
+        }
+
+        if (cb)
+            self.callbacks.push(cb);
+
+        if (self.busy)
+        {
+            self.pending = true;
+            return;
+        }
+
+        var dirty = self.dirty;
+        self.dirty = new Map();
+
+        var tx = self.db.transaction(['files', 'pages'], 'readwrite');
+        var files = tx.objectStore('files');
+        var pages = tx.objectStore('pages');
+
+        dirty.forEach(function(set, path) {
+            var lookup = null;
+            if (set)
+            {
+                try {
+                    lookup = FS.lookupPath(path);
+                } catch (e) {
+                    // deleted meanwhile
+                }
+            }
+
+            if (!lookup)
+            {
+                files.delete(path);
+                pages.delete(IDBKeyRange.bound([path, 0], [path, Infinity]));
+                return;
+            }
+
+            var data = MEMFS.getFileDataAsTypedArray(lookup.node);
+            var nPages = Math.ceil(data.length / self.pageSize);
+
+            files.put({ size: data.length }, path);
+            pages.delete(IDBKeyRange.bound([path, nPages], [path, Infinity]));
+
+            set.forEach(function(i) {
+                if (i < nPages) // a copy, a view would clone the whole buffer
+                    pages.put(data.slice(i * self.pageSize, (i + 1) * self.pageSize), [path, i]);
+            });
+        });
+
+        self.busy = true;
+        var callbacks = self.callbacks;
+        self.callbacks = [];
+
+        var done = function(error) {
+            self.busy = false;
+            if (error)
+                console.log('wallet storage flush failed: ' + error);
+
+            callbacks.forEach(function(cb) {
+                cb(error);
+            });
+
+            if (self.pending)
+            {
+                self.pending = false;
+                self.flush(null);
+            }
+        };
+
+        tx.oncomplete = function() {
+            done(null);
+        };
+        tx.onerror = function() {
+            // requeue, merged with the changes made meanwhile
+            dirty.forEach(function(set, path) {
+                var setNew = self.dirty.get(path);
+                if (typeof setNew === 'undefined')
+                    self.dirty.set(path, set);
+                else if (setNew && set)
+                    set.forEach(function(i) {
+                        setNew.add(i);
+                    });
+            });
+            done(tx.error);
+            self.schedule();
+        };
+    }
+};
@@ -74,7 +74,7 @@ namespace
         GenerateDefaultAddress(db);
         EM_ASM
         (
-            FS.syncfs(false, function()
+            Module.BeamPageStore.flush(function()
             {
                 console.log("wallet created!");
             });
@@ -889,7 +889,7 @@ public:
             fs::remove(dbName);
             EM_ASM
             (
-                FS.syncfs(false, function()
+                Module.BeamPageStore.flush(function()
                 {
                     console.log("wallet deleted!");
                 });
@@ -962,10 +962,8 @@ public:
         EM_ASM
         (
             {
-                FS.mkdir("/beam_wallet");
-                FS.mount(IDBFS, {}, "/beam_wallet");
                 console.log("mounting...");
-                FS.syncfs(true, function(error)
+                Module.BeamPageStore.mount("/beam_wallet", function(error)
                 {
                     if (error == null) {
                         dynCall('vi', $0, [$1]);
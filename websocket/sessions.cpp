@@ -27,6 +27,60 @@ namespace beam
         throw std::runtime_error(ec.message());
     }
 
+    //
+    // Write queue
+    //
+    bool WriteQueue::Push(std::string&& msg)
+    {
+        auto key = get_SupersedeKey(msg);
+        if (!key.empty())
+        {
+            // skip the front, it's being written
+            for (size_t i = 1; i < _items.size(); ++i)
+            {
+                auto& item = _items[i];
+                if (get_SupersedeKey(item) == key)
+                {
+                    _bytes -= item.size();
+                    _bytes += msg.size();
+                    item = std::move(msg);
+                    return true;
+                }
+            }
+        }
+
+        _bytes += msg.size();
+        _items.push_back(std::move(msg));
+
+        // a single big message is always allowed
+        return (_items.size() == 1) || (_bytes <= s_MaxBytes);
+    }
+
+    void WriteQueue::Pop()
+    {
+        assert(!_items.empty());
+        _bytes -= _items.front().size();
+        _items.pop_front();
+    }
+
+    std::string_view WriteQueue::get_SupersedeKey(const std::string& msg)
+    {
+        // json::dump() puts the keys in alphabetical order, "id" comes first
+        static const std::string_view prefix = "{\"id\":\"";
+        if (msg.compare(0, prefix.size(), prefix) != 0)
+            return {};
+
+        auto end = msg.find('"', prefix.size());
+        if (end == std::string::npos)
+            return {};
+
+        std::string_view id(msg.data() + prefix.size(), end - prefix.size());
+        if (id == "ev_sync_progress" || id == "ev_system_state" || id == "ev_connection_changed")
+            return id;
+
+        return {};
+    }
+
     //
     // WebSocket Secure Session
     //
@@ -58,10 +112,7 @@ namespace beam
         // the websocket stream has its own timeout system.
         beast::get_lowest_layer(ws).expires_never();
 
-        // Set suggested timeout settings for the websocket
-        ws.set_option(
-            websocket::stream_base::timeout::suggested(
-                beast::role_type::server));
+        SetupStream();
 
         // Accept the websocket handshake
         ws.async_accept([sp = shared_from_this()](boost::system::error_code ec)
@@ -16,7 +16,9 @@
 #include <memory>
 #include <string>
 #include <queue>
+#include <deque>
 #include <mutex>
+#include <string_view>
 #include <boost/asio/ip/tcp.hpp>
 #include <boost/beast/core.hpp>
 #include <boost/beast/ssl/ssl_stream.hpp>
@@ -41,6 +43,32 @@ namespace beam
     using tcp = boost::asio::ip::tcp;
     using HandlerCreator = std::function<WebSocketServer::ClientHandler::Ptr(WebSocketServer::SendFunc, WebSocketServer::CloseFunc)>;
 
+    // Outgoing messages of a websocket session.
+    // Snapshot notifications (sync progress, system state, ...) supersede the queued ones with the same id,
+    // so a slow client gets the latest state instead of the whole history.
+    // The front message is the one being written and is never touched.
+    class WriteQueue
+    {
+    public:
+        static constexpr size_t s_MaxBytes = 16 * 1024 * 1024;
+
+        // Returns false if the queue exceeds the limit, the session should be dropped then
+        bool Push(std::string&& msg);
+        void Pop();
+
+        std::string& front() { return _items.front(); }
+        bool empty() const { return _items.empty(); }
+        size_t size() const { return _items.size(); }
+        size_t get_Bytes() const { return _bytes; }
+
+        // Non-empty for JSON-RPC notifications that carry the full state
+        static std::string_view get_SupersedeKey(const std::string& msg);
+
+    private:
+        std::deque<std::string> _items;
+        size_t _bytes = 0;
+    };
+
     template<typename Derived>
     class WebsocketSession
     {
@@ -77,11 +105,7 @@ namespace beam
         // Start the asynchronous operation
         void run()
         {
-            GetDerived().GetStream().binary(true);
-            // Set suggested timeout settings for the websocket
-            GetDerived().GetStream().set_option(
-                websocket::stream_base::timeout::suggested(
-                    beast::role_type::server));
+            SetupStream();
 
             // Accept the websocket handshake
             GetDerived().GetStream().async_accept(
@@ -102,6 +126,24 @@ namespace beam
             do_read();
         }
 
+    protected:
+
+        // Must be called before the websocket handshake
+        void SetupStream()
+        {
+            auto& ws = GetDerived().GetStream();
+            ws.binary(true);
+            // Set suggested timeout settings for the websocket
+            ws.set_option(
+                websocket::stream_base::timeout::suggested(
+                    beast::role_type::server));
+
+            // Compress the messages if the client supports it, notifications are verbose JSON
+            websocket::permessage_deflate pmd;
+            pmd.server_enable = true;
+            ws.set_option(pmd);
+        }
+
     private:
 
         Derived& GetDerived()
@@ -203,18 +245,25 @@ namespace beam
 
         void do_write(std::string&& msg)
         {
-            std::string* contents = nullptr;
+            if (_overflow)
+                return;
 
+            bool idle = _writeQueue.empty();
+            if (!_writeQueue.Push(std::move(msg)))
             {
-                _writeQueue.push(std::move(msg));
-
-                if (_writeQueue.size() > 1)
-                    return;
-
-                contents = &_writeQueue.front();
+                // The client doesn't read, don't let it eat our memory.
+                // Pending operations fail and release the session.
+                BEAM_LOG_WARNING() << "WebsocketSession: write queue overflow (" << _writeQueue.size() << " messages, " << _writeQueue.get_Bytes() << " bytes), dropping the client";
+                _overflow = true;
+                boost::system::error_code ec;
+                beast::get_lowest_layer(GetDerived().GetStream()).socket().close(ec);
+                return;
             }
 
-            GetDerived().GetStream().async_write(boost::asio::buffer(*contents),
+            if (!idle)
+                return;
+
+            GetDerived().GetStream().async_write(boost::asio::buffer(_writeQueue.front()),
                 [sp = GetDerived().shared_from_this()](boost::system::error_code ec, std::size_t bytes)
             {
                 sp->on_write(ec, bytes);
@@ -228,20 +277,12 @@ namespace beam
             if (ec)
                 return fail(ec, "write");
 
-            std::string* contents = nullptr;
-            {
-                _writeQueue.pop();
-
-                if (!_writeQueue.empty())
-                {
-                    contents = &_writeQueue.front();
-                }
-            }
+            _writeQueue.Pop();
 
-            if (contents)
+            if (!_writeQueue.empty() && !_overflow)
             {
                 GetDerived().GetStream().async_write(
-                    boost::asio::buffer(*contents),
+                    boost::asio::buffer(_writeQueue.front()),
                     [sp = GetDerived().shared_from_this()](boost::system::error_code ec, std::size_t bytes)
                 {
                     sp->on_write(ec, bytes);
@@ -267,7 +308,8 @@ namespace beam
         SafeReactor::Ptr _reactor;
         HandlerCreator _creator;
 
-        std::queue<std::string> _writeQueue;
+        WriteQueue _writeQueue;
+        bool _overflow = false;
     };
 
     class PlainWebsocketSession
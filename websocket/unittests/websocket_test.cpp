@@ -490,6 +490,43 @@ namespace
     };
 
 
+    void WriteQueueTest()
+    {
+        std::cout << "Write queue test" << std::endl;
+
+        const std::string progress1 = R"({"id":"ev_sync_progress","jsonrpc":"2.0","result":{"done":1}})";
+        const std::string progress2 = R"({"id":"ev_sync_progress","jsonrpc":"2.0","result":{"done":2}})";
+        const std::string progress3 = R"({"id":"ev_sync_progress","jsonrpc":"2.0","result":{"done":3}})";
+        const std::string txs = R"({"id":"ev_txs_changed","jsonrpc":"2.0","result":{}})";
+
+        WALLET_CHECK(WriteQueue::get_SupersedeKey(progress1) == "ev_sync_progress");
+        WALLET_CHECK(WriteQueue::get_SupersedeKey(txs).empty());
+        WALLET_CHECK(WriteQueue::get_SupersedeKey("test message").empty());
+
+        WriteQueue q;
+        WALLET_CHECK(q.Push(std::string(progress1)));
+        WALLET_CHECK(q.Push(std::string(txs)));
+        WALLET_CHECK(q.Push(std::string(progress2)));
+        WALLET_CHECK(q.size() == 3);
+
+        // the front is being written and is kept, the queued snapshot is replaced
+        WALLET_CHECK(q.Push(std::string(progress3)));
+        WALLET_CHECK(q.size() == 3);
+        WALLET_CHECK(q.get_Bytes() == progress1.size() + txs.size() + progress3.size());
+
+        q.Pop();
+        WALLET_CHECK(q.front() == txs);
+        q.Pop();
+        WALLET_CHECK(q.front() == progress3);
+        q.Pop();
+        WALLET_CHECK(q.empty() && q.get_Bytes() == 0);
+
+        // a single big message is allowed, queueing behind it is not
+        std::string big(WriteQueue::s_MaxBytes, 'a');
+        WALLET_CHECK(q.Push(std::move(big)));
+        WALLET_CHECK(!q.Push(std::string(txs)));
+    }
+
     void PlainWebsocketTest()
     {
         std::cout << "Plain Web Socket test" << std::endl;
@@ -608,6 +645,7 @@ int main()
     int logLevel = BEAM_LOG_LEVEL_WARNING;
     auto logger = beam::Logger::create(logLevel, logLevel);
 
+    WriteQueueTest();
     PlainWebsocketTest();
     //SecureWebsocketTest();
     SecureWebsocketTest(1, 1);